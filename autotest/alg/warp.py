@@ -35,6 +35,7 @@
 import os
 import sys
 import shutil
+import struct
 
 sys.path.append( '../pymod' )
 
@@ -1695,6 +1696,55 @@ def warp_52():
 
     return 'success'
 
+###############################################################################
+# Test the control grid mode of the approximate transformer
+
+def warp_53():
+
+    src_ds = gdal.Translate('', '../gcore/data/byte.tif', format = 'MEM',
+                            GCPs = [ gdal.GCP(0, 0, 0, 0, 0),
+                                     gdal.GCP(20, 0, 0, 20, 0),
+                                     gdal.GCP(0, 20, 0, 0, 20),
+                                     gdal.GCP(20, 20, 0, 20, 20),
+                                     gdal.GCP(12, 9, 0, 10, 10),
+                                     gdal.GCP(4, 17, 0, 5, 15) ])
+
+    ref_ds = gdal.Warp('', src_ds, format = 'MEM', tps = True,
+                       width = 400, height = 400, errorThreshold = 0)
+    ref_data = struct.unpack('B' * 400 * 400,
+                             ref_ds.GetRasterBand(1).ReadRaster())
+
+    old_val = gdal.GetConfigOption('GDAL_APPROX_TRANSFORMER_GRID')
+    gdal.SetConfigOption('GDAL_APPROX_TRANSFORMER_GRID', 'YES')
+    out_ds = gdal.Warp('', src_ds, format = 'MEM', tps = True,
+                       width = 400, height = 400, errorThreshold = 0.125)
+    out_mt_ds = gdal.Warp('', src_ds, format = 'MEM', tps = True,
+                          width = 400, height = 400, errorThreshold = 0.125,
+                          multithread = True,
+                          warpOptions = [ 'NUM_THREADS=2' ],
+                          warpMemoryLimit = 1)
+    gdal.SetConfigOption('GDAL_APPROX_TRANSFORMER_GRID', old_val)
+
+    if out_ds.GetRasterBand(1).Checksum() != \
+       out_mt_ds.GetRasterBand(1).Checksum():
+        gdaltest.post_reason('fail')
+        return 'fail'
+
+    # Only pixels whose source position is within 0.125 pixel of a source
+    # pixel boundary may differ.
+    out_data = struct.unpack('B' * 400 * 400,
+                             out_ds.GetRasterBand(1).ReadRaster())
+    diff = 0
+    for i in range(400 * 400):
+        if out_data[i] != ref_data[i]:
+            diff = diff + 1
+    if diff > 400 * 400 / 10:
+        gdaltest.post_reason('fail')
+        print(diff)
+        return 'fail'
+
+    return 'success'
+
 gdaltest_list = [
     warp_1,
     warp_1_short,
@@ -1764,7 +1814,8 @@ gdaltest_list = [
     warp_49,
     warp_50,
     warp_51,
-    warp_52
+    warp_52,
+    warp_53
     ]
 
 
@@ -36,6 +36,7 @@
 #include <gdal_utils.h>
 #include <string>
 #include <limits>
+#include <vector>
 
 namespace tut
 {
@@ -282,4 +283,171 @@ namespace tut
         GetGDALDriverManager()->DeregisterDriver( poDriver );
         delete poDriver;
     }
+
+    class BandWithErrorInRead: public GDALRasterBand
+    {
+        protected:
+            virtual CPLErr IReadBlock(int, int nBlockYOff, void* pData)
+            {
+                if( nBlockYOff >= 50 )
+                {
+                    CPLError(CE_Failure, CPLE_AppDefined,
+                             "read error at line %d", nBlockYOff);
+                    return CE_Failure;
+                }
+                memset(pData, 0, nBlockXSize);
+                return CE_None;
+            }
+
+        public:
+                    BandWithErrorInRead(int nXSize, int nYSize)
+                    {
+                        nRasterXSize = nXSize;
+                        nRasterYSize = nYSize;
+                        nBlockXSize = nXSize;
+                        nBlockYSize = 1;
+                        eDataType = GDT_Byte;
+                    }
+    };
+
+    class DatasetWithErrorInRead: public GDALDataset
+    {
+        public:
+            using GDALDataset::nRasterXSize;
+            using GDALDataset::nRasterYSize;
+            using GDALDataset::SetBand;
+    };
+
+    // Test that a pipelined GDALDatasetCopyWholeRaster() (GDAL_NUM_THREADS)
+    // gives the same result as the sequential one, and reports read errors
+    template<> template<> void object::test<10>()
+    {
+        GDALDriver* poMEMDrv = GetGDALDriverManager()->GetDriverByName("MEM");
+        GDALDataset* poSrcDS = poMEMDrv->Create("", 123, 301, 3, GDT_UInt16, NULL);
+        std::vector<GUInt16> anSrc(123 * 301 * 3);
+        for( size_t i = 0; i < anSrc.size(); ++i )
+            anSrc[i] = static_cast<GUInt16>((i * 7919) % 65536);
+        ensure_equals( poSrcDS->RasterIO(GF_Write, 0, 0, 123, 301, &anSrc[0],
+                                         123, 301, GDT_UInt16, 3, NULL,
+                                         0, 0, 0, NULL), CE_None );
+
+        const char* apszThreads[] = { NULL, "2", "4" };
+        const char* apszInterleave[] = { "INTERLEAVE=BAND", "INTERLEAVE=PIXEL" };
+        std::vector<float> afRef;
+        CPLSetConfigOption("GDAL_SWATH_SIZE", "4096");
+        for( int iThreads = 0; iThreads < 3; ++iThreads )
+        {
+            for( int iInterleave = 0; iInterleave < 2; ++iInterleave )
+            {
+                CPLSetConfigOption("GDAL_NUM_THREADS", apszThreads[iThreads]);
+                GDALDataset* poDstDS = poMEMDrv->Create("", 123, 301, 3,
+                                                        GDT_Float32, NULL);
+                char* apszOptions[] = {
+                    const_cast<char*>(apszInterleave[iInterleave]), NULL };
+                CPLErr eErr = GDALDatasetCopyWholeRaster(
+                    (GDALDatasetH)poSrcDS, (GDALDatasetH)poDstDS,
+                    apszOptions, NULL, NULL);
+                std::vector<float> afDst(anSrc.size());
+                CPL_IGNORE_RET_VAL(poDstDS->RasterIO(GF_Read, 0, 0, 123, 301,
+                                                     &afDst[0], 123, 301,
+                                                     GDT_Float32, 3, NULL,
+                                                     0, 0, 0, NULL));
+                GDALClose(poDstDS);
+                CPLSetConfigOption("GDAL_NUM_THREADS", NULL);
+                ensure_equals( eErr, CE_None );
+                if( afRef.empty() )
+                    afRef = afDst;
+                else
+                    ensure( afDst == afRef );
+            }
+        }
+        ensure_equals( afRef[1], 7919.0f );
+        GDALClose(poSrcDS);
+
+        // Read errors happening in the reading thread must reach the caller
+        DatasetWithErrorInRead* poErrDS = new DatasetWithErrorInRead();
+        poErrDS->nRasterXSize = 100;
+        poErrDS->nRasterYSize = 100;
+        poErrDS->SetBand(1, new BandWithErrorInRead(100, 100));
+        GDALDataset* poDstDS = poMEMDrv->Create("", 100, 100, 1, GDT_Byte, NULL);
+        CPLSetConfigOption("GDAL_NUM_THREADS", "2");
+        CPLErrorReset();
+        CPLPushErrorHandler(CPLQuietErrorHandler);
+        CPLErr eErr = GDALDatasetCopyWholeRaster(
+            (GDALDatasetH)poErrDS, (GDALDatasetH)poDstDS, NULL, NULL, NULL);
+        CPLPopErrorHandler();
+        CPLSetConfigOption("GDAL_NUM_THREADS", NULL);
+        CPLSetConfigOption("GDAL_SWATH_SIZE", NULL);
+        ensure_equals( eErr, CE_Failure );
+        ensure_equals( CPLGetLastErrorType(), CE_Failure );
+        GDALClose(poDstDS);
+        delete poErrDS;
+    }
+
+    class BandWithBlockCache: public GDALRasterBand
+    {
+        protected:
+            virtual CPLErr IReadBlock(int, int nBlockYOff, void* pData)
+            {
+                memset(pData, nBlockYOff % 256, nBlockXSize);
+                return CE_None;
+            }
+
+            virtual CPLErr IWriteBlock(int, int nBlockYOff, void*)
+            {
+                anWrittenLines.push_back(nBlockYOff);
+                anWritingThreads.push_back(CPLGetPID());
+                return CE_None;
+            }
+
+        public:
+            std::vector<int> anWrittenLines;
+            std::vector<GIntBig> anWritingThreads;
+
+                    BandWithBlockCache(int nXSize, int nYSize)
+                    {
+                        nRasterXSize = nXSize;
+                        nRasterYSize = nYSize;
+                        nBlockXSize = nXSize;
+                        nBlockYSize = 1;
+                        eDataType = GDT_Byte;
+                    }
+    };
+
+    // Test that a pipelined GDALDatasetCopyWholeRaster() writes the blocks
+    // of the target from the calling thread only, and in order, even when
+    // the reads of the source evict them from the block cache
+    template<> template<> void object::test<11>()
+    {
+        DatasetWithErrorInRead* poSrcDS = new DatasetWithErrorInRead();
+        poSrcDS->nRasterXSize = 10000;
+        poSrcDS->nRasterYSize = 200;
+        poSrcDS->SetBand(1, new BandWithBlockCache(10000, 200));
+        DatasetWithErrorInRead* poDstDS = new DatasetWithErrorInRead();
+        poDstDS->nRasterXSize = 10000;
+        poDstDS->nRasterYSize = 200;
+        BandWithBlockCache* poDstBand = new BandWithBlockCache(10000, 200);
+        poDstDS->SetBand(1, poDstBand);
+
+        const GIntBig nOldCacheMax = GDALGetCacheMax64();
+        GDALSetCacheMax64(100 * 1000);
+        CPLSetConfigOption("GDAL_NUM_THREADS", "2");
+        CPLSetConfigOption("GDAL_SWATH_SIZE", "100000");
+        CPLErr eErr = GDALDatasetCopyWholeRaster(
+            (GDALDatasetH)poSrcDS, (GDALDatasetH)poDstDS, NULL, NULL, NULL);
+        CPLSetConfigOption("GDAL_NUM_THREADS", NULL);
+        CPLSetConfigOption("GDAL_SWATH_SIZE", NULL);
+        poDstDS->FlushCache();
+        GDALSetCacheMax64(nOldCacheMax);
+        ensure_equals( eErr, CE_None );
+
+        ensure_equals( poDstBand->anWrittenLines.size(), 200U );
+        for( size_t i = 0; i < poDstBand->anWrittenLines.size(); ++i )
+        {
+            ensure_equals( poDstBand->anWrittenLines[i], static_cast<int>(i) );
+            ensure_equals( poDstBand->anWritingThreads[i], CPLGetPID() );
+        }
+        delete poDstDS;
+        delete poSrcDS;
+    }
 } // namespace tut
@@ -40,6 +40,7 @@
 #include <tut.h>
 #include <tut_gdal.h>
 #include <ogr_srs_api.h> // OGR/OSR API
+#include <ogr_spatialref.h>
 #include <algorithm>
 #include <cmath>
 #include <string>
@@ -361,5 +362,57 @@ namespace tut
         CPLFree(wkt1);
     }
 
+    // Test that repeated imports served by the SRS import cache are
+    // identical to the first one and independent from each other
+    template<>
+    template<>
+    void object::test<8>()
+    {
+        for( int iIter = 0; iIter < 2; iIter++ )
+        {
+            OGRSpatialReference oSRS1;
+            ensure_equals("importFromEPSGA failed",
+                          oSRS1.importFromEPSGA(32631), OGRERR_NONE);
+            char* pszWKT1 = NULL;
+            oSRS1.exportToWkt(&pszWKT1);
+
+            // Modifying an imported SRS must not alter the next import
+            oSRS1.SetProjParm(SRS_PP_FALSE_NORTHING, 1000.0);
+
+            OGRSpatialReference oSRS2;
+            ensure_equals("importFromEPSGA failed",
+                          oSRS2.importFromEPSGA(32631), OGRERR_NONE);
+            char* pszWKT2 = NULL;
+            oSRS2.exportToWkt(&pszWKT2);
+            ensure_equals("EPSG import not as expected",
+                          std::string(pszWKT2), std::string(pszWKT1));
+
+            // WKT followed by an ESRI style VERTCS and trailing input
+            std::string osInput(pszWKT1);
+            osInput += ",VERTCS[\"NAVD_1988\",VDATUM[\"North_American_Vertical_Datum_1988\"],"
+                       "PARAMETER[\"Vertical_Shift\",0.0],"
+                       "PARAMETER[\"Direction\",1.0],UNIT[\"Meter\",1.0]] tail";
+            for( int iImport = 0; iImport < 2; iImport++ )
+            {
+                char* pszInput = &osInput[0];
+                OGRSpatialReference oSRS3;
+                ensure_equals("importFromWkt failed",
+                              oSRS3.importFromWkt(&pszInput), OGRERR_NONE);
+                ensure_equals("importFromWkt did not consume the input",
+                              std::string(pszInput), std::string(" tail"));
+                ensure("VERTCS not imported",
+                       oSRS3.GetAttrNode("VERTCS") != NULL);
+                ensure_equals("false_northing not as expected",
+                              oSRS3.GetProjParm(SRS_PP_FALSE_NORTHING), 0.0);
+                oSRS3.SetProjParm(SRS_PP_FALSE_NORTHING, 1000.0);
+            }
+
+            CPLFree(pszWKT1);
+            CPLFree(pszWKT2);
+
+            CPLSetConfigOption("OSR_IMPORT_CACHE_SIZE", "0");
+        }
+        CPLSetConfigOption("OSR_IMPORT_CACHE_SIZE", NULL);
+    }
 
 } // namespace tut
@@ -576,6 +576,22 @@ int main(int argc, char* argv[])
 
     assert( GDALGetCacheUsed64() == 0 );
 
+    for( int iShard = 0; iShard < GDALGetCacheShardCount(); iShard++ )
+    {
+        GIntBig nCacheUsed = 0;
+        GIntBig nHits = 0;
+        GIntBig nMisses = 0;
+        GIntBig nEvictions = 0;
+        int bRet = GDALGetCacheShardStatistics(iShard, &nCacheUsed, &nHits,
+                                               &nMisses, &nEvictions);
+        assert( bRet );
+        (void)bRet;
+        assert( nCacheUsed == 0 );
+        CPLDebug("TEST", "Shard %d: hits = " CPL_FRMT_GIB
+                 ", misses = " CPL_FRMT_GIB ", evictions = " CPL_FRMT_GIB,
+                 iShard, nHits, nMisses, nEvictions);
+    }
+
     GDALDestroyDriverManager();
     CSLDestroy( argv );
 
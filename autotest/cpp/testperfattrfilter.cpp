@@ -0,0 +1,165 @@
+/******************************************************************************
+ * $Id$
+ *
+ * Project:  OGR Core
+ * Purpose:  Test performance of attribute filter evaluation.
+ * Author:   agent, <agent at local>
+ *
+ ******************************************************************************
+ * Copyright (c) 2026, agent <agent at local>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ ****************************************************************************/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <time.h>
+
+#include <vector>
+
+#include "cpl_conv.h"
+#include "ogr_feature.h"
+
+// Evaluates attribute filters on in-memory features, with the tree
+// evaluator (OGR_FEATURE_QUERY_COMPILE=NO) and with the compiled program,
+// checks that the results are identical and prints the timings.
+
+static const int FEATURE_COUNT = 1000000;
+
+static double TimeFilter( OGRFeatureDefn* poDefn, const char* pszFilter,
+                          const std::vector<OGRFeature*>& apoFeatures,
+                          int nIters, std::vector<char>& abResults )
+{
+    OGRFeatureQuery oQuery;
+    if( oQuery.Compile( poDefn, pszFilter ) != OGRERR_NONE )
+        return -1.0;
+
+    abResults.resize( apoFeatures.size() );
+    clock_t start = clock();
+    for( int iIter = 0; iIter < nIters; iIter++ )
+    {
+        for( size_t i = 0; i < apoFeatures.size(); i++ )
+        {
+            abResults[i] = static_cast<char>(
+                oQuery.Evaluate( apoFeatures[i] ));
+        }
+    }
+    clock_t end = clock();
+    return (end - start) * 1.0 / CLOCKS_PER_SEC;
+}
+
+int main(int argc, char* argv[])
+{
+    int nIters = 1;
+    if( argc == 2 )
+        nIters = atoi(argv[1]);
+
+    OGRFeatureDefn* poDefn = new OGRFeatureDefn("test");
+    poDefn->Reference();
+    OGRFieldDefn oIntField("intfield", OFTInteger);
+    poDefn->AddFieldDefn(&oIntField);
+    OGRFieldDefn oInt64Field("int64field", OFTInteger64);
+    poDefn->AddFieldDefn(&oInt64Field);
+    OGRFieldDefn oRealField("realfield", OFTReal);
+    poDefn->AddFieldDefn(&oRealField);
+    OGRFieldDefn oStrField("strfield", OFTString);
+    poDefn->AddFieldDefn(&oStrField);
+    OGRFieldDefn oDateTimeField("dtfield", OFTDateTime);
+    poDefn->AddFieldDefn(&oDateTimeField);
+
+    std::vector<OGRFeature*> apoFeatures;
+    srand(0);
+    for( int i = 0; i < FEATURE_COUNT; i++ )
+    {
+        OGRFeature* poFeature = new OGRFeature(poDefn);
+        poFeature->SetFID(i);
+        if( i % 17 != 0 )
+            poFeature->SetField(0, rand() % 1000);
+        poFeature->SetField(1, static_cast<GIntBig>(rand()) * 10000);
+        if( i % 19 != 0 )
+            poFeature->SetField(2, (rand() % 100000) / 100.0);
+        if( i % 23 != 0 )
+            poFeature->SetField(3, CPLSPrintf("value_%d", rand() % 50));
+        poFeature->SetField(4, 2000 + rand() % 20, 1 + rand() % 12,
+                            1 + rand() % 28, 12, 0, 0.0f, 100);
+        apoFeatures.push_back(poFeature);
+    }
+
+    const char* const apszFilters[] = {
+        "intfield = 500",
+        "intfield > 100 AND intfield < 200",
+        "1000 > intfield",
+        "int64field >= 100000000",
+        "realfield BETWEEN 100 AND 200.5",
+        "realfield > 50 OR intfield < 10",
+        "intfield IN (1, 5, 10, 100, 500, 999)",
+        "intfield IN (1.5, 2, 500)",
+        "strfield = 'VALUE_10'",
+        "strfield <> 'value_10' AND strfield > 'value_3'",
+        "strfield IN ('value_1', 'value_2', 'value_40')",
+        "strfield LIKE 'value_1%'",
+        "strfield IS NULL OR intfield IS NULL",
+        "NOT (intfield > 500)",
+        "NOT (strfield = 'value_1') AND realfield < 2 * 100",
+        "dtfield > '2010/01/01'",
+        "FID < 1000 OR FID > 999000",
+        "intfield + 1 > 500",
+        "intfield + 1 > 500 OR strfield IS NULL",
+        "NOT (intfield * 2 < 100) AND realfield > 10",
+        "(intfield > 100 AND strfield = 'value_1') OR "
+            "(realfield < 10 AND NOT (int64field < 5))",
+        "1 = 1",
+        "intfield = 5 OR 1 = 0"
+    };
+    int nRet = 0;
+
+    for( size_t iFilter = 0;
+         iFilter < sizeof(apszFilters) / sizeof(apszFilters[0]);
+         iFilter++ )
+    {
+        const char* pszFilter = apszFilters[iFilter];
+        std::vector<char> abResults[2];
+        double adfTime[2] = { 0.0, 0.0 };
+        const char* const apszCompile[2] = { "NO", "YES" };
+
+        for( int iRun = 0; iRun < 2; iRun++ )
+        {
+            CPLSetConfigOption("OGR_FEATURE_QUERY_COMPILE", apszCompile[iRun]);
+            adfTime[iRun] = TimeFilter( poDefn, pszFilter, apoFeatures,
+                                        nIters, abResults[iRun] );
+            CPLSetConfigOption("OGR_FEATURE_QUERY_COMPILE", NULL);
+        }
+
+        size_t nMatches = 0;
+        for( size_t i = 0; i < abResults[1].size(); i++ )
+            nMatches += abResults[1][i] ? 1 : 0;
+        const bool bSame = adfTime[0] >= 0 && abResults[0] == abResults[1];
+        printf("%s : %d matches, %.2f s (tree), %.2f s (compiled)%s\n",
+               pszFilter, static_cast<int>(nMatches), adfTime[0], adfTime[1],
+               bSame ? "" : " : results differ !");
+        if( !bSame )
+            nRet = 1;
+    }
+
+    for( size_t i = 0; i < apoFeatures.size(); i++ )
+        delete apoFeatures[i];
+    poDefn->Release();
+
+    return nRet;
+}
@@ -0,0 +1,169 @@
+/******************************************************************************
+ * $Id$
+ *
+ * Project:  OGR Core
+ * Purpose:  Test performance of EPSG code resolution, from CSV tables and
+ *           from their compiled version.
+ * Author:   agent, <agent at local>
+ *
+ ******************************************************************************
+ * Copyright (c) 2026, agent <agent at local>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ ****************************************************************************/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <time.h>
+
+#include <string>
+#include <vector>
+
+#include "cpl_conv.h"
+#include "cpl_csv.h"
+#include "cpl_string.h"
+#include "ogr_spatialref.h"
+
+// Copies the CSV tables of GDAL_DATA into a temporary directory, compiles
+// them, and resolves EPSG codes with CPL_CSV_COMPILED=NO and YES.
+// The tables are released before each iteration so that the cost of
+// loading them, which dominates in short-lived processes, is measured.
+// The WKT of the resolved codes must be identical in both modes.
+
+static const int anColdCodes[] = { 4326, 32631, 2154, 3857, 27700, 4269,
+                                   26917, 3035, 4258, 31467 };
+
+static double Resolve( const std::vector<int>& anCodes, int nIters,
+                       std::vector<std::string>& aosWKT )
+{
+    aosWKT.clear();
+    clock_t start = clock();
+    for( int iIter = 0; iIter < nIters; iIter++ )
+    {
+        CSVDeaccess( NULL );
+        for( size_t i = 0; i < anCodes.size(); i++ )
+        {
+            OGRSpatialReference oSRS;
+            std::string osWKT;
+            if( oSRS.importFromEPSG( anCodes[i] ) == OGRERR_NONE )
+            {
+                char* pszWKT = NULL;
+                oSRS.exportToWkt( &pszWKT );
+                osWKT = pszWKT;
+                CPLFree( pszWKT );
+            }
+            if( iIter == 0 )
+                aosWKT.push_back( osWKT );
+        }
+    }
+    clock_t end = clock();
+    return (end - start) * 1.0 / CLOCKS_PER_SEC;
+}
+
+int main(int argc, char* argv[])
+{
+    int nIters = 20;
+    if( argc == 2 )
+        nIters = atoi(argv[1]);
+
+    const char* pszGCS = CPLFindFile( "gdal", "gcs.csv" );
+    if( pszGCS == NULL )
+    {
+        fprintf( stderr, "Cannot find gcs.csv. Set GDAL_DATA\n" );
+        return 1;
+    }
+    const std::string osDataDir( CPLGetPath( pszGCS ) );
+    const std::string osTmpDir( CPLGenerateTempFilename( "testperfepsg" ) );
+    VSIMkdir( osTmpDir.c_str(), 0755 );
+
+    char** papszFiles = VSIReadDir( osDataDir.c_str() );
+    for( int i = 0; papszFiles != NULL && papszFiles[i] != NULL; i++ )
+    {
+        if( !EQUAL(CPLGetExtension(papszFiles[i]), "csv") )
+            continue;
+        const std::string osSrc(
+            CPLFormFilename( osDataDir.c_str(), papszFiles[i], NULL ) );
+        const std::string osDst(
+            CPLFormFilename( osTmpDir.c_str(), papszFiles[i], NULL ) );
+        if( CPLCopyFile( osDst.c_str(), osSrc.c_str() ) != 0 ||
+            !CSVCompile( osDst.c_str(), NULL ) )
+        {
+            fprintf( stderr, "Cannot copy and compile %s\n", osSrc.c_str() );
+        }
+    }
+    CSLDestroy( papszFiles );
+    CPLSetConfigOption( "GDAL_DATA", osTmpDir.c_str() );
+    // Measure the table lookups, not the SRS import cache.
+    CPLSetConfigOption( "OSR_IMPORT_CACHE_SIZE", "0" );
+
+    std::vector<int> anCold( anColdCodes,
+                             anColdCodes + sizeof(anColdCodes) /
+                                           sizeof(anColdCodes[0]) );
+    std::vector<int> anMany;
+    for( int nCode = 2000; nCode < 2400; nCode++ )
+        anMany.push_back( nCode );
+    for( int nCode = 4200; nCode < 4400; nCode++ )
+        anMany.push_back( nCode );
+    for( int nCode = 32601; nCode <= 32660; nCode++ )
+        anMany.push_back( nCode );
+
+    CPLPushErrorHandler( CPLQuietErrorHandler );
+
+    int nRet = 0;
+    const char* const apszCompiled[2] = { "NO", "YES" };
+    const char* const apszTestNames[2] = { "cold start, 10 codes",
+                                           "cold start, 660 codes" };
+    const std::vector<int>* apanCodes[2] = { &anCold, &anMany };
+    for( int iTest = 0; iTest < 2; iTest++ )
+    {
+        const int nTestIters = iTest == 0 ? nIters * 10 : nIters;
+        std::vector<std::string> aosWKT[2];
+        double adfTime[2] = { 0.0, 0.0 };
+        for( int iRun = 0; iRun < 2; iRun++ )
+        {
+            CPLSetConfigOption( "CPL_CSV_COMPILED", apszCompiled[iRun] );
+            adfTime[iRun] = Resolve( *apanCodes[iTest], nTestIters,
+                                     aosWKT[iRun] );
+            CPLSetConfigOption( "CPL_CSV_COMPILED", NULL );
+        }
+
+        size_t nResolved = 0;
+        for( size_t i = 0; i < aosWKT[1].size(); i++ )
+            nResolved += aosWKT[1][i].empty() ? 0 : 1;
+        const bool bSame = aosWKT[0] == aosWKT[1] && nResolved > 0;
+        printf( "%s (%d codes resolved) x %d : %.3f s (CSV), "
+                "%.3f s (compiled)%s\n",
+                apszTestNames[iTest], static_cast<int>(nResolved),
+                nTestIters, adfTime[0], adfTime[1],
+                bSame ? "" : " : results differ !" );
+        if( !bSame )
+            nRet = 1;
+    }
+
+    CPLPopErrorHandler();
+
+    CSVDeaccess( NULL );
+    papszFiles = VSIReadDir( osTmpDir.c_str() );
+    for( int i = 0; papszFiles != NULL && papszFiles[i] != NULL; i++ )
+        VSIUnlink( CPLFormFilename( osTmpDir.c_str(), papszFiles[i], NULL ) );
+    CSLDestroy( papszFiles );
+    VSIRmdir( osTmpDir.c_str() );
+
+    return nRet;
+}
@@ -0,0 +1,321 @@
+/******************************************************************************
+ * $Id$
+ *
+ * Project:  GDAL Core
+ * Purpose:  Test performance of reading and writing MRF datasets with
+ *           multithreaded page decoding and encoding.
+ * Author:   agent, <agent at local>
+ *
+ ******************************************************************************
+ * Copyright (c) 2026, agent <agent at local>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ ****************************************************************************/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <string>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/time.h>
+#endif
+
+#include "cpl_conv.h"
+#include "cpl_string.h"
+#include "cpl_vsi.h"
+#include "gdal.h"
+
+// Writes MRF files with various compressions and interleavings, then reads
+// them entirely with GDAL_NUM_THREADS unset and set. Then does the same
+// for LERC compressed Float32 and Int16 elevation-like rasters, timing both
+// the writing and the reading. Checks that the results are identical and
+// prints the throughput in MB/s (wall clock time, as the encoding and
+// decoding are spread among threads).
+
+static const int RASTER_SIZE = 2048;
+static const int BAND_COUNT = 3;
+
+static GDALDatasetH CreateSource( GDALDriverH hMEMDrv )
+{
+    GDALDatasetH hDS = GDALCreate( hMEMDrv, "", RASTER_SIZE, RASTER_SIZE,
+                                   BAND_COUNT, GDT_Byte, NULL );
+    GByte* pabyLine = static_cast<GByte*>(CPLMalloc(RASTER_SIZE));
+    srand(0);
+    for( int iBand = 1; iBand <= BAND_COUNT; iBand++ )
+    {
+        GDALRasterBandH hBand = GDALGetRasterBand(hDS, iBand);
+        for( int iLine = 0; iLine < RASTER_SIZE; iLine++ )
+        {
+            // Smooth gradient with some noise, so that the pages compress
+            // reasonably but not trivially.
+            for( int i = 0; i < RASTER_SIZE; i++ )
+                pabyLine[i] = static_cast<GByte>(
+                    ((i + iLine) * iBand / 16 + rand() % 8) & 0xff);
+            CPL_IGNORE_RET_VAL(GDALRasterIO( hBand, GF_Write,
+                                             0, iLine, RASTER_SIZE, 1,
+                                             pabyLine, RASTER_SIZE, 1,
+                                             GDT_Byte, 0, 0 ));
+        }
+    }
+    CPLFree(pabyLine);
+    return hDS;
+}
+
+// Wall clock time in seconds, clock() would sum the time of all threads
+static double GetTime()
+{
+#ifdef _WIN32
+    return GetTickCount() * 1e-3;
+#else
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return tv.tv_sec + tv.tv_usec * 1e-6;
+#endif
+}
+
+static double ReadAll( const char* pszFilename, GDALDataType eType,
+                       int nBands, void* pBuffer, int nIters )
+{
+    double dfTime = 0.0;
+    for( int i = 0; i < nIters; i++ )
+    {
+        // Reopen each time, so that nothing comes from the block cache
+        GDALDatasetH hDS = GDALOpen(pszFilename, GA_ReadOnly);
+        if( hDS == NULL )
+            return -1.0;
+        const double dfStart = GetTime();
+        CPLErr eErr = GDALDatasetRasterIO( hDS, GF_Read,
+                                           0, 0, RASTER_SIZE, RASTER_SIZE,
+                                           pBuffer,
+                                           RASTER_SIZE, RASTER_SIZE, eType,
+                                           nBands, NULL, 0, 0, 0 );
+        dfTime += GetTime() - dfStart;
+        GDALClose(hDS);
+        if( eErr != CE_None )
+            return -1.0;
+    }
+    return dfTime;
+}
+
+static GDALDatasetH CreateElevationSource( GDALDriverH hMEMDrv,
+                                           GDALDataType eType )
+{
+    GDALDatasetH hDS = GDALCreate( hMEMDrv, "", RASTER_SIZE, RASTER_SIZE,
+                                   1, eType, NULL );
+    float* pafLine = static_cast<float*>(
+        CPLMalloc(RASTER_SIZE * sizeof(float)));
+    srand(0);
+    for( int iLine = 0; iLine < RASTER_SIZE; iLine++ )
+    {
+        for( int i = 0; i < RASTER_SIZE; i++ )
+            pafLine[i] = static_cast<float>(
+                1000 + 800 * sin(i / 200.0) * cos(iLine / 150.0) +
+                (rand() % 100) / 10.0);
+        CPL_IGNORE_RET_VAL(GDALRasterIO( GDALGetRasterBand(hDS, 1), GF_Write,
+                                         0, iLine, RASTER_SIZE, 1,
+                                         pafLine, RASTER_SIZE, 1,
+                                         GDT_Float32, 0, 0 ));
+    }
+    CPLFree(pafLine);
+    return hDS;
+}
+
+// Returns the content of a /vsimem/ file, or an empty string
+static std::string GetMemFile( const char* pszFilename )
+{
+    vsi_l_offset nLength = 0;
+    GByte* pabyData = VSIGetMemFileBuffer(pszFilename, &nLength, FALSE);
+    if( pabyData == NULL )
+        return std::string();
+    return std::string(reinterpret_cast<const char*>(pabyData),
+                       static_cast<size_t>(nLength));
+}
+
+static int TestLERC( GDALDriverH hMEMDrv, GDALDriverH hMRFDrv, int nIters,
+                     const char* pszThreads )
+{
+    const GDALDataType aeTypes[] = { GDT_Float32, GDT_Int16 };
+    const char* const apszThreads[2] = { NULL, pszThreads };
+    const char* const apszFilenames[2] = { "/vsimem/testperfmrf_0.mrf",
+                                           "/vsimem/testperfmrf_1.mrf" };
+    int nRet = 0;
+
+    for( size_t iType = 0; iType < sizeof(aeTypes) / sizeof(aeTypes[0]);
+         iType++ )
+    {
+        const GDALDataType eType = aeTypes[iType];
+        GDALDatasetH hSrcDS = CreateElevationSource( hMEMDrv, eType );
+        const size_t nSize = static_cast<size_t>(RASTER_SIZE) * RASTER_SIZE *
+                             GDALGetDataTypeSizeBytes(eType);
+        void* apBuffer[2];
+        apBuffer[0] = CPLMalloc(nSize);
+        apBuffer[1] = CPLMalloc(nSize);
+        char** papszOptions = NULL;
+        papszOptions = CSLSetNameValue(papszOptions, "COMPRESS", "LERC");
+        papszOptions = CSLSetNameValue(papszOptions, "BLOCKSIZE", "256");
+
+        double adfWriteTime[2] = { 0.0, 0.0 };
+        double adfReadTime[2] = { 0.0, 0.0 };
+        for( int iRun = 0; iRun < 2; iRun++ )
+        {
+            CPLSetConfigOption("GDAL_NUM_THREADS", apszThreads[iRun]);
+            for( int i = 0; i < nIters; i++ )
+            {
+                GDALDeleteDataset( hMRFDrv, apszFilenames[iRun] );
+                const double dfStart = GetTime();
+                GDALDatasetH hDS = GDALCreateCopy( hMRFDrv,
+                                                   apszFilenames[iRun],
+                                                   hSrcDS, FALSE,
+                                                   papszOptions, NULL, NULL );
+                // Closing writes the pages still being compressed
+                if( hDS != NULL )
+                    GDALClose(hDS);
+                adfWriteTime[iRun] += GetTime() - dfStart;
+            }
+            adfReadTime[iRun] = ReadAll( apszFilenames[iRun], eType, 1,
+                                         apBuffer[iRun], nIters );
+            CPLSetConfigOption("GDAL_NUM_THREADS", NULL);
+        }
+        CSLDestroy(papszOptions);
+
+        // The written files have to be the same, not only their content
+        const bool bSame = adfReadTime[0] >= 0 && adfReadTime[1] >= 0 &&
+            memcmp( apBuffer[0], apBuffer[1], nSize ) == 0 &&
+            GetMemFile("/vsimem/testperfmrf_0.lrc") ==
+                GetMemFile("/vsimem/testperfmrf_1.lrc") &&
+            GetMemFile("/vsimem/testperfmrf_0.idx") ==
+                GetMemFile("/vsimem/testperfmrf_1.idx");
+        GDALDeleteDataset( hMRFDrv, apszFilenames[0] );
+        GDALDeleteDataset( hMRFDrv, apszFilenames[1] );
+
+        const double dfMB = 1e-6 * nSize * nIters;
+        printf("LERC %s : write %.1f MB/s (1 thread), "
+               "%.1f MB/s (GDAL_NUM_THREADS=%s), "
+               "read %.1f MB/s (1 thread), "
+               "%.1f MB/s (GDAL_NUM_THREADS=%s)%s\n",
+               GDALGetDataTypeName(eType),
+               adfWriteTime[0] > 0 ? dfMB / adfWriteTime[0] : 0.0,
+               adfWriteTime[1] > 0 ? dfMB / adfWriteTime[1] : 0.0,
+               pszThreads,
+               adfReadTime[0] > 0 ? dfMB / adfReadTime[0] : 0.0,
+               adfReadTime[1] > 0 ? dfMB / adfReadTime[1] : 0.0,
+               pszThreads,
+               bSame ? "" : " : results differ !");
+        if( !bSame )
+            nRet = 1;
+
+        CPLFree(apBuffer[0]);
+        CPLFree(apBuffer[1]);
+        GDALClose(hSrcDS);
+    }
+    return nRet;
+}
+
+int main(int argc, char* argv[])
+{
+    int nIters = 2;
+    const char* pszThreads = "ALL_CPUS";
+    if( argc >= 2 )
+        nIters = atoi(argv[1]);
+    if( argc >= 3 )
+        pszThreads = argv[2];
+
+    GDALAllRegister();
+    GDALDriverH hMEMDrv = GDALGetDriverByName("MEM");
+    GDALDriverH hMRFDrv = GDALGetDriverByName("MRF");
+    if( hMEMDrv == NULL || hMRFDrv == NULL )
+    {
+        fprintf(stderr, "MEM or MRF driver not available\n");
+        return 1;
+    }
+
+    GDALDatasetH hSrcDS = CreateSource( hMEMDrv );
+
+    const char* const apszCompress[] = { "DEFLATE", "PNG", "JPEG", "LERC" };
+    const char* const apszInterleave[] = { "BAND", "PIXEL" };
+    const char* const apszThreads[2] = { NULL, pszThreads };
+    const size_t nSize =
+        static_cast<size_t>(RASTER_SIZE) * RASTER_SIZE * BAND_COUNT;
+    GByte* apabyBuffer[2];
+    apabyBuffer[0] = static_cast<GByte*>(CPLMalloc(nSize));
+    apabyBuffer[1] = static_cast<GByte*>(CPLMalloc(nSize));
+    int nRet = 0;
+
+    for( size_t iCompress = 0;
+         iCompress < sizeof(apszCompress) / sizeof(apszCompress[0]);
+         iCompress++ )
+    {
+        for( int iInterleave = 0; iInterleave < 2; iInterleave++ )
+        {
+            const char* pszFilename = "/vsimem/testperfmrf.mrf";
+            char** papszOptions = NULL;
+            papszOptions = CSLSetNameValue(papszOptions, "COMPRESS",
+                                           apszCompress[iCompress]);
+            papszOptions = CSLSetNameValue(papszOptions, "INTERLEAVE",
+                                           apszInterleave[iInterleave]);
+            papszOptions = CSLSetNameValue(papszOptions, "BLOCKSIZE", "256");
+            GDALDatasetH hDS = GDALCreateCopy( hMRFDrv, pszFilename, hSrcDS,
+                                               FALSE, papszOptions,
+                                               NULL, NULL );
+            CSLDestroy(papszOptions);
+            if( hDS == NULL )
+            {
+                nRet = 1;
+                continue;
+            }
+            GDALClose(hDS);
+
+            double adfTime[2] = { 0.0, 0.0 };
+            for( int iRun = 0; iRun < 2; iRun++ )
+            {
+                CPLSetConfigOption("GDAL_NUM_THREADS", apszThreads[iRun]);
+                adfTime[iRun] = ReadAll( pszFilename, GDT_Byte, BAND_COUNT,
+                                         apabyBuffer[iRun], nIters );
+                CPLSetConfigOption("GDAL_NUM_THREADS", NULL);
+            }
+            GDALDeleteDataset( hMRFDrv, pszFilename );
+
+            const bool bSame = adfTime[0] >= 0 && adfTime[1] >= 0 &&
+                memcmp( apabyBuffer[0], apabyBuffer[1], nSize ) == 0;
+            const double dfMB = 1e-6 * nSize * nIters;
+            printf("%s %s : %.1f MB/s (1 thread), "
+                   "%.1f MB/s (GDAL_NUM_THREADS=%s)%s\n",
+                   apszCompress[iCompress], apszInterleave[iInterleave],
+                   adfTime[0] > 0 ? dfMB / adfTime[0] : 0.0,
+                   adfTime[1] > 0 ? dfMB / adfTime[1] : 0.0,
+                   pszThreads,
+                   bSame ? "" : " : results differ !");
+            if( !bSame )
+                nRet = 1;
+        }
+    }
+
+    CPLFree(apabyBuffer[0]);
+    CPLFree(apabyBuffer[1]);
+    GDALClose(hSrcDS);
+
+    if( TestLERC( hMEMDrv, hMRFDrv, nIters, pszThreads ) != 0 )
+        nRet = 1;
+    GDALDestroyDriverManager();
+
+    return nRet;
+}
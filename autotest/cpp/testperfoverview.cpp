@@ -0,0 +1,149 @@
+/******************************************************************************
+ * $Id$
+ *
+ * Project:  GDAL Core
+ * Purpose:  Test performance of overview computation.
+ * Author:   agent, <agent at local>
+ *
+ ******************************************************************************
+ * Copyright (c) 2026, agent <agent at local>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ ****************************************************************************/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "cpl_conv.h"
+#include "gdal.h"
+
+// Computes overviews of a few data types and resampling methods, with
+// and without the AVX code paths (GDAL_USE_AVX=NO), checks that the
+// results are identical and prints the timings.
+
+static const int SRC_SIZE = 4096;
+
+static double TimeOverview( GDALRasterBandH hSrcBand, GDALRasterBandH hOvrBand,
+                            const char* pszResampling, int nIters )
+{
+    clock_t start = clock();
+    for( int i = 0; i < nIters; i++ )
+    {
+        GDALRegenerateOverviews( hSrcBand, 1, &hOvrBand, pszResampling,
+                                 NULL, NULL );
+    }
+    clock_t end = clock();
+    return (end - start) * 1.0 / CLOCKS_PER_SEC;
+}
+
+int main(int argc, char* argv[])
+{
+    int nIters = 5;
+    if( argc == 2 )
+        nIters = atoi(argv[1]);
+
+    GDALAllRegister();
+    GDALDriverH hMEMDrv = GDALGetDriverByName("MEM");
+    if( hMEMDrv == NULL )
+    {
+        fprintf(stderr, "MEM driver not available\n");
+        return 1;
+    }
+
+    const GDALDataType aeTypes[] = { GDT_Byte, GDT_UInt16, GDT_Int16,
+                                     GDT_Float32 };
+    const char* const apszResampling[] = { "AVERAGE", "GAUSS", "CUBIC",
+                                           "BILINEAR" };
+    int nRet = 0;
+
+    for( size_t iType = 0; iType < sizeof(aeTypes) / sizeof(aeTypes[0]);
+         iType++ )
+    {
+        const GDALDataType eType = aeTypes[iType];
+        GDALDatasetH hSrcDS = GDALCreate( hMEMDrv, "", SRC_SIZE, SRC_SIZE, 1,
+                                          eType, NULL );
+        GDALRasterBandH hSrcBand = GDALGetRasterBand(hSrcDS, 1);
+        float* pafLine = static_cast<float*>(
+            CPLMalloc(SRC_SIZE * sizeof(float)));
+        srand(0);
+        for( int iLine = 0; iLine < SRC_SIZE; iLine++ )
+        {
+            for( int i = 0; i < SRC_SIZE; i++ )
+                pafLine[i] = static_cast<float>(rand() % 256) +
+                    (eType == GDT_Float32 ? 0.25f * (rand() % 4) : 0.0f);
+            CPL_IGNORE_RET_VAL(GDALRasterIO( hSrcBand, GF_Write,
+                                             0, iLine, SRC_SIZE, 1,
+                                             pafLine, SRC_SIZE, 1,
+                                             GDT_Float32, 0, 0 ));
+        }
+        CPLFree(pafLine);
+
+        for( size_t iResampling = 0;
+             iResampling < sizeof(apszResampling) / sizeof(apszResampling[0]);
+             iResampling++ )
+        {
+            const char* pszResampling = apszResampling[iResampling];
+            const int nOvrSize = SRC_SIZE / 2;
+            const int nDTSize = GDALGetDataTypeSizeBytes(eType);
+            void* apOut[2] = { NULL, NULL };
+            double adfTime[2] = { 0.0, 0.0 };
+            const char* const apszUseAVX[2] = { "NO", "YES" };
+
+            for( int iRun = 0; iRun < 2; iRun++ )
+            {
+                GDALDatasetH hOvrDS = GDALCreate( hMEMDrv, "",
+                                                  nOvrSize, nOvrSize, 1,
+                                                  eType, NULL );
+                GDALRasterBandH hOvrBand = GDALGetRasterBand(hOvrDS, 1);
+                CPLSetConfigOption("GDAL_USE_AVX", apszUseAVX[iRun]);
+                adfTime[iRun] = TimeOverview( hSrcBand, hOvrBand,
+                                              pszResampling, nIters );
+                CPLSetConfigOption("GDAL_USE_AVX", NULL);
+                apOut[iRun] = CPLMalloc(
+                    static_cast<size_t>(nOvrSize) * nOvrSize * nDTSize);
+                CPL_IGNORE_RET_VAL(GDALRasterIO( hOvrBand, GF_Read,
+                                                 0, 0, nOvrSize, nOvrSize,
+                                                 apOut[iRun],
+                                                 nOvrSize, nOvrSize,
+                                                 eType, 0, 0 ));
+                GDALClose(hOvrDS);
+            }
+
+            const bool bSame = memcmp( apOut[0], apOut[1],
+                static_cast<size_t>(nOvrSize) * nOvrSize * nDTSize ) == 0;
+            printf("%s %s : %.2f s (GDAL_USE_AVX=NO), %.2f s "
+                   "(GDAL_USE_AVX=YES)%s\n",
+                   GDALGetDataTypeName(eType), pszResampling,
+                   adfTime[0], adfTime[1],
+                   bSame ? "" : " : results differ !");
+            if( !bSame )
+                nRet = 1;
+            CPLFree(apOut[0]);
+            CPLFree(apOut[1]);
+        }
+
+        GDALClose(hSrcDS);
+    }
+
+    GDALDestroyDriverManager();
+
+    return nRet;
+}
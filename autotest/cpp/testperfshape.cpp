@@ -0,0 +1,272 @@
+/******************************************************************************
+ * $Id$
+ *
+ * Project:  GDAL Core
+ * Purpose:  Test performance of sequential reading of shapefiles.
+ * Author:   agent, <agent at local>
+ *
+ ******************************************************************************
+ * Copyright (c) 2026, agent <agent at local>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ ****************************************************************************/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <algorithm>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/time.h>
+#endif
+
+#include "cpl_conv.h"
+#include "cpl_string.h"
+#include "cpl_vsi.h"
+#include "gdal.h"
+#include "ogr_api.h"
+
+// Writes a polygon shapefile with a spatial index, and a copy of it in a
+// .zip, then reads them entirely, and with a spatial filter, with
+// SHAPE_READ_AHEAD_SIZE=0 and with the default read-ahead. Checks that the
+// results are identical and prints the throughput in features/s.
+
+static const int FEATURE_COUNT = 200000;
+
+// Wall clock time in seconds, as most of the time is spent in I/O
+static double GetTime()
+{
+#ifdef _WIN32
+    return GetTickCount() * 1e-3;
+#else
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return tv.tv_sec + tv.tv_usec * 1e-6;
+#endif
+}
+
+static bool CreateSource( const char* pszFilename )
+{
+    GDALDriverH hDrv = GDALGetDriverByName("ESRI Shapefile");
+    if( hDrv == NULL )
+        return false;
+    GDALDatasetH hDS = GDALCreate( hDrv, pszFilename, 0, 0, 0, GDT_Unknown,
+                                   NULL );
+    if( hDS == NULL )
+        return false;
+    OGRLayerH hLayer = GDALDatasetCreateLayer( hDS, "testperfshape", NULL,
+                                               wkbPolygon, NULL );
+    OGRFieldDefnH hFieldDefn = OGR_Fld_Create( "id", OFTInteger );
+    OGR_L_CreateField( hLayer, hFieldDefn, TRUE );
+    OGR_Fld_Destroy( hFieldDefn );
+    hFieldDefn = OGR_Fld_Create( "name", OFTString );
+    OGR_Fld_SetWidth( hFieldDefn, 32 );
+    OGR_L_CreateField( hLayer, hFieldDefn, TRUE );
+    OGR_Fld_Destroy( hFieldDefn );
+
+    srand(0);
+    OGRFeatureDefnH hFDefn = OGR_L_GetLayerDefn( hLayer );
+    for( int i = 0; i < FEATURE_COUNT; i++ )
+    {
+        OGRFeatureH hFeat = OGR_F_Create( hFDefn );
+        OGR_F_SetFieldInteger( hFeat, 0, i );
+        OGR_F_SetFieldString( hFeat, 1, CPLSPrintf("feature %d", i) );
+
+        // Small polygons with a variable number of vertices, so that the
+        // records do not all have the same size.
+        const double dfX = (rand() % 36000) / 100.0 - 180.0;
+        const double dfY = (rand() % 18000) / 100.0 - 90.0;
+        const int nPoints = 5 + rand() % 40;
+        OGRGeometryH hRing = OGR_G_CreateGeometry( wkbLinearRing );
+        for( int j = 0; j < nPoints; j++ )
+        {
+            const double dfAngle = 2 * 3.14159265358979 * j / nPoints;
+            OGR_G_AddPoint_2D( hRing, dfX + 0.01 * cos(dfAngle),
+                                      dfY + 0.01 * sin(dfAngle) );
+        }
+        OGR_G_AddPoint_2D( hRing, dfX + 0.01, dfY );
+        OGRGeometryH hPoly = OGR_G_CreateGeometry( wkbPolygon );
+        OGR_G_AddGeometryDirectly( hPoly, hRing );
+        OGR_F_SetGeometryDirectly( hFeat, hPoly );
+
+        CPL_IGNORE_RET_VAL(OGR_L_CreateFeature( hLayer, hFeat ));
+        OGR_F_Destroy( hFeat );
+    }
+    GDALClose(hDS);
+    return true;
+}
+
+// Copies the .shp, .shx and .dbf files in a .zip
+static bool CreateZip( const char* pszShpFilename, const char* pszZipFilename )
+{
+    const char* const apszExt[] = { "shp", "shx", "dbf" };
+    for( size_t i = 0; i < sizeof(apszExt) / sizeof(apszExt[0]); i++ )
+    {
+        CPLString osSrc( CPLResetExtension(pszShpFilename, apszExt[i]) );
+        CPLString osDst( CPLSPrintf("/vsizip/%s/%s", pszZipFilename,
+                                    CPLGetFilename(osSrc)) );
+        VSILFILE* fpSrc = VSIFOpenL( osSrc, "rb" );
+        VSILFILE* fpDst = VSIFOpenL( osDst, "wb" );
+        bool bOK = fpSrc != NULL && fpDst != NULL;
+        GByte abyBuffer[65536];
+        while( bOK )
+        {
+            const size_t nRead = VSIFReadL( abyBuffer, 1, sizeof(abyBuffer),
+                                            fpSrc );
+            if( nRead == 0 )
+                break;
+            bOK = VSIFWriteL( abyBuffer, 1, nRead, fpDst ) == nRead;
+        }
+        if( fpSrc != NULL )
+            VSIFCloseL( fpSrc );
+        if( fpDst != NULL )
+            VSIFCloseL( fpDst );
+        if( !bOK )
+            return false;
+    }
+    return true;
+}
+
+// Reads all the features, and returns a checksum of their content
+static double ReadAll( const char* pszFilename, const char* pszReadAhead,
+                       bool bSpatialFilter, int nIters,
+                       GIntBig* pnFeatures, GIntBig* pnChecksum )
+{
+    CPLSetConfigOption("SHAPE_READ_AHEAD_SIZE", pszReadAhead);
+    double dfTime = 0.0;
+    *pnFeatures = 0;
+    *pnChecksum = 0;
+    for( int i = 0; i < nIters; i++ )
+    {
+        // Reopen each time, so that nothing comes from previous reads
+        GDALDatasetH hDS = GDALOpenEx( pszFilename, GDAL_OF_VECTOR,
+                                       NULL, NULL, NULL );
+        if( hDS == NULL )
+        {
+            dfTime = -1.0;
+            break;
+        }
+        OGRLayerH hLayer = GDALDatasetGetLayer(hDS, 0);
+        const double dfStart = GetTime();
+        if( bSpatialFilter )
+            OGR_L_SetSpatialFilterRect( hLayer, -60, -30, 60, 30 );
+        OGRFeatureH hFeat;
+        while( (hFeat = OGR_L_GetNextFeature(hLayer)) != NULL )
+        {
+            OGRGeometryH hGeom = OGR_F_GetGeometryRef(hFeat);
+            (*pnFeatures) ++;
+            *pnChecksum += OGR_F_GetFieldAsInteger(hFeat, 0) +
+                           strlen(OGR_F_GetFieldAsString(hFeat, 1));
+            if( hGeom != NULL )
+                *pnChecksum += OGR_G_GetPointCount(
+                                        OGR_G_GetGeometryRef(hGeom, 0));
+            OGR_F_Destroy(hFeat);
+        }
+        dfTime += GetTime() - dfStart;
+        GDALClose(hDS);
+    }
+    CPLSetConfigOption("SHAPE_READ_AHEAD_SIZE", NULL);
+    return dfTime;
+}
+
+int main(int argc, char* argv[])
+{
+    int nIters = 3;
+    if( argc >= 2 )
+        nIters = atoi(argv[1]);
+
+    GDALAllRegister();
+
+    CPLString osDir( CPLGenerateTempFilename("testperfshape") );
+    VSIMkdir( osDir, 0755 );
+    CPLString osShp( CPLFormFilename(osDir, "testperfshape", "shp") );
+    CPLString osZip( CPLFormFilename(osDir, "testperfshape", "zip") );
+    if( !CreateSource( osShp ) || !CreateZip( osShp, osZip ) )
+    {
+        fprintf(stderr, "Cannot create %s\n", osShp.c_str());
+        return 1;
+    }
+
+    // Spatial index, only on the local file
+    GDALDatasetH hDS = GDALOpenEx( osShp, GDAL_OF_VECTOR | GDAL_OF_UPDATE,
+                                   NULL, NULL, NULL );
+    GDALDatasetReleaseResultSet( hDS,
+        GDALDatasetExecuteSQL( hDS, "CREATE SPATIAL INDEX ON testperfshape",
+                               NULL, NULL ) );
+    GDALClose(hDS);
+
+    CPLString osZipShp( CPLSPrintf("/vsizip/%s/testperfshape.shp",
+                                   osZip.c_str()) );
+    const char* const apszSources[] = { osShp.c_str(), osZipShp.c_str() };
+    const char* const apszSourceNames[] = { "local", "/vsizip/" };
+    const char* const apszReadAhead[2] = { "0", NULL };
+    int nRet = 0;
+
+    for( int iSource = 0; iSource < 2; iSource++ )
+    {
+        for( int iFilter = 0; iFilter < 2; iFilter++ )
+        {
+            // The .qix is not in the .zip
+            if( iFilter && iSource == 1 )
+                continue;
+
+            double adfTime[2] = { 0.0, 0.0 };
+            GIntBig anFeatures[2] = { 0, 0 };
+            GIntBig anChecksum[2] = { 0, 0 };
+            for( int iRun = 0; iRun < 2; iRun++ )
+            {
+                adfTime[iRun] = ReadAll( apszSources[iSource],
+                                         apszReadAhead[iRun], iFilter != 0,
+                                         nIters, &anFeatures[iRun],
+                                         &anChecksum[iRun] );
+            }
+
+            const char* pszTest = CPLSPrintf("%s%s", apszSourceNames[iSource],
+                                             iFilter ? ", .qix filter" : "");
+            if( adfTime[0] < 0 || adfTime[1] < 0 )
+            {
+                fprintf(stderr, "%s: read failed\n", pszTest);
+                nRet = 1;
+                continue;
+            }
+            if( anFeatures[0] != anFeatures[1] ||
+                anChecksum[0] != anChecksum[1] )
+            {
+                fprintf(stderr, "%s: results differ with read-ahead\n",
+                        pszTest);
+                nRet = 1;
+            }
+            printf("%s: " CPL_FRMT_GIB " features, %.0f features/s without "
+                   "read-ahead, %.0f features/s with read-ahead\n",
+                   pszTest, anFeatures[0] / nIters,
+                   anFeatures[0] / std::max(adfTime[0], 1e-6),
+                   anFeatures[1] / std::max(adfTime[1], 1e-6));
+        }
+    }
+
+    GDALDriverH hDrv = GDALGetDriverByName("ESRI Shapefile");
+    GDALDeleteDataset( hDrv, osShp );
+    VSIUnlink( osZip );
+    VSIRmdir( osDir );
+
+    GDALDestroyDriverManager();
+    return nRet;
+}
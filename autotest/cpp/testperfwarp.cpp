@@ -0,0 +1,218 @@
+/******************************************************************************
+ * $Id$
+ *
+ * Project:  GDAL Core
+ * Purpose:  Test performance of warping kernels with masks.
+ * Author:   agent, <agent at local>
+ *
+ ******************************************************************************
+ * Copyright (c) 2026, agent <agent at local>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ ****************************************************************************/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "cpl_conv.h"
+#include "cpl_string.h"
+#include "gdal.h"
+#include "gdal_utils.h"
+
+// Warps multi-band rasters with source nodata, source alpha and destination
+// alpha, with bilinear and cubic resampling, using the kernels for masked
+// data and the general case (GDAL_WARP_USE_MASKED_KERNELS=NO). Checks that
+// the results are identical and prints the throughput in Mpixels/s.
+
+static const int SRC_SIZE = 1024;
+static const int DST_SIZE = 1000;
+static const int BAND_COUNT = 3;
+
+static GDALDatasetH CreateSource( GDALDriverH hMEMDrv, GDALDataType eType,
+                                  bool bAlpha )
+{
+    const int nBands = BAND_COUNT + (bAlpha ? 1 : 0);
+    GDALDatasetH hDS = GDALCreate( hMEMDrv, "", SRC_SIZE, SRC_SIZE, nBands,
+                                   eType, NULL );
+    double adfGeoTransform[6] = { 0, 1, 0, SRC_SIZE, 0, -1 };
+    GDALSetGeoTransform( hDS, adfGeoTransform );
+
+    float* pafLine = static_cast<float*>(
+        CPLMalloc(SRC_SIZE * sizeof(float)));
+    srand(0);
+    for( int iBand = 1; iBand <= nBands; iBand++ )
+    {
+        GDALRasterBandH hBand = GDALGetRasterBand(hDS, iBand);
+        if( bAlpha && iBand == nBands )
+            GDALSetRasterColorInterpretation( hBand, GCI_AlphaBand );
+        for( int iLine = 0; iLine < SRC_SIZE; iLine++ )
+        {
+            for( int i = 0; i < SRC_SIZE; i++ )
+            {
+                // Sparse zero (nodata / transparent) pixels.
+                if( rand() % 50 == 0 )
+                    pafLine[i] = 0.0f;
+                else if( bAlpha && iBand == nBands )
+                    pafLine[i] = static_cast<float>(128 + rand() % 128);
+                else
+                    pafLine[i] = static_cast<float>(1 + rand() % 255);
+            }
+            CPL_IGNORE_RET_VAL(GDALRasterIO( hBand, GF_Write,
+                                             0, iLine, SRC_SIZE, 1,
+                                             pafLine, SRC_SIZE, 1,
+                                             GDT_Float32, 0, 0 ));
+        }
+    }
+    CPLFree(pafLine);
+    return hDS;
+}
+
+int main(int argc, char* argv[])
+{
+    int nIters = 2;
+    if( argc == 2 )
+        nIters = atoi(argv[1]);
+
+    GDALAllRegister();
+    GDALDriverH hMEMDrv = GDALGetDriverByName("MEM");
+    if( hMEMDrv == NULL )
+    {
+        fprintf(stderr, "MEM driver not available\n");
+        return 1;
+    }
+
+    const GDALDataType aeTypes[] = { GDT_Byte, GDT_UInt16, GDT_Int16,
+                                     GDT_Float32 };
+    const char* const apszResampling[] = { "bilinear", "cubic" };
+    const char* const apszMaskModes[] = { "nodata", "alpha" };
+    const char* const apszUseMaskedKernels[2] = { "NO", "YES" };
+    int nRet = 0;
+
+    for( size_t iType = 0; iType < sizeof(aeTypes) / sizeof(aeTypes[0]);
+         iType++ )
+    {
+        const GDALDataType eType = aeTypes[iType];
+        for( int iMaskMode = 0; iMaskMode < 2; iMaskMode++ )
+        {
+            const bool bAlpha = iMaskMode == 1;
+            GDALDatasetH hSrcDS = CreateSource( hMEMDrv, eType, bAlpha );
+
+            for( size_t iResampling = 0;
+                 iResampling < sizeof(apszResampling) /
+                               sizeof(apszResampling[0]);
+                 iResampling++ )
+            {
+                CPLStringList aosOptions;
+                aosOptions.AddString("-of");
+                aosOptions.AddString("MEM");
+                aosOptions.AddString("-r");
+                aosOptions.AddString(apszResampling[iResampling]);
+                aosOptions.AddString("-ts");
+                aosOptions.AddString(CPLSPrintf("%d", DST_SIZE));
+                aosOptions.AddString(CPLSPrintf("%d", DST_SIZE));
+                aosOptions.AddString("-te");
+                aosOptions.AddString("10.3");
+                aosOptions.AddString("10.7");
+                aosOptions.AddString(CPLSPrintf("%f", SRC_SIZE - 10.7));
+                aosOptions.AddString(CPLSPrintf("%f", SRC_SIZE - 10.3));
+                if( bAlpha )
+                {
+                    aosOptions.AddString("-dstalpha");
+                }
+                else
+                {
+                    aosOptions.AddString("-srcnodata");
+                    aosOptions.AddString("0");
+                    aosOptions.AddString("-dstnodata");
+                    aosOptions.AddString("0");
+                }
+                GDALWarpAppOptions* psOptions =
+                    GDALWarpAppOptionsNew(aosOptions.List(), NULL);
+
+                GDALDatasetH ahOut[2] = { NULL, NULL };
+                double adfTime[2] = { 0.0, 0.0 };
+                for( int iRun = 0; iRun < 2; iRun++ )
+                {
+                    CPLSetConfigOption("GDAL_WARP_USE_MASKED_KERNELS",
+                                       apszUseMaskedKernels[iRun]);
+                    clock_t start = clock();
+                    for( int i = 0; i < nIters; i++ )
+                    {
+                        if( ahOut[iRun] )
+                            GDALClose(ahOut[iRun]);
+                        ahOut[iRun] = GDALWarp( "", NULL, 1, &hSrcDS,
+                                                psOptions, NULL );
+                    }
+                    clock_t end = clock();
+                    CPLSetConfigOption("GDAL_WARP_USE_MASKED_KERNELS", NULL);
+                    adfTime[iRun] = (end - start) * 1.0 / CLOCKS_PER_SEC;
+                }
+                GDALWarpAppOptionsFree(psOptions);
+
+                bool bSame = ahOut[0] != NULL && ahOut[1] != NULL;
+                const int nOutBands =
+                    bSame ? GDALGetRasterCount(ahOut[0]) : 0;
+                const int nDTSize = GDALGetDataTypeSizeBytes(eType);
+                const size_t nSize =
+                    static_cast<size_t>(DST_SIZE) * DST_SIZE * nDTSize;
+                void* apBuffer[2];
+                apBuffer[0] = CPLMalloc(nSize);
+                apBuffer[1] = CPLMalloc(nSize);
+                for( int iBand = 1; bSame && iBand <= nOutBands; iBand++ )
+                {
+                    for( int iRun = 0; iRun < 2; iRun++ )
+                    {
+                        CPL_IGNORE_RET_VAL(GDALRasterIO(
+                            GDALGetRasterBand(ahOut[iRun], iBand), GF_Read,
+                            0, 0, DST_SIZE, DST_SIZE,
+                            apBuffer[iRun], DST_SIZE, DST_SIZE,
+                            eType, 0, 0 ));
+                    }
+                    bSame = memcmp( apBuffer[0], apBuffer[1], nSize ) == 0;
+                }
+                CPLFree(apBuffer[0]);
+                CPLFree(apBuffer[1]);
+
+                const double dfMPix =
+                    1e-6 * DST_SIZE * DST_SIZE * nIters;
+                printf("%s %s %s : %.1f Mpix/s (general case), "
+                       "%.1f Mpix/s (masked kernels)%s\n",
+                       GDALGetDataTypeName(eType), apszMaskModes[iMaskMode],
+                       apszResampling[iResampling],
+                       adfTime[0] > 0 ? dfMPix / adfTime[0] : 0.0,
+                       adfTime[1] > 0 ? dfMPix / adfTime[1] : 0.0,
+                       bSame ? "" : " : results differ !");
+                if( !bSame )
+                    nRet = 1;
+                if( ahOut[0] )
+                    GDALClose(ahOut[0]);
+                if( ahOut[1] )
+                    GDALClose(ahOut[1]);
+            }
+
+            GDALClose(hSrcDS);
+        }
+    }
+
+    GDALDestroyDriverManager();
+
+    return nRet;
+}
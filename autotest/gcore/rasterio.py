@@ -885,6 +885,44 @@ def rasterio_12():
 
     return 'success'
 
+###############################################################################
+# Test reads of raw formats served from a file mapping (RAW_VIRTUAL_MEM_IO)
+
+def rasterio_13():
+
+    for interleave in [ 'BSQ', 'BIL', 'BIP' ]:
+        filename = 'tmp/rasterio_13_%s.bin' % interleave
+        ds = gdal.GetDriverByName('ENVI').Create(filename, 30, 20, 3,
+                                                 gdal.GDT_Int16,
+                                                 options = [ 'INTERLEAVE=' + interleave ])
+        for i in range(3):
+            data = ''.join([ chr((j * 7 + i * 13) % 256) for j in range(30 * 20 * 2) ])
+            ds.GetRasterBand(i+1).WriteRaster(0, 0, 30, 20, data)
+        ds = None
+
+        ref = []
+        for option in [ 'NO', 'YES' ]:
+            gdal.SetConfigOption('RAW_VIRTUAL_MEM_IO', option)
+            ds = gdal.Open(filename)
+            gdal.SetConfigOption('RAW_VIRTUAL_MEM_IO', None)
+            res = [ ds.GetRasterBand(2).ReadRaster(0, 0, 30, 20),
+                    ds.GetRasterBand(2).ReadRaster(3, 4, 10, 5),
+                    ds.GetRasterBand(2).ReadRaster(3, 4, 10, 5, buf_pixel_space = 4),
+                    ds.GetRasterBand(2).ReadRaster(3, 4, 10, 5, buf_type = gdal.GDT_Float32),
+                    ds.ReadRaster(3, 4, 10, 5),
+                    ds.ReadRaster(3, 4, 10, 5, buf_pixel_space = 6, buf_band_space = 2, buf_line_space = 60) ]
+            ds = None
+            if option == 'NO':
+                ref = res
+            elif res != ref:
+                gdaltest.post_reason('failure')
+                print(interleave)
+                return 'fail'
+
+        gdal.GetDriverByName('ENVI').Delete(filename)
+
+    return 'success'
+
 gdaltest_list = [
     rasterio_1,
     rasterio_2,
@@ -897,7 +935,8 @@ gdaltest_list = [
     rasterio_9,
     rasterio_10,
     rasterio_11,
-    rasterio_12
+    rasterio_12,
+    rasterio_13
     ]
 
 if __name__ == '__main__':
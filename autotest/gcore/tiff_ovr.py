@@ -2016,6 +2016,38 @@ def tiff_ovr_51():
 
     return 'success'
 
+###############################################################################
+# Test that computing overviews with GDAL_NUM_THREADS gives the same result
+# as the single-threaded computation.
+
+def tiff_ovr_52():
+
+    src_ds = gdal.Open('data/byte.tif')
+    for interleave in [ 'BAND', 'PIXEL' ]:
+        for resampling in [ 'NEAREST', 'AVERAGE', 'GAUSS', 'CUBIC', 'MODE' ]:
+            if interleave == 'PIXEL' and resampling == 'MODE':
+                continue
+            cs = []
+            for num_threads in [ None, '4' ]:
+                filename = '/vsimem/tiff_ovr_52.tif'
+                ds = gdal.Translate(filename, src_ds,
+                                    options = '-b 1 -b 1 -b 1 -outsize 200 300 -a_nodata 107 -co COMPRESS=DEFLATE -co BLOCKYSIZE=16 -co INTERLEAVE=' + interleave)
+                gdal.SetConfigOption('GDAL_NUM_THREADS', num_threads)
+                ds.BuildOverviews(resampling, overviewlist = [2, 3, 7])
+                gdal.SetConfigOption('GDAL_NUM_THREADS', None)
+                ds = None
+                ds = gdal.Open(filename)
+                cs.append([ ds.GetRasterBand(i+1).GetOverview(j).Checksum()
+                            for i in range(3) for j in range(3) ])
+                ds = None
+                gdal.Unlink(filename)
+            if cs[0] != cs[1]:
+                gdaltest.post_reason('fail')
+                print(interleave, resampling)
+                print(cs)
+                return 'fail'
+
+    return 'success'
 
 ###############################################################################
 # Cleanup
@@ -2132,7 +2164,7 @@ for item in gdaltest_list_internal:
         gdaltest_list.append( (item, item.__name__ + '_inverted') )
 gdaltest_list.append(tiff_ovr_restore_endianness)
 
-gdaltest_list += [ tiff_ovr_51 ]
+gdaltest_list += [ tiff_ovr_51, tiff_ovr_52 ]
 
 if __name__ == '__main__':
 
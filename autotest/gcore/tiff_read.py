@@ -2451,6 +2451,57 @@ def tiff_read_one_strip_no_bytecount():
 
     return 'success'
 
+###############################################################################
+# Test multi-threaded decoding of strips and tiles (NUM_THREADS open option)
+
+def tiff_read_multi_threaded():
+
+    for (src_filename, options) in [
+            ('data/utmsmall.tif', ['COMPRESS=DEFLATE', 'BLOCKYSIZE=7']),
+            ('data/utmsmall.tif', ['COMPRESS=LZW', 'PREDICTOR=2', 'TILED=YES',
+                                   'BLOCKXSIZE=16', 'BLOCKYSIZE=16']),
+            ('data/rgbsmall.tif', ['COMPRESS=PACKBITS', 'TILED=YES',
+                                   'BLOCKXSIZE=16', 'BLOCKYSIZE=16']),
+            ('data/rgbsmall.tif', ['COMPRESS=DEFLATE', 'INTERLEAVE=BAND']),
+            ('data/rgbsmall.tif', ['COMPRESS=JPEG', 'PHOTOMETRIC=YCBCR',
+                                   'TILED=YES', 'BLOCKXSIZE=16',
+                                   'BLOCKYSIZE=16']) ]:
+        if 'COMPRESS=JPEG' in options and \
+           gdal.GetDriverByName('GTiff').GetMetadataItem(
+                'DMD_CREATIONOPTIONLIST').find('JPEG') < 0:
+            continue
+        gdal.GetDriverByName('GTiff').CreateCopy(
+            '/vsimem/tiff_read_multi_threaded.tif', gdal.Open(src_filename),
+            options = options)
+
+        ds = gdal.Open('/vsimem/tiff_read_multi_threaded.tif')
+        ref_data = ds.ReadRaster()
+        ref_data_band = ds.GetRasterBand(1).ReadRaster(5, 5, 40, 40)
+        ds = None
+
+        ds = gdal.OpenEx('/vsimem/tiff_read_multi_threaded.tif',
+                         open_options = ['NUM_THREADS=4'])
+        got_data = ds.ReadRaster()
+        ds = None
+        if got_data != ref_data:
+            gdaltest.post_reason('fail')
+            print(options)
+            return 'fail'
+
+        gdal.SetConfigOption('GDAL_NUM_THREADS', 'ALL_CPUS')
+        ds = gdal.Open('/vsimem/tiff_read_multi_threaded.tif')
+        gdal.SetConfigOption('GDAL_NUM_THREADS', None)
+        got_data = ds.GetRasterBand(1).ReadRaster(5, 5, 40, 40)
+        ds = None
+        if got_data != ref_data_band:
+            gdaltest.post_reason('fail')
+            print(options)
+            return 'fail'
+
+    gdal.Unlink('/vsimem/tiff_read_multi_threaded.tif')
+
+    return 'success'
+
 ###############################################################################
 
 for item in init_list:
@@ -2513,6 +2564,7 @@ gdaltest_list.append( (tiff_read_logl_as_rgba) )
 gdaltest_list.append( (tiff_read_scanline_more_than_2GB) )
 gdaltest_list.append( (tiff_read_wrong_number_extrasamples) )
 gdaltest_list.append( (tiff_read_one_strip_no_bytecount) )
+gdaltest_list.append( (tiff_read_multi_threaded) )
 
 gdaltest_list.append( (tiff_read_online_1) )
 gdaltest_list.append( (tiff_read_online_2) )
@@ -341,6 +341,77 @@ def vsicurl_test_redirect():
 
     return 'success'
 
+###############################################################################
+# Test that AdviseRead() prefetches the strips of the window and that the
+# subsequent reads are served correctly
+
+def vsicurl_test_advise_read():
+
+    if gdaltest.webserver_port == 0:
+        return 'skip'
+
+    ref_ds = gdal.Open('data/stefan_full_rgba.tif')
+    ref_cs = [ ref_ds.GetRasterBand(i+1).Checksum() for i in range(ref_ds.RasterCount) ]
+    ref_ds = None
+
+    for max_conn in [ '1', '8' ]:
+        gdal.SetConfigOption('CPL_VSIL_CURL_ADVISE_READ_MAX_CONNECTIONS', max_conn)
+        # Use a different URL at each iteration to bypass the /vsicurl/ cache
+        ds = gdal.Open('/vsicurl/http://localhost:%d/autotest/gcore/data/stefan_full_rgba.tif?conn=%s' % (gdaltest.webserver_port, max_conn))
+        gdal.SetConfigOption('CPL_VSIL_CURL_ADVISE_READ_MAX_CONNECTIONS', None)
+        if ds is None:
+            gdaltest.post_reason('fail')
+            return 'fail'
+        if ds.AdviseRead(0, 0, ds.RasterXSize, ds.RasterYSize) != 0:
+            gdaltest.post_reason('fail')
+            return 'fail'
+        cs = [ ds.GetRasterBand(i+1).Checksum() for i in range(ds.RasterCount) ]
+        ds = None
+        if cs != ref_cs:
+            gdaltest.post_reason('fail')
+            print(max_conn)
+            print(cs)
+            print(ref_cs)
+            return 'fail'
+
+    return 'success'
+
+###############################################################################
+# Test reading from a handle while another handle on the same URL prefetches,
+# since both share the region cache
+
+def vsicurl_test_advise_read_two_handles():
+
+    if gdaltest.webserver_port == 0:
+        return 'skip'
+
+    ref_ds = gdal.Open('data/stefan_full_rgba.tif')
+    ref_cs = [ ref_ds.GetRasterBand(i+1).Checksum() for i in range(ref_ds.RasterCount) ]
+    ref_ds = None
+
+    for i in range(10):
+        url = '/vsicurl/http://localhost:%d/autotest/gcore/data/stefan_full_rgba.tif?two_handles=%d' % (gdaltest.webserver_port, i)
+        ds1 = gdal.Open(url)
+        ds2 = gdal.Open(url)
+        if ds1 is None or ds2 is None:
+            gdaltest.post_reason('fail')
+            return 'fail'
+        if ds1.AdviseRead(0, 0, ds1.RasterXSize, ds1.RasterYSize) != 0:
+            gdaltest.post_reason('fail')
+            return 'fail'
+        cs2 = [ ds2.GetRasterBand(j+1).Checksum() for j in range(ds2.RasterCount) ]
+        cs1 = [ ds1.GetRasterBand(j+1).Checksum() for j in range(ds1.RasterCount) ]
+        ds1 = None
+        ds2 = None
+        if cs1 != ref_cs or cs2 != ref_cs:
+            gdaltest.post_reason('fail')
+            print(cs1)
+            print(cs2)
+            print(ref_cs)
+            return 'fail'
+
+    return 'success'
+
 ###############################################################################
 def vsicurl_stop_webserver():
 
@@ -364,6 +435,8 @@ gdaltest_list = [ vsicurl_1,
                   vsicurl_11,
                   vsicurl_start_webserver,
                   vsicurl_test_redirect,
+                  vsicurl_test_advise_read,
+                  vsicurl_test_advise_read_two_handles,
                   vsicurl_stop_webserver ]
 
 if __name__ == '__main__':
@@ -2941,6 +2941,49 @@ def gpkg_36():
     gdal.Unlink('/vsimem/gpkg_36.gpkg')
     return 'success'
 
+###############################################################################
+# Test multi-threaded encoding and decoding of tiles
+
+def gpkg_37():
+
+    if gdaltest.gpkg_dr is None:
+        return 'skip'
+    if gdaltest.png_dr is None or gdaltest.jpeg_dr is None:
+        return 'skip'
+
+    src_ds = gdal.Open('data/small_world.tif')
+    for tile_format in [ 'PNG', 'JPEG', 'PNG_JPEG' ]:
+        blobs = []
+        checksums = []
+        for num_threads in [ None, '4' ]:
+            filename = '/vsimem/gpkg_37.gpkg'
+            gdal.SetConfigOption('GDAL_NUM_THREADS', num_threads)
+            out_ds = gdaltest.gpkg_dr.CreateCopy(filename, src_ds, options = ['TILE_FORMAT=' + tile_format, 'BLOCKSIZE=64'] )
+            out_ds.BuildOverviews('NEAR', [2, 4])
+            out_ds = None
+
+            out_ds = gdal.Open(filename)
+            checksums.append([out_ds.GetRasterBand(i+1).Checksum() for i in range(4)] +
+                             [out_ds.GetRasterBand(1).GetOverview(i).Checksum() for i in range(2)])
+            data = out_ds.ReadRaster(0, 0, out_ds.RasterXSize, out_ds.RasterYSize)
+            out_ds = None
+            gdal.SetConfigOption('GDAL_NUM_THREADS', None)
+
+            out_ds = ogr.Open(filename)
+            sql_lyr = out_ds.ExecuteSQL('SELECT hex(tile_data) FROM gpkg_37 ORDER BY zoom_level, tile_row, tile_column')
+            blobs.append([f.GetField(0) for f in sql_lyr] + [data])
+            out_ds.ReleaseResultSet(sql_lyr)
+            out_ds = None
+            gdal.Unlink(filename)
+
+        if blobs[0] != blobs[1] or checksums[0] != checksums[1]:
+            gdaltest.post_reason('fail')
+            print(tile_format)
+            print(checksums)
+            return 'fail'
+
+    return 'success'
+
 ###############################################################################
 #
 
@@ -2999,6 +3042,7 @@ gdaltest_list = [
     gpkg_34,
     gpkg_35,
     gpkg_36,
+    gpkg_37,
     gpkg_cleanup,
 ]
 #gdaltest_list = [ gpkg_init, gpkg_35, gpkg_cleanup ]
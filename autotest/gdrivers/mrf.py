@@ -627,6 +627,76 @@ def mrf_versioned():
 
     return 'success'
 
+###############################################################################
+# Check that reading with page decoding done by several threads gives the
+# same result
+
+def mrf_multithreaded_read():
+
+    src_ds = gdal.Open('data/small_world.tif')
+    expected_data = src_ds.ReadRaster()
+
+    for compress in [ 'DEFLATE', 'PNG', 'LERC' ]:
+        for interleave in [ 'BAND', 'PIXEL' ]:
+            gdal.Translate('/vsimem/out.mrf', src_ds, format = 'MRF',
+                           creationOptions = [ 'COMPRESS=' + compress,
+                                               'INTERLEAVE=' + interleave,
+                                               'BLOCKSIZE=64' ])
+            for num_threads in [ None, '4' ]:
+                gdal.SetConfigOption('GDAL_NUM_THREADS', num_threads)
+                ds = gdal.Open('/vsimem/out.mrf')
+                data = ds.ReadRaster()
+                cs = ds.GetRasterBand(2).Checksum()
+                ds = None
+                gdal.SetConfigOption('GDAL_NUM_THREADS', None)
+                if data != expected_data or cs != 32302:
+                    gdaltest.post_reason('fail')
+                    print(compress, interleave, num_threads, cs)
+                    return 'fail'
+            gdal.GetDriverByName('MRF').Delete('/vsimem/out.mrf')
+
+    return 'success'
+
+###############################################################################
+# Check that writing with page encoding done by several threads gives the
+# same files
+
+def mrf_multithreaded_write():
+
+    src_ds = gdal.Open('data/small_world.tif')
+
+    for compress in [ 'DEFLATE', 'PNG', 'LERC' ]:
+        for interleave in [ 'BAND', 'PIXEL' ]:
+            files = []
+            for num_threads in [ None, '4' ]:
+                gdal.SetConfigOption('GDAL_NUM_THREADS', num_threads)
+                gdal.Translate('/vsimem/out.mrf', src_ds, format = 'MRF',
+                               creationOptions = [ 'COMPRESS=' + compress,
+                                                   'INTERLEAVE=' + interleave,
+                                                   'BLOCKSIZE=64' ])
+                gdal.SetConfigOption('GDAL_NUM_THREADS', None)
+                content = []
+                for f in gdal.ReadDir('/vsimem'):
+                    if f.startswith('out.') and f != 'out.mrf':
+                        fp = gdal.VSIFOpenL('/vsimem/' + f, 'rb')
+                        content.append(gdal.VSIFReadL(1, 10000000, fp))
+                        gdal.VSIFCloseL(fp)
+                files.append(content)
+                ds = gdal.Open('/vsimem/out.mrf')
+                cs = ds.GetRasterBand(2).Checksum()
+                ds = None
+                gdal.GetDriverByName('MRF').Delete('/vsimem/out.mrf')
+                if cs != 32302:
+                    gdaltest.post_reason('fail')
+                    print(compress, interleave, num_threads, cs)
+                    return 'fail'
+            if files[0] != files[1]:
+                gdaltest.post_reason('fail')
+                print(compress, interleave)
+                return 'fail'
+
+    return 'success'
+
 def mrf_cleanup():
 
     files = [
@@ -726,6 +796,8 @@ gdaltest_list += [ mrf_overview_external ]
 gdaltest_list += [ mrf_lerc_nodata ]
 gdaltest_list += [ mrf_cached_source ]
 gdaltest_list += [ mrf_versioned ]
+gdaltest_list += [ mrf_multithreaded_read ]
+gdaltest_list += [ mrf_multithreaded_write ]
 gdaltest_list += [ mrf_cleanup ]
 
 if __name__ == '__main__':
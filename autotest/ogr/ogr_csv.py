@@ -2447,6 +2447,181 @@ def ogr_csv_47():
 
     return 'success'
 
+###############################################################################
+# Test reading records spanning the read blocks, with the various end of
+# lines, and the multi-threaded translation of records (GDAL_NUM_THREADS)
+
+def ogr_csv_48():
+
+    content = '\xef\xbb\xbfid,str,WKT,int,big\n'
+    eols = [ '\n', '\r\n', '\r', '\n\r' ]
+    for i in range(5000):
+        content += '%d,' % (i+1)
+        if (i % 3) == 0:
+            content += '"multi\nline, with ""quotes"" %d"' % i
+        else:
+            content += 'value %d' % i
+        content += ',"POINT (%d %d)",' % (i, -i)
+        if i == 2000:
+            content += 'invalid'
+        elif (i % 7) != 0:
+            content += '%d' % i
+        if i == 3000:
+            content += ',999999999999999999999999'
+        else:
+            content += ',%d' % i
+        content += eols[i % 4]
+    gdal.FileFromMemBuffer('/vsimem/ogr_csv_48.csv', content)
+    gdal.FileFromMemBuffer('/vsimem/ogr_csv_48.csvt',
+                           'Integer,String,WKT,Integer,Integer64')
+
+    results = []
+    for num_threads in [ None, '4' ]:
+        old_val = gdal.GetConfigOption('GDAL_NUM_THREADS')
+        gdal.SetConfigOption('GDAL_NUM_THREADS', num_threads)
+        ds = ogr.Open('/vsimem/ogr_csv_48.csv')
+        gdal.SetConfigOption('GDAL_NUM_THREADS', old_val)
+        lyr = ds.GetLayer(0)
+        if lyr.GetFeatureCount() != 5000:
+            gdaltest.post_reason('fail')
+            print(lyr.GetFeatureCount())
+            return 'fail'
+
+        # Errors raised while translating in worker threads must reach
+        # the error handler of the reading thread
+        errors = []
+        def error_handler(err_type, err_no, err_msg):
+            errors.append(err_msg)
+        gdal.PushErrorHandler(error_handler)
+        dump = []
+        for f in lyr:
+            dump.append((f.GetFID(), f['id'], f['str'], f['int'],
+                         f.GetGeometryRef().ExportToWkt()))
+        gdal.PopErrorHandler()
+        if len(errors) != 2 or errors[0].find('overflow') >= 0 or \
+           errors[0].find('record 2001') < 0 or \
+           errors[1].find('overflow') < 0:
+            gdaltest.post_reason('fail')
+            print(errors)
+            return 'fail'
+
+        # Random access after a partial sequential read
+        lyr.ResetReading()
+        for i in range(10):
+            lyr.GetNextFeature()
+        f = lyr.GetFeature(4000)
+        dump.append((f.GetFID(), f['str']))
+        f = lyr.GetNextFeature()
+        dump.append((f.GetFID(), f['str']))
+        f = lyr.GetFeature(5)
+        dump.append((f.GetFID(), f['str']))
+        if lyr.GetFeature(5001) is not None:
+            gdaltest.post_reason('fail')
+            return 'fail'
+        ds = None
+        results.append(dump)
+
+    gdal.Unlink('/vsimem/ogr_csv_48.csv')
+    gdal.Unlink('/vsimem/ogr_csv_48.csvt')
+
+    dump = results[0]
+    if len(dump) != 5003 or \
+       dump[0] != (1, 1, 'multi\nline, with "quotes" 0', None, 'POINT (0 0)') or \
+       dump[1] != (2, 2, 'value 1', 1, 'POINT (1 -1)') or \
+       dump[4999][0] != 5000 or \
+       dump[5000] != (4000, 'multi\nline, with "quotes" 3999') or \
+       dump[5001] != (4001, 'value 4000') or \
+       dump[5002] != (5, 'value 4'):
+        gdaltest.post_reason('fail')
+        print(dump[0:2], dump[4999:])
+        return 'fail'
+    if results[1] != dump:
+        gdaltest.post_reason('fail')
+        return 'fail'
+
+    return 'success'
+
+###############################################################################
+# Test random reading through the FID index, and the WRITE_FID_INDEX open
+# option
+
+def ogr_csv_49():
+
+    content = 'id,str\n'
+    for i in range(1000):
+        if (i % 10) == 0:
+            content += '%d,"multi\nline %d"\r\n' % (i+1, i)
+        else:
+            content += '%d,value %d\r\n' % (i+1, i)
+    gdal.FileFromMemBuffer('/vsimem/ogr_csv_49.csv', content)
+
+    for iter in range(2):
+        ds = gdal.OpenEx('/vsimem/ogr_csv_49.csv',
+                         open_options = ['WRITE_FID_INDEX=YES'])
+        lyr = ds.GetLayer(0)
+        if lyr.GetFeatureCount() != 1000:
+            gdaltest.post_reason('fail')
+            print(iter)
+            return 'fail'
+        for fid in [ 500, 1, 1000, 11, 999, 12 ]:
+            f = lyr.GetFeature(fid)
+            if f is None or f.GetFID() != fid or f['id'] != str(fid):
+                gdaltest.post_reason('fail')
+                print(iter, fid)
+                return 'fail'
+        f = lyr.GetNextFeature()
+        if f.GetFID() != 13 or f['str'] != 'value 12':
+            gdaltest.post_reason('fail')
+            print(iter)
+            f.DumpReadable()
+            return 'fail'
+        if lyr.GetFeature(1001) is not None:
+            gdaltest.post_reason('fail')
+            print(iter)
+            return 'fail'
+        if lyr.SetNextByIndex(10) != 0:
+            gdaltest.post_reason('fail')
+            print(iter)
+            return 'fail'
+        f = lyr.GetNextFeature()
+        if f.GetFID() != 11 or f['str'] != 'multi\nline 10':
+            gdaltest.post_reason('fail')
+            print(iter)
+            f.DumpReadable()
+            return 'fail'
+        if lyr.SetNextByIndex(1000) != 0 or lyr.GetNextFeature() is not None:
+            gdaltest.post_reason('fail')
+            print(iter)
+            return 'fail'
+        if lyr.SetNextByIndex(1001) == 0:
+            gdaltest.post_reason('fail')
+            print(iter)
+            return 'fail'
+        ds = None
+
+        if gdal.VSIStatL('/vsimem/ogr_csv_49.csv.fidx') is None:
+            gdaltest.post_reason('fail')
+            print(iter)
+            return 'fail'
+
+    # The index is ignored once the file has changed
+    gdal.FileFromMemBuffer('/vsimem/ogr_csv_49.csv', content + '1001,last\n')
+    ds = ogr.Open('/vsimem/ogr_csv_49.csv')
+    lyr = ds.GetLayer(0)
+    if lyr.GetFeatureCount() != 1001:
+        gdaltest.post_reason('fail')
+        return 'fail'
+    f = lyr.GetFeature(1001)
+    if f is None or f['str'] != 'last':
+        gdaltest.post_reason('fail')
+        return 'fail'
+    ds = None
+
+    gdal.Unlink('/vsimem/ogr_csv_49.csv')
+    gdal.Unlink('/vsimem/ogr_csv_49.csv.fidx')
+
+    return 'success'
+
 ###############################################################################
 #
 
@@ -2529,6 +2704,8 @@ gdaltest_list = [
     ogr_csv_45,
     ogr_csv_46,
     ogr_csv_47,
+    ogr_csv_48,
+    ogr_csv_49,
     ogr_csv_cleanup ]
 
 if __name__ == '__main__':
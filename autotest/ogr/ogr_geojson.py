@@ -2668,6 +2668,157 @@ def ogr_geojson_54():
         return 'fail'
     return 'success'
 
+###############################################################################
+# Test streaming reading of FeatureCollection
+
+def ogr_geojson_55():
+    if gdaltest.geojson_drv is None:
+        return 'skip'
+
+    gdal.FileFromMemBuffer('/vsimem/ogr_geojson_55.json',
+"""{
+  "type": "FeatureCollection",
+  "name": "foo",
+  "features": [
+      { "type": "Feature", "id": 10, "properties": { "int": 1, "str": "a{b}[c]\\"" }, "geometry": { "type": "Point", "coordinates": [ 2, 49 ] } },
+      { "type": "Feature", "properties": { "int": 2.5, "str": null, "dt": "2016-05-18T12:34:56Z" }, "geometry": null },
+      { "type": "Feature", "id": 30, "properties": { "int": 3 }, "geometry": { "type": "Point", "coordinates": [ 3, 50 ] } }
+  ],
+  "crs": { "type": "name", "properties": { "name": "urn:ogc:def:crs:EPSG::32631" } }
+}""")
+
+    filenames = [ '/vsimem/ogr_geojson_55.json',
+                  'data/ogr_geojson_14.geojson',
+                  'data/nullvalues.geojson',
+                  'data/srs_name.geojson' ]
+    for filename in filenames:
+        ds_ref = ogr.Open(filename)
+        gdal.SetConfigOption('OGR_GEOJSON_STREAMING_THRESHOLD', '0')
+        ds = ogr.Open(filename)
+        gdal.SetConfigOption('OGR_GEOJSON_STREAMING_THRESHOLD', None)
+        lyr_ref = ds_ref.GetLayer(0)
+        lyr = ds.GetLayer(0)
+        if lyr.GetFeatureCount() != lyr_ref.GetFeatureCount():
+            gdaltest.post_reason('fail')
+            print(filename)
+            return 'fail'
+        if lyr.GetGeomType() != lyr_ref.GetGeomType():
+            gdaltest.post_reason('fail')
+            print(filename)
+            return 'fail'
+        if lyr.GetSpatialRef().IsSame(lyr_ref.GetSpatialRef()) == 0:
+            gdaltest.post_reason('fail')
+            print(filename)
+            return 'fail'
+        defn_ref = lyr_ref.GetLayerDefn()
+        defn = lyr.GetLayerDefn()
+        if defn.GetFieldCount() != defn_ref.GetFieldCount():
+            gdaltest.post_reason('fail')
+            print(filename)
+            return 'fail'
+        for i in range(defn.GetFieldCount()):
+            if defn.GetFieldDefn(i).GetName() != defn_ref.GetFieldDefn(i).GetName() or \
+               defn.GetFieldDefn(i).GetType() != defn_ref.GetFieldDefn(i).GetType():
+                gdaltest.post_reason('fail')
+                print(filename)
+                return 'fail'
+        for f_ref in lyr_ref:
+            f = lyr.GetFeature(f_ref.GetFID())
+            if f is None or f.Equal(f_ref) == 0:
+                gdaltest.post_reason('fail')
+                print(filename)
+                f_ref.DumpReadable()
+                if f is not None:
+                    f.DumpReadable()
+                return 'fail'
+        lyr.SetAttributeFilter('int > 1')
+        lyr_ref.SetAttributeFilter('int > 1')
+        if filename == '/vsimem/ogr_geojson_55.json' and \
+           lyr.GetFeatureCount() != lyr_ref.GetFeatureCount():
+            gdaltest.post_reason('fail')
+            return 'fail'
+
+    # Sequential reading, after random reading
+    gdal.SetConfigOption('OGR_GEOJSON_STREAMING_THRESHOLD', '0')
+    ds = ogr.Open('/vsimem/ogr_geojson_55.json')
+    gdal.SetConfigOption('OGR_GEOJSON_STREAMING_THRESHOLD', None)
+    lyr = ds.GetLayer(0)
+    f = lyr.GetNextFeature()
+    if f.GetFID() != 10 or f.GetField('str') != 'a{b}[c]"':
+        gdaltest.post_reason('fail')
+        f.DumpReadable()
+        return 'fail'
+    if lyr.GetFeature(30) is None or lyr.GetFeature(2) is not None:
+        gdaltest.post_reason('fail')
+        return 'fail'
+    f = lyr.GetNextFeature()
+    if f.GetFID() != 1 or f.GetGeometryRef() is not None:
+        gdaltest.post_reason('fail')
+        f.DumpReadable()
+        return 'fail'
+    f = lyr.GetNextFeature()
+    if f.GetFID() != 30:
+        gdaltest.post_reason('fail')
+        f.DumpReadable()
+        return 'fail'
+    if lyr.GetNextFeature() is not None:
+        gdaltest.post_reason('fail')
+        return 'fail'
+    if lyr.TestCapability(ogr.OLCSequentialWrite) != 0:
+        gdaltest.post_reason('fail')
+        return 'fail'
+    ds = None
+
+    # Truncated file
+    gdal.FileFromMemBuffer('/vsimem/ogr_geojson_55.json',
+"""{ "type": "FeatureCollection", "features": [
+      { "type": "Feature", "properties": {}, "geometry": null },""")
+    gdal.SetConfigOption('OGR_GEOJSON_STREAMING_THRESHOLD', '0')
+    with gdaltest.error_handler():
+        ds = ogr.Open('/vsimem/ogr_geojson_55.json')
+    gdal.SetConfigOption('OGR_GEOJSON_STREAMING_THRESHOLD', None)
+    if ds is not None:
+        gdaltest.post_reason('fail')
+        return 'fail'
+
+    gdal.Unlink('/vsimem/ogr_geojson_55.json')
+
+    return 'success'
+
+###############################################################################
+# Test that colliding ids get the same FIDs in streaming and in-memory modes
+
+def ogr_geojson_56():
+
+    gdal.FileFromMemBuffer('/vsimem/ogr_geojson_56.json',
+"""{ "type": "FeatureCollection", "features": [
+      { "type": "Feature", "id": 1, "properties": { "a": 1 }, "geometry": null },
+      { "type": "Feature", "properties": { "a": 2 }, "geometry": null },
+      { "type": "Feature", "id": 1, "properties": { "a": 3 }, "geometry": null }
+] }""")
+
+    res = []
+    for threshold in [None, '0']:
+        gdal.SetConfigOption('OGR_GEOJSON_STREAMING_THRESHOLD', threshold)
+        with gdaltest.error_handler():
+            ds = ogr.Open('/vsimem/ogr_geojson_56.json')
+            lyr = ds.GetLayer(0)
+            fids = [ (f.GetFID(), f.GetField('a')) for f in lyr ]
+            f = lyr.GetFeature(3)
+            fids.append( (f.GetFID(), f.GetField('a')) )
+        gdal.SetConfigOption('OGR_GEOJSON_STREAMING_THRESHOLD', None)
+        ds = None
+        res.append(fids)
+
+    gdal.Unlink('/vsimem/ogr_geojson_56.json')
+
+    if res[0] != [(1, 1), (2, 2), (3, 3), (3, 3)] or res[1] != res[0]:
+        gdaltest.post_reason('fail')
+        print(res)
+        return 'fail'
+
+    return 'success'
+
 gdaltest_list = [
     ogr_geojson_1,
     ogr_geojson_2,
@@ -2723,6 +2874,8 @@ gdaltest_list = [
     ogr_geojson_52,
     ogr_geojson_53,
     ogr_geojson_54,
+    ogr_geojson_55,
+    ogr_geojson_56,
     ogr_geojson_cleanup ]
 
 if __name__ == '__main__':
@@ -2078,6 +2078,144 @@ def ogr_gpkg_31():
 
     return 'success'
 
+###############################################################################
+# Test the bulk loading of the RTree, from the envelopes collected when
+# inserting features in a new layer or read from an existing table
+
+def ogr_gpkg_32_check_rtree(ds, table, expected_envelopes):
+
+    sql_lyr = ds.ExecuteSQL('SELECT COUNT(*) FROM "rtree_%s_geom"' % table)
+    count = sql_lyr.GetNextFeature().GetField(0)
+    ds.ReleaseResultSet(sql_lyr)
+    if count != len(expected_envelopes):
+        gdaltest.post_reason('fail')
+        print(table, count, len(expected_envelopes))
+        return False
+
+    for (minx, maxx, miny, maxy) in [ (-0.5, 100.5, -0.5, 100.5),
+                                      (3.5, 7.5, 2.5, 4.5),
+                                      (10.5, 10.9, 5.5, 5.9),
+                                      (-10.5, -0.5, -10.5, -0.5),
+                                      (20.5, 30.5, -0.5, 12.5) ]:
+        sql_lyr = ds.ExecuteSQL(('SELECT id FROM "rtree_%s_geom" WHERE ' + \
+            'maxx >= %f AND minx <= %f AND maxy >= %f AND miny <= %f ' + \
+            'ORDER BY id') % (table, minx, maxx, miny, maxy))
+        got_ids = [ f.GetField(0) for f in sql_lyr ]
+        ds.ReleaseResultSet(sql_lyr)
+        expected_ids = sorted([ fid for fid in expected_envelopes
+            if expected_envelopes[fid][1] >= minx and
+               expected_envelopes[fid][0] <= maxx and
+               expected_envelopes[fid][3] >= miny and
+               expected_envelopes[fid][2] <= maxy ])
+        if got_ids != expected_ids:
+            gdaltest.post_reason('fail')
+            print(table, minx, maxx, miny, maxy)
+            print(got_ids)
+            print(expected_ids)
+            return False
+
+    return True
+
+def ogr_gpkg_32():
+
+    if gdaltest.gpkg_dr is None:
+        return 'skip'
+
+    for (key, value) in [ (None, None),
+                          ('GDAL_NUM_THREADS', '2'),
+                          ('OGR_GPKG_MAX_RAM_USAGE_RTREE', '0') ]:
+        if key is not None:
+            gdal.SetConfigOption(key, value)
+
+        ds = gdaltest.gpkg_dr.CreateDataSource('/vsimem/ogr_gpkg_32.gpkg')
+        expected = {}
+        for (table, geom_type, options) in [
+                ('polygons', ogr.wkbPolygon, []),
+                ('points', ogr.wkbPoint, []),
+                ('modified', ogr.wkbPolygon, []),
+                ('polygons_no_spi', ogr.wkbPolygon, ['SPATIAL_INDEX=NO']),
+                ('points_no_spi', ogr.wkbPoint, ['SPATIAL_INDEX=NO']) ]:
+            lyr = ds.CreateLayer(table, geom_type = geom_type, options = options)
+            expected[table] = {}
+            for i in range(1000):
+                f = ogr.Feature(lyr.GetLayerDefn())
+                x = i % 40
+                y = i // 40
+                if i % 100 == 10:
+                    # Null geometries are not indexed
+                    pass
+                elif i % 100 == 20:
+                    # Neither are empty ones
+                    if geom_type == ogr.wkbPoint:
+                        f.SetGeometryDirectly(ogr.Geometry(ogr.wkbPoint))
+                    else:
+                        f.SetGeometryDirectly(ogr.CreateGeometryFromWkt('POLYGON EMPTY'))
+                elif geom_type == ogr.wkbPoint:
+                    f.SetGeometryDirectly(ogr.CreateGeometryFromWkt('POINT (%d %d)' % (x, y)))
+                else:
+                    f.SetGeometryDirectly(ogr.CreateGeometryFromWkt(
+                        'POLYGON ((%d %d,%d.75 %d,%d.75 %d.75,%d %d))' % (x, y, x, y, x, y, x, y)))
+                lyr.CreateFeature(f)
+                geom = f.GetGeometryRef()
+                if geom is not None and not geom.IsEmpty():
+                    expected[table][f.GetFID()] = geom.GetEnvelope()
+
+            if table == 'modified':
+                # The envelopes collected so far are no longer usable
+                f = ogr.Feature(lyr.GetLayerDefn())
+                f.SetFID(1)
+                f.SetGeometryDirectly(ogr.CreateGeometryFromWkt(
+                    'POLYGON ((50 50,50.75 50,50.75 50.75,50 50))'))
+                lyr.SetFeature(f)
+                expected[table][1] = f.GetGeometryRef().GetEnvelope()
+                lyr.DeleteFeature(2)
+                del expected[table][2]
+
+        for table in [ 'polygons_no_spi', 'points_no_spi' ]:
+            sql_lyr = ds.ExecuteSQL("SELECT CreateSpatialIndex('%s', 'geom')" % table)
+            ret = sql_lyr.GetNextFeature().GetField(0)
+            ds.ReleaseResultSet(sql_lyr)
+            if ret != 1:
+                gdaltest.post_reason('fail')
+                print(key, table)
+                return 'fail'
+        ds = None
+
+        if key is not None:
+            gdal.SetConfigOption(key, None)
+
+        ds = ogr.Open('/vsimem/ogr_gpkg_32.gpkg', update = 1)
+        for table in expected:
+            if not ogr_gpkg_32_check_rtree(ds, table, expected[table]):
+                print(key)
+                return 'fail'
+
+        # The triggers maintain the bulk loaded RTree
+        lyr = ds.GetLayerByName('polygons')
+        for fid in [ 3, 4, 5, 6, 7 ]:
+            lyr.DeleteFeature(fid)
+            del expected['polygons'][fid]
+        for i in range(200):
+            f = ogr.Feature(lyr.GetLayerDefn())
+            f.SetGeometryDirectly(ogr.CreateGeometryFromWkt(
+                'POLYGON ((%d 60,%d.75 60,%d.75 60.75,%d 60))' % (i, i, i, i)))
+            lyr.CreateFeature(f)
+            expected['polygons'][f.GetFID()] = f.GetGeometryRef().GetEnvelope()
+        if not ogr_gpkg_32_check_rtree(ds, 'polygons', expected['polygons']):
+            print(key)
+            return 'fail'
+
+        lyr.SetSpatialFilterRect(3.5, 2.5, 7.5, 4.5)
+        if lyr.GetFeatureCount() != 15:
+            gdaltest.post_reason('fail')
+            print(key, lyr.GetFeatureCount())
+            return 'fail'
+        ds = None
+
+        gdaltest.gpkg_dr.DeleteDataSource('/vsimem/ogr_gpkg_32.gpkg')
+
+    return 'success'
+
 ###############################################################################
 # Run test_ogrsf
 
@@ -2167,6 +2305,7 @@ gdaltest_list = [
     ogr_gpkg_29,
     ogr_gpkg_30,
     ogr_gpkg_31,
+    ogr_gpkg_32,
     ogr_gpkg_test_ogrsf,
     ogr_gpkg_cleanup,
 ]
@@ -4553,6 +4553,135 @@ def ogr_shape_99():
 
     return 'success'
 
+###############################################################################
+# Test reading with the read-ahead windows of the .shp and .dbf files
+
+def ogr_shape_100_dump(filename, spatial_filter = None):
+
+    ds = ogr.Open(filename)
+    lyr = ds.GetLayer(0)
+    featurecount = lyr.GetFeatureCount()
+    if spatial_filter is not None:
+        lyr.SetSpatialFilterRect(spatial_filter[0], spatial_filter[1],
+                                 spatial_filter[2], spatial_filter[3])
+    ret = []
+    for f in lyr:
+        ret.append(f.DumpReadableAsString())
+        # Random reads in the middle of sequential reading
+        if f.GetFID() % 97 == 0:
+            ret.append(lyr.GetFeature(featurecount - 1 - f.GetFID()).DumpReadableAsString())
+    return ret
+
+def ogr_shape_100():
+
+    ds = ogr.GetDriverByName('ESRI Shapefile').CreateDataSource('/vsimem/ogr_shape_100.shp')
+    lyr = ds.CreateLayer('ogr_shape_100', geom_type = ogr.wkbPolygon)
+    lyr.CreateField(ogr.FieldDefn('id', ogr.OFTInteger))
+    lyr.CreateField(ogr.FieldDefn('str', ogr.OFTString))
+    for i in range(1000):
+        f = ogr.Feature(lyr.GetLayerDefn())
+        f.SetField('id', i)
+        f.SetField('str', 'x' * (i % 50))
+        # Some records larger than the read-ahead windows used below
+        npoints = 2000 if (i % 250) == 100 else 3 + (i % 17)
+        x = (i % 40) * 10
+        y = (i / 40) * 10
+        wkt = 'POLYGON ((' + ','.join(['%d %d' % (x + j % 5, y + j) for j in range(npoints)]) + ',%d %d))' % (x, y)
+        f.SetGeometry(ogr.CreateGeometryFromWkt(wkt))
+        lyr.CreateFeature(f)
+    ds = None
+
+    for (filename, spatial_filter) in [ ('/vsimem/ogr_shape_100.shp', None),
+                                        ('/vsimem/ogr_shape_100.shp', [ 50, 50, 150, 150 ]),
+                                        ('/vsizip/data/poly.zip/poly.shp', None) ]:
+        ref = None
+        for read_ahead in [ '0', '100', '1000', None ]:
+            gdal.SetConfigOption('SHAPE_READ_AHEAD_SIZE', read_ahead)
+            got = ogr_shape_100_dump(filename, spatial_filter)
+            gdal.SetConfigOption('SHAPE_READ_AHEAD_SIZE', None)
+            if ref is None:
+                ref = got
+            elif got != ref:
+                gdaltest.post_reason('fail')
+                print(filename, spatial_filter, read_ahead)
+                return 'fail'
+        if len(ref) == 0:
+            gdaltest.post_reason('fail')
+            return 'fail'
+
+    ogr.GetDriverByName('ESRI Shapefile').DeleteDataSource('/vsimem/ogr_shape_100.shp')
+
+    return 'success'
+
+###############################################################################
+# Test that arcs, polygons and points decoded directly from the .shp records
+# are correct, including when the geometry of a feature rejected by the
+# attribute filter is reused for the next one.
+
+def ogr_shape_101():
+
+    tests = [ (ogr.wkbLineStringZM, [ 'LINESTRING ZM (0 0 1 2,1 1 3 4)',
+                                      'MULTILINESTRING ZM ((5 5 1 2,6 6 3 4),(7 7 5 6,8 8 7 8,9 9 9 10))',
+                                      'LINESTRING ZM (10 10 1 2,11 10 3 4,12 12 5 6)',
+                                      'LINESTRING ZM (0 0 7 8,1 1 9 10)' ]),
+              (ogr.wkbLineStringM, [ 'LINESTRING M (0 0 1,1 1 2)',
+                                     'LINESTRING M (5 5 3,6 6 4,7 7 5)',
+                                     'MULTILINESTRING M ((10 10 1,11 11 2),(12 12 3,13 13 4))',
+                                     'LINESTRING M (0 0 6,1 1 7)' ]),
+              (ogr.wkbPolygon25D, [ 'POLYGON Z ((0 0 1,0 1 2,1 1 3,0 0 1))',
+                                    'POLYGON Z ((5 5 1,5 9 2,9 9 3,9 5 4,5 5 1),(6 6 5,7 6 6,7 7 7,6 6 5))',
+                                    'MULTIPOLYGON Z (((10 10 1,10 11 2,11 11 3,10 10 1)),((20 20 4,20 21 5,21 21 6,20 20 4)))',
+                                    'POLYGON Z ((0 0 7,0 2 8,2 2 9,0 0 7))' ]),
+              (ogr.wkbPolygonM, [ 'POLYGON M ((0 0 1,0 1 2,1 1 3,0 0 1))',
+                                  'POLYGON M ((5 5 4,5 9 5,9 9 6,5 5 4))',
+                                  'POLYGON M ((10 10 7,10 11 8,11 11 9,10 10 7))',
+                                  'POLYGON M ((0 0 1,0 2 2,2 2 3,2 0 4,0 0 1))' ]),
+              (ogr.wkbPointZM, [ 'POINT ZM (0 0 1 2)',
+                                 'POINT ZM (5 5 3 4)',
+                                 'POINT ZM (10 10 5 6)',
+                                 'POINT ZM (1 1 7 8)' ]) ]
+
+    for (geom_type, wkts) in tests:
+        ds = ogr.GetDriverByName('ESRI Shapefile').CreateDataSource('/vsimem/ogr_shape_101.shp')
+        lyr = ds.CreateLayer('ogr_shape_101', geom_type = geom_type)
+        lyr.CreateField(ogr.FieldDefn('id', ogr.OFTInteger))
+        for i in range(len(wkts)):
+            f = ogr.Feature(lyr.GetLayerDefn())
+            f.SetField('id', i)
+            f.SetGeometry(ogr.CreateGeometryFromWkt(wkts[i]))
+            lyr.CreateFeature(f)
+        ds = None
+
+        ds = ogr.Open('/vsimem/ogr_shape_101.shp')
+        lyr = ds.GetLayer(0)
+        for (attr_filter, spatial_filter) in [ (None, None),
+                                               ('id = 1 OR id = 3', None),
+                                               ('id <> 1', None),
+                                               ('id >= 2', [ -1, -1, 30, 30 ]) ]:
+            lyr.SetAttributeFilter(attr_filter)
+            if spatial_filter is None:
+                lyr.SetSpatialFilter(None)
+            else:
+                lyr.SetSpatialFilterRect(spatial_filter[0], spatial_filter[1],
+                                         spatial_filter[2], spatial_filter[3])
+            count = 0
+            for f in lyr:
+                count += 1
+                got = f.GetGeometryRef().ExportToIsoWkt()
+                if got != wkts[f.GetField('id')]:
+                    gdaltest.post_reason('fail')
+                    print(attr_filter, spatial_filter, got)
+                    return 'fail'
+            if count == 0:
+                gdaltest.post_reason('fail')
+                print(geom_type, attr_filter, spatial_filter)
+                return 'fail'
+        ds = None
+
+        ogr.GetDriverByName('ESRI Shapefile').DeleteDataSource('/vsimem/ogr_shape_101.shp')
+
+    return 'success'
+
 def ogr_shape_cleanup():
 
     if gdaltest.shape_ds is None:
@@ -4693,6 +4822,8 @@ gdaltest_list = [
     ogr_shape_97,
     ogr_shape_98,
     ogr_shape_99,
+    ogr_shape_100,
+    ogr_shape_101,
     ogr_shape_cleanup ]
 
 #gdaltest_list = [ ogr_shape_99 ]
@@ -1513,6 +1513,310 @@ def ogr_sql_47():
     return 'success'
 
 
+###############################################################################
+# Test LIMIT / OFFSET, and ORDER BY with the top-K and external sort paths
+
+def ogr_sql_48():
+
+    ds = ogr.GetDriverByName('Memory').CreateDataSource('')
+    lyr = ds.CreateLayer('test')
+    lyr.CreateField(ogr.FieldDefn('intfield', ogr.OFTInteger))
+    lyr.CreateField(ogr.FieldDefn('strfield', ogr.OFTString))
+    values = []
+    for i in range(1000):
+        f = ogr.Feature(lyr.GetLayerDefn())
+        f['intfield'] = (i * 7919) % 101
+        if i % 13 != 0:
+            f['strfield'] = 'val%d' % ((i * 31) % 17)
+        lyr.CreateFeature(f)
+        values.append((f['intfield'], f['strfield'], f.GetFID()))
+
+    # Python's sort is stable, as is the OGR SQL one
+    expected_int = [v[2] for v in sorted(values, key=lambda v: -v[0])]
+    expected_str = [v[2] for v in
+                    sorted(values, key=lambda v: (v[1] is not None, v[1]))]
+
+    for max_mem in [None, '1000']:
+        gdal.SetConfigOption('OGR_SQL_SORT_MAX_MEMORY', max_mem)
+
+        tests = [
+            ('SELECT * FROM test LIMIT 5', list(range(5))),
+            ('SELECT * FROM test LIMIT 5 OFFSET 995', list(range(995,1000))),
+            ('SELECT * FROM test LIMIT 0', []),
+            ('SELECT * FROM test LIMIT 5 OFFSET 1000', []),
+            ('SELECT * FROM test ORDER BY intfield DESC', expected_int),
+            ('SELECT * FROM test ORDER BY intfield DESC LIMIT 30',
+                expected_int[0:30]),
+            ('SELECT * FROM test ORDER BY intfield DESC LIMIT 30 OFFSET 500',
+                expected_int[500:530]),
+            ('SELECT * FROM test ORDER BY strfield', expected_str),
+            ('SELECT * FROM test ORDER BY strfield LIMIT 100 OFFSET 20',
+                expected_str[20:120]),
+            ('SELECT * FROM test ORDER BY intfield LIMIT 2000 OFFSET 10',
+                [v[2] for v in sorted(values, key=lambda v: v[0])][10:]) ]
+
+        for (sql, expected_fids) in tests:
+            sql_lyr = ds.ExecuteSQL(sql)
+            fids = [f.GetFID() for f in sql_lyr]
+            count = sql_lyr.GetFeatureCount()
+            ds.ReleaseResultSet(sql_lyr)
+            if fids != expected_fids or count != len(expected_fids):
+                gdaltest.post_reason('fail')
+                print(max_mem, sql, count, fids[0:10], expected_fids[0:10])
+                gdal.SetConfigOption('OGR_SQL_SORT_MAX_MEMORY', None)
+                return 'fail'
+
+    gdal.SetConfigOption('OGR_SQL_SORT_MAX_MEMORY', None)
+
+    return 'success'
+
+
+###############################################################################
+# Test GROUP BY
+
+def ogr_sql_49():
+
+    ds = ogr.GetDriverByName('Memory').CreateDataSource('')
+    lyr = ds.CreateLayer('test')
+    lyr.CreateField(ogr.FieldDefn('intfield', ogr.OFTInteger))
+    lyr.CreateField(ogr.FieldDefn('strfield', ogr.OFTString))
+    lyr.CreateField(ogr.FieldDefn('realfield', ogr.OFTReal))
+    groups = {}
+    for i in range(1000):
+        f = ogr.Feature(lyr.GetLayerDefn())
+        f['intfield'] = i % 7
+        if i % 11 != 0:
+            f['strfield'] = 'val%d' % (i % 5)
+        f['realfield'] = i * 0.5
+        lyr.CreateFeature(f)
+        key = (f['intfield'], f['strfield'])
+        if key not in groups:
+            groups[key] = []
+        groups[key].append(f['realfield'])
+
+    # Nulls sort first
+    keys = sorted(groups.keys(), key=lambda k: (k[0], k[1] is not None, k[1]))
+    expected = [(k[0], k[1], len(groups[k]), sum(groups[k]),
+                 min(groups[k]), max(groups[k])) for k in keys]
+    expected_desc = sorted(expected, key=lambda v: -v[0])
+
+    for max_mem in [None, '1000']:
+        gdal.SetConfigOption('OGR_SQL_GROUP_BY_MAX_MEMORY', max_mem)
+
+        tests = [
+            ('ORDER BY intfield, strfield', None, expected),
+            ('', None, expected),
+            ('ORDER BY intfield DESC, strfield', None, expected_desc),
+            ('ORDER BY intfield, strfield LIMIT 5 OFFSET 3', None,
+                expected[3:8]),
+            ('ORDER BY intfield, strfield', 'cnt > 28',
+                [v for v in expected if v[2] > 28]) ]
+
+        for (clauses, having, expected_values) in tests:
+            sql_lyr = ds.ExecuteSQL(
+                'SELECT intfield, strfield, COUNT(*) AS cnt, '
+                'SUM(realfield) AS s, MIN(realfield) AS mi, '
+                'MAX(realfield) AS ma, AVG(realfield) AS av '
+                'FROM test GROUP BY intfield, strfield ' + clauses)
+            if having is not None:
+                sql_lyr.SetAttributeFilter(having)
+            values = []
+            for f in sql_lyr:
+                if abs(f['av'] - f['s'] / f['cnt']) > 1e-8:
+                    gdaltest.post_reason('fail')
+                    f.DumpReadable()
+                    values = None
+                    break
+                values.append((f['intfield'], f['strfield'], f['cnt'],
+                               f['s'], f['mi'], f['ma']))
+            count = sql_lyr.GetFeatureCount()
+            ds.ReleaseResultSet(sql_lyr)
+            if values != expected_values or count != len(expected_values):
+                gdaltest.post_reason('fail')
+                print(max_mem, clauses, having, count, values, expected_values)
+                gdal.SetConfigOption('OGR_SQL_GROUP_BY_MAX_MEMORY', None)
+                return 'fail'
+
+        # Without ORDER BY, groups come in ascending order of the GROUP BY
+        # fields, whether they were spilled to disk or not
+        sql_lyr = ds.ExecuteSQL(
+            'SELECT strfield, COUNT(intfield) FROM test GROUP BY strfield')
+        values = [(f.GetField(0), f.GetField(1)) for f in sql_lyr]
+        ds.ReleaseResultSet(sql_lyr)
+        expected_str = []
+        for k in sorted(set([k[1] for k in keys]),
+                        key=lambda v: (v is not None, v)):
+            expected_str.append((k, sum([len(groups[g]) for g in groups
+                                         if g[1] == k])))
+        if values != expected_str:
+            gdaltest.post_reason('fail')
+            print(max_mem, values)
+            gdal.SetConfigOption('OGR_SQL_GROUP_BY_MAX_MEMORY', None)
+            return 'fail'
+
+    gdal.SetConfigOption('OGR_SQL_GROUP_BY_MAX_MEMORY', None)
+
+    # Filter on a summary column without alias
+    sql_lyr = ds.ExecuteSQL(
+        'SELECT intfield, COUNT(*) FROM test GROUP BY intfield')
+    sql_lyr.SetAttributeFilter('"COUNT_*" > 142')
+    values = [(f.GetField(0), f.GetField(1)) for f in sql_lyr]
+    ds.ReleaseResultSet(sql_lyr)
+    expected_int = [(i, len([j for j in range(1000) if j % 7 == i]))
+                    for i in range(7)]
+    if values != [v for v in expected_int if v[1] > 142]:
+        gdaltest.post_reason('fail')
+        print(values)
+        return 'fail'
+
+    # Error cases
+    for sql in [ 'SELECT realfield FROM test GROUP BY intfield',
+                 'SELECT * FROM test GROUP BY intfield',
+                 'SELECT DISTINCT intfield FROM test GROUP BY intfield',
+                 'SELECT COUNT(DISTINCT strfield) FROM test GROUP BY intfield',
+                 'SELECT intfield FROM test GROUP BY not_existing',
+                 'SELECT intfield FROM test GROUP BY intfield ORDER BY strfield' ]:
+        gdal.PushErrorHandler('CPLQuietErrorHandler')
+        sql_lyr = ds.ExecuteSQL(sql)
+        gdal.PopErrorHandler()
+        if sql_lyr is not None:
+            gdaltest.post_reason('fail')
+            print(sql)
+            ds.ReleaseResultSet(sql_lyr)
+            return 'fail'
+
+    return 'success'
+
+
+###############################################################################
+# Test that a field named "offset" can still be used (OFFSET is only a keyword
+# after LIMIT)
+
+def ogr_sql_50():
+
+    ds = ogr.GetDriverByName('Memory').CreateDataSource('')
+    lyr = ds.CreateLayer('test')
+    lyr.CreateField(ogr.FieldDefn('offset', ogr.OFTInteger))
+    for i in range(5):
+        f = ogr.Feature(lyr.GetLayerDefn())
+        f['offset'] = 1996 + i
+        lyr.CreateFeature(f)
+
+    lyr.SetAttributeFilter('offset > 1998')
+    if lyr.GetFeatureCount() != 2:
+        gdaltest.post_reason('fail')
+        return 'fail'
+    lyr.SetAttributeFilter(None)
+
+    sql_lyr = ds.ExecuteSQL('SELECT offset FROM test WHERE offset > 1997 ' +
+                            'ORDER BY offset DESC LIMIT 2 OFFSET 1')
+    values = [f['offset'] for f in sql_lyr]
+    ds.ReleaseResultSet(sql_lyr)
+    if values != [1999, 1998]:
+        gdaltest.post_reason('fail')
+        print(values)
+        return 'fail'
+
+    return 'success'
+
+
+###############################################################################
+# Test that a field named "group" can still be used (GROUP is only a keyword
+# before BY)
+
+def ogr_sql_51():
+
+    ds = ogr.GetDriverByName('Memory').CreateDataSource('')
+    lyr = ds.CreateLayer('test')
+    lyr.CreateField(ogr.FieldDefn('group', ogr.OFTString))
+    for i in range(5):
+        f = ogr.Feature(lyr.GetLayerDefn())
+        f['group'] = 'ab'[i % 2]
+        lyr.CreateFeature(f)
+
+    lyr.SetAttributeFilter("group = 'a'")
+    if lyr.GetFeatureCount() != 3:
+        gdaltest.post_reason('fail')
+        return 'fail'
+    lyr.SetAttributeFilter(None)
+
+    sql_lyr = ds.ExecuteSQL("SELECT group, COUNT(*) FROM test " +
+                            "WHERE group <> 'c' GROUP BY group ORDER BY group")
+    values = [(f['group'], f['COUNT_*']) for f in sql_lyr]
+    ds.ReleaseResultSet(sql_lyr)
+    if values != [('a', 3), ('b', 2)]:
+        gdaltest.post_reason('fail')
+        print(values)
+        return 'fail'
+
+    return 'success'
+
+###############################################################################
+# Test ORDER BY on several keys, over more records than the initial size of
+# the sort index
+
+def ogr_sql_52():
+
+    ds = ogr.GetDriverByName('Memory').CreateDataSource('')
+    lyr = ds.CreateLayer('test')
+    lyr.CreateField(ogr.FieldDefn('a', ogr.OFTInteger))
+    lyr.CreateField(ogr.FieldDefn('b', ogr.OFTString))
+    lyr.CreateField(ogr.FieldDefn('c', ogr.OFTReal))
+    expected = []
+    for i in range(500):
+        f = ogr.Feature(lyr.GetLayerDefn())
+        f['a'] = i % 7
+        f['b'] = 'val%03d' % ((i * 37) % 101)
+        f['c'] = i
+        lyr.CreateFeature(f)
+        expected.append((i % 7, 'val%03d' % ((i * 37) % 101), i))
+    expected.sort(key=lambda x: (x[0], [-ord(ch) for ch in x[1]], x[2]))
+
+    sql_lyr = ds.ExecuteSQL('SELECT a, b, c FROM test ORDER BY a, b DESC, c')
+    values = [(f['a'], f['b'], int(f['c'])) for f in sql_lyr]
+    ds.ReleaseResultSet(sql_lyr)
+    if values != expected:
+        gdaltest.post_reason('fail')
+        print(values[0:10])
+        return 'fail'
+
+    return 'success'
+
+###############################################################################
+# Test LIMIT and OFFSET on SELECT DISTINCT
+
+def ogr_sql_53():
+
+    ds = ogr.GetDriverByName('Memory').CreateDataSource('')
+    lyr = ds.CreateLayer('test')
+    lyr.CreateField(ogr.FieldDefn('a', ogr.OFTInteger))
+    for i in range(20):
+        f = ogr.Feature(lyr.GetLayerDefn())
+        f['a'] = i % 10
+        lyr.CreateFeature(f)
+
+    for (sql, expected) in [
+            ('SELECT DISTINCT a FROM test ORDER BY a LIMIT 3', [0, 1, 2]),
+            ('SELECT DISTINCT a FROM test ORDER BY a LIMIT 3 OFFSET 4',
+             [4, 5, 6]),
+            ('SELECT DISTINCT a FROM test ORDER BY a DESC LIMIT 2 OFFSET 1',
+             [8, 7]),
+            ('SELECT DISTINCT a FROM test ORDER BY a LIMIT 5 OFFSET 8',
+             [8, 9]),
+            ('SELECT DISTINCT a FROM test ORDER BY a LIMIT 0', []),
+            ('SELECT DISTINCT a FROM test LIMIT 5 OFFSET 12', []) ]:
+        sql_lyr = ds.ExecuteSQL(sql)
+        count = sql_lyr.GetFeatureCount()
+        values = [f['a'] for f in sql_lyr]
+        ds.ReleaseResultSet(sql_lyr)
+        if values != expected or count != len(expected):
+            gdaltest.post_reason('fail')
+            print(sql, values, count)
+            return 'fail'
+
+    return 'success'
+
+
 def ogr_sql_cleanup():
     gdaltest.lyr = None
     gdaltest.ds = None
@@ -1569,6 +1873,12 @@ gdaltest_list = [
     ogr_sql_45,
     ogr_sql_46,
     ogr_sql_47,
+    ogr_sql_48,
+    ogr_sql_49,
+    ogr_sql_50,
+    ogr_sql_51,
+    ogr_sql_52,
+    ogr_sql_53,
     ogr_sql_cleanup ]
 
 if __name__ == '__main__':
@@ -322,6 +322,73 @@ def osr_ct_8():
 
     return 'success'
 
+###############################################################################
+# Test WGS84 -> WebMercator optimized transform
+
+def osr_ct_9():
+
+    if gdaltest.have_proj4 == 0:
+        return 'skip'
+
+    src_srs = osr.SpatialReference()
+    src_srs.SetWellKnownGeogCS( 'WGS84' )
+
+    dst_srs = osr.SpatialReference()
+    dst_srs.ImportFromEPSG( 3857 )
+
+    ct = osr.CoordinateTransformation( src_srs, dst_srs )
+
+    pnts = [ (2, 49), (200, 49), (0, 90) ]
+    result = ct.TransformPoints( pnts )
+    expected_result = [ (222638.98158654716, 6274861.394006577, 0.0),
+                        (-17811118.526923772, 6274861.394006577, 0.0),
+                        (float('inf'), float('inf'), 0.0) ]
+
+    for i in range(2):
+        for j in range(3):
+            if abs(result[i][j] - expected_result[i][j]) > 1e-6:
+                gdaltest.post_reason( 'Failed to transform from LL to Pseudo Mercator')
+                print('Got:      %s' % str(result))
+                print('Expected: %s' % str(expected_result))
+                return 'fail'
+    if result[2][0] != expected_result[2][0]:
+        gdaltest.post_reason( 'Expected pole to be rejected')
+        print('Got:      %s' % str(result))
+        return 'fail'
+
+    return 'success'
+
+###############################################################################
+# Test that transforming many points with several threads gives the same
+# result as with a single thread
+
+def osr_ct_10():
+
+    if gdaltest.have_proj4 == 0:
+        return 'skip'
+
+    src_srs = osr.SpatialReference()
+    src_srs.SetWellKnownGeogCS( 'WGS84' )
+
+    dst_srs = osr.SpatialReference()
+    dst_srs.ImportFromEPSG( 32631 )
+
+    pnts = [ (-3 + 9.0 * i / 50000, 40 + i % 100 * 0.1) for i in range(50000) ]
+
+    results = []
+    for num_threads in ['1', '4']:
+        gdal.SetConfigOption('GDAL_NUM_THREADS', num_threads)
+        ct = osr.CoordinateTransformation( src_srs, dst_srs )
+        results.append( ct.TransformPoints( pnts ) )
+        ct = None
+        gdal.SetConfigOption('GDAL_NUM_THREADS', None)
+
+    if results[0] != results[1]:
+        gdaltest.post_reason( 'Multi-threaded transformation differs')
+        return 'fail'
+
+    return 'success'
+
 ###############################################################################
 # Cleanup
 
@@ -343,6 +410,8 @@ gdaltest_list = [
     osr_ct_6,
     osr_ct_7,
     osr_ct_8,
+    osr_ct_9,
+    osr_ct_10,
     osr_ct_cleanup,
     None ]
 
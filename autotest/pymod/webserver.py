@@ -49,12 +49,43 @@ class GDAL_Handler(BaseHTTPRequestHandler):
     def log_request(self, code='-', size='-'):
         return
 
+    # Serve files of the autotest tree, honouring single Range requests
+    def serve_local_file(self, head_only):
+        import os
+        filename = os.path.join(os.path.dirname(os.path.abspath(__file__)), '..', self.path[len('/autotest/'):].split('?')[0])
+        if self.path.find('..') >= 0 or not os.path.isfile(filename):
+            self.send_error(404,'File Not Found: %s' % self.path)
+            return
+        f = open(filename, 'rb')
+        content = f.read()
+        f.close()
+        start = 0
+        end = len(content) - 1
+        if 'Range' in self.headers and self.headers['Range'].startswith('bytes='):
+            ranges = self.headers['Range'][len('bytes='):].split('-')
+            start = int(ranges[0])
+            if ranges[1] != '':
+                end = min(end, int(ranges[1]))
+            self.send_response(206)
+            self.send_header('Content-Range', 'bytes %d-%d/%d' % (start, end, len(content)))
+        else:
+            self.send_response(200)
+        self.send_header('Content-type', 'application/octet-stream')
+        self.send_header('Content-Length', end - start + 1)
+        self.end_headers()
+        if not head_only:
+            self.wfile.write(content[start:end+1])
+
     def do_HEAD(self):
         if do_log:
             f = open('/tmp/log.txt', 'a')
             f.write('HEAD %s\n' % self.path)
             f.close()
 
+        if self.path.startswith('/autotest/'):
+            self.serve_local_file(True)
+            return
+
         if self.path == '/s3_fake_bucket/resource2.bin':
             self.send_response(200)
             self.send_header('Content-type', 'text/plain')
@@ -313,6 +344,10 @@ class GDAL_Handler(BaseHTTPRequestHandler):
                 f.write('GET %s\n' % self.path)
                 f.close()
 
+            if self.path.startswith('/autotest/'):
+                self.serve_local_file(False)
+                return
+
             if self.path == '/shutdown':
                 self.send_response(200)
                 self.send_header('Content-type', 'text/html')
@@ -1529,6 +1529,67 @@ def test_gdalwarp_46():
     return 'success'
 
 
+###############################################################################
+# Test -multi with several chunks in flight (CHUNKS_IN_FLIGHT)
+
+def test_gdalwarp_47():
+    if test_cli_utilities.get_gdalwarp_path() is None:
+        return 'skip'
+
+    for options in [ '', '-dstalpha' ]:
+        gdaltest.runexternal(test_cli_utilities.get_gdalwarp_path() + ' -overwrite -r cubic -ts 1000 1000 -wm 0.2 ' + options + ' ../gcore/data/byte.tif tmp/test_gdalwarp_47_ref.tif')
+        gdaltest.runexternal(test_cli_utilities.get_gdalwarp_path() + ' -overwrite -r cubic -ts 1000 1000 -wm 0.2 -multi -wo CHUNKS_IN_FLIGHT=4 ' + options + ' ../gcore/data/byte.tif tmp/test_gdalwarp_47.tif')
+
+        ref_ds = gdal.Open('tmp/test_gdalwarp_47_ref.tif')
+        ds = gdal.Open('tmp/test_gdalwarp_47.tif')
+        if ref_ds is None or ds is None:
+            gdaltest.post_reason('fail')
+            return 'fail'
+
+        for i in range(ref_ds.RasterCount):
+            if ds.GetRasterBand(i+1).Checksum() != ref_ds.GetRasterBand(i+1).Checksum():
+                gdaltest.post_reason('Bad checksum')
+                print(options, i+1)
+                return 'fail'
+
+        ds = None
+        ref_ds = None
+
+    return 'success'
+
+
+###############################################################################
+# Test -multi with many chunks in flight and a tiny block cache, so that the
+# source reads evict dirty destination blocks
+
+def test_gdalwarp_48():
+    if test_cli_utilities.get_gdalwarp_path() is None:
+        return 'skip'
+
+    gdaltest.runexternal(test_cli_utilities.get_gdalwarp_path() + ' -overwrite -ts 3000 3000 -r bilinear -co TILED=YES -co COMPRESS=DEFLATE ../gcore/data/byte.tif tmp/test_gdalwarp_48_src.tif')
+    gdaltest.runexternal(test_cli_utilities.get_gdalwarp_path() + ' -overwrite -r cubic -ts 2500 2500 -wm 1 --config GDAL_CACHEMAX 1 tmp/test_gdalwarp_48_src.tif tmp/test_gdalwarp_48_ref.tif')
+    ref_ds = gdal.Open('tmp/test_gdalwarp_48_ref.tif')
+    if ref_ds is None:
+        gdaltest.post_reason('fail')
+        return 'fail'
+    ref_cs = ref_ds.GetRasterBand(1).Checksum()
+    ref_ds = None
+
+    for i in range(5):
+        gdaltest.runexternal(test_cli_utilities.get_gdalwarp_path() + ' -overwrite -r cubic -ts 2500 2500 -wm 1 -multi -wo CHUNKS_IN_FLIGHT=8 --config GDAL_CACHEMAX 1 tmp/test_gdalwarp_48_src.tif tmp/test_gdalwarp_48.tif')
+        ds = gdal.Open('tmp/test_gdalwarp_48.tif')
+        if ds is None:
+            gdaltest.post_reason('fail')
+            return 'fail'
+        cs = ds.GetRasterBand(1).Checksum()
+        ds = None
+        if cs != ref_cs:
+            gdaltest.post_reason('Bad checksum')
+            print(i, cs, ref_cs)
+            return 'fail'
+
+    return 'success'
+
 ###############################################################################
 # Cleanup
 
@@ -1625,6 +1686,21 @@ def test_gdalwarp_cleanup():
         os.remove('tmp/test_gdalwarp_46.tif')
     except:
         pass
+    try:
+        os.remove('tmp/test_gdalwarp_47.tif')
+    except:
+        pass
+    try:
+        os.remove('tmp/test_gdalwarp_47_ref.tif')
+    except:
+        pass
+    for filename in [ 'tmp/test_gdalwarp_48_src.tif',
+                      'tmp/test_gdalwarp_48_ref.tif',
+                      'tmp/test_gdalwarp_48.tif' ]:
+        try:
+            os.remove(filename)
+        except:
+            pass
     try:
         os.remove('tmp/cutline_4326.shp')
         os.remove('tmp/cutline_4326.shx')
@@ -1683,6 +1759,8 @@ gdaltest_list = [
     test_gdalwarp_44,
     test_gdalwarp_45,
     test_gdalwarp_46,
+    test_gdalwarp_47,
+    test_gdalwarp_48,
     test_gdalwarp_cleanup
     ]
 
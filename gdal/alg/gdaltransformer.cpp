@@ -37,6 +37,13 @@
 #include "gdal_alg_priv.h"
 #include "cpl_list.h"
 #include "cpl_multiproc.h"
+#include "cpl_atomic_ops.h"
+
+#include <algorithm>
+#include <map>
+#include <set>
+#include <utility>
+#include <vector>
 
 CPL_CVSID("$Id$");
 CPL_C_START
@@ -2486,6 +2493,8 @@ GDALDeserializeReprojectionTransformer( CPLXMLNode *psTree )
 /* ==================================================================== */
 /************************************************************************/
 
+struct GDALApproxGrid;
+
 typedef struct
 {
     GDALTransformerInfo sTI;
@@ -2495,8 +2504,487 @@ typedef struct
     double	      dfMaxError;
 
     int               bOwnSubtransformer;
+
+    /* Control grid of the 2D mode, or NULL. */
+    GDALApproxGrid   *psGrid;
 } ApproxTransformInfo;
 
+/************************************************************************/
+/*                           GDALApproxGrid                             */
+/*                                                                      */
+/*      Control grid of the 2D mode of the approximate transformer.     */
+/*      The input space is divided into cells of GridCellSize pixels.   */
+/*      A cell is bilinearly interpolated from the exact transforms of  */
+/*      its corners if the error measured at its center and at the      */
+/*      middle of its edges is within MaxError. Otherwise it is split   */
+/*      in four, down to APPROX_GRID_MIN_CELL_SIZE pixels, below which  */
+/*      its points are transformed exactly. Exact transforms of grid    */
+/*      nodes and cell states are kept for the lifetime of the grid,    */
+/*      which is shared by the clones of a transformer (one per warping */
+/*      thread).                                                        */
+/************************************************************************/
+
+// Smallest cell size, in pixels. Nodes are addressed in units of half of it.
+static const int APPROX_GRID_MIN_CELL_SIZE = 8;
+static const int APPROX_GRID_UNIT = APPROX_GRID_MIN_CELL_SIZE / 2;
+
+// The grid is emptied when it reaches this number of nodes.
+static const size_t APPROX_GRID_MAX_NODES = 1000000;
+
+typedef std::pair<GIntBig, GIntBig> GDALApproxGridNodeKey;
+
+typedef struct
+{
+    double      dfX;
+    double      dfY;
+    double      dfZ;
+    bool        bSuccess;
+} GDALApproxGridNode;
+
+typedef struct
+{
+    int         nLevel;
+    GIntBig     nCellX;
+    GIntBig     nCellY;
+} GDALApproxGridCellKey;
+
+static bool operator< ( const GDALApproxGridCellKey& a,
+                        const GDALApproxGridCellKey& b )
+{
+    if( a.nLevel != b.nLevel )
+        return a.nLevel < b.nLevel;
+    if( a.nCellY != b.nCellY )
+        return a.nCellY < b.nCellY;
+    return a.nCellX < b.nCellX;
+}
+
+typedef enum
+{
+    APPROX_CELL_INTERPOLATE,
+    APPROX_CELL_SPLIT,
+    APPROX_CELL_EXACT
+} GDALApproxGridCellState;
+
+typedef struct
+{
+    std::map<GDALApproxGridNodeKey, GDALApproxGridNode> oNodes;
+    std::map<GDALApproxGridCellKey, GDALApproxGridCellState> oCells;
+} GDALApproxGridDirection;
+
+struct GDALApproxGrid
+{
+    volatile int nRefCount;
+    CPLMutex    *hMutex;
+    int         nCellSize;
+    int         nMaxLevel;
+
+    // Index 0 for source to destination, 1 for destination to source.
+    GDALApproxGridDirection asDir[2];
+
+    // Statistics.
+    GUIntBig    nNodeTransforms;
+    GUIntBig    nInterpolatedPoints;
+    GUIntBig    nExactPoints;
+};
+
+/* Leaf cell containing the last located point. */
+typedef struct
+{
+    bool        bValid;
+    double      dfXMin;
+    double      dfYMin;
+    double      dfSize;
+    GDALApproxGridCellState eState;
+    GDALApproxGridNode asCorners[4];  // (0,0), (1,0), (0,1), (1,1)
+} GDALApproxGridLeaf;
+
+/************************************************************************/
+/*                        GDALApproxGridCreate()                        */
+/************************************************************************/
+
+static GDALApproxGrid *GDALApproxGridCreate( int nCellSize )
+{
+    GDALApproxGrid *psGrid = new GDALApproxGrid();
+    psGrid->nRefCount = 1;
+    psGrid->hMutex = NULL;
+    psGrid->nCellSize = nCellSize;
+    psGrid->nMaxLevel = 0;
+    while( (nCellSize >> (psGrid->nMaxLevel + 1)) >= APPROX_GRID_MIN_CELL_SIZE )
+        psGrid->nMaxLevel++;
+    psGrid->nNodeTransforms = 0;
+    psGrid->nInterpolatedPoints = 0;
+    psGrid->nExactPoints = 0;
+    return psGrid;
+}
+
+/************************************************************************/
+/*                       GDALApproxGridRelease()                        */
+/************************************************************************/
+
+static void GDALApproxGridRelease( GDALApproxGrid *psGrid )
+{
+    if( psGrid == NULL || CPLAtomicDec(&(psGrid->nRefCount)) > 0 )
+        return;
+
+    CPLDebug( "GDAL", "ApproxTransformer grid: " CPL_FRMT_GUIB
+              " points interpolated, " CPL_FRMT_GUIB " transformed exactly, "
+              CPL_FRMT_GUIB " grid node transforms",
+              psGrid->nInterpolatedPoints, psGrid->nExactPoints,
+              psGrid->nNodeTransforms );
+    if( psGrid->hMutex != NULL )
+        CPLDestroyMutex( psGrid->hMutex );
+    delete psGrid;
+}
+
+/************************************************************************/
+/*                     GDALApproxGridGetCellNode()                      */
+/************************************************************************/
+
+/* Key of node (iX, iY), in 0..2, of a cell. 0 and 2 are the corners. */
+static GDALApproxGridNodeKey
+GDALApproxGridGetCellNode( const GDALApproxGrid *psGrid,
+                           const GDALApproxGridCellKey& sCell, int iX, int iY )
+{
+    const GIntBig nUnits =
+        (psGrid->nCellSize / APPROX_GRID_UNIT) >> sCell.nLevel;
+    return GDALApproxGridNodeKey( sCell.nCellX * nUnits + iX * nUnits / 2,
+                                  sCell.nCellY * nUnits + iY * nUnits / 2 );
+}
+
+/************************************************************************/
+/*                      GDALApproxGridValidateCell()                    */
+/*                                                                      */
+/*      Decide the state of a cell whose 9 nodes are known.             */
+/************************************************************************/
+
+static GDALApproxGridCellState
+GDALApproxGridValidateCell( const GDALApproxGrid *psGrid,
+                            const GDALApproxGridDirection& oDir,
+                            const GDALApproxGridCellKey& sCell,
+                            double dfMaxError )
+{
+    GDALApproxGridNode asNodes[3][3];
+    for( int iY = 0; iY < 3; iY++ )
+    {
+        for( int iX = 0; iX < 3; iX++ )
+        {
+            asNodes[iY][iX] = oDir.oNodes.find(
+                GDALApproxGridGetCellNode(psGrid, sCell, iX, iY))->second;
+            if( !asNodes[iY][iX].bSuccess )
+                return APPROX_CELL_EXACT;
+        }
+    }
+
+    // Compare the exact transforms of the center and of the middle of the
+    // edges with their bilinear interpolation from the corners.
+    static const int anChecks[5][2] = { {1,1}, {1,0}, {0,1}, {2,1}, {1,2} };
+    for( int i = 0; i < 5; i++ )
+    {
+        const int iX = anChecks[i][0];
+        const int iY = anChecks[i][1];
+        const double dfWX = iX * 0.5;
+        const double dfWY = iY * 0.5;
+        const double dfX =
+            (1 - dfWY) * ((1 - dfWX) * asNodes[0][0].dfX + dfWX * asNodes[0][2].dfX) +
+            dfWY * ((1 - dfWX) * asNodes[2][0].dfX + dfWX * asNodes[2][2].dfX);
+        const double dfY =
+            (1 - dfWY) * ((1 - dfWX) * asNodes[0][0].dfY + dfWX * asNodes[0][2].dfY) +
+            dfWY * ((1 - dfWX) * asNodes[2][0].dfY + dfWX * asNodes[2][2].dfY);
+        const double dfError = fabs(dfX - asNodes[iY][iX].dfX) +
+                               fabs(dfY - asNodes[iY][iX].dfY);
+        if( !(dfError <= dfMaxError) )
+        {
+            return sCell.nLevel < psGrid->nMaxLevel ? APPROX_CELL_SPLIT :
+                                                      APPROX_CELL_EXACT;
+        }
+    }
+
+    return APPROX_CELL_INTERPOLATE;
+}
+
+/************************************************************************/
+/*                        GDALApproxGridLocate()                        */
+/*                                                                      */
+/*      Find the leaf cell containing (dfX, dfY), validating the cells  */
+/*      on the way when possible. Returns false, and adds the nodes     */
+/*      to transform to oMissing, if a cell cannot be validated yet.    */
+/*      Must be called with the grid mutex held.                        */
+/************************************************************************/
+
+static bool GDALApproxGridLocate( GDALApproxGrid *psGrid,
+                                  GDALApproxGridDirection& oDir,
+                                  double dfX, double dfY, double dfMaxError,
+                                  GDALApproxGridLeaf *psLeaf,
+                                  std::set<GDALApproxGridNodeKey>& oMissing )
+{
+    psLeaf->bValid = false;
+    if( !(fabs(dfX) < 1e15 && fabs(dfY) < 1e15) )
+    {
+        psLeaf->eState = APPROX_CELL_EXACT;
+        return true;
+    }
+
+    for( int nLevel = 0; nLevel <= psGrid->nMaxLevel; nLevel++ )
+    {
+        const double dfSize =
+            static_cast<double>(psGrid->nCellSize >> nLevel);
+        GDALApproxGridCellKey sCell;
+        sCell.nLevel = nLevel;
+        sCell.nCellX = static_cast<GIntBig>(floor(dfX / dfSize));
+        sCell.nCellY = static_cast<GIntBig>(floor(dfY / dfSize));
+
+        std::map<GDALApproxGridCellKey, GDALApproxGridCellState>::iterator
+            oIter = oDir.oCells.find(sCell);
+        GDALApproxGridCellState eState;
+        if( oIter != oDir.oCells.end() )
+        {
+            eState = oIter->second;
+        }
+        else
+        {
+            bool bComplete = true;
+            for( int iY = 0; iY < 3; iY++ )
+            {
+                for( int iX = 0; iX < 3; iX++ )
+                {
+                    const GDALApproxGridNodeKey oKey =
+                        GDALApproxGridGetCellNode(psGrid, sCell, iX, iY);
+                    if( oDir.oNodes.find(oKey) == oDir.oNodes.end() )
+                    {
+                        oMissing.insert(oKey);
+                        bComplete = false;
+                    }
+                }
+            }
+            if( !bComplete )
+                return false;
+            eState = GDALApproxGridValidateCell(psGrid, oDir, sCell,
+                                                dfMaxError);
+            oDir.oCells[sCell] = eState;
+        }
+
+        if( eState == APPROX_CELL_SPLIT )
+            continue;
+
+        psLeaf->bValid = true;
+        psLeaf->eState = eState;
+        psLeaf->dfXMin = sCell.nCellX * dfSize;
+        psLeaf->dfYMin = sCell.nCellY * dfSize;
+        psLeaf->dfSize = dfSize;
+        if( eState == APPROX_CELL_INTERPOLATE )
+        {
+            for( int i = 0; i < 4; i++ )
+            {
+                psLeaf->asCorners[i] = oDir.oNodes.find(
+                    GDALApproxGridGetCellNode(psGrid, sCell,
+                                              (i % 2) * 2, (i / 2) * 2))->second;
+            }
+        }
+        return true;
+    }
+
+    // Not reached: cells of the last level are never split.
+    psLeaf->eState = APPROX_CELL_EXACT;
+    return true;
+}
+
+/************************************************************************/
+/*                       GDALApproxGridTransform()                      */
+/*                                                                      */
+/*      Transform points with the control grid. All z must be 0.        */
+/************************************************************************/
+
+static int GDALApproxGridTransform( ApproxTransformInfo *psATInfo,
+                                    int bDstToSrc, int nPoints,
+                                    double *x, double *y, double *z,
+                                    int *panSuccess )
+{
+    GDALApproxGrid *psGrid = psATInfo->psGrid;
+    GDALApproxGridDirection& oDir = psGrid->asDir[bDstToSrc ? 1 : 0];
+
+    std::vector<int> anPending;
+    std::vector<int> anStillPending;
+    std::vector<int> anExact;
+    std::vector<GDALApproxGridLeaf> asLeaves;
+    std::vector<int> anInterpolate;
+    std::vector<int> anInterpolateLeaf;
+    std::set<GDALApproxGridNodeKey> oMissing;
+    std::vector<double> adfX;
+    std::vector<double> adfY;
+    std::vector<double> adfZ;
+    std::vector<int> anSuccess;
+    GUIntBig nInterpolated = 0;
+
+    anPending.resize(nPoints);
+    for( int i = 0; i < nPoints; i++ )
+        anPending[i] = i;
+
+    while( !anPending.empty() )
+    {
+        oMissing.clear();
+        anStillPending.clear();
+        asLeaves.clear();
+        anInterpolate.clear();
+        anInterpolateLeaf.clear();
+
+/* -------------------------------------------------------------------- */
+/*      Only look up the leaf cells of the points with the mutex        */
+/*      held, and keep a copy of them.                                  */
+/* -------------------------------------------------------------------- */
+        {
+            CPLMutexHolderD( &(psGrid->hMutex) );
+
+            GDALApproxGridLeaf sLeaf;
+            memset( &sLeaf, 0, sizeof(sLeaf) );
+            for( size_t iPending = 0; iPending < anPending.size(); iPending++ )
+            {
+                const int i = anPending[iPending];
+
+                // Consecutive points generally fall in the same cell.
+                if( !(sLeaf.bValid &&
+                      x[i] >= sLeaf.dfXMin &&
+                      x[i] < sLeaf.dfXMin + sLeaf.dfSize &&
+                      y[i] >= sLeaf.dfYMin &&
+                      y[i] < sLeaf.dfYMin + sLeaf.dfSize) )
+                {
+                    if( !GDALApproxGridLocate( psGrid, oDir, x[i], y[i],
+                                               psATInfo->dfMaxError,
+                                               &sLeaf, oMissing ) )
+                    {
+                        anStillPending.push_back(i);
+                        continue;
+                    }
+                    if( sLeaf.eState == APPROX_CELL_INTERPOLATE )
+                        asLeaves.push_back(sLeaf);
+                }
+
+                if( sLeaf.eState == APPROX_CELL_EXACT )
+                {
+                    anExact.push_back(i);
+                    continue;
+                }
+
+                anInterpolate.push_back(i);
+                anInterpolateLeaf.push_back(
+                    static_cast<int>(asLeaves.size()) - 1);
+            }
+        }
+
+/* -------------------------------------------------------------------- */
+/*      Interpolate the points from the corners of their leaf cell.     */
+/* -------------------------------------------------------------------- */
+        for( size_t iPoint = 0; iPoint < anInterpolate.size(); iPoint++ )
+        {
+            const int i = anInterpolate[iPoint];
+            const GDALApproxGridLeaf& sLeaf = asLeaves[anInterpolateLeaf[iPoint]];
+            const double dfWX = (x[i] - sLeaf.dfXMin) / sLeaf.dfSize;
+            const double dfWY = (y[i] - sLeaf.dfYMin) / sLeaf.dfSize;
+            const GDALApproxGridNode *pasC = sLeaf.asCorners;
+            x[i] = (1 - dfWY) * ((1 - dfWX) * pasC[0].dfX + dfWX * pasC[1].dfX) +
+                   dfWY * ((1 - dfWX) * pasC[2].dfX + dfWX * pasC[3].dfX);
+            y[i] = (1 - dfWY) * ((1 - dfWX) * pasC[0].dfY + dfWX * pasC[1].dfY) +
+                   dfWY * ((1 - dfWX) * pasC[2].dfY + dfWX * pasC[3].dfY);
+            z[i] = (1 - dfWY) * ((1 - dfWX) * pasC[0].dfZ + dfWX * pasC[1].dfZ) +
+                   dfWY * ((1 - dfWX) * pasC[2].dfZ + dfWX * pasC[3].dfZ);
+            panSuccess[i] = TRUE;
+        }
+        nInterpolated += anInterpolate.size();
+
+        if( oMissing.empty() )
+            break;
+
+/* -------------------------------------------------------------------- */
+/*      Compute the missing nodes with the base transformer, without    */
+/*      holding the mutex so that other threads can go on.              */
+/* -------------------------------------------------------------------- */
+        const int nMissing = static_cast<int>(oMissing.size());
+        adfX.resize(nMissing);
+        adfY.resize(nMissing);
+        adfZ.resize(nMissing);
+        anSuccess.resize(nMissing);
+        int iNode = 0;
+        for( std::set<GDALApproxGridNodeKey>::const_iterator
+                oIter = oMissing.begin(); oIter != oMissing.end(); ++oIter )
+        {
+            adfX[iNode] = static_cast<double>(oIter->first * APPROX_GRID_UNIT);
+            adfY[iNode] = static_cast<double>(oIter->second * APPROX_GRID_UNIT);
+            adfZ[iNode] = 0.0;
+            anSuccess[iNode] = FALSE;
+            iNode++;
+        }
+        if( !psATInfo->pfnBaseTransformer( psATInfo->pBaseCBData, bDstToSrc,
+                                           nMissing, &adfX[0], &adfY[0],
+                                           &adfZ[0], &anSuccess[0] ) )
+        {
+            std::fill(anSuccess.begin(), anSuccess.end(), FALSE);
+        }
+
+        {
+            CPLMutexHolderD( &(psGrid->hMutex) );
+            if( oDir.oNodes.size() + nMissing > APPROX_GRID_MAX_NODES )
+            {
+                oDir.oNodes.clear();
+                oDir.oCells.clear();
+            }
+            iNode = 0;
+            for( std::set<GDALApproxGridNodeKey>::const_iterator
+                    oIter = oMissing.begin(); oIter != oMissing.end(); ++oIter )
+            {
+                GDALApproxGridNode sNode;
+                sNode.dfX = adfX[iNode];
+                sNode.dfY = adfY[iNode];
+                sNode.dfZ = adfZ[iNode];
+                sNode.bSuccess = anSuccess[iNode] != FALSE;
+                oDir.oNodes.insert(std::make_pair(*oIter, sNode));
+                iNode++;
+            }
+            psGrid->nNodeTransforms += nMissing;
+        }
+
+        anPending.swap(anStillPending);
+    }
+
+/* -------------------------------------------------------------------- */
+/*      Transform exactly the points of the cells that could not be     */
+/*      approximated.                                                   */
+/* -------------------------------------------------------------------- */
+    int bRet = TRUE;
+    const int nExact = static_cast<int>(anExact.size());
+    if( nExact > 0 )
+    {
+        adfX.resize(nExact);
+        adfY.resize(nExact);
+        adfZ.resize(nExact);
+        anSuccess.resize(nExact);
+        for( int i = 0; i < nExact; i++ )
+        {
+            adfX[i] = x[anExact[i]];
+            adfY[i] = y[anExact[i]];
+            adfZ[i] = z[anExact[i]];
+            anSuccess[i] = FALSE;
+        }
+        bRet = psATInfo->pfnBaseTransformer( psATInfo->pBaseCBData, bDstToSrc,
+                                             nExact, &adfX[0], &adfY[0],
+                                             &adfZ[0], &anSuccess[0] );
+        for( int i = 0; i < nExact; i++ )
+        {
+            x[anExact[i]] = adfX[i];
+            y[anExact[i]] = adfY[i];
+            z[anExact[i]] = adfZ[i];
+            panSuccess[anExact[i]] = bRet ? anSuccess[i] : FALSE;
+        }
+    }
+
+    {
+        CPLMutexHolderD( &(psGrid->hMutex) );
+        psGrid->nInterpolatedPoints += nInterpolated;
+        psGrid->nExactPoints += nExact;
+    }
+
+    return bRet;
+}
+
+
 /************************************************************************/
 /*                  GDALCreateSimilarApproxTransformer()                */
 /************************************************************************/
@@ -2526,6 +3014,19 @@ void* GDALCreateSimilarApproxTransformer( void *hTransformArg, double dfSrcRatio
     }
     psClonedInfo->bOwnSubtransformer = TRUE;
 
+/* -------------------------------------------------------------------- */
+/*      Clones of the same transformer, such as the ones used by the    */
+/*      warping threads, share the control grid.                        */
+/* -------------------------------------------------------------------- */
+    if( psInfo->psGrid != NULL )
+    {
+        if( dfSrcRatioX == 1.0 && dfSrcRatioY == 1.0 )
+            CPLAtomicInc( &(psInfo->psGrid->nRefCount) );
+        else
+            psClonedInfo->psGrid =
+                GDALApproxGridCreate( psInfo->psGrid->nCellSize );
+    }
+
     return psClonedInfo;
 }
 
@@ -2548,6 +3049,11 @@ GDALSerializeApproxTransformer( void *pTransformArg )
     CPLCreateXMLElementAndValue( psTree, "MaxError",
                                  CPLString().Printf("%g",psInfo->dfMaxError) );
 
+    if( psInfo->psGrid != NULL )
+        CPLCreateXMLElementAndValue(
+            psTree, "GridCellSize",
+            CPLString().Printf("%d", psInfo->psGrid->nCellSize) );
+
 /* -------------------------------------------------------------------- */
 /*      Capture underlying transformer.                                 */
 /* -------------------------------------------------------------------- */
@@ -2596,6 +3102,12 @@ GDALSerializeApproxTransformer( void *pTransformArg )
  * circumstances as little internal validation is done, in order to keep things
  * fast.
  *
+ * Starting with GDAL 2.2, the GDAL_APPROX_TRANSFORMER_GRID configuration
+ * option can be set to YES, or to a cell size in pixels (a power of two, 64
+ * by default), to interpolate points of zero z in a grid of exact transforms
+ * instead, that is refined where dfMaxError is exceeded and shared by the
+ * clones of the transformer.
+ *
  * @param pfnBaseTransformer the high precision transformer which should be
  * approximated.
  * @param pBaseTransformArg the callback argument for the high precision
@@ -2618,6 +3130,25 @@ void *GDALCreateApproxTransformer( GDALTransformerFunc pfnBaseTransformer,
     psATInfo->pBaseCBData = pBaseTransformArg;
     psATInfo->dfMaxError = dfMaxError;
     psATInfo->bOwnSubtransformer = FALSE;
+    psATInfo->psGrid = NULL;
+
+    const char *pszGrid =
+        CPLGetConfigOption( "GDAL_APPROX_TRANSFORMER_GRID", "NO" );
+    if( CPLTestBool(pszGrid) )
+    {
+        int nCellSize = atoi(pszGrid);
+        if( nCellSize == 0 )
+            nCellSize = 64;
+        if( nCellSize < 2 * APPROX_GRID_MIN_CELL_SIZE ||
+            nCellSize > 65536 || (nCellSize & (nCellSize - 1)) != 0 )
+        {
+            CPLError( CE_Warning, CPLE_AppDefined,
+                      "Invalid value for GDAL_APPROX_TRANSFORMER_GRID: %s. "
+                      "Using 64", pszGrid );
+            nCellSize = 64;
+        }
+        psATInfo->psGrid = GDALApproxGridCreate( nCellSize );
+    }
 
     memcpy( psATInfo->sTI.abySignature, GDAL_GTI2_SIGNATURE, strlen(GDAL_GTI2_SIGNATURE) );
     psATInfo->sTI.pszClassName = "GDALApproxTransformer";
@@ -2665,6 +3196,8 @@ void GDALDestroyApproxTransformer( void * pCBData )
     if( psATInfo->bOwnSubtransformer )
         GDALDestroyTransformer( psATInfo->pBaseCBData );
 
+    GDALApproxGridRelease( psATInfo->psGrid );
+
     CPLFree( pCBData );
 }
 
@@ -2950,6 +3483,19 @@ int GDALApproxTransform( void *pCBData, int bDstToSrc, int nPoints,
 
     int nMiddle = (nPoints-1)/2;
 
+/* -------------------------------------------------------------------- */
+/*      Use the control grid if there is one and the points are 2D.     */
+/* -------------------------------------------------------------------- */
+    if( psATInfo->psGrid != NULL && psATInfo->dfMaxError > 0.0 &&
+        nPoints > 0 )
+    {
+        int i = 0;
+        for( ; i < nPoints && z[i] == 0.0; i++ ) {}
+        if( i == nPoints )
+            return GDALApproxGridTransform( psATInfo, bDstToSrc, nPoints,
+                                            x, y, z, panSuccess );
+    }
+
 /* -------------------------------------------------------------------- */
 /*      Bail if our preconditions are not met, or if error is not       */
 /*      acceptable.                                                     */
@@ -3011,6 +3557,8 @@ GDALDeserializeApproxTransformer( CPLXMLNode *psTree )
 
 {
     double dfMaxError = CPLAtof(CPLGetXMLValue( psTree, "MaxError",  "0.25" ));
+    const char *pszGridCellSize =
+        CPLGetXMLValue( psTree, "GridCellSize", NULL );
     GDALTransformerFunc pfnBaseTransform = NULL;
     void *pBaseCBData = NULL;
 
@@ -3034,6 +3582,16 @@ GDALDeserializeApproxTransformer( CPLXMLNode *psTree )
         void *pApproxCBData = GDALCreateApproxTransformer( pfnBaseTransform,
                                                            pBaseCBData,
                                                            dfMaxError );
+        ApproxTransformInfo *psATInfo = (ApproxTransformInfo *) pApproxCBData;
+        GDALApproxGridRelease( psATInfo->psGrid );
+        psATInfo->psGrid = NULL;
+        if( pszGridCellSize != NULL )
+        {
+            const int nCellSize = atoi(pszGridCellSize);
+            if( nCellSize >= 2 * APPROX_GRID_MIN_CELL_SIZE &&
+                nCellSize <= 65536 && (nCellSize & (nCellSize - 1)) == 0 )
+                psATInfo->psGrid = GDALApproxGridCreate( nCellSize );
+        }
         GDALApproxTransformerOwnsSubtransformer( pApproxCBData, TRUE );
 
         return pApproxCBData;
@@ -3470,6 +4028,14 @@ void GDALSetTransformerDstGeoTransform(void *pTransformArg,
         ApproxTransformInfo   *psATInfo = (ApproxTransformInfo*)pTransformArg;
         psInfo = (GDALTransformerInfo *)psATInfo->pBaseCBData;
 
+        // The grid nodes are no longer valid: detach from them.
+        if( psATInfo->psGrid != NULL )
+        {
+            const int nCellSize = psATInfo->psGrid->nCellSize;
+            GDALApproxGridRelease( psATInfo->psGrid );
+            psATInfo->psGrid = GDALApproxGridCreate( nCellSize );
+        }
+
         if( psInfo == NULL ||
             memcmp(psInfo->abySignature,GDAL_GTI2_SIGNATURE, strlen(GDAL_GTI2_SIGNATURE)) != 0 )
         {
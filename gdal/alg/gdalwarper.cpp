@@ -913,6 +913,12 @@ GDALWarpDstAlphaMasker( void *pMaskFuncArg, int nBandCount,
  * set the number of threads to use to parallelize the computation part of the
  * warping. If not set, computation will be done in a single thread.
  *
+ * - CHUNKS_IN_FLIGHT: (GDAL >= 2.2) Number of chunks processed concurrently
+ * by GDALWarpOperation::ChunkAndWarpMulti() (gdalwarp -multi).  Defaults to
+ * 2.  With 3 or more, reading the source data of the next chunks, warping the
+ * current chunk and writing the previous chunks are overlapped.  Each chunk in
+ * flight uses up to the warp memory limit.
+ *
  * - STREAMABLE_OUTPUT: (GDAL >= 2.0) This defaults to FALSE, but may
  * be set to TRUE typically when writing to a streamed file. The
  * gdalwarp utility automatically sets this option when writing to
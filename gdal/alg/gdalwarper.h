@@ -371,6 +371,14 @@ private:
 
     CPLMutex        *hIOMutex;
     CPLMutex        *hWarpMutex;
+    CPLMutex        *hDstIOMutex;
+
+    CPLMutex        *hChunkCondMutex;
+    CPLCond         *hChunkCond;
+    int             nNextChunkToProcess;
+    int             nNextChunkToAdvise;
+    int             nNextChunkToWrite;
+    int             bChunkPipelineAborted;
 
     int             nChunkListCount;
     int             nChunkListMax;
@@ -386,6 +394,12 @@ private:
                                       int nDstXSize, int nDstYSize );
     void            ReportTiming( const char * );
 
+    static void     ChunkThreadMain( void * );
+    void            AdviseReadChunks( int iFirstChunk, int nChunks );
+    int             WaitForWriteTurn( int nDstXOff, int nDstYOff );
+    void            EndWriteTurn();
+    void            AbortChunkPipeline();
+
 public:
                     GDALWarpOperation();
     virtual        ~GDALWarpOperation();
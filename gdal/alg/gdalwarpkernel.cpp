@@ -152,6 +152,14 @@ static CPLErr GWKAverageOrMode( GDALWarpKernel * );
 static CPLErr GWKCubicNoMasksOrDstDensityOnlyUShort( GDALWarpKernel * );
 static CPLErr GWKCubicSplineNoMasksOrDstDensityOnlyUShort( GDALWarpKernel * );
 static CPLErr GWKBilinearNoMasksOrDstDensityOnlyUShort( GDALWarpKernel * );
+static CPLErr GWKBilinearWithMasksByte( GDALWarpKernel *poWK );
+static CPLErr GWKBilinearWithMasksShort( GDALWarpKernel *poWK );
+static CPLErr GWKBilinearWithMasksUShort( GDALWarpKernel *poWK );
+static CPLErr GWKBilinearWithMasksFloat( GDALWarpKernel *poWK );
+static CPLErr GWKCubicWithMasksByte( GDALWarpKernel *poWK );
+static CPLErr GWKCubicWithMasksShort( GDALWarpKernel *poWK );
+static CPLErr GWKCubicWithMasksUShort( GDALWarpKernel *poWK );
+static CPLErr GWKCubicWithMasksFloat( GDALWarpKernel *poWK );
 
 /************************************************************************/
 /*                           GWKJobStruct                               */
@@ -1178,6 +1186,33 @@ CPLErr GDALWarpKernel::PerformWarp()
         return GWKCubicNoMasksOrDstDensityOnlyDouble( this );
 #endif
 
+/* -------------------------------------------------------------------- */
+/*      Bilinear and cubic resampling with masks, when the general      */
+/*      case would use their 4 samples formulas. GDAL_WARP_USE_MASKED_  */
+/*      KERNELS=NO forces the general case, to compare results and      */
+/*      timings.                                                        */
+/* -------------------------------------------------------------------- */
+    if( (eResample == GRA_Bilinear || eResample == GRA_Cubic)
+        && dfXScale >= 0.95 && dfYScale >= 0.95
+        && nSrcXSize > 1 && nSrcYSize > 1
+        && CPLTestBool(CPLGetConfigOption("GDAL_WARP_USE_MASKED_KERNELS",
+                                          "YES")) )
+    {
+        const bool bBilinear = (eResample == GRA_Bilinear);
+        if( eWorkingDataType == GDT_Byte )
+            return bBilinear ? GWKBilinearWithMasksByte( this ) :
+                               GWKCubicWithMasksByte( this );
+        if( eWorkingDataType == GDT_Int16 )
+            return bBilinear ? GWKBilinearWithMasksShort( this ) :
+                               GWKCubicWithMasksShort( this );
+        if( eWorkingDataType == GDT_UInt16 )
+            return bBilinear ? GWKBilinearWithMasksUShort( this ) :
+                               GWKCubicWithMasksUShort( this );
+        if( eWorkingDataType == GDT_Float32 )
+            return bBilinear ? GWKBilinearWithMasksFloat( this ) :
+                               GWKCubicWithMasksFloat( this );
+    }
+
     if( eResample == GRA_Average )
         return GWKAverageOrMode( this );
 
@@ -1382,6 +1417,55 @@ static int GWKSetPixelValueRealT( GDALWarpKernel *poWK, int iBand,
     return TRUE;
 }
 
+/************************************************************************/
+/*                     GWKSetPixelValueFromRealT()                      */
+/*                                                                      */
+/*      Same as GWKSetPixelValue() for a real working data type.        */
+/************************************************************************/
+
+template<class T>
+static CPL_INLINE void GWKSetPixelValueFromRealT( GDALWarpKernel *poWK,
+                                                  int iBand, int iDstOffset,
+                                                  double dfDensity,
+                                                  double dfReal )
+{
+    T *pDst = (T*)(poWK->papabyDstImage[iBand]);
+
+    if( dfDensity < 0.9999 )
+    {
+        double dfDstDensity = 1.0;
+
+        if( dfDensity < 0.0001 )
+            return;
+
+        if( poWK->pafDstDensity != NULL )
+            dfDstDensity = poWK->pafDstDensity[iDstOffset];
+        else if( poWK->panDstValid != NULL
+                 && !((poWK->panDstValid[iDstOffset>>5]
+                       & (0x01 << (iDstOffset & 0x1f))) ) )
+            dfDstDensity = 0.0;
+
+        double dfDstReal = pDst[iDstOffset];
+
+        double dfDstInfluence = (1.0 - dfDensity) * dfDstDensity;
+
+        dfReal = (dfReal * dfDensity + dfDstReal * dfDstInfluence)
+            / (dfDensity + dfDstInfluence);
+    }
+
+    pDst[iDstOffset] = GWKClampValueT<T>(dfReal);
+
+    if( std::numeric_limits<T>::is_integer &&
+        poWK->padfDstNoDataReal != NULL &&
+        poWK->padfDstNoDataReal[iBand] == (double)pDst[iDstOffset] )
+    {
+        if( pDst[iDstOffset] == std::numeric_limits<T>::min() )
+            pDst[iDstOffset] = std::numeric_limits<T>::min() + 1;
+        else
+            pDst[iDstOffset] --;
+    }
+}
+
 /************************************************************************/
 /*                          GWKSetPixelValue()                          */
 /************************************************************************/
@@ -4381,6 +4465,531 @@ static CPLErr GWKCubicSplineNoMasksOrDstDensityOnlyByte( GDALWarpKernel *poWK )
                    GWKResampleNoMasksOrDstDensityOnlyThread<GByte,GRA_CubicSpline> );
 }
 
+/************************************************************************/
+/*                       GWKResampleWithMasksThread()                   */
+/*                                                                      */
+/*      Bilinear and cubic resampling with source validity masks        */
+/*      and/or density, and destination validity/density. Pixels        */
+/*      whose whole kernel footprint is valid are computed with         */
+/*      weights shared by all bands, directly from the typed source     */
+/*      buffers. Other pixels go through the same code as               */
+/*      GWKGeneralCase(), which gives the same results.                 */
+/************************************************************************/
+
+#if defined(__x86_64) || defined(_M_X64)
+/* Same as CubicConvolution(), on two values at a time. */
+static CPL_INLINE XMMReg2Double GWKCubicConvolution_SSE2(
+    const XMMReg2Double& distance1, const XMMReg2Double& distance2,
+    const XMMReg2Double& distance3,
+    const XMMReg2Double& f0, const XMMReg2Double& f1,
+    const XMMReg2Double& f2, const XMMReg2Double& f3 )
+{
+    const double dfHalf = 0.5;
+    const double dfTwo = 2.0;
+    const double dfThree = 3.0;
+    const double dfFour = 4.0;
+    const double dfFive = 5.0;
+    const XMMReg2Double v_half = XMMReg2Double::Load1ValHighAndLow(&dfHalf);
+    const XMMReg2Double v_two = XMMReg2Double::Load1ValHighAndLow(&dfTwo);
+    const XMMReg2Double v_three = XMMReg2Double::Load1ValHighAndLow(&dfThree);
+    const XMMReg2Double v_four = XMMReg2Double::Load1ValHighAndLow(&dfFour);
+    const XMMReg2Double v_five = XMMReg2Double::Load1ValHighAndLow(&dfFive);
+    return f1 + v_half * (distance1 * (f2 - f0)
+                + distance2 * (v_two * f0 - v_five * f1 + v_four * f2 - f3)
+                + distance3 * (v_three * (f1 - f2) + f3 - f0));
+}
+#endif
+
+static CPL_INLINE bool GWKIsValidBit( const GUInt32* panValid, int iOffset )
+{
+    return (panValid[iOffset>>5] & (0x01 << (iOffset & 0x1f))) != 0;
+}
+
+/* Checks that the nCols x nRows source pixels starting at iSrcOffset are */
+/* valid in all masks, and returns their unified density in padfDensity.  */
+static bool GWKIsFootprintValid( const GDALWarpKernel *poWK, int iSrcOffset,
+                                 int nCols, int nRows,
+                                 const GUInt32* const* papanBandValid,
+                                 int nBandValid, double *padfDensity )
+{
+    for( int iRow = 0; iRow < nRows; iRow++ )
+    {
+        const int iRowOffset = iSrcOffset + iRow * poWK->nSrcXSize;
+        for( int iCol = 0; iCol < nCols; iCol++ )
+        {
+            const int iOffset = iRowOffset + iCol;
+            if( poWK->panUnifiedSrcValid != NULL &&
+                !GWKIsValidBit(poWK->panUnifiedSrcValid, iOffset) )
+                return false;
+            for( int i = 0; i < nBandValid; i++ )
+            {
+                if( !GWKIsValidBit(papanBandValid[i], iOffset) )
+                    return false;
+            }
+            double dfDensity = 1.0;
+            if( poWK->pafUnifiedSrcDensity != NULL )
+            {
+                dfDensity = poWK->pafUnifiedSrcDensity[iOffset];
+                if( !(dfDensity > 0.000000001) )
+                    return false;
+            }
+            padfDensity[iRow * nCols + iCol] = dfDensity;
+        }
+    }
+    return true;
+}
+
+template<class T, GDALResampleAlg eResample>
+static void GWKResampleWithMasksThread( void* pData )
+
+{
+    GWKJobStruct* psJob = (GWKJobStruct*) pData;
+    GDALWarpKernel *poWK = psJob->poWK;
+    int iYMin = psJob->iYMin;
+    int iYMax = psJob->iYMax;
+
+    int iDstY;
+    int nDstXSize = poWK->nDstXSize;
+    int nSrcXSize = poWK->nSrcXSize, nSrcYSize = poWK->nSrcYSize;
+    const int nBands = poWK->nBands;
+
+    CPLAssert(eResample == GRA_Bilinear || eResample == GRA_Cubic);
+
+/* -------------------------------------------------------------------- */
+/*      Allocate x,y,z coordinate arrays for transformation ... one     */
+/*      scanlines worth of positions.                                   */
+/* -------------------------------------------------------------------- */
+    double *padfX, *padfY, *padfZ;
+    int    *pabSuccess;
+
+    padfX = (double *) CPLMalloc(sizeof(double) * nDstXSize);
+    padfY = (double *) CPLMalloc(sizeof(double) * nDstXSize);
+    padfZ = (double *) CPLMalloc(sizeof(double) * nDstXSize);
+    pabSuccess = (int *) CPLMalloc(sizeof(int) * nDstXSize);
+
+    double dfSrcCoordPrecision = CPLAtof(
+        CSLFetchNameValueDef(poWK->papszWarpOptions, "SRC_COORD_PRECISION", "0"));
+    double dfErrorThreshold = CPLAtof(
+        CSLFetchNameValueDef(poWK->papszWarpOptions, "ERROR_THRESHOLD", "0"));
+
+/* -------------------------------------------------------------------- */
+/*      Collect the per-band validity masks that are set.               */
+/* -------------------------------------------------------------------- */
+    std::vector<const GUInt32*> apanBandValid;
+    if( poWK->papanBandSrcValid != NULL )
+    {
+        for( int iBand = 0; iBand < nBands; iBand++ )
+        {
+            if( poWK->papanBandSrcValid[iBand] != NULL )
+                apanBandValid.push_back( poWK->papanBandSrcValid[iBand] );
+        }
+    }
+    const int nBandValid = static_cast<int>(apanBandValid.size());
+    const GUInt32* const* papanBandValid =
+        nBandValid ? &apanBandValid[0] : NULL;
+
+/* ==================================================================== */
+/*      Loop over output lines.                                         */
+/* ==================================================================== */
+    for( iDstY = iYMin; iDstY < iYMax; iDstY++ )
+    {
+        int iDstX;
+
+/* -------------------------------------------------------------------- */
+/*      Setup points to transform to source image space.                */
+/* -------------------------------------------------------------------- */
+        for( iDstX = 0; iDstX < nDstXSize; iDstX++ )
+        {
+            padfX[iDstX] = iDstX + 0.5 + poWK->nDstXOff;
+            padfY[iDstX] = iDstY + 0.5 + poWK->nDstYOff;
+            padfZ[iDstX] = 0.0;
+        }
+
+/* -------------------------------------------------------------------- */
+/*      Transform the points from destination pixel/line coordinates    */
+/*      to source pixel/line coordinates.                               */
+/* -------------------------------------------------------------------- */
+        poWK->pfnTransformer( psJob->pTransformerArg, TRUE, nDstXSize,
+                              padfX, padfY, padfZ, pabSuccess );
+        if( dfSrcCoordPrecision > 0.0 )
+        {
+            GWKRoundSourceCoordinates(nDstXSize, padfX, padfY, padfZ, pabSuccess,
+                                      dfSrcCoordPrecision,
+                                      dfErrorThreshold,
+                                      poWK->pfnTransformer,
+                                      psJob->pTransformerArg,
+                                      0.5 + poWK->nDstXOff,
+                                      iDstY + 0.5 + poWK->nDstYOff);
+        }
+
+/* ==================================================================== */
+/*      Loop over pixels in output scanline.                            */
+/* ==================================================================== */
+        for( iDstX = 0; iDstX < nDstXSize; iDstX++ )
+        {
+            int iSrcOffset;
+            if( !GWKCheckAndComputeSrcOffsets(pabSuccess, iDstX, padfX, padfY,
+                                    poWK, nSrcXSize, nSrcYSize, iSrcOffset) )
+                continue;
+
+            double  dfDensity = 1.0;
+
+            if( poWK->pafUnifiedSrcDensity != NULL )
+            {
+                dfDensity = poWK->pafUnifiedSrcDensity[iSrcOffset];
+                if( dfDensity < 0.00001 )
+                    continue;
+            }
+
+            if( poWK->panUnifiedSrcValid != NULL
+                && !GWKIsValidBit(poWK->panUnifiedSrcValid, iSrcOffset) )
+                continue;
+
+            const int iDstOffset = iDstX + iDstY * nDstXSize;
+            const double dfSrcX = padfX[iDstX] - poWK->nSrcXOff;
+            const double dfSrcY = padfY[iDstX] - poWK->nSrcYOff;
+            bool bHasFoundDensity = false;
+
+/* -------------------------------------------------------------------- */
+/*      Fast path: all the source pixels of the kernel are valid.       */
+/*      The arithmetic is the one of GWKBilinearResample4Sample()       */
+/*      and GWKCubicResample4Sample(), in the same order.               */
+/* -------------------------------------------------------------------- */
+            bool bFastPath = false;
+            if( eResample == GRA_Bilinear )
+            {
+                const int iSrcX = (int) floor(dfSrcX - 0.5);
+                const int iSrcY = (int) floor(dfSrcY - 0.5);
+                double adfDensity[4];
+                const int iKernelOffset = iSrcX + iSrcY * nSrcXSize;
+                if( iSrcX >= 0 && iSrcX + 1 < nSrcXSize &&
+                    iSrcY >= 0 && iSrcY + 1 < nSrcYSize &&
+                    GWKIsFootprintValid( poWK, iKernelOffset, 2, 2,
+                                         papanBandValid, nBandValid,
+                                         adfDensity ) )
+                {
+                    bFastPath = true;
+
+                    const double dfRatioX = 1.5 - (dfSrcX - iSrcX);
+                    const double dfRatioY = 1.5 - (dfSrcY - iSrcY);
+                    const double dfMult1 = dfRatioX * dfRatioY;
+                    const double dfMult2 = (1.0-dfRatioX) * dfRatioY;
+                    const double dfMult3 = dfRatioX * (1.0-dfRatioY);
+                    const double dfMult4 = (1.0-dfRatioX) * (1.0-dfRatioY);
+
+                    double dfDivisor = 0.0;
+                    dfDivisor += dfMult1;
+                    dfDivisor += dfMult2;
+                    dfDivisor += dfMult3;
+                    dfDivisor += dfMult4;
+                    double dfBandDensity = 0.0;
+                    dfBandDensity += adfDensity[0] * dfMult1;
+                    dfBandDensity += adfDensity[1] * dfMult2;
+                    dfBandDensity += adfDensity[2] * dfMult3;
+                    dfBandDensity += adfDensity[3] * dfMult4;
+
+                    if( dfDivisor < 0.00001 )
+                        continue;
+                    if( dfDivisor != 1.0 )
+                        dfBandDensity /= dfDivisor;
+                    if( dfBandDensity < 0.0000000001 )
+                        continue;
+
+                    int iBand = 0;  // Used after for.
+#if defined(__x86_64) || defined(_M_X64)
+                    // Two bands at a time. Each lane does the same
+                    // operations as the scalar code below.
+                    const XMMReg2Double v_mult1 =
+                        XMMReg2Double::Load1ValHighAndLow(&dfMult1);
+                    const XMMReg2Double v_mult2 =
+                        XMMReg2Double::Load1ValHighAndLow(&dfMult2);
+                    const XMMReg2Double v_mult3 =
+                        XMMReg2Double::Load1ValHighAndLow(&dfMult3);
+                    const XMMReg2Double v_mult4 =
+                        XMMReg2Double::Load1ValHighAndLow(&dfMult4);
+                    const XMMReg2Double v_divisor =
+                        XMMReg2Double::Load1ValHighAndLow(&dfDivisor);
+                    for( ; iBand + 1 < nBands; iBand += 2 )
+                    {
+                        const T* pSrc1 =
+                            ((const T*)poWK->papabySrcImage[iBand]) +
+                                                            iKernelOffset;
+                        const T* pSrc2 =
+                            ((const T*)poWK->papabySrcImage[iBand+1]) +
+                                                            iKernelOffset;
+                        double adfValues[2];
+                        XMMReg2Double v_value = XMMReg2Double::Zero();
+                        adfValues[0] = (double)pSrc1[0];
+                        adfValues[1] = (double)pSrc2[0];
+                        v_value += XMMReg2Double::Load2Val(adfValues) * v_mult1;
+                        adfValues[0] = (double)pSrc1[1];
+                        adfValues[1] = (double)pSrc2[1];
+                        v_value += XMMReg2Double::Load2Val(adfValues) * v_mult2;
+                        adfValues[0] = (double)pSrc1[nSrcXSize];
+                        adfValues[1] = (double)pSrc2[nSrcXSize];
+                        v_value += XMMReg2Double::Load2Val(adfValues) * v_mult3;
+                        adfValues[0] = (double)pSrc1[nSrcXSize + 1];
+                        adfValues[1] = (double)pSrc2[nSrcXSize + 1];
+                        v_value += XMMReg2Double::Load2Val(adfValues) * v_mult4;
+                        if( dfDivisor != 1.0 )
+                            v_value = v_value / v_divisor;
+                        v_value.Store2Double(adfValues);
+
+                        GWKSetPixelValueFromRealT<T>( poWK, iBand, iDstOffset,
+                                                      dfBandDensity,
+                                                      adfValues[0] );
+                        GWKSetPixelValueFromRealT<T>( poWK, iBand + 1,
+                                                      iDstOffset,
+                                                      dfBandDensity,
+                                                      adfValues[1] );
+                    }
+#endif
+                    for( ; iBand < nBands; iBand++ )
+                    {
+                        const T* pSrc =
+                            ((const T*)poWK->papabySrcImage[iBand]) +
+                                                            iKernelOffset;
+                        double dfValue = 0.0;
+                        dfValue += (double)pSrc[0] * dfMult1;
+                        dfValue += (double)pSrc[1] * dfMult2;
+                        dfValue += (double)pSrc[nSrcXSize] * dfMult3;
+                        dfValue += (double)pSrc[nSrcXSize + 1] * dfMult4;
+                        if( dfDivisor != 1.0 )
+                            dfValue /= dfDivisor;
+
+                        GWKSetPixelValueFromRealT<T>( poWK, iBand, iDstOffset,
+                                                      dfBandDensity, dfValue );
+                    }
+                    bHasFoundDensity = true;
+                }
+            }
+            else
+            {
+                const int iSrcX = (int) (dfSrcX - 0.5);
+                const int iSrcY = (int) (dfSrcY - 0.5);
+                double adfDensity[16];
+                const int iKernelOffset =
+                    (iSrcX - 1) + (iSrcY - 1) * nSrcXSize;
+                if( iSrcX - 1 >= 0 && iSrcX + 2 < nSrcXSize &&
+                    iSrcY - 1 >= 0 && iSrcY + 2 < nSrcYSize &&
+                    GWKIsFootprintValid( poWK, iKernelOffset, 4, 4,
+                                         papanBandValid, nBandValid,
+                                         adfDensity ) )
+                {
+                    bFastPath = true;
+
+                    const double dfDeltaX = dfSrcX - 0.5 - iSrcX;
+                    const double dfDeltaY = dfSrcY - 0.5 - iSrcY;
+                    const double dfDeltaX2 = dfDeltaX * dfDeltaX;
+                    const double dfDeltaY2 = dfDeltaY * dfDeltaY;
+                    const double dfDeltaX3 = dfDeltaX2 * dfDeltaX;
+                    const double dfDeltaY3 = dfDeltaY2 * dfDeltaY;
+
+                    double adfValueDens[4];
+                    for( int i = 0; i < 4; i++ )
+                    {
+                        adfValueDens[i] = CubicConvolution(
+                            dfDeltaX, dfDeltaX2, dfDeltaX3,
+                            adfDensity[4*i], adfDensity[4*i+1],
+                            adfDensity[4*i+2], adfDensity[4*i+3]);
+                    }
+                    const double dfBandDensity = CubicConvolution(
+                        dfDeltaY, dfDeltaY2, dfDeltaY3,
+                        adfValueDens[0], adfValueDens[1],
+                        adfValueDens[2], adfValueDens[3]);
+                    if( dfBandDensity < 0.0000000001 )
+                        continue;
+
+                    int iBand = 0;  // Used after for.
+#if defined(__x86_64) || defined(_M_X64)
+                    const XMMReg2Double v_deltaX =
+                        XMMReg2Double::Load1ValHighAndLow(&dfDeltaX);
+                    const XMMReg2Double v_deltaX2 =
+                        XMMReg2Double::Load1ValHighAndLow(&dfDeltaX2);
+                    const XMMReg2Double v_deltaX3 =
+                        XMMReg2Double::Load1ValHighAndLow(&dfDeltaX3);
+                    const XMMReg2Double v_deltaY =
+                        XMMReg2Double::Load1ValHighAndLow(&dfDeltaY);
+                    const XMMReg2Double v_deltaY2 =
+                        XMMReg2Double::Load1ValHighAndLow(&dfDeltaY2);
+                    const XMMReg2Double v_deltaY3 =
+                        XMMReg2Double::Load1ValHighAndLow(&dfDeltaY3);
+                    for( ; iBand + 1 < nBands; iBand += 2 )
+                    {
+                        const T* pSrc1 =
+                            ((const T*)poWK->papabySrcImage[iBand]) +
+                                                            iKernelOffset;
+                        const T* pSrc2 =
+                            ((const T*)poWK->papabySrcImage[iBand+1]) +
+                                                            iKernelOffset;
+                        XMMReg2Double av_row[4];
+                        for( int i = 0; i < 4; i++ )
+                        {
+                            XMMReg2Double av_col[4];
+                            for( int j = 0; j < 4; j++ )
+                            {
+                                double adfValues[2];
+                                adfValues[0] = (double)pSrc1[i * nSrcXSize + j];
+                                adfValues[1] = (double)pSrc2[i * nSrcXSize + j];
+                                av_col[j] = XMMReg2Double::Load2Val(adfValues);
+                            }
+                            av_row[i] = GWKCubicConvolution_SSE2(
+                                v_deltaX, v_deltaX2, v_deltaX3,
+                                av_col[0], av_col[1], av_col[2], av_col[3]);
+                        }
+                        double adfValues[2];
+                        GWKCubicConvolution_SSE2(
+                            v_deltaY, v_deltaY2, v_deltaY3,
+                            av_row[0], av_row[1],
+                            av_row[2], av_row[3]).Store2Double(adfValues);
+
+                        GWKSetPixelValueFromRealT<T>( poWK, iBand, iDstOffset,
+                                                      dfBandDensity,
+                                                      adfValues[0] );
+                        GWKSetPixelValueFromRealT<T>( poWK, iBand + 1,
+                                                      iDstOffset,
+                                                      dfBandDensity,
+                                                      adfValues[1] );
+                    }
+#endif
+                    for( ; iBand < nBands; iBand++ )
+                    {
+                        const T* pSrc =
+                            ((const T*)poWK->papabySrcImage[iBand]) +
+                                                            iKernelOffset;
+                        double adfValue[4];
+                        for( int i = 0; i < 4; i++ )
+                        {
+                            const T* pSrcRow = pSrc + i * nSrcXSize;
+                            adfValue[i] = CubicConvolution(
+                                dfDeltaX, dfDeltaX2, dfDeltaX3,
+                                (double)pSrcRow[0], (double)pSrcRow[1],
+                                (double)pSrcRow[2], (double)pSrcRow[3]);
+                        }
+                        const double dfValue = CubicConvolution(
+                            dfDeltaY, dfDeltaY2, dfDeltaY3,
+                            adfValue[0], adfValue[1],
+                            adfValue[2], adfValue[3]);
+
+                        GWKSetPixelValueFromRealT<T>( poWK, iBand, iDstOffset,
+                                                      dfBandDensity, dfValue );
+                    }
+                    bHasFoundDensity = true;
+                }
+            }
+
+/* -------------------------------------------------------------------- */
+/*      Otherwise, process each band as GWKGeneralCase() does.          */
+/* -------------------------------------------------------------------- */
+            if( !bFastPath )
+            {
+                for( int iBand = 0; iBand < nBands; iBand++ )
+                {
+                    double dfBandDensity = 0.0;
+                    double dfValueReal = 0.0;
+                    double dfValueImag = 0.0;
+
+                    if( eResample == GRA_Bilinear )
+                        GWKBilinearResample4Sample( poWK, iBand,
+                                                    dfSrcX, dfSrcY,
+                                                    &dfBandDensity,
+                                                    &dfValueReal, &dfValueImag );
+                    else
+                        GWKCubicResample4Sample( poWK, iBand,
+                                                 dfSrcX, dfSrcY,
+                                                 &dfBandDensity,
+                                                 &dfValueReal, &dfValueImag );
+
+                    // If we didn't find any valid inputs skip to next band.
+                    if ( dfBandDensity < 0.0000000001 )
+                        continue;
+
+                    bHasFoundDensity = true;
+
+                    GWKSetPixelValueFromRealT<T>( poWK, iBand, iDstOffset,
+                                                  dfBandDensity, dfValueReal );
+                }
+            }
+
+            if( !bHasFoundDensity )
+                continue;
+
+/* -------------------------------------------------------------------- */
+/*      Update destination density/validity masks.                      */
+/* -------------------------------------------------------------------- */
+            GWKOverlayDensity( poWK, iDstOffset, dfDensity );
+
+            if( poWK->panDstValid != NULL )
+            {
+                poWK->panDstValid[iDstOffset>>5] |=
+                    0x01 << (iDstOffset & 0x1f);
+            }
+        } /* Next iDstX */
+
+/* -------------------------------------------------------------------- */
+/*      Report progress to the user, and optionally cancel out.         */
+/* -------------------------------------------------------------------- */
+        if (psJob->pfnProgress && psJob->pfnProgress(psJob))
+            break;
+    }
+
+/* -------------------------------------------------------------------- */
+/*      Cleanup and return.                                             */
+/* -------------------------------------------------------------------- */
+    CPLFree( padfX );
+    CPLFree( padfY );
+    CPLFree( padfZ );
+    CPLFree( pabSuccess );
+}
+
+static CPLErr GWKBilinearWithMasksByte( GDALWarpKernel *poWK )
+{
+    return GWKRun( poWK, "GWKBilinearWithMasksByte",
+                   GWKResampleWithMasksThread<GByte,GRA_Bilinear> );
+}
+
+static CPLErr GWKBilinearWithMasksShort( GDALWarpKernel *poWK )
+{
+    return GWKRun( poWK, "GWKBilinearWithMasksShort",
+                   GWKResampleWithMasksThread<GInt16,GRA_Bilinear> );
+}
+
+static CPLErr GWKBilinearWithMasksUShort( GDALWarpKernel *poWK )
+{
+    return GWKRun( poWK, "GWKBilinearWithMasksUShort",
+                   GWKResampleWithMasksThread<GUInt16,GRA_Bilinear> );
+}
+
+static CPLErr GWKBilinearWithMasksFloat( GDALWarpKernel *poWK )
+{
+    return GWKRun( poWK, "GWKBilinearWithMasksFloat",
+                   GWKResampleWithMasksThread<float,GRA_Bilinear> );
+}
+
+static CPLErr GWKCubicWithMasksByte( GDALWarpKernel *poWK )
+{
+    return GWKRun( poWK, "GWKCubicWithMasksByte",
+                   GWKResampleWithMasksThread<GByte,GRA_Cubic> );
+}
+
+static CPLErr GWKCubicWithMasksShort( GDALWarpKernel *poWK )
+{
+    return GWKRun( poWK, "GWKCubicWithMasksShort",
+                   GWKResampleWithMasksThread<GInt16,GRA_Cubic> );
+}
+
+static CPLErr GWKCubicWithMasksUShort( GDALWarpKernel *poWK )
+{
+    return GWKRun( poWK, "GWKCubicWithMasksUShort",
+                   GWKResampleWithMasksThread<GUInt16,GRA_Cubic> );
+}
+
+static CPLErr GWKCubicWithMasksFloat( GDALWarpKernel *poWK )
+{
+    return GWKRun( poWK, "GWKCubicWithMasksFloat",
+                   GWKResampleWithMasksThread<float,GRA_Cubic> );
+}
+
 /************************************************************************/
 /*                          GWKNearestByte()                            */
 /*                                                                      */
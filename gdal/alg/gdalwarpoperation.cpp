@@ -29,9 +29,11 @@
  ****************************************************************************/
 
 #include "gdalwarper.h"
+#include "gdal_priv.h"
 #include "cpl_string.h"
 #include "cpl_multiproc.h"
 #include "ogr_api.h"
+#include <vector>
 
 CPL_CVSID("$Id$");
 
@@ -125,6 +127,14 @@ GDALWarpOperation::GDALWarpOperation()
 
     hIOMutex = NULL;
     hWarpMutex = NULL;
+    hDstIOMutex = NULL;
+
+    hChunkCondMutex = NULL;
+    hChunkCond = NULL;
+    nNextChunkToProcess = 0;
+    nNextChunkToAdvise = 0;
+    nNextChunkToWrite = 0;
+    bChunkPipelineAborted = FALSE;
 
     nChunkListCount = 0;
     nChunkListMax = 0;
@@ -749,6 +759,104 @@ CPLErr GDALChunkAndWarpImage( GDALWarpOperationH hOperation,
         ChunkAndWarpImage( nDstXOff, nDstYOff, nDstXSize, nDstYSize );
 }
 
+/************************************************************************/
+/*                          AdviseReadChunks()                          */
+/*                                                                      */
+/*      Let the source driver know about the source windows of the     */
+/*      next chunks to be processed, so that it can start fetching      */
+/*      them (asynchronously for some drivers) while the current        */
+/*      chunks are being warped.  Must be called with hIOMutex held.    */
+/************************************************************************/
+
+void GDALWarpOperation::AdviseReadChunks( int iFirstChunk, int nChunks )
+
+{
+    if( iFirstChunk < nNextChunkToAdvise )
+    {
+        nChunks -= nNextChunkToAdvise - iFirstChunk;
+        iFirstChunk = nNextChunkToAdvise;
+    }
+
+    for( int iChunk = iFirstChunk;
+         nChunks > 0 && iChunk < nChunkListCount;
+         iChunk++, nChunks-- )
+    {
+        const GDALWarpChunk *psChunk = pasChunkList + iChunk;
+
+        if( psChunk->ssx > 0 && psChunk->ssy > 0 )
+        {
+            GDALDatasetAdviseRead( psOptions->hSrcDS,
+                                   psChunk->sx, psChunk->sy,
+                                   psChunk->ssx, psChunk->ssy,
+                                   psChunk->ssx, psChunk->ssy,
+                                   psOptions->eWorkingDataType,
+                                   psOptions->nBandCount,
+                                   psOptions->panSrcBands, NULL );
+        }
+        nNextChunkToAdvise = iChunk + 1;
+    }
+}
+
+/************************************************************************/
+/*                          WaitForWriteTurn()                          */
+/*                                                                      */
+/*      In ChunkAndWarpMulti(), chunks are written in the order in      */
+/*      which they appear in the chunk list, so that the output is      */
+/*      written sequentially (which matters for STREAMABLE_OUTPUT).     */
+/*      Chunks are identified by the offset of their destination        */
+/*      window, as they do not overlap.  Returns FALSE if the           */
+/*      operation has been aborted in the meantime.                     */
+/************************************************************************/
+
+int GDALWarpOperation::WaitForWriteTurn( int nDstXOff, int nDstYOff )
+
+{
+    if( hChunkCond == NULL )
+        return TRUE;
+
+    CPLAcquireMutex( hChunkCondMutex, 1000.0 );
+    while( !bChunkPipelineAborted &&
+           nNextChunkToWrite < nChunkListCount &&
+           (pasChunkList[nNextChunkToWrite].dx != nDstXOff ||
+            pasChunkList[nNextChunkToWrite].dy != nDstYOff) )
+    {
+        CPLCondWait( hChunkCond, hChunkCondMutex );
+    }
+    const int bRet = !bChunkPipelineAborted;
+    CPLReleaseMutex( hChunkCondMutex );
+
+    return bRet;
+}
+
+/************************************************************************/
+/*                            EndWriteTurn()                            */
+/************************************************************************/
+
+void GDALWarpOperation::EndWriteTurn()
+
+{
+    if( hChunkCond == NULL )
+        return;
+
+    CPLAcquireMutex( hChunkCondMutex, 1000.0 );
+    nNextChunkToWrite++;
+    CPLCondBroadcast( hChunkCond );
+    CPLReleaseMutex( hChunkCondMutex );
+}
+
+/************************************************************************/
+/*                         AbortChunkPipeline()                         */
+/************************************************************************/
+
+void GDALWarpOperation::AbortChunkPipeline()
+
+{
+    CPLAcquireMutex( hChunkCondMutex, 1000.0 );
+    bChunkPipelineAborted = TRUE;
+    CPLCondBroadcast( hChunkCond );
+    CPLReleaseMutex( hChunkCondMutex );
+}
+
 /************************************************************************/
 /*                          ChunkThreadMain()                           */
 /************************************************************************/
@@ -756,58 +864,76 @@ CPLErr GDALChunkAndWarpImage( GDALWarpOperationH hOperation,
 typedef struct
 {
     GDALWarpOperation *poOperation;
-    GDALWarpChunk     *pasChunkInfo;
+    const double      *padfProgressBase;
+    int                nChunksInFlight;
     CPLJoinableThread *hThreadHandle;
     CPLErr             eErr;
-    double             dfProgressBase;
-    double             dfProgressScale;
-    CPLMutex          *hIOMutex;
-
-    CPLMutex          *hCondMutex;
-    volatile int       bIOMutexTaken;
-    CPLCond           *hCond;
 } ChunkThreadData;
 
 
-static void ChunkThreadMain( void *pThreadData )
+void GDALWarpOperation::ChunkThreadMain( void *pThreadData )
 
 {
-    volatile ChunkThreadData* psData = (volatile ChunkThreadData*) pThreadData;
+    ChunkThreadData *psData = (ChunkThreadData *) pThreadData;
+    GDALWarpOperation *poThis = psData->poOperation;
 
-    GDALWarpChunk *pasChunkInfo = psData->pasChunkInfo;
+    while( true )
+    {
+/* -------------------------------------------------------------------- */
+/*      Pick the next chunk to process.                                 */
+/* -------------------------------------------------------------------- */
+        CPLAcquireMutex( poThis->hChunkCondMutex, 1000.0 );
+        if( poThis->bChunkPipelineAborted ||
+            poThis->nNextChunkToProcess >= poThis->nChunkListCount )
+        {
+            CPLReleaseMutex( poThis->hChunkCondMutex );
+            break;
+        }
+        const int iChunk = poThis->nNextChunkToProcess++;
+        CPLReleaseMutex( poThis->hChunkCondMutex );
+
+        GDALWarpChunk *pasThisChunk = poThis->pasChunkList + iChunk;
 
 /* -------------------------------------------------------------------- */
-/*      Acquire IO mutex.                                               */
+/*      Advise the source driver of the windows of this chunk and of    */
+/*      the following ones that will be in flight with it.              */
 /* -------------------------------------------------------------------- */
-    if( !CPLAcquireMutex( psData->hIOMutex, 600.0 ) )
-    {
-        CPLError( CE_Failure, CPLE_AppDefined,
-                    "Failed to acquire IOMutex in WarpRegion()." );
-        psData->eErr = CE_Failure;
-    }
-    else
-    {
-        if (psData->hCond != NULL)
+        if( !CPLAcquireMutex( poThis->hIOMutex, 600.0 ) )
         {
-            CPLAcquireMutex( psData->hCondMutex, 1.0 );
-            psData->bIOMutexTaken = TRUE;
-            CPLCondSignal(psData->hCond);
-            CPLReleaseMutex( psData->hCondMutex );
+            CPLError( CE_Failure, CPLE_AppDefined,
+                      "Failed to acquire IOMutex in ChunkThreadMain()." );
+            psData->eErr = CE_Failure;
+            poThis->AbortChunkPipeline();
+            break;
         }
+        poThis->AdviseReadChunks( iChunk, psData->nChunksInFlight );
+        CPLReleaseMutex( poThis->hIOMutex );
 
-        psData->eErr = psData->poOperation->WarpRegion(
-                                    pasChunkInfo->dx, pasChunkInfo->dy,
-                                    pasChunkInfo->dsx, pasChunkInfo->dsy,
-                                    pasChunkInfo->sx, pasChunkInfo->sy,
-                                    pasChunkInfo->ssx, pasChunkInfo->ssy,
-                                    pasChunkInfo->sExtraSx, pasChunkInfo->sExtraSy,
-                                    psData->dfProgressBase,
-                                    psData->dfProgressScale);
+/* -------------------------------------------------------------------- */
+/*      Warp it.  WarpRegion() takes care of serializing the source     */
+/*      I/O, the warping and the destination I/O of concurrent chunks.  */
+/* -------------------------------------------------------------------- */
+        CPLDebug( "GDAL", "Start chunk %d.", iChunk );
+
+        const double dfProgressBase = psData->padfProgressBase[iChunk];
+        const CPLErr eErr = poThis->WarpRegion(
+                                pasThisChunk->dx, pasThisChunk->dy,
+                                pasThisChunk->dsx, pasThisChunk->dsy,
+                                pasThisChunk->sx, pasThisChunk->sy,
+                                pasThisChunk->ssx, pasThisChunk->ssy,
+                                pasThisChunk->sExtraSx, pasThisChunk->sExtraSy,
+                                dfProgressBase,
+                                psData->padfProgressBase[iChunk+1]
+                                                            - dfProgressBase );
 
-    /* -------------------------------------------------------------------- */
-    /*      Release the IO mutex.                                           */
-    /* -------------------------------------------------------------------- */
-        CPLReleaseMutex( psData->hIOMutex );
+        CPLDebug( "GDAL", "Finished chunk %d.", iChunk );
+
+        if( eErr != CE_None )
+        {
+            psData->eErr = eErr;
+            poThis->AbortChunkPipeline();
+            break;
+        }
     }
 }
 
@@ -825,7 +951,17 @@ static void ChunkThreadMain( void *pThreadData )
  *
  * Externally this method operates the same as ChunkAndWarpImage(), but
  * internally this method uses multiple threads to interleave input/output
- * for one region while the processing is being done for another.
+ * for some regions while the processing is being done for another.
+ *
+ * The number of chunks that are processed at the same time is controlled
+ * by the CHUNKS_IN_FLIGHT warp option (2 by default).  At any time, one
+ * chunk is being read from the source dataset, one is being warped (by the
+ * threads of the NUM_THREADS option) and one is being written to the
+ * destination dataset, the other chunks waiting for their turn.  The
+ * source windows of the chunks in flight are announced to the source
+ * driver with GDALDatasetAdviseRead(), and reading from the source dataset
+ * does not block writing to the destination dataset when those are
+ * distinct.  Chunks are still written in order.
  *
  * @param nDstXOff X offset to window of destination data to be produced.
  * @param nDstYOff Y offset to window of destination data to be produced.
@@ -839,16 +975,6 @@ CPLErr GDALWarpOperation::ChunkAndWarpMulti(
     int nDstXOff, int nDstYOff,  int nDstXSize, int nDstYSize )
 
 {
-    hIOMutex = CPLCreateMutex();
-    hWarpMutex = CPLCreateMutex();
-
-    CPLReleaseMutex( hIOMutex );
-    CPLReleaseMutex( hWarpMutex );
-
-    CPLCond* hCond = CPLCreateCond();
-    CPLMutex* hCondMutex = CPLCreateMutex();
-    CPLReleaseMutex(hCondMutex);
-
 /* -------------------------------------------------------------------- */
 /*      Collect the list of chunks to operate on.                       */
 /* -------------------------------------------------------------------- */
@@ -859,106 +985,116 @@ CPLErr GDALWarpOperation::ChunkAndWarpMulti(
     if( pasChunkList )
         qsort(pasChunkList, nChunkListCount, sizeof(GDALWarpChunk), OrderWarpChunk);
 
-/* -------------------------------------------------------------------- */
-/*      Process them one at a time, updating the progress               */
-/*      information for each region.                                    */
-/* -------------------------------------------------------------------- */
-    ChunkThreadData volatile asThreadData[2];
-    memset((void*)&asThreadData, 0, sizeof(asThreadData));
-    asThreadData[0].poOperation = this;
-    asThreadData[0].hIOMutex = hIOMutex;
-    asThreadData[1].poOperation = this;
-    asThreadData[1].hIOMutex = hIOMutex;
-
-    int iChunk;
-    double dfPixelsProcessed=0.0, dfTotalPixels = nDstXSize*(double)nDstYSize;
-
-    CPLErr eErr = CE_None;
-    for( iChunk = 0; iChunk < nChunkListCount+1; iChunk++ )
+    if( nChunkListCount == 0 )
     {
-        int    iThread = iChunk % 2;
+        WipeChunkList();
+        return CE_None;
+    }
+
+    int nChunksInFlight = atoi( CSLFetchNameValueDef(
+                        psOptions->papszWarpOptions, "CHUNKS_IN_FLIGHT", "2") );
+    if( nChunksInFlight < 1 )
+        nChunksInFlight = 1;
+    else if( nChunksInFlight > 64 )
+        nChunksInFlight = 64;
+    if( nChunksInFlight > nChunkListCount )
+        nChunksInFlight = nChunkListCount;
 
 /* -------------------------------------------------------------------- */
-/*      Launch thread for this chunk.                                   */
+/*      Setup the locks.  Source I/O is serialized by hIOMutex, warping  */
+/*      by hWarpMutex and destination I/O by hDstIOMutex, which is the   */
+/*      same as hIOMutex when both datasets are the same.               */
 /* -------------------------------------------------------------------- */
-        if( pasChunkList != NULL && iChunk < nChunkListCount )
-        {
-            GDALWarpChunk *pasThisChunk = pasChunkList + iChunk;
-            double dfChunkPixels = pasThisChunk->dsx * (double) pasThisChunk->dsy;
-
-            asThreadData[iThread].dfProgressBase = dfPixelsProcessed / dfTotalPixels;
-            asThreadData[iThread].dfProgressScale = dfChunkPixels / dfTotalPixels;
-
-            dfPixelsProcessed += dfChunkPixels;
-
-            asThreadData[iThread].pasChunkInfo = pasThisChunk;
+    hIOMutex = CPLCreateMutex();
+    hWarpMutex = CPLCreateMutex();
+    CPLReleaseMutex( hIOMutex );
+    CPLReleaseMutex( hWarpMutex );
 
-            if ( iChunk == 0 )
-            {
-                asThreadData[iThread].hCond = hCond;
-                asThreadData[iThread].hCondMutex = hCondMutex;
-            }
-            else
-            {
-                asThreadData[iThread].hCond = NULL;
-                asThreadData[iThread].hCondMutex = NULL;
-            }
-            asThreadData[iThread].bIOMutexTaken = FALSE;
+    if( psOptions->hDstDS == psOptions->hSrcDS )
+        hDstIOMutex = hIOMutex;
+    else
+    {
+        hDstIOMutex = CPLCreateMutex();
+        CPLReleaseMutex( hDstIOMutex );
+    }
 
-            CPLDebug( "GDAL", "Start chunk %d.", iChunk );
-            asThreadData[iThread].hThreadHandle =
-                CPLCreateJoinableThread( ChunkThreadMain, (void*) &asThreadData[iThread] );
-            if( asThreadData[iThread].hThreadHandle == NULL )
-            {
-                CPLError( CE_Failure, CPLE_AppDefined,
-                          "CPLCreateJoinableThread() failed in ChunkAndWarpMulti()" );
-                eErr = CE_Failure;
-                break;
-            }
+    hChunkCond = CPLCreateCond();
+    hChunkCondMutex = CPLCreateMutex();
+    CPLReleaseMutex( hChunkCondMutex );
 
-            /* Wait that the first thread has acquired the IO mutex before proceeding. */
-            /* (This will ensure that the first thread will run before the second one). */
-            if( iChunk == 0 )
-            {
-                CPLAcquireMutex(hCondMutex, 1.0);
-                while (asThreadData[iThread].bIOMutexTaken == FALSE)
-                    CPLCondWait(hCond, hCondMutex);
-                CPLReleaseMutex(hCondMutex);
-            }
-        }
+    nNextChunkToProcess = 0;
+    nNextChunkToAdvise = 0;
+    nNextChunkToWrite = 0;
+    bChunkPipelineAborted = FALSE;
 
 /* -------------------------------------------------------------------- */
-/*      Wait for previous chunks thread to complete.                    */
+/*      Compute the progress range of each chunk.                       */
 /* -------------------------------------------------------------------- */
-        if( iChunk > 0 )
-        {
-            iThread = (iChunk-1) % 2;
+    std::vector<double> adfProgressBase( nChunkListCount + 1 );
+    double dfPixelsProcessed = 0.0;
+    const double dfTotalPixels = nDstXSize * (double) nDstYSize;
 
-            /* Wait for thread to finish. */
-            CPLJoinThread(asThreadData[iThread].hThreadHandle);
-            asThreadData[iThread].hThreadHandle = NULL;
+    for( int iChunk = 0; iChunk < nChunkListCount; iChunk++ )
+    {
+        adfProgressBase[iChunk] = dfPixelsProcessed / dfTotalPixels;
+        dfPixelsProcessed +=
+            pasChunkList[iChunk].dsx * (double) pasChunkList[iChunk].dsy;
+    }
+    adfProgressBase[nChunkListCount] = dfPixelsProcessed / dfTotalPixels;
 
-            CPLDebug( "GDAL", "Finished chunk %d.", iChunk-1 );
+/* -------------------------------------------------------------------- */
+/*      Launch one thread per chunk in flight.  Each one repeatedly     */
+/*      picks the next chunk in the list until none is left.            */
+/* -------------------------------------------------------------------- */
+    std::vector<ChunkThreadData> asThreadData( nChunksInFlight );
+    CPLErr eErr = CE_None;
 
-            eErr = asThreadData[iThread].eErr;
+    CPLDebug( "GDAL", "Processing %d chunks with %d chunks in flight.",
+              nChunkListCount, nChunksInFlight );
 
-            if( eErr != CE_None )
-                break;
+    for( int iThread = 0; iThread < nChunksInFlight; iThread++ )
+    {
+        asThreadData[iThread].poOperation = this;
+        asThreadData[iThread].padfProgressBase = &adfProgressBase[0];
+        asThreadData[iThread].nChunksInFlight = nChunksInFlight;
+        asThreadData[iThread].eErr = CE_None;
+        asThreadData[iThread].hThreadHandle =
+            CPLCreateJoinableThread( ChunkThreadMain, &asThreadData[iThread] );
+        if( asThreadData[iThread].hThreadHandle == NULL )
+        {
+            CPLError( CE_Failure, CPLE_AppDefined,
+                      "CPLCreateJoinableThread() failed in ChunkAndWarpMulti()" );
+            eErr = CE_Failure;
+            AbortChunkPipeline();
+            break;
         }
     }
 
-    /* -------------------------------------------------------------------- */
-    /*      Wait for all threads to complete.                               */
-    /* -------------------------------------------------------------------- */
-    int iThread;
-    for(iThread = 0; iThread < 2; iThread ++)
+/* -------------------------------------------------------------------- */
+/*      Wait for all threads to complete.                               */
+/* -------------------------------------------------------------------- */
+    for( int iThread = 0; iThread < nChunksInFlight; iThread++ )
     {
-        if (asThreadData[iThread].hThreadHandle)
-            CPLJoinThread(asThreadData[iThread].hThreadHandle);
+        if( asThreadData[iThread].hThreadHandle )
+        {
+            CPLJoinThread( asThreadData[iThread].hThreadHandle );
+            if( eErr == CE_None )
+                eErr = asThreadData[iThread].eErr;
+        }
     }
 
-    CPLDestroyCond(hCond);
-    CPLDestroyMutex(hCondMutex);
+    CPLDestroyCond( hChunkCond );
+    CPLDestroyMutex( hChunkCondMutex );
+    hChunkCond = NULL;
+    hChunkCondMutex = NULL;
+
+    if( hDstIOMutex != hIOMutex )
+        CPLDestroyMutex( hDstIOMutex );
+    CPLDestroyMutex( hIOMutex );
+    CPLDestroyMutex( hWarpMutex );
+    hDstIOMutex = NULL;
+    hIOMutex = NULL;
+    hWarpMutex = NULL;
 
     WipeChunkList();
 
@@ -1359,6 +1495,8 @@ CPLErr GDALWarpOperation::WarpRegion( int nDstXOff, int nDstYOff,
 /* -------------------------------------------------------------------- */
     if( pszInitDest == NULL )
     {
+        CPLMutexHolderOptionalLockD( hDstIOMutex );
+
         eErr = GDALDatasetRasterIO( psOptions->hDstDS, GF_Read,
                                     nDstXOff, nDstYOff, nDstXSize, nDstYSize,
                                     pDstBuffer, nDstXSize, nDstYSize,
@@ -1386,10 +1524,17 @@ CPLErr GDALWarpOperation::WarpRegion( int nDstXOff, int nDstYOff,
                                dfProgressBase, dfProgressScale);
 
 /* -------------------------------------------------------------------- */
-/*      Write the output data back to disk if all went well.            */
+/*      Write the output data back to disk if all went well.  In        */
+/*      ChunkAndWarpMulti(), wait for the previous chunks to be         */
+/*      written first.                                                  */
 /* -------------------------------------------------------------------- */
+    if( eErr == CE_None && !WaitForWriteTurn( nDstXOff, nDstYOff ) )
+        eErr = CE_Failure;
+
     if( eErr == CE_None )
     {
+        CPLMutexHolderOptionalLockD( hDstIOMutex );
+
         eErr = GDALDatasetRasterIO( psOptions->hDstDS, GF_Write,
                                     nDstXOff, nDstYOff, nDstXSize, nDstYSize,
                                     pDstBuffer, nDstXSize, nDstYSize,
@@ -1411,6 +1556,9 @@ CPLErr GDALWarpOperation::WarpRegion( int nDstXOff, int nDstYOff,
         ReportTiming( "Output buffer write" );
     }
 
+    if( eErr == CE_None )
+        EndWriteTurn();
+
 /* -------------------------------------------------------------------- */
 /*      Cleanup and return.                                             */
 /* -------------------------------------------------------------------- */
@@ -1510,6 +1658,22 @@ CPLErr GDALWarpOperation::WarpRegionToBuffer(
     (void) eBufDataType;
     CPLAssert( eBufDataType == psOptions->eWorkingDataType );
 
+/* -------------------------------------------------------------------- */
+/*      Acquire IO mutex for the source reading part.                   */
+/* -------------------------------------------------------------------- */
+    if( hIOMutex != NULL && !CPLAcquireMutex( hIOMutex, 600.0 ) )
+    {
+        CPLError( CE_Failure, CPLE_AppDefined,
+                  "Failed to acquire IOMutex in WarpRegion()." );
+        return CE_Failure;
+    }
+
+    // The source reads may push dirty blocks of the destination out of the
+    // block cache, while another chunk writes them under hDstIOMutex.  Leave
+    // their flushing to the threads that hold hDstIOMutex.
+    if( hIOMutex != NULL )
+        GDALRasterBlock::EnterDisableDirtyBlockFlush();
+
 /* -------------------------------------------------------------------- */
 /*      If not given a corresponding source window compute one now.     */
 /* -------------------------------------------------------------------- */
@@ -1520,7 +1684,14 @@ CPLErr GDALWarpOperation::WarpRegionToBuffer(
                                     &nSrcXSize, &nSrcYSize,
                                     &nSrcXExtraSize, &nSrcYExtraSize, NULL );
         if( eErr != CE_None )
+        {
+            if( hIOMutex != NULL )
+            {
+                GDALRasterBlock::LeaveDisableDirtyBlockFlush();
+                CPLReleaseMutex( hIOMutex );
+            }
             return eErr;
+        }
     }
 
 /* -------------------------------------------------------------------- */
@@ -1565,6 +1736,11 @@ CPLErr GDALWarpOperation::WarpRegionToBuffer(
         CPLError( CE_Failure, CPLE_AppDefined,
                   "Integer overflow : nSrcXSize=%d, nSrcYSize=%d",
                   nSrcXSize, nSrcYSize);
+        if( hIOMutex != NULL )
+        {
+            GDALRasterBlock::LeaveDisableDirtyBlockFlush();
+            CPLReleaseMutex( hIOMutex );
+        }
         return CE_Failure;
     }
 
@@ -1686,6 +1862,7 @@ CPLErr GDALWarpOperation::WarpRegionToBuffer(
 
         eErr = CreateKernelMask( &oWK, i, "DstDensity" );
 
+        CPLMutexHolderOptionalLockD( hDstIOMutex );
         if( eErr == CE_None )
             eErr =
                 GDALWarpDstAlphaMasker( psOptions,
@@ -1872,6 +2049,7 @@ CPLErr GDALWarpOperation::WarpRegionToBuffer(
 /* -------------------------------------------------------------------- */
     if( hIOMutex != NULL )
     {
+        GDALRasterBlock::LeaveDisableDirtyBlockFlush();
         CPLReleaseMutex( hIOMutex );
         if( !CPLAcquireMutex( hWarpMutex, 600.0 ) )
         {
@@ -1905,24 +2083,22 @@ CPLErr GDALWarpOperation::WarpRegionToBuffer(
             (void *) &oWK, psOptions->pPostWarpProcessorArg );
 
 /* -------------------------------------------------------------------- */
-/*      Release Warp Mutex, and acquire io mutex.                       */
+/*      Release Warp Mutex.                                             */
 /* -------------------------------------------------------------------- */
     if( hIOMutex != NULL )
-    {
         CPLReleaseMutex( hWarpMutex );
-        if( !CPLAcquireMutex( hIOMutex, 600.0 ) )
-        {
-            CPLError( CE_Failure, CPLE_AppDefined,
-                      "Failed to acquire IOMutex in WarpRegion()." );
-            return CE_Failure;
-        }
-    }
 
 /* -------------------------------------------------------------------- */
 /*      Write destination alpha if available.                           */
 /* -------------------------------------------------------------------- */
+    if( eErr == CE_None && psOptions->nDstAlphaBand > 0 &&
+        !WaitForWriteTurn( nDstXOff, nDstYOff ) )
+        eErr = CE_Failure;
+
     if( eErr == CE_None && psOptions->nDstAlphaBand > 0 )
     {
+        CPLMutexHolderOptionalLockD( hDstIOMutex );
+
         eErr =
             GDALWarpDstAlphaMasker( psOptions,
                                     -psOptions->nBandCount,
@@ -0,0 +1,113 @@
+/* ****************************************************************************
+ * $Id$
+ *
+ * Project:  GDAL Utilities
+ * Purpose:  Write the compiled version of CSV tables, typically the ones
+ *           of the GDAL_DATA directory.
+ * Author:   agent, <agent at local>
+ *
+ * ****************************************************************************
+ * Copyright (c) 2026, agent <agent at local>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ ****************************************************************************/
+
+#include "cpl_conv.h"
+#include "cpl_csv.h"
+#include "cpl_string.h"
+#include "gdal.h"
+
+CPL_CVSID("$Id$");
+
+/************************************************************************/
+/*                               Usage()                                */
+/************************************************************************/
+static void Usage()
+
+{
+    printf( "Usage: gdalcompilecsv [-q] [-o <out.csvb>] <in.csv>*\n"
+            "\n"
+            "Writes the compiled version (.csvb) of each CSV table next to\n"
+            "it, or to the file specified with -o if there is a single\n"
+            "table.\n" );
+    exit( 1 );
+}
+
+/************************************************************************/
+/*                                main()                                */
+/************************************************************************/
+
+int main( int argc, char ** argv )
+
+{
+    const char *pszOutFilename = NULL;
+    bool bQuiet = false;
+    CPLStringList aosFilenames;
+
+    argc = GDALGeneralCmdLineProcessor( argc, &argv, 0 );
+    if( argc < 1 )
+        exit( -argc );
+
+/* -------------------------------------------------------------------- */
+/*      Process arguments.                                              */
+/* -------------------------------------------------------------------- */
+    for( int iArg = 1; iArg < argc; iArg++ )
+    {
+        if( EQUAL(argv[iArg],"-q") )
+        {
+            bQuiet = true;
+        }
+        else if( EQUAL(argv[iArg],"-o") && iArg + 1 < argc )
+        {
+            pszOutFilename = argv[++iArg];
+        }
+        else if( argv[iArg][0] == '-' )
+        {
+            Usage();
+        }
+        else
+        {
+            aosFilenames.AddString( argv[iArg] );
+        }
+    }
+
+    if( aosFilenames.size() == 0 ||
+        (pszOutFilename != NULL && aosFilenames.size() != 1) )
+        Usage();
+
+/* -------------------------------------------------------------------- */
+/*      Compile the tables.                                             */
+/* -------------------------------------------------------------------- */
+    int nRet = 0;
+    for( int i = 0; i < aosFilenames.size(); i++ )
+    {
+        if( !CSVCompile( aosFilenames[i], pszOutFilename ) )
+        {
+            nRet = 1;
+            continue;
+        }
+        if( !bQuiet )
+            printf( "%s compiled.\n", aosFilenames[i] );
+    }
+
+    CSLDestroy( argv );
+    GDALDestroyDriverManager();
+
+    return nRet;
+}
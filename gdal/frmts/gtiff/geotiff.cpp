@@ -38,7 +38,10 @@
 
 #include "cpl_port.h"  // Must be first.
 
+#include <algorithm>
 #include <set>
+#include <utility>
+#include <vector>
 
 #include "cpl_csv.h"
 #include "cplkeywordparser.h"
@@ -204,6 +207,27 @@ typedef struct
     bool          bReady;
 } GTiffCompressionJob;
 
+typedef struct
+{
+    GTiffDataset *poDS;
+    bool          bTIFFIsBigEndian;
+    char         *pszTmpFilename;
+    int           nStripOrTile;
+    int           nHeight;
+    uint16        nSamplesPerPixel;
+    uint16        nPredictor;
+    uint16        nYCbCrSubsampleHoriz;
+    uint16        nYCbCrSubsampleVert;
+    uint32        nJPEGTableSize;
+    void         *pJPEGTable;  // Owned by the TIFF handle of poDS.
+
+    GByte        *pabyCompressedBuffer;
+    int           nCompressedBufferSize;
+    GByte        *pabyBuffer;
+    int           nBufferSize;
+    bool          bSuccess;
+} GTiffDecompressionJob;
+
 class GTiffDataset CPL_FINAL : public GDALPamDataset
 {
     friend class GTiffBitmapBand;
@@ -412,6 +436,16 @@ class GTiffDataset CPL_FINAL : public GDALPamDataset
     int            SubmitCompressionJob(int nStripOrTile, GByte* pabyData,
                                         int cc, int nHeight);
 
+    // Only set on the base dataset. Shared with overviews and masks.
+    int            nDecompressionThreads;
+    CPLWorkerThreadPool *poDecompressThreadPool;
+    void           InitDecompressionThreads(char** papszOptions);
+    CPLWorkerThreadPool* GetDecompressionThreadPool();
+    static void    ThreadDecompressionFunc(void* pData);
+    void           MultiThreadedRead( int nXOff, int nYOff,
+                                      int nXSize, int nYSize,
+                                      int nBandCount, int *panBandMap );
+
     int            GuessJPEGQuality(int& bOutHasQuantizationTable,
                                     int& bOutHasHuffmanTable);
 
@@ -476,6 +510,11 @@ class GTiffDataset CPL_FINAL : public GDALPamDataset
                                GSpacing nPixelSpace, GSpacing nLineSpace,
                                GSpacing nBandSpace,
                                GDALRasterIOExtraArg* psExtraArg);
+    virtual CPLErr AdviseRead( int nXOff, int nYOff, int nXSize, int nYSize,
+                               int nBufXSize, int nBufYSize,
+                               GDALDataType eDT,
+                               int nBandCount, int *panBandList,
+                               char **papszOptions );
     virtual char **GetFileList(void);
 
     virtual CPLErr IBuildOverviews( const char *, int, int *, int, int *,
@@ -1040,6 +1079,9 @@ public:
                                   GDALDataType eBufType,
                                   GSpacing nPixelSpace, GSpacing nLineSpace,
                                   GDALRasterIOExtraArg* psExtraArg ) CPL_FINAL;
+    virtual CPLErr AdviseRead( int nXOff, int nYOff, int nXSize, int nYSize,
+                               int nBufXSize, int nBufYSize,
+                               GDALDataType eDT, char **papszOptions );
 
     virtual const char *GetDescription() const CPL_FINAL;
     virtual void        SetDescription( const char * ) CPL_FINAL;
@@ -1997,6 +2039,12 @@ CPLErr GTiffDataset::IRasterIO( GDALRWFlag eRWFlag,
             return static_cast<CPLErr>(nErr);
     }
 
+    if( eRWFlag == GF_Read )
+    {
+        MultiThreadedRead(nXOff, nYOff, nXSize, nYSize,
+                          nBandCount, panBandMap);
+    }
+
     ++nJPEGOverviewVisibilityFlag;
     const CPLErr eErr =
         GDALPamDataset::IRasterIO(
@@ -3828,6 +3876,142 @@ int GTiffDataset::DirectIO( GDALRWFlag eRWFlag,
 }
 
 
+/************************************************************************/
+/*                             AdviseRead()                             */
+/*                                                                      */
+/*      Compute the file ranges of the strips/tiles intersecting the    */
+/*      window and hand them to the VSI layer, so that network          */
+/*      filesystems can fetch them ahead of the actual reads.           */
+/************************************************************************/
+
+CPLErr GTiffDataset::AdviseRead( int nXOff, int nYOff, int nXSize, int nYSize,
+                                 int nBufXSize, int nBufYSize,
+                                 GDALDataType eDT,
+                                 int nBandCount, int *panBandList,
+                                 char ** /* papszOptions */ )
+{
+    int bStopProcessing = FALSE;
+    CPLErr eErr = ValidateRasterIOOrAdviseReadParameters(
+        "AdviseRead()", &bStopProcessing,
+        nXOff, nYOff, nXSize, nYSize, nBufXSize, nBufYSize,
+        nBandCount, panBandList );
+    if( eErr != CE_None || bStopProcessing )
+        return eErr;
+
+    // Try to pass the request to the most appropriate overview dataset.
+    if( nBufXSize < nXSize && nBufYSize < nYSize )
+    {
+        GDALRasterBand* poBand = GetRasterBand(
+            panBandList != NULL ? panBandList[0] : 1 );
+        ++nJPEGOverviewVisibilityFlag;
+        const int nOverview =
+            GDALBandGetBestOverviewLevel2( poBand, nXOff, nYOff,
+                                           nXSize, nYSize,
+                                           nBufXSize, nBufYSize, NULL );
+        GDALRasterBand* poOvrBand =
+            nOverview >= 0 ? poBand->GetOverview(nOverview) : NULL;
+        --nJPEGOverviewVisibilityFlag;
+        if( poOvrBand != NULL )
+        {
+            GDALDataset* poOvrDS = poOvrBand->GetDataset();
+            if( poOvrDS == NULL || poOvrDS == this )
+                return CE_None;
+            return poOvrDS->AdviseRead( nXOff, nYOff, nXSize, nYSize,
+                                        nBufXSize, nBufYSize, eDT,
+                                        nBandCount, panBandList, NULL );
+        }
+    }
+
+    if( eAccess != GA_ReadOnly || bStreamingIn || !SetDirectory() )
+        return CE_None;
+
+    const bool bTiled = CPL_TO_BOOL(TIFFIsTiled(hTIFF));
+    toff_t *panOffsets = NULL;
+    toff_t *panByteCounts = NULL;
+
+    const int nBlockX1 = nXOff / nBlockXSize;
+    const int nBlockY1 = nYOff / nBlockYSize;
+    const int nBlockX2 = (nXOff + nXSize - 1) / nBlockXSize;
+    const int nBlockY2 = (nYOff + nYSize - 1) / nBlockYSize;
+    const int nBlocksPerRow = DIV_ROUND_UP(nRasterXSize, nBlockXSize);
+    const int nBandIter =
+        nPlanarConfig == PLANARCONFIG_SEPARATE ? nBandCount : 1;
+
+    // Cap the number of ranges: the VSI layer has a bounded cache anyway.
+    const int nMaxBlocks = 1024;
+    std::vector< std::pair<vsi_l_offset, size_t> > aoRanges;
+    for( int iBand = 0; iBand < nBandIter; ++iBand )
+    {
+        const int nBandBlockIdShift =
+            nPlanarConfig == PLANARCONFIG_SEPARATE ?
+                ((panBandList != NULL ? panBandList[iBand] : iBand + 1) - 1) *
+                    nBlocksPerBand : 0;
+        for( int iY = nBlockY1; iY <= nBlockY2; ++iY )
+        {
+            for( int iX = nBlockX1; iX <= nBlockX2; ++iX )
+            {
+                if( static_cast<int>(aoRanges.size()) == nMaxBlocks )
+                    break;
+                const int nBlockId =
+                    iX + iY * nBlocksPerRow + nBandBlockIdShift;
+                if( nBlockId == nLoadedBlock || !IsBlockAvailable(nBlockId) )
+                    continue;
+                if( panOffsets == NULL )
+                {
+                    if( !TIFFGetField( hTIFF,
+                            bTiled ? TIFFTAG_TILEOFFSETS : TIFFTAG_STRIPOFFSETS,
+                            &panOffsets ) || panOffsets == NULL ||
+                        !TIFFGetField( hTIFF,
+                            bTiled ? TIFFTAG_TILEBYTECOUNTS :
+                                     TIFFTAG_STRIPBYTECOUNTS,
+                            &panByteCounts ) || panByteCounts == NULL )
+                    {
+                        return CE_None;
+                    }
+                }
+                if( panByteCounts[nBlockId] == 0 ||
+                    panByteCounts[nBlockId] >
+                        static_cast<toff_t>(INT_MAX) )
+                    continue;
+                aoRanges.push_back(
+                    std::pair<vsi_l_offset, size_t>(
+                        static_cast<vsi_l_offset>(panOffsets[nBlockId]),
+                        static_cast<size_t>(panByteCounts[nBlockId])) );
+            }
+        }
+    }
+    if( aoRanges.empty() )
+        return CE_None;
+
+    std::sort( aoRanges.begin(), aoRanges.end() );
+    std::vector<vsi_l_offset> anOffsets;
+    std::vector<size_t> anSizes;
+    for( size_t i = 0; i < aoRanges.size(); ++i )
+    {
+        anOffsets.push_back(aoRanges[i].first);
+        anSizes.push_back(aoRanges[i].second);
+    }
+    VSIFAdviseReadL( static_cast<int>(anOffsets.size()),
+                     &anOffsets[0], &anSizes[0],
+                     VSI_TIFFGetVSILFile(TIFFClientdata( hTIFF )) );
+
+    return CE_None;
+}
+
+/************************************************************************/
+/*                             AdviseRead()                             */
+/************************************************************************/
+
+CPLErr GTiffRasterBand::AdviseRead( int nXOff, int nYOff,
+                                    int nXSize, int nYSize,
+                                    int nBufXSize, int nBufYSize,
+                                    GDALDataType eDT, char **papszOptions )
+{
+    return poGDS->AdviseRead( nXOff, nYOff, nXSize, nYSize,
+                              nBufXSize, nBufYSize, eDT,
+                              1, &nBand, papszOptions );
+}
+
 /************************************************************************/
 /*                            IRasterIO()                               */
 /************************************************************************/
@@ -3881,6 +4065,11 @@ CPLErr GTiffRasterBand::IRasterIO( GDALRWFlag eRWFlag,
             return static_cast<CPLErr>(nErr);
     }
 
+    if( eRWFlag == GF_Read )
+    {
+        poGDS->MultiThreadedRead(nXOff, nYOff, nXSize, nYSize, 1, &nBand);
+    }
+
     if( poGDS->nBands != 1 &&
         poGDS->nPlanarConfig == PLANARCONFIG_CONTIG &&
         eRWFlag == GF_Read &&
@@ -6518,6 +6707,8 @@ GTiffDataset::GTiffDataset() :
     bHasDiscardedLsb(false),
     poCompressThreadPool(NULL),
     hCompressThreadPoolMutex(NULL),
+    nDecompressionThreads(0),
+    poDecompressThreadPool(NULL),
     m_pTempBufferForCommonDirectIO(NULL),
     m_nTempBufferForCommonDirectIOSize(0),
     m_bReadGeoTransform(false),
@@ -6674,6 +6865,10 @@ int GTiffDataset::Finalize()
         papoJPEGOverviewDS = NULL;
     }
 
+    // Overviews and masks may have used it, so only free it after them.
+    delete poDecompressThreadPool;
+    poDecompressThreadPool = NULL;
+
     // If we are a mask dataset, we can have overviews, but we don't
     // own them. We can only free the array, not the overviews themselves.
     CPLFree( papoOverviewDS );
@@ -7218,78 +7413,90 @@ bool GTiffDataset::WriteEncodedStrip( uint32 strip, GByte* pabyData,
 }
 
 /************************************************************************/
-/*                        InitCompressionThreads()                      */
+/*                         GTiffGetNumThreads()                         */
 /************************************************************************/
 
-void GTiffDataset::InitCompressionThreads(char** papszOptions)
+static int GTiffGetNumThreads(char** papszOptions)
 {
     const char* pszValue = CSLFetchNameValue( papszOptions, "NUM_THREADS" );
     if( pszValue == NULL )
         pszValue = CPLGetConfigOption("GDAL_NUM_THREADS", NULL);
-    if( pszValue )
+    if( pszValue == NULL )
+        return 0;
+
+    int nThreads = 0;
+    if( EQUAL(pszValue, "ALL_CPUS") )
+        nThreads = CPLGetNumCPUs();
+    else
+        nThreads = atoi(pszValue);
+    if( nThreads < 0 ||
+        (nThreads <= 1 &&
+         !EQUAL(pszValue, "0") &&
+         !EQUAL(pszValue, "1") &&
+         !EQUAL(pszValue, "ALL_CPUS")) )
     {
-        int nThreads = 0;
-        if( EQUAL(pszValue, "ALL_CPUS") )
-            nThreads = CPLGetNumCPUs();
+        CPLError(CE_Warning, CPLE_AppDefined,
+                 "Invalid value for NUM_THREADS: %s", pszValue);
+        return 0;
+    }
+    return nThreads;
+}
+
+/************************************************************************/
+/*                        InitCompressionThreads()                      */
+/************************************************************************/
+
+void GTiffDataset::InitCompressionThreads(char** papszOptions)
+{
+    const int nThreads = GTiffGetNumThreads(papszOptions);
+    if( nThreads > 1 )
+    {
+        if( nCompression == COMPRESSION_NONE ||
+            nCompression == COMPRESSION_JPEG )
+        {
+            CPLDebug( "GTiff",
+                      "NUM_THREADS ignored with uncompressed or JPEG" );
+        }
         else
-            nThreads = atoi(pszValue);
-        if( nThreads > 1 )
         {
-            if( nCompression == COMPRESSION_NONE ||
-                nCompression == COMPRESSION_JPEG )
+            CPLDebug("GTiff", "Using %d threads for compression", nThreads);
+            poCompressThreadPool = new CPLWorkerThreadPool();
+            if( !poCompressThreadPool->Setup(nThreads, NULL, NULL) )
             {
-                CPLDebug( "GTiff",
-                          "NUM_THREADS ignored with uncompressed or JPEG" );
+                delete poCompressThreadPool;
+                poCompressThreadPool = NULL;
             }
             else
             {
-                CPLDebug("GTiff", "Using %d threads for compression", nThreads);
-                poCompressThreadPool = new CPLWorkerThreadPool();
-                if( !poCompressThreadPool->Setup(nThreads, NULL, NULL) )
-                {
-                    delete poCompressThreadPool;
-                    poCompressThreadPool = NULL;
-                }
-                else
+                // Add a margin of an extra job w.r.t thread number
+                // so as to optimize compression time (enables the main
+                // thread to do boring I/O while all CPUs are working)
+                asCompressionJobs.resize(nThreads + 1);
+                memset(&asCompressionJobs[0], 0,
+                       asCompressionJobs.size() *
+                       sizeof(GTiffCompressionJob));
+                for( int i = 0;
+                     i < static_cast<int>(asCompressionJobs.size());
+                     ++i )
                 {
-                    // Add a margin of an extra job w.r.t thread number
-                    // so as to optimize compression time (enables the main
-                    // thread to do boring I/O while all CPUs are working)
-                    asCompressionJobs.resize(nThreads + 1);
-                    memset(&asCompressionJobs[0], 0,
-                           asCompressionJobs.size() *
-                           sizeof(GTiffCompressionJob));
-                    for( int i = 0;
-                         i < static_cast<int>(asCompressionJobs.size());
-                         ++i )
-                    {
-                        asCompressionJobs[i].pszTmpFilename =
-                            CPLStrdup(CPLSPrintf("/vsimem/gtiff/thread/job/%p",
-                                                 &asCompressionJobs[i]));
-                        asCompressionJobs[i].nStripOrTile = -1;
-                    }
-                    hCompressThreadPoolMutex = CPLCreateMutex();
-                    CPLReleaseMutex(hCompressThreadPoolMutex);
-
-                    // This is kind of a hack, but basically using
-                    // TIFFWriteRawStrip/Tile and then TIFFReadEncodedStrip/Tile
-                    // does not work on a newly created file, because
-                    // TIFF_MYBUFFER is not set in tif_flags
-                    // (if using TIFFWriteEncodedStrip/Tile first,
-                    // TIFFWriteBufferSetup() is automatically called).
-                    // This should likely rather fixed in libtiff itself.
-                    TIFFWriteBufferSetup(hTIFF, NULL, -1);
+                    asCompressionJobs[i].pszTmpFilename =
+                        CPLStrdup(CPLSPrintf("/vsimem/gtiff/thread/job/%p",
+                                             &asCompressionJobs[i]));
+                    asCompressionJobs[i].nStripOrTile = -1;
                 }
+                hCompressThreadPoolMutex = CPLCreateMutex();
+                CPLReleaseMutex(hCompressThreadPoolMutex);
+
+                // This is kind of a hack, but basically using
+                // TIFFWriteRawStrip/Tile and then TIFFReadEncodedStrip/Tile
+                // does not work on a newly created file, because
+                // TIFF_MYBUFFER is not set in tif_flags
+                // (if using TIFFWriteEncodedStrip/Tile first,
+                // TIFFWriteBufferSetup() is automatically called).
+                // This should likely rather fixed in libtiff itself.
+                TIFFWriteBufferSetup(hTIFF, NULL, -1);
             }
         }
-        else if( nThreads < 0 ||
-                 (!EQUAL(pszValue, "0") &&
-                  !EQUAL(pszValue, "1") &&
-                  !EQUAL(pszValue, "ALL_CPUS")) )
-        {
-            CPLError(CE_Warning, CPLE_AppDefined,
-                     "Invalid value for NUM_THREADS: %s", pszValue);
-        }
     }
 }
 
@@ -7540,6 +7747,403 @@ int GTiffDataset::SubmitCompressionJob(int nStripOrTile, GByte* pabyData,
     return TRUE;
 }
 
+/************************************************************************/
+/*                      InitDecompressionThreads()                      */
+/************************************************************************/
+
+void GTiffDataset::InitDecompressionThreads(char** papszOptions)
+{
+    const int nThreads = GTiffGetNumThreads(papszOptions);
+    if( nThreads > 1 )
+    {
+        // The worker pool itself is only instantiated on the first
+        // RasterIO() request that spans several compressed blocks.
+        CPLDebug("GTiff", "Using up to %d threads for decompression",
+                 nThreads);
+        nDecompressionThreads = nThreads;
+    }
+}
+
+/************************************************************************/
+/*                     GetDecompressionThreadPool()                     */
+/************************************************************************/
+
+CPLWorkerThreadPool* GTiffDataset::GetDecompressionThreadPool()
+{
+    // Overviews and masks share the pool of the main dataset.
+    GTiffDataset* poRootDS = this;
+    while( poRootDS->poBaseDS != NULL )
+        poRootDS = poRootDS->poBaseDS;
+
+    if( poRootDS->nDecompressionThreads <= 1 )
+        return NULL;
+    if( poRootDS->poDecompressThreadPool == NULL )
+    {
+        poRootDS->poDecompressThreadPool = new CPLWorkerThreadPool();
+        if( !poRootDS->poDecompressThreadPool->Setup(
+                        poRootDS->nDecompressionThreads, NULL, NULL) )
+        {
+            delete poRootDS->poDecompressThreadPool;
+            poRootDS->poDecompressThreadPool = NULL;
+            poRootDS->nDecompressionThreads = 0;
+        }
+    }
+    return poRootDS->poDecompressThreadPool;
+}
+
+/************************************************************************/
+/*                      ThreadDecompressionFunc()                       */
+/************************************************************************/
+
+void GTiffDataset::ThreadDecompressionFunc(void* pData)
+{
+    GTiffDecompressionJob* psJob = static_cast<GTiffDecompressionJob *>(pData);
+    GTiffDataset* poDS = psJob->poDS;
+    psJob->bSuccess = false;
+
+    // Wrap the raw strip/tile into a single strip TIFF file in /vsimem, so
+    // that libtiff can decode it with a codec state of its own.
+    VSILFILE* fpTmp = VSIFOpenL(psJob->pszTmpFilename, "wb+");
+    if( fpTmp == NULL )
+        return;
+    TIFF* hTIFFTmp = VSI_TIFFOpen(psJob->pszTmpFilename,
+        psJob->bTIFFIsBigEndian ? "wb+" : "wl+", fpTmp);
+    if( hTIFFTmp == NULL )
+    {
+        CPL_IGNORE_RET_VAL(VSIFCloseL(fpTmp));
+        VSIUnlink(psJob->pszTmpFilename);
+        return;
+    }
+    TIFFSetField(hTIFFTmp, TIFFTAG_IMAGEWIDTH, poDS->nBlockXSize);
+    TIFFSetField(hTIFFTmp, TIFFTAG_IMAGELENGTH, psJob->nHeight);
+    TIFFSetField(hTIFFTmp, TIFFTAG_BITSPERSAMPLE, poDS->nBitsPerSample);
+    TIFFSetField(hTIFFTmp, TIFFTAG_COMPRESSION, poDS->nCompression);
+    if( psJob->nPredictor != PREDICTOR_NONE )
+        TIFFSetField(hTIFFTmp, TIFFTAG_PREDICTOR, psJob->nPredictor);
+    TIFFSetField(hTIFFTmp, TIFFTAG_PHOTOMETRIC, poDS->nPhotometric);
+    TIFFSetField(hTIFFTmp, TIFFTAG_SAMPLEFORMAT, poDS->nSampleFormat);
+    TIFFSetField(hTIFFTmp, TIFFTAG_SAMPLESPERPIXEL, psJob->nSamplesPerPixel);
+    TIFFSetField(hTIFFTmp, TIFFTAG_ROWSPERSTRIP, psJob->nHeight);
+    TIFFSetField(hTIFFTmp, TIFFTAG_PLANARCONFIG, PLANARCONFIG_CONTIG);
+    if( poDS->nPhotometric == PHOTOMETRIC_YCBCR )
+    {
+        TIFFSetField(hTIFFTmp, TIFFTAG_YCBCRSUBSAMPLING,
+                     psJob->nYCbCrSubsampleHoriz,
+                     psJob->nYCbCrSubsampleVert);
+    }
+    if( psJob->pJPEGTable != NULL )
+    {
+        TIFFSetField(hTIFFTmp, TIFFTAG_JPEGTABLES,
+                     psJob->nJPEGTableSize, psJob->pJPEGTable);
+    }
+
+    bool bOK =
+        TIFFWriteRawStrip(hTIFFTmp, 0, psJob->pabyCompressedBuffer,
+                          psJob->nCompressedBufferSize) ==
+                                            psJob->nCompressedBufferSize;
+    XTIFFClose(hTIFFTmp);
+    if( VSIFCloseL(fpTmp) != 0 )
+        bOK = false;
+
+    if( bOK )
+    {
+        fpTmp = VSIFOpenL(psJob->pszTmpFilename, "rb");
+        hTIFFTmp = fpTmp ? VSI_TIFFOpen(psJob->pszTmpFilename, "r", fpTmp) :
+                           NULL;
+        if( hTIFFTmp == NULL )
+        {
+            bOK = false;
+        }
+        else
+        {
+            if( poDS->nCompression == COMPRESSION_JPEG &&
+                poDS->nPhotometric == PHOTOMETRIC_YCBCR )
+            {
+                TIFFSetField(hTIFFTmp, TIFFTAG_JPEGCOLORMODE,
+                             JPEGCOLORMODE_RGB);
+            }
+            bOK = TIFFReadEncodedStrip(hTIFFTmp, 0, psJob->pabyBuffer,
+                                       psJob->nBufferSize) != -1;
+            XTIFFClose(hTIFFTmp);
+        }
+        if( fpTmp != NULL )
+            CPL_IGNORE_RET_VAL(VSIFCloseL(fpTmp));
+    }
+    VSIUnlink(psJob->pszTmpFilename);
+
+    psJob->bSuccess = bOK;
+}
+
+/************************************************************************/
+/*                         MultiThreadedRead()                          */
+/*                                                                      */
+/*      Decode in worker threads all the strips/tiles intersecting      */
+/*      the requested window that are not already in the block cache,  */
+/*      and push them into it, so that the generic RasterIO() that      */
+/*      follows only has to pick them up. The raw bytes are fetched     */
+/*      in the calling thread, since fpL is not thread-safe.            */
+/************************************************************************/
+
+void GTiffDataset::MultiThreadedRead( int nXOff, int nYOff,
+                                      int nXSize, int nYSize,
+                                      int nBandCount, int *panBandMap )
+{
+    if( eAccess != GA_ReadOnly || bStreamingIn || nBands == 0 ||
+        bTreatAsRGBA || bTreatAsSplit || bTreatAsSplitBitmap ||
+        !(nCompression == COMPRESSION_ADOBE_DEFLATE ||
+          nCompression == COMPRESSION_DEFLATE ||
+          nCompression == COMPRESSION_LZW ||
+          nCompression == COMPRESSION_PACKBITS ||
+          nCompression == COMPRESSION_LZMA ||
+          nCompression == COMPRESSION_JPEG) ||
+        dynamic_cast<GTiffOddBitsBand*>(GetRasterBand(1)) != NULL )
+    {
+        return;
+    }
+
+    const int nBlockX1 = nXOff / nBlockXSize;
+    const int nBlockY1 = nYOff / nBlockYSize;
+    const int nBlockX2 = (nXOff + nXSize - 1) / nBlockXSize;
+    const int nBlockY2 = (nYOff + nYSize - 1) / nBlockYSize;
+    const int nXBlocks = nBlockX2 - nBlockX1 + 1;
+    const int nYBlocks = nBlockY2 - nBlockY1 + 1;
+    if( static_cast<GIntBig>(nXBlocks) * nYBlocks < 2 )
+        return;
+
+    const bool bSeparate = nPlanarConfig == PLANARCONFIG_SEPARATE;
+    const GDALDataType eDataType = GetRasterBand(1)->GetRasterDataType();
+    const int nDTSize = GDALGetDataTypeSizeBytes(eDataType);
+
+    // Decoding a pixel-interleaved block yields all the bands at once, so
+    // put them all in cache if it is big enough, as IReadBlock() does.
+    const GIntBig nBlockCacheSize =
+        static_cast<GIntBig>(nBlockXSize) * nBlockYSize * nDTSize;
+    const bool bAllBands =
+        !bSeparate && nBands > 1 &&
+        nBlockCacheSize < GDALGetCacheMax64() / nBands;
+    const int nOutBands = bSeparate ? nBandCount : 1;
+    const int nCachedBands = bSeparate ? 1 : (bAllBands ? nBands : nBandCount);
+    if( static_cast<GIntBig>(nXBlocks) * nYBlocks * nOutBands * nCachedBands *
+                nBlockCacheSize > GDALGetCacheMax64() )
+    {
+        // The decoded blocks would be evicted before being used.
+        return;
+    }
+
+    int nJPEGColorMode = JPEGCOLORMODE_RAW;
+    if( nCompression == COMPRESSION_JPEG &&
+        nPhotometric == PHOTOMETRIC_YCBCR &&
+        (!TIFFGetField(hTIFF, TIFFTAG_JPEGCOLORMODE, &nJPEGColorMode) ||
+         nJPEGColorMode != JPEGCOLORMODE_RGB) )
+    {
+        return;
+    }
+
+    CPLWorkerThreadPool* poPool = GetDecompressionThreadPool();
+    if( poPool == NULL || !SetDirectory() )
+        return;
+
+    const bool bTiled = CPL_TO_BOOL(TIFFIsTiled(hTIFF));
+    toff_t *panByteCounts = NULL;
+    if( !TIFFGetField( hTIFF,
+                       bTiled ? TIFFTAG_TILEBYTECOUNTS : TIFFTAG_STRIPBYTECOUNTS,
+                       &panByteCounts ) || panByteCounts == NULL )
+    {
+        return;
+    }
+
+    GTiffDecompressionJob sJobTemplate;
+    memset(&sJobTemplate, 0, sizeof(sJobTemplate));
+    sJobTemplate.poDS = this;
+    sJobTemplate.bTIFFIsBigEndian = CPL_TO_BOOL( TIFFIsBigEndian(hTIFF) );
+    sJobTemplate.nSamplesPerPixel = bSeparate ? 1 : nSamplesPerPixel;
+    sJobTemplate.nPredictor = PREDICTOR_NONE;
+    if( nCompression == COMPRESSION_LZW ||
+        nCompression == COMPRESSION_ADOBE_DEFLATE ||
+        nCompression == COMPRESSION_DEFLATE )
+    {
+        TIFFGetField( hTIFF, TIFFTAG_PREDICTOR, &sJobTemplate.nPredictor );
+    }
+    if( nPhotometric == PHOTOMETRIC_YCBCR )
+    {
+        TIFFGetFieldDefaulted( hTIFF, TIFFTAG_YCBCRSUBSAMPLING,
+                               &sJobTemplate.nYCbCrSubsampleHoriz,
+                               &sJobTemplate.nYCbCrSubsampleVert );
+    }
+    if( nCompression == COMPRESSION_JPEG )
+    {
+        uint32 nJPEGTableSize = 0;
+        void* pJPEGTable = NULL;
+        if( TIFFGetField( hTIFF, TIFFTAG_JPEGTABLES,
+                          &nJPEGTableSize, &pJPEGTable ) )
+        {
+            sJobTemplate.nJPEGTableSize = nJPEGTableSize;
+            sJobTemplate.pJPEGTable = pJPEGTable;
+        }
+    }
+
+    const int nBlockBufSize =
+        bTiled ? static_cast<int>(TIFFTileSize(hTIFF)) :
+                 static_cast<int>(TIFFStripSize(hTIFF));
+    if( nBlockBufSize <= 0 )
+        return;
+    const int nBlocksPerRow = DIV_ROUND_UP(nRasterXSize, nBlockXSize);
+
+/* -------------------------------------------------------------------- */
+/*      Fetch the raw bytes of the blocks that need to be decoded.      */
+/* -------------------------------------------------------------------- */
+    std::vector<GTiffDecompressionJob> asJobs;
+    bool bOK = true;
+    for( int iOutBand = 0; bOK && iOutBand < nOutBands; ++iOutBand )
+    {
+        for( int iY = nBlockY1; bOK && iY <= nBlockY2; ++iY )
+        {
+            for( int iX = nBlockX1; bOK && iX <= nBlockX2; ++iX )
+            {
+                int nBlockId = iX + iY * nBlocksPerRow;
+                if( bSeparate )
+                    nBlockId += (panBandMap[iOutBand] - 1) * nBlocksPerBand;
+
+                // Skip blocks for which all the target bands are cached.
+                bool bAllCached = true;
+                for( int i = 0; i < nCachedBands; ++i )
+                {
+                    const int nTargetBand =
+                        bSeparate ? panBandMap[iOutBand] :
+                        bAllBands ? i + 1 : panBandMap[i];
+                    GTiffRasterBand* poBand = static_cast<GTiffRasterBand*>(
+                        GetRasterBand(nTargetBand));
+                    GDALRasterBlock* poBlock =
+                        poBand->TryGetLockedBlockRef(iX, iY);
+                    if( poBlock == NULL )
+                    {
+                        bAllCached = false;
+                        break;
+                    }
+                    poBlock->DropLock();
+                }
+                if( bAllCached || nBlockId == nLoadedBlock ||
+                    !IsBlockAvailable(nBlockId) )
+                {
+                    continue;
+                }
+
+                const toff_t nByteCount = panByteCounts[nBlockId];
+                if( nByteCount > static_cast<toff_t>(INT_MAX) )
+                {
+                    bOK = false;
+                    break;
+                }
+
+                GTiffDecompressionJob sJob(sJobTemplate);
+                sJob.nStripOrTile = nBlockId;
+                sJob.nHeight = nBlockYSize;
+                if( !bTiled &&
+                    static_cast<int>((iY + 1) * nBlockYSize) > nRasterYSize )
+                {
+                    sJob.nHeight = nRasterYSize - iY * nBlockYSize;
+                }
+                sJob.nCompressedBufferSize = static_cast<int>(nByteCount);
+                sJob.pabyCompressedBuffer = static_cast<GByte*>(
+                    VSI_MALLOC_VERBOSE(sJob.nCompressedBufferSize));
+                sJob.nBufferSize = nBlockBufSize;
+                sJob.pabyBuffer = static_cast<GByte*>(
+                    VSI_CALLOC_VERBOSE(1, nBlockBufSize));
+                asJobs.push_back(sJob);
+                if( sJob.pabyCompressedBuffer == NULL ||
+                    sJob.pabyBuffer == NULL )
+                {
+                    bOK = false;
+                    break;
+                }
+
+                const tmsize_t nRead = bTiled ?
+                    TIFFReadRawTile( hTIFF, nBlockId,
+                                     sJob.pabyCompressedBuffer,
+                                     sJob.nCompressedBufferSize ) :
+                    TIFFReadRawStrip( hTIFF, nBlockId,
+                                      sJob.pabyCompressedBuffer,
+                                      sJob.nCompressedBufferSize );
+                if( nRead != static_cast<tmsize_t>(sJob.nCompressedBufferSize) )
+                {
+                    // Let IReadBlock() report the error if needed.
+                    asJobs.back().nCompressedBufferSize = 0;
+                }
+            }
+        }
+    }
+
+/* -------------------------------------------------------------------- */
+/*      Decode them.                                                    */
+/* -------------------------------------------------------------------- */
+    if( bOK && asJobs.size() >= 2 )
+    {
+        for( size_t i = 0; i < asJobs.size(); ++i )
+        {
+            if( asJobs[i].nCompressedBufferSize == 0 )
+                continue;
+            asJobs[i].pszTmpFilename =
+                CPLStrdup(CPLSPrintf("/vsimem/gtiff/thread/decjob/%p",
+                                     &asJobs[i]));
+            poPool->SubmitJob(ThreadDecompressionFunc, &asJobs[i]);
+        }
+        poPool->WaitCompletion();
+    }
+
+/* -------------------------------------------------------------------- */
+/*      Push the decoded data into the block cache.                     */
+/* -------------------------------------------------------------------- */
+    const int nWordBytes = nBitsPerSample / 8;
+    for( size_t i = 0; i < asJobs.size(); ++i )
+    {
+        GTiffDecompressionJob& sJob = asJobs[i];
+        if( sJob.bSuccess )
+        {
+            const int nBlockIdBand0 = sJob.nStripOrTile % nBlocksPerBand;
+            const int iX = nBlockIdBand0 % nBlocksPerRow;
+            const int iY = nBlockIdBand0 / nBlocksPerRow;
+            for( int j = 0; j < nCachedBands; ++j )
+            {
+                const int nTargetBand =
+                    bSeparate ? 1 + sJob.nStripOrTile / nBlocksPerBand :
+                    bAllBands ? j + 1 : panBandMap[j];
+                GTiffRasterBand* poBand = static_cast<GTiffRasterBand*>(
+                    GetRasterBand(nTargetBand));
+                GDALRasterBlock* poBlock =
+                    poBand->TryGetLockedBlockRef(iX, iY);
+                if( poBlock != NULL )
+                {
+                    poBlock->DropLock();
+                    continue;
+                }
+                poBlock = poBand->GetLockedBlockRef(iX, iY, TRUE);
+                if( poBlock == NULL )
+                    continue;
+                if( nBands == 1 || bSeparate )
+                {
+                    memcpy( poBlock->GetDataRef(), sJob.pabyBuffer,
+                            static_cast<size_t>(std::min(
+                                static_cast<GIntBig>(nBlockBufSize),
+                                nBlockCacheSize)) );
+                }
+                else
+                {
+                    GDALCopyWords( sJob.pabyBuffer +
+                                        (nTargetBand - 1) * nWordBytes,
+                                   eDataType, nBands * nWordBytes,
+                                   poBlock->GetDataRef(), eDataType,
+                                   nWordBytes,
+                                   nBlockXSize * nBlockYSize );
+                }
+                poBlock->DropLock();
+            }
+        }
+        CPLFree(sJob.pszTmpFilename);
+        VSIFree(sJob.pabyCompressedBuffer);
+        VSIFree(sJob.pabyBuffer);
+    }
+}
+
 /************************************************************************/
 /*                          DiscardLsb()                                */
 /************************************************************************/
@@ -10761,6 +11365,10 @@ GDALDataset *GTiffDataset::Open( GDALOpenInfo * poOpenInfo )
     {
         poDS->InitCreationOrOpenOptions(poOpenInfo->papszOpenOptions);
     }
+    else
+    {
+        poDS->InitDecompressionThreads(poOpenInfo->papszOpenOptions);
+    }
 
     if( nCompression == COMPRESSION_JPEG && poOpenInfo->eAccess == GA_Update )
     {
@@ -16653,7 +17261,7 @@ void GDALRegister_GTiff()
     poDriver->SetMetadataItem( GDAL_DMD_CREATIONOPTIONLIST, szCreateOptions );
     poDriver->SetMetadataItem( GDAL_DMD_OPENOPTIONLIST,
 "<OpenOptionList>"
-"   <Option name='NUM_THREADS' type='string' description='Number of worker threads for compression. Can be set to ALL_CPUS' default='1'/>"
+"   <Option name='NUM_THREADS' type='string' description='Number of worker threads for compression or decompression. Can be set to ALL_CPUS' default='1'/>"
 "   <Option name='GEOTIFF_KEYS_FLAVOR' type='string-select' default='STANDARD' description='Which flavor of GeoTIFF keys must be used (for writing)'>"
 "       <Value>STANDARD</Value>"
 "       <Value>ESRI_PE</Value>"
@@ -92,6 +92,10 @@ class MBTilesDataset : public GDALPamDataset, public GDALGPKGMBTilesLikePseudoDa
     virtual char      **GetMetadata( const char * pszDomain = "" );
     virtual const char *GetMetadataItem( const char* pszName, const char * pszDomain = "" );
 
+    virtual CPLErr    IRasterIO( GDALRWFlag, int, int, int, int,
+                                 void *, int, int, GDALDataType,
+                                 int, int *, GSpacing, GSpacing, GSpacing,
+                                 GDALRasterIOExtraArg* psExtraArg );
     virtual CPLErr    IBuildOverviews(
                         const char * pszResampling,
                         int nOverviews, int * panOverviewList,
@@ -891,6 +895,29 @@ static void LongLatToSphericalMercator(double* x, double* y)
   *y = Y;
 }
 
+/************************************************************************/
+/*                             IRasterIO()                              */
+/************************************************************************/
+
+CPLErr MBTilesDataset::IRasterIO( GDALRWFlag eRWFlag,
+                                   int nXOff, int nYOff, int nXSize, int nYSize,
+                                   void * pData, int nBufXSize, int nBufYSize,
+                                   GDALDataType eBufType,
+                                   int nBandCount, int *panBandMap,
+                                   GSpacing nPixelSpace, GSpacing nLineSpace,
+                                   GSpacing nBandSpace,
+                                   GDALRasterIOExtraArg* psExtraArg )
+{
+    if( eRWFlag == GF_Read && nXSize == nBufXSize && nYSize == nBufYSize )
+        PrefetchTiles(nXOff, nYOff, nXSize, nYSize);
+
+    return GDALPamDataset::IRasterIO( eRWFlag, nXOff, nYOff, nXSize, nYSize,
+                                      pData, nBufXSize, nBufYSize, eBufType,
+                                      nBandCount, panBandMap,
+                                      nPixelSpace, nLineSpace, nBandSpace,
+                                      psExtraArg );
+}
+
 /************************************************************************/
 /*                          SetGeoTransform()                           */
 /************************************************************************/
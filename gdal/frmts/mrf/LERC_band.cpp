@@ -28,6 +28,17 @@ USING_NAMESPACE_LERC
 
 NAMESPACE_MRF_START
 
+//
+// The LERC state that can be reused from one page to the next, so that
+// encoding and decoding pages of the same size doesn't allocate memory
+//
+class LERC_Codec {
+public:
+    CntZImage zImg;     // LERC 1
+    Lerc2 lerc2;        // LERC 2
+    BitMask2 bitMask;   // LERC 2 no data mask
+};
+
 // Load a buffer into a zImg
 template <typename T> void CntZImgFill(CntZImage &zImg, T *src, const ILImage &img)
 {
@@ -64,9 +75,10 @@ template <typename T> void CntZImgUFill(CntZImage &zImg, T *dst, const ILImage &
 }
 
 //  LERC 1 compression
-static CPLErr CompressLERC(buf_mgr &dst, buf_mgr &src, const ILImage &img, double precision)
+static CPLErr CompressLERC(buf_mgr &dst, buf_mgr &src, const ILImage &img, double precision,
+    LERC_Codec &codec)
 {
-    CntZImage zImg;
+    CntZImage &zImg = codec.zImg;
     // Fill data into zImg
 #define FILL(T) CntZImgFill(zImg, (T *)(src.buffer), img)
     switch (img.dt) {
@@ -95,9 +107,10 @@ static CPLErr CompressLERC(buf_mgr &dst, buf_mgr &src, const ILImage &img, doubl
     return CE_None;
 }
 
-static CPLErr DecompressLERC(buf_mgr &dst, buf_mgr &src, const ILImage &img)
+static CPLErr DecompressLERC(buf_mgr &dst, buf_mgr &src, const ILImage &img,
+    LERC_Codec &codec)
 {
-    CntZImage zImg;
+    CntZImage &zImg = codec.zImg;
     Byte *ptr = (Byte *)src.buffer;
     if (!zImg.read(&ptr, 1e12))
     {
@@ -148,12 +161,13 @@ template <typename T> int MaskFill(BitMask2 &bitMask, T *src, const ILImage &img
     return count;
 }
 
-static CPLErr CompressLERC2(buf_mgr &dst, buf_mgr &src, const ILImage &img, double precision)
+static CPLErr CompressLERC2(buf_mgr &dst, buf_mgr &src, const ILImage &img, double precision,
+    LERC_Codec &codec)
 {
     int w = img.pagesize.x;
     int h = img.pagesize.y;
     // So we build a bitmask to pass a pointer to bytes, which gets converted to a bitmask?
-    BitMask2 bitMask;
+    BitMask2 &bitMask = codec.bitMask;
     int ndv_count = 0;
     if (img.hasNoData) { // Only build a bitmask if no data value is defined
 	switch (img.dt) {
@@ -173,7 +187,8 @@ static CPLErr CompressLERC2(buf_mgr &dst, buf_mgr &src, const ILImage &img, doub
 	}
     }
     // Set bitmask if it has some ndvs
-    Lerc2 lerc2(w, h, (ndv_count == 0) ? NULL : bitMask.Bits());
+    Lerc2 &lerc2 = codec.lerc2;
+    lerc2.Set(w, h, (ndv_count == 0) ? NULL : bitMask.Bits());
     bool success = false;
     Byte *ptr = (Byte *)dst.buffer;
 
@@ -224,16 +239,18 @@ template <typename T> void UnMask(BitMask2 &bitMask, T *arr, const ILImage &img)
     return;
 }
 
-CPLErr LERC_Band::Decompress(buf_mgr &dst, buf_mgr &src)
+static CPLErr DecompressLERC2(buf_mgr &dst, buf_mgr &src, const ILImage &img,
+    LERC_Codec &codec)
 {
     const Byte *ptr = (Byte *)(src.buffer);
     Lerc2::HeaderInfo hdInfo;
-    Lerc2 lerc2;
+    Lerc2 &lerc2 = codec.lerc2;
     if (!lerc2.GetHeaderInfo(ptr, hdInfo))
-	return DecompressLERC(dst, src, img);
+	return DecompressLERC(dst, src, img, codec);
     // It is lerc2 here
     bool success = false;
-    BitMask2 bitMask(img.pagesize.x, img.pagesize.y);
+    BitMask2 &bitMask = codec.bitMask;
+    bitMask.SetSize(img.pagesize.x, img.pagesize.y);
     switch (img.dt) {
 #define DECODE(T) success = lerc2.Decode(&ptr, reinterpret_cast<T *>(dst.buffer), bitMask.Bits())
     case GDT_Byte:	DECODE(GByte);	    break;
@@ -269,16 +286,46 @@ CPLErr LERC_Band::Decompress(buf_mgr &dst, buf_mgr &src)
     return CE_None;
 }
 
+// Pages can be decoded and encoded by multiple threads at the same time,
+// each one gets its own codec
+LERC_Codec *LERC_Band::GetCodec()
+{
+    CPLMutexHolderD(&hCodecMutex);
+    if (codecs.empty())
+	return new LERC_Codec();
+    LERC_Codec *codec = codecs.back();
+    codecs.pop_back();
+    return codec;
+}
+
+void LERC_Band::ReleaseCodec(LERC_Codec *codec)
+{
+    CPLMutexHolderD(&hCodecMutex);
+    codecs.push_back(codec);
+}
+
+CPLErr LERC_Band::Decompress(buf_mgr &dst, buf_mgr &src)
+{
+    LERC_Codec *codec = GetCodec();
+    CPLErr ret = DecompressLERC2(dst, src, img, *codec);
+    ReleaseCodec(codec);
+    return ret;
+}
+
 CPLErr LERC_Band::Compress(buf_mgr &dst, buf_mgr &src)
 {
+    LERC_Codec *codec = GetCodec();
+    CPLErr ret;
     if (version == 2)
-	return CompressLERC2(dst, src, img, precision);
+	ret = CompressLERC2(dst, src, img, precision, *codec);
     else
-	return CompressLERC(dst, src, img, precision);
+	ret = CompressLERC(dst, src, img, precision, *codec);
+    ReleaseCodec(codec);
+    return ret;
 }
 
 LERC_Band::LERC_Band(GDALMRFDataset *pDS, const ILImage &image, int b, int level):
-    GDALMRFRasterBand(pDS, image, b, level)
+    GDALMRFRasterBand(pDS, image, b, level), hCodecMutex(NULL)
 {
     // Pick 1/1000 for floats and 0.5 losless for integers
     if (eDataType == GDT_Float32 || eDataType == GDT_Float64 )
@@ -295,6 +342,10 @@ LERC_Band::LERC_Band(GDALMRFDataset *pDS, const ILImage &image, int b, int level
 
 LERC_Band::~LERC_Band()
 {
+    for (size_t i = 0; i < codecs.size(); i++)
+	delete codecs[i];
+    if (hCodecMutex)
+	CPLDestroyMutex(hCodecMutex);
 }
 
 
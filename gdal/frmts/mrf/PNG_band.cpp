@@ -327,18 +327,19 @@ CPLErr PNG_Band::Decompress(buf_mgr &dst, buf_mgr &src)
 }
 
 CPLErr PNG_Band::Compress(buf_mgr &dst, buf_mgr &src)
-{   
-    if (!codec.PNGColors && img.comp == IL_PPNG) { // Late set PNG palette to conserve memory
+{   // May run on the dataset pool threads, so use a codec of its own
+    PNG_Codec pngc(img);
+    pngc.deflate_flags = deflate_flags;
+    if (img.comp == IL_PPNG) {
         GDALColorTable *poCT = GetColorTable();
         if (!poCT) {
             CPLError(CE_Failure, CPLE_NotSupported, "MRF PPNG needs a color table");
             return CE_Failure;
         }
-        ResetPalette(poCT, codec);
+        ResetPalette(poCT, pngc);
     }
 
-    codec.deflate_flags = deflate_flags;
-    return codec.CompressPNG(dst, src);
+    return pngc.CompressPNG(dst, src);
 }
 
 /**
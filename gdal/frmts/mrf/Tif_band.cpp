@@ -44,11 +44,12 @@
  */
 
 #include "marfa.h"
+#include "cpl_atomic_ops.h"
 
 NAMESPACE_MRF_START
 
 // Returns a string in /vsimem/ + prefix + count that doesn't exist when this function gets called
-// It is not thread safe, open the result as soon as possible
+// Open the result as soon as possible
 static CPLString uniq_memfname(const char *prefix)
 {
 
@@ -59,8 +60,9 @@ static CPLString uniq_memfname(const char *prefix)
 #else
     CPLString fname;
     VSIStatBufL statb;
-    static unsigned int cnt=0;
-    do fname.Printf("/vsimem/%s_%08x",prefix, cnt++);
+    static volatile int cnt=0;
+    do fname.Printf("/vsimem/%s_%08x",prefix,
+	static_cast<unsigned int>(CPLAtomicInc(&cnt)));
     while (!VSIStatL(fname, &statb));
     return fname;
 #endif
@@ -52,12 +52,16 @@
 #include <gdal_pam.h>
 #include <ogr_srs_api.h>
 #include <ogr_spatialref.h>
+#include <cpl_worker_thread_pool.h>
 
 // For printing values
 #include <ostream>
 #include <iostream>
 #include <sstream>
 
+#include <deque>
+#include <vector>
+
 #ifdef GDAL_COMPILATION
 #define NAMESPACE_MRF_START namespace GDAL_MRF {
 #define NAMESPACE_MRF_END   }
@@ -115,6 +119,28 @@ typedef struct {
     size_t size;
 } buf_mgr;
 
+class GDALMRFRasterBand;
+
+// An error raised while compressing a page, emitted again by the writing thread
+struct MRFDeferredError {
+    CPLErr eErr;
+    CPLErrorNum nErrNo;
+    CPLString osMsg;
+};
+
+// A page compressed by the dataset thread pool, see GDALMRFRasterBand::IWriteBlock
+struct MRFCompressJob {
+    GDALMRFRasterBand *band;
+    GUIntBig infooffset;
+    char *buffer;   // The raw page, followed by space for the compressed one
+    buf_mgr dst;    // The compressed page, somewhere in buffer
+    void *usebuff;  // What gets written, NULL for an empty page
+    CPLErr ret;
+    CPLErr compressret; // Result of Compress()
+    std::vector<MRFDeferredError> errors; // Raised by the worker
+    bool ready;     // Set by the worker, under the dataset compress mutex
+};
+
 // A tile index record, 16 bytes, big endian
 typedef struct {
     GIntBig offset;
@@ -361,10 +387,20 @@ public:
     void SetPBufferSize(unsigned int sz) {
         pbsize = sz;
     }
+
     unsigned int GetPBufferSize() {
         return pbsize;
     }
 
+    // Pool used to decode and encode pages concurrently, NULL if
+    // GDAL_NUM_THREADS does not ask for more than one thread
+    CPLWorkerThreadPool *GetThreadPool();
+
+    // Queue a page being compressed by the pool, pages are written in order
+    CPLErr QueueTile(MRFCompressJob *job);
+    // Write the queued pages, waiting for them, until only nMaxQueued are left
+    CPLErr WriteQueuedTiles(size_t nMaxQueued = 0);
+
 protected:
     CPLErr LevelInit(const int l);
 
@@ -494,6 +530,14 @@ protected:
     VF dfp;  // Data file handle
     VF ifp;  // Index file handle
 
+    // Page decoding and encoding threads, created on first use
+    CPLWorkerThreadPool *poThreadPool;
+    int nPoolThreads; // -1 until GDAL_NUM_THREADS is checked
+
+    // Pages being compressed, in the order they have to be written
+    std::deque<MRFCompressJob *> compressJobs;
+    CPLMutex *hCompressMutex;
+
     // statistical values
     std::vector<double> vNoData, vMin, vMax;
 };
@@ -506,6 +550,21 @@ public:
     virtual CPLErr IReadBlock(int xblk, int yblk, void *buffer);
     virtual CPLErr IWriteBlock(int xblk, int yblk, void *buffer);
 
+#if GDAL_VERSION_MAJOR >= 2
+    virtual CPLErr IRasterIO(GDALRWFlag, int, int, int, int,
+        void *, int, int, GDALDataType,
+        GSpacing, GSpacing, GDALRasterIOExtraArg*);
+#endif
+
+    // Also writes the pages still being compressed
+    virtual CPLErr FlushCache();
+
+    // Reads the index and the pages covering a range of blocks at once,
+    // decodes them, possibly in parallel, and stores the blocks of the
+    // requested bands in the block cache, for this band level
+    CPLErr PrefetchBlocks(int xblk0, int yblk0, int xblk1, int yblk1,
+        int nBandCount, const int *panBandMap);
+
     virtual GDALColorTable *GetColorTable() { return poDS->poColorTable; }
 
     CPLErr SetColorInterpretation(GDALColorInterp ci) { img.ci = ci; return CE_None; }
@@ -569,6 +628,11 @@ protected:
     // Read the index record itself, can be overwritten
     //    virtual CPLErr ReadTileIdx(const ILSize &, ILIdx &, GIntBig bias = 0);
 
+    // Decodes one page read by PrefetchBlocks, runs in the thread pool
+    static void DecodePage(void *);
+    // Encodes one page queued by IWriteBlock, runs in the thread pool
+    static void CompressPage(void *);
+
     GIntBig bandbit(int b) { return ((GIntBig)1) << b; }
     GIntBig bandbit() { return bandbit(m_band); }
     GIntBig AllBandMask() { return bandbit(poDS->nBands) - 1; }
@@ -706,6 +770,9 @@ protected:
 };
 
 #if defined(LERC)
+// Reusable LERC encoding and decoding state, defined in LERC_band.cpp
+class LERC_Codec;
+
 class LERC_Band : public GDALMRFRasterBand {
     friend class GDALMRFDataset;
 public:
@@ -716,6 +783,12 @@ protected:
     virtual CPLErr Compress(buf_mgr &dst, buf_mgr &src);
     double precision;
     int version;
+
+    // Codecs are kept and reused across pages, one per concurrent user
+    LERC_Codec *GetCodec();
+    void ReleaseCodec(LERC_Codec *codec);
+    std::vector<LERC_Codec *> codecs;
+    CPLMutex *hCodecMutex;
 };
 #endif
 
@@ -90,6 +90,9 @@ GDALMRFDataset::GDALMRFDataset()
     Quality = 0;
     dfp.acc = GF_Read;
     ifp.acc = GF_Read;
+    poThreadPool = NULL;
+    nPoolThreads = -1;
+    hCompressMutex = NULL;
 }
 
 bool GDALMRFDataset::SetPBuffer(unsigned int sz)
@@ -114,6 +117,11 @@ GDALMRFDataset::~GDALMRFDataset()
 
 {   // Make sure everything gets written
     FlushCache();
+    WriteQueuedTiles();
+    delete poThreadPool;
+    poThreadPool = NULL;
+    if (hCompressMutex)
+	CPLDestroyMutex(hCompressMutex);
     if (ifp.FP)
 	VSIFCloseL(ifp.FP);
     if (dfp.FP)
@@ -173,6 +181,19 @@ CPLErr GDALMRFDataset::IRasterIO(GDALRWFlag eRWFlag, int nXOff, int nYOff, int n
     if (!bCrystalized)
 	Crystalize();
 
+    // Read and decode all the pages involved at once, the parent
+    // implementation will then find the blocks in the cache
+    if (eRWFlag == GF_Read && cds == NULL && nBandCount > 0 &&
+	nXSize == nBufXSize && nYSize == nBufYSize)
+    {
+	GDALMRFRasterBand *b = static_cast<GDALMRFRasterBand *>(GetRasterBand(panBandMap[0]));
+	int nBlockXSize, nBlockYSize;
+	b->GetBlockSize(&nBlockXSize, &nBlockYSize);
+	b->PrefetchBlocks(nXOff / nBlockXSize, nYOff / nBlockYSize,
+	    (nXOff + nXSize - 1) / nBlockXSize, (nYOff + nYSize - 1) / nBlockYSize,
+	    nBandCount, panBandMap);
+    }
+
     //
     // Call the parent implementation, which splits it into bands and calls their IRasterIO
     // 
@@ -185,6 +206,91 @@ CPLErr GDALMRFDataset::IRasterIO(GDALRWFlag eRWFlag, int nXOff, int nYOff, int n
 }
 
 
+/**
+*\brief Lazily create the page decoding and encoding thread pool
+*
+* The number of threads is controlled by GDAL_NUM_THREADS, no pool is used
+* if it is not set or set to 1
+*/
+CPLWorkerThreadPool *GDALMRFDataset::GetThreadPool()
+{
+    if (nPoolThreads < 0) {
+	nPoolThreads = 0;
+	const char *pszThreads = CPLGetConfigOption("GDAL_NUM_THREADS", NULL);
+	if (pszThreads != NULL) {
+	    nPoolThreads = EQUAL(pszThreads, "ALL_CPUS") ?
+		CPLGetNumCPUs() : atoi(pszThreads);
+	    nPoolThreads = MIN(nPoolThreads, 128);
+	}
+	if (nPoolThreads > 1) {
+	    poThreadPool = new CPLWorkerThreadPool();
+	    if (!poThreadPool->Setup(nPoolThreads, NULL, NULL)) {
+		delete poThreadPool;
+		poThreadPool = NULL;
+	    }
+	    else {
+		hCompressMutex = CPLCreateMutex();
+		CPLReleaseMutex(hCompressMutex);
+	    }
+	}
+    }
+    return poThreadPool;
+}
+
+/**
+*\brief Queue a page submitted to the thread pool for compression
+*
+* The pages are written in the order they are queued, so the output does not
+* depend on the number of threads.  Returns the error of writing older pages
+*/
+CPLErr GDALMRFDataset::QueueTile(MRFCompressJob *job)
+{
+    compressJobs.push_back(job);
+    if (!job->ready)
+	poThreadPool->SubmitJob(GDALMRFRasterBand::CompressPage, job);
+    // Keep the pool busy while limiting the memory used
+    return WriteQueuedTiles(2 * nPoolThreads);
+}
+
+CPLErr GDALMRFDataset::WriteQueuedTiles(size_t nMaxQueued)
+{
+    CPLErr ret = CE_None;
+    while (compressJobs.size() > nMaxQueued) {
+	MRFCompressJob *job = compressJobs.front();
+	while (true) {
+	    // Count the pages not done yet, wait until at least one more is
+	    int pending = 0;
+	    CPLAcquireMutex(hCompressMutex, 1000.0);
+	    bool ready = job->ready;
+	    for (size_t i = 0; i < compressJobs.size(); i++)
+		if (!compressJobs[i]->ready)
+		    pending++;
+	    CPLReleaseMutex(hCompressMutex);
+	    if (ready)
+		break;
+	    poThreadPool->WaitCompletion(pending - 1);
+	}
+	compressJobs.pop_front();
+
+	// Report what happened in the worker, as IWriteBlock would have
+	for (size_t i = 0; i < job->errors.size(); i++)
+	    CPLError(job->errors[i].eErr, job->errors[i].nErrNo, "%s", job->errors[i].osMsg.c_str());
+	if (job->compressret != CE_None && job->errors.empty())
+	    CPLError(job->compressret, CPLE_AppDefined, "MRF: Compression error");
+
+	if (job->ret != CE_None) {
+	    CPLError(CE_Failure, CPLE_AppDefined, "MRF: Deflate error");
+	    WriteTile(NULL, job->infooffset, 0);
+	    ret = CE_Failure;
+	}
+	else if (CE_None != WriteTile(job->usebuff, job->infooffset, job->dst.size))
+	    ret = CE_Failure;
+	CPLFree(job->buffer);
+	delete job;
+    }
+    return ret;
+}
+
 /**
 *\brief Build some overviews
 *
@@ -56,6 +56,7 @@
 #include <ogr_spatialref.h>
 
 #include <vector>
+#include <algorithm>
 #include <assert.h>
 #include "../zlib/zlib.h"
 
@@ -662,6 +663,10 @@ CPLErr GDALMRFRasterBand::IReadBlock(int xblk, int yblk, void *buffer)
     if (poDS->bypass_cache && !poDS->source.empty())
 	return FetchBlock(xblk, yblk, buffer);
 
+    // Pages still being compressed have to be written before reading
+    if (!poDS->compressJobs.empty())
+	poDS->WriteQueuedTiles();
+
     if (CE_None != poDS->ReadTileIdx(tinfo, req, img)) {
 	CPLError( CE_Failure, CPLE_AppDefined,
 	    "MRF: Unable to read index at offset " CPL_FRMT_GIB, IdxOffset(req, img));
@@ -789,6 +794,305 @@ CPLErr GDALMRFRasterBand::IReadBlock(int xblk, int yblk, void *buffer)
     return RB(xblk, yblk, dst, buffer);
 }
 
+#if GDAL_VERSION_MAJOR >= 2
+CPLErr GDALMRFRasterBand::IRasterIO(GDALRWFlag eRWFlag,
+    int nXOff, int nYOff, int nXSize, int nYSize,
+    void *pData, int nBufXSize, int nBufYSize, GDALDataType eBufType,
+    GSpacing nPixelSpace, GSpacing nLineSpace, GDALRasterIOExtraArg* psExtraArgs)
+{
+    // Read and decode the pages for the whole window at once
+    if (eRWFlag == GF_Read && nXSize == nBufXSize && nYSize == nBufYSize) {
+	int band = m_band + 1;
+	PrefetchBlocks(nXOff / nBlockXSize, nYOff / nBlockYSize,
+	    (nXOff + nXSize - 1) / nBlockXSize, (nYOff + nYSize - 1) / nBlockYSize,
+	    1, &band);
+    }
+
+    return GDALPamRasterBand::IRasterIO(eRWFlag, nXOff, nYOff, nXSize, nYSize,
+	pData, nBufXSize, nBufYSize, eBufType, nPixelSpace, nLineSpace, psExtraArgs);
+}
+#endif
+
+// A page read by PrefetchBlocks, waiting to be decoded
+struct MRFPage {
+    GDALMRFRasterBand *band; // The band that decodes it
+    int x, y, c;
+    GIntBig offset;
+    size_t size;
+    char *src;  // Raw page, with 3 bytes of padding
+    char *dst;  // Decoded page, pageSizeBytes
+    CPLErr ret;
+};
+
+static bool PageOffsetLess(const MRFPage &a, const MRFPage &b)
+{
+    return a.offset < b.offset;
+}
+
+// Returns the band b (1 based) at level l
+static GDALMRFRasterBand *LevelBand(GDALMRFDataset *ds, int b, int l)
+{
+    GDALRasterBand *band = ds->GetRasterBand(b);
+    if (l && band->GetOverviewCount())
+	band = band->GetOverview(l - 1);
+    return static_cast<GDALMRFRasterBand *>(band);
+}
+
+// Same as the decoding part of IReadBlock, errors are not reported, the page
+// is left out and IReadBlock will report them when reading it again
+void GDALMRFRasterBand::DecodePage(void *p)
+{
+    MRFPage *page = static_cast<MRFPage *>(p);
+    GDALMRFRasterBand *band = page->band;
+    const ILImage &img = band->img;
+
+    CPLPushErrorHandler(CPLQuietErrorHandler);
+    buf_mgr src = { page->src, page->size };
+    buf_mgr dst;
+
+    if (band->deflatep) {
+	dst.size = img.pageSizeBytes + 1440;
+	dst.buffer = (char *)VSIMalloc(dst.size);
+	if (dst.buffer != NULL && ZUnPack(src, dst, band->deflate_flags)) {
+	    CPLFree(page->src);
+	    page->src = dst.buffer;
+	    src.size = dst.size;
+	}
+	else
+	    CPLFree(dst.buffer);
+    }
+
+    src.buffer = page->src;
+    dst.buffer = page->dst;
+    dst.size = img.pageSizeBytes;
+    page->ret = band->Decompress(dst, src);
+    dst.size = img.pageSizeBytes;
+    if (CE_None == page->ret && is_Endianess_Dependent(img.dt, img.comp) && (img.nbo != NET_ORDER))
+	swab_buff(dst, img);
+
+    CPLFree(page->src);
+    page->src = NULL;
+    CPLPopErrorHandler();
+}
+
+//
+// Fills the block cache for a window of blocks
+// The index records are read one row at a time, the data is read in file order,
+// merging the pages that are close to each other, and the pages are decoded by the
+// dataset thread pool when GDAL_NUM_THREADS is set.  Interleaved pages fill the blocks
+// of all the bands.
+// This is only an optimization, errors are left for IReadBlock to report
+//
+CPLErr GDALMRFRasterBand::PrefetchBlocks(int xblk0, int yblk0, int xblk1, int yblk1,
+    int nBandCount, const int *panBandMap)
+{
+    const int cstride = img.pagesize.c;
+
+    // Only for plain MRFs, caching and cloning ones do their own fetching
+    if (poDS->eAccess != GA_ReadOnly || !poDS->source.empty() || poDS->bypass_cache)
+	return CE_None;
+    if (1 != cstride && poDS->nBands != cstride)
+	return CE_None;
+
+    xblk0 = MAX(xblk0, 0);
+    yblk0 = MAX(yblk0, 0);
+    xblk1 = MIN(xblk1, img.pagecount.x - 1);
+    yblk1 = MIN(yblk1, img.pagecount.y - 1);
+    if (xblk1 < xblk0 || yblk1 < yblk0)
+	return CE_None;
+
+    const int nCols = xblk1 - xblk0 + 1;
+    const int nPagesPerBand = nCols * (yblk1 - yblk0 + 1);
+    const int nPageBands = (1 == cstride) ? nBandCount : 1;
+    if (nPagesPerBand * nPageBands < 2 || GIntBig(nPagesPerBand) * nPageBands
+	* img.pageSizeBytes > GDALGetCacheMax64() / 2)
+	return CE_None;
+
+    // Requested bands, at this level
+    vector<GDALMRFRasterBand *> bands;
+    for (int i = 0; i < nBandCount; i++) {
+	if (panBandMap[i] < 1 || panBandMap[i] > poDS->nBands)
+	    return CE_None;
+	bands.push_back(LevelBand(poDS, panBandMap[i], m_l));
+    }
+
+    // Interleaved pages fill all the bands
+    vector<GDALMRFRasterBand *> fillbands;
+    if (1 == cstride)
+	fillbands = bands;
+    else
+	for (int i = 0; i < poDS->nBands; i++)
+	    fillbands.push_back(LevelBand(poDS, i + 1, m_l));
+
+    VSILFILE *l_ifp = poDS->IdxFP();
+    if (l_ifp == NULL)
+	return CE_None;
+
+    vector<MRFPage> pages;
+    vector<ILIdx> idx(static_cast<size_t>(nCols) * img.pagecount.c);
+    for (int y = yblk0; y <= yblk1; y++) {
+	// Only the pages with blocks not already in the cache
+	vector<MRFPage> row;
+	for (int x = xblk0; x <= xblk1; x++) {
+	    for (int i = 0; i < static_cast<int>(bands.size()); i++) {
+		GDALRasterBlock *poBlock = bands[i]->TryGetLockedBlockRef(x, y);
+		if (poBlock != NULL) {
+		    poBlock->DropLock();
+		    continue;
+		}
+		MRFPage page;
+		page.band = (1 == cstride) ? bands[i] : this;
+		page.x = x;
+		page.y = y;
+		page.c = (1 == cstride) ? bands[i]->m_band : 0;
+		page.offset = 0;
+		page.size = 0;
+		page.src = NULL;
+		page.dst = NULL;
+		page.ret = CE_Failure;
+		row.push_back(page);
+		if (1 != cstride) // One page holds all the bands
+		    break;
+	    }
+	}
+
+	if (row.empty())
+	    continue;
+
+	// Read the index records for the whole row of pages
+	ILSize pos(xblk0, y, 0, 0, m_l);
+	VSIFSeekL(l_ifp, IdxOffset(pos, img), SEEK_SET);
+	if (idx.size() != VSIFReadL(&idx[0], sizeof(ILIdx), idx.size(), l_ifp))
+	    return CE_None;
+
+	for (size_t j = 0; j < row.size(); j++) {
+	    MRFPage &page = row[j];
+	    const ILIdx &tinfo = idx[static_cast<size_t>(page.x - xblk0) * img.pagecount.c + page.c];
+	    GIntBig size = net64(tinfo.size);
+	    page.offset = net64(tinfo.offset);
+	    if (size <= 0 || size > INT_MAX - 3) {
+		// Empty pages get filled with NoData, bad ones are left alone
+		if (0 != size)
+		    continue;
+		for (size_t i = 0; i < fillbands.size(); i++) {
+		    if (1 == cstride && fillbands[i] != page.band)
+			continue;
+		    GDALRasterBlock *poBlock = fillbands[i]->GetLockedBlockRef(page.x, page.y, TRUE);
+		    if (poBlock == NULL)
+			continue;
+		    fillbands[i]->FillBlock(poBlock->GetDataRef());
+		    poBlock->DropLock();
+		}
+		continue;
+	    }
+	    page.size = static_cast<size_t>(size);
+	    pages.push_back(page);
+	}
+    }
+
+    if (pages.empty())
+	return CE_None;
+
+    CPLDebug("MRF_IO", "Prefetch %d pages, level %d", static_cast<int>(pages.size()), m_l);
+
+    VSILFILE *l_dfp = poDS->DataFP();
+    if (l_dfp == NULL)
+	return CE_None;
+
+    // Read the data, in file order, merging nearby pages in single reads
+    const GIntBig MAXGAP = 4096;
+    const GIntBig MAXREAD = 16 * 1024 * 1024;
+    std::sort(pages.begin(), pages.end(), PageOffsetLess);
+    vector<char> chunk;
+    for (size_t i = 0; i < pages.size(); ) {
+	GIntBig start = pages[i].offset;
+	GIntBig end = start + pages[i].size;
+	size_t j = i + 1;
+	while (j < pages.size() && pages[j].offset <= end + MAXGAP
+	    && MAX(end, pages[j].offset + GIntBig(pages[j].size)) - start <= MAXREAD)
+	{
+	    end = MAX(end, pages[j].offset + GIntBig(pages[j].size));
+	    j++;
+	}
+
+	bool ok = true;
+	try {
+	    chunk.resize(static_cast<size_t>(end - start));
+	}
+	catch (const std::bad_alloc &) {
+	    ok = false;
+	}
+	ok = ok && 0 == VSIFSeekL(l_dfp, start, SEEK_SET)
+	    && 1 == VSIFReadL(&chunk[0], chunk.size(), 1, l_dfp);
+
+	for (; ok && i < j; i++) {
+	    MRFPage &page = pages[i];
+	    page.src = (char *)VSIMalloc(page.size + 3);
+	    page.dst = (char *)VSIMalloc(img.pageSizeBytes);
+	    if (page.src == NULL || page.dst == NULL) {
+		ok = false;
+		break;
+	    }
+	    memcpy(page.src, &chunk[static_cast<size_t>(page.offset - start)], page.size);
+	    memset(page.src + page.size, 0, 3);
+	}
+	i = j;
+    }
+
+    // Decode the pages, concurrently if possible
+    vector<void *> jobs;
+    for (size_t i = 0; i < pages.size(); i++)
+	if (pages[i].src != NULL && pages[i].dst != NULL)
+	    jobs.push_back(&pages[i]);
+
+    CPLWorkerThreadPool *pool = poDS->GetThreadPool();
+    if (pool != NULL && jobs.size() > 1) {
+	pool->SubmitJobs(DecodePage, jobs);
+	pool->WaitCompletion();
+    }
+    else {
+	for (size_t i = 0; i < jobs.size(); i++)
+	    DecodePage(jobs[i]);
+    }
+
+    // Store the decoded pages in the block cache
+    for (size_t i = 0; i < pages.size(); i++) {
+	MRFPage &page = pages[i];
+	if (CE_None == page.ret) {
+	    for (size_t b = 0; b < fillbands.size(); b++) {
+		GDALMRFRasterBand *band = fillbands[b];
+		if (1 == cstride && band != page.band)
+		    continue;
+		GDALRasterBlock *poBlock = band->GetLockedBlockRef(page.x, page.y, TRUE);
+		if (poBlock == NULL)
+		    continue;
+		void *ob = poBlock->GetDataRef();
+		if (1 == cstride) {
+		    memcpy(ob, page.dst, img.pageSizeBytes);
+		}
+		else {
+// Same as in RB, only the data type size matters
+#define CpySI(T) cpy_stride_in<T> (ob, (T *)page.dst + b,\
+    blockSizeBytes()/sizeof(T), cstride)
+		    switch (GDALGetDataTypeSize(eDataType)/8)
+		    {
+		    case 1: CpySI(GByte); break;
+		    case 2: CpySI(GInt16); break;
+		    case 4: CpySI(GInt32); break;
+		    case 8: CpySI(GIntBig); break;
+		    }
+#undef CpySI
+		}
+		poBlock->DropLock();
+	    }
+	}
+	CPLFree(page.src);
+	CPLFree(page.dst);
+    }
+
+    return CE_None;
+}
+
 
 /**
 *\brief Write a block from the provided buffer
@@ -800,6 +1104,88 @@ CPLErr GDALMRFRasterBand::IReadBlock(int xblk, int yblk, void *buffer)
 *
 */
 
+// Returns a new compression job, for an empty page if buffer is NULL
+static MRFCompressJob *NewCompressJob(GDALMRFRasterBand *band, GUIntBig infooffset, char *buffer)
+{
+    MRFCompressJob *job = new MRFCompressJob;
+    job->band = band;
+    job->infooffset = infooffset;
+    job->buffer = buffer;
+    job->dst.buffer = NULL;
+    job->dst.size = 0;
+    job->usebuff = NULL;
+    job->ret = CE_None;
+    job->compressret = CE_None;
+    job->ready = (NULL == buffer);
+    return job;
+}
+
+// Keeps the errors raised by a worker in the job, WriteQueuedTiles emits them
+static void CPL_STDCALL DeferCompressError(CPLErr eErr, CPLErrorNum nErrNo, const char *pszMsg)
+{
+    MRFCompressJob *job = static_cast<MRFCompressJob *>(CPLGetErrorHandlerUserData());
+    MRFDeferredError error;
+    error.eErr = eErr;
+    error.nErrNo = nErrNo;
+    error.osMsg = pszMsg;
+    job->errors.push_back(error);
+}
+
+//
+// Same as the compression part of IWriteBlock, the raw page is at the start of the job
+// buffer, followed by pbsize bytes for the compressed one
+//
+void GDALMRFRasterBand::CompressPage(void *p)
+{
+    MRFCompressJob *job = static_cast<MRFCompressJob *>(p);
+    GDALMRFRasterBand *band = job->band;
+    GDALMRFDataset *ds = band->poDS;
+    const ILImage &img = band->img;
+    CPLErr ret = CE_None;
+    CPLPushErrorHandlerEx(DeferCompressError, job);
+    CPLSetCurrentErrorHandlerCatchDebug(FALSE);
+
+    // Like in IWriteBlock, only separate pages get swapped
+    buf_mgr src = { job->buffer, static_cast<size_t>(img.pageSizeBytes) };
+    if (1 == img.pagesize.c && is_Endianess_Dependent(img.dt, img.comp) && (img.nbo != NET_ORDER))
+	swab_buff(src, img);
+
+    job->dst.buffer = job->buffer + img.pageSizeBytes;
+    job->dst.size = ds->pbsize;
+    const CPLErr compressret = band->Compress(job->dst, src);
+    if (CE_None != compressret && 1 != img.pagesize.c) {
+	// Interleaved pages that fail to compress are written as empty
+	job->dst.size = 0;
+    }
+    else {
+	job->usebuff = job->dst.buffer;
+	if (band->deflatep) {
+	    // Move the packed part at the start of the buffer, to make more space available
+	    memmove(job->buffer, job->dst.buffer, job->dst.size);
+	    job->dst.buffer = job->buffer;
+	    job->usebuff = DeflateBlock(job->dst,
+		img.pageSizeBytes + ds->pbsize - job->dst.size, band->deflate_flags);
+	    if (!job->usebuff)
+		ret = CE_Failure;
+	}
+    }
+    CPLPopErrorHandler();
+
+    CPLAcquireMutex(ds->hCompressMutex, 1000.0);
+    job->ret = ret;
+    job->compressret = compressret;
+    job->ready = true;
+    CPLReleaseMutex(ds->hCompressMutex);
+}
+
+CPLErr GDALMRFRasterBand::FlushCache()
+{
+    CPLErr ret = GDALPamRasterBand::FlushCache();
+    if (CE_None != poDS->WriteQueuedTiles())
+	ret = CE_Failure;
+    return ret;
+}
+
 CPLErr GDALMRFRasterBand::IWriteBlock(int xblk, int yblk, void *buffer)
 
 {
@@ -810,14 +1196,31 @@ CPLErr GDALMRFRasterBand::IWriteBlock(int xblk, int yblk, void *buffer)
     CPLDebug("MRF_IB", "IWriteBlock %d,%d,0,%d, level  %d, stride %d\n", xblk, yblk, 
 	m_band, m_l, cstride);
 
+    // With GDAL_NUM_THREADS, pages are compressed by the dataset pool and written in order
+    // Caching MRFs write fetched tiles directly, so they don't use it
+    CPLWorkerThreadPool *pool = poDS->source.empty() ? poDS->GetThreadPool() : NULL;
+
     if (1 == cstride) {     // Separate bands, we can write it as is
 	// Empty page skip
 
 	int success;
 	double val = GetNoDataValue(&success);
 	if (!success) val = 0.0;
-	if (isAllVal(eDataType, buffer, img.pageSizeBytes, val))
+	if (isAllVal(eDataType, buffer, img.pageSizeBytes, val)) {
+	    if (pool)
+		return poDS->QueueTile(NewCompressJob(this, infooffset, NULL));
 	    return poDS->WriteTile(NULL, infooffset, 0);
+	}
+
+	if (pool) {
+	    char *pagebuffer = (char *)VSIMalloc(img.pageSizeBytes + poDS->pbsize);
+	    if (!pagebuffer) {
+		CPLError(CE_Failure,CPLE_AppDefined, "MRF: Can't allocate write buffer");
+		return CE_Failure;
+	    }
+	    memcpy(pagebuffer, buffer, img.pageSizeBytes);
+	    return poDS->QueueTile(NewCompressJob(this, infooffset, pagebuffer));
+	}
 
 	// Use the pbuffer to hold the compressed page before writing it
 	poDS->tile = ILSize(); // Mark it corrupt
@@ -929,6 +1332,8 @@ CPLErr GDALMRFRasterBand::IWriteBlock(int xblk, int yblk, void *buffer)
 
     if (GIntBig(empties) == AllBandMask()) {
 	CPLFree(tbuffer);
+	if (pool)
+	    return poDS->QueueTile(NewCompressJob(this, infooffset, NULL));
 	return poDS->WriteTile(NULL, infooffset, 0);
     }
 
@@ -937,6 +1342,11 @@ CPLErr GDALMRFRasterBand::IWriteBlock(int xblk, int yblk, void *buffer)
 	"MRF: IWrite, band dirty mask is " CPL_FRMT_GIB " instead of " CPL_FRMT_GIB,
 	poDS->bdirty, AllBandMask());
 
+    if (pool) {
+	poDS->bdirty = 0;
+	return poDS->QueueTile(NewCompressJob(this, infooffset, (char *)tbuffer));
+    }
+
     buf_mgr src;
     src.buffer = (char *)tbuffer;
     src.size = static_cast<size_t>(img.pageSizeBytes);
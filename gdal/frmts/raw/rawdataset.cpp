@@ -31,6 +31,7 @@
 #include "rawdataset.h"
 #include "cpl_conv.h"
 #include "cpl_string.h"
+#include "cpl_virtualmem.h"
 
 #include <cmath>
 #include <cstddef>
@@ -167,6 +168,9 @@ void RawRasterBand::Initialize()
 
     bDirty = FALSE;
 
+    psVirtualMemIOMapping = NULL;
+    nVirtualMemIOUsage = -1;
+
 /* -------------------------------------------------------------------- */
 /*      Allocate working scanline.                                      */
 /* -------------------------------------------------------------------- */
@@ -211,6 +215,9 @@ RawRasterBand::~RawRasterBand()
 
     FlushCache();
 
+    if( psVirtualMemIOMapping != NULL )
+        CPLVirtualMemFree( psVirtualMemIOMapping );
+
     if (bOwnsFP)
     {
         if ( bIsVSIL )
@@ -659,6 +666,14 @@ CPLErr RawRasterBand::IRasterIO( GDALRWFlag eRWFlag,
 #endif
     const int nBufDataSize = GDALGetDataTypeSizeBytes( eBufType );
 
+    if( CanUseVirtualMemIO( eRWFlag, nXSize, nYSize,
+                            nBufXSize, nBufYSize, eBufType ) )
+    {
+        return VirtualMemIO( nXOff, nYOff, nXSize, nYSize,
+                             pData, eBufType, nPixelSpace, nLineSpace,
+                             psExtraArg );
+    }
+
     if( !CanUseDirectIO(nXOff, nYOff, nXSize, nYSize, eBufType ) )
     {
         return GDALRasterBand::IRasterIO( eRWFlag, nXOff, nYOff,
@@ -1146,6 +1161,194 @@ GDALColorInterp RawRasterBand::GetColorInterpretation()
     return eInterp;
 }
 
+/************************************************************************/
+/*                           GetMappedData()                            */
+/*                                                                      */
+/*      Return the address of the first pixel of the band in a          */
+/*      read-only shared mapping of the file, creating the mapping      */
+/*      on first use.  Returns NULL if the band cannot be mapped, in    */
+/*      which case the regular I/O code paths are used.                 */
+/************************************************************************/
+
+const GByte *RawRasterBand::GetMappedData()
+{
+    if( nVirtualMemIOUsage < 0 )
+    {
+        nVirtualMemIOUsage = FALSE;
+
+/* -------------------------------------------------------------------- */
+/*      Only map local files opened in read-only mode whose layout      */
+/*      can be consumed as is.                                          */
+/* -------------------------------------------------------------------- */
+        if( !bIsVSIL ||
+            eAccess != GA_ReadOnly ||
+            (poDS != NULL && poDS->GetAccess() != GA_ReadOnly) ||
+            nPixelOffset <= 0 ||
+            nLineOffset <= 0 ||
+            (eDataType != GDT_Byte && !bNativeOrder) ||
+            !CPLTestBool(CPLGetConfigOption("RAW_VIRTUAL_MEM_IO", "YES")) ||
+            !CPLIsVirtualMemFileMapAvailable() ||
+            VSIFGetNativeFileDescriptorL(fpRawL) == NULL )
+        {
+            return NULL;
+        }
+
+        const vsi_l_offset nSize =
+            static_cast<vsi_l_offset>(nRasterYSize - 1) * nLineOffset +
+            static_cast<vsi_l_offset>(nRasterXSize - 1) * nPixelOffset +
+            GDALGetDataTypeSizeBytes(eDataType);
+        if( static_cast<size_t>(nSize) != nSize )
+            return NULL;
+
+/* -------------------------------------------------------------------- */
+/*      Leave truncated files to the regular code path, which knows     */
+/*      how to report short reads.                                      */
+/* -------------------------------------------------------------------- */
+        const vsi_l_offset nCurPos = VSIFTellL(fpRawL);
+        if( VSIFSeekL(fpRawL, 0, SEEK_END) != 0 )
+            return NULL;
+        const vsi_l_offset nFileSize = VSIFTellL(fpRawL);
+        if( VSIFSeekL(fpRawL, nCurPos, SEEK_SET) != 0 ||
+            nFileSize < nImgOffset + nSize )
+        {
+            return NULL;
+        }
+
+        psVirtualMemIOMapping = CPLVirtualMemFileMapNew(
+            fpRawL, nImgOffset, nSize, VIRTUALMEM_READONLY, NULL, NULL );
+        if( psVirtualMemIOMapping == NULL )
+            return NULL;
+
+        CPLDebug( "RAW", "Using VirtualMemIO" );
+        nVirtualMemIOUsage = TRUE;
+    }
+
+    if( psVirtualMemIOMapping == NULL )
+        return NULL;
+    return static_cast<const GByte *>(
+        CPLVirtualMemGetAddr(psVirtualMemIOMapping) );
+}
+
+/************************************************************************/
+/*                         CanUseVirtualMemIO()                         */
+/*                                                                      */
+/*      Reads at full resolution into a buffer of the band data type    */
+/*      can be served directly from the file mapping, without going     */
+/*      through the block cache or an intermediate buffer.              */
+/************************************************************************/
+
+int RawRasterBand::CanUseVirtualMemIO( GDALRWFlag eRWFlag,
+                                       int nXSize, int nYSize,
+                                       int nBufXSize, int nBufYSize,
+                                       GDALDataType eBufType )
+{
+    return eRWFlag == GF_Read &&
+           nXSize == nBufXSize &&
+           nYSize == nBufYSize &&
+           eBufType == eDataType &&
+           GetMappedData() != NULL;
+}
+
+/************************************************************************/
+/*                            VirtualMemIO()                            */
+/************************************************************************/
+
+CPLErr RawRasterBand::VirtualMemIO( int nXOff, int nYOff,
+                                    int nXSize, int nYSize,
+                                    void * pData, GDALDataType eBufType,
+                                    GSpacing nPixelSpace, GSpacing nLineSpace,
+                                    GDALRasterIOExtraArg* psExtraArg )
+{
+    const GByte *pabyMapping = GetMappedData();
+    const int nBandDataSize = GDALGetDataTypeSizeBytes(eDataType);
+    const size_t nBytesPerLine = static_cast<size_t>(nXSize) * nBandDataSize;
+
+    for( int iLine = 0; iLine < nYSize; iLine++ )
+    {
+        const GByte *pabySrc = pabyMapping
+            + static_cast<size_t>(nYOff + iLine) * nLineOffset
+            + static_cast<size_t>(nXOff) * nPixelOffset;
+        GByte *pabyDst = static_cast<GByte *>(pData)
+            + static_cast<GPtrDiff_t>(iLine) * nLineSpace;
+
+        if( nPixelOffset == nBandDataSize && nPixelSpace == nBandDataSize )
+            memcpy( pabyDst, pabySrc, nBytesPerLine );
+        else
+            GDALCopyWords( pabySrc, eDataType, nPixelOffset,
+                           pabyDst, eBufType, static_cast<int>(nPixelSpace),
+                           nXSize );
+
+        if( psExtraArg->pfnProgress != NULL &&
+            !psExtraArg->pfnProgress(1.0 * (iLine + 1) / nYSize, "",
+                                     psExtraArg->pProgressData) )
+        {
+            return CE_Failure;
+        }
+    }
+
+    return CE_None;
+}
+
+/************************************************************************/
+/*                          GetMappedWindow()                           */
+/************************************************************************/
+
+/**
+ * \brief Borrow a pointer to a window of the band in the file mapping.
+ *
+ * When the band is read from a local file opened in read-only mode, its
+ * data is in the native byte order, and the bytes of the requested window
+ * are contiguous in the file (part of a single line, or full width lines
+ * of a band sequential layout), a pointer to the first pixel of the window
+ * in a read-only mapping of the file is returned.  The pixels are of the
+ * band data type, packed, and in row order.
+ *
+ * The pointer remains valid until the band is destroyed and must not be
+ * written through.  NULL is returned when the window cannot be borrowed;
+ * RasterIO() must then be used instead.
+ *
+ * Mappings can be disabled by setting the RAW_VIRTUAL_MEM_IO configuration
+ * option to NO.
+ *
+ * @param nXOff the pixel offset to the top left corner of the window.
+ * @param nYOff the line offset to the top left corner of the window.
+ * @param nXSize the width of the window in pixels.
+ * @param nYSize the height of the window in lines.
+ *
+ * @return a pointer into the mapping or NULL.
+ *
+ * @since GDAL 2.2
+ */
+
+const void *RawRasterBand::GetMappedWindow( int nXOff, int nYOff,
+                                            int nXSize, int nYSize )
+{
+    if( nXOff < 0 || nYOff < 0 || nXSize <= 0 || nYSize <= 0 ||
+        nXSize > nRasterXSize - nXOff ||
+        nYSize > nRasterYSize - nYOff )
+    {
+        return NULL;
+    }
+
+    const int nBandDataSize = GDALGetDataTypeSizeBytes(eDataType);
+    if( nPixelOffset != nBandDataSize )
+        return NULL;
+    if( nYSize > 1 &&
+        (nXSize != nRasterXSize ||
+         nLineOffset != static_cast<GIntBig>(nBandDataSize) * nRasterXSize) )
+    {
+        return NULL;
+    }
+
+    const GByte *pabyMapping = GetMappedData();
+    if( pabyMapping == NULL )
+        return NULL;
+
+    return pabyMapping
+        + static_cast<size_t>(nYOff) * nLineOffset
+        + static_cast<size_t>(nXOff) * nPixelOffset;
+}
+
 /************************************************************************/
 /*                           GetVirtualMemAuto()                        */
 /************************************************************************/
@@ -1246,7 +1449,9 @@ CPLErr RawDataset::IRasterIO( GDALRWFlag eRWFlag,
         {
             RawRasterBand* poBand = reinterpret_cast<RawRasterBand *>(
                 GetRasterBand(panBandMap[iBandIndex]) );
-            if( !poBand->CanUseDirectIO(nXOff, nYOff, nXSize, nYSize, eBufType ) )
+            if( !poBand->CanUseDirectIO(nXOff, nYOff, nXSize, nYSize, eBufType ) &&
+                !poBand->CanUseVirtualMemIO(eRWFlag, nXSize, nYSize,
+                                            nBufXSize, nBufYSize, eBufType) )
             {
                 break;
             }
@@ -102,6 +102,11 @@ protected:
 
     int         bOwnsFP;
 
+    // Read-only mapping of the band extent, lazily created by
+    // GetMappedData().  nVirtualMemIOUsage is -1 until evaluated.
+    CPLVirtualMem *psVirtualMemIOMapping;
+    int         nVirtualMemIOUsage;
+
     int         Seek( vsi_l_offset, int );
     size_t      Read( void *, size_t, size_t );
     size_t      Write( void *, size_t, size_t );
@@ -119,6 +124,16 @@ protected:
     int         CanUseDirectIO(int nXOff, int nYOff, int nXSize, int nYSize,
                                GDALDataType eBufType);
 
+    const GByte *GetMappedData();
+    int         CanUseVirtualMemIO( GDALRWFlag eRWFlag,
+                                    int nXSize, int nYSize,
+                                    int nBufXSize, int nBufYSize,
+                                    GDALDataType eBufType );
+    CPLErr      VirtualMemIO( int nXOff, int nYOff, int nXSize, int nYSize,
+                              void * pData, GDALDataType eBufType,
+                              GSpacing nPixelSpace, GSpacing nLineSpace,
+                              GDALRasterIOExtraArg* psExtraArg );
+
 public:
 
                  RawRasterBand( GDALDataset *poDS, int nBand, void * fpRaw,
@@ -172,6 +187,9 @@ public:
     VSILFILE    *GetFPL() { CPLAssert(bIsVSIL); return fpRawL; }
     int          GetOwnsFP() { return bOwnsFP; }
 
+    const void  *GetMappedWindow( int nXOff, int nYOff,
+                                  int nXSize, int nYSize );
+
   private:
     CPL_DISALLOW_COPY_ASSIGN(RawRasterBand);
 };
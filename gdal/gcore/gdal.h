@@ -1060,6 +1060,12 @@ int CPL_DLL CPL_STDCALL GDALGetCacheUsed(void);
 void CPL_DLL CPL_STDCALL GDALSetCacheMax64( GIntBig nBytes );
 GIntBig CPL_DLL CPL_STDCALL GDALGetCacheMax64(void);
 GIntBig CPL_DLL CPL_STDCALL GDALGetCacheUsed64(void);
+int CPL_DLL CPL_STDCALL GDALGetCacheShardCount(void);
+int CPL_DLL CPL_STDCALL GDALGetCacheShardStatistics( int iShard,
+                                                     GIntBig* pnCacheUsed,
+                                                     GIntBig* pnHits,
+                                                     GIntBig* pnMisses,
+                                                     GIntBig* pnEvictions );
 
 int CPL_DLL CPL_STDCALL GDALFlushCacheBlock(void);
 
@@ -635,6 +635,8 @@ class CPL_DLL GDALRasterBlock
 
     static void FlushDirtyBlocks();
     static int  FlushCacheBlock(int bDirtyBlocksOnly = FALSE);
+    static void EnterDisableDirtyBlockFlush();
+    static void LeaveDisableDirtyBlockFlush();
     static void Verify();
 
 #ifdef notdef
@@ -37,19 +37,48 @@ CPL_CVSID("$Id$");
 static bool bCacheMaxInitialized = false;
 // Will later be overriden by the default 5% if GDAL_CACHEMAX not defined.
 static GIntBig nCacheMax = 40 * 1024 * 1024;
-static volatile GIntBig nCacheUsed = 0;
 
-static GDALRasterBlock *poOldest = NULL;  // Tail.
-static GDALRasterBlock *poNewest = NULL;  // Head.
+/* -------------------------------------------------------------------- */
+/*      The global LRU list of blocks can be split into several         */
+/*      independent partitions (shards), each one with its own lock,    */
+/*      so that threads working on different blocks do not contend      */
+/*      on a single lock. A block is assigned to a shard from a hash of */
+/*      its band and its coordinates. The cache budget set by           */
+/*      GDALSetCacheMax64() is shared by all the shards.                */
+/* -------------------------------------------------------------------- */
 
-#if 0
-static CPLMutex *hRBLock = NULL;
-#define INITIALIZE_LOCK CPLMutexHolderD( &hRBLock )
-#define TAKE_LOCK       CPLMutexHolderOptionalLockD( hRBLock )
-#define DESTROY_LOCK    CPLDestroyMutex( hRBLock )
-#else
+#define GDAL_RB_MAX_SHARDS 256
+
+typedef struct
+{
+    CPLLock                  *hRBLock;
+    GDALRasterBlock          *poOldest;  // Tail.
+    GDALRasterBlock          *poNewest;  // Head.
+    volatile GIntBig          nCacheUsed;
+    GIntBig                   nHits;
+    GIntBig                   nMisses;
+    GIntBig                   nEvictions;
+} GDALRasterBlockCacheShard;
+
+static GDALRasterBlockCacheShard asShards[GDAL_RB_MAX_SHARDS];
+static int nShards = 1;
+static volatile int nShardsInitialized = FALSE;
+static CPLMutex *hShardsInitMutex = NULL;
+static volatile int iNextShardToFlush = 0;
+
+/************************************************************************/
+/*                      IsDirtyBlockFlushDisabled()                     */
+/************************************************************************/
+
+// Whether the current thread is between EnterDisableDirtyBlockFlush() and
+// LeaveDisableDirtyBlockFlush().
+static bool IsDirtyBlockFlushDisabled()
+{
+    const int* pnCounter =
+        static_cast<int*>( CPLGetTLS(CTLS_RB_DISABLE_DIRTY_FLUSH) );
+    return pnCounter != NULL && *pnCounter > 0;
+}
 
-static CPLLock* hRBLock = NULL;
 static bool bDebugContention = false;
 static bool bSleepsForBockCacheDebug = false;
 static CPLLockType GetLockType()
@@ -79,12 +108,91 @@ static CPLLockType GetLockType()
     return (CPLLockType) nLockType;
 }
 
-#define INITIALIZE_LOCK         CPLLockHolderD( &hRBLock, GetLockType() ); \
-                                CPLLockSetDebugPerf(hRBLock, bDebugContention)
-#define TAKE_LOCK               CPLLockHolderOptionalLockD( hRBLock )
-#define DESTROY_LOCK            CPLDestroyLock( hRBLock )
+#define INITIALIZE_LOCK(psShard) \
+                CPLLockHolderD( &((psShard)->hRBLock), GetLockType() ); \
+                CPLLockSetDebugPerf((psShard)->hRBLock, bDebugContention)
+#define TAKE_LOCK(psShard) \
+                CPLLockHolderOptionalLockD( (psShard)->hRBLock )
+#define DESTROY_LOCK(psShard) \
+                CPLDestroyLock( (psShard)->hRBLock )
 
-#endif
+/************************************************************************/
+/*                           GetShardCount()                            */
+/*                                                                      */
+/*      Read GDAL_RB_SHARDS. Must be called before any block is put     */
+/*      into the cache, and is thus done by GDALGetCacheMax64().        */
+/************************************************************************/
+
+static int GetShardCount()
+{
+    const char* pszShards = CPLGetConfigOption("GDAL_RB_SHARDS", "1");
+    int nShardCount = EQUAL(pszShards, "ALL_CPUS") ? CPLGetNumCPUs() :
+                                                      atoi(pszShards);
+    if( nShardCount < 1 )
+    {
+        CPLError(CE_Warning, CPLE_NotSupported,
+                 "GDAL_RB_SHARDS=%s not supported. Falling back to 1",
+                 pszShards);
+        nShardCount = 1;
+    }
+    else if( nShardCount > GDAL_RB_MAX_SHARDS )
+    {
+        nShardCount = GDAL_RB_MAX_SHARDS;
+    }
+    return nShardCount;
+}
+
+/************************************************************************/
+/*                          InitializeShards()                          */
+/************************************************************************/
+
+static void InitializeShards()
+{
+    if( nShardsInitialized )
+        return;
+
+    CPLMutexHolder oInitHolder( &hShardsInitMutex );
+    if( nShardsInitialized )
+        return;
+    nShards = GetShardCount();
+    for( int i = 0; i < nShards; ++i )
+    {
+        INITIALIZE_LOCK(&asShards[i]);
+    }
+    if( nShards > 1 )
+        CPLDebug( "GDAL", "Using %d block cache shards", nShards );
+    // Full barrier, so that the shards are seen initialized before the flag.
+    CPLAtomicInc( &nShardsInitialized );
+}
+
+/************************************************************************/
+/*                              GetShard()                              */
+/************************************************************************/
+
+static GDALRasterBlockCacheShard* GetShard( GDALRasterBlock* poBlock )
+{
+    if( nShards == 1 )
+        return &asShards[0];
+
+    GUIntBig nHash = static_cast<GUIntBig>(
+        reinterpret_cast<size_t>(poBlock->GetBand()) >> 4);
+    nHash = nHash * 1000003U + static_cast<GUIntBig>(poBlock->GetXOff());
+    nHash = nHash * 1000003U + static_cast<GUIntBig>(poBlock->GetYOff());
+    nHash ^= nHash >> 29;
+    return &asShards[nHash % static_cast<GUIntBig>(nShards)];
+}
+
+/************************************************************************/
+/*                            GetCacheUsed()                            */
+/************************************************************************/
+
+static GIntBig GetCacheUsed()
+{
+    GIntBig nCacheUsed = 0;
+    for( int i = 0; i < nShards; ++i )
+        nCacheUsed += asShards[i].nCacheUsed;
+    return nCacheUsed;
+}
 
 //#define ENABLE_DEBUG
 
@@ -142,6 +250,7 @@ void CPL_STDCALL GDALSetCacheMax64( GIntBig nNewSizeInBytes )
     }
 #endif
 
+    InitializeShards();
     bCacheMaxInitialized = true;
     nCacheMax = nNewSizeInBytes;
 
@@ -149,13 +258,13 @@ void CPL_STDCALL GDALSetCacheMax64( GIntBig nNewSizeInBytes )
 /*      Flush blocks till we are under the new limit or till we         */
 /*      can't seem to flush anymore.                                    */
 /* -------------------------------------------------------------------- */
-    while( nCacheUsed > nCacheMax )
+    while( GetCacheUsed() > nCacheMax )
     {
-        const GIntBig nOldCacheUsed = nCacheUsed;
+        const GIntBig nOldCacheUsed = GetCacheUsed();
 
         GDALFlushCacheBlock();
 
-        if( nCacheUsed == nOldCacheUsed )
+        if( GetCacheUsed() == nOldCacheUsed )
             break;
     }
 }
@@ -225,9 +334,7 @@ GIntBig CPL_STDCALL GDALGetCacheMax64()
 {
     if( !bCacheMaxInitialized )
     {
-        {
-            INITIALIZE_LOCK;
-        }
+        InitializeShards();
         bSleepsForBockCacheDebug = CPLTestBool(
             CPLGetConfigOption("GDAL_DEBUG_BLOCK_CACHE", "NO"));
 
@@ -296,6 +403,7 @@ GIntBig CPL_STDCALL GDALGetCacheMax64()
 
 int CPL_STDCALL GDALGetCacheUsed()
 {
+    const GIntBig nCacheUsed = GetCacheUsed();
     if (nCacheUsed > INT_MAX)
     {
         static bool bHasWarned = false;
@@ -324,7 +432,85 @@ int CPL_STDCALL GDALGetCacheUsed()
  * @since GDAL 1.8.0
  */
 
-GIntBig CPL_STDCALL GDALGetCacheUsed64() { return nCacheUsed; }
+GIntBig CPL_STDCALL GDALGetCacheUsed64() { return GetCacheUsed(); }
+
+/************************************************************************/
+/*                       GDALGetCacheShardCount()                       */
+/************************************************************************/
+
+/**
+ * \brief Get the number of partitions of the block cache.
+ *
+ * The global LRU list of cached blocks may be split into several
+ * independently locked partitions (shards), so as to reduce lock
+ * contention when many threads access the block cache concurrently.
+ * The number of shards is set with the GDAL_RB_SHARDS configuration option
+ * (an integer, or ALL_CPUS), which must be defined before the block cache
+ * is first used. It defaults to 1. All shards share the budget set by
+ * GDALSetCacheMax64().
+ *
+ * @return the number of shards of the block cache.
+ *
+ * @since GDAL 2.2
+ */
+
+int CPL_STDCALL GDALGetCacheShardCount()
+{
+    InitializeShards();
+    return nShards;
+}
+
+/************************************************************************/
+/*                    GDALGetCacheShardStatistics()                     */
+/************************************************************************/
+
+/**
+ * \brief Get usage statistics of a partition of the block cache.
+ *
+ * Counters are cumulated since the start of the process.
+ *
+ * @param iShard index of the shard, between 0 and
+ *               GDALGetCacheShardCount() - 1.
+ * @param pnCacheUsed pointer to the number of bytes currently cached
+ *                    by the shard, or NULL.
+ * @param pnHits pointer to the number of times a cached block of the shard
+ *               has been reused, or NULL.
+ * @param pnMisses pointer to the number of blocks that have been
+ *                 added to the shard, or NULL.
+ * @param pnEvictions pointer to the number of blocks that have been
+ *                    evicted from the shard, or NULL.
+ *
+ * @return TRUE in case of success, or FALSE if iShard is invalid.
+ *
+ * @since GDAL 2.2
+ */
+
+int CPL_STDCALL GDALGetCacheShardStatistics( int iShard,
+                                             GIntBig* pnCacheUsed,
+                                             GIntBig* pnHits,
+                                             GIntBig* pnMisses,
+                                             GIntBig* pnEvictions )
+{
+    InitializeShards();
+    if( iShard < 0 || iShard >= nShards )
+    {
+        CPLError( CE_Failure, CPLE_IllegalArg,
+                  "Invalid shard index: %d", iShard );
+        return FALSE;
+    }
+
+    GDALRasterBlockCacheShard* psShard = &asShards[iShard];
+    TAKE_LOCK(psShard);
+    if( pnCacheUsed )
+        *pnCacheUsed = psShard->nCacheUsed;
+    if( pnHits )
+        *pnHits = psShard->nHits;
+    if( pnMisses )
+        *pnMisses = psShard->nMisses;
+    if( pnEvictions )
+        *pnEvictions = psShard->nEvictions;
+    return TRUE;
+}
 
 /************************************************************************/
 /*                        GDALFlushCacheBlock()                         */
@@ -403,15 +589,30 @@ int CPL_STDCALL GDALFlushCacheBlock()
 int GDALRasterBlock::FlushCacheBlock( int bDirtyBlocksOnly )
 
 {
-    GDALRasterBlock *poTarget;
+    GDALRasterBlock *poTarget = NULL;
+
+    InitializeShards();
+
+    const bool bSkipDirtyBlocks = IsDirtyBlockFlushDisabled();
+    if( bDirtyBlocksOnly && bSkipDirtyBlocks )
+        return FALSE;
 
+    // Start from a different shard at each call, so that repeated calls
+    // evict blocks evenly from all of them.
+    const int iFirstShard = nShards == 1 ? 0 : static_cast<int>(
+        static_cast<unsigned int>(CPLAtomicInc(&iNextShardToFlush)) %
+        static_cast<unsigned int>(nShards));
+    for( int i = 0; poTarget == NULL && i < nShards; ++i )
     {
-        INITIALIZE_LOCK;
-        poTarget = poOldest;
+        GDALRasterBlockCacheShard* psShard =
+            &asShards[(iFirstShard + i) % nShards];
+        TAKE_LOCK(psShard);
+        poTarget = psShard->poOldest;
 
         while( poTarget != NULL )
         {
-            if( !bDirtyBlocksOnly || poTarget->GetDirty() )
+            if( bDirtyBlocksOnly ? poTarget->GetDirty() :
+                !(bSkipDirtyBlocks && poTarget->GetDirty()) )
             {
                 if( CPLAtomicCompareAndExchange(
                         &(poTarget->nLockCount), 0, -1) )
@@ -421,7 +622,7 @@ int GDALRasterBlock::FlushCacheBlock( int bDirtyBlocksOnly )
         }
 
         if( poTarget == NULL )
-            return FALSE;
+            continue;
         if( bSleepsForBockCacheDebug )
             CPLSleep(CPLAtof(
                 CPLGetConfigOption(
@@ -429,8 +630,12 @@ int GDALRasterBlock::FlushCacheBlock( int bDirtyBlocksOnly )
 
         poTarget->Detach_unlocked();
         poTarget->GetBand()->UnreferenceBlock(poTarget);
+        psShard->nEvictions++;
     }
 
+    if( poTarget == NULL )
+        return FALSE;
+
     if( bSleepsForBockCacheDebug )
         CPLSleep(CPLAtof(
             CPLGetConfigOption("GDAL_RB_FLUSHBLOCK_SLEEP_AFTER_RB_LOCK", "0")));
@@ -481,6 +686,60 @@ void GDALRasterBlock::FlushDirtyBlocks()
     }
 }
 
+/************************************************************************/
+/*                    EnterDisableDirtyBlockFlush()                     */
+/************************************************************************/
+
+/**
+ * \brief Starts preventing dirty blocks from being flushed.
+ *
+ * Until the matching LeaveDisableDirtyBlockFlush() call, the blocks that the
+ * current thread evicts from the cache to make room for new ones are only
+ * taken among the clean blocks.  The dirty blocks are left to the other
+ * threads, so that the thread writing a dataset is the only one that calls
+ * its IWriteBlock() method, in the order it writes the blocks.  The cache
+ * may temporarily grow above its limit if it only holds dirty blocks.
+ *
+ * Calls can be nested.
+ *
+ * @since GDAL 2.2
+ */
+
+void GDALRasterBlock::EnterDisableDirtyBlockFlush()
+{
+    int bMemoryError = FALSE;
+    int* pnCounter = static_cast<int*>(
+        CPLGetTLSEx(CTLS_RB_DISABLE_DIRTY_FLUSH, &bMemoryError) );
+    if( bMemoryError )
+        return;
+    if( pnCounter == NULL )
+    {
+        pnCounter = static_cast<int*>( VSI_CALLOC_VERBOSE(1, sizeof(int)) );
+        if( pnCounter == NULL )
+            return;
+        CPLSetTLS( CTLS_RB_DISABLE_DIRTY_FLUSH, pnCounter, TRUE );
+    }
+    (*pnCounter)++;
+}
+
+/************************************************************************/
+/*                    LeaveDisableDirtyBlockFlush()                     */
+/************************************************************************/
+
+/**
+ * \brief Ends a section started with EnterDisableDirtyBlockFlush().
+ *
+ * @since GDAL 2.2
+ */
+
+void GDALRasterBlock::LeaveDisableDirtyBlockFlush()
+{
+    int* pnCounter =
+        static_cast<int*>( CPLGetTLS(CTLS_RB_DISABLE_DIRTY_FLUSH) );
+    if( pnCounter != NULL && *pnCounter > 0 )
+        (*pnCounter)--;
+}
+
 /************************************************************************/
 /*                          GDALRasterBlock()                           */
 /************************************************************************/
@@ -621,19 +880,21 @@ void GDALRasterBlock::Detach()
 {
     if( bMustDetach )
     {
-        TAKE_LOCK;
+        TAKE_LOCK(GetShard(this));
         Detach_unlocked();
     }
 }
 
 void GDALRasterBlock::Detach_unlocked()
 {
-    if( poOldest == this )
-        poOldest = poPrevious;
+    GDALRasterBlockCacheShard* psShard = GetShard(this);
+
+    if( psShard->poOldest == this )
+        psShard->poOldest = poPrevious;
 
-    if( poNewest == this )
+    if( psShard->poNewest == this )
     {
-        poNewest = poNext;
+        psShard->poNewest = poNext;
     }
 
     if( poPrevious != NULL )
@@ -647,7 +908,7 @@ void GDALRasterBlock::Detach_unlocked()
     bMustDetach = false;
 
     if( pData )
-        nCacheUsed -= GetBlockSize();
+        psShard->nCacheUsed -= GetBlockSize();
 
 #ifdef ENABLE_DEBUG
     Verify();
@@ -667,27 +928,32 @@ void GDALRasterBlock::Detach_unlocked()
 void GDALRasterBlock::Verify()
 
 {
-    TAKE_LOCK;
-
-    CPLAssert( (poNewest == NULL && poOldest == NULL)
-               || (poNewest != NULL && poOldest != NULL) );
-
-    if( poNewest != NULL )
+    for( int i = 0; i < nShards; ++i )
     {
-        CPLAssert( poNewest->poPrevious == NULL );
-        CPLAssert( poOldest->poNext == NULL );
+        GDALRasterBlockCacheShard* psShard = &asShards[i];
+        TAKE_LOCK(psShard);
 
-        GDALRasterBlock* poLast = NULL;
-        for( GDALRasterBlock *poBlock = poNewest;
-             poBlock != NULL;
-             poBlock = poBlock->poNext )
+        CPLAssert( (psShard->poNewest == NULL && psShard->poOldest == NULL)
+                || (psShard->poNewest != NULL && psShard->poOldest != NULL) );
+
+        if( psShard->poNewest != NULL )
         {
-            CPLAssert( poBlock->poPrevious == poLast );
+            CPLAssert( psShard->poNewest->poPrevious == NULL );
+            CPLAssert( psShard->poOldest->poNext == NULL );
 
-            poLast = poBlock;
-        }
+            GDALRasterBlock* poLast = NULL;
+            for( GDALRasterBlock *poBlock = psShard->poNewest;
+                 poBlock != NULL;
+                 poBlock = poBlock->poNext )
+            {
+                CPLAssert( poBlock->poPrevious == poLast );
+                CPLAssert( GetShard(poBlock) == psShard );
 
-        CPLAssert( poOldest == poLast );
+                poLast = poBlock;
+            }
+
+            CPLAssert( psShard->poOldest == poLast );
+        }
     }
 }
 
@@ -698,8 +964,10 @@ void GDALRasterBlock::Verify() {}
 #ifdef notdef
 void GDALRasterBlock::CheckNonOrphanedBlocks( GDALRasterBand* poBand )
 {
-    TAKE_LOCK;
-    for( GDALRasterBlock *poBlock = poNewest;
+  for( int i = 0; i < nShards; ++i )
+  {
+    TAKE_LOCK(&asShards[i]);
+    for( GDALRasterBlock *poBlock = asShards[i].poNewest;
                           poBlock != NULL;
                           poBlock = poBlock->poNext )
     {
@@ -719,6 +987,7 @@ void GDALRasterBlock::CheckNonOrphanedBlocks( GDALRasterBand* poBand )
                        poBand->GetDataset()->GetDescription());
         }
     }
+  }
 }
 #endif
 
@@ -772,7 +1041,7 @@ CPLErr GDALRasterBlock::Write()
 void GDALRasterBlock::Touch()
 
 {
-    TAKE_LOCK;
+    TAKE_LOCK(GetShard(this));
     Touch_unlocked();
 }
 
@@ -780,7 +1049,9 @@ void GDALRasterBlock::Touch()
 void GDALRasterBlock::Touch_unlocked()
 
 {
-    if( poNewest == this )
+    GDALRasterBlockCacheShard* psShard = GetShard(this);
+
+    if( psShard->poNewest == this )
         return;
 
     // In theory, we should not try to touch a block that has been detached.
@@ -788,13 +1059,13 @@ void GDALRasterBlock::Touch_unlocked()
     if( !bMustDetach )
     {
         if( pData )
-            nCacheUsed += GetBlockSize();
+            psShard->nCacheUsed += GetBlockSize();
 
         bMustDetach = true;
     }
 
-    if( poOldest == this )
-        poOldest = this->poPrevious;
+    if( psShard->poOldest == this )
+        psShard->poOldest = this->poPrevious;
 
     if( poPrevious != NULL )
         poPrevious->poNext = poNext;
@@ -803,19 +1074,19 @@ void GDALRasterBlock::Touch_unlocked()
         poNext->poPrevious = poPrevious;
 
     poPrevious = NULL;
-    poNext = poNewest;
+    poNext = psShard->poNewest;
 
-    if( poNewest != NULL )
+    if( psShard->poNewest != NULL )
     {
-        CPLAssert( poNewest->poPrevious == NULL );
-        poNewest->poPrevious = this;
+        CPLAssert( psShard->poNewest->poPrevious == NULL );
+        psShard->poNewest->poPrevious = this;
     }
-    poNewest = this;
+    psShard->poNewest = this;
 
-    if( poOldest == NULL )
+    if( psShard->poOldest == NULL )
     {
         CPLAssert( poPrevious == NULL && poNext == NULL );
-        poOldest = this;
+        psShard->poOldest = this;
     }
 #ifdef ENABLE_DEBUG
     Verify();
@@ -844,7 +1115,7 @@ CPLErr GDALRasterBlock::Internalize()
 
     void        *pNewData = NULL;
 
-    // This call will initialize the hRBLock mutex. Other call places can
+    // This call will initialize the shard locks. Other call places can
     // only be called if we have go through there.
     const GIntBig nCurCacheMax = GDALGetCacheMax64();
 
@@ -853,25 +1124,37 @@ CPLErr GDALRasterBlock::Internalize()
 
 /* -------------------------------------------------------------------- */
 /*      Flush old blocks if we are nearing our memory limit.            */
+/*      Blocks of the shard of this block are evicted first, and then   */
+/*      those of the other shards if that is not enough.                */
 /* -------------------------------------------------------------------- */
+    GDALRasterBlockCacheShard* const psShard = GetShard(this);
+    const int iShard = static_cast<int>(psShard - asShards);
+    int iVictimShard = iShard;
+    const bool bSkipDirtyBlocks = IsDirtyBlockFlushDisabled();
     bool bFirstIter = true;
     bool bLoopAgain = false;
+    bool bTouched = false;
     do
     {
         bLoopAgain = false;
         GDALRasterBlock* apoBlocksToFree[64] = { NULL };
         int nBlocksToFree = 0;
         {
-            TAKE_LOCK;
+            GDALRasterBlockCacheShard* psVictimShard = &asShards[iVictimShard];
+            TAKE_LOCK(psVictimShard);
 
             if( bFirstIter )
-                nCacheUsed += nSizeInBytes;
-            GDALRasterBlock *poTarget = poOldest;
-            while( nCacheUsed > nCurCacheMax )
+            {
+                psShard->nCacheUsed += nSizeInBytes;
+                psShard->nMisses++;
+            }
+            GDALRasterBlock *poTarget = psVictimShard->poOldest;
+            while( GetCacheUsed() > nCurCacheMax )
             {
                 while( poTarget != NULL )
                 {
-                    if( CPLAtomicCompareAndExchange(
+                    if( !(bSkipDirtyBlocks && poTarget->GetDirty()) &&
+                        CPLAtomicCompareAndExchange(
                             &(poTarget->nLockCount), 0, -1) )
                         break;
                     poTarget = poTarget->poPrevious;
@@ -889,6 +1172,7 @@ CPLErr GDALRasterBlock::Internalize()
 
                     poTarget->Detach_unlocked();
                     poTarget->GetBand()->UnreferenceBlock(poTarget);
+                    psVictimShard->nEvictions++;
 
                     apoBlocksToFree[nBlocksToFree++] = poTarget;
                     if( poTarget->GetDirty() )
@@ -896,12 +1180,12 @@ CPLErr GDALRasterBlock::Internalize()
                         // Only free one dirty block at a time so that
                         // other dirty blocks of other bands with the same
                         // coordinates can be found with TryGetLockedBlock()
-                        bLoopAgain = nCacheUsed > nCurCacheMax;
+                        bLoopAgain = GetCacheUsed() > nCurCacheMax;
                         break;
                     }
                     if( nBlocksToFree == 64 )
                     {
-                        bLoopAgain = ( nCacheUsed > nCurCacheMax );
+                        bLoopAgain = ( GetCacheUsed() > nCurCacheMax );
                         break;
                     }
 
@@ -909,6 +1193,10 @@ CPLErr GDALRasterBlock::Internalize()
                 }
                 else
                 {
+                    // Nothing more can be evicted from this shard: go on
+                    // with the next one, until we are back to ours.
+                    iVictimShard = (iVictimShard + 1) % nShards;
+                    bLoopAgain = iVictimShard != iShard;
                     break;
                 }
             }
@@ -916,8 +1204,11 @@ CPLErr GDALRasterBlock::Internalize()
         /* ------------------------------------------------------------------ */
         /*      Add this block to the list.                                   */
         /* ------------------------------------------------------------------ */
-            if( !bLoopAgain )
+            if( !bLoopAgain && psVictimShard == psShard )
+            {
                 Touch_unlocked();
+                bTouched = true;
+            }
         }
 
         bFirstIter = false;
@@ -955,6 +1246,9 @@ CPLErr GDALRasterBlock::Internalize()
     }
     while(bLoopAgain);
 
+    if( !bTouched )
+        Touch();
+
     if( pNewData == NULL )
     {
         pNewData = VSI_MALLOC_VERBOSE( nSizeInBytes );
@@ -1001,9 +1295,15 @@ void GDALRasterBlock::MarkClean() { bDirty = false; }
 
 void GDALRasterBlock::DestroyRBMutex()
 {
-    if( hRBLock != NULL )
-        DESTROY_LOCK;
-    hRBLock = NULL;
+    for( int i = 0; i < nShards; ++i )
+    {
+        if( asShards[i].hRBLock != NULL )
+            DESTROY_LOCK(&asShards[i]);
+        asShards[i].hRBLock = NULL;
+    }
+    if( hShardsInitMutex != NULL )
+        CPLDestroyMutex( hShardsInitMutex );
+    hShardsInitMutex = NULL;
 }
 
 /************************************************************************/
@@ -1043,11 +1343,16 @@ int GDALRasterBlock::TakeLock()
         DropLock();
 
         // wait for the block having been unreferenced
-        TAKE_LOCK;
+        TAKE_LOCK(GetShard(this));
 
         return FALSE;
     }
-    Touch();
+    {
+        GDALRasterBlockCacheShard* psShard = GetShard(this);
+        TAKE_LOCK(psShard);
+        psShard->nHits++;
+        Touch_unlocked();
+    }
     return TRUE;
 }
 
@@ -1079,7 +1384,7 @@ int GDALRasterBlock::DropLockForRemovalFromStorage()
 #endif
 
     // Wait for the block for having been unreferenced.
-    TAKE_LOCK;
+    TAKE_LOCK(GetShard(this));
 
     return FALSE;
 }
@@ -1087,15 +1392,18 @@ int GDALRasterBlock::DropLockForRemovalFromStorage()
 #if 0
 void GDALRasterBlock::DumpAll()
 {
-    int iBlock = 0;
-    for( GDALRasterBlock *poBlock = poNewest;
-         poBlock != NULL;
-         poBlock = poBlock->poNext )
+    for( int i = 0; i < nShards; ++i )
     {
-        printf("Block %d\n", iBlock);
-        poBlock->DumpBlock();
-        printf("\n");
-        iBlock++;
+        int iBlock = 0;
+        for( GDALRasterBlock *poBlock = asShards[i].poNewest;
+             poBlock != NULL;
+             poBlock = poBlock->poNext )
+        {
+            printf("Shard %d, Block %d\n", i, iBlock);
+            poBlock->DumpBlock();
+            printf("\n");
+            iBlock++;
+        }
     }
 }
 
@@ -29,13 +29,43 @@
  ****************************************************************************/
 
 #include <limits>
+#include <new>
 #include <vector>
 
+#include "cpl_worker_thread_pool.h"
 #include "gdal_priv.h"
 #include "gdalwarper.h"
+#include "overview_priv.h"
+
+// Restrict to 64bit processors because they are guaranteed to have SSE2.
+// Could possibly be used too on 32bit, but we would need to check at runtime.
+#if defined(__x86_64) || defined(_M_X64)
+#define USE_SSE2
+#endif
+
+#ifdef USE_SSE2
+#include <gdalsse_priv.h>
+#endif
 
 CPL_CVSID("$Id$");
 
+#ifdef HAVE_AVX_AT_COMPILE_TIME
+
+/************************************************************************/
+/*                           GDALOvrUseAVX()                            */
+/************************************************************************/
+
+// The AVX code paths can be disabled with GDAL_USE_AVX=NO, for example to
+// compare timings with the default code paths.
+static bool GDALOvrUseAVX()
+{
+    static const bool bHasAVX = CPL_TO_BOOL(CPLHaveRuntimeAVX());
+    return bHasAVX &&
+           CPLTestBool(CPLGetConfigOption("GDAL_USE_AVX", "YES"));
+}
+
+#endif
+
 /************************************************************************/
 /*                     GDALResampleChunk32R_Near()                      */
 /************************************************************************/
@@ -221,6 +251,90 @@ static bool ReadColorTableAsArray( const GDALColorTable* poColorTable,
     return true;
 }
 
+/************************************************************************/
+/*                   GDALResampleAverage2x2SSE2<T>()                    */
+/************************************************************************/
+
+// Optimized versions of the 2x2 average without nodata for Byte and UInt16.
+// They return the number of destination pixels computed, the remaining ones
+// being computed by the generic code. The rounding is the same as the one of
+// the generic code.
+
+template<class T> static inline int
+GDALResampleAverage2x2SSE2( const T* /* pSrcRow1 */,
+                            const T* /* pSrcRow2 */,
+                            int /* nDstCount */, T* /* pDst */ )
+{
+    return 0;
+}
+
+#ifdef USE_SSE2
+
+template<> inline int GDALResampleAverage2x2SSE2<GByte>(
+    const GByte* pabySrcRow1, const GByte* pabySrcRow2,
+    int nDstCount, GByte* pabyDst )
+{
+    const __m128i v_mask_low = _mm_set1_epi16(0x00FF);
+    const __m128i v_two = _mm_set1_epi16(2);
+    int i = 0;  // Used after for.
+    for( ; i + 15 < nDstCount; i += 16 )
+    {
+        __m128i v_sum[2];
+        for( int k = 0; k < 2; ++k )
+        {
+            const __m128i v_row1 = _mm_loadu_si128(
+                reinterpret_cast<const __m128i*>(pabySrcRow1 + 2 * i + 16 * k));
+            const __m128i v_row2 = _mm_loadu_si128(
+                reinterpret_cast<const __m128i*>(pabySrcRow2 + 2 * i + 16 * k));
+            // Sum of 4 values is at most 1020, which fits on 16 bits.
+            __m128i v = _mm_add_epi16(_mm_and_si128(v_row1, v_mask_low),
+                                      _mm_srli_epi16(v_row1, 8));
+            v = _mm_add_epi16(v, _mm_and_si128(v_row2, v_mask_low));
+            v = _mm_add_epi16(v, _mm_srli_epi16(v_row2, 8));
+            v_sum[k] = _mm_srli_epi16(_mm_add_epi16(v, v_two), 2);
+        }
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(pabyDst + i),
+                         _mm_packus_epi16(v_sum[0], v_sum[1]));
+    }
+    return i;
+}
+
+template<> inline int GDALResampleAverage2x2SSE2<GUInt16>(
+    const GUInt16* panSrcRow1, const GUInt16* panSrcRow2,
+    int nDstCount, GUInt16* panDst )
+{
+    const __m128i v_mask_low = _mm_set1_epi32(0xFFFF);
+    const __m128i v_two = _mm_set1_epi32(2);
+    const __m128i v_bias32 = _mm_set1_epi32(32768);
+    const __m128i v_bias16 = _mm_set1_epi16(static_cast<short>(0x8000));
+    int i = 0;  // Used after for.
+    for( ; i + 7 < nDstCount; i += 8 )
+    {
+        __m128i v_sum[2];
+        for( int k = 0; k < 2; ++k )
+        {
+            const __m128i v_row1 = _mm_loadu_si128(
+                reinterpret_cast<const __m128i*>(panSrcRow1 + 2 * i + 8 * k));
+            const __m128i v_row2 = _mm_loadu_si128(
+                reinterpret_cast<const __m128i*>(panSrcRow2 + 2 * i + 8 * k));
+            __m128i v = _mm_add_epi32(_mm_and_si128(v_row1, v_mask_low),
+                                      _mm_srli_epi32(v_row1, 16));
+            v = _mm_add_epi32(v, _mm_and_si128(v_row2, v_mask_low));
+            v = _mm_add_epi32(v, _mm_srli_epi32(v_row2, 16));
+            v = _mm_srli_epi32(_mm_add_epi32(v, v_two), 2);
+            // There is no unsigned saturated packing of 32 bit values in
+            // SSE2, so shift to the signed range.
+            v_sum[k] = _mm_sub_epi32(v, v_bias32);
+        }
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(panDst + i),
+                         _mm_xor_si128(_mm_packs_epi32(v_sum[0], v_sum[1]),
+                                       v_bias16));
+    }
+    return i;
+}
+
+#endif // USE_SSE2
+
 /************************************************************************/
 /*                    GDALResampleChunk32R_Average()                    */
 /************************************************************************/
@@ -262,6 +376,10 @@ GDALResampleChunk32R_AverageT( double dfXRatioDstToSrc,
     int nChunkBottomYOff = nChunkYOff + nChunkYSize;
     int nDstXWidth = nDstXOff2 - nDstXOff;
 
+#ifdef HAVE_AVX_AT_COMPILE_TIME
+    const bool bUseAVX = GDALOvrUseAVX();
+#endif
+
 /* -------------------------------------------------------------------- */
 /*      Allocate scanline buffer.                                       */
 /* -------------------------------------------------------------------- */
@@ -360,7 +478,12 @@ GDALResampleChunk32R_AverageT( double dfXRatioDstToSrc,
                 const T* pSrcScanlineShifted =
                     pChunk + panSrcXOffShifted[0] +
                     (nSrcYOff - nChunkYOff) * nChunkXSize;
-                for( int iDstPixel = 0; iDstPixel < nDstXWidth; ++iDstPixel )
+                const int nDone = GDALResampleAverage2x2SSE2(
+                    pSrcScanlineShifted, pSrcScanlineShifted + nChunkXSize,
+                    nDstXWidth, pDstScanline );
+                pSrcScanlineShifted += 2 * nDone;
+                for( int iDstPixel = nDone; iDstPixel < nDstXWidth;
+                     ++iDstPixel )
                 {
                     const Tsum nTotal =
                         pSrcScanlineShifted[0]
@@ -372,6 +495,23 @@ GDALResampleChunk32R_AverageT( double dfXRatioDstToSrc,
                     pSrcScanlineShifted += 2;
                 }
             }
+#ifdef HAVE_AVX_AT_COMPILE_TIME
+            else if( bUseAVX &&
+                     bSrcXSpacingIsTwo && nSrcYOff2 == nSrcYOff + 2 &&
+                     pabyChunkNodataMask == NULL &&
+                     eWrkDataType == GDT_Float32 )
+            {
+                // Same as above for Float32, with AVX.
+                const float* pafSrcScanlineShifted =
+                    reinterpret_cast<const float*>(pChunk) +
+                    panSrcXOffShifted[0] +
+                    (nSrcYOff - nChunkYOff) * nChunkXSize;
+                GDALOvrAverage2x2Float32AVX(
+                    pafSrcScanlineShifted,
+                    pafSrcScanlineShifted + nChunkXSize,
+                    nDstXWidth, reinterpret_cast<float*>(pDstScanline) );
+            }
+#endif
             else
             {
                 nSrcYOff -= nChunkYOff;
@@ -1178,15 +1318,7 @@ template<class T> static inline void GDALResampleConvolutionVertical_2cols(
     dfRes2 = dfVal3 + dfVal4;
 }
 
-// TODO(schwehr): Move define of USE_SSE2 and include to the top of the file.
-// Restrict to 64bit processors because they are guaranteed to have SSE2.
-// Could possibly be used too on 32bit, but we would need to check at runtime.
-#if defined(__x86_64) || defined(_M_X64)
-#define USE_SSE2
-#endif
-
 #ifdef USE_SSE2
-#include <gdalsse_priv.h>
 
 /************************************************************************/
 /*              GDALResampleConvolutionHorizontalSSE2<T>                */
@@ -1501,6 +1633,10 @@ GDALResampleChunk32R_ConvolutionT( double dfXRatioDstToSrc,
     const double dfYScaleWeight = ( dfYScale >= 1.0 ) ? 1.0 : dfYScale;
     const double dfYScaledRadius = nKernelRadius / dfYScaleWeight;
 
+#ifdef HAVE_AVX_AT_COMPILE_TIME
+    const bool bUseAVX = GDALOvrUseAVX();
+#endif
+
     float* pafDstScanline = static_cast<float *>(
         VSI_MALLOC_VERBOSE(nDstXSize * sizeof(float)) );
 
@@ -1761,6 +1897,19 @@ GDALResampleChunk32R_ConvolutionT( double dfXRatioDstToSrc,
             int iFilteredPixelOff = 0;  // Used after for.
             // j used after for.
             int j = (nSrcLineStart - nChunkYOff) * nDstXSize;
+#ifdef HAVE_AVX_AT_COMPILE_TIME
+            if( bUseAVX )
+            {
+                for( ;
+                     iFilteredPixelOff+3 < nDstXSize;
+                     iFilteredPixelOff += 4, j += 4 )
+                {
+                    GDALOvrConvolutionVertical4ColsAVX(
+                        padfHorizontalFilteredBand + j, nDstXSize, padfWeights,
+                        nSrcLineCount, pafDstScanline + iFilteredPixelOff );
+                }
+            }
+#endif
             for( ;
                  iFilteredPixelOff+1 < nDstXSize;
                  iFilteredPixelOff += 2, j += 2 )
@@ -2437,6 +2586,385 @@ GDALDataType GDALGetOvrWorkDataType( const char* pszResampling,
     return GDT_Float32;
 }
 
+/************************************************************************/
+/*                          GDALOvrChunkBand                            */
+/************************************************************************/
+
+// Stands for a window of an overview band when the resampling functions are
+// run from worker threads. The lines written by the resampling function are
+// converted to the data type of the overview band and accumulated in memory,
+// and FlushToOverview() then writes them to the real overview band from the
+// calling thread.
+
+class GDALOvrChunkBand CPL_FINAL : public GDALRasterBand
+{
+    GDALRasterBand *poOverview;
+    int             nWinXOff;
+    int             nWinYOff;
+    int             nWinXSize;
+    int             nWinYSize;
+    GByte          *pabyData;
+
+  protected:
+    virtual CPLErr IReadBlock( int, int, void * );
+    virtual CPLErr IRasterIO( GDALRWFlag, int, int, int, int,
+                              void *, int, int, GDALDataType,
+                              GSpacing nPixelSpace, GSpacing nLineSpace,
+                              GDALRasterIOExtraArg* psExtraArg );
+
+  public:
+                   GDALOvrChunkBand( GDALRasterBand* poOverview,
+                                     int nXOff, int nYOff,
+                                     int nXSize, int nYSize );
+    virtual       ~GDALOvrChunkBand();
+
+    bool           IsInitOK() const { return pabyData != NULL; }
+    CPLErr         FlushToOverview();
+};
+
+/************************************************************************/
+/*                          GDALOvrChunkBand()                          */
+/************************************************************************/
+
+GDALOvrChunkBand::GDALOvrChunkBand( GDALRasterBand* poOverviewIn,
+                                    int nXOff, int nYOff,
+                                    int nXSize, int nYSize ) :
+    poOverview(poOverviewIn),
+    nWinXOff(nXOff),
+    nWinYOff(nYOff),
+    nWinXSize(nXSize),
+    nWinYSize(nYSize),
+    pabyData(NULL)
+{
+    nRasterXSize = poOverview->GetXSize();
+    nRasterYSize = poOverview->GetYSize();
+    eDataType = poOverview->GetRasterDataType();
+    nBlockXSize = nRasterXSize;
+    nBlockYSize = 1;
+    eAccess = GA_Update;
+    bForceCachedIO = FALSE;
+
+    // Used by the convolution based resampling functions.
+    const char* pszNBITS =
+        poOverview->GetMetadataItem("NBITS", "IMAGE_STRUCTURE");
+    if( pszNBITS != NULL )
+        GDALRasterBand::SetMetadataItem("NBITS", pszNBITS, "IMAGE_STRUCTURE");
+
+    pabyData = static_cast<GByte *>(
+        VSI_MALLOC3_VERBOSE( nWinXSize, nWinYSize,
+                             GDALGetDataTypeSizeBytes(eDataType) ) );
+}
+
+/************************************************************************/
+/*                         ~GDALOvrChunkBand()                          */
+/************************************************************************/
+
+GDALOvrChunkBand::~GDALOvrChunkBand()
+{
+    VSIFree(pabyData);
+}
+
+/************************************************************************/
+/*                             IReadBlock()                             */
+/************************************************************************/
+
+CPLErr GDALOvrChunkBand::IReadBlock( int, int, void * )
+{
+    CPLError( CE_Failure, CPLE_NotSupported,
+              "GDALOvrChunkBand::IReadBlock() not supported" );
+    return CE_Failure;
+}
+
+/************************************************************************/
+/*                             IRasterIO()                              */
+/************************************************************************/
+
+CPLErr GDALOvrChunkBand::IRasterIO( GDALRWFlag eRWFlag,
+                                    int nXOff, int nYOff,
+                                    int nXSize, int nYSize,
+                                    void * pData, int nBufXSize, int nBufYSize,
+                                    GDALDataType eBufType,
+                                    GSpacing nPixelSpace, GSpacing nLineSpace,
+                                    GDALRasterIOExtraArg* /* psExtraArg */ )
+{
+    if( eRWFlag != GF_Write ||
+        nXSize != nBufXSize || nYSize != nBufYSize ||
+        nXOff < nWinXOff || nXOff + nXSize > nWinXOff + nWinXSize ||
+        nYOff < nWinYOff || nYOff + nYSize > nWinYOff + nWinYSize )
+    {
+        CPLError( CE_Failure, CPLE_NotSupported,
+                  "GDALOvrChunkBand::IRasterIO(): unsupported request" );
+        return CE_Failure;
+    }
+
+    const int nDTSize = GDALGetDataTypeSizeBytes(eDataType);
+    for( int iLine = 0; iLine < nYSize; ++iLine )
+    {
+        const size_t nDstOffset =
+            (static_cast<size_t>(nYOff - nWinYOff + iLine) * nWinXSize +
+             (nXOff - nWinXOff)) * nDTSize;
+        GDALCopyWords( static_cast<GByte *>(pData) + iLine * nLineSpace,
+                       eBufType, static_cast<int>(nPixelSpace),
+                       pabyData + nDstOffset, eDataType, nDTSize,
+                       nXSize );
+    }
+
+    return CE_None;
+}
+
+/************************************************************************/
+/*                          FlushToOverview()                           */
+/************************************************************************/
+
+CPLErr GDALOvrChunkBand::FlushToOverview()
+{
+    return poOverview->RasterIO( GF_Write, nWinXOff, nWinYOff,
+                                 nWinXSize, nWinYSize,
+                                 pabyData, nWinXSize, nWinYSize,
+                                 eDataType, 0, 0, NULL );
+}
+
+/************************************************************************/
+/*                         GDALOvrResampleJob                           */
+/************************************************************************/
+
+typedef struct
+{
+    // NULL for complex data types, that go through GDALResampleChunkC32R().
+    GDALResampleFunction pfnResampleFn;
+    double               dfXRatioDstToSrc;
+    double               dfYRatioDstToSrc;
+    GDALDataType         eWrkDataType;
+    void                *pChunk;
+    GByte               *pabyChunkNodataMask;
+    int                  nSrcWidth;
+    int                  nSrcHeight;
+    int                  nChunkXOff;
+    int                  nChunkXSize;
+    int                  nChunkYOff;
+    int                  nChunkYSize;
+    int                  nDstXOff;
+    int                  nDstXOff2;
+    int                  nDstYOff;
+    int                  nDstYOff2;
+    GDALRasterBand      *poOverview;
+    const char          *pszResampling;
+    int                  bHasNoData;
+    float                fNoDataValue;
+    GDALColorTable      *poColorTable;
+    GDALDataType         eSrcDataType;
+
+    GDALOvrChunkBand    *poChunkBand;
+    CPLErr               eErr;
+} GDALOvrResampleJob;
+
+/************************************************************************/
+/*                       GDALOvrResampleJobFunc()                       */
+/************************************************************************/
+
+static void GDALOvrResampleJobFunc( void* pData )
+{
+    GDALOvrResampleJob* psJob = static_cast<GDALOvrResampleJob *>(pData);
+
+    if( psJob->pfnResampleFn != NULL )
+    {
+        psJob->eErr = psJob->pfnResampleFn(
+            psJob->dfXRatioDstToSrc, psJob->dfYRatioDstToSrc,
+            0.0, 0.0,
+            psJob->eWrkDataType,
+            psJob->pChunk,
+            psJob->pabyChunkNodataMask,
+            psJob->nChunkXOff, psJob->nChunkXSize,
+            psJob->nChunkYOff, psJob->nChunkYSize,
+            psJob->nDstXOff, psJob->nDstXOff2,
+            psJob->nDstYOff, psJob->nDstYOff2,
+            psJob->poChunkBand, psJob->pszResampling,
+            psJob->bHasNoData, psJob->fNoDataValue, psJob->poColorTable,
+            psJob->eSrcDataType );
+    }
+    else
+    {
+        psJob->eErr = GDALResampleChunkC32R(
+            psJob->nSrcWidth, psJob->nSrcHeight,
+            static_cast<float *>(psJob->pChunk),
+            psJob->nChunkYOff, psJob->nChunkYSize,
+            psJob->nDstYOff, psJob->nDstYOff2,
+            psJob->poChunkBand, psJob->pszResampling );
+    }
+}
+
+/************************************************************************/
+/*                       GDALOvrResamplePipeline                        */
+/************************************************************************/
+
+// Runs the resampling of source chunks in a pool of worker threads.
+// The caller alternates between two slots: while the jobs of one slot are
+// running, the next chunk can be read into the buffers of the other slot,
+// and the results of the previous chunk be written to the overviews, so
+// that all I/O remains on the calling thread.
+
+class GDALOvrResamplePipeline
+{
+    CPLWorkerThreadPool               oPool;
+    int                               nThreads;
+    std::vector<GDALOvrResampleJob *> apsJobs[2];
+
+    void           FreeJobs( int iSlot );
+
+  public:
+                   GDALOvrResamplePipeline();
+                  ~GDALOvrResamplePipeline();
+
+    static GDALOvrResamplePipeline* Create();
+
+    int            GetThreadCount() const { return nThreads; }
+    CPLErr         SubmitJobs( int iSlot, const GDALOvrResampleJob& sTemplate,
+                               int nSplits );
+    void           WaitCompletion() { oPool.WaitCompletion(); }
+    CPLErr         WriteResults( int iSlot );
+};
+
+/************************************************************************/
+/*                       GDALOvrResamplePipeline()                      */
+/************************************************************************/
+
+GDALOvrResamplePipeline::GDALOvrResamplePipeline() :
+    nThreads(0)
+{}
+
+/************************************************************************/
+/*                      ~GDALOvrResamplePipeline()                      */
+/************************************************************************/
+
+GDALOvrResamplePipeline::~GDALOvrResamplePipeline()
+{
+    oPool.WaitCompletion();
+    FreeJobs(0);
+    FreeJobs(1);
+}
+
+/************************************************************************/
+/*                               Create()                               */
+/************************************************************************/
+
+// Returns NULL if GDAL_NUM_THREADS does not ask for more than one thread.
+GDALOvrResamplePipeline* GDALOvrResamplePipeline::Create()
+{
+    const char* pszNumThreads = CPLGetConfigOption("GDAL_NUM_THREADS", NULL);
+    if( pszNumThreads == NULL )
+        return NULL;
+
+    int nThreads = 0;
+    if( EQUAL(pszNumThreads, "ALL_CPUS") )
+        nThreads = CPLGetNumCPUs();
+    else
+        nThreads = atoi(pszNumThreads);
+    if( nThreads > 128 )
+        nThreads = 128;
+    if( nThreads <= 1 )
+        return NULL;
+
+    GDALOvrResamplePipeline* poPipeline =
+        new (std::nothrow) GDALOvrResamplePipeline();
+    if( poPipeline == NULL ||
+        !poPipeline->oPool.Setup( nThreads, NULL, NULL ) )
+    {
+        delete poPipeline;
+        return NULL;
+    }
+    poPipeline->nThreads = nThreads;
+    CPLDebug( "GDAL", "Using %d threads for overview computation", nThreads );
+    return poPipeline;
+}
+
+/************************************************************************/
+/*                              FreeJobs()                              */
+/************************************************************************/
+
+void GDALOvrResamplePipeline::FreeJobs( int iSlot )
+{
+    for( size_t i = 0; i < apsJobs[iSlot].size(); ++i )
+    {
+        delete apsJobs[iSlot][i]->poChunkBand;
+        delete apsJobs[iSlot][i];
+    }
+    apsJobs[iSlot].clear();
+}
+
+/************************************************************************/
+/*                             SubmitJobs()                             */
+/************************************************************************/
+
+// Split the destination lines [nDstYOff, nDstYOff2[ of sTemplate in at most
+// nSplits jobs. Each destination line only depends on the source chunk, so
+// the result is the same as with a single call to the resampling function.
+CPLErr GDALOvrResamplePipeline::SubmitJobs( int iSlot,
+                                            const GDALOvrResampleJob& sTemplate,
+                                            int nSplits )
+{
+    const int nDstLines = sTemplate.nDstYOff2 - sTemplate.nDstYOff;
+    if( nDstLines <= 0 )
+        return CE_None;
+    if( nSplits > nDstLines )
+        nSplits = nDstLines;
+    if( nSplits < 1 )
+        nSplits = 1;
+
+    for( int iSplit = 0; iSplit < nSplits; ++iSplit )
+    {
+        GDALOvrResampleJob* psJob =
+            new (std::nothrow) GDALOvrResampleJob(sTemplate);
+        if( psJob == NULL )
+            return CE_Failure;
+        psJob->nDstYOff = sTemplate.nDstYOff +
+            static_cast<int>(static_cast<GIntBig>(nDstLines) * iSplit /
+                             nSplits);
+        psJob->nDstYOff2 = sTemplate.nDstYOff +
+            static_cast<int>(static_cast<GIntBig>(nDstLines) * (iSplit + 1) /
+                             nSplits);
+        psJob->eErr = CE_Failure;
+        psJob->poChunkBand = new (std::nothrow) GDALOvrChunkBand(
+            sTemplate.poOverview,
+            psJob->nDstXOff, psJob->nDstYOff,
+            psJob->nDstXOff2 - psJob->nDstXOff,
+            psJob->nDstYOff2 - psJob->nDstYOff );
+        if( psJob->poChunkBand == NULL || !psJob->poChunkBand->IsInitOK() )
+        {
+            delete psJob->poChunkBand;
+            delete psJob;
+            return CE_Failure;
+        }
+        apsJobs[iSlot].push_back(psJob);
+        if( !oPool.SubmitJob( GDALOvrResampleJobFunc, psJob ) )
+        {
+            apsJobs[iSlot].pop_back();
+            delete psJob->poChunkBand;
+            delete psJob;
+            return CE_Failure;
+        }
+    }
+
+    return CE_None;
+}
+
+/************************************************************************/
+/*                            WriteResults()                            */
+/************************************************************************/
+
+// Must be called once the jobs of iSlot are completed.
+CPLErr GDALOvrResamplePipeline::WriteResults( int iSlot )
+{
+    CPLErr eErr = CE_None;
+    for( size_t i = 0; eErr == CE_None && i < apsJobs[iSlot].size(); ++i )
+    {
+        eErr = apsJobs[iSlot][i]->eErr;
+        if( eErr == CE_None )
+            eErr = apsJobs[iSlot][i]->poChunkBand->FlushToOverview();
+    }
+    FreeJobs(iSlot);
+    return eErr;
+}
+
 /************************************************************************/
 /*                      GDALRegenerateOverviews()                       */
 /************************************************************************/
@@ -2460,6 +2988,10 @@ GDALDataType GDALGetOvrWorkDataType( const char* pszResampling,
  * considered as the nodata value and not each value of the triplet
  * independently per band.
  *
+ * Starting with GDAL 2.2, the resampling is done in worker threads,
+ * overlapped with the reading and writing of the bands, when the
+ * GDAL_NUM_THREADS configuration option is set.
+ *
  * @param hSrcBand the source (base level) band.
  * @param nOverviewCount the number of downsampled bands being generated.
  * @param pahOvrBands the list of downsampled bands to be generated.
@@ -2622,20 +3154,39 @@ GDALRegenerateOverviews( GDALRasterBandH hSrcBand,
     const int nMaxChunkYSizeQueried =
         nFullResYChunk + 2 * nKernelRadius * nMaxOvrFactor;
 
-    GByte *pabyChunkNodataMask = NULL;
-    void *pChunk =
-        VSI_MALLOC3_VERBOSE(
-            GDALGetDataTypeSizeBytes(eType), nMaxChunkYSizeQueried, nWidth );
-    if( bUseNoDataMask )
+    // When GDAL_NUM_THREADS is set, the resampling of a chunk is done by
+    // worker threads, while the next chunk is read. Two chunk buffers are
+    // then needed.
+    GDALOvrResamplePipeline* poPipeline = GDALOvrResamplePipeline::Create();
+    const int nSlots = poPipeline != NULL ? 2 : 1;
+
+    void *apChunk[2] = { NULL, NULL };
+    GByte *apabyChunkNodataMask[2] = { NULL, NULL };
+    bool bAllocOK = true;
+    for( int iSlot = 0; iSlot < nSlots; ++iSlot )
     {
-        pabyChunkNodataMask =
-            (GByte*) VSI_MALLOC2_VERBOSE( nMaxChunkYSizeQueried, nWidth );
+        apChunk[iSlot] =
+            VSI_MALLOC3_VERBOSE(
+                GDALGetDataTypeSizeBytes(eType), nMaxChunkYSizeQueried,
+                nWidth );
+        if( bUseNoDataMask )
+        {
+            apabyChunkNodataMask[iSlot] =
+                (GByte*) VSI_MALLOC2_VERBOSE( nMaxChunkYSizeQueried, nWidth );
+        }
+        if( apChunk[iSlot] == NULL ||
+            (bUseNoDataMask && apabyChunkNodataMask[iSlot] == NULL) )
+            bAllocOK = false;
     }
 
-    if( pChunk == NULL || (bUseNoDataMask && pabyChunkNodataMask == NULL))
+    if( !bAllocOK )
     {
-        CPLFree(pChunk);
-        CPLFree(pabyChunkNodataMask);
+        delete poPipeline;
+        for( int iSlot = 0; iSlot < nSlots; ++iSlot )
+        {
+            CPLFree(apChunk[iSlot]);
+            CPLFree(apabyChunkNodataMask[iSlot]);
+        }
         return CE_Failure;
     }
 
@@ -2647,6 +3198,7 @@ GDALRegenerateOverviews( GDALRasterBandH hSrcBand,
 /*      Loop over image operating on chunks.                            */
 /* -------------------------------------------------------------------- */
     int nChunkYOff = 0;
+    int iCurSlot = 0;
     CPLErr eErr = CE_None;
 
     for( nChunkYOff = 0;
@@ -2660,6 +3212,9 @@ GDALRegenerateOverviews( GDALRasterBandH hSrcBand,
             eErr = CE_Failure;
         }
 
+        void *pChunk = apChunk[iCurSlot];
+        GByte *pabyChunkNodataMask = apabyChunkNodataMask[iCurSlot];
+
         if( nFullResYChunk + nChunkYOff > nHeight )
             nFullResYChunk = nHeight - nChunkYOff;
 
@@ -2760,6 +3315,11 @@ GDALRegenerateOverviews( GDALRasterBandH hSrcBand,
             }
         }
 
+        // Wait for the resampling of the previous chunk to be completed,
+        // before submitting the current one.
+        if( poPipeline != NULL )
+            poPipeline->WaitCompletion();
+
         for( int iOverview = 0;
              iOverview < nOverviewCount && eErr == CE_None;
              ++iOverview )
@@ -2789,9 +3349,40 @@ GDALRegenerateOverviews( GDALRasterBandH hSrcBand,
                       "nDstYOff=%d, nDstYOff2=%d", nDstYOff, nDstYOff2 );
 #endif
 
-            if( eType == GDT_Byte ||
-                eType == GDT_UInt16 ||
-                eType == GDT_Float32 )
+            const bool bComplex = !( eType == GDT_Byte ||
+                                     eType == GDT_UInt16 ||
+                                     eType == GDT_Float32 );
+            if( poPipeline != NULL )
+            {
+                GDALOvrResampleJob sJob;
+                sJob.pfnResampleFn = bComplex ? NULL : pfnResampleFn;
+                sJob.dfXRatioDstToSrc = dfXRatioDstToSrc;
+                sJob.dfYRatioDstToSrc = dfYRatioDstToSrc;
+                sJob.eWrkDataType = eType;
+                sJob.pChunk = pChunk;
+                sJob.pabyChunkNodataMask = pabyChunkNodataMask;
+                sJob.nSrcWidth = nWidth;
+                sJob.nSrcHeight = nHeight;
+                sJob.nChunkXOff = 0;
+                sJob.nChunkXSize = nWidth;
+                sJob.nChunkYOff = nChunkYOffQueried;
+                sJob.nChunkYSize = nChunkYSizeQueried;
+                sJob.nDstXOff = 0;
+                sJob.nDstXOff2 = nDstWidth;
+                sJob.nDstYOff = nDstYOff;
+                sJob.nDstYOff2 = nDstYOff2;
+                sJob.poOverview = papoOvrBands[iOverview];
+                sJob.pszResampling = pszResampling;
+                sJob.bHasNoData = bHasNoData;
+                sJob.fNoDataValue = fNoDataValue;
+                sJob.poColorTable = poColorTable;
+                sJob.eSrcDataType = poSrcBand->GetRasterDataType();
+                sJob.poChunkBand = NULL;
+                sJob.eErr = CE_None;
+                eErr = poPipeline->SubmitJobs( iCurSlot, sJob,
+                                               poPipeline->GetThreadCount() );
+            }
+            else if( !bComplex )
                 eErr = pfnResampleFn(
                     dfXRatioDstToSrc, dfYRatioDstToSrc,
                     0.0, 0.0,
@@ -2813,10 +3404,30 @@ GDALRegenerateOverviews( GDALRasterBandH hSrcBand,
                     nDstYOff, nDstYOff2,
                     papoOvrBands[iOverview], pszResampling);
         }
+
+        // Write the results of the previous chunk while the current one
+        // is being resampled.
+        if( poPipeline != NULL )
+        {
+            if( eErr == CE_None )
+                eErr = poPipeline->WriteResults( 1 - iCurSlot );
+            iCurSlot = 1 - iCurSlot;
+        }
     }
 
-    VSIFree( pChunk );
-    VSIFree( pabyChunkNodataMask );
+    if( poPipeline != NULL )
+    {
+        poPipeline->WaitCompletion();
+        if( eErr == CE_None )
+            eErr = poPipeline->WriteResults( 1 - iCurSlot );
+        delete poPipeline;
+    }
+
+    for( int iSlot = 0; iSlot < nSlots; ++iSlot )
+    {
+        VSIFree( apChunk[iSlot] );
+        VSIFree( apabyChunkNodataMask[iSlot] );
+    }
 
 /* -------------------------------------------------------------------- */
 /*      Renormalized overview mean / stddev if needed.                  */
@@ -2880,6 +3491,9 @@ GDALRegenerateOverviews( GDALRasterBandH hSrcBand,
  * considered as the nodata value and not each value of the triplet
  * independently per band.
  *
+ * The bands are resampled in worker threads when GDAL_NUM_THREADS is set
+ * (GDAL >= 2.2).
+ *
  * @param nBands the number of bands, size of papoSrcBands and size of
  *               first dimension of papapoOverviewBands
  * @param papoSrcBands the list of source bands to downsample
@@ -3032,6 +3646,10 @@ GDALRegenerateOverviewsMultiBand( int nBands, GDALRasterBand** papoSrcBands,
             papoSrcBands[iBand]->GetNoDataValue(&pabHasNoData[iBand]) );
     }
 
+    // When GDAL_NUM_THREADS is set, resample the bands of a block in
+    // worker threads, while reading the next block.
+    GDALOvrResamplePipeline* poPipeline = GDALOvrResamplePipeline::Create();
+
     // Second pass to do the real job.
     double dfCurPixelCount = 0;
     CPLErr eErr = CE_None;
@@ -3077,48 +3695,52 @@ GDALRegenerateOverviewsMultiBand( int nBands, GDALRasterBand** papoSrcBands,
         const int nFullResYChunkQueried =
             nFullResYChunk + 2 * nKernelRadius * nOvrFactor;
 
+        // With worker threads, the source blocks are read in one slot
+        // while the bands of the previous block are resampled from the
+        // other one.
+        const int nSlots = poPipeline != NULL ? 2 : 1;
         void** papaChunk = static_cast<void **>(
-            VSI_MALLOC_VERBOSE(nBands * sizeof(void*)) );
+            VSI_CALLOC_VERBOSE(nSlots * nBands, sizeof(void*)) );
         if( papaChunk == NULL )
         {
+            delete poPipeline;
             CPLFree(pabHasNoData);
             CPLFree(pafNoDataValue);
             return CE_Failure;
         }
-        GByte* pabyChunkNoDataMask = NULL;
-        for( int iBand = 0; iBand < nBands; ++iBand )
+        GByte* apabyChunkNoDataMask[2] = { NULL, NULL };
+        bool bAllocOK = true;
+        for( int i = 0; bAllocOK && i < nSlots * nBands; ++i )
         {
-            papaChunk[iBand] = VSI_MALLOC3_VERBOSE(
+            papaChunk[i] = VSI_MALLOC3_VERBOSE(
                 nFullResXChunkQueried,
                 nFullResYChunkQueried,
                 GDALGetDataTypeSizeBytes(eWrkDataType) );
-            if( papaChunk[iBand] == NULL )
-            {
-                while ( --iBand >= 0)
-                    CPLFree(papaChunk[iBand]);
-                CPLFree(papaChunk);
-                CPLFree(pabHasNoData);
-                CPLFree(pafNoDataValue);
-                return CE_Failure;
-            }
+            if( papaChunk[i] == NULL )
+                bAllocOK = false;
         }
-        if( bUseNoDataMask )
+        for( int iSlot = 0; bAllocOK && bUseNoDataMask && iSlot < nSlots;
+             ++iSlot )
         {
-            pabyChunkNoDataMask = static_cast<GByte *>(
+            apabyChunkNoDataMask[iSlot] = static_cast<GByte *>(
                 VSI_MALLOC2_VERBOSE( nFullResXChunkQueried,
                                      nFullResYChunkQueried ) );
-            if( pabyChunkNoDataMask == NULL )
-            {
-                for( int iBand = 0; iBand < nBands; ++iBand )
-                {
-                    CPLFree(papaChunk[iBand]);
-                }
-                CPLFree(papaChunk);
-                CPLFree(pabHasNoData);
-                CPLFree(pafNoDataValue);
-                return CE_Failure;
-            }
+            if( apabyChunkNoDataMask[iSlot] == NULL )
+                bAllocOK = false;
         }
+        if( !bAllocOK )
+        {
+            for( int i = 0; i < nSlots * nBands; ++i )
+                CPLFree(papaChunk[i]);
+            CPLFree(papaChunk);
+            CPLFree(apabyChunkNoDataMask[0]);
+            CPLFree(apabyChunkNoDataMask[1]);
+            delete poPipeline;
+            CPLFree(pabHasNoData);
+            CPLFree(pafNoDataValue);
+            return CE_Failure;
+        }
+        int iCurSlot = 0;
 
         int nDstYOff = 0;
         // Iterate on destination overview, block by block.
@@ -3202,6 +3824,9 @@ GDALRegenerateOverviewsMultiBand( int nBands, GDALRasterBand** papoSrcBands,
                     nDstXOff, nDstYOff, nDstXCount, nDstYCount );
 #endif
 
+                void** papChunk = papaChunk + iCurSlot * nBands;
+                GByte* pabyChunkNoDataMask = apabyChunkNoDataMask[iCurSlot];
+
                 // Read the source buffers for all the bands.
                 for( int iBand = 0; iBand < nBands && eErr == CE_None; ++iBand )
                 {
@@ -3214,7 +3839,7 @@ GDALRegenerateOverviewsMultiBand( int nBands, GDALRasterBand** papoSrcBands,
                         GF_Read,
                         nChunkXOffQueried, nChunkYOffQueried,
                         nChunkXSizeQueried, nChunkYSizeQueried,
-                        papaChunk[iBand],
+                        papChunk[iBand],
                         nChunkXSizeQueried, nChunkYSizeQueried,
                         eWrkDataType, 0, 0, NULL );
                 }
@@ -3235,14 +3860,53 @@ GDALRegenerateOverviewsMultiBand( int nBands, GDALRasterBand** papoSrcBands,
                         GDT_Byte, 0, 0, NULL );
                 }
 
+                // Wait for the resampling of the previous block to be
+                // completed, before submitting the current one.
+                if( poPipeline != NULL )
+                    poPipeline->WaitCompletion();
+
                 // Compute the resulting overview block.
                 for( int iBand = 0; iBand < nBands && eErr == CE_None; ++iBand )
                 {
+                    if( poPipeline != NULL )
+                    {
+                        GDALOvrResampleJob sJob;
+                        sJob.pfnResampleFn = pfnResampleFn;
+                        sJob.dfXRatioDstToSrc = dfXRatioDstToSrc;
+                        sJob.dfYRatioDstToSrc = dfYRatioDstToSrc;
+                        sJob.eWrkDataType = eWrkDataType;
+                        sJob.pChunk = papChunk[iBand];
+                        sJob.pabyChunkNodataMask = pabyChunkNoDataMask;
+                        sJob.nSrcWidth = nSrcWidth;
+                        sJob.nSrcHeight = nSrcHeight;
+                        sJob.nChunkXOff = nChunkXOffQueried;
+                        sJob.nChunkXSize = nChunkXSizeQueried;
+                        sJob.nChunkYOff = nChunkYOffQueried;
+                        sJob.nChunkYSize = nChunkYSizeQueried;
+                        sJob.nDstXOff = nDstXOff;
+                        sJob.nDstXOff2 = nDstXOff + nDstXCount;
+                        sJob.nDstYOff = nDstYOff;
+                        sJob.nDstYOff2 = nDstYOff + nDstYCount;
+                        sJob.poOverview = papapoOverviewBands[iBand][iOverview];
+                        sJob.pszResampling = pszResampling;
+                        sJob.bHasNoData = pabHasNoData[iBand];
+                        sJob.fNoDataValue = pafNoDataValue[iBand];
+                        sJob.poColorTable = NULL;
+                        sJob.eSrcDataType = eDataType;
+                        sJob.poChunkBand = NULL;
+                        sJob.eErr = CE_None;
+                        eErr = poPipeline->SubmitJobs(
+                            iCurSlot, sJob,
+                            (poPipeline->GetThreadCount() + nBands - 1) /
+                                nBands );
+                        continue;
+                    }
+
                     eErr = pfnResampleFn(
                         dfXRatioDstToSrc, dfYRatioDstToSrc,
                         0.0, 0.0,
                         eWrkDataType,
-                        papaChunk[iBand],
+                        papChunk[iBand],
                         pabyChunkNoDataMask,
                         nChunkXOffQueried, nChunkXSizeQueried,
                         nChunkYOffQueried, nChunkYSizeQueried,
@@ -3255,21 +3919,43 @@ GDALRegenerateOverviewsMultiBand( int nBands, GDALRasterBand** papoSrcBands,
                         /*poColorTable*/ NULL,
                         eDataType);
                 }
+
+                // Write the results of the previous block while the current
+                // one is being resampled.
+                if( poPipeline != NULL )
+                {
+                    if( eErr == CE_None )
+                        eErr = poPipeline->WriteResults( 1 - iCurSlot );
+                    iCurSlot = 1 - iCurSlot;
+                }
             }
 
             dfCurPixelCount += static_cast<double>(nYCount) * nSrcWidth;
         }
 
+        // The next overview level may be computed from this one, so all
+        // its blocks must be written at that point.
+        if( poPipeline != NULL )
+        {
+            poPipeline->WaitCompletion();
+            if( eErr == CE_None )
+                eErr = poPipeline->WriteResults( 1 - iCurSlot );
+        }
+
         // Flush the data to overviews.
         for( int iBand = 0; iBand < nBands; ++iBand )
         {
-            CPLFree(papaChunk[iBand]);
             papapoOverviewBands[iBand][iOverview]->FlushCache();
         }
+        for( int i = 0; i < nSlots * nBands; ++i )
+            CPLFree(papaChunk[i]);
         CPLFree(papaChunk);
-        CPLFree(pabyChunkNoDataMask);
+        CPLFree(apabyChunkNoDataMask[0]);
+        CPLFree(apabyChunkNoDataMask[1]);
     }
 
+    delete poPipeline;
+
     CPLFree(pabHasNoData);
     CPLFree(pafNoDataValue);
 
@@ -0,0 +1,54 @@
+/******************************************************************************
+ * $Id$
+ *
+ * Project:  GDAL Core
+ * Purpose:  Private declarations for overview computation.
+ * Author:   agent, <agent at local>
+ *
+ ******************************************************************************
+ * Copyright (c) 2026, agent <agent at local>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ ****************************************************************************/
+
+#ifndef OVERVIEW_PRIV_H_INCLUDED
+#define OVERVIEW_PRIV_H_INCLUDED
+
+#ifndef DOXYGEN_SKIP
+
+#include "cpl_cpu_features.h"
+
+#ifdef HAVE_AVX_AT_COMPILE_TIME
+
+// Defined in overviewavx.cpp. They give the same result as the scalar code
+// paths of overview.cpp.
+
+void GDALOvrAverage2x2Float32AVX( const float* pafSrcRow1,
+                                  const float* pafSrcRow2,
+                                  int nDstCount, float* pafDst );
+
+void GDALOvrConvolutionVertical4ColsAVX( const double* padfSrc, int nStride,
+                                         const double* padfWeights,
+                                         int nSrcLineCount, float* pafDst );
+
+#endif // HAVE_AVX_AT_COMPILE_TIME
+
+#endif // DOXYGEN_SKIP
+
+#endif // OVERVIEW_PRIV_H_INCLUDED
@@ -0,0 +1,131 @@
+/******************************************************************************
+ * $Id$
+ *
+ * Project:  GDAL Core
+ * Purpose:  AVX optimized kernels for overview computation.
+ * Author:   agent, <agent at local>
+ *
+ ******************************************************************************
+ * Copyright (c) 2026, agent <agent at local>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ ****************************************************************************/
+
+#include "cpl_port.h"
+#include "overview_priv.h"
+
+#ifdef HAVE_AVX_AT_COMPILE_TIME
+#include <immintrin.h>
+
+CPL_CVSID("$Id$");
+
+/************************************************************************/
+/*                    GDALOvrAverage2x2Float32AVX()                     */
+/************************************************************************/
+
+// Average of 2x2 source pixels, without nodata. The additions are done in
+// double precision and in the same order as in
+// GDALResampleChunk32R_AverageT<float, double>(), so that the result is
+// identical.
+
+void GDALOvrAverage2x2Float32AVX( const float* pafSrcRow1,
+                                  const float* pafSrcRow2,
+                                  int nDstCount, float* pafDst )
+{
+    const __m256d v_zero = _mm256_setzero_pd();
+    const __m256d v_quarter = _mm256_set1_pd(0.25);
+    int i = 0;  // Used after for.
+    for( ; i + 3 < nDstCount; i += 4 )
+    {
+        const __m128 v_row1_a = _mm_loadu_ps(pafSrcRow1 + 2 * i);
+        const __m128 v_row1_b = _mm_loadu_ps(pafSrcRow1 + 2 * i + 4);
+        const __m128 v_row2_a = _mm_loadu_ps(pafSrcRow2 + 2 * i);
+        const __m128 v_row2_b = _mm_loadu_ps(pafSrcRow2 + 2 * i + 4);
+
+        // Separate even and odd source pixels.
+        const __m256d v_row1_even = _mm256_cvtps_pd(
+            _mm_shuffle_ps(v_row1_a, v_row1_b, _MM_SHUFFLE(2, 0, 2, 0)));
+        const __m256d v_row1_odd = _mm256_cvtps_pd(
+            _mm_shuffle_ps(v_row1_a, v_row1_b, _MM_SHUFFLE(3, 1, 3, 1)));
+        const __m256d v_row2_even = _mm256_cvtps_pd(
+            _mm_shuffle_ps(v_row2_a, v_row2_b, _MM_SHUFFLE(2, 0, 2, 0)));
+        const __m256d v_row2_odd = _mm256_cvtps_pd(
+            _mm_shuffle_ps(v_row2_a, v_row2_b, _MM_SHUFFLE(3, 1, 3, 1)));
+
+        // Starting from zero matters for negative zero values.
+        __m256d v_sum = _mm256_add_pd(v_zero, v_row1_even);
+        v_sum = _mm256_add_pd(v_sum, v_row1_odd);
+        v_sum = _mm256_add_pd(v_sum, v_row2_even);
+        v_sum = _mm256_add_pd(v_sum, v_row2_odd);
+
+        // Multiplying by 0.25 is exactly the same as dividing by 4.
+        _mm_storeu_ps(pafDst + i,
+                      _mm256_cvtpd_ps(_mm256_mul_pd(v_sum, v_quarter)));
+    }
+    for( ; i < nDstCount; ++i )
+    {
+        double dfTotal = 0;
+        dfTotal += pafSrcRow1[2 * i];
+        dfTotal += pafSrcRow1[2 * i + 1];
+        dfTotal += pafSrcRow2[2 * i];
+        dfTotal += pafSrcRow2[2 * i + 1];
+        pafDst[i] = static_cast<float>(dfTotal / 4);
+    }
+}
+
+/************************************************************************/
+/*                GDALOvrConvolutionVertical4ColsAVX()                  */
+/************************************************************************/
+
+// Vertical pass of the convolution on 4 consecutive columns, with the same
+// accumulation scheme as GDALResampleConvolutionVertical_2cols().
+
+void GDALOvrConvolutionVertical4ColsAVX( const double* padfSrc, int nStride,
+                                         const double* padfWeights,
+                                         int nSrcLineCount, float* pafDst )
+{
+    __m256d v_acc1 = _mm256_setzero_pd();
+    __m256d v_acc2 = _mm256_setzero_pd();
+    int i = 0;  // Used after for.
+    size_t j = 0;  // Used after for.
+    for( ; i + 3 < nSrcLineCount; i += 4, j += 4 * static_cast<size_t>(nStride) )
+    {
+        v_acc1 = _mm256_add_pd(v_acc1,
+            _mm256_mul_pd(_mm256_loadu_pd(padfSrc + j),
+                          _mm256_set1_pd(padfWeights[i])));
+        v_acc1 = _mm256_add_pd(v_acc1,
+            _mm256_mul_pd(_mm256_loadu_pd(padfSrc + j + nStride),
+                          _mm256_set1_pd(padfWeights[i + 1])));
+        v_acc2 = _mm256_add_pd(v_acc2,
+            _mm256_mul_pd(_mm256_loadu_pd(padfSrc + j + 2 * nStride),
+                          _mm256_set1_pd(padfWeights[i + 2])));
+        v_acc2 = _mm256_add_pd(v_acc2,
+            _mm256_mul_pd(_mm256_loadu_pd(padfSrc + j + 3 * nStride),
+                          _mm256_set1_pd(padfWeights[i + 3])));
+    }
+    for( ; i < nSrcLineCount; ++i, j += nStride )
+    {
+        v_acc1 = _mm256_add_pd(v_acc1,
+            _mm256_mul_pd(_mm256_loadu_pd(padfSrc + j),
+                          _mm256_set1_pd(padfWeights[i])));
+    }
+    _mm_storeu_ps(pafDst, _mm256_cvtpd_ps(_mm256_add_pd(v_acc1, v_acc2)));
+}
+
+#endif // HAVE_AVX_AT_COMPILE_TIME
@@ -35,9 +35,12 @@
 #include "gdalwarper.h"
 #include "memdataset.h"
 #include "vrtdataset.h"
+#include "cpl_multiproc.h"
 
+#include <deque>
 #include <stdexcept>
 #include <limits>
+#include <vector>
 
 CPL_CVSID("$Id$");
 
@@ -3575,6 +3578,496 @@ static void GDALCopyWholeRasterGetSwathSize(
     *pnSwathLines = nSwathLines;
 }
 
+/************************************************************************/
+/*                    GDALCopyWholeRasterPipeline                       */
+/*                                                                      */
+/*      When GDAL_NUM_THREADS asks for more than one thread,            */
+/*      GDALDatasetCopyWholeRaster() reads the swaths in a dedicated    */
+/*      thread while the calling thread writes them, so that decoding   */
+/*      of the source and encoding of the target overlap.  With at      */
+/*      least 3 threads, and when the source data type differs from     */
+/*      the target one, the data type conversion runs in a third        */
+/*      stage.  Swaths cycle through a fixed number of slots, so the    */
+/*      memory used is bounded to a few swath buffers.                  */
+/************************************************************************/
+
+namespace {
+
+typedef struct
+{
+    CPLErr      eErrClass;
+    CPLErrorNum nErrNo;
+    CPLString   osMsg;
+} GDALCopyDeferredError;
+
+typedef struct
+{
+    int         nBand;          // 0 means all bands.
+    int         iX;
+    int         iY;
+    int         nCols;
+    int         nLines;
+    void       *pReadBuf;
+    void       *pWriteBuf;      // Same as pReadBuf without conversion stage.
+    CPLErr      eErr;
+    std::vector<GDALCopyDeferredError> aoErrors;
+} GDALCopySwath;
+
+class GDALCopyWholeRasterPipeline
+{
+  public:
+    GDALDataset   *poSrcDS;
+    int            nXSize;
+    int            nYSize;
+    int            nBandCount;
+    int            nSwathCols;
+    int            nSwathLines;
+    bool           bInterleave;
+    GDALDataType   eReadDT;
+    GDALDataType   eDT;
+
+    CPLMutex      *hMutex;
+    CPLCond       *hCond;
+    bool           bAbort;
+
+    std::vector<GDALCopySwath *> apsSlots;
+    std::deque<GDALCopySwath *>  apsFree;
+    std::deque<GDALCopySwath *>  apsRead;
+    std::deque<GDALCopySwath *>  apsConverted;
+
+                   GDALCopyWholeRasterPipeline();
+                  ~GDALCopyWholeRasterPipeline();
+
+    bool           AllocateSlots( int nSlots );
+    bool           HasConversionStage() const { return eReadDT != eDT; }
+
+    GDALCopySwath *Pop( std::deque<GDALCopySwath *>& oQueue );
+    void           Push( std::deque<GDALCopySwath *>& oQueue,
+                         GDALCopySwath *psSwath );
+    void           Abort();
+
+    void           Read();
+    void           Convert();
+
+  private:
+    CPL_DISALLOW_COPY_ASSIGN(GDALCopyWholeRasterPipeline);
+};
+
+/************************************************************************/
+/*                    GDALCopyWholeRasterPipeline()                     */
+/************************************************************************/
+
+GDALCopyWholeRasterPipeline::GDALCopyWholeRasterPipeline() :
+    poSrcDS(NULL),
+    nXSize(0),
+    nYSize(0),
+    nBandCount(0),
+    nSwathCols(0),
+    nSwathLines(0),
+    bInterleave(false),
+    eReadDT(GDT_Unknown),
+    eDT(GDT_Unknown),
+    hMutex(NULL),
+    hCond(CPLCreateCond()),
+    bAbort(false)
+{
+    hMutex = CPLCreateMutex();
+    CPLReleaseMutex(hMutex);
+}
+
+/************************************************************************/
+/*                   ~GDALCopyWholeRasterPipeline()                     */
+/************************************************************************/
+
+GDALCopyWholeRasterPipeline::~GDALCopyWholeRasterPipeline()
+{
+    for( size_t i = 0; i < apsSlots.size(); ++i )
+    {
+        if( apsSlots[i]->pWriteBuf != apsSlots[i]->pReadBuf )
+            CPLFree( apsSlots[i]->pWriteBuf );
+        CPLFree( apsSlots[i]->pReadBuf );
+        delete apsSlots[i];
+    }
+    if( hCond != NULL )
+        CPLDestroyCond( hCond );
+    if( hMutex != NULL )
+        CPLDestroyMutex( hMutex );
+}
+
+/************************************************************************/
+/*                           AllocateSlots()                            */
+/************************************************************************/
+
+bool GDALCopyWholeRasterPipeline::AllocateSlots( int nSlots )
+{
+    if( hMutex == NULL || hCond == NULL )
+        return false;
+
+    const int nBufBands = bInterleave ? nBandCount : 1;
+    for( int i = 0; i < nSlots; ++i )
+    {
+        GDALCopySwath *psSwath = new GDALCopySwath;
+        psSwath->nBand = 0;
+        psSwath->iX = 0;
+        psSwath->iY = 0;
+        psSwath->nCols = 0;
+        psSwath->nLines = 0;
+        psSwath->eErr = CE_None;
+        psSwath->pReadBuf = VSI_MALLOC3_VERBOSE(
+            nSwathCols, nSwathLines,
+            GDALGetDataTypeSizeBytes(eReadDT) * nBufBands );
+        psSwath->pWriteBuf = psSwath->pReadBuf;
+        if( HasConversionStage() && psSwath->pReadBuf != NULL )
+        {
+            psSwath->pWriteBuf = VSI_MALLOC3_VERBOSE(
+                nSwathCols, nSwathLines,
+                GDALGetDataTypeSizeBytes(eDT) * nBufBands );
+        }
+        apsSlots.push_back( psSwath );
+        if( psSwath->pReadBuf == NULL || psSwath->pWriteBuf == NULL )
+        {
+            // Make sure the destructor does not free pReadBuf twice.
+            if( psSwath->pWriteBuf == NULL )
+                psSwath->pWriteBuf = psSwath->pReadBuf;
+            return false;
+        }
+        apsFree.push_back( psSwath );
+    }
+    return true;
+}
+
+/************************************************************************/
+/*                                Pop()                                 */
+/*                                                                      */
+/*      Wait for a swath in the queue.  NULL is returned at the end of  */
+/*      the stream or when the pipeline is aborted.                     */
+/************************************************************************/
+
+GDALCopySwath *
+GDALCopyWholeRasterPipeline::Pop( std::deque<GDALCopySwath *>& oQueue )
+{
+    CPLMutexHolderD( &hMutex );
+    while( oQueue.empty() && !bAbort )
+        CPLCondWait( hCond, hMutex );
+    if( bAbort )
+        return NULL;
+    GDALCopySwath *psSwath = oQueue.front();
+    oQueue.pop_front();
+    return psSwath;
+}
+
+/************************************************************************/
+/*                                Push()                                */
+/************************************************************************/
+
+void GDALCopyWholeRasterPipeline::Push( std::deque<GDALCopySwath *>& oQueue,
+                                        GDALCopySwath *psSwath )
+{
+    CPLMutexHolderD( &hMutex );
+    oQueue.push_back( psSwath );
+    CPLCondBroadcast( hCond );
+}
+
+/************************************************************************/
+/*                               Abort()                                */
+/************************************************************************/
+
+void GDALCopyWholeRasterPipeline::Abort()
+{
+    CPLMutexHolderD( &hMutex );
+    bAbort = true;
+    CPLCondBroadcast( hCond );
+}
+
+/************************************************************************/
+/*                      GDALCopyDeferErrorHandler()                     */
+/*                                                                      */
+/*      Errors emitted by the stage threads are attached to the swath   */
+/*      and emitted again by the calling thread, so that they reach     */
+/*      its error handlers and last error state.                        */
+/************************************************************************/
+
+static void CPL_STDCALL GDALCopyDeferErrorHandler( CPLErr eErrClass,
+                                                   CPLErrorNum nErrNo,
+                                                   const char *pszMsg )
+{
+    GDALCopySwath *psSwath =
+        static_cast<GDALCopySwath *>( CPLGetErrorHandlerUserData() );
+    GDALCopyDeferredError sError;
+    sError.eErrClass = eErrClass;
+    sError.nErrNo = nErrNo;
+    sError.osMsg = pszMsg;
+    psSwath->aoErrors.push_back( sError );
+}
+
+/************************************************************************/
+/*                                Read()                                */
+/************************************************************************/
+
+void GDALCopyWholeRasterPipeline::Read()
+{
+    const int nBandPasses = bInterleave ? 1 : nBandCount;
+    for( int iBand = 0; iBand < nBandPasses; iBand++ )
+    {
+        for( int iY = 0; iY < nYSize; iY += nSwathLines )
+        {
+            for( int iX = 0; iX < nXSize; iX += nSwathCols )
+            {
+                GDALCopySwath *psSwath = Pop( apsFree );
+                if( psSwath == NULL )
+                    return;
+
+                psSwath->nBand = bInterleave ? 0 : iBand + 1;
+                psSwath->iX = iX;
+                psSwath->iY = iY;
+                psSwath->nCols = MIN(nSwathCols, nXSize - iX);
+                psSwath->nLines = MIN(nSwathLines, nYSize - iY);
+                psSwath->aoErrors.clear();
+
+                CPLPushErrorHandlerEx( GDALCopyDeferErrorHandler, psSwath );
+                CPLSetCurrentErrorHandlerCatchDebug( FALSE );
+                psSwath->eErr = poSrcDS->RasterIO(
+                    GF_Read,
+                    psSwath->iX, psSwath->iY, psSwath->nCols, psSwath->nLines,
+                    psSwath->pReadBuf, psSwath->nCols, psSwath->nLines,
+                    eReadDT,
+                    bInterleave ? nBandCount : 1,
+                    bInterleave ? NULL : &(psSwath->nBand),
+                    0, 0, 0, NULL );
+                CPLPopErrorHandler();
+
+                Push( HasConversionStage() ? apsRead : apsConverted,
+                      psSwath );
+                if( psSwath->eErr != CE_None )
+                    return;
+            }
+        }
+    }
+
+    // End of stream.
+    Push( HasConversionStage() ? apsRead : apsConverted, NULL );
+}
+
+/************************************************************************/
+/*                              Convert()                               */
+/************************************************************************/
+
+void GDALCopyWholeRasterPipeline::Convert()
+{
+    const int nReadDTSize = GDALGetDataTypeSizeBytes(eReadDT);
+    const int nDTSize = GDALGetDataTypeSizeBytes(eDT);
+    const int nBufBands = bInterleave ? nBandCount : 1;
+
+    while( true )
+    {
+        GDALCopySwath *psSwath = Pop( apsRead );
+        if( psSwath == NULL )
+            break;
+
+        if( psSwath->eErr == CE_None )
+        {
+            // The swath buffers are band sequential, so this is a plain
+            // conversion of nLines * nBufBands rows of nCols values.
+            const int nRows = psSwath->nLines * nBufBands;
+            for( int iRow = 0; iRow < nRows; iRow++ )
+            {
+                GDALCopyWords(
+                    static_cast<GByte *>(psSwath->pReadBuf) +
+                        static_cast<size_t>(iRow) * psSwath->nCols *
+                        nReadDTSize,
+                    eReadDT, nReadDTSize,
+                    static_cast<GByte *>(psSwath->pWriteBuf) +
+                        static_cast<size_t>(iRow) * psSwath->nCols * nDTSize,
+                    eDT, nDTSize,
+                    psSwath->nCols );
+            }
+        }
+
+        Push( apsConverted, psSwath );
+    }
+
+    Push( apsConverted, NULL );
+}
+
+static void GDALCopyWholeRasterReadThread( void *pData )
+{
+    // The blocks the reads push out of the cache may be dirty blocks of
+    // the target.  Leave them to the writing thread, so that they are
+    // written from a single thread and in the order of the sequential copy.
+    GDALRasterBlock::EnterDisableDirtyBlockFlush();
+    static_cast<GDALCopyWholeRasterPipeline *>(pData)->Read();
+    GDALRasterBlock::LeaveDisableDirtyBlockFlush();
+}
+
+static void GDALCopyWholeRasterConvertThread( void *pData )
+{
+    static_cast<GDALCopyWholeRasterPipeline *>(pData)->Convert();
+}
+
+}  // namespace
+
+/************************************************************************/
+/*                 GDALDatasetCopyWholeRasterPipelined()                */
+/*                                                                      */
+/*      Returns -1 if the pipeline cannot be used, in which case the    */
+/*      caller falls back to the sequential implementation.             */
+/************************************************************************/
+
+static int GDALDatasetCopyWholeRasterPipelined( GDALDataset *poSrcDS,
+                                                GDALDataset *poDstDS,
+                                                GDALDataType eDT,
+                                                bool bInterleave,
+                                                int nSwathCols,
+                                                int nSwathLines,
+                                                GDALProgressFunc pfnProgress,
+                                                void *pProgressData )
+{
+    const char *pszNumThreads = CPLGetConfigOption("GDAL_NUM_THREADS", NULL);
+    if( pszNumThreads == NULL )
+        return -1;
+
+    int nThreads = 0;
+    if( EQUAL(pszNumThreads, "ALL_CPUS") )
+        nThreads = CPLGetNumCPUs();
+    else
+        nThreads = atoi(pszNumThreads);
+    if( nThreads <= 1 )
+        return -1;
+
+    const int nXSize = poDstDS->GetRasterXSize();
+    const int nYSize = poDstDS->GetRasterYSize();
+    const int nBandCount = poDstDS->GetRasterCount();
+    const int nTotalBlocks =
+        (bInterleave ? 1 : nBandCount) *
+        ((nYSize + nSwathLines - 1) / nSwathLines) *
+        ((nXSize + nSwathCols - 1) / nSwathCols);
+    if( nTotalBlocks < 2 )
+        return -1;
+
+/* -------------------------------------------------------------------- */
+/*      With a third thread, read the source in its own data type and   */
+/*      convert in a separate stage.  This is only done when all the    */
+/*      source bands share the same data type, and not for VRT, whose   */
+/*      sources might compute values in the requested buffer type.      */
+/* -------------------------------------------------------------------- */
+    GDALDataType eReadDT = eDT;
+    if( nThreads >= 3 &&
+        !(poSrcDS->GetDriver() != NULL &&
+          EQUAL(poSrcDS->GetDriver()->GetDescription(), "VRT")) )
+    {
+        const GDALDataType eSrcDT =
+            poSrcDS->GetRasterBand(1)->GetRasterDataType();
+        bool bSameType = true;
+        for( int iBand = 1; iBand < nBandCount && bSameType; iBand++ )
+        {
+            if( poSrcDS->GetRasterBand(iBand + 1)->GetRasterDataType()
+                != eSrcDT )
+                bSameType = false;
+        }
+        if( bSameType )
+            eReadDT = eSrcDT;
+    }
+
+    GDALCopyWholeRasterPipeline oPipeline;
+    oPipeline.poSrcDS = poSrcDS;
+    oPipeline.nXSize = nXSize;
+    oPipeline.nYSize = nYSize;
+    oPipeline.nBandCount = nBandCount;
+    oPipeline.nSwathCols = nSwathCols;
+    oPipeline.nSwathLines = nSwathLines;
+    oPipeline.bInterleave = bInterleave;
+    oPipeline.eReadDT = eReadDT;
+    oPipeline.eDT = eDT;
+
+    // One slot per stage, plus one so that the reader does not wait for
+    // the writer to release a swath.
+    const int nStages = oPipeline.HasConversionStage() ? 3 : 2;
+    // The sequential implementation needs a single swath buffer, so let it
+    // try before reporting an allocation failure.
+    CPLPushErrorHandler( CPLQuietErrorHandler );
+    const bool bAllocated = oPipeline.AllocateSlots( nStages + 1 );
+    CPLPopErrorHandler();
+    if( !bAllocated )
+    {
+        CPLErrorReset();
+        return -1;
+    }
+
+    CPLDebug( "GDAL",
+              "GDALDatasetCopyWholeRaster(): using a %d stage pipeline",
+              nStages );
+
+    CPLJoinableThread *hReadThread =
+        CPLCreateJoinableThread( GDALCopyWholeRasterReadThread, &oPipeline );
+    if( hReadThread == NULL )
+        return -1;
+    CPLJoinableThread *hConvertThread = NULL;
+    if( oPipeline.HasConversionStage() )
+    {
+        hConvertThread = CPLCreateJoinableThread(
+            GDALCopyWholeRasterConvertThread, &oPipeline );
+        if( hConvertThread == NULL )
+        {
+            oPipeline.Abort();
+            CPLJoinThread( hReadThread );
+            return CE_Failure;
+        }
+    }
+
+/* -------------------------------------------------------------------- */
+/*      Write the swaths as they come out of the pipeline.              */
+/* -------------------------------------------------------------------- */
+    CPLErr eErr = CE_None;
+    int nBlocksDone = 0;
+    while( eErr == CE_None )
+    {
+        GDALCopySwath *psSwath = oPipeline.Pop( oPipeline.apsConverted );
+        if( psSwath == NULL )
+            break;
+
+        for( size_t i = 0; i < psSwath->aoErrors.size(); ++i )
+        {
+            CPLError( psSwath->aoErrors[i].eErrClass,
+                      psSwath->aoErrors[i].nErrNo,
+                      "%s", psSwath->aoErrors[i].osMsg.c_str() );
+        }
+
+        eErr = psSwath->eErr;
+        if( eErr == CE_None )
+        {
+            eErr = poDstDS->RasterIO(
+                GF_Write,
+                psSwath->iX, psSwath->iY, psSwath->nCols, psSwath->nLines,
+                psSwath->pWriteBuf, psSwath->nCols, psSwath->nLines,
+                eDT,
+                bInterleave ? nBandCount : 1,
+                bInterleave ? NULL : &(psSwath->nBand),
+                0, 0, 0, NULL );
+        }
+
+        nBlocksDone++;
+        if( eErr == CE_None &&
+            !pfnProgress( nBlocksDone / static_cast<double>(nTotalBlocks),
+                          NULL, pProgressData ) )
+        {
+            eErr = CE_Failure;
+            CPLError( CE_Failure, CPLE_UserInterrupt,
+                      "User terminated CreateCopy()" );
+        }
+
+        oPipeline.Push( oPipeline.apsFree, psSwath );
+    }
+
+    if( eErr != CE_None )
+        oPipeline.Abort();
+
+    CPLJoinThread( hReadThread );
+    if( hConvertThread != NULL )
+        CPLJoinThread( hConvertThread );
+
+    return eErr;
+}
+
 /************************************************************************/
 /*                     GDALDatasetCopyWholeRaster()                     */
 /************************************************************************/
@@ -3597,6 +4090,9 @@ static void GDALCopyWholeRasterGetSwathSize(
  * target dataset block sizes to achieve best compression.  More options may be
  * supported in the future.
  *
+ * Starting with GDAL 2.2, when GDAL_NUM_THREADS is set, the next swath is
+ * read in another thread while the current one is written.
+ *
  * @param hSrcDS the source dataset
  * @param hDstDS the destination dataset
  * @param papszOptions transfer hints in "StringList" Name=Value format.
@@ -3707,12 +4203,6 @@ CPLErr CPL_STDCALL GDALDatasetCopyWholeRaster(
     if( bInterleave)
         nPixelSize *= nBandCount;
 
-    void *pSwathBuf = VSI_MALLOC3_VERBOSE(nSwathCols, nSwathLines, nPixelSize );
-    if( pSwathBuf == NULL )
-    {
-        return CE_Failure;
-    }
-
     CPLDebug( "GDAL",
               "GDALDatasetCopyWholeRaster(): %d*%d swaths, bInterleave=%d",
               nSwathCols, nSwathLines, static_cast<int>(bInterleave) );
@@ -3724,6 +4214,21 @@ CPLErr CPL_STDCALL GDALDatasetCopyWholeRaster(
                              nBandCount, NULL, NULL);
     }
 
+/* ==================================================================== */
+/*      Pipelined case.                                                 */
+/* ==================================================================== */
+    const int nPipelineRet = GDALDatasetCopyWholeRasterPipelined(
+        poSrcDS, poDstDS, eDT, bInterleave, nSwathCols, nSwathLines,
+        pfnProgress, pProgressData );
+    if( nPipelineRet >= 0 )
+        return static_cast<CPLErr>(nPipelineRet);
+
+    void *pSwathBuf = VSI_MALLOC3_VERBOSE(nSwathCols, nSwathLines, nPixelSize );
+    if( pSwathBuf == NULL )
+    {
+        return CE_Failure;
+    }
+
 /* ==================================================================== */
 /*      Band oriented (uninterleaved) case.                             */
 /* ==================================================================== */
@@ -457,12 +457,14 @@ class CPL_DLL OGRFeature
 class OGRLayer;
 class swq_expr_node;
 class swq_custom_func_registrar;
+class OGRFeatureQueryProgram;
 
 class CPL_DLL OGRFeatureQuery
 {
   private:
     OGRFeatureDefn *poTargetDefn;
     void           *pSWQExpr;
+    OGRFeatureQueryProgram *poProgram;
 
     char          **FieldCollector( void *, char ** );
 
@@ -2163,6 +2163,16 @@ OGRErr OGRSpatialReference::importFromEPSGA( int nCode )
         return OGRERR_FAILURE;
     }
 
+/* -------------------------------------------------------------------- */
+/*      Reuse the result of a previous import of the same code from     */
+/*      the same support files.                                         */
+/* -------------------------------------------------------------------- */
+    CPLString osCacheKey;
+    osCacheKey.Printf( "EPSGA:%d:%s", nCode, CSVFilename( "gcs.csv" ) );
+    poRoot = OSRGetCachedImport( osCacheKey, NULL );
+    if( poRoot != NULL )
+        return OGRERR_NONE;
+
 /* -------------------------------------------------------------------- */
 /*      Try this as various sorts of objects till one works.            */
 /* -------------------------------------------------------------------- */
@@ -2245,6 +2255,9 @@ OGRErr OGRSpatialReference::importFromEPSGA( int nCode )
         eErr = FixupOrdering();
     }
 
+    if( eErr == OGRERR_NONE )
+        OSRCacheImport( osCacheKey, GetRoot(), 0 );
+
     return eErr;
 }
 
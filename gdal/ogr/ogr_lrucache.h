@@ -0,0 +1,123 @@
+/******************************************************************************
+ * $Id$
+ *
+ * Project:  OpenGIS Simple Features Reference Implementation
+ * Purpose:  Small least-recently-used cache used by the SRS/CT caches.
+ * Author:   agent, <agent at local>
+ *
+ ******************************************************************************
+ * Copyright (c) 2026, agent <agent at local>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ ****************************************************************************/
+
+#ifndef OGR_LRUCACHE_H_INCLUDED
+#define OGR_LRUCACHE_H_INCLUDED
+
+#ifndef DOXYGEN_SKIP
+
+#include "cpl_string.h"
+
+#include <list>
+#include <map>
+#include <utility>
+#include <vector>
+
+/************************************************************************/
+/*                             OGRLRUCache                              */
+/*                                                                      */
+/*      Map from a string key to a value, bounded to a maximum number   */
+/*      of entries with the least recently used one evicted first.      */
+/*      The cache does not own the values: evicted ones are handed      */
+/*      back to the caller so that it can release them, typically       */
+/*      after having released the lock protecting the cache.            */
+/*      This class is not thread-safe by itself.                        */
+/************************************************************************/
+
+template<class Value> class OGRLRUCache
+{
+    typedef std::pair<CPLString, Value>            Entry;
+    typedef std::list<Entry>                       EntryList;
+    typedef std::map<CPLString, typename EntryList::iterator> EntryMap;
+
+    EntryList   oList;  // Most recently used first.
+    EntryMap    oMap;
+    size_t      nMaxSize;
+
+  public:
+    explicit OGRLRUCache( size_t nMaxSizeIn ) : nMaxSize(nMaxSizeIn) {}
+
+    size_t  GetMaxSize() const { return nMaxSize; }
+    size_t  size() const { return oList.size(); }
+
+    /* Returns a pointer to the value stored in the cache (valid until the
+     * next Insert() / Remove() / Clear()), or NULL. */
+    Value  *Get( const CPLString& osKey )
+    {
+        typename EntryMap::iterator oIter = oMap.find(osKey);
+        if( oIter == oMap.end() )
+            return NULL;
+        if( oIter->second != oList.begin() )
+            oList.splice(oList.begin(), oList, oIter->second);
+        return &(oIter->second->second);
+    }
+
+    /* Inserts or replaces the value for osKey. Values that are replaced or
+     * evicted to honour the maximum size are appended to aoEvicted. */
+    void    Insert( const CPLString& osKey, const Value& oValue,
+                    std::vector<Value>& aoEvicted )
+    {
+        typename EntryMap::iterator oIter = oMap.find(osKey);
+        if( oIter != oMap.end() )
+        {
+            aoEvicted.push_back(oIter->second->second);
+            oList.erase(oIter->second);
+            oMap.erase(oIter);
+        }
+        if( nMaxSize == 0 )
+        {
+            aoEvicted.push_back(oValue);
+            return;
+        }
+        while( oList.size() >= nMaxSize )
+        {
+            aoEvicted.push_back(oList.back().second);
+            oMap.erase(oList.back().first);
+            oList.pop_back();
+        }
+        oList.push_front(Entry(osKey, oValue));
+        oMap[osKey] = oList.begin();
+    }
+
+    /* Moves all values to aoEvicted and empties the cache. */
+    void    Clear( std::vector<Value>& aoEvicted )
+    {
+        for( typename EntryList::iterator oIter = oList.begin();
+             oIter != oList.end(); ++oIter )
+        {
+            aoEvicted.push_back(oIter->second);
+        }
+        oList.clear();
+        oMap.clear();
+    }
+};
+
+#endif /* #ifndef DOXYGEN_SKIP */
+
+#endif /* ndef OGR_LRUCACHE_H_INCLUDED */
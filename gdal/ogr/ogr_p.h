@@ -137,6 +137,12 @@ extern const swq_field_type SpecialFieldTypes[SPECIAL_FIELD_COUNT];
 
 OGRErr CPL_DLL OSRGetEllipsoidInfo( int, char **, double *, double *);
 
+/* Cache of successful SRS imports (ogrspatialreference.cpp) */
+class OGR_SRSNode;
+OGR_SRSNode *OSRGetCachedImport( const char *pszKey, size_t *pnConsumed );
+void OSRCacheImport( const char *pszKey, const OGR_SRSNode *poRoot,
+                     size_t nConsumed );
+
 /* Fast atof function */
 double OGRFastAtof(const char* pszStr);
 
@@ -770,6 +770,7 @@ OCTTransformEx( OGRCoordinateTransformationH hCT,
 char *OCTProj4Normalize( const char *pszProj4Src );
 
 void OCTCleanupProjMutex( void );
+void OCTCleanupTransformCache( void );
 
 /* -------------------------------------------------------------------- */
 /*      Projection transform dictionary query.                          */
@@ -34,6 +34,12 @@
 #include "cpl_conv.h"
 #include "cpl_string.h"
 #include "cpl_multiproc.h"
+#include "cpl_worker_thread_pool.h"
+#include "gdalsse_priv.h"
+#include "ogr_lrucache.h"
+
+#include <algorithm>
+#include <vector>
 
 #ifdef PROJ_STATIC
 #include "proj_api.h"
@@ -115,10 +121,232 @@ void OCTCleanupProjMutex()
     }
 }
 
+/* ==================================================================== */
+/*      Process-wide cache of transformations.                          */
+/*                                                                      */
+/*      Entries are keyed by the WKT of the source and target SRS and   */
+/*      remember the PROJ.4 definitions derived from them. When PROJ    */
+/*      contexts are available, destroyed transformations also leave    */
+/*      their initialized context and handles in the entry, so that     */
+/*      the next identical transformation can adopt them directly.      */
+/* ==================================================================== */
+
+typedef struct
+{
+    projCtx     pjctx;
+    projPJ      psPJSource;
+    projPJ      psPJTarget;
+} OGRProj4CTHandles;
+
+struct OGRProj4CTCacheEntry
+{
+    CPLString   osSrcProj4Defn;
+    CPLString   osDstProj4Defn;
+    int         bWGS84ToWebMercator;
+    int         bWebMercatorToWGS84;
+    std::vector<OGRProj4CTHandles> aoIdleHandles;
+};
+
+// Maximum number of idle handle sets kept per cache entry.
+static const size_t MAX_IDLE_HANDLES = 8;
+
+static CPLMutex *hCTCacheMutex = NULL;
+static OGRLRUCache<OGRProj4CTCacheEntry*> *poCTCache = NULL;
+static GUIntBig nCTCacheHits = 0;
+static GUIntBig nCTCacheHandleReuses = 0;
+static GUIntBig nCTCacheMisses = 0;
+
+/************************************************************************/
+/*                          OCTGetCacheSize()                           */
+/************************************************************************/
+
+static int OCTGetCacheSize()
+{
+    return atoi(CPLGetConfigOption("OGR_CT_CACHE_SIZE", "32"));
+}
+
+/************************************************************************/
+/*                       OCTFreeCacheEntries()                          */
+/************************************************************************/
+
+static void OCTFreeCacheEntries(
+                        const std::vector<OGRProj4CTCacheEntry*>& apoEntries )
+{
+    for( size_t i = 0; i < apoEntries.size(); i++ )
+    {
+        OGRProj4CTCacheEntry *poEntry = apoEntries[i];
+        for( size_t j = 0; j < poEntry->aoIdleHandles.size(); j++ )
+        {
+            const OGRProj4CTHandles& sHandles = poEntry->aoIdleHandles[j];
+            pfn_pj_free( sHandles.psPJSource );
+            pfn_pj_free( sHandles.psPJTarget );
+            pfn_pj_ctx_free( sHandles.pjctx );
+        }
+        delete poEntry;
+    }
+}
+
+/************************************************************************/
+/*                           OCTGetCacheKey()                           */
+/*                                                                      */
+/*      Returns an empty string if the cache is disabled.               */
+/************************************************************************/
+
+static CPLString OCTGetCacheKey( OGRSpatialReference *poSource,
+                                 OGRSpatialReference *poTarget )
+{
+    CPLString osKey;
+    if( OCTGetCacheSize() <= 0 )
+        return osKey;
+
+    char *pszSrcWKT = NULL;
+    char *pszDstWKT = NULL;
+    if( poSource->exportToWkt( &pszSrcWKT ) == OGRERR_NONE &&
+        poTarget->exportToWkt( &pszDstWKT ) == OGRERR_NONE )
+    {
+        // Also account for the configuration options that
+        // exportToProj4() honours.
+        osKey = pszSrcWKT;
+        osKey += '\n';
+        osKey += pszDstWKT;
+        osKey += '\n';
+        osKey += CPLGetConfigOption("OSR_USE_ETMERC", "");
+        osKey += '\n';
+        osKey += CPLGetConfigOption("OVERRIDE_PROJ_DATUM_WITH_TOWGS84", "");
+    }
+    CPLFree( pszSrcWKT );
+    CPLFree( pszDstWKT );
+    return osKey;
+}
+
+/************************************************************************/
+/*                          OCTInsertInCache()                          */
+/************************************************************************/
+
+static void OCTInsertInCache( const CPLString& osKey,
+                              const char *pszSrcProj4Defn,
+                              const char *pszDstProj4Defn,
+                              int bWGS84ToWebMercator,
+                              int bWebMercatorToWGS84 )
+{
+    std::vector<OGRProj4CTCacheEntry*> apoEvicted;
+    {
+        CPLMutexHolderD( &hCTCacheMutex );
+        if( poCTCache == NULL )
+            poCTCache = new OGRLRUCache<OGRProj4CTCacheEntry*>(
+                                                        OCTGetCacheSize() );
+        else if( poCTCache->Get(osKey) != NULL )
+            return;
+
+        OGRProj4CTCacheEntry *poEntry = new OGRProj4CTCacheEntry();
+        poEntry->osSrcProj4Defn = pszSrcProj4Defn;
+        poEntry->osDstProj4Defn = pszDstProj4Defn;
+        poEntry->bWGS84ToWebMercator = bWGS84ToWebMercator;
+        poEntry->bWebMercatorToWGS84 = bWebMercatorToWGS84;
+        poCTCache->Insert(osKey, poEntry, apoEvicted);
+    }
+    OCTFreeCacheEntries(apoEvicted);
+}
+
+/************************************************************************/
+/*                     OCTReleaseHandlesToCache()                       */
+/*                                                                      */
+/*      Gives the context and handles of a transformation being         */
+/*      destroyed to its cache entry. Returns false if they must be     */
+/*      freed by the caller.                                            */
+/************************************************************************/
+
+static bool OCTReleaseHandlesToCache( const CPLString& osKey,
+                                      const OGRProj4CTHandles& sHandles )
+{
+    CPLMutexHolderD( &hCTCacheMutex );
+    OGRProj4CTCacheEntry **ppoEntry =
+        poCTCache != NULL ? poCTCache->Get(osKey) : NULL;
+    if( ppoEntry == NULL ||
+        (*ppoEntry)->aoIdleHandles.size() >= MAX_IDLE_HANDLES )
+        return false;
+    (*ppoEntry)->aoIdleHandles.push_back(sHandles);
+    return true;
+}
+
+/************************************************************************/
+/*                     OCTAcquireHandlesFromCache()                     */
+/************************************************************************/
+
+static bool OCTAcquireHandlesFromCache( const CPLString& osKey,
+                                        OGRProj4CTHandles *psHandles )
+{
+    CPLMutexHolderD( &hCTCacheMutex );
+    OGRProj4CTCacheEntry **ppoEntry =
+        poCTCache != NULL ? poCTCache->Get(osKey) : NULL;
+    if( ppoEntry == NULL || (*ppoEntry)->aoIdleHandles.empty() )
+        return false;
+    *psHandles = (*ppoEntry)->aoIdleHandles.back();
+    (*ppoEntry)->aoIdleHandles.pop_back();
+    nCTCacheHandleReuses++;
+    return true;
+}
+
+/************************************************************************/
+/*                      OCTCleanupTransformCache()                      */
+/************************************************************************/
+
+void OCTCleanupTransformCache()
+{
+    if( hCTCacheMutex == NULL )
+        return;
+
+    std::vector<OGRProj4CTCacheEntry*> apoEvicted;
+    {
+        CPLMutexHolderD( &hCTCacheMutex );
+        if( poCTCache != NULL )
+        {
+            poCTCache->Clear(apoEvicted);
+            delete poCTCache;
+            poCTCache = NULL;
+        }
+        CPLDebug( "OGRCT",
+                  "Transformation cache: " CPL_FRMT_GUIB " hits "
+                  "(" CPL_FRMT_GUIB " with reused PROJ.4 handles), "
+                  CPL_FRMT_GUIB " misses",
+                  nCTCacheHits, nCTCacheHandleReuses, nCTCacheMisses );
+        nCTCacheHits = 0;
+        nCTCacheHandleReuses = 0;
+        nCTCacheMisses = 0;
+    }
+    OCTFreeCacheEntries(apoEvicted);
+
+    CPLDestroyMutex(hCTCacheMutex);
+    hCTCacheMutex = NULL;
+}
+
 /************************************************************************/
 /*                              OGRProj4CT                              */
 /************************************************************************/
 
+class OGRProj4CT;
+
+// Share of a TransformEx() call processed by one thread.
+struct OGRProj4CTJob
+{
+    OGRProj4CT         *poCT;
+    OGRProj4CTHandles   sHandles;
+    std::vector<double> adfBackup;  // For CHECK_WITH_INVERT_PROJ.
+    int                 nCount;
+    double             *x;
+    double             *y;
+    double             *z;
+    int                 nErr;
+
+    OGRProj4CTJob() : poCT(NULL), nCount(0), x(NULL), y(NULL), z(NULL),
+                      nErr(0)
+    {
+        sHandles.pjctx = NULL;
+        sHandles.psPJSource = NULL;
+        sHandles.psPJTarget = NULL;
+    }
+};
+
 class OGRProj4CT : public OGRCoordinateTransformation
 {
     OGRSpatialReference *poSRSSource;
@@ -136,7 +364,7 @@ class OGRProj4CT : public OGRCoordinateTransformation
     double      dfTargetWrapLong;
 
     int         bIdentityTransform;
-    //int         bWGS84ToWebMercator;
+    int         bWGS84ToWebMercator;
     int         bWebMercatorToWGS84;
 
     int         nErrorCount;
@@ -146,16 +374,24 @@ class OGRProj4CT : public OGRCoordinateTransformation
 
     projCtx     pjctx;
 
+    // PROJ.4 definitions, used to initialize the handles of other threads.
+    CPLString   osSrcProj4Defn;
+    CPLString   osDstProj4Defn;
+
+    // Key in the transformation cache, or empty.
+    CPLString   osCacheKey;
+
+    // The first job runs in the calling thread with the handles above,
+    // the other ones own their context and handles.
+    std::vector<OGRProj4CTJob> asJobs;
+    CPLWorkerThreadPool *poWorkerPool;
+
     int         InitializeNoLock( OGRSpatialReference *poSource,
                                   OGRSpatialReference *poTarget );
 
-    int         nMaxCount;
-    double     *padfOriX;
-    double     *padfOriY;
-    double     *padfOriZ;
-    double     *padfTargetX;
-    double     *padfTargetY;
-    double     *padfTargetZ;
+    int         SetupJobs( int nJobs );
+    int         TransformJob( OGRProj4CTJob *psJob );
+    static void TransformJobFunc( void *pData );
 
 public:
                 OGRProj4CT();
@@ -414,6 +650,10 @@ void OGRCoordinateTransformation::DestroyCT(OGRCoordinateTransformation* poCT)
  *
  * The PROJ.4 library must be available at run-time.
  *
+ * Starting with GDAL 2.2, arrays of 20000 points or more are split among
+ * the threads set by the GDAL_NUM_THREADS configuration option, with PROJ.4
+ * 4.8 or later.
+ *
  * @param poSource source spatial reference system.
  * @param poTarget target spatial reference system.
  * @return NULL on failure or a ready to use transformation object.
@@ -490,10 +730,9 @@ OGRProj4CT::OGRProj4CT() :
     dfSourceToRadians(0.0), bSourceWrap(FALSE), dfSourceWrapLong(0.0),
     poSRSTarget(NULL), psPJTarget(NULL), bTargetLatLong(FALSE),
     dfTargetFromRadians(0.0), bTargetWrap(FALSE), dfTargetWrapLong(0.0),
-    bIdentityTransform(FALSE), bWebMercatorToWGS84(FALSE), nErrorCount(0),
-    bCheckWithInvertProj(FALSE), dfThreshold(0.0), pjctx(NULL), nMaxCount(0),
-    padfOriX(NULL), padfOriY(NULL), padfOriZ(NULL), padfTargetX(NULL),
-    padfTargetY(NULL), padfTargetZ(NULL)
+    bIdentityTransform(FALSE), bWGS84ToWebMercator(FALSE),
+    bWebMercatorToWGS84(FALSE), nErrorCount(0), bCheckWithInvertProj(FALSE),
+    dfThreshold(0.0), pjctx(NULL), poWorkerPool(NULL)
 {
     if (pfn_pj_ctx_alloc != NULL)
         pjctx = pfn_pj_ctx_alloc();
@@ -518,6 +757,18 @@ OGRProj4CT::~OGRProj4CT()
             delete poSRSTarget;
     }
 
+    if( pjctx != NULL && psPJSource != NULL && psPJTarget != NULL &&
+        !osCacheKey.empty() )
+    {
+        OGRProj4CTHandles sHandles = { pjctx, psPJSource, psPJTarget };
+        if( OCTReleaseHandlesToCache(osCacheKey, sHandles) )
+        {
+            pjctx = NULL;
+            psPJSource = NULL;
+            psPJTarget = NULL;
+        }
+    }
+
     if (pjctx != NULL)
     {
         pfn_pj_ctx_free(pjctx);
@@ -528,7 +779,7 @@ OGRProj4CT::~OGRProj4CT()
         if( psPJTarget != NULL )
             pfn_pj_free( psPJTarget );
     }
-    else
+    else if( psPJSource != NULL || psPJTarget != NULL )
     {
         CPLMutexHolderD( &hPROJMutex );
 
@@ -539,12 +790,19 @@ OGRProj4CT::~OGRProj4CT()
             pfn_pj_free( psPJTarget );
     }
 
-    CPLFree(padfOriX);
-    CPLFree(padfOriY);
-    CPLFree(padfOriZ);
-    CPLFree(padfTargetX);
-    CPLFree(padfTargetY);
-    CPLFree(padfTargetZ);
+    delete poWorkerPool;
+
+    for( size_t i = 1; i < asJobs.size(); i++ )
+    {
+        const OGRProj4CTHandles& sHandles = asJobs[i].sHandles;
+        if( sHandles.pjctx == NULL ||
+            (!osCacheKey.empty() &&
+             OCTReleaseHandlesToCache(osCacheKey, sHandles)) )
+            continue;
+        pfn_pj_free( sHandles.psPJSource );
+        pfn_pj_free( sHandles.psPJTarget );
+        pfn_pj_ctx_free( sHandles.pjctx );
+    }
 }
 
 /************************************************************************/
@@ -570,6 +828,139 @@ int OGRProj4CT::Initialize( OGRSpatialReference * poSourceIn,
     return InitializeNoLock(poSourceIn, poTargetIn);
 }
 
+/************************************************************************/
+/*                       OCTExportToProj4Defns()                        */
+/*                                                                      */
+/*      Export the source and target SRS to the PROJ.4 definitions      */
+/*      that will be passed to pj_init_plus().                          */
+/************************************************************************/
+
+static bool OCTExportToProj4Defns( OGRSpatialReference *poSource,
+                                   OGRSpatialReference *poTarget,
+                                   char **ppszSrcProj4Defn,
+                                   char **ppszDstProj4Defn,
+                                   int *pbWGS84ToWebMercator,
+                                   int *pbWebMercatorToWGS84 )
+{
+    char        *pszSrcProj4Defn = NULL;
+    *pbWGS84ToWebMercator = FALSE;
+    *pbWebMercatorToWGS84 = FALSE;
+
+    if( poSource->exportToProj4( &pszSrcProj4Defn ) != OGRERR_NONE )
+    {
+        CPLFree( pszSrcProj4Defn );
+        return false;
+    }
+
+    if( strlen(pszSrcProj4Defn) == 0 )
+    {
+        CPLFree( pszSrcProj4Defn );
+        CPLError( CE_Failure, CPLE_AppDefined,
+                  "No PROJ.4 translation for source SRS, coordinate\n"
+                  "transformation initialization has failed." );
+        return false;
+    }
+
+    char        *pszDstProj4Defn = NULL;
+
+    if( poTarget->exportToProj4( &pszDstProj4Defn ) != OGRERR_NONE )
+    {
+        CPLFree( pszSrcProj4Defn );
+        CPLFree( pszDstProj4Defn );
+        return false;
+    }
+
+    if( strlen(pszDstProj4Defn) == 0 )
+    {
+        CPLFree( pszSrcProj4Defn );
+        CPLFree( pszDstProj4Defn );
+        CPLError( CE_Failure, CPLE_AppDefined,
+                  "No PROJ.4 translation for destination SRS, coordinate\n"
+                  "transformation initialization has failed." );
+        return false;
+    }
+
+/* -------------------------------------------------------------------- */
+/*      Optimization to avoid useless nadgrids evaluation.              */
+/*      For example when converting between WGS84 and WebMercator       */
+/* -------------------------------------------------------------------- */
+    if( pszSrcProj4Defn[strlen(pszSrcProj4Defn)-1] == ' ' )
+        pszSrcProj4Defn[strlen(pszSrcProj4Defn)-1] = 0;
+    if( pszDstProj4Defn[strlen(pszDstProj4Defn)-1] == ' ' )
+        pszDstProj4Defn[strlen(pszDstProj4Defn)-1] = 0;
+    char* pszNeedle = strstr(pszSrcProj4Defn, "  ");
+    if( pszNeedle )
+        memmove(pszNeedle, pszNeedle + 1, strlen(pszNeedle + 1)+1);
+    pszNeedle = strstr(pszDstProj4Defn, "  ");
+    if( pszNeedle )
+        memmove(pszNeedle, pszNeedle + 1, strlen(pszNeedle + 1)+1);
+
+    if( (strstr(pszSrcProj4Defn, "+datum=WGS84") != NULL ||
+         strstr(pszSrcProj4Defn, "+ellps=WGS84 +towgs84=0,0,0,0,0,0,0 ") != NULL) &&
+        strstr(pszDstProj4Defn, "+nadgrids=@null ") != NULL &&
+        strstr(pszDstProj4Defn, "+towgs84") == NULL )
+    {
+        char* pszDst = strstr(pszSrcProj4Defn, "+towgs84=0,0,0,0,0,0,0 ");
+        char* pszSrc;
+        if( pszDst != NULL )
+        {
+            pszSrc = pszDst + strlen("+towgs84=0,0,0,0,0,0,0 ");
+            memmove(pszDst, pszSrc, strlen(pszSrc)+1);
+        }
+        else
+            memcpy(strstr(pszSrcProj4Defn, "+datum=WGS84"), "+ellps", 6);
+
+        pszDst = strstr(pszDstProj4Defn, "+nadgrids=@null ");
+        pszSrc = pszDst + strlen("+nadgrids=@null ");
+        memmove(pszDst, pszSrc, strlen(pszSrc)+1);
+
+        pszDst = strstr(pszDstProj4Defn, "+wktext ");
+        if( pszDst )
+        {
+            pszSrc = pszDst + strlen("+wktext ");
+            memmove(pszDst, pszSrc, strlen(pszSrc)+1);
+        }
+
+        *pbWGS84ToWebMercator =
+            strcmp(pszSrcProj4Defn, "+proj=longlat +ellps=WGS84 +no_defs") == 0 &&
+            strcmp(pszDstProj4Defn, "+proj=merc +a=6378137 +b=6378137 +lat_ts=0.0 +lon_0=0.0 +x_0=0.0 +y_0=0 +k=1.0 +units=m +no_defs") == 0;
+    }
+    else
+    if( (strstr(pszDstProj4Defn, "+datum=WGS84") != NULL ||
+         strstr(pszDstProj4Defn, "+ellps=WGS84 +towgs84=0,0,0,0,0,0,0 ") != NULL) &&
+        strstr(pszSrcProj4Defn, "+nadgrids=@null ") != NULL &&
+        strstr(pszSrcProj4Defn, "+towgs84") == NULL )
+    {
+        char* pszDst = strstr(pszDstProj4Defn, "+towgs84=0,0,0,0,0,0,0 ");
+        char* pszSrc;
+        if( pszDst != NULL)
+        {
+            pszSrc = pszDst + strlen("+towgs84=0,0,0,0,0,0,0 ");
+            memmove(pszDst, pszSrc, strlen(pszSrc)+1);
+        }
+        else
+            memcpy(strstr(pszDstProj4Defn, "+datum=WGS84"), "+ellps", 6);
+
+        pszDst = strstr(pszSrcProj4Defn, "+nadgrids=@null ");
+        pszSrc = pszDst + strlen("+nadgrids=@null ");
+        memmove(pszDst, pszSrc, strlen(pszSrc)+1);
+
+        pszDst = strstr(pszSrcProj4Defn, "+wktext ");
+        if( pszDst )
+        {
+            pszSrc = pszDst + strlen("+wktext ");
+            memmove(pszDst, pszSrc, strlen(pszSrc)+1);
+        }
+        *pbWebMercatorToWGS84 =
+            strcmp(pszDstProj4Defn, "+proj=longlat +ellps=WGS84 +no_defs") == 0 &&
+            strcmp(pszSrcProj4Defn, "+proj=merc +a=6378137 +b=6378137 +lat_ts=0.0 +lon_0=0.0 +x_0=0.0 +y_0=0 +k=1.0 +units=m +no_defs") == 0;
+    }
+
+    *ppszSrcProj4Defn = pszSrcProj4Defn;
+    *ppszDstProj4Defn = pszDstProj4Defn;
+    return true;
+}
+
 /************************************************************************/
 /*                         InitializeNoLock()                           */
 /************************************************************************/
@@ -666,121 +1057,72 @@ int OGRProj4CT::InitializeNoLock( OGRSpatialReference * poSourceIn,
     static int   nDebugReportCount = 0;
 
     char        *pszSrcProj4Defn = NULL;
-
-    if( poSRSSource->exportToProj4( &pszSrcProj4Defn ) != OGRERR_NONE )
-    {
-        CPLFree( pszSrcProj4Defn );
-        return FALSE;
-    }
-
-    if( strlen(pszSrcProj4Defn) == 0 )
-    {
-        CPLFree( pszSrcProj4Defn );
-        CPLError( CE_Failure, CPLE_AppDefined,
-                  "No PROJ.4 translation for source SRS, coordinate\n"
-                  "transformation initialization has failed." );
-        return FALSE;
-    }
-
     char        *pszDstProj4Defn = NULL;
 
-    if( poSRSTarget->exportToProj4( &pszDstProj4Defn ) != OGRERR_NONE )
-    {
-        CPLFree( pszSrcProj4Defn );
-        CPLFree( pszDstProj4Defn );
-        return FALSE;
-    }
-
-    if( strlen(pszDstProj4Defn) == 0 )
-    {
-        CPLFree( pszSrcProj4Defn );
-        CPLFree( pszDstProj4Defn );
-        CPLError( CE_Failure, CPLE_AppDefined,
-                  "No PROJ.4 translation for destination SRS, coordinate\n"
-                  "transformation initialization has failed." );
-        return FALSE;
-    }
-
 /* -------------------------------------------------------------------- */
-/*      Optimization to avoid useless nadgrids evaluation.              */
-/*      For example when converting between WGS84 and WebMercator       */
+/*      Look for an identical transformation in the cache. This saves   */
+/*      the PROJ.4 export, and the PROJ.4 initialization too when idle  */
+/*      handles of a destroyed transformation are available.            */
 /* -------------------------------------------------------------------- */
-    if( pszSrcProj4Defn[strlen(pszSrcProj4Defn)-1] == ' ' )
-        pszSrcProj4Defn[strlen(pszSrcProj4Defn)-1] = 0;
-    if( pszDstProj4Defn[strlen(pszDstProj4Defn)-1] == ' ' )
-        pszDstProj4Defn[strlen(pszDstProj4Defn)-1] = 0;
-    char* pszNeedle = strstr(pszSrcProj4Defn, "  ");
-    if( pszNeedle )
-        memmove(pszNeedle, pszNeedle + 1, strlen(pszNeedle + 1)+1);
-    pszNeedle = strstr(pszDstProj4Defn, "  ");
-    if( pszNeedle )
-        memmove(pszNeedle, pszNeedle + 1, strlen(pszNeedle + 1)+1);
-
-    if( (strstr(pszSrcProj4Defn, "+datum=WGS84") != NULL ||
-         strstr(pszSrcProj4Defn, "+ellps=WGS84 +towgs84=0,0,0,0,0,0,0 ") != NULL) &&
-        strstr(pszDstProj4Defn, "+nadgrids=@null ") != NULL &&
-        strstr(pszDstProj4Defn, "+towgs84") == NULL )
+    const CPLString osKey(OCTGetCacheKey(poSRSSource, poSRSTarget));
+    if( !osKey.empty() )
     {
-        char* pszDst = strstr(pszSrcProj4Defn, "+towgs84=0,0,0,0,0,0,0 ");
-        char* pszSrc;
-        if( pszDst != NULL )
+        OGRProj4CTHandles sHandles = { NULL, NULL, NULL };
         {
-            pszSrc = pszDst + strlen("+towgs84=0,0,0,0,0,0,0 ");
-            memmove(pszDst, pszSrc, strlen(pszSrc)+1);
+            CPLMutexHolderD( &hCTCacheMutex );
+            OGRProj4CTCacheEntry **ppoEntry =
+                poCTCache != NULL ? poCTCache->Get(osKey) : NULL;
+            if( ppoEntry != NULL )
+            {
+                OGRProj4CTCacheEntry *poEntry = *ppoEntry;
+                nCTCacheHits++;
+                pszSrcProj4Defn = CPLStrdup(poEntry->osSrcProj4Defn);
+                pszDstProj4Defn = CPLStrdup(poEntry->osDstProj4Defn);
+                bWGS84ToWebMercator = poEntry->bWGS84ToWebMercator;
+                bWebMercatorToWGS84 = poEntry->bWebMercatorToWGS84;
+                if( pjctx != NULL && !poEntry->aoIdleHandles.empty() )
+                {
+                    sHandles = poEntry->aoIdleHandles.back();
+                    poEntry->aoIdleHandles.pop_back();
+                    nCTCacheHandleReuses++;
+                }
+            }
+            else
+            {
+                nCTCacheMisses++;
+            }
         }
-        else
-            memcpy(strstr(pszSrcProj4Defn, "+datum=WGS84"), "+ellps", 6);
 
-        pszDst = strstr(pszDstProj4Defn, "+nadgrids=@null ");
-        pszSrc = pszDst + strlen("+nadgrids=@null ");
-        memmove(pszDst, pszSrc, strlen(pszSrc)+1);
-
-        pszDst = strstr(pszDstProj4Defn, "+wktext ");
-        if( pszDst )
+        if( sHandles.pjctx != NULL )
         {
-            pszSrc = pszDst + strlen("+wktext ");
-            memmove(pszDst, pszSrc, strlen(pszSrc)+1);
+            pfn_pj_ctx_free(pjctx);
+            pjctx = sHandles.pjctx;
+            psPJSource = sHandles.psPJSource;
+            psPJTarget = sHandles.psPJTarget;
+            bIdentityTransform =
+                strcmp(pszSrcProj4Defn, pszDstProj4Defn) == 0;
+            osSrcProj4Defn = pszSrcProj4Defn;
+            osDstProj4Defn = pszDstProj4Defn;
+            osCacheKey = osKey;
+            CPLFree( pszSrcProj4Defn );
+            CPLFree( pszDstProj4Defn );
+            return TRUE;
         }
-
-        //bWGS84ToWebMercator =
-        //    strcmp(pszSrcProj4Defn, "+proj=longlat +ellps=WGS84 +no_defs") == 0 &&
-        //    strcmp(pszDstProj4Defn, "+proj=merc +a=6378137 +b=6378137 +lat_ts=0.0 +lon_0=0.0 +x_0=0.0 +y_0=0 +k=1.0 +units=m +no_defs") == 0;
     }
-    else
-    if( (strstr(pszDstProj4Defn, "+datum=WGS84") != NULL ||
-         strstr(pszDstProj4Defn, "+ellps=WGS84 +towgs84=0,0,0,0,0,0,0 ") != NULL) &&
-        strstr(pszSrcProj4Defn, "+nadgrids=@null ") != NULL &&
-        strstr(pszSrcProj4Defn, "+towgs84") == NULL )
-    {
-        char* pszDst = strstr(pszDstProj4Defn, "+towgs84=0,0,0,0,0,0,0 ");
-        char* pszSrc;
-        if( pszDst != NULL)
-        {
-            pszSrc = pszDst + strlen("+towgs84=0,0,0,0,0,0,0 ");
-            memmove(pszDst, pszSrc, strlen(pszSrc)+1);
-        }
-        else
-            memcpy(strstr(pszDstProj4Defn, "+datum=WGS84"), "+ellps", 6);
-
-        pszDst = strstr(pszSrcProj4Defn, "+nadgrids=@null ");
-        pszSrc = pszDst + strlen("+nadgrids=@null ");
-        memmove(pszDst, pszSrc, strlen(pszSrc)+1);
 
-        pszDst = strstr(pszSrcProj4Defn, "+wktext ");
-        if( pszDst )
-        {
-            pszSrc = pszDst + strlen("+wktext ");
-            memmove(pszDst, pszSrc, strlen(pszSrc)+1);
-        }
-        bWebMercatorToWGS84 =
-            strcmp(pszDstProj4Defn, "+proj=longlat +ellps=WGS84 +no_defs") == 0 &&
-            strcmp(pszSrcProj4Defn, "+proj=merc +a=6378137 +b=6378137 +lat_ts=0.0 +lon_0=0.0 +x_0=0.0 +y_0=0 +k=1.0 +units=m +no_defs") == 0;
+    if( pszSrcProj4Defn == NULL &&
+        !OCTExportToProj4Defns( poSRSSource, poSRSTarget,
+                                &pszSrcProj4Defn, &pszDstProj4Defn,
+                                &bWGS84ToWebMercator,
+                                &bWebMercatorToWGS84 ) )
+    {
+        return FALSE;
     }
 
 /* -------------------------------------------------------------------- */
 /*      Establish PROJ.4 handle for source if projection.               */
 /* -------------------------------------------------------------------- */
-    if( !bWebMercatorToWGS84 )
+    if( !bWGS84ToWebMercator && !bWebMercatorToWGS84 )
     {
         if (pjctx)
             psPJSource = pfn_pj_init_plus_ctx( pjctx, pszSrcProj4Defn );
@@ -820,7 +1162,7 @@ int OGRProj4CT::InitializeNoLock( OGRSpatialReference * poSourceIn,
     if( nDebugReportCount < 10 )
         CPLDebug( "OGRCT", "Source: %s", pszSrcProj4Defn );
 
-    if( !bWebMercatorToWGS84 && psPJSource == NULL )
+    if( !bWGS84ToWebMercator && !bWebMercatorToWGS84 && psPJSource == NULL )
     {
         CPLFree( pszSrcProj4Defn );
         CPLFree( pszDstProj4Defn );
@@ -830,7 +1172,7 @@ int OGRProj4CT::InitializeNoLock( OGRSpatialReference * poSourceIn,
 /* -------------------------------------------------------------------- */
 /*      Establish PROJ.4 handle for target if projection.               */
 /* -------------------------------------------------------------------- */
-    if( !bWebMercatorToWGS84 )
+    if( !bWGS84ToWebMercator && !bWebMercatorToWGS84 )
     {
         if (pjctx)
             psPJTarget = pfn_pj_init_plus_ctx( pjctx, pszDstProj4Defn );
@@ -848,7 +1190,7 @@ int OGRProj4CT::InitializeNoLock( OGRSpatialReference * poSourceIn,
         nDebugReportCount++;
     }
 
-    if( !bWebMercatorToWGS84 && psPJTarget == NULL )
+    if( !bWGS84ToWebMercator && !bWebMercatorToWGS84 && psPJTarget == NULL )
     {
         CPLFree( pszSrcProj4Defn );
         CPLFree( pszDstProj4Defn );
@@ -870,6 +1212,16 @@ int OGRProj4CT::InitializeNoLock( OGRSpatialReference * poSourceIn,
     }
 #endif
 
+    osSrcProj4Defn = pszSrcProj4Defn;
+    osDstProj4Defn = pszDstProj4Defn;
+
+    if( !osKey.empty() )
+    {
+        OCTInsertInCache( osKey, pszSrcProj4Defn, pszDstProj4Defn,
+                          bWGS84ToWebMercator, bWebMercatorToWGS84 );
+        osCacheKey = osKey;
+    }
+
     CPLFree( pszSrcProj4Defn );
     CPLFree( pszDstProj4Defn );
 
@@ -939,13 +1291,186 @@ int CPL_STDCALL OCTTransform( OGRCoordinateTransformationH hTransform,
 }
 
 /************************************************************************/
-/*                            TransformEx()                             */
+/*                         OCTScaleCoordinates()                        */
+/*                                                                      */
+/*      Multiply x[i] and y[i] by dfFactor for the points whose x (and  */
+/*      y if bCheckY) is not HUGE_VAL, two points at a time.            */
 /************************************************************************/
 
-int OGRProj4CT::TransformEx( int nCount, double *x, double *y, double *z,
-                             int *pabSuccess )
+static void OCTScaleCoordinates( int nCount, double *x, double *y,
+                                 double dfFactor, bool bCheckY )
+{
+    const double dfHugeVal = HUGE_VAL;
+    const XMMReg2Double oFactor = XMMReg2Double::Load1ValHighAndLow(&dfFactor);
+    const XMMReg2Double oHugeVal =
+        XMMReg2Double::Load1ValHighAndLow(&dfHugeVal);
 
+    int i = 0;
+    for( ; i + 1 < nCount; i += 2 )
+    {
+        const XMMReg2Double oX = XMMReg2Double::Load2Val(x + i);
+        const XMMReg2Double oY = XMMReg2Double::Load2Val(y + i);
+        XMMReg2Double oValid = XMMReg2Double::NotEquals(oX, oHugeVal);
+        if( bCheckY )
+            oValid = XMMReg2Double::And(
+                oValid, XMMReg2Double::NotEquals(oY, oHugeVal));
+        XMMReg2Double::Ternary(oValid, oX * oFactor, oX).Store2Double(x + i);
+        XMMReg2Double::Ternary(oValid, oY * oFactor, oY).Store2Double(y + i);
+    }
+    for( ; i < nCount; i++ )
+    {
+        if( x[i] != HUGE_VAL && (!bCheckY || y[i] != HUGE_VAL) )
+        {
+            x[i] *= dfFactor;
+            y[i] *= dfFactor;
+        }
+    }
+}
+
+/************************************************************************/
+/*                          OCTGetNumThreads()                          */
+/************************************************************************/
+
+// Arrays are not split in chunks of less than this number of points.
+static const int MIN_POINTS_PER_JOB = 10000;
+
+static int OCTGetNumThreads()
 {
+    const char *pszNumThreads = CPLGetConfigOption("GDAL_NUM_THREADS", "1");
+    int nThreads;
+    if( EQUAL(pszNumThreads, "ALL_CPUS") )
+        nThreads = CPLGetNumCPUs();
+    else
+        nThreads = atoi(pszNumThreads);
+    return std::max(1, std::min(128, nThreads));
+}
+
+/************************************************************************/
+/*                          OCTInitHandles()                            */
+/************************************************************************/
+
+static bool OCTInitHandlesInternal( const char *pszSrcProj4Defn,
+                                    const char *pszDstProj4Defn,
+                                    OGRProj4CTHandles *psHandles )
+{
+    psHandles->pjctx = pfn_pj_ctx_alloc();
+    if( psHandles->pjctx == NULL )
+        return false;
+    psHandles->psPJSource =
+        pfn_pj_init_plus_ctx( psHandles->pjctx, pszSrcProj4Defn );
+    psHandles->psPJTarget =
+        pfn_pj_init_plus_ctx( psHandles->pjctx, pszDstProj4Defn );
+    if( psHandles->psPJSource == NULL || psHandles->psPJTarget == NULL )
+    {
+        if( psHandles->psPJSource != NULL )
+            pfn_pj_free( psHandles->psPJSource );
+        if( psHandles->psPJTarget != NULL )
+            pfn_pj_free( psHandles->psPJTarget );
+        pfn_pj_ctx_free( psHandles->pjctx );
+        psHandles->pjctx = NULL;
+        psHandles->psPJSource = NULL;
+        psHandles->psPJTarget = NULL;
+        return false;
+    }
+    return true;
+}
+
+static bool OCTInitHandles( const char *pszSrcProj4Defn,
+                            const char *pszDstProj4Defn,
+                            OGRProj4CTHandles *psHandles )
+{
+    if( bProjLocaleSafe )
+        return OCTInitHandlesInternal( pszSrcProj4Defn, pszDstProj4Defn,
+                                       psHandles );
+
+    CPLLocaleC  oLocaleEnforcer;
+    return OCTInitHandlesInternal( pszSrcProj4Defn, pszDstProj4Defn,
+                                   psHandles );
+}
+
+/************************************************************************/
+/*                             SetupJobs()                              */
+/*                                                                      */
+/*      Prepare up to nJobs jobs, and return the number of jobs that    */
+/*      can actually be run.                                            */
+/************************************************************************/
+
+int OGRProj4CT::SetupJobs( int nJobs )
+{
+    if( asJobs.empty() )
+    {
+        asJobs.resize(1);
+        asJobs[0].poCT = this;
+    }
+    asJobs[0].sHandles.pjctx = pjctx;
+    asJobs[0].sHandles.psPJSource = psPJSource;
+    asJobs[0].sHandles.psPJTarget = psPJTarget;
+
+    if( nJobs <= 1 )
+        return 1;
+
+    // Without PROJ contexts, pj_transform() calls are serialized anyway.
+    const bool bNeedHandles = !bWGS84ToWebMercator && !bWebMercatorToWGS84;
+    if( bNeedHandles && pjctx == NULL )
+        return 1;
+
+    if( poWorkerPool == NULL )
+    {
+        poWorkerPool = new CPLWorkerThreadPool();
+        if( !poWorkerPool->Setup(nJobs - 1, NULL, NULL) )
+        {
+            delete poWorkerPool;
+            poWorkerPool = NULL;
+            return 1;
+        }
+    }
+    nJobs = std::min(nJobs, poWorkerPool->GetThreadCount() + 1);
+
+    for( int i = 1; i < nJobs; i++ )
+    {
+        if( static_cast<size_t>(i) == asJobs.size() )
+        {
+            asJobs.push_back(OGRProj4CTJob());
+            asJobs.back().poCT = this;
+        }
+        OGRProj4CTHandles *psHandles = &(asJobs[i].sHandles);
+        if( bNeedHandles && psHandles->pjctx == NULL &&
+            (osCacheKey.empty() ||
+             !OCTAcquireHandlesFromCache(osCacheKey, psHandles)) &&
+            !OCTInitHandles(osSrcProj4Defn, osDstProj4Defn, psHandles) )
+        {
+            return i;
+        }
+    }
+    return nJobs;
+}
+
+/************************************************************************/
+/*                          TransformJobFunc()                          */
+/************************************************************************/
+
+void OGRProj4CT::TransformJobFunc( void *pData )
+{
+    OGRProj4CTJob *psJob = static_cast<OGRProj4CTJob *>(pData);
+    psJob->nErr = psJob->poCT->TransformJob(psJob);
+}
+
+/************************************************************************/
+/*                            TransformJob()                            */
+/*                                                                      */
+/*      Transform the points of a job, and return the PROJ.4 error      */
+/*      code.                                                           */
+/************************************************************************/
+
+int OGRProj4CT::TransformJob( OGRProj4CTJob *psJob )
+
+{
+    const int nCount = psJob->nCount;
+    double *x = psJob->x;
+    double *y = psJob->y;
+    double *z = psJob->z;
+    projPJ hPJSource = psJob->sHandles.psPJSource;
+    projPJ hPJTarget = psJob->sHandles.psPJTarget;
     int   err, i;
 
 /* -------------------------------------------------------------------- */
@@ -967,24 +1492,17 @@ int OGRProj4CT::TransformEx( int nCount, double *x, double *y, double *z,
             }
         }
 
-        for( i = 0; i < nCount; i++ )
-        {
-            if( x[i] != HUGE_VAL )
-            {
-                x[i] *= dfSourceToRadians;
-                y[i] *= dfSourceToRadians;
-            }
-        }
+        OCTScaleCoordinates( nCount, x, y, dfSourceToRadians, false );
     }
 
 /* -------------------------------------------------------------------- */
 /*      Optimized transform from WebMercator to WGS84                   */
 /* -------------------------------------------------------------------- */
     bool bTransformDone = false;
+#define SPHERE_RADIUS          6378137.
+#define REVERSE_SPHERE_RADIUS  (1. / 6378137.)
     if( bWebMercatorToWGS84 )
     {
-#define REVERSE_SPHERE_RADIUS  (1. / 6378137.)
-
         double y0 = y[0];
         for( i = 0; i < nCount; i++ )
         {
@@ -1035,13 +1553,62 @@ int OGRProj4CT::TransformEx( int nCount, double *x, double *y, double *z,
 
         bTransformDone = true;
     }
+
+/* -------------------------------------------------------------------- */
+/*      Optimized transform from WGS84 to WebMercator. This follows     */
+/*      what pj_fwd() does for the spherical Mercator, including the    */
+/*      rejection of points out of range.                               */
+/* -------------------------------------------------------------------- */
+    else if( bWGS84ToWebMercator )
+    {
+        double dfLastLat = HUGE_VAL;
+        double dfLastY = HUGE_VAL;
+        for( i = 0; i < nCount; i++ )
+        {
+            if( x[i] == HUGE_VAL )
+                continue;
+            if( fabs(y[i]) - M_PI / 2 > 1e-12 || fabs(x[i]) > 10.0 ||
+                fabs(fabs(y[i]) - M_PI / 2) <= 1e-10 )
+            {
+                x[i] = y[i] = HUGE_VAL;
+                continue;
+            }
+
+            double dfLong = x[i];
+            if( fabs(dfLong) > 3.14159265359 )
+            {
+                dfLong += M_PI;
+                dfLong -= 2 * M_PI * floor(dfLong / (2 * M_PI));
+                dfLong -= M_PI;
+                if( bCheckWithInvertProj &&
+                    fabs(dfLong - x[i]) > dfThreshold )
+                {
+                    x[i] = y[i] = HUGE_VAL;
+                    continue;
+                }
+            }
+            x[i] = SPHERE_RADIUS * dfLong;
+
+            // Optimization for the case where we are provided a whole
+            // line of same latitude.
+            if( y[i] != dfLastLat )
+            {
+                dfLastLat = y[i];
+                dfLastY = SPHERE_RADIUS * log(tan(M_PI / 4 + 0.5 * y[i]));
+            }
+            y[i] = dfLastY;
+        }
+
+        bTransformDone = true;
+    }
     else if( bIdentityTransform )
         bTransformDone = true;
 
 /* -------------------------------------------------------------------- */
 /*      Do the transformation (or not...) using PROJ.4.                 */
 /* -------------------------------------------------------------------- */
-    if( !bTransformDone && pjctx == NULL )
+    const bool bNeedsMutex = !bTransformDone && psJob->sHandles.pjctx == NULL;
+    if( bNeedsMutex )
     {
         /* The mutex has already been created */
         CPLAssert(hPROJMutex != NULL);
@@ -1055,23 +1622,22 @@ int OGRProj4CT::TransformEx( int nCount, double *x, double *y, double *z,
         /* For some projections, we cannot detect if we are trying to reproject */
         /* coordinates outside the validity area of the projection. So let's do */
         /* the reverse reprojection and compare with the source coordinates */
-        if (nCount > nMaxCount)
-        {
-            nMaxCount = nCount;
-            padfOriX = (double*) CPLRealloc(padfOriX, sizeof(double)*nCount);
-            padfOriY = (double*) CPLRealloc(padfOriY, sizeof(double)*nCount);
-            padfOriZ = (double*) CPLRealloc(padfOriZ, sizeof(double)*nCount);
-            padfTargetX = (double*) CPLRealloc(padfTargetX, sizeof(double)*nCount);
-            padfTargetY = (double*) CPLRealloc(padfTargetY, sizeof(double)*nCount);
-            padfTargetZ = (double*) CPLRealloc(padfTargetZ, sizeof(double)*nCount);
-        }
+        if( psJob->adfBackup.size() < static_cast<size_t>(nCount) * 6 )
+            psJob->adfBackup.resize(static_cast<size_t>(nCount) * 6);
+        double *padfOriX = &psJob->adfBackup[0];
+        double *padfOriY = padfOriX + nCount;
+        double *padfOriZ = padfOriY + nCount;
+        double *padfTargetX = padfOriZ + nCount;
+        double *padfTargetY = padfTargetX + nCount;
+        double *padfTargetZ = padfTargetY + nCount;
+
         memcpy(padfOriX, x, sizeof(double)*nCount);
         memcpy(padfOriY, y, sizeof(double)*nCount);
         if (z)
         {
             memcpy(padfOriZ, z, sizeof(double)*nCount);
         }
-        err = pfn_pj_transform( psPJSource, psPJTarget, nCount, 1, x, y, z );
+        err = pfn_pj_transform( hPJSource, hPJTarget, nCount, 1, x, y, z );
         if (err == 0)
         {
             memcpy(padfTargetX, x, sizeof(double)*nCount);
@@ -1081,7 +1647,7 @@ int OGRProj4CT::TransformEx( int nCount, double *x, double *y, double *z,
                 memcpy(padfTargetZ, z, sizeof(double)*nCount);
             }
 
-            err = pfn_pj_transform( psPJTarget, psPJSource , nCount, 1,
+            err = pfn_pj_transform( hPJTarget, hPJSource , nCount, 1,
                                     padfTargetX, padfTargetY, (z) ? padfTargetZ : NULL);
             if (err == 0)
             {
@@ -1100,8 +1666,79 @@ int OGRProj4CT::TransformEx( int nCount, double *x, double *y, double *z,
     }
     else
     {
-        err = pfn_pj_transform( psPJSource, psPJTarget, nCount, 1, x, y, z );
+        err = pfn_pj_transform( hPJSource, hPJTarget, nCount, 1, x, y, z );
+    }
+
+    if( bNeedsMutex )
+        CPLReleaseMutex(hPROJMutex);
+
+    if( err != 0 )
+        return err;
+
+/* -------------------------------------------------------------------- */
+/*      Potentially transform back to degrees.                          */
+/* -------------------------------------------------------------------- */
+    if( bTargetLatLong )
+    {
+        OCTScaleCoordinates( nCount, x, y, dfTargetFromRadians, true );
+
+        if( bTargetWrap )
+        {
+            for( i = 0; i < nCount; i++ )
+            {
+                if( x[i] != HUGE_VAL && y[i] != HUGE_VAL )
+                {
+                    if( x[i] < dfTargetWrapLong - 180.0 )
+                        x[i] += 360.0;
+                    else if( x[i] > dfTargetWrapLong + 180 )
+                        x[i] -= 360.0;
+                }
+            }
+        }
+    }
+
+    return 0;
+}
+
+/************************************************************************/
+/*                            TransformEx()                             */
+/************************************************************************/
+
+int OGRProj4CT::TransformEx( int nCount, double *x, double *y, double *z,
+                             int *pabSuccess )
+
+{
+/* -------------------------------------------------------------------- */
+/*      Large arrays are split between GDAL_NUM_THREADS threads, each   */
+/*      one with its own PROJ.4 context and handles.                    */
+/* -------------------------------------------------------------------- */
+    int nJobs = 1;
+    if( !bIdentityTransform && nCount >= 2 * MIN_POINTS_PER_JOB )
+        nJobs = std::min(OCTGetNumThreads(), nCount / MIN_POINTS_PER_JOB);
+    nJobs = SetupJobs( nJobs );
+
+    for( int iJob = 0; iJob < nJobs; iJob++ )
+    {
+        const int nStart = static_cast<int>(
+            static_cast<GIntBig>(nCount) * iJob / nJobs);
+        const int nEnd = static_cast<int>(
+            static_cast<GIntBig>(nCount) * (iJob + 1) / nJobs);
+        OGRProj4CTJob *psJob = &asJobs[iJob];
+        psJob->nCount = nEnd - nStart;
+        psJob->x = x + nStart;
+        psJob->y = y + nStart;
+        psJob->z = z ? z + nStart : NULL;
+        psJob->nErr = 0;
+        if( iJob > 0 )
+            poWorkerPool->SubmitJob( TransformJobFunc, psJob );
     }
+    TransformJobFunc( &asJobs[0] );
+    if( nJobs > 1 )
+        poWorkerPool->WaitCompletion();
+
+    int err = 0;
+    for( int iJob = 0; iJob < nJobs && err == 0; iJob++ )
+        err = asJobs[iJob].nErr;
 
 /* -------------------------------------------------------------------- */
 /*      Try to report an error through CPL.  Get proj.4 error string    */
@@ -1116,9 +1753,8 @@ int OGRProj4CT::TransformEx( int nCount, double *x, double *y, double *z,
 
         if( ++nErrorCount < 20 )
         {
-            if (pjctx != NULL)
-                /* pfn_pj_strerrno not yet thread-safe in PROJ 4.8.0 */
-                CPLAcquireMutex(hPROJMutex, 1000.0);
+            /* pfn_pj_strerrno not yet thread-safe in PROJ 4.8.0 */
+            CPLMutexHolderD( &hPROJMutex );
 
             const char *pszError = NULL;
             if( pfn_pj_strerrno != NULL )
@@ -1130,10 +1766,6 @@ int OGRProj4CT::TransformEx( int nCount, double *x, double *y, double *z,
                           err );
             else
                 CPLError( CE_Failure, CPLE_AppDefined, "%s", pszError );
-
-            if (pjctx != NULL)
-                /* pfn_pj_strerrno not yet thread-safe in PROJ 4.8.0 */
-                CPLReleaseMutex(hPROJMutex);
         }
         else if( nErrorCount == 20 )
         {
@@ -1142,49 +1774,15 @@ int OGRProj4CT::TransformEx( int nCount, double *x, double *y, double *z,
                       err );
         }
 
-        if (pjctx == NULL)
-            CPLReleaseMutex(hPROJMutex);
         return FALSE;
     }
 
-    if( !bTransformDone && pjctx == NULL )
-        CPLReleaseMutex(hPROJMutex);
-
-/* -------------------------------------------------------------------- */
-/*      Potentially transform back to degrees.                          */
-/* -------------------------------------------------------------------- */
-    if( bTargetLatLong )
-    {
-        for( i = 0; i < nCount; i++ )
-        {
-            if( x[i] != HUGE_VAL && y[i] != HUGE_VAL )
-            {
-                x[i] *= dfTargetFromRadians;
-                y[i] *= dfTargetFromRadians;
-            }
-        }
-
-        if( bTargetWrap )
-        {
-            for( i = 0; i < nCount; i++ )
-            {
-                if( x[i] != HUGE_VAL && y[i] != HUGE_VAL )
-                {
-                    if( x[i] < dfTargetWrapLong - 180.0 )
-                        x[i] += 360.0;
-                    else if( x[i] > dfTargetWrapLong + 180 )
-                        x[i] -= 360.0;
-                }
-            }
-        }
-    }
-
 /* -------------------------------------------------------------------- */
 /*      Establish error information if pabSuccess provided.             */
 /* -------------------------------------------------------------------- */
     if( pabSuccess )
     {
-        for( i = 0; i < nCount; i++ )
+        for( int i = 0; i < nCount; i++ )
         {
             if( x[i] == HUGE_VAL || y[i] == HUGE_VAL )
                 pabSuccess[i] = FALSE;
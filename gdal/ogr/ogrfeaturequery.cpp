@@ -30,6 +30,8 @@
  ****************************************************************************/
 
 #include <assert.h>
+#include <algorithm>
+#include <vector>
 #include "swq.h"
 #include "ogr_feature.h"
 #include "ogr_p.h"
@@ -46,6 +48,563 @@ const char* const SpecialFieldNames[SPECIAL_FIELD_COUNT]
 const swq_field_type SpecialFieldTypes[SPECIAL_FIELD_COUNT]
 = {SWQ_INTEGER, SWQ_STRING, SWQ_STRING, SWQ_STRING, SWQ_FLOAT};
 
+/************************************************************************/
+/*                         OGRFeatureFetcher()                          */
+/************************************************************************/
+
+static swq_expr_node *OGRFeatureFetcher( swq_expr_node *op, void *pFeatureIn )
+
+{
+    OGRFeature *poFeature = (OGRFeature *) pFeatureIn;
+    swq_expr_node *poRetNode = NULL;
+
+    if( op->field_type == SWQ_GEOMETRY )
+    {
+        int iField = op->field_index - (poFeature->GetFieldCount() + SPECIAL_FIELD_COUNT);
+        poRetNode = new swq_expr_node( poFeature->GetGeomFieldRef(iField) );
+        return poRetNode;
+    }
+
+    switch( op->field_type )
+    {
+      case SWQ_INTEGER:
+      case SWQ_BOOLEAN:
+        poRetNode = new swq_expr_node(
+            poFeature->GetFieldAsInteger(op->field_index) );
+        break;
+
+      case SWQ_INTEGER64:
+        poRetNode = new swq_expr_node(
+            poFeature->GetFieldAsInteger64(op->field_index) );
+        break;
+
+      case SWQ_FLOAT:
+        poRetNode = new swq_expr_node(
+            poFeature->GetFieldAsDouble(op->field_index) );
+        break;
+
+      default:
+        poRetNode = new swq_expr_node(
+            poFeature->GetFieldAsString(op->field_index) );
+        break;
+    }
+
+    poRetNode->is_null = !(poFeature->IsFieldSet(op->field_index));
+
+    return poRetNode;
+}
+
+/************************************************************************/
+/*                        OGRFeatureQueryProgram                        */
+/*                                                                      */
+/*      Flat form of the expression, built by Compile().                */
+/*      Comparisons of a field with constants are lowered to typed      */
+/*      instructions that read the field directly from the feature,     */
+/*      constant sub-expressions are folded, and AND/OR short-circuit   */
+/*      when that cannot change the result.  Sub-expressions that       */
+/*      cannot be lowered are evaluated with swq_expr_node::Evaluate(). */
+/*      The results are the same as the ones of the tree evaluation,    */
+/*      including its handling of NULL values and errors.               */
+/*                                                                      */
+/*      The program references sub-trees of the expression, so drivers  */
+/*      may only rewrite the tree returned by GetSWQExpr() in ways that */
+/*      keep its nodes alive and equivalent, as                         */
+/*      ReplaceBetweenByGEAndLERecurse() does.                          */
+/************************************************************************/
+
+typedef enum
+{
+    OFQ_CONSTANT,
+    OFQ_ISNULL,
+    OFQ_CMP_INTEGER,
+    OFQ_CMP_DOUBLE,
+    OFQ_CMP_STRING,
+    OFQ_BETWEEN_INTEGER,
+    OFQ_BETWEEN_DOUBLE,
+    OFQ_BETWEEN_STRING,
+    OFQ_IN_INTEGER,
+    OFQ_IN_DOUBLE,
+    OFQ_IN_STRING,
+    OFQ_LIKE,
+    OFQ_SUBTREE,
+    OFQ_NOT,
+    OFQ_AND,
+    OFQ_OR,
+    OFQ_JUMP_IF_FALSE,
+    OFQ_JUMP_IF_TRUE
+} OGRFeatureQueryOpcode;
+
+/* Values of the evaluation stack */
+#define OFQ_FALSE  0
+#define OFQ_TRUE   1
+#define OFQ_NULL   2
+#define OFQ_ERROR  3
+
+typedef struct
+{
+    OGRFeatureQueryOpcode eOpcode;
+    swq_field_type eFieldType;  // type of the field, selects the getter
+    int            iField;
+    swq_op         eCmp;        // for OFQ_CMP_xxx, as field OP constant
+    bool           bFieldFirst; // whether the field was the left operand
+    int            nValue;      // constant value, or jump target
+    size_t         iConst;      // first constant
+    size_t         nConstCount;
+    swq_expr_node *poNode;      // for OFQ_SUBTREE
+} OGRFeatureQueryInstr;
+
+class OGRFeatureQueryProgram
+{
+    std::vector<OGRFeatureQueryInstr> aoInstr;
+    std::vector<GIntBig>        anConstants;
+    std::vector<double>         adfConstants;
+    std::vector<CPLString>      aosConstants;
+    std::vector<swq_expr_node*> apoFoldedNodes;
+
+    OGRFeatureQueryInstr &Emit( OGRFeatureQueryOpcode eOpcode );
+    swq_expr_node *GetConstant( swq_expr_node *poNode );
+    bool        CompilePredicate( swq_expr_node *poNode );
+    bool        CompileNode( swq_expr_node *poNode, bool &bMayBeNull );
+
+  public:
+                OGRFeatureQueryProgram() {}
+               ~OGRFeatureQueryProgram();
+
+    static OGRFeatureQueryProgram *Build( swq_expr_node *poExpr );
+
+    int         Evaluate( OGRFeature *poFeature ) const;
+};
+
+/************************************************************************/
+/*                      ~OGRFeatureQueryProgram()                       */
+/************************************************************************/
+
+OGRFeatureQueryProgram::~OGRFeatureQueryProgram()
+
+{
+    for( size_t i = 0; i < apoFoldedNodes.size(); i++ )
+        delete apoFoldedNodes[i];
+}
+
+/************************************************************************/
+/*                        OGRFeatureQueryIsConstant()                   */
+/************************************************************************/
+
+static bool OGRFeatureQueryIsConstant( swq_expr_node *poNode )
+
+{
+    if( poNode->eNodeType == SNT_CONSTANT )
+        return true;
+    if( poNode->eNodeType != SNT_OPERATION ||
+        poNode->nOperation == SWQ_CUSTOM_FUNC )
+        return false;
+    for( int i = 0; i < poNode->nSubExprCount; i++ )
+    {
+        if( !OGRFeatureQueryIsConstant( poNode->papoSubExpr[i] ) )
+            return false;
+    }
+    return true;
+}
+
+/************************************************************************/
+/*                                Emit()                                */
+/************************************************************************/
+
+OGRFeatureQueryInstr &OGRFeatureQueryProgram::Emit(
+                                        OGRFeatureQueryOpcode eOpcode )
+
+{
+    OGRFeatureQueryInstr sInstr;
+    sInstr.eOpcode = eOpcode;
+    sInstr.eFieldType = SWQ_OTHER;
+    sInstr.iField = -1;
+    sInstr.eCmp = SWQ_EQ;
+    sInstr.bFieldFirst = true;
+    sInstr.nValue = 0;
+    sInstr.iConst = 0;
+    sInstr.nConstCount = 0;
+    sInstr.poNode = NULL;
+    aoInstr.push_back( sInstr );
+    return aoInstr.back();
+}
+
+/************************************************************************/
+/*                            GetConstant()                             */
+/*                                                                      */
+/*      Return the node itself if it is a constant, or its value if it  */
+/*      is a constant expression, or NULL.                              */
+/************************************************************************/
+
+swq_expr_node *OGRFeatureQueryProgram::GetConstant( swq_expr_node *poNode )
+
+{
+    if( poNode->eNodeType == SNT_CONSTANT )
+        return poNode;
+    if( !OGRFeatureQueryIsConstant( poNode ) )
+        return NULL;
+
+    swq_expr_node *poValue = poNode->Evaluate( OGRFeatureFetcher, NULL );
+    if( poValue != NULL )
+        apoFoldedNodes.push_back( poValue );
+    return poValue;
+}
+
+/************************************************************************/
+/*                          CompilePredicate()                          */
+/*                                                                      */
+/*      Lower a comparison of a field with constants, following the     */
+/*      type dispatching of SWQGeneralEvaluator() on the values that    */
+/*      OGRFeatureFetcher() and the constants would provide.            */
+/************************************************************************/
+
+bool OGRFeatureQueryProgram::CompilePredicate( swq_expr_node *poNode )
+
+{
+    const int nOp = poNode->nOperation;
+    const int nCount = poNode->nSubExprCount;
+
+    if( nCount < 1 ||
+        (nOp == SWQ_ISNULL && nCount != 1) ||
+        (nOp == SWQ_BETWEEN && nCount != 3) ||
+        (nOp == SWQ_IN && nCount < 2) ||
+        (nOp == SWQ_LIKE && nCount != 2 && nCount != 3) ||
+        (nOp != SWQ_ISNULL && nOp != SWQ_BETWEEN && nOp != SWQ_IN &&
+         nOp != SWQ_LIKE && nCount != 2) )
+        return false;
+
+/* -------------------------------------------------------------------- */
+/*      Find the field.  Only binary comparisons may have it on the     */
+/*      right side.                                                     */
+/* -------------------------------------------------------------------- */
+    int iFieldOperand = 0;
+    if( poNode->papoSubExpr[0]->eNodeType != SNT_COLUMN )
+    {
+        if( nCount != 2 || nOp == SWQ_LIKE ||
+            poNode->papoSubExpr[1]->eNodeType != SNT_COLUMN )
+            return false;
+        iFieldOperand = 1;
+    }
+    swq_expr_node *poField = poNode->papoSubExpr[iFieldOperand];
+    if( poField->table_index != 0 || poField->field_index < 0 )
+        return false;
+
+    // Type of the value returned by OGRFeatureFetcher()
+    swq_field_type eFieldValueType;
+    switch( poField->field_type )
+    {
+      case SWQ_INTEGER:
+      case SWQ_BOOLEAN:
+        eFieldValueType = SWQ_INTEGER;
+        break;
+      case SWQ_INTEGER64:
+        eFieldValueType = SWQ_INTEGER64;
+        break;
+      case SWQ_FLOAT:
+        eFieldValueType = SWQ_FLOAT;
+        break;
+      case SWQ_STRING:
+      case SWQ_DATE:
+      case SWQ_TIME:
+      case SWQ_TIMESTAMP:
+        eFieldValueType = SWQ_STRING;
+        break;
+      default:
+        return false;
+    }
+
+    if( nOp == SWQ_ISNULL )
+    {
+        OGRFeatureQueryInstr &sInstr = Emit( OFQ_ISNULL );
+        sInstr.eFieldType = poField->field_type;
+        sInstr.iField = poField->field_index;
+        return true;
+    }
+
+/* -------------------------------------------------------------------- */
+/*      Collect the constants.                                          */
+/* -------------------------------------------------------------------- */
+    std::vector<swq_expr_node*> apoConstants;
+    for( int i = 0; i < nCount; i++ )
+    {
+        if( i == iFieldOperand )
+            continue;
+        swq_expr_node *poConstant = GetConstant( poNode->papoSubExpr[i] );
+        if( poConstant == NULL || poConstant->is_null ||
+            poConstant->field_type == SWQ_GEOMETRY )
+            return false;
+        apoConstants.push_back( poConstant );
+    }
+
+    const swq_field_type eType0 = iFieldOperand == 0 ?
+        eFieldValueType : apoConstants[0]->field_type;
+    const swq_field_type eType1 = iFieldOperand == 1 ?
+        eFieldValueType : apoConstants[0]->field_type;
+
+    size_t nFirstConst;
+    OGRFeatureQueryOpcode eOpcode;
+
+    if( eType0 == SWQ_FLOAT || eType1 == SWQ_FLOAT )
+    {
+        if( eFieldValueType == SWQ_STRING || nOp == SWQ_LIKE )
+            return false;
+        nFirstConst = adfConstants.size();
+        for( size_t i = 0; i < apoConstants.size(); i++ )
+        {
+            adfConstants.push_back(
+                SWQ_IS_INTEGER(apoConstants[i]->field_type) ?
+                    static_cast<double>(apoConstants[i]->int_value) :
+                    apoConstants[i]->float_value );
+        }
+        eOpcode = nOp == SWQ_BETWEEN ? OFQ_BETWEEN_DOUBLE :
+                  nOp == SWQ_IN ? OFQ_IN_DOUBLE : OFQ_CMP_DOUBLE;
+        if( nOp == SWQ_IN )
+            std::sort( adfConstants.begin() + nFirstConst,
+                       adfConstants.end() );
+    }
+    else if( SWQ_IS_INTEGER(eType0) || eType0 == SWQ_BOOLEAN )
+    {
+        if( eFieldValueType == SWQ_STRING || nOp == SWQ_LIKE )
+            return false;
+        nFirstConst = anConstants.size();
+        for( size_t i = 0; i < apoConstants.size(); i++ )
+            anConstants.push_back( apoConstants[i]->int_value );
+        eOpcode = nOp == SWQ_BETWEEN ? OFQ_BETWEEN_INTEGER :
+                  nOp == SWQ_IN ? OFQ_IN_INTEGER : OFQ_CMP_INTEGER;
+        if( nOp == SWQ_IN )
+            std::sort( anConstants.begin() + nFirstConst,
+                       anConstants.end() );
+    }
+    else
+    {
+        if( eFieldValueType != SWQ_STRING )
+            return false;
+        nFirstConst = aosConstants.size();
+        for( size_t i = 0; i < apoConstants.size(); i++ )
+        {
+            if( (apoConstants[i]->field_type != SWQ_STRING &&
+                 apoConstants[i]->field_type != SWQ_TIMESTAMP) ||
+                apoConstants[i]->string_value == NULL )
+                return false;
+            aosConstants.push_back( apoConstants[i]->string_value );
+        }
+        eOpcode = nOp == SWQ_BETWEEN ? OFQ_BETWEEN_STRING :
+                  nOp == SWQ_IN ? OFQ_IN_STRING :
+                  nOp == SWQ_LIKE ? OFQ_LIKE : OFQ_CMP_STRING;
+    }
+
+    if( eOpcode == OFQ_CMP_INTEGER || eOpcode == OFQ_CMP_DOUBLE ||
+        eOpcode == OFQ_CMP_STRING )
+    {
+        if( nOp != SWQ_EQ && nOp != SWQ_NE && nOp != SWQ_LT &&
+            nOp != SWQ_LE && nOp != SWQ_GT && nOp != SWQ_GE )
+            return false;
+    }
+
+    OGRFeatureQueryInstr &sInstr = Emit( eOpcode );
+    sInstr.eFieldType = poField->field_type;
+    sInstr.iField = poField->field_index;
+    sInstr.iConst = nFirstConst;
+    sInstr.nConstCount = apoConstants.size();
+    sInstr.bFieldFirst = iFieldOperand == 0;
+    sInstr.eCmp = static_cast<swq_op>(nOp);
+    if( iFieldOperand == 1 )
+    {
+        // Turn "constant OP field" into "field OP' constant"
+        switch( nOp )
+        {
+          case SWQ_LT: sInstr.eCmp = SWQ_GT; break;
+          case SWQ_LE: sInstr.eCmp = SWQ_GE; break;
+          case SWQ_GT: sInstr.eCmp = SWQ_LT; break;
+          case SWQ_GE: sInstr.eCmp = SWQ_LE; break;
+          default: break;
+        }
+    }
+    return true;
+}
+
+/************************************************************************/
+/*                            CompileNode()                             */
+/*                                                                      */
+/*      Emit the instructions that push the boolean value of a node.    */
+/*      bMayBeNull is set if that value may be OFQ_NULL or OFQ_ERROR.   */
+/************************************************************************/
+
+bool OGRFeatureQueryProgram::CompileNode( swq_expr_node *poNode,
+                                          bool &bMayBeNull )
+
+{
+    bMayBeNull = false;
+    if( poNode->eNodeType != SNT_OPERATION ||
+        poNode->field_type != SWQ_BOOLEAN )
+        return false;
+
+/* -------------------------------------------------------------------- */
+/*      Constant folding.                                               */
+/* -------------------------------------------------------------------- */
+    if( OGRFeatureQueryIsConstant( poNode ) )
+    {
+        swq_expr_node *poValue = poNode->Evaluate( OGRFeatureFetcher, NULL );
+        OGRFeatureQueryInstr &sInstr = Emit( OFQ_CONSTANT );
+        if( poValue == NULL )
+            sInstr.nValue = OFQ_ERROR;
+        else if( poValue->is_null )
+            sInstr.nValue = OFQ_NULL;
+        else
+            sInstr.nValue = poValue->int_value ? OFQ_TRUE : OFQ_FALSE;
+        bMayBeNull = sInstr.nValue >= OFQ_NULL;
+        delete poValue;
+        return true;
+    }
+
+/* -------------------------------------------------------------------- */
+/*      Logical operators, whose operands must be booleans for          */
+/*      SWQGeneralEvaluator() to handle them.                           */
+/* -------------------------------------------------------------------- */
+    const int nOp = poNode->nOperation;
+    if( (nOp == SWQ_AND || nOp == SWQ_OR) && poNode->nSubExprCount == 2 )
+    {
+        if( poNode->papoSubExpr[0]->field_type != SWQ_BOOLEAN ||
+            poNode->papoSubExpr[1]->field_type != SWQ_BOOLEAN )
+            return false;
+
+        bool bLeftMayBeNull = false;
+        bool bRightMayBeNull = false;
+        if( !CompileNode( poNode->papoSubExpr[0], bLeftMayBeNull ) )
+        {
+            Emit( OFQ_SUBTREE ).poNode = poNode->papoSubExpr[0];
+            bLeftMayBeNull = true;
+        }
+        const size_t iJump = aoInstr.size();
+        Emit( nOp == SWQ_AND ? OFQ_JUMP_IF_FALSE : OFQ_JUMP_IF_TRUE );
+        if( !CompileNode( poNode->papoSubExpr[1], bRightMayBeNull ) )
+        {
+            Emit( OFQ_SUBTREE ).poNode = poNode->papoSubExpr[1];
+            bRightMayBeNull = true;
+        }
+        Emit( nOp == SWQ_AND ? OFQ_AND : OFQ_OR );
+
+        // Skipping the right operand is only valid if it cannot be NULL,
+        // as a NULL operand makes the result FALSE.
+        if( bRightMayBeNull )
+            aoInstr.erase( aoInstr.begin() + iJump );
+        else
+            aoInstr[iJump].nValue = static_cast<int>(aoInstr.size());
+        // Jump targets of the right operand moved back by one.
+        for( size_t i = iJump; bRightMayBeNull && i < aoInstr.size(); i++ )
+        {
+            if( aoInstr[i].eOpcode == OFQ_JUMP_IF_FALSE ||
+                aoInstr[i].eOpcode == OFQ_JUMP_IF_TRUE )
+                aoInstr[i].nValue --;
+        }
+
+        bMayBeNull = bLeftMayBeNull || bRightMayBeNull;
+        return true;
+    }
+
+    if( nOp == SWQ_NOT && poNode->nSubExprCount == 1 )
+    {
+        swq_expr_node *poSub = poNode->papoSubExpr[0];
+        if( poSub->field_type != SWQ_BOOLEAN )
+            return false;
+        if( !CompileNode( poSub, bMayBeNull ) )
+        {
+            Emit( OFQ_SUBTREE ).poNode = poSub;
+            bMayBeNull = true;
+        }
+        Emit( OFQ_NOT );
+        return true;
+    }
+
+/* -------------------------------------------------------------------- */
+/*      Comparisons.                                                    */
+/* -------------------------------------------------------------------- */
+    if( nOp == SWQ_EQ || nOp == SWQ_NE || nOp == SWQ_LT || nOp == SWQ_LE ||
+        nOp == SWQ_GT || nOp == SWQ_GE || nOp == SWQ_BETWEEN ||
+        nOp == SWQ_IN || nOp == SWQ_LIKE || nOp == SWQ_ISNULL )
+    {
+        const size_t nIntConsts = anConstants.size();
+        const size_t nDoubleConsts = adfConstants.size();
+        const size_t nStringConsts = aosConstants.size();
+        if( CompilePredicate( poNode ) )
+            return true;
+        anConstants.resize( nIntConsts );
+        adfConstants.resize( nDoubleConsts );
+        aosConstants.resize( nStringConsts );
+    }
+
+    return false;
+}
+
+/************************************************************************/
+/*                               Build()                                */
+/************************************************************************/
+
+OGRFeatureQueryProgram *OGRFeatureQueryProgram::Build( swq_expr_node *poExpr )
+
+{
+    if( !CPLTestBool(CPLGetConfigOption("OGR_FEATURE_QUERY_COMPILE", "YES")) )
+        return NULL;
+
+    OGRFeatureQueryProgram *poProgram = new OGRFeatureQueryProgram();
+    bool bMayBeNull = false;
+    if( !poProgram->CompileNode( poExpr, bMayBeNull ) )
+    {
+        delete poProgram;
+        return NULL;
+    }
+    return poProgram;
+}
+
+/************************************************************************/
+/*                      Instruction helpers.                            */
+/************************************************************************/
+
+template<class T> static inline bool OGRFeatureQueryCompare( T a, T b,
+                                                             swq_op eCmp )
+{
+    switch( eCmp )
+    {
+      case SWQ_EQ: return a == b;
+      case SWQ_NE: return a != b;
+      case SWQ_LT: return a < b;
+      case SWQ_LE: return a <= b;
+      case SWQ_GT: return a > b;
+      default:     return a >= b;
+    }
+}
+
+static inline GIntBig OGRFeatureQueryGetInteger(
+                    OGRFeature *poFeature, const OGRFeatureQueryInstr &sInstr )
+{
+    if( sInstr.eFieldType == SWQ_INTEGER64 )
+        return poFeature->GetFieldAsInteger64( sInstr.iField );
+    return poFeature->GetFieldAsInteger( sInstr.iField );
+}
+
+static inline double OGRFeatureQueryGetDouble(
+                    OGRFeature *poFeature, const OGRFeatureQueryInstr &sInstr )
+{
+    if( sInstr.eFieldType == SWQ_FLOAT )
+        return poFeature->GetFieldAsDouble( sInstr.iField );
+    return static_cast<double>(OGRFeatureQueryGetInteger( poFeature, sInstr ));
+}
+
+// String equality of SWQGeneralEvaluator(), where the +00 timezone of a
+// timestamp may be ignored if the other one has no timezone.
+static bool OGRFeatureQueryStringEqual( const char *pszA, const char *pszB )
+{
+    const size_t nLenA = strlen(pszA);
+    const size_t nLenB = strlen(pszB);
+    if( nLenA > 3 && nLenB > 3 )
+    {
+        if( strcmp(pszA + nLenA - 3, "+00") == 0 && pszB[nLenB-3] == ':' )
+            return EQUALN(pszA, pszB, nLenB);
+        if( pszA[nLenA-3] == ':' && strcmp(pszB + nLenB - 3, "+00") == 0 )
+            return EQUALN(pszA, pszB, nLenA);
+    }
+    return strcasecmp(pszA, pszB) == 0;
+}
+
 /************************************************************************/
 /*                          OGRFeatureQuery()                           */
 /************************************************************************/
@@ -55,6 +614,7 @@ OGRFeatureQuery::OGRFeatureQuery()
 {
     poTargetDefn = NULL;
     pSWQExpr = NULL;
+    poProgram = NULL;
 }
 
 /************************************************************************/
@@ -64,6 +624,7 @@ OGRFeatureQuery::OGRFeatureQuery()
 OGRFeatureQuery::~OGRFeatureQuery()
 
 {
+    delete poProgram;
     delete (swq_expr_node *) pSWQExpr;
 }
 
@@ -85,6 +646,8 @@ OGRErr OGRFeatureQuery::Compile( OGRFeatureDefn *poDefn,
         delete (swq_expr_node *) pSWQExpr;
         pSWQExpr = NULL;
     }
+    delete poProgram;
+    poProgram = NULL;
 
 /* -------------------------------------------------------------------- */
 /*      Build list of fields.                                           */
@@ -182,6 +745,11 @@ OGRErr OGRFeatureQuery::Compile( OGRFeatureDefn *poDefn,
         eErr = OGRERR_CORRUPT_DATA;
         pSWQExpr = NULL;
     }
+    else
+    {
+        poProgram =
+            OGRFeatureQueryProgram::Build( (swq_expr_node *) pSWQExpr );
+    }
 
     CPLFree( papszFieldNames );
     CPLFree( paeFieldTypes );
@@ -191,49 +759,194 @@ OGRErr OGRFeatureQuery::Compile( OGRFeatureDefn *poDefn,
 }
 
 /************************************************************************/
-/*                         OGRFeatureFetcher()                          */
+/*                              Evaluate()                              */
 /************************************************************************/
 
-static swq_expr_node *OGRFeatureFetcher( swq_expr_node *op, void *pFeatureIn )
+int OGRFeatureQueryProgram::Evaluate( OGRFeature *poFeature ) const
 
 {
-    OGRFeature *poFeature = (OGRFeature *) pFeatureIn;
-    swq_expr_node *poRetNode = NULL;
-
-    if( op->field_type == SWQ_GEOMETRY )
+/* -------------------------------------------------------------------- */
+/*      The stack is local, so that a program can be evaluated by       */
+/*      several threads.  Its depth is at most the number of           */
+/*      instructions.                                                   */
+/* -------------------------------------------------------------------- */
+    const size_t nInstr = aoInstr.size();
+    int anLocalStack[32];
+    std::vector<int> anHeapStack;
+    int *panStack = anLocalStack;
+    if( nInstr > sizeof(anLocalStack) / sizeof(anLocalStack[0]) )
     {
-        int iField = op->field_index - (poFeature->GetFieldCount() + SPECIAL_FIELD_COUNT);
-        poRetNode = new swq_expr_node( poFeature->GetGeomFieldRef(iField) );
-        return poRetNode;
+        anHeapStack.assign( nInstr, OFQ_FALSE );
+        panStack = &anHeapStack[0];
     }
+    panStack[0] = OFQ_FALSE;
+    int nSP = 0;
 
-    switch( op->field_type )
+    for( size_t iPC = 0; iPC < nInstr; iPC++ )
     {
-      case SWQ_INTEGER:
-      case SWQ_BOOLEAN:
-        poRetNode = new swq_expr_node(
-            poFeature->GetFieldAsInteger(op->field_index) );
-        break;
+        const OGRFeatureQueryInstr &sInstr = aoInstr[iPC];
 
-      case SWQ_INTEGER64:
-        poRetNode = new swq_expr_node(
-            poFeature->GetFieldAsInteger64(op->field_index) );
-        break;
+        // A NULL field value makes any comparison FALSE.
+        if( sInstr.eOpcode >= OFQ_CMP_INTEGER && sInstr.eOpcode <= OFQ_LIKE &&
+            !poFeature->IsFieldSet( sInstr.iField ) )
+        {
+            panStack[nSP++] = OFQ_FALSE;
+            continue;
+        }
 
-      case SWQ_FLOAT:
-        poRetNode = new swq_expr_node(
-            poFeature->GetFieldAsDouble(op->field_index) );
-        break;
+        switch( sInstr.eOpcode )
+        {
+          case OFQ_CONSTANT:
+            panStack[nSP++] = sInstr.nValue;
+            break;
 
-      default:
-        poRetNode = new swq_expr_node(
-            poFeature->GetFieldAsString(op->field_index) );
-        break;
-    }
+          case OFQ_ISNULL:
+            panStack[nSP++] = !poFeature->IsFieldSet( sInstr.iField );
+            break;
 
-    poRetNode->is_null = !(poFeature->IsFieldSet(op->field_index));
+          case OFQ_CMP_INTEGER:
+            panStack[nSP++] = OGRFeatureQueryCompare(
+                OGRFeatureQueryGetInteger( poFeature, sInstr ),
+                anConstants[sInstr.iConst], sInstr.eCmp );
+            break;
 
-    return poRetNode;
+          case OFQ_CMP_DOUBLE:
+            panStack[nSP++] = OGRFeatureQueryCompare(
+                OGRFeatureQueryGetDouble( poFeature, sInstr ),
+                adfConstants[sInstr.iConst], sInstr.eCmp );
+            break;
+
+          case OFQ_CMP_STRING:
+          {
+            const char *pszValue = poFeature->GetFieldAsString( sInstr.iField );
+            const char *pszConst = aosConstants[sInstr.iConst].c_str();
+            if( sInstr.eCmp == SWQ_EQ )
+                panStack[nSP++] = sInstr.bFieldFirst ?
+                    OGRFeatureQueryStringEqual( pszValue, pszConst ) :
+                    OGRFeatureQueryStringEqual( pszConst, pszValue );
+            else
+                panStack[nSP++] = OGRFeatureQueryCompare(
+                    strcasecmp( pszValue, pszConst ), 0, sInstr.eCmp );
+            break;
+          }
+
+          case OFQ_BETWEEN_INTEGER:
+          {
+            const GIntBig nValue = OGRFeatureQueryGetInteger( poFeature, sInstr );
+            panStack[nSP++] = nValue >= anConstants[sInstr.iConst] &&
+                              nValue <= anConstants[sInstr.iConst + 1];
+            break;
+          }
+
+          case OFQ_BETWEEN_DOUBLE:
+          {
+            const double dfValue = OGRFeatureQueryGetDouble( poFeature, sInstr );
+            panStack[nSP++] = dfValue >= adfConstants[sInstr.iConst] &&
+                              dfValue <= adfConstants[sInstr.iConst + 1];
+            break;
+          }
+
+          case OFQ_BETWEEN_STRING:
+          {
+            const char *pszValue = poFeature->GetFieldAsString( sInstr.iField );
+            panStack[nSP++] =
+                strcasecmp( pszValue, aosConstants[sInstr.iConst] ) >= 0 &&
+                strcasecmp( pszValue, aosConstants[sInstr.iConst + 1] ) <= 0;
+            break;
+          }
+
+          case OFQ_IN_INTEGER:
+          {
+            const std::vector<GIntBig>::const_iterator oStart =
+                anConstants.begin() + sInstr.iConst;
+            panStack[nSP++] = std::binary_search(
+                oStart, oStart + sInstr.nConstCount,
+                OGRFeatureQueryGetInteger( poFeature, sInstr ) );
+            break;
+          }
+
+          case OFQ_IN_DOUBLE:
+          {
+            const double dfValue = OGRFeatureQueryGetDouble( poFeature, sInstr );
+            const std::vector<double>::const_iterator oStart =
+                adfConstants.begin() + sInstr.iConst;
+            // NaN is equal to nothing, but binary_search() would find it.
+            panStack[nSP++] = !CPLIsNan(dfValue) && std::binary_search(
+                oStart, oStart + sInstr.nConstCount, dfValue );
+            break;
+          }
+
+          case OFQ_IN_STRING:
+          {
+            const char *pszValue = poFeature->GetFieldAsString( sInstr.iField );
+            int bFound = FALSE;
+            for( size_t i = 0; !bFound && i < sInstr.nConstCount; i++ )
+                bFound = strcasecmp( pszValue,
+                                     aosConstants[sInstr.iConst + i] ) == 0;
+            panStack[nSP++] = bFound;
+            break;
+          }
+
+          case OFQ_LIKE:
+            panStack[nSP++] = swq_test_like(
+                poFeature->GetFieldAsString( sInstr.iField ),
+                aosConstants[sInstr.iConst],
+                sInstr.nConstCount == 2 ?
+                    aosConstants[sInstr.iConst + 1][0] : '\0' );
+            break;
+
+          case OFQ_SUBTREE:
+          {
+            swq_expr_node *poResult =
+                sInstr.poNode->Evaluate( OGRFeatureFetcher, poFeature );
+            if( poResult == NULL )
+                panStack[nSP++] = OFQ_ERROR;
+            else
+            {
+                panStack[nSP++] = poResult->is_null ? OFQ_NULL :
+                    poResult->int_value ? OFQ_TRUE : OFQ_FALSE;
+                delete poResult;
+            }
+            break;
+          }
+
+          case OFQ_NOT:
+          {
+            const int nValue = panStack[nSP-1];
+            panStack[nSP-1] = nValue == OFQ_ERROR ? OFQ_ERROR :
+                              nValue == OFQ_FALSE ? OFQ_TRUE : OFQ_FALSE;
+            break;
+          }
+
+          case OFQ_AND:
+          case OFQ_OR:
+          {
+            const int nRight = panStack[--nSP];
+            const int nLeft = panStack[nSP-1];
+            if( nLeft == OFQ_ERROR || nRight == OFQ_ERROR )
+                panStack[nSP-1] = OFQ_ERROR;
+            else if( nLeft == OFQ_NULL || nRight == OFQ_NULL )
+                panStack[nSP-1] = OFQ_FALSE;
+            else if( sInstr.eOpcode == OFQ_AND )
+                panStack[nSP-1] = nLeft && nRight;
+            else
+                panStack[nSP-1] = nLeft || nRight;
+            break;
+          }
+
+          case OFQ_JUMP_IF_FALSE:
+            if( panStack[nSP-1] == OFQ_FALSE )
+                iPC = sInstr.nValue - 1;
+            break;
+
+          case OFQ_JUMP_IF_TRUE:
+            if( panStack[nSP-1] == OFQ_TRUE )
+                iPC = sInstr.nValue - 1;
+            break;
+        }
+    }
+
+    return panStack[0] == OFQ_TRUE;
 }
 
 /************************************************************************/
@@ -246,6 +959,9 @@ int OGRFeatureQuery::Evaluate( OGRFeature *poFeature )
     if( pSWQExpr == NULL )
         return FALSE;
 
+    if( poProgram != NULL )
+        return poProgram->Evaluate( poFeature );
+
     swq_expr_node *poResult;
 
     poResult = ((swq_expr_node *) pSWQExpr)->Evaluate( OGRFeatureFetcher,
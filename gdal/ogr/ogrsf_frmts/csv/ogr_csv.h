@@ -32,6 +32,9 @@
 #define OGR_CSV_H_INCLUDED
 
 #include "ogrsf_frmts.h"
+#include "cpl_worker_thread_pool.h"
+
+#include <vector>
 
 typedef enum
 {
@@ -59,6 +62,57 @@ typedef enum
 
 void OGRCSVDriverRemoveFromMap(const char* pszName, GDALDataset* poDS);
 
+/************************************************************************/
+/*                          OGRCSVRecordReader                          */
+/*                                                                      */
+/*      Block based reader of CSV records, following the same           */
+/*      splitting rules as OGRCSVReadParseLineL(), but whose tokens     */
+/*      point into a buffer reused from one record to the next.         */
+/************************************************************************/
+
+class OGRCSVRecordReader
+{
+    VSILFILE           *fp;
+    char                chDelimiter;
+    bool                bHonourStrings;
+    bool                bMergeDelimiter;
+
+    GByte              *pabyBlock;
+    size_t              nBlockSize;
+    size_t              nBlockPos;
+    vsi_l_offset        nBlockOffset;
+    bool                bEOF;
+
+    std::vector<char>   abyRecord;
+    std::vector<char*>  apszTokens;
+    vsi_l_offset        nRecordOffset;
+
+    bool                FillBlock();
+    bool                ReadLine( int *pnQuotes );
+    void                SplitRecord();
+
+  public:
+                        OGRCSVRecordReader();
+                       ~OGRCSVRecordReader();
+
+    void                Start( VSILFILE *fp, vsi_l_offset nOffset,
+                               char chDelimiter, bool bHonourStrings,
+                               bool bMergeDelimiter );
+    char              **ReadRecord();
+    vsi_l_offset        GetRecordOffset() const { return nRecordOffset; }
+};
+
+struct OGRCSVTranslateJob;
+
+/* Error emitted while translating a record in a worker thread, and */
+/* emitted again by the reading thread */
+struct OGRCSVDeferredError
+{
+    CPLErr              eErr;
+    CPLErrorNum         nErrNo;
+    CPLString           osMsg;
+};
+
 /************************************************************************/
 /*                             OGRCSVLayer                              */
 /************************************************************************/
@@ -118,7 +172,52 @@ class OGRCSVLayer : public OGRLayer
 
     int                 bEmptyStringNull;
 
+    OGRCSVRecordReader  oReader;
+    bool                bReaderStarted;
+    int                 nReaderFID;
+
     char              **GetNextLineTokens();
+    void                StartReader( vsi_l_offset nOffset );
+
+    /* FID to file offset index, filled as records are read in order. */
+    /* The record of FID i+1 starts at */
+    /* anFIDIndexBase[i / CSV_FID_INDEX_GROUP] + anFIDIndexDelta[i] */
+    std::vector<vsi_l_offset> anFIDIndexBase;
+    std::vector<GUInt32> anFIDIndexDelta;
+    bool                bFIDIndexComplete;
+    bool                bFIDIndexOverflow;
+    bool                bFIDIndexFileTried;
+    bool                bFIDIndexFromFile;
+    int                 bWriteFIDIndex;
+
+    void                AddToFIDIndex( vsi_l_offset nOffset );
+    bool                SeekToFID( GIntBig nFID );
+    CPLString           GetFIDIndexFilename() const;
+    GUInt32             GetFIDIndexFlags() const;
+    void                LoadFIDIndex();
+    void                SaveFIDIndex();
+
+    OGRFeature         *TranslateFeature( char **papszTokens, int nFID,
+                                          bool bWarningEmitted,
+                                          CPLString &osWarning );
+    void                EmitWarning( const CPLString &osWarning );
+    void                EmitBatchErrors( size_t iRecord );
+
+    /* Features translated ahead by worker threads, in FID order */
+    CPLWorkerThreadPool *poThreadPool;
+    int                 nPoolThreads;
+    std::vector<char>   abyBatchData;
+    std::vector<size_t> anBatchTokenOffsets;
+    std::vector<char*>  apszBatchTokens;
+    std::vector<OGRFeature*> apoBatchFeatures;
+    std::vector<CPLString> aosBatchWarnings;
+    std::vector< std::vector<OGRCSVDeferredError> > aaoBatchErrors;
+    size_t              iBatchNext;
+
+    CPLWorkerThreadPool *GetThreadPool();
+    void                FillFeatureBatch();
+    void                ClearFeatureBatch();
+    static void         TranslateFeaturesJob( void *pData );
 
     static int          Matches(const char* pszFieldName, char** papszPossibleNames);
 
@@ -146,6 +245,7 @@ class OGRCSVLayer : public OGRLayer
     void                ResetReading();
     OGRFeature *        GetNextFeature();
     virtual OGRFeature* GetFeature( GIntBig nFID );
+    virtual OGRErr      SetNextByIndex( GIntBig nIndex );
 
     OGRFeatureDefn *    GetLayerDefn() { return poFeatureDefn; }
 
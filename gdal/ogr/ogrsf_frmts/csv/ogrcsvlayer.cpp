@@ -34,8 +34,20 @@
 #include "cpl_csv.h"
 #include "ogr_p.h"
 
+#if defined(__x86_64) || defined(_M_X64)
+#define USE_SSE2
+#endif
+
+#ifdef USE_SSE2
+#include <emmintrin.h>
+#endif
+
 CPL_CVSID("$Id$");
 
+static const size_t CSV_BLOCK_SIZE = 65536;
+static const size_t CSV_FID_INDEX_GROUP = 256;
+static const char CSV_FID_INDEX_MAGIC[] = "CSVFIDX1";
+
 
 /************************************************************************/
 /*                            CSVSplitLine()                            */
@@ -209,6 +221,303 @@ char **OGRCSVReadParseLineL( VSILFILE * fp, char chDelimiter,
     return papszReturn;
 }
 
+/************************************************************************/
+/*                         OGRCSVFindFirstOf()                          */
+/*                                                                      */
+/*      Return the index of the first byte equal to one of the 4        */
+/*      characters, or nSize if there is none.  16 bytes are tested     */
+/*      at once with SSE2.                                              */
+/************************************************************************/
+
+static size_t OGRCSVFindFirstOf( const GByte *pabyData, size_t nSize,
+                                 GByte ch1, GByte ch2, GByte ch3, GByte ch4 )
+{
+    size_t i = 0;
+#ifdef USE_SSE2
+    const __m128i xmm1 = _mm_set1_epi8(static_cast<char>(ch1));
+    const __m128i xmm2 = _mm_set1_epi8(static_cast<char>(ch2));
+    const __m128i xmm3 = _mm_set1_epi8(static_cast<char>(ch3));
+    const __m128i xmm4 = _mm_set1_epi8(static_cast<char>(ch4));
+    for( ; i + 16 <= nSize; i += 16 )
+    {
+        const __m128i xmmData = _mm_loadu_si128(
+            reinterpret_cast<const __m128i*>(pabyData + i));
+        const __m128i xmmMatch = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(xmmData, xmm1),
+                         _mm_cmpeq_epi8(xmmData, xmm2)),
+            _mm_or_si128(_mm_cmpeq_epi8(xmmData, xmm3),
+                         _mm_cmpeq_epi8(xmmData, xmm4)));
+        int nMask = _mm_movemask_epi8(xmmMatch);
+        if( nMask != 0 )
+        {
+            while( (nMask & 1) == 0 )
+            {
+                nMask >>= 1;
+                i++;
+            }
+            return i;
+        }
+    }
+#endif
+    for( ; i < nSize; i++ )
+    {
+        const GByte ch = pabyData[i];
+        if( ch == ch1 || ch == ch2 || ch == ch3 || ch == ch4 )
+            return i;
+    }
+    return nSize;
+}
+
+/************************************************************************/
+/*                         OGRCSVRecordReader()                         */
+/************************************************************************/
+
+OGRCSVRecordReader::OGRCSVRecordReader() :
+    fp(NULL),
+    chDelimiter(','),
+    bHonourStrings(true),
+    bMergeDelimiter(false),
+    pabyBlock(NULL),
+    nBlockSize(0),
+    nBlockPos(0),
+    nBlockOffset(0),
+    bEOF(true),
+    nRecordOffset(0)
+{}
+
+/************************************************************************/
+/*                        ~OGRCSVRecordReader()                         */
+/************************************************************************/
+
+OGRCSVRecordReader::~OGRCSVRecordReader()
+{
+    CPLFree(pabyBlock);
+}
+
+/************************************************************************/
+/*                               Start()                                */
+/*                                                                      */
+/*      Position the reader at nOffset.  The file pointer is then       */
+/*      owned by the reader until the next Start().                     */
+/************************************************************************/
+
+void OGRCSVRecordReader::Start( VSILFILE *fpIn, vsi_l_offset nOffset,
+                                char chDelimiterIn, bool bHonourStringsIn,
+                                bool bMergeDelimiterIn )
+{
+    fp = fpIn;
+    chDelimiter = chDelimiterIn;
+    bHonourStrings = bHonourStringsIn;
+    bMergeDelimiter = bMergeDelimiterIn;
+    if( pabyBlock == NULL )
+        pabyBlock = static_cast<GByte*>(CPLMalloc(CSV_BLOCK_SIZE));
+    nBlockSize = 0;
+    nBlockPos = 0;
+    nBlockOffset = nOffset;
+    nRecordOffset = nOffset;
+    bEOF = VSIFSeekL(fp, nOffset, SEEK_SET) != 0;
+}
+
+/************************************************************************/
+/*                             FillBlock()                              */
+/************************************************************************/
+
+bool OGRCSVRecordReader::FillBlock()
+{
+    if( bEOF )
+        return false;
+    nBlockOffset += nBlockSize;
+    nBlockPos = 0;
+    nBlockSize = VSIFReadL(pabyBlock, 1, CSV_BLOCK_SIZE, fp);
+    if( nBlockSize < CSV_BLOCK_SIZE )
+        bEOF = true;
+    return nBlockSize > 0;
+}
+
+/************************************************************************/
+/*                              ReadLine()                              */
+/*                                                                      */
+/*      Append the next line to the record, with the end of line        */
+/*      rules of CPLReadLineL() : CR, LF, CRLF and LFCR terminate a     */
+/*      line, and the line is truncated at a nul character.  Returns    */
+/*      false at end of file.                                           */
+/************************************************************************/
+
+bool OGRCSVRecordReader::ReadLine( int *pnQuotes )
+{
+    bool bGotLine = false;
+    bool bTruncated = false;
+
+    while( true )
+    {
+        if( nBlockPos == nBlockSize && !FillBlock() )
+            return bGotLine;
+        bGotLine = true;
+
+        const GByte *pabyStart = pabyBlock + nBlockPos;
+        const size_t nAvail = nBlockSize - nBlockPos;
+        const size_t nLen = OGRCSVFindFirstOf( pabyStart, nAvail,
+                                               '\n', '\r', '"', '\0' );
+        if( !bTruncated )
+            abyRecord.insert( abyRecord.end(), pabyStart, pabyStart + nLen );
+        nBlockPos += nLen;
+        if( nLen == nAvail )
+            continue;
+
+        const GByte ch = pabyBlock[nBlockPos++];
+        if( ch == '"' )
+        {
+            if( !bTruncated )
+            {
+                abyRecord.push_back('"');
+                (*pnQuotes)++;
+            }
+        }
+        else if( ch == '\0' )
+        {
+            bTruncated = true;
+        }
+        else
+        {
+            if( nBlockPos == nBlockSize )
+                FillBlock();
+            if( nBlockPos < nBlockSize )
+            {
+                const GByte chNext = pabyBlock[nBlockPos];
+                if( (chNext == '\n' || chNext == '\r') && chNext != ch )
+                    nBlockPos++;
+            }
+            return true;
+        }
+    }
+}
+
+/************************************************************************/
+/*                             ReadRecord()                             */
+/*                                                                      */
+/*      Read the next record, which spans several lines when a quoted   */
+/*      string contains end of lines, and split it into tokens.  The    */
+/*      returned list, and its strings, are owned by the reader and     */
+/*      valid until the next call.                                      */
+/************************************************************************/
+
+char **OGRCSVRecordReader::ReadRecord()
+{
+    nRecordOffset = nBlockOffset + nBlockPos;
+    abyRecord.resize(0);
+
+    int nQuotes = 0;
+    if( fp == NULL || !ReadLine(&nQuotes) )
+        return NULL;
+
+    /* Skip BOM */
+    if( abyRecord.size() >= 3 &&
+        static_cast<GByte>(abyRecord[0]) == 0xEF &&
+        static_cast<GByte>(abyRecord[1]) == 0xBB &&
+        static_cast<GByte>(abyRecord[2]) == 0xBF )
+    {
+        abyRecord.erase( abyRecord.begin(), abyRecord.begin() + 3 );
+    }
+
+/* -------------------------------------------------------------------- */
+/*      As long as the number of quotes is odd, keep adding lines.      */
+/* -------------------------------------------------------------------- */
+    while( bHonourStrings && (nQuotes % 2) != 0 )
+    {
+        const size_t nSize = abyRecord.size();
+        // The '\n' gets lost in ReadLine().
+        abyRecord.push_back('\n');
+        if( !ReadLine(&nQuotes) )
+        {
+            abyRecord.resize(nSize);
+            break;
+        }
+    }
+    abyRecord.push_back('\0');
+
+    SplitRecord();
+
+    return &apszTokens[0];
+}
+
+/************************************************************************/
+/*                            SplitRecord()                             */
+/*                                                                      */
+/*      Same tokenization as CSVSplitLine(), or as                      */
+/*      CSLTokenizeStringComplex() when strings are not honoured, but   */
+/*      done in place : unquoted tokens are only nul terminated, and    */
+/*      quoted ones are shifted over their quotes.                      */
+/************************************************************************/
+
+void OGRCSVRecordReader::SplitRecord()
+{
+    apszTokens.resize(0);
+
+    char *pszIn = &abyRecord[0];
+    const char * const pszEnd = pszIn + abyRecord.size() - 1;
+    const GByte chQuote = bHonourStrings ? '"' : chDelimiter;
+
+    while( *pszIn != '\0' )
+    {
+        bool bInString = false;
+        char * const pszToken = pszIn;
+        char *pszOut = pszIn;
+
+        /* Try to find the next delimiter, marking end of token. */
+        while( true )
+        {
+            const size_t nRun = OGRCSVFindFirstOf(
+                reinterpret_cast<const GByte*>(pszIn), pszEnd - pszIn,
+                chDelimiter, chQuote, chDelimiter, chQuote );
+            if( pszOut != pszIn )
+                memmove( pszOut, pszIn, nRun );
+            pszOut += nRun;
+            pszIn += nRun;
+            if( pszIn == pszEnd )
+                break;
+
+            if( *pszIn == chDelimiter )
+            {
+                pszIn++;
+                if( !bInString )
+                {
+                    if( bMergeDelimiter )
+                    {
+                        while( *pszIn == chDelimiter )
+                            pszIn++;
+                    }
+                    break;
+                }
+                *pszOut++ = chDelimiter;
+            }
+            else if( !bInString || pszIn[1] != '"' )
+            {
+                bInString = !bInString;
+                pszIn++;
+            }
+            else  /* doubled quotes in string resolve to one quote */
+            {
+                pszIn += 2;
+                *pszOut++ = '"';
+            }
+        }
+
+        /* If the last token is an empty token, then we have to catch
+         * it now, otherwise we won't reenter the loop and it will be lost.
+         * The test must be done before nul terminating the token, which
+         * may overwrite the delimiter.
+         */
+        const bool bLastEmpty = *pszIn == '\0' && pszIn[-1] == chDelimiter;
+
+        *pszOut = '\0';
+        apszTokens.push_back( pszToken );
+        if( bLastEmpty )
+            apszTokens.push_back( pszOut );
+    }
+
+    apszTokens.push_back( NULL );
+}
+
 /************************************************************************/
 /*                            OGRCSVLayer()                             */
 /*                                                                      */
@@ -250,7 +559,17 @@ OGRCSVLayer::OGRCSVLayer( const char *pszLayerNameIn,
     bKeepSourceColumns(FALSE),
     bKeepGeomColumns(TRUE),
     bMergeDelimiter(FALSE),
-    bEmptyStringNull(FALSE)
+    bEmptyStringNull(FALSE),
+    bReaderStarted(false),
+    nReaderFID(1),
+    bFIDIndexComplete(false),
+    bFIDIndexOverflow(false),
+    bFIDIndexFileTried(false),
+    bFIDIndexFromFile(false),
+    bWriteFIDIndex(FALSE),
+    poThreadPool(NULL),
+    nPoolThreads(-1),
+    iBatchNext(0)
 {
     poFeatureDefn = new OGRFeatureDefn( pszLayerNameIn );
     SetDescription( poFeatureDefn->GetName() );
@@ -324,6 +643,8 @@ void OGRCSVLayer::BuildFeatureDefn( const char* pszNfdcGeomField,
         = CSLFetchBoolean(papszOpenOptions, "MERGE_SEPARATOR", FALSE);
     bEmptyStringNull
         = CSLFetchBoolean(papszOpenOptions, "EMPTY_STRING_AS_NULL", FALSE);
+    bWriteFIDIndex
+        = CSLFetchBoolean(papszOpenOptions, "WRITE_FID_INDEX", FALSE);
 
 /* -------------------------------------------------------------------- */
 /*      If this is not a new file, read ahead to establish if it is     */
@@ -1265,6 +1586,12 @@ OGRCSVLayer::~OGRCSVLayer()
     if ( bNew && bInWriteMode )
         WriteHeader();
 
+    ClearFeatureBatch();
+    delete poThreadPool;
+
+    if( bWriteFIDIndex )
+        SaveFIDIndex();
+
     CPLFree( panGeomFieldIndex );
 
     poFeatureDefn->Release();
@@ -1288,16 +1615,29 @@ void OGRCSVLayer::ResetReading()
         CSLDestroy( OGRCSVReadParseLineL( fpCSV, chDelimiter, bDontHonourStrings ) );
 
     bNeedRewindBeforeRead = FALSE;
+    bReaderStarted = false;
+    nReaderFID = 1;
+    ClearFeatureBatch();
 
     nNextFID = 1;
 }
 
 /************************************************************************/
 /*                        GetNextLineTokens()                           */
+/*                                                                      */
+/*      The returned tokens are owned by the record reader, and valid   */
+/*      until the next call.                                            */
 /************************************************************************/
 
 char** OGRCSVLayer::GetNextLineTokens()
 {
+/* -------------------------------------------------------------------- */
+/*      The record reader takes over the file from its current          */
+/*      position, that is after the header line.                        */
+/* -------------------------------------------------------------------- */
+    if( !bReaderStarted )
+        StartReader( VSIFTellL(fpCSV) );
+
 /* -------------------------------------------------------------------- */
 /*      Read the CSV record.                                            */
 /* -------------------------------------------------------------------- */
@@ -1305,40 +1645,347 @@ char** OGRCSVLayer::GetNextLineTokens()
 
     while( true )
     {
-        papszTokens = OGRCSVReadParseLineL( fpCSV, chDelimiter, bDontHonourStrings,
-                                            FALSE, bMergeDelimiter );
+        papszTokens = oReader.ReadRecord();
         if( papszTokens == NULL )
+        {
+            /* All the records have been indexed : the feature count */
+            /* is known. */
+            if( !bFIDIndexOverflow &&
+                anFIDIndexDelta.size() == static_cast<size_t>(nReaderFID - 1) )
+            {
+                bFIDIndexComplete = true;
+                if( nTotalFeatures < 0 )
+                    nTotalFeatures = nReaderFID - 1;
+            }
             return NULL;
+        }
 
         if( papszTokens[0] != NULL )
             break;
-
-        CSLDestroy(papszTokens);
     }
+
+    if( anFIDIndexDelta.size() == static_cast<size_t>(nReaderFID - 1) )
+        AddToFIDIndex( oReader.GetRecordOffset() );
+    nReaderFID ++;
+
     return papszTokens;
 }
 
 /************************************************************************/
-/*                             GetFeature()                             */
+/*                            StartReader()                             */
 /************************************************************************/
 
-OGRFeature* OGRCSVLayer::GetFeature(GIntBig nFID)
+void OGRCSVLayer::StartReader( vsi_l_offset nOffset )
 {
-    if( nFID < 1 || fpCSV == NULL )
-        return NULL;
-    if( nFID < nNextFID || bNeedRewindBeforeRead )
+    // Special fix to read NdfcFacilities.xls with un-balanced double quotes.
+    const bool bHonourStrings = !(chDelimiter == '\t' && bDontHonourStrings);
+    oReader.Start( fpCSV, nOffset, chDelimiter, bHonourStrings,
+                   bHonourStrings && bMergeDelimiter );
+    bReaderStarted = true;
+}
+
+/************************************************************************/
+/*                           AddToFIDIndex()                            */
+/*                                                                      */
+/*      Offsets are stored relative to the first record of their        */
+/*      group, on 4 bytes.  If a group spans more than 4 GB, the        */
+/*      index stops there, and further records are reached by reading   */
+/*      from the last indexed one.                                      */
+/************************************************************************/
+
+void OGRCSVLayer::AddToFIDIndex( vsi_l_offset nOffset )
+{
+    if( bFIDIndexOverflow )
+        return;
+    if( (anFIDIndexDelta.size() % CSV_FID_INDEX_GROUP) == 0 )
+    {
+        anFIDIndexBase.push_back( nOffset );
+        anFIDIndexDelta.push_back( 0 );
+        return;
+    }
+    const vsi_l_offset nDelta = nOffset - anFIDIndexBase.back();
+    if( nDelta > 0xFFFFFFFFU )
+    {
+        bFIDIndexOverflow = true;
+        return;
+    }
+    anFIDIndexDelta.push_back( static_cast<GUInt32>(nDelta) );
+}
+
+/************************************************************************/
+/*                             SeekToFID()                              */
+/*                                                                      */
+/*      Position the reading so that the next feature returned is the   */
+/*      one of FID nFID.  Returns false if there are less than nFID-1   */
+/*      features.                                                       */
+/************************************************************************/
+
+bool OGRCSVLayer::SeekToFID( GIntBig nFID )
+{
+    if( fpCSV == NULL )
+        return false;
+
+    LoadFIDIndex();
+
+/* -------------------------------------------------------------------- */
+/*      Jump to the closest indexed record, when going backward or      */
+/*      skipping records.                                               */
+/* -------------------------------------------------------------------- */
+    const GIntBig nIndexedFID =
+        MIN( nFID, static_cast<GIntBig>(anFIDIndexDelta.size()) );
+    if( nIndexedFID >= 1 &&
+        (nIndexedFID > nNextFID || nFID < nNextFID || bNeedRewindBeforeRead) )
+    {
+        const size_t iRecord = static_cast<size_t>(nIndexedFID - 1);
+        ClearFeatureBatch();
+        StartReader( anFIDIndexBase[iRecord / CSV_FID_INDEX_GROUP] +
+                     anFIDIndexDelta[iRecord] );
+        nReaderFID = static_cast<int>(nIndexedFID);
+        nNextFID = static_cast<int>(nIndexedFID);
+        bNeedRewindBeforeRead = FALSE;
+    }
+    else if( nFID < nNextFID || bNeedRewindBeforeRead )
         ResetReading();
+
+/* -------------------------------------------------------------------- */
+/*      Skip the records after it.                                      */
+/* -------------------------------------------------------------------- */
     while( nNextFID < nFID )
     {
-        char **papszTokens = GetNextLineTokens();
-        if( papszTokens == NULL )
-            return NULL;
-        CSLDestroy(papszTokens);
+        if( iBatchNext < apoBatchFeatures.size() )
+        {
+            delete apoBatchFeatures[iBatchNext];
+            apoBatchFeatures[iBatchNext] = NULL;
+            EmitBatchErrors( iBatchNext );
+            iBatchNext ++;
+        }
+        else if( GetNextLineTokens() == NULL )
+            return false;
         nNextFID ++;
     }
+    return true;
+}
+
+/************************************************************************/
+/*                        GetFIDIndexFilename()                         */
+/************************************************************************/
+
+CPLString OGRCSVLayer::GetFIDIndexFilename() const
+{
+    return CPLString(pszFilename) + ".fidx";
+}
+
+/************************************************************************/
+/*                         GetFIDIndexFlags()                           */
+/*                                                                      */
+/*      Reading options that change the records and their FIDs.         */
+/************************************************************************/
+
+GUInt32 OGRCSVLayer::GetFIDIndexFlags() const
+{
+    const bool bHonourStrings = !(chDelimiter == '\t' && bDontHonourStrings);
+    return static_cast<GByte>(chDelimiter) |
+           (bHonourStrings ? 0x100 : 0) |
+           (bHonourStrings && bMergeDelimiter ? 0x200 : 0) |
+           (bHasFieldNames ? 0x400 : 0);
+}
+
+/************************************************************************/
+/*                            LoadFIDIndex()                            */
+/*                                                                      */
+/*      Load the index written by a previous session with the           */
+/*      WRITE_FID_INDEX open option, if it matches the size and         */
+/*      modification time of the file.                                  */
+/************************************************************************/
+
+void OGRCSVLayer::LoadFIDIndex()
+{
+    if( bFIDIndexFileTried || bFIDIndexComplete || bInWriteMode )
+        return;
+    bFIDIndexFileTried = true;
+
+    const CPLString osIndexFilename( GetFIDIndexFilename() );
+    VSIStatBufL sStat;
+    VSIStatBufL sIndexStat;
+    if( VSIStatL(osIndexFilename, &sIndexStat) != 0 ||
+        VSIStatL(pszFilename, &sStat) != 0 )
+        return;
+
+    VSILFILE* fp = VSIFOpenL(osIndexFilename, "rb");
+    if( fp == NULL )
+        return;
+
+    char szMagic[8];
+    GUIntBig nFileSize = 0;
+    GIntBig nMTime = 0;
+    GUInt32 nIndexFlags = 0;
+    GUInt32 nGroupSize = 0;
+    GUIntBig nRecords = 0;
+    bool bOK = VSIFReadL(szMagic, 8, 1, fp) == 1 &&
+               VSIFReadL(&nFileSize, 8, 1, fp) == 1 &&
+               VSIFReadL(&nMTime, 8, 1, fp) == 1 &&
+               VSIFReadL(&nIndexFlags, 4, 1, fp) == 1 &&
+               VSIFReadL(&nGroupSize, 4, 1, fp) == 1 &&
+               VSIFReadL(&nRecords, 8, 1, fp) == 1;
+    CPL_LSBPTR64(&nFileSize);
+    CPL_LSBPTR64(&nMTime);
+    CPL_LSBPTR32(&nIndexFlags);
+    CPL_LSBPTR32(&nGroupSize);
+    CPL_LSBPTR64(&nRecords);
+    const vsi_l_offset nHeaderSize = 8 + 8 + 8 + 4 + 4 + 8;
+    const GUIntBig nGroups =
+        (nRecords + CSV_FID_INDEX_GROUP - 1) / CSV_FID_INDEX_GROUP;
+    if( !bOK || memcmp(szMagic, CSV_FID_INDEX_MAGIC, 8) != 0 ||
+        nFileSize != static_cast<GUIntBig>(sStat.st_size) ||
+        nMTime != static_cast<GIntBig>(sStat.st_mtime) ||
+        nIndexFlags != GetFIDIndexFlags() ||
+        nGroupSize != CSV_FID_INDEX_GROUP ||
+        nRecords >= static_cast<GUIntBig>(INT_MAX) ||
+        static_cast<GUIntBig>(sIndexStat.st_size) !=
+            nHeaderSize + nGroups * 8 + nRecords * 4 )
+    {
+        CPLDebug("CSV", "Ignoring %s, which does not match %s",
+                 osIndexFilename.c_str(), pszFilename);
+        VSIFCloseL(fp);
+        return;
+    }
+
+    std::vector<vsi_l_offset> anBase;
+    std::vector<GUInt32> anDelta;
+    try
+    {
+        anBase.resize( static_cast<size_t>(nGroups) );
+        anDelta.resize( static_cast<size_t>(nRecords) );
+    }
+    catch( const std::bad_alloc& )
+    {
+        CPLError(CE_Failure, CPLE_OutOfMemory,
+                 "Cannot allocate FID index of %s", pszFilename);
+        VSIFCloseL(fp);
+        return;
+    }
+    if( nRecords > 0 )
+    {
+        bOK = VSIFReadL(&anBase[0], 8, anBase.size(), fp) == anBase.size() &&
+              VSIFReadL(&anDelta[0], 4, anDelta.size(), fp) == anDelta.size();
+    }
+    VSIFCloseL(fp);
+    if( !bOK )
+        return;
+#ifdef CPL_MSB
+    for( size_t i = 0; i < anBase.size(); i++ )
+        CPL_LSBPTR64(&anBase[i]);
+    for( size_t i = 0; i < anDelta.size(); i++ )
+        CPL_LSBPTR32(&anDelta[i]);
+#endif
+
+    CPLDebug("CSV", "Using FID index %s", osIndexFilename.c_str());
+    anFIDIndexBase.swap(anBase);
+    anFIDIndexDelta.swap(anDelta);
+    bFIDIndexOverflow = false;
+    bFIDIndexComplete = true;
+    bFIDIndexFromFile = true;
+    nTotalFeatures = static_cast<GIntBig>(nRecords);
+}
+
+/************************************************************************/
+/*                            SaveFIDIndex()                            */
+/************************************************************************/
+
+void OGRCSVLayer::SaveFIDIndex()
+{
+    if( !bFIDIndexComplete || bFIDIndexFromFile || bInWriteMode ||
+        fpCSV == NULL )
+        return;
+
+    const CPLString osIndexFilename( GetFIDIndexFilename() );
+    VSIStatBufL sStat;
+    if( VSIStatL(pszFilename, &sStat) != 0 )
+        return;
+
+    VSILFILE* fp = VSIFOpenL(osIndexFilename, "wb");
+    if( fp == NULL )
+    {
+        CPLError(CE_Warning, CPLE_FileIO, "Cannot create %s",
+                 osIndexFilename.c_str());
+        return;
+    }
+
+    GUIntBig nFileSize = static_cast<GUIntBig>(sStat.st_size);
+    GIntBig nMTime = static_cast<GIntBig>(sStat.st_mtime);
+    GUInt32 nIndexFlags = GetFIDIndexFlags();
+    GUInt32 nGroupSize = static_cast<GUInt32>(CSV_FID_INDEX_GROUP);
+    GUIntBig nRecords = static_cast<GUIntBig>(anFIDIndexDelta.size());
+    CPL_LSBPTR64(&nFileSize);
+    CPL_LSBPTR64(&nMTime);
+    CPL_LSBPTR32(&nIndexFlags);
+    CPL_LSBPTR32(&nGroupSize);
+    CPL_LSBPTR64(&nRecords);
+    bool bOK = VSIFWriteL(CSV_FID_INDEX_MAGIC, 8, 1, fp) == 1 &&
+               VSIFWriteL(&nFileSize, 8, 1, fp) == 1 &&
+               VSIFWriteL(&nMTime, 8, 1, fp) == 1 &&
+               VSIFWriteL(&nIndexFlags, 4, 1, fp) == 1 &&
+               VSIFWriteL(&nGroupSize, 4, 1, fp) == 1 &&
+               VSIFWriteL(&nRecords, 8, 1, fp) == 1;
+    for( size_t i = 0; bOK && i < anFIDIndexBase.size(); i++ )
+    {
+        GUIntBig nVal = anFIDIndexBase[i];
+        CPL_LSBPTR64(&nVal);
+        bOK = VSIFWriteL(&nVal, 8, 1, fp) == 1;
+    }
+#ifdef CPL_MSB
+    for( size_t i = 0; bOK && i < anFIDIndexDelta.size(); i++ )
+    {
+        GUInt32 nVal = anFIDIndexDelta[i];
+        CPL_LSBPTR32(&nVal);
+        bOK = VSIFWriteL(&nVal, 4, 1, fp) == 1;
+    }
+#else
+    if( bOK && !anFIDIndexDelta.empty() )
+    {
+        bOK = VSIFWriteL(&anFIDIndexDelta[0], 4, anFIDIndexDelta.size(), fp)
+                == anFIDIndexDelta.size();
+    }
+#endif
+    if( VSIFCloseL(fp) != 0 )
+        bOK = false;
+    if( !bOK )
+    {
+        CPLError(CE_Warning, CPLE_FileIO, "Cannot write %s",
+                 osIndexFilename.c_str());
+        VSIUnlink(osIndexFilename);
+    }
+}
+
+/************************************************************************/
+/*                             GetFeature()                             */
+/************************************************************************/
+
+OGRFeature* OGRCSVLayer::GetFeature(GIntBig nFID)
+{
+    if( nFID < 1 || nFID > INT_MAX || fpCSV == NULL )
+        return NULL;
+    if( !SeekToFID(nFID) )
+        return NULL;
     return GetNextUnfilteredFeature();
 }
 
+/************************************************************************/
+/*                           SetNextByIndex()                           */
+/************************************************************************/
+
+OGRErr OGRCSVLayer::SetNextByIndex( GIntBig nIndex )
+{
+    if( m_poFilterGeom != NULL || m_poAttrQuery != NULL )
+        return OGRLayer::SetNextByIndex(nIndex);
+
+    if( nIndex < 0 || nIndex >= INT_MAX || fpCSV == NULL )
+        return OGRERR_FAILURE;
+    if( !SeekToFID(nIndex + 1) )
+        return OGRERR_FAILURE;
+    return OGRERR_NONE;
+}
+
 /************************************************************************/
 /*                      GetNextUnfilteredFeature()                      */
 /************************************************************************/
@@ -1349,13 +1996,261 @@ OGRFeature * OGRCSVLayer::GetNextUnfilteredFeature()
     if (fpCSV == NULL)
         return NULL;
 
+    OGRFeature *poFeature;
+
 /* -------------------------------------------------------------------- */
-/*      Read the CSV record.                                            */
+/*      Take the feature from the batch translated in advance, or       */
+/*      read and translate the CSV record.                              */
 /* -------------------------------------------------------------------- */
-    char **papszTokens = GetNextLineTokens();
-    if( papszTokens == NULL )
-        return NULL;
+    if( iBatchNext < apoBatchFeatures.size() )
+    {
+        poFeature = apoBatchFeatures[iBatchNext];
+        apoBatchFeatures[iBatchNext] = NULL;
+        EmitBatchErrors( iBatchNext );
+        iBatchNext ++;
+    }
+    else
+    {
+        char **papszTokens = GetNextLineTokens();
+        if( papszTokens == NULL )
+            return NULL;
 
+        CPLString osWarning;
+        poFeature = TranslateFeature( papszTokens, nNextFID,
+                                      CPL_TO_BOOL(bWarningBadTypeOrWidth),
+                                      osWarning );
+        EmitWarning( osWarning );
+    }
+
+/* -------------------------------------------------------------------- */
+/*      Translate the record id.                                        */
+/* -------------------------------------------------------------------- */
+    poFeature->SetFID( nNextFID++ );
+
+    m_nFeaturesRead++;
+
+    return poFeature;
+}
+
+/************************************************************************/
+/*                            EmitWarning()                             */
+/************************************************************************/
+
+void OGRCSVLayer::EmitWarning( const CPLString &osWarning )
+{
+    if( !osWarning.empty() && !bWarningBadTypeOrWidth )
+    {
+        bWarningBadTypeOrWidth = TRUE;
+        CPLError( CE_Warning, CPLE_AppDefined, "%s", osWarning.c_str() );
+    }
+}
+
+/************************************************************************/
+/*                          EmitBatchErrors()                           */
+/*                                                                      */
+/*      Emit the errors and warning of a record translated by a         */
+/*      worker thread, in the order TranslateFeature() raised them.     */
+/************************************************************************/
+
+void OGRCSVLayer::EmitBatchErrors( size_t iRecord )
+{
+    const std::vector<OGRCSVDeferredError>& aoErrors = aaoBatchErrors[iRecord];
+    for( size_t i = 0; i < aoErrors.size(); i++ )
+    {
+        CPLError( aoErrors[i].eErr, aoErrors[i].nErrNo, "%s",
+                  aoErrors[i].osMsg.c_str() );
+    }
+    EmitWarning( aosBatchWarnings[iRecord] );
+}
+
+/************************************************************************/
+/*                           GetThreadPool()                            */
+/************************************************************************/
+
+/* Worker threads translating records into features. NULL unless */
+/* GDAL_NUM_THREADS is set to more than 1 */
+CPLWorkerThreadPool* OGRCSVLayer::GetThreadPool()
+{
+    if( nPoolThreads < 0 )
+    {
+        nPoolThreads = 0;
+        const char* pszThreads = CPLGetConfigOption("GDAL_NUM_THREADS", NULL);
+        if( pszThreads != NULL )
+        {
+            nPoolThreads = EQUAL(pszThreads, "ALL_CPUS") ?
+                CPLGetNumCPUs() : atoi(pszThreads);
+            nPoolThreads = MIN(nPoolThreads, 128);
+        }
+        if( nPoolThreads > 1 )
+        {
+            poThreadPool = new CPLWorkerThreadPool();
+            if( !poThreadPool->Setup(nPoolThreads, NULL, NULL) )
+            {
+                delete poThreadPool;
+                poThreadPool = NULL;
+            }
+        }
+    }
+    return poThreadPool;
+}
+
+/************************************************************************/
+/*                      OGRCSVDeferErrorHandler()                       */
+/************************************************************************/
+
+static void CPL_STDCALL OGRCSVDeferErrorHandler( CPLErr eErr,
+                                                 CPLErrorNum nErrNo,
+                                                 const char *pszMsg )
+{
+    std::vector<OGRCSVDeferredError>* paoErrors =
+        static_cast<std::vector<OGRCSVDeferredError>*>(
+            CPLGetErrorHandlerUserData() );
+    OGRCSVDeferredError oError;
+    oError.eErr = eErr;
+    oError.nErrNo = nErrNo;
+    oError.osMsg = pszMsg;
+    paoErrors->push_back( oError );
+}
+
+/************************************************************************/
+/*                        TranslateFeaturesJob()                        */
+/************************************************************************/
+
+struct OGRCSVTranslateJob
+{
+    OGRCSVLayer        *poLayer;
+    size_t              iFirst;
+    size_t              iLast;
+    int                 nFirstFID;
+    bool                bWarningEmitted;
+    const size_t       *panRecordTokens;
+};
+
+void OGRCSVLayer::TranslateFeaturesJob( void *pData )
+{
+    OGRCSVTranslateJob* psJob = static_cast<OGRCSVTranslateJob*>(pData);
+    OGRCSVLayer* poLayer = psJob->poLayer;
+    for( size_t i = psJob->iFirst; i < psJob->iLast; i++ )
+    {
+        char** papszTokens =
+            &poLayer->apszBatchTokens[psJob->panRecordTokens[i]];
+        CPLPushErrorHandlerEx( OGRCSVDeferErrorHandler,
+                               &poLayer->aaoBatchErrors[i] );
+        CPLSetCurrentErrorHandlerCatchDebug( FALSE );
+        poLayer->apoBatchFeatures[i] = poLayer->TranslateFeature(
+            papszTokens, psJob->nFirstFID + static_cast<int>(i),
+            psJob->bWarningEmitted, poLayer->aosBatchWarnings[i] );
+        CPLPopErrorHandler();
+    }
+}
+
+/************************************************************************/
+/*                          FillFeatureBatch()                          */
+/*                                                                      */
+/*      Read the next records, and translate them into features on      */
+/*      the worker threads.  The features are then returned in order    */
+/*      by GetNextUnfilteredFeature(), which also emits the errors and  */
+/*      warnings so that they are the same as when reading              */
+/*      sequentially.                                                   */
+/************************************************************************/
+
+void OGRCSVLayer::FillFeatureBatch()
+{
+    CPLWorkerThreadPool* poPool = GetThreadPool();
+    if( poPool == NULL || fpCSV == NULL )
+        return;
+
+    ClearFeatureBatch();
+
+/* -------------------------------------------------------------------- */
+/*      Copy the tokens, as the reader reuses its buffer.               */
+/* -------------------------------------------------------------------- */
+    const size_t nMaxRecords = 256 * static_cast<size_t>(nPoolThreads);
+    const size_t nEndOfRecord = static_cast<size_t>(-1);
+    std::vector<size_t> anRecordTokens;
+    while( anRecordTokens.size() < nMaxRecords )
+    {
+        char **papszTokens = GetNextLineTokens();
+        if( papszTokens == NULL )
+            break;
+        anRecordTokens.push_back( anBatchTokenOffsets.size() );
+        for( ; *papszTokens != NULL; papszTokens++ )
+        {
+            anBatchTokenOffsets.push_back( abyBatchData.size() );
+            abyBatchData.insert( abyBatchData.end(), *papszTokens,
+                                 *papszTokens + strlen(*papszTokens) + 1 );
+        }
+        anBatchTokenOffsets.push_back( nEndOfRecord );
+    }
+
+    const size_t nRecords = anRecordTokens.size();
+    if( nRecords == 0 )
+        return;
+
+    apszBatchTokens.resize( anBatchTokenOffsets.size() );
+    for( size_t i = 0; i < anBatchTokenOffsets.size(); i++ )
+    {
+        apszBatchTokens[i] = (anBatchTokenOffsets[i] == nEndOfRecord) ?
+            NULL : &abyBatchData[anBatchTokenOffsets[i]];
+    }
+    apoBatchFeatures.resize( nRecords );
+    aosBatchWarnings.resize( nRecords );
+    aaoBatchErrors.resize( nRecords );
+
+/* -------------------------------------------------------------------- */
+/*      Translate one slice of records per thread, the first one in     */
+/*      the current thread.                                             */
+/* -------------------------------------------------------------------- */
+    const size_t nJobs = MIN( static_cast<size_t>(nPoolThreads), nRecords );
+    std::vector<OGRCSVTranslateJob> asJobs( nJobs );
+    std::vector<void*> apJobs;
+    for( size_t iJob = 0; iJob < nJobs; iJob++ )
+    {
+        asJobs[iJob].poLayer = this;
+        asJobs[iJob].iFirst = nRecords * iJob / nJobs;
+        asJobs[iJob].iLast = nRecords * (iJob + 1) / nJobs;
+        asJobs[iJob].nFirstFID = nNextFID;
+        asJobs[iJob].bWarningEmitted = CPL_TO_BOOL(bWarningBadTypeOrWidth);
+        asJobs[iJob].panRecordTokens = &anRecordTokens[0];
+        if( iJob > 0 )
+            apJobs.push_back( &asJobs[iJob] );
+    }
+    if( !apJobs.empty() )
+        poPool->SubmitJobs( TranslateFeaturesJob, apJobs );
+    TranslateFeaturesJob( &asJobs[0] );
+    poPool->WaitCompletion();
+}
+
+/************************************************************************/
+/*                         ClearFeatureBatch()                          */
+/************************************************************************/
+
+void OGRCSVLayer::ClearFeatureBatch()
+{
+    for( size_t i = iBatchNext; i < apoBatchFeatures.size(); i++ )
+        delete apoBatchFeatures[i];
+    apoBatchFeatures.resize(0);
+    aosBatchWarnings.resize(0);
+    aaoBatchErrors.resize(0);
+    apszBatchTokens.resize(0);
+    anBatchTokenOffsets.resize(0);
+    abyBatchData.resize(0);
+    iBatchNext = 0;
+}
+
+/************************************************************************/
+/*                          TranslateFeature()                          */
+/*                                                                      */
+/*      Build a feature from the tokens of a record. Does not modify    */
+/*      the layer so that it can run in worker threads : the first      */
+/*      warning is returned in osWarning, and left to EmitWarning().    */
+/************************************************************************/
+
+OGRFeature * OGRCSVLayer::TranslateFeature( char **papszTokens, int nFID,
+                                            bool bWarningEmitted,
+                                            CPLString &osWarning )
+
+{
 /* -------------------------------------------------------------------- */
 /*      Create the OGR feature.                                         */
 /* -------------------------------------------------------------------- */
@@ -1442,13 +2337,13 @@ OGRFeature * OGRCSVLayer::GetNextUnfilteredFeature()
                 {
                     poFeature->SetField( iOGRField, 0 );
                 }
-                else if( !bWarningBadTypeOrWidth )
+                else if( !bWarningEmitted )
                 {
-                    bWarningBadTypeOrWidth = TRUE;
-                    CPLError(CE_Warning, CPLE_AppDefined,
+                    bWarningEmitted = true;
+                    osWarning.Printf(
                                 "Invalid value type found in record %d for field %s. "
                                 "This warning will no longer be emitted",
-                                nNextFID, poFieldDefn->GetNameRef());
+                                nFID, poFieldDefn->GetNameRef());
                 }
             }
         }
@@ -1467,25 +2362,25 @@ OGRFeature * OGRCSVLayer::GetNextUnfilteredFeature()
                 if ( eType == CPL_VALUE_INTEGER || eType == CPL_VALUE_REAL )
                 {
                     poFeature->SetField( iOGRField, papszTokens[iAttr] );
-                    if( !bWarningBadTypeOrWidth &&
+                    if( !bWarningEmitted &&
                         (eFieldType == OFTInteger || eFieldType == OFTInteger64) && eType == CPL_VALUE_REAL )
                     {
-                        bWarningBadTypeOrWidth = TRUE;
-                        CPLError(CE_Warning, CPLE_AppDefined,
+                        bWarningEmitted = true;
+                        osWarning.Printf(
                                  "Invalid value type found in record %d for field %s. "
                                  "This warning will no longer be emitted",
-                                 nNextFID, poFieldDefn->GetNameRef());
+                                 nFID, poFieldDefn->GetNameRef());
                     }
-                    else if( !bWarningBadTypeOrWidth && poFieldDefn->GetWidth() > 0 &&
+                    else if( !bWarningEmitted && poFieldDefn->GetWidth() > 0 &&
                              (int)strlen(papszTokens[iAttr]) > poFieldDefn->GetWidth() )
                     {
-                        bWarningBadTypeOrWidth = TRUE;
-                        CPLError(CE_Warning, CPLE_AppDefined,
+                        bWarningEmitted = true;
+                        osWarning.Printf(
                                  "Value with a width greater than field width found in record %d for field %s. "
                                  "This warning will no longer be emitted",
-                                 nNextFID, poFieldDefn->GetNameRef());
+                                 nFID, poFieldDefn->GetNameRef());
                     }
-                    else if( !bWarningBadTypeOrWidth && eType == CPL_VALUE_REAL &&
+                    else if( !bWarningEmitted && eType == CPL_VALUE_REAL &&
                              poFieldDefn->GetWidth() > 0)
                     {
                         const char* pszDot = strchr(papszTokens[iAttr], '.');
@@ -1494,23 +2389,23 @@ OGRFeature * OGRCSVLayer::GetNextUnfilteredFeature()
                             nPrecision = static_cast<int>(strlen(pszDot + 1));
                         if( nPrecision > poFieldDefn->GetPrecision() )
                         {
-                             bWarningBadTypeOrWidth = TRUE;
-                            CPLError(CE_Warning, CPLE_AppDefined,
+                            bWarningEmitted = true;
+                            osWarning.Printf(
                                      "Value with a precision greater than field precision found in record %d for field %s. "
                                      "This warning will no longer be emitted",
-                                     nNextFID, poFieldDefn->GetNameRef());
+                                     nFID, poFieldDefn->GetNameRef());
                         }
                     }
                 }
                 else
                 {
-                    if( !bWarningBadTypeOrWidth )
+                    if( !bWarningEmitted )
                     {
-                        bWarningBadTypeOrWidth = TRUE;
-                        CPLError(CE_Warning, CPLE_AppDefined,
+                        bWarningEmitted = true;
+                        osWarning.Printf(
                                     "Invalid value type found in record %d for field %s. "
                                     "This warning will no longer be emitted",
-                                    nNextFID, poFieldDefn->GetNameRef());
+                                    nFID, poFieldDefn->GetNameRef());
                     }
                 }
             }
@@ -1520,13 +2415,13 @@ OGRFeature * OGRCSVLayer::GetNextUnfilteredFeature()
             if (papszTokens[iAttr][0] != '\0' && !poFieldDefn->IsIgnored())
             {
                 poFeature->SetField( iOGRField, papszTokens[iAttr] );
-                if( !bWarningBadTypeOrWidth && !poFeature->IsFieldSet(iOGRField) )
+                if( !bWarningEmitted && !poFeature->IsFieldSet(iOGRField) )
                 {
-                    bWarningBadTypeOrWidth = TRUE;
-                    CPLError(CE_Warning, CPLE_AppDefined,
+                    bWarningEmitted = true;
+                    osWarning.Printf(
                              "Invalid value type found in record %d for field %s. "
                              "This warning will no longer be emitted",
-                             nNextFID, poFieldDefn->GetNameRef());
+                             nFID, poFieldDefn->GetNameRef());
                 }
             }
         }
@@ -1536,14 +2431,14 @@ OGRFeature * OGRCSVLayer::GetNextUnfilteredFeature()
                 (!bEmptyStringNull || papszTokens[iAttr][0] != '\0') )
             {
                 poFeature->SetField( iOGRField, papszTokens[iAttr] );
-                if( !bWarningBadTypeOrWidth && poFieldDefn->GetWidth() > 0 &&
+                if( !bWarningEmitted && poFieldDefn->GetWidth() > 0 &&
                     (int)strlen(papszTokens[iAttr]) > poFieldDefn->GetWidth() )
                 {
-                    bWarningBadTypeOrWidth = TRUE;
-                    CPLError(CE_Warning, CPLE_AppDefined,
+                    bWarningEmitted = true;
+                    osWarning.Printf(
                                 "Value with a width greater than field width found in record %d for field %s. "
                                 "This warning will no longer be emitted",
-                                nNextFID, poFieldDefn->GetNameRef());
+                                nFID, poFieldDefn->GetNameRef());
                 }
             }
         }
@@ -1651,15 +2546,6 @@ OGRFeature * OGRCSVLayer::GetNextUnfilteredFeature()
         }
     }
 
-    CSLDestroy( papszTokens );
-
-/* -------------------------------------------------------------------- */
-/*      Translate the record id.                                        */
-/* -------------------------------------------------------------------- */
-    poFeature->SetFID( nNextFID++ );
-
-    m_nFeaturesRead++;
-
     return poFeature;
 }
 
@@ -1682,6 +2568,9 @@ OGRFeature *OGRCSVLayer::GetNextFeature()
 /* -------------------------------------------------------------------- */
     while( true )
     {
+        if( iBatchNext == apoBatchFeatures.size() )
+            FillFeatureBatch();
+
         poFeature = GetNextUnfilteredFeature();
         if( poFeature == NULL )
             break;
@@ -2089,6 +2978,9 @@ OGRErr OGRCSVLayer::ICreateFeature( OGRFeature *poNewFeature )
 
     bNeedRewindBeforeRead = TRUE;
 
+    /* Appended records will be indexed when read */
+    bFIDIndexComplete = false;
+
 /* -------------------------------------------------------------------- */
 /*      Write field names if we haven't written them yet.               */
 /*      Write .csvt file if needed                                      */
@@ -2336,6 +3228,10 @@ GIntBig OGRCSVLayer::GetFeatureCount( int bForce )
     if (fpCSV == NULL)
         return 0;
 
+    LoadFIDIndex();
+    if (nTotalFeatures >= 0)
+        return nTotalFeatures;
+
     ResetReading();
 
     if( chDelimiter == '\t' && bDontHonourStrings )
@@ -2377,8 +3273,6 @@ GIntBig OGRCSVLayer::GetFeatureCount( int bForce )
                 break;
 
             nTotalFeatures ++;
-
-            CSLDestroy(papszTokens);
         }
     }
 
@@ -34,6 +34,7 @@
 #include "cpl_string.h"
 #include "ogr_api.h"
 #include "cpl_time.h"
+#include <algorithm>
 #include <vector>
 
 CPL_CVSID("$Id$");
@@ -91,7 +92,9 @@ OGRGenSQLResultsLayer::OGRGenSQLResultsLayer( GDALDataset *poSrcDSIn,
                                               const char *pszDialect ) :
     poSrcLayer(NULL), pszWHERE(NULL), papoTableLayers(NULL), poDefn(NULL),
     panGeomFieldToSrcGeomField(NULL), nIndexSize(0),
-    panFIDIndex(NULL), bOrderByValid(FALSE), nNextIndexFID(0),
+    panFIDIndex(NULL), bOrderByValid(FALSE), fpFIDIndex(NULL),
+    nFIDIndexCacheStart(-1), fpSortRuns(NULL), nNextIndexFID(0),
+    nIteratedFeatures(0), bGroupByDone(FALSE), fpGroups(NULL),
     poSummaryFeature(NULL), iFIDFieldIndex(), nExtraDSCount(0), papoExtraDS(NULL)
 {
     swq_select *psSelectInfo = (swq_select *) pSelectInfoIn;
@@ -502,7 +505,8 @@ OGRGenSQLResultsLayer::~OGRGenSQLResultsLayer()
     CPLFree( papoTableLayers );
     papoTableLayers = NULL;
 
-    CPLFree( panFIDIndex );
+    InvalidateOrderByIndex();
+    ClearGroupBy();
     CPLFree( panGeomFieldToSrcGeomField );
 
     delete poSummaryFeature;
@@ -625,6 +629,7 @@ void OGRGenSQLResultsLayer::ResetReading()
     }
 
     nNextIndexFID = 0;
+    nIteratedFeatures = 0;
 }
 
 /************************************************************************/
@@ -643,11 +648,16 @@ OGRErr OGRGenSQLResultsLayer::SetNextByIndex( GIntBig nIndex )
 
     if( psSelectInfo->query_mode == SWQM_SUMMARY_RECORD
         || psSelectInfo->query_mode == SWQM_DISTINCT_LIST
+        || psSelectInfo->query_mode == SWQM_GROUP_BY
         || panFIDIndex != NULL )
     {
         nNextIndexFID = nIndex;
         return OGRERR_NONE;
     }
+    else if( psSelectInfo->limit >= 0 || psSelectInfo->offset > 0 )
+    {
+        return OGRLayer::SetNextByIndex( nIndex );
+    }
     else
     {
         return poSrcLayer->SetNextByIndex( nIndex );
@@ -690,6 +700,23 @@ OGRErr OGRGenSQLResultsLayer::GetExtent( int iGeomField,
         return OGRERR_FAILURE;
 }
 
+/************************************************************************/
+/*                     OGRGenSQLGetDistinctCount()                      */
+/*                                                                      */
+/*      Number of records of a DISTINCT list, after its OFFSET and      */
+/*      LIMIT.  Record i of the result is distinct_list[offset + i].    */
+/************************************************************************/
+
+static GIntBig OGRGenSQLGetDistinctCount( swq_select *psSelectInfo,
+                                          swq_summary *psSummary )
+{
+    GIntBig nCount = std::max( static_cast<GIntBig>(0),
+                               psSummary->count - psSelectInfo->offset );
+    if( psSelectInfo->limit >= 0 )
+        nCount = std::min( nCount, psSelectInfo->limit );
+    return nCount;
+}
+
 /************************************************************************/
 /*                          GetFeatureCount()                           */
 /************************************************************************/
@@ -711,12 +738,33 @@ GIntBig OGRGenSQLResultsLayer::GetFeatureCount( int bForce )
         if( psSummary == NULL )
             return 0;
 
-        return psSummary->count;
+        return OGRGenSQLGetDistinctCount( psSelectInfo, psSummary );
+    }
+    else if( psSelectInfo->query_mode == SWQM_GROUP_BY )
+    {
+        if( !PrepareGroupBy() )
+            return 0;
+
+        if( m_poAttrQuery != NULL )
+            return OGRLayer::GetFeatureCount( bForce );
+        if( fpGroups != NULL )
+            return static_cast<GIntBig>(anGroupOffsets.size());
+        return static_cast<GIntBig>(apoGroups.size());
     }
     else if( psSelectInfo->query_mode != SWQM_RECORDSET )
         return 1;
     else if( m_poAttrQuery == NULL && !MustEvaluateSpatialFilterOnGenSQL() )
-        return poSrcLayer->GetFeatureCount( bForce );
+    {
+        GIntBig nRet = poSrcLayer->GetFeatureCount( bForce );
+        if( nRet >= 0 )
+        {
+            nRet = std::max( static_cast<GIntBig>(0),
+                             nRet - psSelectInfo->offset );
+            if( psSelectInfo->limit >= 0 )
+                nRet = std::min( nRet, psSelectInfo->limit );
+        }
+        return nRet;
+    }
     else
         return OGRLayer::GetFeatureCount( bForce );
 }
@@ -734,8 +782,11 @@ int OGRGenSQLResultsLayer::TestCapability( const char *pszCap )
     {
         if( psSelectInfo->query_mode == SWQM_SUMMARY_RECORD
             || psSelectInfo->query_mode == SWQM_DISTINCT_LIST
+            || psSelectInfo->query_mode == SWQM_GROUP_BY
             || panFIDIndex != NULL )
             return TRUE;
+        else if( psSelectInfo->limit >= 0 || psSelectInfo->offset > 0 )
+            return FALSE;
         else
             return poSrcLayer->TestCapability( pszCap );
     }
@@ -810,46 +861,11 @@ int OGRGenSQLResultsLayer::PrepareSummary()
     ApplyFiltersToSource();
 
 /* -------------------------------------------------------------------- */
-/*      Ignore geometry reading if no spatial filter in place and that  */
-/*      the where clause and no column references OGR_GEOMETRY,         */
-/*      OGR_GEOM_WKT or OGR_GEOM_AREA special fields.                   */
+/*      Ignore geometry reading if not needed.                          */
 /* -------------------------------------------------------------------- */
     int bSaveIsGeomIgnored = poSrcLayer->GetLayerDefn()->IsGeometryIgnored();
-    if ( m_poFilterGeom == NULL && ( psSelectInfo->where_expr == NULL ||
-                !ContainGeomSpecialField(psSelectInfo->where_expr) ) )
-    {
-        int bFoundGeomExpr = FALSE;
-        for( int iField = 0; iField < psSelectInfo->result_columns; iField++ )
-        {
-            swq_col_def *psColDef = psSelectInfo->column_defs + iField;
-            if (psColDef->table_index == 0 && psColDef->field_index != -1)
-            {
-                OGRLayer* poLayer = papoTableLayers[psColDef->table_index];
-                int nSpecialFieldIdx = psColDef->field_index -
-                                poLayer->GetLayerDefn()->GetFieldCount();
-                if (nSpecialFieldIdx == SPF_OGR_GEOMETRY ||
-                    nSpecialFieldIdx == SPF_OGR_GEOM_WKT ||
-                    nSpecialFieldIdx == SPF_OGR_GEOM_AREA)
-                {
-                    bFoundGeomExpr = TRUE;
-                    break;
-                }
-                if( psColDef->field_index ==
-                        GEOM_FIELD_INDEX_TO_ALL_FIELD_INDEX(poLayer->GetLayerDefn(), 0) )
-                {
-                    bFoundGeomExpr = TRUE;
-                    break;
-                }
-            }
-            if (psColDef->expr != NULL && ContainGeomSpecialField(psColDef->expr))
-            {
-                bFoundGeomExpr = TRUE;
-                break;
-            }
-        }
-        if (!bFoundGeomExpr)
-            poSrcLayer->GetLayerDefn()->SetGeometryIgnored(TRUE);
-    }
+    if( !SummaryNeedsGeometry() )
+        poSrcLayer->GetLayerDefn()->SetGeometryIgnored(TRUE);
 
 /* -------------------------------------------------------------------- */
 /*      We treat COUNT(*) as a special case, and fill with              */
@@ -991,52 +1007,8 @@ int OGRGenSQLResultsLayer::PrepareSummary()
             swq_col_def *psColDef = psSelectInfo->column_defs + iField;
             if (psSelectInfo->column_summary != NULL)
             {
-                swq_summary *psSummary = psSelectInfo->column_summary + iField;
-
-                if( psColDef->col_func == SWQCF_AVG && psSummary->count > 0 )
-                {
-                    if( psColDef->field_type == SWQ_DATE ||
-                        psColDef->field_type == SWQ_TIME ||
-                        psColDef->field_type == SWQ_TIMESTAMP)
-                    {
-                        struct tm brokendowntime;
-                        double dfAvg = psSummary->sum / psSummary->count;
-                        CPLUnixTimeToYMDHMS((GIntBig)dfAvg, &brokendowntime);
-                        poSummaryFeature->SetField( iField,
-                                                    brokendowntime.tm_year + 1900,
-                                                    brokendowntime.tm_mon + 1,
-                                                    brokendowntime.tm_mday,
-                                                    brokendowntime.tm_hour,
-                                                    brokendowntime.tm_min,
-                                                    static_cast<float>(brokendowntime.tm_sec + fmod(dfAvg, 1)),
-                                                    0);
-                    }
-                    else
-                        poSummaryFeature->SetField( iField,
-                                                    psSummary->sum / psSummary->count );
-                }
-                else if( psColDef->col_func == SWQCF_MIN && psSummary->count > 0 )
-                {
-                    if( psColDef->field_type == SWQ_DATE ||
-                        psColDef->field_type == SWQ_TIME ||
-                        psColDef->field_type == SWQ_TIMESTAMP)
-                        poSummaryFeature->SetField( iField, psSummary->szMin );
-                    else
-                        poSummaryFeature->SetField( iField, psSummary->min );
-                }
-                else if( psColDef->col_func == SWQCF_MAX && psSummary->count > 0 )
-                {
-                    if( psColDef->field_type == SWQ_DATE ||
-                        psColDef->field_type == SWQ_TIME ||
-                        psColDef->field_type == SWQ_TIMESTAMP)
-                        poSummaryFeature->SetField( iField, psSummary->szMax );
-                    else
-                        poSummaryFeature->SetField( iField, psSummary->max );
-                }
-                else if( psColDef->col_func == SWQCF_COUNT )
-                    poSummaryFeature->SetField( iField, psSummary->count );
-                else if( psColDef->col_func == SWQCF_SUM && psSummary->count > 0 )
-                    poSummaryFeature->SetField( iField, psSummary->sum );
+                SetSummaryField( poSummaryFeature, iField,
+                                 psSelectInfo->column_summary + iField );
             }
             else if ( psColDef->col_func == SWQCF_COUNT )
                 poSummaryFeature->SetField( iField, 0 );
@@ -1046,6 +1018,117 @@ int OGRGenSQLResultsLayer::PrepareSummary()
     return TRUE;
 }
 
+/************************************************************************/
+/*                        SummaryNeedsGeometry()                        */
+/*                                                                      */
+/*      Geometry reading can be skipped if no spatial filter is in      */
+/*      place and if the where clause, the columns and the GROUP BY     */
+/*      keys do not reference OGR_GEOMETRY, OGR_GEOM_WKT or             */
+/*      OGR_GEOM_AREA special fields.                                   */
+/************************************************************************/
+
+int OGRGenSQLResultsLayer::SummaryNeedsGeometry()
+
+{
+    swq_select *psSelectInfo = (swq_select *) pSelectInfo;
+
+    if ( m_poFilterGeom != NULL || ( psSelectInfo->where_expr != NULL &&
+                ContainGeomSpecialField(psSelectInfo->where_expr) ) )
+        return TRUE;
+
+    for( int iField = 0; iField < psSelectInfo->result_columns; iField++ )
+    {
+        swq_col_def *psColDef = psSelectInfo->column_defs + iField;
+        if (psColDef->table_index == 0 && psColDef->field_index != -1)
+        {
+            OGRLayer* poLayer = papoTableLayers[psColDef->table_index];
+            int nSpecialFieldIdx = psColDef->field_index -
+                            poLayer->GetLayerDefn()->GetFieldCount();
+            if (nSpecialFieldIdx == SPF_OGR_GEOMETRY ||
+                nSpecialFieldIdx == SPF_OGR_GEOM_WKT ||
+                nSpecialFieldIdx == SPF_OGR_GEOM_AREA)
+                return TRUE;
+            if( psColDef->field_index ==
+                    GEOM_FIELD_INDEX_TO_ALL_FIELD_INDEX(poLayer->GetLayerDefn(), 0) )
+                return TRUE;
+        }
+        if (psColDef->expr != NULL && ContainGeomSpecialField(psColDef->expr))
+            return TRUE;
+    }
+
+    for( int iKey = 0; iKey < psSelectInfo->group_specs; iKey++ )
+    {
+        int nSpecialFieldIdx = psSelectInfo->group_defs[iKey].field_index -
+                                poSrcLayer->GetLayerDefn()->GetFieldCount();
+        if (nSpecialFieldIdx == SPF_OGR_GEOMETRY ||
+            nSpecialFieldIdx == SPF_OGR_GEOM_WKT ||
+            nSpecialFieldIdx == SPF_OGR_GEOM_AREA)
+            return TRUE;
+    }
+
+    return FALSE;
+}
+
+/************************************************************************/
+/*                          SetSummaryField()                           */
+/*                                                                      */
+/*      Set the value of a column function field from its summary.      */
+/************************************************************************/
+
+void OGRGenSQLResultsLayer::SetSummaryField( OGRFeature *poFeature,
+                                             int iField,
+                                             swq_summary *psSummary )
+
+{
+    swq_select *psSelectInfo = (swq_select *) pSelectInfo;
+    swq_col_def *psColDef = psSelectInfo->column_defs + iField;
+
+    if( psColDef->col_func == SWQCF_AVG && psSummary->count > 0 )
+    {
+        if( psColDef->field_type == SWQ_DATE ||
+            psColDef->field_type == SWQ_TIME ||
+            psColDef->field_type == SWQ_TIMESTAMP)
+        {
+            struct tm brokendowntime;
+            double dfAvg = psSummary->sum / psSummary->count;
+            CPLUnixTimeToYMDHMS((GIntBig)dfAvg, &brokendowntime);
+            poFeature->SetField( iField,
+                                 brokendowntime.tm_year + 1900,
+                                 brokendowntime.tm_mon + 1,
+                                 brokendowntime.tm_mday,
+                                 brokendowntime.tm_hour,
+                                 brokendowntime.tm_min,
+                                 static_cast<float>(brokendowntime.tm_sec + fmod(dfAvg, 1)),
+                                 0);
+        }
+        else
+            poFeature->SetField( iField,
+                                 psSummary->sum / psSummary->count );
+    }
+    else if( psColDef->col_func == SWQCF_MIN && psSummary->count > 0 )
+    {
+        if( psColDef->field_type == SWQ_DATE ||
+            psColDef->field_type == SWQ_TIME ||
+            psColDef->field_type == SWQ_TIMESTAMP)
+            poFeature->SetField( iField, psSummary->szMin );
+        else
+            poFeature->SetField( iField, psSummary->min );
+    }
+    else if( psColDef->col_func == SWQCF_MAX && psSummary->count > 0 )
+    {
+        if( psColDef->field_type == SWQ_DATE ||
+            psColDef->field_type == SWQ_TIME ||
+            psColDef->field_type == SWQ_TIMESTAMP)
+            poFeature->SetField( iField, psSummary->szMax );
+        else
+            poFeature->SetField( iField, psSummary->max );
+    }
+    else if( psColDef->col_func == SWQCF_COUNT )
+        poFeature->SetField( iField, psSummary->count );
+    else if( psColDef->col_func == SWQCF_SUM && psSummary->count > 0 )
+        poFeature->SetField( iField, psSummary->sum );
+}
+
 /************************************************************************/
 /*                       OGRMultiFeatureFetcher()                       */
 /************************************************************************/
@@ -1555,6 +1638,23 @@ OGRFeature *OGRGenSQLResultsLayer::GetNextFeature()
         || psSelectInfo->query_mode == SWQM_DISTINCT_LIST )
         return GetFeature( nNextIndexFID++ );
 
+/* -------------------------------------------------------------------- */
+/*      Handle GROUP BY results, filtered by the attribute filter of    */
+/*      this layer.                                                     */
+/* -------------------------------------------------------------------- */
+    if( psSelectInfo->query_mode == SWQM_GROUP_BY )
+    {
+        while( true )
+        {
+            OGRFeature *poFeature = GetFeature( nNextIndexFID++ );
+            if( poFeature == NULL )
+                return NULL;
+            if( m_poAttrQuery == NULL || m_poAttrQuery->Evaluate( poFeature ) )
+                return poFeature;
+            delete poFeature;
+        }
+    }
+
     int bEvaluateSpatialFilter = MustEvaluateSpatialFilterOnGenSQL();
 
 /* -------------------------------------------------------------------- */
@@ -1568,11 +1668,24 @@ OGRFeature *OGRGenSQLResultsLayer::GetNextFeature()
             poFeature =  GetFeature( nNextIndexFID++ );
         else
         {
+            // LIMIT and OFFSET apply to the records produced by the SELECT,
+            // before any filter installed on this result layer.
+            if( psSelectInfo->limit >= 0 &&
+                nIteratedFeatures - psSelectInfo->offset >=
+                                                    psSelectInfo->limit )
+                return NULL;
+
             OGRFeature *poSrcFeat = poSrcLayer->GetNextFeature();
 
             if( poSrcFeat == NULL )
                 return NULL;
 
+            if( nIteratedFeatures++ < psSelectInfo->offset )
+            {
+                delete poSrcFeat;
+                continue;
+            }
+
             poFeature = TranslateFeature( poSrcFeat );
             delete poSrcFeat;
         }
@@ -1627,11 +1740,13 @@ OGRFeature *OGRGenSQLResultsLayer::GetFeature( GIntBig nFID )
         if( psSummary == NULL )
             return NULL;
 
-        if( nFID < 0 || nFID >= psSummary->count )
+        if( nFID < 0 ||
+            nFID >= OGRGenSQLGetDistinctCount( psSelectInfo, psSummary ) )
             return NULL;
 
-        if( psSummary->distinct_list[nFID] != NULL )
-            poSummaryFeature->SetField( 0, psSummary->distinct_list[nFID] );
+        const GIntBig iValue = nFID + psSelectInfo->offset;
+        if( psSummary->distinct_list[iValue] != NULL )
+            poSummaryFeature->SetField( 0, psSummary->distinct_list[iValue] );
         else
             poSummaryFeature->UnsetField( 0 );
         poSummaryFeature->SetFID( nFID );
@@ -1639,6 +1754,17 @@ OGRFeature *OGRGenSQLResultsLayer::GetFeature( GIntBig nFID )
         return poSummaryFeature->Clone();
     }
 
+/* -------------------------------------------------------------------- */
+/*      Handle request for a GROUP BY result record.                    */
+/* -------------------------------------------------------------------- */
+    if( psSelectInfo->query_mode == SWQM_GROUP_BY )
+    {
+        if( !PrepareGroupBy() )
+            return NULL;
+
+        return GetGroupFeature( nFID );
+    }
+
 /* -------------------------------------------------------------------- */
 /*      Are we running in sorted mode?  If so, run the fid through      */
 /*      the index.                                                      */
@@ -1647,6 +1773,8 @@ OGRFeature *OGRGenSQLResultsLayer::GetFeature( GIntBig nFID )
     {
         if( nFID < 0 || nFID >= nIndexSize )
             return NULL;
+        else if( fpFIDIndex != NULL )
+            nFID = GetFIDFromIndexFile( nFID );
         else
             nFID = panFIDIndex[nFID];
     }
@@ -1714,12 +1842,15 @@ OGRFeatureDefn *OGRGenSQLResultsLayer::GetLayerDefn()
 /*                                                                      */
 /*      This is accomplished by making one pass through all the         */
 /*      eligible source features, and capturing the order by fields     */
-/*      of all records in memory.  A quick sort is then applied to      */
+/*      of all records in memory.  A merge sort is then applied to      */
 /*      this in memory copy of the order-by fields to create the        */
 /*      required index.                                                 */
 /*                                                                      */
-/*      Keeping all the key values in memory will *not* scale up to     */
-/*      very large input datasets.                                      */
+/*      When the key values do not fit in the memory budget set by      */
+/*      OGR_SQL_SORT_MAX_MEMORY, sorted runs are written to a           */
+/*      temporary file and merged afterwards.  When a LIMIT clause      */
+/*      is present, only the first OFFSET+LIMIT records are kept in     */
+/*      a bounded heap.                                                 */
 /************************************************************************/
 
 void OGRGenSQLResultsLayer::CreateOrderByIndex()
@@ -1743,6 +1874,31 @@ void OGRGenSQLResultsLayer::CreateOrderByIndex()
 
     ResetReading();
 
+/* -------------------------------------------------------------------- */
+/*      Establish the memory budget.  Each record costs its key         */
+/*      values, its FID and its index entry, plus any string copy.      */
+/* -------------------------------------------------------------------- */
+    const GIntBig nMaxMemory = std::max( static_cast<GIntBig>(1),
+        CPLAtoGIntBig(CPLGetConfigOption("OGR_SQL_SORT_MAX_MEMORY",
+                                         "268435456")) );
+    const GIntBig nRecordSize = static_cast<GIntBig>(
+        sizeof(OGRField) * nOrderItems + 2 * sizeof(GIntBig) );
+    const GIntBig nMaxRecords = std::max( static_cast<GIntBig>(1),
+                                          nMaxMemory / nRecordSize );
+
+/* -------------------------------------------------------------------- */
+/*      With a LIMIT clause, there is no need to sort more than the     */
+/*      first OFFSET+LIMIT records.                                     */
+/* -------------------------------------------------------------------- */
+    if( psSelectInfo->limit >= 0 &&
+        psSelectInfo->limit < nMaxRecords &&
+        psSelectInfo->offset < nMaxRecords - psSelectInfo->limit )
+    {
+        CreateTopKOrderByIndex( psSelectInfo->limit + psSelectInfo->offset );
+        ResetReading();
+        return;
+    }
+
 /* -------------------------------------------------------------------- */
 /*      Allocate set of key values, and the output index.               */
 /* -------------------------------------------------------------------- */
@@ -1757,11 +1913,55 @@ void OGRGenSQLResultsLayer::CreateOrderByIndex()
 /*      Read in all the key values.                                     */
 /* -------------------------------------------------------------------- */
     OGRFeature *poSrcFeat;
+    std::vector<vsi_l_offset> anRunOffsets;
+    GIntBig nStringBytes = 0;
     nIndexSize = 0;
 
     while( (poSrcFeat = poSrcLayer->GetNextFeature()) != NULL )
     {
-        int iKey;
+        // Over budget: sort what we have and spill it as a run.
+        if( nIndexSize > 0 &&
+            nIndexSize * nRecordSize + nStringBytes > nMaxMemory )
+        {
+            if( fpSortRuns == NULL )
+            {
+                osSortRunsFilename = CPLGenerateTempFilename("ogrsqlsort");
+                fpSortRuns = VSIFOpenL( osSortRunsFilename, "wb+" );
+                if( fpSortRuns == NULL )
+                {
+                    CPLError( CE_Failure, CPLE_FileIO,
+                              "Cannot create %s",
+                              osSortRunsFilename.c_str() );
+                }
+                else
+                {
+                    CPLDebug( "GenSQL",
+                              "Sort exceeds " CPL_FRMT_GIB " bytes. "
+                              "Using external merge sort in %s",
+                              nMaxMemory, osSortRunsFilename.c_str() );
+                }
+            }
+            if( fpSortRuns != NULL )
+                anRunOffsets.push_back( VSIFTellL(fpSortRuns) );
+            if( fpSortRuns == NULL ||
+                !WriteSortedRun( pasIndexFields, panFIDList, nIndexSize ) )
+            {
+                delete poSrcFeat;
+                FreeSortKeys( pasIndexFields, nIndexSize );
+                VSIFree(pasIndexFields);
+                VSIFree(panFIDList);
+                nIndexSize = 0;
+                if( fpSortRuns != NULL )
+                {
+                    VSIFCloseL( fpSortRuns );
+                    fpSortRuns = NULL;
+                    VSIUnlink( osSortRunsFilename );
+                }
+                return;
+            }
+            nIndexSize = 0;
+            nStringBytes = 0;
+        }
 
         if ((size_t)nIndexSize == nFeaturesAlloc)
         {
@@ -1770,6 +1970,8 @@ void OGRGenSQLResultsLayer::CreateOrderByIndex()
                     (GIntBig)sizeof(OGRField) * nOrderItems * nNewFeaturesAlloc )
             {
                 CPLError(CE_Failure, CPLE_AppDefined, "Cannot allocate pasIndexFields");
+                delete poSrcFeat;
+                FreeSortKeys( pasIndexFields, nIndexSize );
                 VSIFree(pasIndexFields);
                 VSIFree(panFIDList);
                 nIndexSize = 0;
@@ -1781,6 +1983,8 @@ void OGRGenSQLResultsLayer::CreateOrderByIndex()
             if (pasNewIndexFields == NULL)
             {
                 CPLError(CE_Failure, CPLE_AppDefined, "Cannot allocate pasIndexFields");
+                delete poSrcFeat;
+                FreeSortKeys( pasIndexFields, nIndexSize );
                 VSIFree(pasIndexFields);
                 VSIFree(panFIDList);
                 nIndexSize = 0;
@@ -1792,6 +1996,8 @@ void OGRGenSQLResultsLayer::CreateOrderByIndex()
                 VSI_REALLOC_VERBOSE(panFIDList, sizeof(GIntBig) *  (size_t)nNewFeaturesAlloc);
             if (panNewFIDList == NULL)
             {
+                delete poSrcFeat;
+                FreeSortKeys( pasIndexFields, nIndexSize );
                 VSIFree(pasIndexFields);
                 VSIFree(panFIDList);
                 nIndexSize = 0;
@@ -1799,63 +2005,14 @@ void OGRGenSQLResultsLayer::CreateOrderByIndex()
             }
             panFIDList = panNewFIDList;
 
-            memset(pasIndexFields + nFeaturesAlloc, 0,
+            memset(pasIndexFields + nFeaturesAlloc * nOrderItems, 0,
                    sizeof(OGRField) * nOrderItems * (size_t)(nNewFeaturesAlloc - nFeaturesAlloc));
 
             nFeaturesAlloc = (size_t)nNewFeaturesAlloc;
         }
 
-        for( iKey = 0; iKey < nOrderItems; iKey++ )
-        {
-            swq_order_def *psKeyDef = psSelectInfo->order_defs + iKey;
-            OGRFieldDefn *poFDefn;
-            OGRField *psSrcField, *psDstField;
-
-            psDstField = pasIndexFields + nIndexSize * nOrderItems + iKey;
-
-            if ( psKeyDef->field_index >= iFIDFieldIndex)
-            {
-                if ( psKeyDef->field_index < iFIDFieldIndex + SPECIAL_FIELD_COUNT )
-                {
-                    switch (SpecialFieldTypes[psKeyDef->field_index - iFIDFieldIndex])
-                    {
-                      case SWQ_INTEGER:
-                      case SWQ_INTEGER64:
-                        psDstField->Integer64 = poSrcFeat->GetFieldAsInteger64(psKeyDef->field_index);
-                        break;
-
-                      case SWQ_FLOAT:
-                        psDstField->Real = poSrcFeat->GetFieldAsDouble(psKeyDef->field_index);
-                        break;
-
-                      default:
-                        psDstField->String = CPLStrdup( poSrcFeat->GetFieldAsString(psKeyDef->field_index) );
-                        break;
-                    }
-                }
-                continue;
-            }
-
-            poFDefn = poSrcLayer->GetLayerDefn()->GetFieldDefn(
-                psKeyDef->field_index );
-
-            psSrcField = poSrcFeat->GetRawFieldRef( psKeyDef->field_index );
-
-            if( poFDefn->GetType() == OFTInteger
-                || poFDefn->GetType() == OFTInteger64
-                || poFDefn->GetType() == OFTReal
-                || poFDefn->GetType() == OFTDate
-                || poFDefn->GetType() == OFTTime
-                || poFDefn->GetType() == OFTDateTime)
-                memcpy( psDstField, psSrcField, sizeof(OGRField) );
-            else if( poFDefn->GetType() == OFTString )
-            {
-                if( poSrcFeat->IsFieldSet( psKeyDef->field_index ) )
-                    psDstField->String = CPLStrdup( psSrcField->String );
-                else
-                    memcpy( psDstField, psSrcField, sizeof(OGRField) );
-            }
-        }
+        nStringBytes += ReadSortKeys( poSrcFeat,
+                                      pasIndexFields + nIndexSize * nOrderItems );
 
         panFIDList[nIndexSize] = poSrcFeat->GetFID();
         delete poSrcFeat;
@@ -1865,12 +2022,43 @@ void OGRGenSQLResultsLayer::CreateOrderByIndex()
 
     //CPLDebug("GenSQL", "CreateOrderByIndex() = %d features", nIndexSize);
 
+/* -------------------------------------------------------------------- */
+/*      If runs were spilled, spill the last one and merge them all.    */
+/* -------------------------------------------------------------------- */
+    if( fpSortRuns != NULL )
+    {
+        bool bOK = true;
+        if( nIndexSize > 0 )
+        {
+            anRunOffsets.push_back( VSIFTellL(fpSortRuns) );
+            bOK = CPL_TO_BOOL(
+                WriteSortedRun( pasIndexFields, panFIDList, nIndexSize ) );
+            if( !bOK )
+                FreeSortKeys( pasIndexFields, nIndexSize );
+        }
+        VSIFree(pasIndexFields);
+        VSIFree(panFIDList);
+        nIndexSize = 0;
+
+        if( bOK )
+            MergeSortedRuns( anRunOffsets );
+
+        VSIFCloseL( fpSortRuns );
+        fpSortRuns = NULL;
+        VSIUnlink( osSortRunsFilename );
+
+        ResetReading();
+        return;
+    }
+
 /* -------------------------------------------------------------------- */
 /*      Initialize panFIDIndex                                          */
 /* -------------------------------------------------------------------- */
-    panFIDIndex = (GIntBig *) VSI_MALLOC_VERBOSE(sizeof(GIntBig) * (size_t)nIndexSize);
+    panFIDIndex = (GIntBig *) VSI_MALLOC_VERBOSE(sizeof(GIntBig) *
+                                    (size_t)std::max(nIndexSize, (GIntBig)1));
     if( panFIDIndex == NULL )
     {
+        FreeSortKeys( pasIndexFields, nIndexSize );
         VSIFree(pasIndexFields);
         VSIFree(panFIDList);
         nIndexSize = 0;
@@ -1884,6 +2072,7 @@ void OGRGenSQLResultsLayer::CreateOrderByIndex()
 /* -------------------------------------------------------------------- */
     if( !SortIndexSection( pasIndexFields, 0, nIndexSize ) )
     {
+        FreeSortKeys( pasIndexFields, nIndexSize );
         VSIFree(pasIndexFields);
         VSIFree(panFIDList);
         nIndexSize = 0;
@@ -1908,42 +2097,7 @@ void OGRGenSQLResultsLayer::CreateOrderByIndex()
 /* -------------------------------------------------------------------- */
 /*      Free the key field values.                                      */
 /* -------------------------------------------------------------------- */
-    for( int iKey = 0; iKey < nOrderItems; iKey++ )
-    {
-        swq_order_def *psKeyDef = psSelectInfo->order_defs + iKey;
-        OGRFieldDefn *poFDefn;
-
-        if ( psKeyDef->field_index >= iFIDFieldIndex &&
-            psKeyDef->field_index < iFIDFieldIndex + SPECIAL_FIELD_COUNT )
-        {
-            /* warning: only special fields of type string should be deallocated */
-            if (SpecialFieldTypes[psKeyDef->field_index - iFIDFieldIndex] == SWQ_STRING)
-            {
-                for( i = 0; i < nIndexSize; i++ )
-                {
-                    OGRField *psField = pasIndexFields + iKey + i * nOrderItems;
-                    CPLFree( psField->String );
-                }
-            }
-            continue;
-        }
-
-        poFDefn = poSrcLayer->GetLayerDefn()->GetFieldDefn(
-            psKeyDef->field_index );
-
-        if( poFDefn->GetType() == OFTString )
-        {
-            for( i = 0; i < nIndexSize; i++ )
-            {
-                OGRField *psField = pasIndexFields + iKey + i * nOrderItems;
-
-                if( psField->Set.nMarker1 != OGRUnsetMarker
-                    || psField->Set.nMarker2 != OGRUnsetMarker )
-                    CPLFree( psField->String );
-            }
-        }
-    }
-
+    FreeSortKeys( pasIndexFields, nIndexSize );
     CPLFree( pasIndexFields );
 
     /* If it is already sorted, then free than panFIDIndex array */
@@ -1958,46 +2112,1516 @@ void OGRGenSQLResultsLayer::CreateOrderByIndex()
 
         nIndexSize = 0;
     }
+    else
+    {
+        ApplyLimitToOrderByIndex();
+    }
 
     ResetReading();
 }
 
 /************************************************************************/
-/*                          SortIndexSection()                          */
+/*                        OGRGenSQLSeqSorter                            */
+/************************************************************************/
+
+namespace {
+struct OGRGenSQLSeqSorter
+{
+    const GIntBig *panSeq;
+
+    explicit OGRGenSQLSeqSorter( const GIntBig *panSeqIn ) : panSeq(panSeqIn) {}
+
+    bool operator()( GIntBig iFirst, GIntBig iSecond ) const
+    {
+        return panSeq[iFirst] < panSeq[iSecond];
+    }
+};
+}
+
+/************************************************************************/
+/*                       CreateTopKOrderByIndex()                       */
 /*                                                                      */
-/*      Sort the records in a section of the index.                     */
+/*      Build the index of the first nK records of the sorted           */
+/*      result, with a single pass over the source layer and a          */
+/*      max-heap of nK records: a new record replaces the heap top      */
+/*      when it sorts before it.  Records are numbered in reading       */
+/*      order so that ties are resolved as with the stable full sort.   */
 /************************************************************************/
 
-int OGRGenSQLResultsLayer::SortIndexSection( OGRField *pasIndexFields,
-                                              GIntBig nStart, GIntBig nEntries )
+void OGRGenSQLResultsLayer::CreateTopKOrderByIndex( GIntBig nK )
 
 {
-    if( nEntries < 2 )
-        return TRUE;
-
     swq_select *psSelectInfo = (swq_select *) pSelectInfo;
-    int      nOrderItems = psSelectInfo->order_specs;
+    const int nOrderItems = psSelectInfo->order_specs;
 
-    GIntBig nFirstGroup = nEntries / 2;
-    GIntBig nFirstStart = nStart;
-    GIntBig nSecondGroup = nEntries - nFirstGroup;
-    GIntBig nSecondStart = nStart + nFirstGroup;
-    GIntBig iMerge = 0;
-    GIntBig *panMerged;
+    nIndexSize = 0;
+    panFIDIndex = NULL;
 
-    if( !SortIndexSection( pasIndexFields, nFirstStart, nFirstGroup ) ||
-        !SortIndexSection( pasIndexFields, nSecondStart, nSecondGroup ) )
-        return FALSE;
+/* -------------------------------------------------------------------- */
+/*      Records are stored in slots.  The heap is an array of slot      */
+/*      numbers, and the next record is read in a spare slot.           */
+/* -------------------------------------------------------------------- */
+    GIntBig nSlotsAlloc = std::min( nK + 1, static_cast<GIntBig>(100) );
+    OGRField *pasSlotFields = (OGRField *)
+        CPLCalloc(sizeof(OGRField), nOrderItems * (size_t)nSlotsAlloc);
+    GIntBig *panSlotFID = (GIntBig *)
+        CPLMalloc(sizeof(GIntBig) * (size_t)nSlotsAlloc);
+    GIntBig *panSlotSeq = (GIntBig *)
+        CPLMalloc(sizeof(GIntBig) * (size_t)nSlotsAlloc);
+    GIntBig *panHeap = (GIntBig *)
+        CPLMalloc(sizeof(GIntBig) * (size_t)nSlotsAlloc);
+    GIntBig nHeapSize = 0;
+    GIntBig iSpareSlot = 0;
+    GIntBig nSeq = 0;
+    bool bOK = true;
+
+#define SLOT_FIELDS(iSlot) (pasSlotFields + (iSlot) * nOrderItems)
+#define SLOT_PRECEDES(iFirst, iSecond) \
+    (nResult = Compare( SLOT_FIELDS(iFirst), SLOT_FIELDS(iSecond) ), \
+     nResult > 0 || (nResult == 0 && panSlotSeq[iFirst] < panSlotSeq[iSecond]))
+
+    int nResult;
+    OGRFeature *poSrcFeat;
 
-    panMerged = (GIntBig *) VSI_MALLOC_VERBOSE( sizeof(GIntBig) * (size_t)nEntries );
-    if( panMerged == NULL )
+    while( nK > 0 && (poSrcFeat = poSrcLayer->GetNextFeature()) != NULL )
     {
-        return FALSE;
-    }
+        FreeSortKeys( SLOT_FIELDS(iSpareSlot), 1 );
+        ReadSortKeys( poSrcFeat, SLOT_FIELDS(iSpareSlot) );
+        panSlotFID[iSpareSlot] = poSrcFeat->GetFID();
+        panSlotSeq[iSpareSlot] = nSeq++;
+        delete poSrcFeat;
 
-    while( iMerge < nEntries )
-    {
-        int  nResult;
+        if( nHeapSize < nK )
+        {
+            // Sift the new record up.
+            GIntBig iChild = nHeapSize++;
+            panHeap[iChild] = iSpareSlot;
+            while( iChild > 0 )
+            {
+                const GIntBig iParent = (iChild - 1) / 2;
+                if( !SLOT_PRECEDES(panHeap[iParent], panHeap[iChild]) )
+                    break;
+                std::swap( panHeap[iParent], panHeap[iChild] );
+                iChild = iParent;
+            }
+
+            iSpareSlot = nHeapSize;
+            if( iSpareSlot == nSlotsAlloc )
+            {
+                const GIntBig nNewSlotsAlloc =
+                    std::min( nK + 1, nSlotsAlloc + nSlotsAlloc / 3 + 1 );
+                OGRField* pasNewSlotFields = (OGRField *)
+                    VSI_REALLOC_VERBOSE(pasSlotFields,
+                        sizeof(OGRField) * nOrderItems * (size_t)nNewSlotsAlloc);
+                if( pasNewSlotFields == NULL )
+                {
+                    bOK = false;
+                    break;
+                }
+                pasSlotFields = pasNewSlotFields;
+                memset( SLOT_FIELDS(nSlotsAlloc), 0, sizeof(OGRField) *
+                        nOrderItems * (size_t)(nNewSlotsAlloc - nSlotsAlloc) );
+
+                GIntBig* panNewSlotFID = (GIntBig *)
+                    VSI_REALLOC_VERBOSE(panSlotFID,
+                                sizeof(GIntBig) * (size_t)nNewSlotsAlloc);
+                if( panNewSlotFID != NULL )
+                    panSlotFID = panNewSlotFID;
+                GIntBig* panNewSlotSeq = (GIntBig *)
+                    VSI_REALLOC_VERBOSE(panSlotSeq,
+                                sizeof(GIntBig) * (size_t)nNewSlotsAlloc);
+                if( panNewSlotSeq != NULL )
+                    panSlotSeq = panNewSlotSeq;
+                GIntBig* panNewHeap = (GIntBig *)
+                    VSI_REALLOC_VERBOSE(panHeap,
+                                sizeof(GIntBig) * (size_t)nNewSlotsAlloc);
+                if( panNewHeap != NULL )
+                    panHeap = panNewHeap;
+                nSlotsAlloc = nNewSlotsAlloc;
+                if( panNewSlotFID == NULL || panNewSlotSeq == NULL ||
+                    panNewHeap == NULL )
+                {
+                    bOK = false;
+                    break;
+                }
+            }
+        }
+        else if( SLOT_PRECEDES(iSpareSlot, panHeap[0]) )
+        {
+            // Replace the last record of the heap and sift it down.
+            std::swap( iSpareSlot, panHeap[0] );
+            GIntBig iParent = 0;
+            while( true )
+            {
+                GIntBig iLast = iParent;
+                const GIntBig iLeft = 2 * iParent + 1;
+                const GIntBig iRight = iLeft + 1;
+                if( iLeft < nHeapSize &&
+                    SLOT_PRECEDES(panHeap[iLast], panHeap[iLeft]) )
+                    iLast = iLeft;
+                if( iRight < nHeapSize &&
+                    SLOT_PRECEDES(panHeap[iLast], panHeap[iRight]) )
+                    iLast = iRight;
+                if( iLast == iParent )
+                    break;
+                std::swap( panHeap[iParent], panHeap[iLast] );
+                iParent = iLast;
+            }
+        }
+    }
+
+#undef SLOT_PRECEDES
+#undef SLOT_FIELDS
+
+/* -------------------------------------------------------------------- */
+/*      Sort the retained records, in reading order first so that the   */
+/*      stable merge sort resolves ties the same way as a full sort.    */
+/* -------------------------------------------------------------------- */
+    if( bOK )
+    {
+        panFIDIndex = (GIntBig *) VSI_MALLOC_VERBOSE(sizeof(GIntBig) *
+                                    (size_t)std::max(nHeapSize, (GIntBig)1));
+        bOK = panFIDIndex != NULL;
+    }
+    if( bOK )
+    {
+        memcpy( panFIDIndex, panHeap, sizeof(GIntBig) * (size_t)nHeapSize );
+        std::sort( panFIDIndex, panFIDIndex + nHeapSize,
+                   OGRGenSQLSeqSorter(panSlotSeq) );
+        bOK = CPL_TO_BOOL(SortIndexSection( pasSlotFields, 0, nHeapSize ));
+    }
+
+    bool bAlreadySorted = true;
+    if( bOK )
+    {
+        nIndexSize = nHeapSize;
+        for( GIntBig i = 0; i < nIndexSize; i++ )
+        {
+            if( panSlotSeq[panFIDIndex[i]] != i )
+                bAlreadySorted = false;
+            panFIDIndex[i] = panSlotFID[panFIDIndex[i]];
+        }
+    }
+
+    FreeSortKeys( pasSlotFields, nSlotsAlloc );
+    CPLFree( pasSlotFields );
+    CPLFree( panSlotFID );
+    CPLFree( panSlotSeq );
+    CPLFree( panHeap );
+
+    // See CreateOrderByIndex(): sequential reading is then possible.
+    if( !bOK || bAlreadySorted )
+    {
+        CPLFree( panFIDIndex );
+        panFIDIndex = NULL;
+
+        nIndexSize = 0;
+    }
+    else
+    {
+        ApplyLimitToOrderByIndex();
+    }
+}
+
+/************************************************************************/
+/*                      ApplyLimitToOrderByIndex()                      */
+/*                                                                      */
+/*      Restrict the in-memory index to the OFFSET/LIMIT window.        */
+/************************************************************************/
+
+void OGRGenSQLResultsLayer::ApplyLimitToOrderByIndex()
+
+{
+    swq_select *psSelectInfo = (swq_select *) pSelectInfo;
+
+    const GIntBig nStart = std::min( psSelectInfo->offset, nIndexSize );
+    GIntBig nCount = nIndexSize - nStart;
+    if( psSelectInfo->limit >= 0 && nCount > psSelectInfo->limit )
+        nCount = psSelectInfo->limit;
+
+    if( nStart > 0 )
+        memmove( panFIDIndex, panFIDIndex + nStart,
+                 sizeof(GIntBig) * (size_t)nCount );
+    nIndexSize = nCount;
+}
+
+/************************************************************************/
+/*                          IsStringSortKey()                           */
+/************************************************************************/
+
+int OGRGenSQLResultsLayer::IsStringSortKey( int iKey )
+
+{
+    swq_select *psSelectInfo = (swq_select *) pSelectInfo;
+    swq_order_def *psKeyDef = psSelectInfo->order_defs + iKey;
+
+    if( psKeyDef->field_index >= iFIDFieldIndex )
+    {
+        return psKeyDef->field_index < iFIDFieldIndex + SPECIAL_FIELD_COUNT &&
+               SpecialFieldTypes[psKeyDef->field_index - iFIDFieldIndex] ==
+                                                                SWQ_STRING;
+    }
+
+    return poSrcLayer->GetLayerDefn()->GetFieldDefn(
+                        psKeyDef->field_index )->GetType() == OFTString;
+}
+
+/************************************************************************/
+/*                            ReadSortKeys()                            */
+/*                                                                      */
+/*      Capture the order by fields of a source feature.  Returns       */
+/*      the number of bytes allocated for string copies.                */
+/************************************************************************/
+
+size_t OGRGenSQLResultsLayer::ReadSortKeys( OGRFeature *poSrcFeat,
+                                            OGRField *pasDstFields )
+
+{
+    swq_select *psSelectInfo = (swq_select *) pSelectInfo;
+    const int nOrderItems = psSelectInfo->order_specs;
+    size_t nStringBytes = 0;
+
+    memset( pasDstFields, 0, sizeof(OGRField) * nOrderItems );
+
+    for( int iKey = 0; iKey < nOrderItems; iKey++ )
+    {
+        swq_order_def *psKeyDef = psSelectInfo->order_defs + iKey;
+        OGRFieldDefn *poFDefn;
+        OGRField *psSrcField, *psDstField;
+
+        psDstField = pasDstFields + iKey;
+
+        if ( psKeyDef->field_index >= iFIDFieldIndex)
+        {
+            if ( psKeyDef->field_index < iFIDFieldIndex + SPECIAL_FIELD_COUNT )
+            {
+                switch (SpecialFieldTypes[psKeyDef->field_index - iFIDFieldIndex])
+                {
+                  case SWQ_INTEGER:
+                  case SWQ_INTEGER64:
+                    psDstField->Integer64 = poSrcFeat->GetFieldAsInteger64(psKeyDef->field_index);
+                    break;
+
+                  case SWQ_FLOAT:
+                    psDstField->Real = poSrcFeat->GetFieldAsDouble(psKeyDef->field_index);
+                    break;
+
+                  default:
+                    psDstField->String = CPLStrdup( poSrcFeat->GetFieldAsString(psKeyDef->field_index) );
+                    nStringBytes += strlen(psDstField->String) + 1;
+                    break;
+                }
+            }
+            continue;
+        }
+
+        poFDefn = poSrcLayer->GetLayerDefn()->GetFieldDefn(
+            psKeyDef->field_index );
+
+        psSrcField = poSrcFeat->GetRawFieldRef( psKeyDef->field_index );
+
+        if( poFDefn->GetType() == OFTInteger
+            || poFDefn->GetType() == OFTInteger64
+            || poFDefn->GetType() == OFTReal
+            || poFDefn->GetType() == OFTDate
+            || poFDefn->GetType() == OFTTime
+            || poFDefn->GetType() == OFTDateTime)
+            memcpy( psDstField, psSrcField, sizeof(OGRField) );
+        else if( poFDefn->GetType() == OFTString )
+        {
+            if( poSrcFeat->IsFieldSet( psKeyDef->field_index ) )
+            {
+                psDstField->String = CPLStrdup( psSrcField->String );
+                nStringBytes += strlen(psDstField->String) + 1;
+            }
+            else
+                memcpy( psDstField, psSrcField, sizeof(OGRField) );
+        }
+    }
+
+    return nStringBytes;
+}
+
+/************************************************************************/
+/*                            FreeSortKeys()                            */
+/************************************************************************/
+
+void OGRGenSQLResultsLayer::FreeSortKeys( OGRField *pasIndexFields,
+                                          GIntBig nEntries )
+
+{
+    swq_select *psSelectInfo = (swq_select *) pSelectInfo;
+    const int nOrderItems = psSelectInfo->order_specs;
+
+    for( int iKey = 0; iKey < nOrderItems; iKey++ )
+    {
+        /* warning: only fields of type string should be deallocated */
+        if( !IsStringSortKey( iKey ) )
+            continue;
+
+        for( GIntBig i = 0; i < nEntries; i++ )
+        {
+            OGRField *psField = pasIndexFields + iKey + i * nOrderItems;
+
+            if( psField->Set.nMarker1 != OGRUnsetMarker
+                || psField->Set.nMarker2 != OGRUnsetMarker )
+            {
+                CPLFree( psField->String );
+                psField->String = NULL;
+            }
+        }
+    }
+}
+
+/************************************************************************/
+/*                           WriteSortedRun()                           */
+/*                                                                      */
+/*      Sort a section of records and append it to the runs file.       */
+/*      Each record is written as its FID followed by its keys,         */
+/*      strings being written as their length (-1 if unset) and         */
+/*      their bytes.  The key values are freed.                         */
+/************************************************************************/
+
+int OGRGenSQLResultsLayer::WriteSortedRun( OGRField *pasIndexFields,
+                                           GIntBig *panFIDList,
+                                           GIntBig nEntries )
+
+{
+    swq_select *psSelectInfo = (swq_select *) pSelectInfo;
+    const int nOrderItems = psSelectInfo->order_specs;
+
+    panFIDIndex = (GIntBig *) VSI_MALLOC_VERBOSE(sizeof(GIntBig) *
+                                                 (size_t)nEntries);
+    if( panFIDIndex == NULL )
+        return FALSE;
+    for( GIntBig i = 0; i < nEntries; i++ )
+        panFIDIndex[i] = i;
+
+    int bOK = SortIndexSection( pasIndexFields, 0, nEntries );
+
+    for( GIntBig i = 0; bOK && i < nEntries; i++ )
+    {
+        const GIntBig iRecord = panFIDIndex[i];
+        OGRField *pasFields = pasIndexFields + iRecord * nOrderItems;
+
+        bOK = VSIFWriteL( panFIDList + iRecord, sizeof(GIntBig), 1,
+                          fpSortRuns ) == 1;
+        for( int iKey = 0; bOK && iKey < nOrderItems; iKey++ )
+        {
+            OGRField *psField = pasFields + iKey;
+            if( !IsStringSortKey( iKey ) )
+            {
+                bOK = VSIFWriteL( psField, sizeof(OGRField), 1,
+                                  fpSortRuns ) == 1;
+            }
+            else if( psField->Set.nMarker1 == OGRUnsetMarker
+                     && psField->Set.nMarker2 == OGRUnsetMarker )
+            {
+                const GInt32 nLen = -1;
+                bOK = VSIFWriteL( &nLen, sizeof(nLen), 1, fpSortRuns ) == 1;
+            }
+            else
+            {
+                const GInt32 nLen =
+                    static_cast<GInt32>(strlen(psField->String));
+                bOK = VSIFWriteL( &nLen, sizeof(nLen), 1, fpSortRuns ) == 1 &&
+                      VSIFWriteL( psField->String, 1, nLen,
+                                  fpSortRuns ) == static_cast<size_t>(nLen);
+            }
+        }
+    }
+
+    if( !bOK )
+        CPLError( CE_Failure, CPLE_FileIO, "Cannot write to %s",
+                  osSortRunsFilename.c_str() );
+
+    CPLFree( panFIDIndex );
+    panFIDIndex = NULL;
+
+    if( bOK )
+        FreeSortKeys( pasIndexFields, nEntries );
+
+    return bOK;
+}
+
+/************************************************************************/
+/*                          OGRGenSQLSortRun                            */
+/*                                                                      */
+/*      Buffered sequential reader of one run of the runs file.         */
+/************************************************************************/
+
+namespace {
+class OGRGenSQLSortRun
+{
+    VSILFILE           *fp;
+    vsi_l_offset        nOffset;
+    vsi_l_offset        nEndOffset;
+    std::vector<GByte>  abyBuffer;
+    size_t              nBufferPos;
+    size_t              nBufferSize;
+
+  public:
+    OGRGenSQLSortRun( VSILFILE *fpIn, vsi_l_offset nStart,
+                      vsi_l_offset nEnd, size_t nBufferAlloc ) :
+        fp(fpIn), nOffset(nStart), nEndOffset(nEnd),
+        abyBuffer(nBufferAlloc), nBufferPos(0), nBufferSize(0) {}
+
+    bool IsEOF() const
+        { return nBufferPos == nBufferSize && nOffset == nEndOffset; }
+
+    bool Read( void *pBuffer, size_t nBytes );
+};
+
+bool OGRGenSQLSortRun::Read( void *pBuffer, size_t nBytes )
+{
+    GByte *pabyOut = static_cast<GByte *>(pBuffer);
+    while( nBytes > 0 )
+    {
+        if( nBufferPos == nBufferSize )
+        {
+            const size_t nToRead = static_cast<size_t>(
+                std::min( static_cast<vsi_l_offset>(abyBuffer.size()),
+                          nEndOffset - nOffset ) );
+            if( nToRead == 0 ||
+                VSIFSeekL( fp, nOffset, SEEK_SET ) != 0 ||
+                VSIFReadL( &abyBuffer[0], 1, nToRead, fp ) != nToRead )
+                return false;
+            nOffset += nToRead;
+            nBufferPos = 0;
+            nBufferSize = nToRead;
+        }
+        const size_t nChunk = std::min( nBytes, nBufferSize - nBufferPos );
+        memcpy( pabyOut, &abyBuffer[nBufferPos], nChunk );
+        nBufferPos += nChunk;
+        pabyOut += nChunk;
+        nBytes -= nChunk;
+    }
+    return true;
+}
+}
+
+/************************************************************************/
+/*                          MergeSortedRuns()                           */
+/*                                                                      */
+/*      K-way merge of the runs of the runs file.  The FIDs of the      */
+/*      OFFSET/LIMIT window of the result are written to another        */
+/*      temporary file, which backs the index from then on.  On a tie   */
+/*      the earliest run wins, which keeps the sort stable.             */
+/************************************************************************/
+
+#define FID_INDEX_CACHE_SIZE 4096
+
+int OGRGenSQLResultsLayer::MergeSortedRuns(
+                            const std::vector<vsi_l_offset>& anRunOffsets )
+
+{
+    swq_select *psSelectInfo = (swq_select *) pSelectInfo;
+    const int nOrderItems = psSelectInfo->order_specs;
+    const int nRuns = static_cast<int>(anRunOffsets.size());
+
+    CPLDebug( "GenSQL", "Merging %d sorted runs", nRuns );
+
+    osFIDIndexFilename = CPLGenerateTempFilename("ogrsqlsortfid");
+    fpFIDIndex = VSIFOpenL( osFIDIndexFilename, "wb+" );
+    if( fpFIDIndex == NULL )
+    {
+        CPLError( CE_Failure, CPLE_FileIO, "Cannot create %s",
+                  osFIDIndexFilename.c_str() );
+        return FALSE;
+    }
+
+    panFIDIndex = (GIntBig *) VSI_MALLOC_VERBOSE(sizeof(GIntBig) *
+                                                 FID_INDEX_CACHE_SIZE);
+    OGRField *pasRunFields = (OGRField *)
+        VSI_CALLOC_VERBOSE(sizeof(OGRField) * nOrderItems, nRuns);
+    GIntBig *panRunFID = (GIntBig *)
+        VSI_MALLOC_VERBOSE(sizeof(GIntBig) * nRuns);
+    bool *pabRunActive = (bool *) VSI_CALLOC_VERBOSE(sizeof(bool), nRuns);
+
+/* -------------------------------------------------------------------- */
+/*      Set up the run readers, sharing at most the memory budget.      */
+/* -------------------------------------------------------------------- */
+    const GIntBig nMaxMemory = std::max( static_cast<GIntBig>(1),
+        CPLAtoGIntBig(CPLGetConfigOption("OGR_SQL_SORT_MAX_MEMORY",
+                                         "268435456")) );
+    const size_t nBufferAlloc = static_cast<size_t>(
+        std::max( static_cast<GIntBig>(4096),
+                  std::min( static_cast<GIntBig>(65536),
+                            nMaxMemory / nRuns ) ) );
+
+    VSIFSeekL( fpSortRuns, 0, SEEK_END );
+    const vsi_l_offset nRunsFileSize = VSIFTellL( fpSortRuns );
+
+    std::vector<OGRGenSQLSortRun*> apoRuns;
+    for( int iRun = 0; iRun < nRuns; iRun++ )
+    {
+        apoRuns.push_back( new OGRGenSQLSortRun(
+            fpSortRuns, anRunOffsets[iRun],
+            iRun + 1 < nRuns ? anRunOffsets[iRun+1] : nRunsFileSize,
+            nBufferAlloc ) );
+    }
+
+    bool bOK = panFIDIndex != NULL && pasRunFields != NULL &&
+               panRunFID != NULL && pabRunActive != NULL;
+
+/* -------------------------------------------------------------------- */
+/*      Read the next record of a run, if any.                          */
+/* -------------------------------------------------------------------- */
+#define READ_RUN_RECORD(iRun) \
+    do { \
+        OGRGenSQLSortRun *poRun = apoRuns[iRun]; \
+        OGRField *pasFields = pasRunFields + (iRun) * nOrderItems; \
+        FreeSortKeys( pasFields, 1 ); \
+        pabRunActive[iRun] = !poRun->IsEOF(); \
+        if( !pabRunActive[iRun] ) \
+            break; \
+        bOK = poRun->Read( panRunFID + (iRun), sizeof(GIntBig) ); \
+        for( int iKey = 0; bOK && iKey < nOrderItems; iKey++ ) \
+        { \
+            if( !IsStringSortKey( iKey ) ) \
+            { \
+                bOK = poRun->Read( pasFields + iKey, sizeof(OGRField) ); \
+                continue; \
+            } \
+            GInt32 nLen = 0; \
+            bOK = poRun->Read( &nLen, sizeof(nLen) ); \
+            if( bOK && nLen < 0 ) \
+            { \
+                pasFields[iKey].Set.nMarker1 = OGRUnsetMarker; \
+                pasFields[iKey].Set.nMarker2 = OGRUnsetMarker; \
+            } \
+            else if( bOK ) \
+            { \
+                pasFields[iKey].String = (char *) CPLMalloc( nLen + 1 ); \
+                pasFields[iKey].String[nLen] = '\0'; \
+                bOK = poRun->Read( pasFields[iKey].String, nLen ); \
+            } \
+        } \
+    } while( false )
+
+    for( int iRun = 0; bOK && iRun < nRuns; iRun++ )
+        READ_RUN_RECORD(iRun);
+
+/* -------------------------------------------------------------------- */
+/*      Merge.                                                          */
+/* -------------------------------------------------------------------- */
+    GIntBig nOutput = 0;
+    int nCached = 0;
+    nIndexSize = 0;
+    while( bOK )
+    {
+        int iBest = -1;
+        for( int iRun = 0; iRun < nRuns; iRun++ )
+        {
+            if( pabRunActive[iRun] &&
+                (iBest < 0 ||
+                 Compare( pasRunFields + iRun * nOrderItems,
+                          pasRunFields + iBest * nOrderItems ) > 0) )
+                iBest = iRun;
+        }
+        if( iBest < 0 )
+            break;
+
+        if( nOutput >= psSelectInfo->offset )
+        {
+            if( psSelectInfo->limit >= 0 &&
+                nIndexSize == psSelectInfo->limit )
+                break;
+            panFIDIndex[nCached++] = panRunFID[iBest];
+            nIndexSize++;
+            if( nCached == FID_INDEX_CACHE_SIZE )
+            {
+                bOK = VSIFWriteL( panFIDIndex, sizeof(GIntBig), nCached,
+                                  fpFIDIndex ) == (size_t)nCached;
+                nCached = 0;
+            }
+        }
+        nOutput++;
+
+        READ_RUN_RECORD(iBest);
+    }
+
+#undef READ_RUN_RECORD
+
+    if( bOK && nCached > 0 )
+        bOK = VSIFWriteL( panFIDIndex, sizeof(GIntBig), nCached,
+                          fpFIDIndex ) == (size_t)nCached;
+
+    for( int iRun = 0; iRun < nRuns; iRun++ )
+        delete apoRuns[iRun];
+    if( pasRunFields != NULL )
+        FreeSortKeys( pasRunFields, nRuns );
+    CPLFree( pasRunFields );
+    CPLFree( panRunFID );
+    CPLFree( pabRunActive );
+
+    if( !bOK )
+    {
+        CPLError( CE_Failure, CPLE_FileIO,
+                  "External sort failed" );
+        InvalidateOrderByIndex();
+        // Do not retry the sort on next access.
+        bOrderByValid = TRUE;
+        return FALSE;
+    }
+
+    nFIDIndexCacheStart = -1;
+    return TRUE;
+}
+
+/************************************************************************/
+/*                        GetFIDFromIndexFile()                         */
+/************************************************************************/
+
+GIntBig OGRGenSQLResultsLayer::GetFIDFromIndexFile( GIntBig iIndex )
+
+{
+    const GIntBig nBlockStart =
+        (iIndex / FID_INDEX_CACHE_SIZE) * FID_INDEX_CACHE_SIZE;
+    if( nBlockStart != nFIDIndexCacheStart )
+    {
+        const size_t nToRead = static_cast<size_t>(
+            std::min( static_cast<GIntBig>(FID_INDEX_CACHE_SIZE),
+                      nIndexSize - nBlockStart ) );
+        if( VSIFSeekL( fpFIDIndex, static_cast<vsi_l_offset>(nBlockStart) *
+                                            sizeof(GIntBig), SEEK_SET ) != 0 ||
+            VSIFReadL( panFIDIndex, sizeof(GIntBig), nToRead,
+                       fpFIDIndex ) != nToRead )
+        {
+            nFIDIndexCacheStart = -1;
+            return OGRNullFID;
+        }
+        nFIDIndexCacheStart = nBlockStart;
+    }
+    return panFIDIndex[iIndex - nBlockStart];
+}
+
+/************************************************************************/
+/*                            OGRGenSQLGroup                            */
+/*                                                                      */
+/*      A group of a GROUP BY: its encoded key values, and the          */
+/*      summary of each aggregate column.                               */
+/************************************************************************/
+
+struct OGRGenSQLGroup
+{
+    char        *pszKey;
+    swq_summary *pasSummary;
+};
+
+static unsigned long OGRGenSQLGroupHash( const void *elt )
+{
+    return CPLHashSetHashStr(
+        static_cast<const OGRGenSQLGroup *>(elt)->pszKey );
+}
+
+static int OGRGenSQLGroupEqual( const void *elt1, const void *elt2 )
+{
+    return strcmp( static_cast<const OGRGenSQLGroup *>(elt1)->pszKey,
+                   static_cast<const OGRGenSQLGroup *>(elt2)->pszKey ) == 0;
+}
+
+static void OGRGenSQLGroupFree( OGRGenSQLGroup *psGroup )
+{
+    CPLFree( psGroup->pszKey );
+    CPLFree( psGroup->pasSummary );
+    delete psGroup;
+}
+
+/************************************************************************/
+/*                       OGRGenSQLGetKeyValue()                         */
+/*                                                                      */
+/*      Group keys are encoded as the concatenation, for each GROUP BY  */
+/*      field, of "-" for a null value, or of the length of the value   */
+/*      as a string, ':' and the value.                                 */
+/************************************************************************/
+
+static bool OGRGenSQLGetKeyValue( const char *pszKey, int iKey,
+                                  CPLString &osValue )
+{
+    for( int i = 0; ; i++ )
+    {
+        if( *pszKey == '-' )
+        {
+            if( i == iKey )
+                return false;
+            pszKey++;
+            continue;
+        }
+        const size_t nLen = static_cast<size_t>(atoi(pszKey));
+        pszKey = strchr(pszKey, ':') + 1;
+        if( i == iKey )
+        {
+            osValue.assign( pszKey, nLen );
+            return true;
+        }
+        pszKey += nLen;
+    }
+}
+
+/************************************************************************/
+/*                         OGRGenSQLGroupSorter                         */
+/*                                                                      */
+/*      Order groups according to ORDER BY, whose fields are all        */
+/*      GROUP BY keys, then by the GROUP BY keys, and finally by the    */
+/*      encoded key to get a total order.                               */
+/************************************************************************/
+
+namespace {
+struct OGRGenSQLGroupOrderKey
+{
+    int            iKey;
+    swq_field_type eType;
+    int            bAscending;
+};
+
+struct OGRGenSQLGroupSorter
+{
+    const std::vector<OGRGenSQLGroupOrderKey> *paoOrderKeys;
+
+    explicit OGRGenSQLGroupSorter(
+            const std::vector<OGRGenSQLGroupOrderKey> *paoOrderKeysIn ) :
+        paoOrderKeys(paoOrderKeysIn) {}
+
+    int Compare( const char *pszKey1, const char *pszKey2 ) const;
+
+    bool operator()( const OGRGenSQLGroup *psGroup1,
+                     const OGRGenSQLGroup *psGroup2 ) const
+    {
+        return Compare( psGroup1->pszKey, psGroup2->pszKey ) < 0;
+    }
+};
+
+int OGRGenSQLGroupSorter::Compare( const char *pszKey1,
+                                   const char *pszKey2 ) const
+{
+    CPLString osValue1, osValue2;
+    for( size_t i = 0; i < paoOrderKeys->size(); i++ )
+    {
+        const OGRGenSQLGroupOrderKey &oKey = (*paoOrderKeys)[i];
+        const bool bSet1 = OGRGenSQLGetKeyValue( pszKey1, oKey.iKey, osValue1 );
+        const bool bSet2 = OGRGenSQLGetKeyValue( pszKey2, oKey.iKey, osValue2 );
+        int nResult = 0;
+
+        // Null values sort first, as in Compare()
+        if( !bSet1 || !bSet2 )
+            nResult = (bSet1 ? 1 : 0) - (bSet2 ? 1 : 0);
+        else if( oKey.eType == SWQ_INTEGER || oKey.eType == SWQ_INTEGER64 ||
+                 oKey.eType == SWQ_BOOLEAN )
+        {
+            const GIntBig nVal1 = CPLAtoGIntBig(osValue1);
+            const GIntBig nVal2 = CPLAtoGIntBig(osValue2);
+            nResult = (nVal1 < nVal2) ? -1 : (nVal1 > nVal2) ? 1 : 0;
+        }
+        else if( oKey.eType == SWQ_FLOAT )
+        {
+            const double dfVal1 = CPLAtof(osValue1);
+            const double dfVal2 = CPLAtof(osValue2);
+            nResult = (dfVal1 < dfVal2) ? -1 : (dfVal1 > dfVal2) ? 1 : 0;
+        }
+        else
+            nResult = strcmp( osValue1, osValue2 );
+
+        if( nResult != 0 )
+            return oKey.bAscending ? nResult : -nResult;
+    }
+    return strcmp( pszKey1, pszKey2 );
+}
+}
+
+/************************************************************************/
+/*                           BuildGroupKey()                            */
+/************************************************************************/
+
+void OGRGenSQLResultsLayer::BuildGroupKey( OGRFeature *poSrcFeat,
+                                           CPLString &osKey )
+
+{
+    swq_select *psSelectInfo = (swq_select *) pSelectInfo;
+    OGRFeatureDefn *poSrcDefn = poSrcLayer->GetLayerDefn();
+
+    osKey.resize(0);
+    for( int iKey = 0; iKey < psSelectInfo->group_specs; iKey++ )
+    {
+        const int iSrcField = psSelectInfo->group_defs[iKey].field_index;
+        if( !poSrcFeat->IsFieldSet( iSrcField ) )
+        {
+            osKey += '-';
+            continue;
+        }
+
+        const char *pszValue;
+        // Make sure that real values are not truncated
+        if( iSrcField < iFIDFieldIndex &&
+            poSrcDefn->GetFieldDefn(iSrcField)->GetType() == OFTReal )
+            pszValue = CPLSPrintf( "%.17g",
+                                   poSrcFeat->GetFieldAsDouble(iSrcField) );
+        else
+            pszValue = poSrcFeat->GetFieldAsString( iSrcField );
+
+        osKey += CPLSPrintf( "%d:", static_cast<int>(strlen(pszValue)) );
+        osKey += pszValue;
+    }
+}
+
+/************************************************************************/
+/*                          AccumulateGroup()                           */
+/************************************************************************/
+
+void OGRGenSQLResultsLayer::AccumulateGroup( OGRGenSQLGroup *psGroup,
+                                             OGRFeature *poSrcFeat )
+
+{
+    swq_select *psSelectInfo = (swq_select *) pSelectInfo;
+
+    for( size_t i = 0; i < anAggregateColumns.size(); i++ )
+    {
+        swq_col_def *psColDef =
+            psSelectInfo->column_defs + anAggregateColumns[i];
+        swq_summary *psSummary = psGroup->pasSummary + i;
+        const int iSrcField = psColDef->field_index;
+
+        if( psColDef->col_func == SWQCF_COUNT )
+        {
+            /* psColDef->field_index can be -1 in the case of a COUNT(*) */
+            if( iSrcField < 0 )
+                psSummary->count++;
+            else if( IS_GEOM_FIELD_INDEX(poSrcLayer->GetLayerDefn(), iSrcField) )
+            {
+                if( poSrcFeat->GetGeomFieldRef(
+                        ALL_FIELD_INDEX_TO_GEOM_FIELD_INDEX(
+                            poSrcLayer->GetLayerDefn(), iSrcField)) != NULL )
+                    psSummary->count++;
+            }
+            else if( poSrcFeat->IsFieldSet( iSrcField ) )
+                psSummary->count++;
+        }
+        else if( !poSrcFeat->IsFieldSet( iSrcField ) )
+        {
+            /* nothing to do */
+        }
+        else if( psColDef->field_type == SWQ_DATE ||
+                 psColDef->field_type == SWQ_TIME ||
+                 psColDef->field_type == SWQ_TIMESTAMP )
+        {
+            swq_summary_add_value( psColDef, psSummary,
+                                   poSrcFeat->GetFieldAsString( iSrcField ) );
+        }
+        else
+        {
+            // Numeric values do not need to go through strings
+            const double dfValue = poSrcFeat->GetFieldAsDouble( iSrcField );
+            psSummary->count++;
+            psSummary->sum += dfValue;
+            if( dfValue < psSummary->min )
+                psSummary->min = dfValue;
+            if( dfValue > psSummary->max )
+                psSummary->max = dfValue;
+        }
+    }
+}
+
+/************************************************************************/
+/*                      OGRGenSQLGetGroupKeyType()                      */
+/************************************************************************/
+
+static swq_field_type OGRGenSQLGetGroupKeyType( OGRFeatureDefn *poSrcDefn,
+                                                int iFIDFieldIndex,
+                                                int iSrcField )
+
+{
+    if( iSrcField >= iFIDFieldIndex )
+        return SpecialFieldTypes[iSrcField - iFIDFieldIndex];
+
+    switch( poSrcDefn->GetFieldDefn(iSrcField)->GetType() )
+    {
+      case OFTInteger:
+        return SWQ_INTEGER;
+      case OFTInteger64:
+        return SWQ_INTEGER64;
+      case OFTReal:
+        return SWQ_FLOAT;
+      default:
+        return SWQ_STRING;
+    }
+}
+
+/************************************************************************/
+/*                     OGRGenSQLGetGroupOrderKeys()                     */
+/*                                                                      */
+/*      The ORDER BY fields, followed by the GROUP BY fields in         */
+/*      ascending order, so that groups are sorted the same way         */
+/*      whether they were spilled to disk or not.                       */
+/************************************************************************/
+
+static void OGRGenSQLGetGroupOrderKeys(
+                        swq_select *psSelectInfo, OGRFeatureDefn *poSrcDefn,
+                        int iFIDFieldIndex,
+                        std::vector<OGRGenSQLGroupOrderKey> &aoOrderKeys )
+
+{
+    for( int i = 0; i < psSelectInfo->order_specs; i++ )
+    {
+        swq_order_def *psOrderDef = psSelectInfo->order_defs + i;
+        OGRGenSQLGroupOrderKey oKey;
+        oKey.iKey = psSelectInfo->GetGroupByKey( psOrderDef->table_index,
+                                                 psOrderDef->field_index );
+        oKey.bAscending = psOrderDef->ascending_flag;
+        oKey.eType = OGRGenSQLGetGroupKeyType( poSrcDefn, iFIDFieldIndex,
+                                               psOrderDef->field_index );
+        aoOrderKeys.push_back( oKey );
+    }
+
+    for( int i = 0; i < psSelectInfo->group_specs; i++ )
+    {
+        OGRGenSQLGroupOrderKey oKey;
+        oKey.iKey = i;
+        oKey.bAscending = TRUE;
+        oKey.eType = OGRGenSQLGetGroupKeyType(
+                            poSrcDefn, iFIDFieldIndex,
+                            psSelectInfo->group_defs[i].field_index );
+        aoOrderKeys.push_back( oKey );
+    }
+}
+
+/************************************************************************/
+/*                             SortGroups()                             */
+/************************************************************************/
+
+void OGRGenSQLResultsLayer::SortGroups(
+                        std::vector<OGRGenSQLGroup*> &apoGroupsToSort )
+
+{
+    std::vector<OGRGenSQLGroupOrderKey> aoOrderKeys;
+    OGRGenSQLGetGroupOrderKeys( (swq_select *) pSelectInfo,
+                                poSrcLayer->GetLayerDefn(), iFIDFieldIndex,
+                                aoOrderKeys );
+
+    std::sort( apoGroupsToSort.begin(), apoGroupsToSort.end(),
+               OGRGenSQLGroupSorter(&aoOrderKeys) );
+}
+
+/************************************************************************/
+/*                             WriteGroup()                             */
+/*                                                                      */
+/*      A group is written as the length of its key, the key and the    */
+/*      summaries.                                                      */
+/************************************************************************/
+
+int OGRGenSQLResultsLayer::WriteGroup( VSILFILE *fp, const char *pszKey,
+                                       const swq_summary *pasSummary )
+
+{
+    const GInt32 nKeyLen = static_cast<GInt32>(strlen(pszKey));
+    const size_t nSummaries = anAggregateColumns.size();
+    return VSIFWriteL( &nKeyLen, sizeof(nKeyLen), 1, fp ) == 1 &&
+           VSIFWriteL( pszKey, 1, nKeyLen, fp ) == static_cast<size_t>(nKeyLen) &&
+           (nSummaries == 0 ||
+            VSIFWriteL( pasSummary, sizeof(swq_summary), nSummaries,
+                        fp ) == nSummaries);
+}
+
+/************************************************************************/
+/*                           WriteGroupRun()                            */
+/*                                                                      */
+/*      Sort the groups and append them to the runs file, and free      */
+/*      them.                                                           */
+/************************************************************************/
+
+int OGRGenSQLResultsLayer::WriteGroupRun(
+                            std::vector<OGRGenSQLGroup*> &apoRunGroups )
+
+{
+    SortGroups( apoRunGroups );
+
+    int bOK = TRUE;
+    for( size_t i = 0; i < apoRunGroups.size(); i++ )
+    {
+        if( bOK )
+            bOK = WriteGroup( fpSortRuns, apoRunGroups[i]->pszKey,
+                              apoRunGroups[i]->pasSummary );
+        OGRGenSQLGroupFree( apoRunGroups[i] );
+    }
+    apoRunGroups.clear();
+
+    if( !bOK )
+        CPLError( CE_Failure, CPLE_FileIO, "Cannot write to %s",
+                  osSortRunsFilename.c_str() );
+    return bOK;
+}
+
+/************************************************************************/
+/*                        OGRGenSQLReadRunGroup()                       */
+/*                                                                      */
+/*      Read the next group of a run of groups, if any.                 */
+/************************************************************************/
+
+static bool OGRGenSQLReadRunGroup( OGRGenSQLSortRun *poRun, bool &bActive,
+                                   CPLString &osKey,
+                                   swq_summary *pasSummary,
+                                   size_t nSummaries )
+{
+    bActive = !poRun->IsEOF();
+    if( !bActive )
+        return true;
+    GInt32 nKeyLen = 0;
+    if( !poRun->Read( &nKeyLen, sizeof(nKeyLen) ) || nKeyLen < 0 )
+        return false;
+    osKey.resize( nKeyLen );
+    return (nKeyLen == 0 || poRun->Read( &osKey[0], nKeyLen )) &&
+           (nSummaries == 0 ||
+            poRun->Read( pasSummary, sizeof(swq_summary) * nSummaries ));
+}
+
+/************************************************************************/
+/*                           MergeGroupRuns()                           */
+/*                                                                      */
+/*      K-way merge of the runs of groups.  The partial summaries of    */
+/*      a group found in several runs are combined, and the groups of   */
+/*      the OFFSET/LIMIT window are written to the groups file.         */
+/************************************************************************/
+
+int OGRGenSQLResultsLayer::MergeGroupRuns(
+                            const std::vector<vsi_l_offset>& anRunOffsets )
+
+{
+    swq_select *psSelectInfo = (swq_select *) pSelectInfo;
+    const int nRuns = static_cast<int>(anRunOffsets.size());
+    const size_t nSummaries = anAggregateColumns.size();
+
+    CPLDebug( "GenSQL", "Merging %d runs of groups", nRuns );
+
+    osGroupsFilename = CPLGenerateTempFilename("ogrsqlgroups");
+    fpGroups = VSIFOpenL( osGroupsFilename, "wb+" );
+    if( fpGroups == NULL )
+    {
+        CPLError( CE_Failure, CPLE_FileIO, "Cannot create %s",
+                  osGroupsFilename.c_str() );
+        return FALSE;
+    }
+
+    const GIntBig nMaxMemory = std::max( static_cast<GIntBig>(1),
+        CPLAtoGIntBig(CPLGetConfigOption("OGR_SQL_GROUP_BY_MAX_MEMORY",
+                                         "268435456")) );
+    const size_t nBufferAlloc = static_cast<size_t>(
+        std::max( static_cast<GIntBig>(4096),
+                  std::min( static_cast<GIntBig>(65536),
+                            nMaxMemory / nRuns ) ) );
+
+    VSIFSeekL( fpSortRuns, 0, SEEK_END );
+    const vsi_l_offset nRunsFileSize = VSIFTellL( fpSortRuns );
+
+    std::vector<OGRGenSQLSortRun*> apoRuns;
+    std::vector<CPLString> aosRunKeys( nRuns );
+    std::vector<swq_summary> asRunSummaries( nRuns * nSummaries + 1 );
+    std::vector<bool> abRunActive( nRuns );
+    for( int iRun = 0; iRun < nRuns; iRun++ )
+    {
+        apoRuns.push_back( new OGRGenSQLSortRun(
+            fpSortRuns, anRunOffsets[iRun],
+            iRun + 1 < nRuns ? anRunOffsets[iRun+1] : nRunsFileSize,
+            nBufferAlloc ) );
+    }
+
+    std::vector<OGRGenSQLGroupOrderKey> aoOrderKeys;
+    OGRGenSQLGetGroupOrderKeys( psSelectInfo, poSrcLayer->GetLayerDefn(),
+                                iFIDFieldIndex, aoOrderKeys );
+    const OGRGenSQLGroupSorter oSorter( &aoOrderKeys );
+
+    bool bOK = true;
+    for( int iRun = 0; bOK && iRun < nRuns; iRun++ )
+    {
+        bool bActive = false;
+        bOK = OGRGenSQLReadRunGroup( apoRuns[iRun], bActive,
+                                     aosRunKeys[iRun],
+                                     &asRunSummaries[iRun * nSummaries],
+                                     nSummaries );
+        abRunActive[iRun] = bActive;
+    }
+
+/* -------------------------------------------------------------------- */
+/*      Merge.  Runs are sorted on the full key, so that the partial    */
+/*      summaries of a group come out adjacent.                         */
+/* -------------------------------------------------------------------- */
+    CPLString osCurKey;
+    std::vector<swq_summary> asCurSummaries( nSummaries + 1 );
+    bool bHasCur = false;
+    GIntBig nOutput = 0;
+
+    while( bOK )
+    {
+        int iBest = -1;
+        for( int iRun = 0; iRun < nRuns; iRun++ )
+        {
+            if( abRunActive[iRun] &&
+                (iBest < 0 ||
+                 oSorter.Compare( aosRunKeys[iRun], aosRunKeys[iBest] ) < 0) )
+                iBest = iRun;
+        }
+
+        if( iBest >= 0 && bHasCur && osCurKey == aosRunKeys[iBest] )
+        {
+            for( size_t i = 0; i < nSummaries; i++ )
+            {
+                swq_summary_merge(
+                    psSelectInfo->column_defs + anAggregateColumns[i],
+                    &asCurSummaries[i],
+                    &asRunSummaries[iBest * nSummaries + i] );
+            }
+        }
+        else
+        {
+            if( bHasCur )
+            {
+                if( psSelectInfo->limit >= 0 &&
+                    static_cast<GIntBig>(anGroupOffsets.size()) ==
+                                                    psSelectInfo->limit )
+                    break;
+                if( nOutput >= psSelectInfo->offset )
+                {
+                    anGroupOffsets.push_back( VSIFTellL(fpGroups) );
+                    bOK = CPL_TO_BOOL(WriteGroup( fpGroups, osCurKey,
+                                                  &asCurSummaries[0] ));
+                }
+                nOutput++;
+            }
+            if( iBest < 0 )
+                break;
+            osCurKey = aosRunKeys[iBest];
+            if( nSummaries > 0 )
+                memcpy( &asCurSummaries[0],
+                        &asRunSummaries[iBest * nSummaries],
+                        sizeof(swq_summary) * nSummaries );
+            bHasCur = true;
+        }
+
+        if( bOK )
+        {
+            bool bActive = false;
+            bOK = OGRGenSQLReadRunGroup( apoRuns[iBest], bActive,
+                                         aosRunKeys[iBest],
+                                         &asRunSummaries[iBest * nSummaries],
+                                         nSummaries );
+            abRunActive[iBest] = bActive;
+        }
+    }
+
+    for( int iRun = 0; iRun < nRuns; iRun++ )
+        delete apoRuns[iRun];
+
+    if( !bOK )
+    {
+        CPLError( CE_Failure, CPLE_FileIO, "GROUP BY merge failed" );
+        VSIFCloseL( fpGroups );
+        fpGroups = NULL;
+        VSIUnlink( osGroupsFilename );
+        anGroupOffsets.clear();
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+/************************************************************************/
+/*                           PrepareGroupBy()                           */
+/*                                                                      */
+/*      Streaming hash aggregation of the source features.  When the    */
+/*      groups exceed the memory budget set by                          */
+/*      OGR_SQL_GROUP_BY_MAX_MEMORY, they are sorted and spilled to a   */
+/*      temporary file, and the runs are merged at the end.             */
+/************************************************************************/
+
+int OGRGenSQLResultsLayer::PrepareGroupBy()
+
+{
+    swq_select *psSelectInfo = (swq_select *) pSelectInfo;
+
+    if( bGroupByDone )
+        return TRUE;
+    bGroupByDone = TRUE;
+
+    anAggregateColumns.clear();
+    for( int iField = 0; iField < psSelectInfo->result_columns; iField++ )
+    {
+        if( psSelectInfo->column_defs[iField].col_func != SWQCF_NONE )
+            anAggregateColumns.push_back( iField );
+    }
+    const size_t nSummaries = anAggregateColumns.size();
+
+    const GIntBig nMaxMemory = std::max( static_cast<GIntBig>(1),
+        CPLAtoGIntBig(CPLGetConfigOption("OGR_SQL_GROUP_BY_MAX_MEMORY",
+                                         "268435456")) );
+
+/* -------------------------------------------------------------------- */
+/*      Ensure our query parameters are in place on the source          */
+/*      layer.  And initialize reading.                                 */
+/* -------------------------------------------------------------------- */
+    ApplyFiltersToSource();
+
+    int bSaveIsGeomIgnored = poSrcLayer->GetLayerDefn()->IsGeometryIgnored();
+    if( !SummaryNeedsGeometry() )
+        poSrcLayer->GetLayerDefn()->SetGeometryIgnored(TRUE);
+
+/* -------------------------------------------------------------------- */
+/*      Aggregate.                                                      */
+/* -------------------------------------------------------------------- */
+    CPLHashSet *hSet = CPLHashSetNew( OGRGenSQLGroupHash,
+                                      OGRGenSQLGroupEqual, NULL );
+    std::vector<vsi_l_offset> anRunOffsets;
+    GIntBig nMemUsed = 0;
+    CPLString osKey;
+    OGRGenSQLGroup sLookup;
+    OGRFeature *poSrcFeat;
+    bool bOK = true;
+
+    while( bOK && (poSrcFeat = poSrcLayer->GetNextFeature()) != NULL )
+    {
+        BuildGroupKey( poSrcFeat, osKey );
+        sLookup.pszKey = const_cast<char*>(osKey.c_str());
+        OGRGenSQLGroup *psGroup = static_cast<OGRGenSQLGroup *>(
+                                        CPLHashSetLookup( hSet, &sLookup ) );
+        if( psGroup == NULL )
+        {
+            // Over budget: spill the groups as a sorted run.
+            if( nMemUsed > nMaxMemory && !apoGroups.empty() )
+            {
+                if( fpSortRuns == NULL )
+                {
+                    osSortRunsFilename =
+                        CPLGenerateTempFilename("ogrsqlgroupruns");
+                    fpSortRuns = VSIFOpenL( osSortRunsFilename, "wb+" );
+                    if( fpSortRuns == NULL )
+                    {
+                        CPLError( CE_Failure, CPLE_FileIO,
+                                  "Cannot create %s",
+                                  osSortRunsFilename.c_str() );
+                        delete poSrcFeat;
+                        bOK = false;
+                        break;
+                    }
+                    CPLDebug( "GenSQL",
+                              "GROUP BY exceeds " CPL_FRMT_GIB " bytes. "
+                              "Spilling groups to %s",
+                              nMaxMemory, osSortRunsFilename.c_str() );
+                }
+                anRunOffsets.push_back( VSIFTellL(fpSortRuns) );
+                CPLHashSetClear( hSet );
+                nMemUsed = 0;
+                if( !WriteGroupRun( apoGroups ) )
+                {
+                    delete poSrcFeat;
+                    bOK = false;
+                    break;
+                }
+            }
+
+            psGroup = new OGRGenSQLGroup;
+            psGroup->pszKey = CPLStrdup( osKey );
+            psGroup->pasSummary = static_cast<swq_summary *>(
+                CPLMalloc( sizeof(swq_summary) * (nSummaries + 1) ) );
+            for( size_t i = 0; i < nSummaries; i++ )
+                swq_summary_init( psGroup->pasSummary + i );
+            apoGroups.push_back( psGroup );
+            CPLHashSetInsert( hSet, psGroup );
+
+            // Approximate cost of a group, including hash set node.
+            nMemUsed += sizeof(OGRGenSQLGroup) + osKey.size() + 1 +
+                        sizeof(swq_summary) * nSummaries +
+                        4 * sizeof(void*);
+        }
+
+        AccumulateGroup( psGroup, poSrcFeat );
+        delete poSrcFeat;
+    }
+
+    CPLHashSetDestroy( hSet );
+
+    poSrcLayer->GetLayerDefn()->SetGeometryIgnored(bSaveIsGeomIgnored);
+
+    ClearFilters();
+
+/* -------------------------------------------------------------------- */
+/*      If groups were spilled, spill the last ones and merge them      */
+/*      all.                                                            */
+/* -------------------------------------------------------------------- */
+    if( fpSortRuns != NULL )
+    {
+        if( bOK && !apoGroups.empty() )
+        {
+            anRunOffsets.push_back( VSIFTellL(fpSortRuns) );
+            bOK = CPL_TO_BOOL(WriteGroupRun( apoGroups ));
+        }
+        ClearGroupBy();
+        bGroupByDone = TRUE;
+
+        if( bOK )
+            bOK = CPL_TO_BOOL(MergeGroupRuns( anRunOffsets ));
+
+        VSIFCloseL( fpSortRuns );
+        fpSortRuns = NULL;
+        VSIUnlink( osSortRunsFilename );
+
+        return bOK;
+    }
+
+    if( !bOK )
+    {
+        ClearGroupBy();
+        bGroupByDone = TRUE;
+        return FALSE;
+    }
+
+/* -------------------------------------------------------------------- */
+/*      Otherwise, sort the groups in the same order as the merge of    */
+/*      spilled runs would produce.  Then apply OFFSET/LIMIT.           */
+/* -------------------------------------------------------------------- */
+    SortGroups( apoGroups );
+
+    const size_t nStart = static_cast<size_t>(
+        std::min( psSelectInfo->offset,
+                  static_cast<GIntBig>(apoGroups.size()) ) );
+    size_t nEnd = apoGroups.size();
+    if( psSelectInfo->limit >= 0 &&
+        psSelectInfo->limit < static_cast<GIntBig>(nEnd - nStart) )
+        nEnd = nStart + static_cast<size_t>(psSelectInfo->limit);
+    for( size_t i = 0; i < apoGroups.size(); i++ )
+    {
+        if( i < nStart || i >= nEnd )
+            OGRGenSQLGroupFree( apoGroups[i] );
+    }
+    apoGroups.erase( apoGroups.begin() + nEnd, apoGroups.end() );
+    apoGroups.erase( apoGroups.begin(), apoGroups.begin() + nStart );
+
+    return TRUE;
+}
+
+/************************************************************************/
+/*                          GetGroupFeature()                           */
+/************************************************************************/
+
+OGRFeature *OGRGenSQLResultsLayer::GetGroupFeature( GIntBig nFID )
+
+{
+    swq_select *psSelectInfo = (swq_select *) pSelectInfo;
+    const size_t nSummaries = anAggregateColumns.size();
+
+    CPLString osKey;
+    std::vector<swq_summary> asSummaries( nSummaries + 1 );
+
+    if( fpGroups != NULL )
+    {
+        if( nFID < 0 || nFID >= static_cast<GIntBig>(anGroupOffsets.size()) )
+            return NULL;
+
+        GInt32 nKeyLen = 0;
+        if( VSIFSeekL( fpGroups, anGroupOffsets[static_cast<size_t>(nFID)],
+                       SEEK_SET ) != 0 ||
+            VSIFReadL( &nKeyLen, sizeof(nKeyLen), 1, fpGroups ) != 1 ||
+            nKeyLen < 0 )
+            return NULL;
+        osKey.resize( nKeyLen );
+        if( (nKeyLen > 0 &&
+             VSIFReadL( &osKey[0], 1, nKeyLen, fpGroups ) !=
+                                        static_cast<size_t>(nKeyLen)) ||
+            (nSummaries > 0 &&
+             VSIFReadL( &asSummaries[0], sizeof(swq_summary), nSummaries,
+                        fpGroups ) != nSummaries) )
+            return NULL;
+    }
+    else
+    {
+        if( nFID < 0 || nFID >= static_cast<GIntBig>(apoGroups.size()) )
+            return NULL;
+
+        OGRGenSQLGroup *psGroup = apoGroups[static_cast<size_t>(nFID)];
+        osKey = psGroup->pszKey;
+        if( nSummaries > 0 )
+            memcpy( &asSummaries[0], psGroup->pasSummary,
+                    sizeof(swq_summary) * nSummaries );
+    }
+
+    OGRFeature *poFeature = new OGRFeature( poDefn );
+    poFeature->SetFID( nFID );
+
+    CPLString osValue;
+    size_t iSummary = 0;
+    for( int iField = 0; iField < psSelectInfo->result_columns; iField++ )
+    {
+        swq_col_def *psColDef = psSelectInfo->column_defs + iField;
+        if( psColDef->col_func != SWQCF_NONE )
+        {
+            SetSummaryField( poFeature, iField, &asSummaries[iSummary++] );
+        }
+        else if( OGRGenSQLGetKeyValue(
+                    osKey, psSelectInfo->GetGroupByKey( psColDef->table_index,
+                                                        psColDef->field_index ),
+                    osValue ) )
+        {
+            poFeature->SetField( iField, osValue.c_str() );
+        }
+    }
+
+    return poFeature;
+}
+
+/************************************************************************/
+/*                            ClearGroupBy()                            */
+/************************************************************************/
+
+void OGRGenSQLResultsLayer::ClearGroupBy()
+
+{
+    for( size_t i = 0; i < apoGroups.size(); i++ )
+        OGRGenSQLGroupFree( apoGroups[i] );
+    apoGroups.clear();
+
+    if( fpGroups != NULL )
+    {
+        VSIFCloseL( fpGroups );
+        fpGroups = NULL;
+        VSIUnlink( osGroupsFilename );
+    }
+    anGroupOffsets.clear();
+
+    bGroupByDone = FALSE;
+}
+
+/************************************************************************/
+/*                          SortIndexSection()                          */
+/*                                                                      */
+/*      Sort the records in a section of the index.                     */
+/************************************************************************/
+
+int OGRGenSQLResultsLayer::SortIndexSection( OGRField *pasIndexFields,
+                                              GIntBig nStart, GIntBig nEntries )
+
+{
+    if( nEntries < 2 )
+        return TRUE;
+
+    swq_select *psSelectInfo = (swq_select *) pSelectInfo;
+    int      nOrderItems = psSelectInfo->order_specs;
+
+    GIntBig nFirstGroup = nEntries / 2;
+    GIntBig nFirstStart = nStart;
+    GIntBig nSecondGroup = nEntries - nFirstGroup;
+    GIntBig nSecondStart = nStart + nFirstGroup;
+    GIntBig iMerge = 0;
+    GIntBig *panMerged;
+
+    if( !SortIndexSection( pasIndexFields, nFirstStart, nFirstGroup ) ||
+        !SortIndexSection( pasIndexFields, nSecondStart, nSecondGroup ) )
+        return FALSE;
+
+    panMerged = (GIntBig *) VSI_MALLOC_VERBOSE( sizeof(GIntBig) * (size_t)nEntries );
+    if( panMerged == NULL )
+    {
+        return FALSE;
+    }
+
+    while( iMerge < nEntries )
+    {
+        int  nResult;
 
         if( nFirstGroup == 0 )
             nResult = -1;
@@ -2214,6 +3838,12 @@ void OGRGenSQLResultsLayer::FindAndSetIgnoredFields()
         AddFieldDefnToSet(psOrderDef->table_index, psOrderDef->field_index, hSet);
     }
 
+    for( int iGroup = 0; iGroup < psSelectInfo->group_specs; iGroup++ )
+    {
+        swq_group_def *psGroupDef = psSelectInfo->group_defs + iGroup;
+        AddFieldDefnToSet(psGroupDef->table_index, psGroupDef->field_index, hSet);
+    }
+
 /* -------------------------------------------------------------------- */
 /*      2nd phase : now, we can exclude the unused fields               */
 /* -------------------------------------------------------------------- */
@@ -2249,6 +3879,14 @@ void OGRGenSQLResultsLayer::InvalidateOrderByIndex()
     CPLFree( panFIDIndex );
     panFIDIndex = NULL;
 
+    if( fpFIDIndex != NULL )
+    {
+        VSIFCloseL( fpFIDIndex );
+        fpFIDIndex = NULL;
+        VSIUnlink( osFIDIndexFilename );
+    }
+    nFIDIndexCacheStart = -1;
+
     nIndexSize = 0;
     bOrderByValid = FALSE;
 }
@@ -2270,6 +3908,8 @@ OGRErr OGRGenSQLResultsLayer::SetAttributeFilter( const char* pszAttributeFilter
 void OGRGenSQLResultsLayer::SetSpatialFilter( int iGeomField, OGRGeometry * poGeom )
 {
     InvalidateOrderByIndex();
+    // The groups were aggregated with the previous spatial filter
+    ClearGroupBy();
     if( iGeomField == 0 )
         OGRLayer::SetSpatialFilter(poGeom);
     else
@@ -35,6 +35,8 @@
 #include "swq.h"
 #include "cpl_hash_set.h"
 
+#include <vector>
+
 #define GEOM_FIELD_INDEX_TO_ALL_FIELD_INDEX(poFDefn, iGeom) \
     ((poFDefn)->GetFieldCount() + SPECIAL_FIELD_COUNT + (iGeom))
 
@@ -45,6 +47,8 @@
 #define ALL_FIELD_INDEX_TO_GEOM_FIELD_INDEX(poFDefn, idx) \
     ((idx) - ((poFDefn)->GetFieldCount() + SPECIAL_FIELD_COUNT))
 
+struct OGRGenSQLGroup;
+
 /************************************************************************/
 /*                        OGRGenSQLResultsLayer                         */
 /************************************************************************/
@@ -68,7 +72,26 @@ class CPL_DLL OGRGenSQLResultsLayer : public OGRLayer
     GIntBig    *panFIDIndex;
     int         bOrderByValid;
 
+    // Sorted FIDs spilled to disk by the external sort. panFIDIndex is then
+    // a cache of a block of the file, starting at nFIDIndexCacheStart.
+    VSILFILE   *fpFIDIndex;
+    CPLString   osFIDIndexFilename;
+    GIntBig     nFIDIndexCacheStart;
+
+    VSILFILE   *fpSortRuns;
+    CPLString   osSortRunsFilename;
+
     GIntBig      nNextIndexFID;
+    GIntBig      nIteratedFeatures;
+
+    // GROUP BY result, in memory, or in a temporary file (fpGroups) when
+    // the groups did not fit in the memory budget.
+    int         bGroupByDone;
+    std::vector<int> anAggregateColumns;
+    std::vector<OGRGenSQLGroup*> apoGroups;
+    VSILFILE   *fpGroups;
+    CPLString   osGroupsFilename;
+    std::vector<vsi_l_offset> anGroupOffsets;
     OGRFeature  *poSummaryFeature;
 
     int         iFIDFieldIndex;
@@ -77,9 +100,33 @@ class CPL_DLL OGRGenSQLResultsLayer : public OGRLayer
     GDALDataset **papoExtraDS;
 
     int         PrepareSummary();
+    int         SummaryNeedsGeometry();
+    void        SetSummaryField( OGRFeature *poFeature, int iField,
+                                 swq_summary *psSummary );
+
+    int         PrepareGroupBy();
+    void        BuildGroupKey( OGRFeature *poSrcFeat, CPLString &osKey );
+    void        AccumulateGroup( OGRGenSQLGroup *psGroup,
+                                 OGRFeature *poSrcFeat );
+    void        SortGroups( std::vector<OGRGenSQLGroup*> &apoGroupsToSort );
+    int         WriteGroupRun( std::vector<OGRGenSQLGroup*> &apoRunGroups );
+    int         MergeGroupRuns( const std::vector<vsi_l_offset>& anRunOffsets );
+    int         WriteGroup( VSILFILE *fp, const char *pszKey,
+                            const swq_summary *pasSummary );
+    OGRFeature *GetGroupFeature( GIntBig nFID );
+    void        ClearGroupBy();
 
     OGRFeature *TranslateFeature( OGRFeature * );
     void        CreateOrderByIndex();
+    void        CreateTopKOrderByIndex( GIntBig nK );
+    size_t      ReadSortKeys( OGRFeature *poSrcFeat, OGRField *pasDstFields );
+    void        FreeSortKeys( OGRField *pasIndexFields, GIntBig nEntries );
+    int         IsStringSortKey( int iKey );
+    int         WriteSortedRun( OGRField *pasIndexFields, GIntBig *panFIDList,
+                                GIntBig nEntries );
+    int         MergeSortedRuns( const std::vector<vsi_l_offset>& anRunOffsets );
+    void        ApplyLimitToOrderByIndex();
+    GIntBig     GetFIDFromIndexFile( GIntBig iIndex );
     int         SortIndexSection( OGRField *pasIndexFields,
                                   GIntBig nStart, GIntBig nEntries );
     int         Compare( OGRField *pasFirst, OGRField *pasSecond );
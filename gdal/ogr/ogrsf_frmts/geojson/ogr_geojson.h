@@ -41,6 +41,7 @@
 #define SPACE_FOR_BBOX  130
 
 class OGRGeoJSONDataSource;
+class OGRGeoJSONReader;
 
 /************************************************************************/
 /*                           OGRGeoJSONLayer                            */
@@ -67,6 +68,12 @@ public:
     virtual const char* GetFIDColumn();
     virtual int         TestCapability( const char * pszCap );
 
+    virtual void        ResetReading();
+    virtual OGRFeature* GetNextFeature();
+    virtual OGRFeature* GetFeature( GIntBig nFID );
+    virtual GIntBig     GetFeatureCount( int bForce );
+    virtual OGRErr      SetNextByIndex( GIntBig nIndex );
+
     virtual OGRErr      SyncToDisk();
     //
     // OGRGeoJSONLayer Interface
@@ -74,12 +81,15 @@ public:
     void SetFIDColumn( const char* pszFIDColumn );
     void AddFeature( OGRFeature* poFeature );
     void DetectGeometryType();
+    void SetStreamingReader( OGRGeoJSONReader* poReader );
 
 private:
 
     OGRGeoJSONDataSource* poDS_;
+    OGRGeoJSONReader* poReader_;  // Only set in streaming mode.
     CPLString sFIDColumn_;
     bool bUpdated_;
+    bool bOriginalIdModified_;
 };
 
 /************************************************************************/
@@ -210,6 +220,11 @@ private:
     int ReadFromFile( GDALOpenInfo* poOpenInfo );
     int ReadFromService( const char* pszSource );
     void LoadLayers(char** papszOpenOptions);
+    void SetOptionsOnReader( OGRGeoJSONReader& reader,
+                             char** papszOpenOptionsIn );
+    bool CanUseStreamingReader( GDALOpenInfo* poOpenInfo );
+    bool ReadFromFileStreaming( GDALOpenInfo* poOpenInfo,
+                                bool& bTryStandardReading );
 };
 
 
@@ -87,6 +87,20 @@ int OGRGeoJSONDataSource::Open( GDALOpenInfo* poOpenInfo,
     }
     else if( eGeoJSONSourceFile == nSrcType )
     {
+        if( CanUseStreamingReader( poOpenInfo ) )
+        {
+            bool bTryStandardReading = false;
+            if( ReadFromFileStreaming( poOpenInfo, bTryStandardReading ) )
+                return TRUE;
+            if( !bTryStandardReading )
+            {
+                Clear();
+                CPLError( CE_Failure, CPLE_OpenFailed,
+                          "Failed to read GeoJSON data" );
+                return FALSE;
+            }
+        }
+
         if( !ReadFromFile( poOpenInfo ) )
             return FALSE;
     }
@@ -463,6 +477,100 @@ int OGRGeoJSONDataSource::ReadFromFile( GDALOpenInfo* poOpenInfo )
     return TRUE;
 }
 
+/************************************************************************/
+/*                       CanUseStreamingReader()                        */
+/************************************************************************/
+
+// Big FeatureCollection files opened in read-only mode are read
+// incrementally instead of being ingested and parsed as a whole.
+bool OGRGeoJSONDataSource::CanUseStreamingReader( GDALOpenInfo* poOpenInfo )
+{
+    if( poOpenInfo->eAccess != GA_ReadOnly ||
+        poOpenInfo->fpL == NULL || poOpenInfo->pabyHeader == NULL )
+    {
+        return false;
+    }
+
+    const GIntBig nThreshold = CPLAtoGIntBig(
+        CPLGetConfigOption("OGR_GEOJSON_STREAMING_THRESHOLD", "104857600"));
+    if( nThreshold < 0 )
+        return false;
+    VSIStatBufL sStatBuf;
+    if( VSIStatL( poOpenInfo->pszFilename, &sStatBuf ) != 0 ||
+        static_cast<GIntBig>(sStatBuf.st_size) < nThreshold )
+    {
+        return false;
+    }
+
+    // Leave JSONP, ESRI Feature Service, TopoJSON and CouchDB content to
+    // the standard readers.
+    const char* pszHeader =
+        reinterpret_cast<const char*>(poOpenInfo->pabyHeader);
+    if( static_cast<GByte>(pszHeader[0]) == 0xEF &&
+        static_cast<GByte>(pszHeader[1]) == 0xBB &&
+        static_cast<GByte>(pszHeader[2]) == 0xBF )
+    {
+        pszHeader += 3;
+    }
+    while( *pszHeader != '\0' && isspace(static_cast<int>(*pszHeader)) )
+        pszHeader ++;
+
+    return *pszHeader == '{' &&
+           strstr(pszHeader, "esriGeometry") == NULL &&
+           strstr(pszHeader, "esriFieldType") == NULL &&
+           strstr(pszHeader, "\"Topology\"") == NULL &&
+           !STARTS_WITH(pszHeader, "{\"couchdb\":\"Welcome\"") &&
+           !STARTS_WITH(pszHeader, "{\"db_name\":\"") &&
+           !STARTS_WITH(pszHeader, "{\"total_rows\":") &&
+           !STARTS_WITH(pszHeader, "{\"rows\":[");
+}
+
+/************************************************************************/
+/*                       ReadFromFileStreaming()                        */
+/************************************************************************/
+
+bool OGRGeoJSONDataSource::ReadFromFileStreaming( GDALOpenInfo* poOpenInfo,
+                                                  bool& bTryStandardReading )
+{
+    bTryStandardReading = false;
+
+    VSILFILE* fp = VSIFOpenL( poOpenInfo->pszFilename, "rb" );
+    if( fp == NULL )
+    {
+        bTryStandardReading = true;
+        return false;
+    }
+
+    OGRGeoJSONReader* poReader = new OGRGeoJSONReader();
+    SetOptionsOnReader( *poReader, poOpenInfo->papszOpenOptions );
+
+    OGRGeoJSONLayer* poLayer =
+        poReader->FirstPassReadLayer( this, fp, bTryStandardReading );
+    if( poLayer == NULL )
+    {
+        delete poReader;
+        return false;
+    }
+
+    json_object* poObj = poReader->GetJSonObject();
+    json_object* poProperties = json_object_object_get(poObj, "properties");
+    if( poProperties && json_object_get_type(poProperties) == json_type_object )
+    {
+        json_object* poExceededTransferLimit =
+            json_object_object_get(poProperties, "exceededTransferLimit");
+        if( poExceededTransferLimit && json_object_get_type(poExceededTransferLimit) == json_type_boolean )
+            bOtherPages_ = CPL_TO_BOOL(
+                json_object_get_boolean(poExceededTransferLimit) );
+    }
+
+    poLayer->SetStreamingReader( poReader );
+    AddLayer( poLayer );
+
+    pszName_ = CPLStrdup( poOpenInfo->pszFilename );
+
+    return true;
+}
+
 /************************************************************************/
 /*                           ReadFromService()                          */
 /************************************************************************/
@@ -620,30 +728,7 @@ void OGRGeoJSONDataSource::LoadLayers(char** papszOpenOptionsIn)
 /*      Configure GeoJSON format translator.                            */
 /* -------------------------------------------------------------------- */
     OGRGeoJSONReader reader;
-
-    if( eGeometryAsCollection == flTransGeom_ )
-    {
-        reader.SetPreserveGeometryType( false );
-        CPLDebug( "GeoJSON", "Geometry as OGRGeometryCollection type." );
-    }
-
-    if( eAttributesSkip == flTransAttrs_ )
-    {
-        reader.SetSkipAttributes( true );
-        CPLDebug( "GeoJSON", "Skip all attributes." );
-    }
-
-    reader.SetFlattenNestedAttributes(
-        CPL_TO_BOOL(CSLFetchBoolean(papszOpenOptionsIn, "FLATTEN_NESTED_ATTRIBUTES", FALSE)),
-        CSLFetchNameValueDef(papszOpenOptionsIn, "NESTED_ATTRIBUTE_SEPARATOR", "_")[0]);
-
-    const int bDefaultNativeData = bUpdatable_ ? TRUE : FALSE ;
-    reader.SetStoreNativeData(
-        CPL_TO_BOOL(CSLFetchBoolean(papszOpenOptionsIn, "NATIVE_DATA", bDefaultNativeData)));
-
-    reader.SetArrayAsString(
-        CPLTestBool(CSLFetchNameValueDef(papszOpenOptionsIn, "ARRAY_AS_STRING",
-                CPLGetConfigOption("OGR_GEOJSON_ARRAY_AS_STRING", "NO"))));
+    SetOptionsOnReader( reader, papszOpenOptionsIn );
 
 /* -------------------------------------------------------------------- */
 /*      Parse GeoJSON and build valid OGRLayer instance.                */
@@ -671,6 +756,38 @@ void OGRGeoJSONDataSource::LoadLayers(char** papszOpenOptionsIn)
     return;
 }
 
+/************************************************************************/
+/*                         SetOptionsOnReader()                         */
+/************************************************************************/
+
+void OGRGeoJSONDataSource::SetOptionsOnReader( OGRGeoJSONReader& reader,
+                                               char** papszOpenOptionsIn )
+{
+    if( eGeometryAsCollection == flTransGeom_ )
+    {
+        reader.SetPreserveGeometryType( false );
+        CPLDebug( "GeoJSON", "Geometry as OGRGeometryCollection type." );
+    }
+
+    if( eAttributesSkip == flTransAttrs_ )
+    {
+        reader.SetSkipAttributes( true );
+        CPLDebug( "GeoJSON", "Skip all attributes." );
+    }
+
+    reader.SetFlattenNestedAttributes(
+        CPL_TO_BOOL(CSLFetchBoolean(papszOpenOptionsIn, "FLATTEN_NESTED_ATTRIBUTES", FALSE)),
+        CSLFetchNameValueDef(papszOpenOptionsIn, "NESTED_ATTRIBUTE_SEPARATOR", "_")[0]);
+
+    const int bDefaultNativeData = bUpdatable_ ? TRUE : FALSE ;
+    reader.SetStoreNativeData(
+        CPL_TO_BOOL(CSLFetchBoolean(papszOpenOptionsIn, "NATIVE_DATA", bDefaultNativeData)));
+
+    reader.SetArrayAsString(
+        CPLTestBool(CSLFetchNameValueDef(papszOpenOptionsIn, "ARRAY_AS_STRING",
+                CPLGetConfigOption("OGR_GEOJSON_ARRAY_AS_STRING", "NO"))));
+}
+
 /************************************************************************/
 /*                            AddLayer()                                */
 /************************************************************************/
@@ -30,6 +30,7 @@
 #include <algorithm> // for_each, find_if
 #include <json.h> // JSON-C
 #include "ogr_geojson.h"
+#include "ogrgeojsonreader.h"
 
 /* Remove annoying warnings Microsoft Visual C++ */
 #if defined(_MSC_VER)
@@ -52,7 +53,9 @@ OGRGeoJSONLayer::OGRGeoJSONLayer( const char* pszName,
                                   OGRSpatialReference* poSRSIn,
                                   OGRwkbGeometryType eGType,
                                   OGRGeoJSONDataSource* poDS )
-  : OGRMemLayer( pszName, poSRSIn, eGType), poDS_(poDS), bUpdated_(false)
+  : OGRMemLayer( pszName, poSRSIn, eGType), poDS_(poDS), poReader_(NULL),
+    bUpdated_(false),
+    bOriginalIdModified_(false)
 {
     SetAdvertizeUTF8(true);
     SetUpdatable( poDS->IsUpdatable() );
@@ -64,6 +67,7 @@ OGRGeoJSONLayer::OGRGeoJSONLayer( const char* pszName,
 
 OGRGeoJSONLayer::~OGRGeoJSONLayer()
 {
+    delete poReader_;
 }
 
 /************************************************************************/
@@ -93,9 +97,100 @@ int OGRGeoJSONLayer::TestCapability( const char * pszCap )
 {
     if( EQUAL(pszCap, OLCCurveGeometries) )
         return FALSE;
+    if( poReader_ != NULL && EQUAL(pszCap, OLCFastSetNextByIndex) )
+        return FALSE;
     return OGRMemLayer::TestCapability(pszCap);
 }
 
+/************************************************************************/
+/*                         SetStreamingReader()                         */
+/************************************************************************/
+
+// In streaming mode, features are not stored in the underlying memory
+// layer but read from the file by poReader, which the layer takes
+// ownership of. The layer is then read-only.
+void OGRGeoJSONLayer::SetStreamingReader( OGRGeoJSONReader* poReader )
+{
+    CPLAssert( poReader_ == NULL );
+    poReader_ = poReader;
+    SetUpdatable( false );
+}
+
+/************************************************************************/
+/*                           ResetReading()                             */
+/************************************************************************/
+
+void OGRGeoJSONLayer::ResetReading()
+{
+    if( poReader_ != NULL )
+        poReader_->ResetReading();
+    else
+        OGRMemLayer::ResetReading();
+}
+
+/************************************************************************/
+/*                          GetNextFeature()                            */
+/************************************************************************/
+
+OGRFeature* OGRGeoJSONLayer::GetNextFeature()
+{
+    if( poReader_ == NULL )
+        return OGRMemLayer::GetNextFeature();
+
+    while( true )
+    {
+        OGRFeature* poFeature = poReader_->GetNextFeature(this);
+        if( poFeature == NULL )
+            return NULL;
+        if( (m_poFilterGeom == NULL
+             || FilterGeometry( poFeature->GetGeomFieldRef(m_iGeomFieldFilter) ) )
+            && (m_poAttrQuery == NULL
+                || m_poAttrQuery->Evaluate( poFeature ) ) )
+        {
+            m_nFeaturesRead++;
+            return poFeature;
+        }
+        delete poFeature;
+    }
+}
+
+/************************************************************************/
+/*                            GetFeature()                              */
+/************************************************************************/
+
+OGRFeature* OGRGeoJSONLayer::GetFeature( GIntBig nFID )
+{
+    if( poReader_ != NULL )
+        return poReader_->GetFeature(this, nFID);
+    return OGRMemLayer::GetFeature(nFID);
+}
+
+/************************************************************************/
+/*                          GetFeatureCount()                           */
+/************************************************************************/
+
+GIntBig OGRGeoJSONLayer::GetFeatureCount( int bForce )
+{
+    if( poReader_ != NULL )
+    {
+        if( m_poFilterGeom != NULL || m_poAttrQuery != NULL )
+            return OGRLayer::GetFeatureCount( bForce );
+        return poReader_->GetFeatureCount();
+    }
+    return OGRMemLayer::GetFeatureCount(bForce);
+}
+
+/************************************************************************/
+/*                          SetNextByIndex()                            */
+/************************************************************************/
+
+OGRErr OGRGeoJSONLayer::SetNextByIndex( GIntBig nIndex )
+{
+    if( poReader_ != NULL )
+        return OGRLayer::SetNextByIndex(nIndex);
+    return OGRMemLayer::SetNextByIndex(nIndex);
+}
+
 /************************************************************************/
 /*                           SyncToDisk()                               */
 /************************************************************************/
@@ -112,9 +207,33 @@ OGRErr OGRGeoJSONLayer::SyncToDisk()
 
 void OGRGeoJSONLayer::AddFeature( OGRFeature* poFeature )
 {
+/* -------------------------------------------------------------------- */
+/*      A feature without id, or whose id is already used, gets the     */
+/*      first free FID from the current feature count.                  */
+/* -------------------------------------------------------------------- */
+    GIntBig nFID = poFeature->GetFID();
+    bool bNewFID = ( -1 == nFID );
+    if( !bNewFID && OGRMemLayer::GetFeatureRef( nFID ) != NULL )
+    {
+        if( !bOriginalIdModified_ )
+        {
+            CPLError( CE_Warning, CPLE_AppDefined,
+                      "Several features with id = " CPL_FRMT_GIB " have been "
+                      "found. Altering it to be unique. This warning will not "
+                      "be emitted for this layer", nFID );
+            bOriginalIdModified_ = true;
+        }
+        bNewFID = true;
+    }
+    if( bNewFID )
+    {
+        nFID = GetFeatureCount(FALSE);
+        while( OGRMemLayer::GetFeatureRef( nFID ) != NULL )
+            nFID ++;
+    }
+
     if( -1 == poFeature->GetFID() )
     {
-        GIntBig nFID = GetFeatureCount(FALSE);
         poFeature->SetFID( nFID );
 
         // TODO - mloskot: We need to redesign creation of FID column
@@ -126,8 +245,9 @@ void OGRGeoJSONLayer::AddFeature( OGRFeature* poFeature )
             poFeature->SetField( nField, nFID );
         }
     }
+    else
+        poFeature->SetFID( nFID );
 
-    GIntBig nFID = poFeature->GetFID();
     if( !CPL_INT64_FITS_ON_INT32(nFID) )
         SetMetadataItem(OLMD_FID64, "YES");
 
@@ -143,7 +263,8 @@ void OGRGeoJSONLayer::AddFeature( OGRFeature* poFeature )
 
 void OGRGeoJSONLayer::DetectGeometryType()
 {
-    if (GetLayerDefn()->GetGeomType() != wkbUnknown)
+    // Already done during the first pass in streaming mode.
+    if (poReader_ != NULL || GetLayerDefn()->GetGeomType() != wkbUnknown)
         return;
 
     ResetReading();
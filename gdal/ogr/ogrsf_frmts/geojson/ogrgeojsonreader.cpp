@@ -39,6 +39,11 @@
 
 OGRGeoJSONReader::OGRGeoJSONReader() :
     poGJObject_(NULL),
+    fp_(NULL),
+    poScanner_(NULL),
+    nNextFeatureIdx_(0),
+    bHasExplicitFID_(false),
+    bFIDMapBuilt_(false),
     bGeometryPreserve_(true),
     bAttributesSkip_(false),
     bFlattenNestedAttributes_(false),
@@ -64,6 +69,10 @@ OGRGeoJSONReader::~OGRGeoJSONReader()
     }
 
     poGJObject_ = NULL;
+
+    delete poScanner_;
+    if( fp_ != NULL )
+        VSIFCloseL(fp_);
 }
 
 /************************************************************************/
@@ -432,6 +441,17 @@ bool OGRGeoJSONReader::GenerateLayerDefn( OGRGeoJSONLayer* poLayer, json_object*
         }
     }
 
+    DetectFIDColumn( poLayer );
+
+    return bSuccess;
+}
+
+/************************************************************************/
+/*                          DetectFIDColumn()                           */
+/************************************************************************/
+
+void OGRGeoJSONReader::DetectFIDColumn( OGRGeoJSONLayer* poLayer )
+{
 /* -------------------------------------------------------------------- */
 /*      Validate and add FID column if necessary.                       */
 /* -------------------------------------------------------------------- */
@@ -463,8 +483,6 @@ bool OGRGeoJSONReader::GenerateLayerDefn( OGRGeoJSONLayer* poLayer, json_object*
       poLayer_->SetFIDColumn( fldDefn.GetNameRef() );
       }
     */
-
-    return bSuccess;
 }
 
 /************************************************************************/
@@ -1141,46 +1159,54 @@ OGRGeoJSONReader::ReadFeatureCollection( OGRGeoJSONLayer* poLayer, json_object*
         //CPLAssert( nFeatures == poLayer_->GetFeatureCount() );
     }
 
-    // Collect top objects except 'type' and the 'features' array
     if( bStoreNativeData_ )
+        StoreCollectionNativeData( poLayer, poObj );
+}
+
+/************************************************************************/
+/*                      StoreCollectionNativeData()                     */
+/************************************************************************/
+
+void OGRGeoJSONReader::StoreCollectionNativeData( OGRGeoJSONLayer* poLayer,
+                                                  json_object* poObj )
+{
+    // Collect top objects except 'type' and the 'features' array
+    json_object_iter it;
+    it.key = NULL;
+    it.val = NULL;
+    it.entry = NULL;
+    CPLString osNativeData;
+    json_object_object_foreachC(poObj, it)
     {
-        json_object_iter it;
-        it.key = NULL;
-        it.val = NULL;
-        it.entry = NULL;
-        CPLString osNativeData;
-        json_object_object_foreachC(poObj, it)
+        if( strcmp(it.key, "type") == 0 ||
+            strcmp(it.key, "features") == 0 )
         {
-            if( strcmp(it.key, "type") == 0 ||
-                strcmp(it.key, "features") == 0 )
-            {
-                continue;
-            }
-            if( osNativeData.size() == 0 )
-                osNativeData = "{ ";
-            else
-                osNativeData += ", ";
-            json_object* poKey = json_object_new_string(it.key);
-            osNativeData += json_object_to_json_string(poKey);
-            json_object_put(poKey);
-            osNativeData += ": ";
-            osNativeData += json_object_to_json_string(it.val);
+            continue;
         }
         if( osNativeData.size() == 0 )
-        {
             osNativeData = "{ ";
-        }
-        osNativeData += " }";
+        else
+            osNativeData += ", ";
+        json_object* poKey = json_object_new_string(it.key);
+        osNativeData += json_object_to_json_string(poKey);
+        json_object_put(poKey);
+        osNativeData += ": ";
+        osNativeData += json_object_to_json_string(it.val);
+    }
+    if( osNativeData.size() == 0 )
+    {
+        osNativeData = "{ ";
+    }
+    osNativeData += " }";
 
-        osNativeData = "NATIVE_DATA=" + osNativeData;
+    osNativeData = "NATIVE_DATA=" + osNativeData;
 
-        char* apszMetadata[3];
-        apszMetadata[0] = (char*) osNativeData.c_str();
-        apszMetadata[1] = (char*) "NATIVE_MEDIA_TYPE=application/vnd.geo+json";
-        apszMetadata[2] = NULL;
+    char* apszMetadata[3];
+    apszMetadata[0] = (char*) osNativeData.c_str();
+    apszMetadata[1] = (char*) "NATIVE_MEDIA_TYPE=application/vnd.geo+json";
+    apszMetadata[2] = NULL;
 
-        poLayer->SetMetadata( apszMetadata, "NATIVE_DATA" );
-    }
+    poLayer->SetMetadata( apszMetadata, "NATIVE_DATA" );
 }
 
 /************************************************************************/
@@ -34,7 +34,9 @@
 #include "cpl_string.h"
 #include "ogrsf_frmts.h"
 #include <json.h> // JSON-C
+#include <map>
 #include <set>
+#include <vector>
 
 /************************************************************************/
 /*                         FORWARD DECLARATIONS                         */
@@ -81,6 +83,70 @@ struct GeoJSONObject
     };
 };
 
+/************************************************************************/
+/*                       OGRGeoJSONFeatureScanner                       */
+/************************************************************************/
+
+/* Incremental scanner of a GeoJSON FeatureCollection document. It walks */
+/* the file by chunks, only tracking the lexical structure, and returns  */
+/* the text of each element of the top-level "features" array in turn,   */
+/* so that only one feature needs to be held in memory at a time.        */
+
+class OGRGeoJSONFeatureScanner
+{
+public:
+
+    explicit OGRGeoJSONFeatureScanner( VSILFILE* fp );
+
+    void Rewind();
+    bool NextFeature( CPLString& osFeature, vsi_l_offset& nOffset );
+
+    bool HasError() const { return bError_; }
+    bool HasStarted() const { return bStarted_; }
+    bool HasFoundFeatures() const { return bFoundFeatures_; }
+    CPLString GetTopLevelMembers() const;
+
+    static bool ReadObjectAt( VSILFILE* fp, vsi_l_offset nOffset,
+                              CPLString& osObject );
+
+private:
+
+    VSILFILE* fp_;
+    std::vector<char> abyBuffer_;
+    size_t nBufferSize_;
+    size_t nBufferPos_;
+    vsi_l_offset nBufferOffset_;
+
+    bool bError_;
+    bool bStarted_;
+    bool bFinished_;
+    int nDepth_;
+    bool bInString_;
+    bool bEscape_;
+    bool bExpectKey_;
+    bool bInKey_;
+    bool bValuePending_;
+    bool bInFeatures_;
+    bool bFoundFeatures_;
+
+    bool bCapturingMember_;
+    bool bCapturingFeature_;
+    size_t nCaptureStart_;
+    vsi_l_offset nFeatureOffset_;
+    CPLString osKey_;
+    CPLString osCapture_;
+    CPLString osMembers_;
+
+    bool FillBuffer();
+    void EndMember();
+
+    //
+    // Copy operations not supported.
+    //
+    OGRGeoJSONFeatureScanner( OGRGeoJSONFeatureScanner const& );
+    OGRGeoJSONFeatureScanner& operator=( OGRGeoJSONFeatureScanner const& );
+};
+
 /************************************************************************/
 /*                           OGRGeoJSONReader                           */
 /************************************************************************/
@@ -108,10 +174,31 @@ public:
 
     json_object* GetJSonObject() { return poGJObject_; }
 
+    //
+    // Streaming mode: the reader owns fp and is owned by the layer.
+    //
+    OGRGeoJSONLayer* FirstPassReadLayer( OGRGeoJSONDataSource* poDS,
+                                         VSILFILE* fp,
+                                         bool& bTryStandardReading );
+    void ResetReading();
+    OGRFeature* GetNextFeature( OGRGeoJSONLayer* poLayer );
+    OGRFeature* GetFeature( OGRGeoJSONLayer* poLayer, GIntBig nFID );
+    GIntBig GetFeatureCount() const
+        { return static_cast<GIntBig>(anFeatureOffsets_.size()); }
+
 private:
 
     json_object* poGJObject_;
 
+    VSILFILE* fp_;
+    OGRGeoJSONFeatureScanner* poScanner_;
+    std::vector<vsi_l_offset> anFeatureOffsets_;
+    GIntBig nNextFeatureIdx_;
+    bool bHasExplicitFID_;
+    bool bFIDMapBuilt_;
+    std::map<GIntBig, GIntBig> oMapFIDToIdx_;
+    std::map<GIntBig, GIntBig> oMapIdxToFID_;
+
     bool bGeometryPreserve_;
     bool bAttributesSkip_;
     bool bFlattenNestedAttributes_;
@@ -139,12 +226,19 @@ private:
     //
     bool GenerateLayerDefn( OGRGeoJSONLayer* poLayer, json_object* poGJObject );
     bool GenerateFeatureDefn( OGRGeoJSONLayer* poLayer, json_object* poObj );
+    void DetectFIDColumn( OGRGeoJSONLayer* poLayer );
+    void StoreCollectionNativeData( OGRGeoJSONLayer* poLayer,
+                                    json_object* poObj );
     bool AddFeature( OGRGeoJSONLayer* poLayer, OGRGeometry* poGeometry );
     bool AddFeature( OGRGeoJSONLayer* poLayer, OGRFeature* poFeature );
 
     OGRGeometry* ReadGeometry( json_object* poObj );
     OGRFeature* ReadFeature( OGRGeoJSONLayer* poLayer, json_object* poObj );
     void ReadFeatureCollection( OGRGeoJSONLayer* poLayer, json_object* poObj );
+    OGRFeature* ReadFeatureFromText( OGRGeoJSONLayer* poLayer,
+                                     const char* pszText );
+    void AssignFID( OGRFeature* poFeature, GIntBig nIdx );
+    void BuildFIDMap( OGRGeoJSONLayer* poLayer );
 };
 
 void OGRGeoJSONReaderSetField(OGRLayer* poLayer,
@@ -0,0 +1,729 @@
+/******************************************************************************
+ * $Id$
+ *
+ * Project:  OpenGIS Simple Features Reference Implementation
+ * Purpose:  Streaming reading of GeoJSON FeatureCollection files.
+ * Author:   agent, <agent at local>
+ *
+ ******************************************************************************
+ * Copyright (c) 2026, agent <agent at local>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ ****************************************************************************/
+#include "ogrgeojsonreader.h"
+#include "ogrgeojsonutils.h"
+#include "ogr_geojson.h"
+#include <json.h> // JSON-C
+
+static const size_t GEOJSON_SCANNER_BUFFER_SIZE = 65536;
+
+/************************************************************************/
+/*                        OGRGeoJSONIsSpace()                           */
+/************************************************************************/
+
+static bool OGRGeoJSONIsSpace( char ch )
+{
+    return ch == ' ' || ch == '\t' || ch == '\r' || ch == '\n';
+}
+
+/************************************************************************/
+/*                      OGRGeoJSONFeatureScanner()                      */
+/************************************************************************/
+
+OGRGeoJSONFeatureScanner::OGRGeoJSONFeatureScanner( VSILFILE* fp ) :
+    fp_(fp),
+    abyBuffer_(GEOJSON_SCANNER_BUFFER_SIZE),
+    nBufferSize_(0),
+    nBufferPos_(0),
+    nBufferOffset_(0),
+    bError_(false),
+    bStarted_(false),
+    bFinished_(false),
+    nDepth_(0),
+    bInString_(false),
+    bEscape_(false),
+    bExpectKey_(false),
+    bInKey_(false),
+    bValuePending_(false),
+    bInFeatures_(false),
+    bFoundFeatures_(false),
+    bCapturingMember_(false),
+    bCapturingFeature_(false),
+    nCaptureStart_(0),
+    nFeatureOffset_(0)
+{}
+
+/************************************************************************/
+/*                               Rewind()                               */
+/************************************************************************/
+
+void OGRGeoJSONFeatureScanner::Rewind()
+{
+    nBufferSize_ = 0;
+    nBufferPos_ = 0;
+    nBufferOffset_ = 0;
+    bError_ = false;
+    bStarted_ = false;
+    bFinished_ = false;
+    nDepth_ = 0;
+    bInString_ = false;
+    bEscape_ = false;
+    bExpectKey_ = false;
+    bInKey_ = false;
+    bValuePending_ = false;
+    bInFeatures_ = false;
+    bFoundFeatures_ = false;
+    bCapturingMember_ = false;
+    bCapturingFeature_ = false;
+    nCaptureStart_ = 0;
+    nFeatureOffset_ = 0;
+    osKey_.clear();
+    osCapture_.clear();
+    osMembers_.clear();
+}
+
+/************************************************************************/
+/*                             FillBuffer()                             */
+/************************************************************************/
+
+bool OGRGeoJSONFeatureScanner::FillBuffer()
+{
+    if( bCapturingMember_ || bCapturingFeature_ )
+    {
+        osCapture_.append( &abyBuffer_[nCaptureStart_],
+                           nBufferSize_ - nCaptureStart_ );
+    }
+    nCaptureStart_ = 0;
+
+    // Always seek, since GetFeature() may have moved the file pointer
+    // in between.
+    nBufferOffset_ += nBufferSize_;
+    nBufferPos_ = 0;
+    if( VSIFSeekL( fp_, nBufferOffset_, SEEK_SET ) != 0 )
+    {
+        nBufferSize_ = 0;
+        return false;
+    }
+    nBufferSize_ = VSIFReadL( &abyBuffer_[0], 1, abyBuffer_.size(), fp_ );
+    return nBufferSize_ > 0;
+}
+
+/************************************************************************/
+/*                             EndMember()                              */
+/************************************************************************/
+
+// Called on the ',' or '}' that terminates a member of the top-level
+// object.
+void OGRGeoJSONFeatureScanner::EndMember()
+{
+    if( !bCapturingMember_ )
+        return;
+
+    osCapture_.append( &abyBuffer_[nCaptureStart_],
+                       nBufferPos_ - nCaptureStart_ );
+    bCapturingMember_ = false;
+
+    if( !osMembers_.empty() )
+        osMembers_ += ", ";
+    osMembers_ += "\"";
+    osMembers_ += osKey_;
+    osMembers_ += "\": ";
+    osMembers_ += osCapture_;
+    osCapture_.clear();
+}
+
+/************************************************************************/
+/*                         GetTopLevelMembers()                         */
+/************************************************************************/
+
+// Returns the members of the top-level object that have been met so far,
+// except "features", as a JSon object.
+CPLString OGRGeoJSONFeatureScanner::GetTopLevelMembers() const
+{
+    return "{ " + osMembers_ + " }";
+}
+
+/************************************************************************/
+/*                            NextFeature()                             */
+/************************************************************************/
+
+bool OGRGeoJSONFeatureScanner::NextFeature( CPLString& osFeature,
+                                            vsi_l_offset& nOffset )
+{
+    while( !bError_ && !bFinished_ )
+    {
+        if( nBufferPos_ == nBufferSize_ )
+        {
+            if( !FillBuffer() )
+            {
+                if( bStarted_ )
+                {
+                    CPLError( CE_Failure, CPLE_AppDefined,
+                              "GeoJSON parsing error: unexpected end of file" );
+                }
+                bError_ = true;
+                return false;
+            }
+        }
+
+        const char ch = abyBuffer_[nBufferPos_];
+
+        if( bInString_ )
+        {
+            if( bEscape_ )
+                bEscape_ = false;
+            else if( ch == '\\' )
+                bEscape_ = true;
+            else if( ch == '"' )
+            {
+                bInString_ = false;
+                bInKey_ = false;
+            }
+            if( bInKey_ )
+                osKey_ += ch;
+            nBufferPos_ ++;
+            continue;
+        }
+
+        if( nDepth_ == 1 && bValuePending_ && !OGRGeoJSONIsSpace(ch) )
+        {
+            bValuePending_ = false;
+            if( ch == '[' && osKey_ == "features" )
+            {
+                bInFeatures_ = true;
+                bFoundFeatures_ = true;
+            }
+            else
+            {
+                bCapturingMember_ = true;
+                nCaptureStart_ = nBufferPos_;
+                osCapture_.clear();
+            }
+        }
+
+        switch( ch )
+        {
+            case '"':
+                bInString_ = true;
+                if( nDepth_ == 1 && bExpectKey_ )
+                {
+                    bInKey_ = true;
+                    bExpectKey_ = false;
+                    osKey_.clear();
+                }
+                break;
+
+            case ':':
+                if( nDepth_ == 1 )
+                    bValuePending_ = true;
+                break;
+
+            case ',':
+                if( nDepth_ == 1 )
+                {
+                    EndMember();
+                    bExpectKey_ = true;
+                }
+                break;
+
+            case '{':
+            case '[':
+                if( nDepth_ == 0 )
+                {
+                    if( ch != '{' )
+                    {
+                        bError_ = true;
+                        return false;
+                    }
+                    bStarted_ = true;
+                    bExpectKey_ = true;
+                }
+                else if( nDepth_ == 2 && bInFeatures_ && ch == '{' )
+                {
+                    bCapturingFeature_ = true;
+                    nCaptureStart_ = nBufferPos_;
+                    nFeatureOffset_ = nBufferOffset_ + nBufferPos_;
+                    osCapture_.clear();
+                }
+                nDepth_ ++;
+                break;
+
+            case '}':
+            case ']':
+                nDepth_ --;
+                if( nDepth_ < 0 )
+                {
+                    CPLError( CE_Failure, CPLE_AppDefined,
+                              "GeoJSON parsing error: unbalanced '%c' "
+                              "at offset " CPL_FRMT_GUIB,
+                              ch, nBufferOffset_ + nBufferPos_ );
+                    bError_ = true;
+                    return false;
+                }
+                if( nDepth_ == 2 && bCapturingFeature_ )
+                {
+                    nBufferPos_ ++;
+                    osCapture_.append( &abyBuffer_[nCaptureStart_],
+                                       nBufferPos_ - nCaptureStart_ );
+                    bCapturingFeature_ = false;
+                    osFeature.swap( osCapture_ );
+                    osCapture_.clear();
+                    nOffset = nFeatureOffset_;
+                    return true;
+                }
+                if( nDepth_ == 1 && bInFeatures_ )
+                {
+                    bInFeatures_ = false;
+                }
+                else if( nDepth_ == 0 )
+                {
+                    EndMember();
+                    bFinished_ = true;
+                }
+                break;
+
+            default:
+                // Tolerate a UTF-8 BOM before the top-level object.
+                if( !bStarted_ && !OGRGeoJSONIsSpace(ch) &&
+                    !(nBufferOffset_ + nBufferPos_ < 3 &&
+                      (static_cast<GByte>(ch) & 0x80) != 0) )
+                {
+                    bError_ = true;
+                    return false;
+                }
+                break;
+        }
+        nBufferPos_ ++;
+    }
+
+    return false;
+}
+
+/************************************************************************/
+/*                           ReadObjectAt()                             */
+/************************************************************************/
+
+// Reads the text of the JSon object starting at nOffset.
+bool OGRGeoJSONFeatureScanner::ReadObjectAt( VSILFILE* fp,
+                                             vsi_l_offset nOffset,
+                                             CPLString& osObject )
+{
+    osObject.clear();
+    if( VSIFSeekL( fp, nOffset, SEEK_SET ) != 0 )
+        return false;
+
+    char achBuffer[4096];
+    int nDepth = 0;
+    bool bInString = false;
+    bool bEscape = false;
+    while( true )
+    {
+        const size_t nRead = VSIFReadL( achBuffer, 1, sizeof(achBuffer), fp );
+        if( nRead == 0 )
+            return false;
+        for( size_t i = 0; i < nRead; i++ )
+        {
+            const char ch = achBuffer[i];
+            if( bInString )
+            {
+                if( bEscape )
+                    bEscape = false;
+                else if( ch == '\\' )
+                    bEscape = true;
+                else if( ch == '"' )
+                    bInString = false;
+            }
+            else if( ch == '"' )
+                bInString = true;
+            else if( ch == '{' || ch == '[' )
+                nDepth ++;
+            else if( ch == '}' || ch == ']' )
+            {
+                nDepth --;
+                if( nDepth == 0 )
+                {
+                    osObject.append( achBuffer, i + 1 );
+                    return true;
+                }
+            }
+            else if( nDepth == 0 && !OGRGeoJSONIsSpace(ch) )
+                return false;
+        }
+        osObject.append( achBuffer, nRead );
+    }
+}
+
+/************************************************************************/
+/*                       OGRGeoJSONGetExplicitId()                      */
+/************************************************************************/
+
+// Returns whether the feature has a member that may end up being used as
+// its FID, and the value of this member if it is an integer.
+static bool OGRGeoJSONGetExplicitId( json_object* poObj, GIntBig& nId,
+                                     bool& bIsInteger )
+{
+    bIsInteger = false;
+    json_object* poObjId = OGRGeoJSONFindMemberByName( poObj, "id" );
+    if( poObjId == NULL )
+    {
+        json_object* poObjProps =
+            OGRGeoJSONFindMemberByName( poObj, "properties" );
+        if( poObjProps != NULL &&
+            json_object_get_type(poObjProps) == json_type_object )
+        {
+            poObjId = json_object_object_get( poObjProps, "id" );
+        }
+    }
+    if( poObjId == NULL )
+        return false;
+    if( json_object_get_type(poObjId) == json_type_int )
+    {
+        nId = static_cast<GIntBig>(json_object_get_int64(poObjId));
+        bIsInteger = true;
+    }
+    return true;
+}
+
+/************************************************************************/
+/*                         FirstPassReadLayer()                         */
+/************************************************************************/
+
+// Scan the whole file once to establish the layer schema, geometry type,
+// spatial reference and the offsets of the features, without building
+// the JSon tree of the whole document. Features are then read on demand
+// by GetNextFeature() and GetFeature().
+//
+// bTryStandardReading is set when the document is valid JSon, but not
+// a FeatureCollection, in which case the caller should ingest it.
+
+OGRGeoJSONLayer* OGRGeoJSONReader::FirstPassReadLayer(
+                                        OGRGeoJSONDataSource* poDS,
+                                        VSILFILE* fp,
+                                        bool& bTryStandardReading )
+{
+    bTryStandardReading = false;
+
+    CPLAssert( fp_ == NULL );
+    fp_ = fp;
+    poScanner_ = new OGRGeoJSONFeatureScanner( fp_ );
+
+    OGRGeoJSONLayer* poLayer =
+        new OGRGeoJSONLayer( OGRGeoJSONLayer::DefaultName, NULL,
+                             OGRGeoJSONLayer::DefaultGeometryType, poDS );
+
+    bool bFirstGeometry = true;
+    bool bMixedGeometryTypes = false;
+    OGRwkbGeometryType eLayerGeomType = wkbUnknown;
+    bool bFID64 = false;
+
+    CPLString osFeature;
+    vsi_l_offset nOffset = 0;
+    while( poScanner_->NextFeature( osFeature, nOffset ) )
+    {
+        json_object* poObj = NULL;
+        if( !OGRJSonParse( osFeature, &poObj ) )
+        {
+            delete poLayer;
+            return NULL;
+        }
+        anFeatureOffsets_.push_back( nOffset );
+
+        if( !bAttributesSkip_ && !GenerateFeatureDefn( poLayer, poObj ) )
+        {
+            CPLDebug( "GeoJSON", "Create feature schema failure." );
+        }
+
+        GIntBig nId = 0;
+        bool bIsInteger = false;
+        if( OGRGeoJSONGetExplicitId( poObj, nId, bIsInteger ) )
+        {
+            bHasExplicitFID_ = true;
+            if( bIsInteger && !CPL_INT64_FITS_ON_INT32(nId) )
+                bFID64 = true;
+        }
+
+        if( !bMixedGeometryTypes )
+        {
+            json_object* poObjGeom =
+                OGRGeoJSONFindMemberByName( poObj, "geometry" );
+            OGRGeometry* poGeometry =
+                poObjGeom ? ReadGeometry( poObjGeom ) : NULL;
+            if( poGeometry != NULL )
+            {
+                const OGRwkbGeometryType eGeomType =
+                    poGeometry->getGeometryType();
+                if( bFirstGeometry )
+                {
+                    eLayerGeomType = eGeomType;
+                    bFirstGeometry = false;
+                }
+                else if( eGeomType != eLayerGeomType )
+                {
+                    CPLDebug( "GeoJSON",
+                        "Detected layer of mixed-geometry type features." );
+                    eLayerGeomType = OGRGeoJSONLayer::DefaultGeometryType;
+                    bMixedGeometryTypes = true;
+                }
+                delete poGeometry;
+            }
+        }
+
+        json_object_put( poObj );
+    }
+
+    if( poScanner_->HasError() )
+    {
+        // A document that does not start with an object is left to the
+        // standard reader, which will report the appropriate error.
+        bTryStandardReading = !poScanner_->HasStarted();
+        delete poLayer;
+        return NULL;
+    }
+
+/* -------------------------------------------------------------------- */
+/*      Only FeatureCollection documents are read in streaming mode.    */
+/* -------------------------------------------------------------------- */
+    if( !OGRJSonParse( poScanner_->GetTopLevelMembers(), &poGJObject_,
+                       false ) ||
+        !poScanner_->HasFoundFeatures() ||
+        OGRGeoJSONGetType( poGJObject_ ) != GeoJSONObject::eFeatureCollection )
+    {
+        bTryStandardReading = true;
+        delete poLayer;
+        return NULL;
+    }
+
+    if( bIsGeocouchSpatiallistFormat )
+        bHasExplicitFID_ = true;
+
+    OGRSpatialReference* poSRS = OGRGeoJSONReadSpatialReference( poGJObject_ );
+    if( poSRS == NULL )
+    {
+        // If there is none defined, we use 4326
+        poSRS = new OGRSpatialReference();
+        if( OGRERR_NONE != poSRS->importFromEPSG( 4326 ) )
+        {
+            delete poSRS;
+            poSRS = NULL;
+        }
+    }
+    if( poSRS != NULL )
+    {
+        poLayer->GetLayerDefn()->GetGeomFieldDefn(0)->SetSpatialRef( poSRS );
+        poSRS->Release();
+    }
+
+    poLayer->GetLayerDefn()->SetGeomType( eLayerGeomType );
+    if( !bAttributesSkip_ )
+        DetectFIDColumn( poLayer );
+    if( bFID64 )
+        poLayer->SetMetadataItem( OLMD_FID64, "YES" );
+    if( bStoreNativeData_ )
+        StoreCollectionNativeData( poLayer, poGJObject_ );
+
+    CPLDebug( "GeoJSON", "Streaming mode: " CPL_FRMT_GIB " features found.",
+              GetFeatureCount() );
+
+    CPLErrorReset();
+
+    ResetReading();
+
+    return poLayer;
+}
+
+/************************************************************************/
+/*                            ResetReading()                            */
+/************************************************************************/
+
+void OGRGeoJSONReader::ResetReading()
+{
+    if( poScanner_ != NULL )
+        poScanner_->Rewind();
+    nNextFeatureIdx_ = 0;
+}
+
+/************************************************************************/
+/*                         ReadFeatureFromText()                        */
+/************************************************************************/
+
+OGRFeature* OGRGeoJSONReader::ReadFeatureFromText( OGRGeoJSONLayer* poLayer,
+                                                   const char* pszText )
+{
+    json_object* poObj = NULL;
+    if( !OGRJSonParse( pszText, &poObj ) )
+        return NULL;
+
+    OGRFeature* poFeature = ReadFeature( poLayer, poObj );
+    json_object_put( poObj );
+    return poFeature;
+}
+
+/************************************************************************/
+/*                             AssignFID()                              */
+/************************************************************************/
+
+// Sets the FID of the feature at index nIdx of the collection, as
+// OGRGeoJSONLayer::AddFeature() would in non-streaming mode. The FIDs that
+// differ from the id of the feature, or from its index when it has no id,
+// have been collected by BuildFIDMap().
+
+void OGRGeoJSONReader::AssignFID( OGRFeature* poFeature, GIntBig nIdx )
+{
+    const bool bHasId = ( -1 != poFeature->GetFID() );
+    GIntBig nFID = bHasId ? poFeature->GetFID() : nIdx;
+
+    std::map<GIntBig, GIntBig>::const_iterator oIter =
+        oMapIdxToFID_.find( nIdx );
+    if( oIter != oMapIdxToFID_.end() )
+        nFID = oIter->second;
+
+    poFeature->SetFID( nFID );
+
+    if( !bHasId )
+    {
+        const int nField =
+            poFeature->GetFieldIndex( OGRGeoJSONLayer::DefaultFIDColumn );
+        if( -1 != nField &&
+            (poFeature->GetFieldDefnRef(nField)->GetType() == OFTInteger ||
+             poFeature->GetFieldDefnRef(nField)->GetType() == OFTInteger64) )
+        {
+            poFeature->SetField( nField, nFID );
+        }
+    }
+}
+
+/************************************************************************/
+/*                           GetNextFeature()                           */
+/************************************************************************/
+
+OGRFeature* OGRGeoJSONReader::GetNextFeature( OGRGeoJSONLayer* poLayer )
+{
+    if( poScanner_ == NULL )
+        return NULL;
+
+    CPLString osFeature;
+    vsi_l_offset nOffset = 0;
+    if( !poScanner_->NextFeature( osFeature, nOffset ) )
+        return NULL;
+
+    if( bHasExplicitFID_ && !bFIDMapBuilt_ )
+        BuildFIDMap( poLayer );
+
+    OGRFeature* poFeature = ReadFeatureFromText( poLayer, osFeature );
+    if( poFeature != NULL )
+        AssignFID( poFeature, nNextFeatureIdx_ );
+    nNextFeatureIdx_ ++;
+    return poFeature;
+}
+
+/************************************************************************/
+/*                            BuildFIDMap()                             */
+/************************************************************************/
+
+// When FIDs come from the data, a full read is needed to know which
+// feature has a given FID. This is done once, on the first GetNextFeature()
+// or GetFeature() call, with a scanner of its own so as not to disturb
+// sequential reading.
+//
+// FIDs are allocated as OGRGeoJSONLayer::AddFeature() does in non-streaming
+// mode: a feature without id, or whose id is already used, gets the first
+// free FID starting from its index in the collection.
+
+void OGRGeoJSONReader::BuildFIDMap( OGRGeoJSONLayer* poLayer )
+{
+    bFIDMapBuilt_ = true;
+
+    bool bOriginalIdModified = false;
+    OGRGeoJSONFeatureScanner oScanner( fp_ );
+    CPLString osFeature;
+    vsi_l_offset nOffset = 0;
+    GIntBig nIdx = 0;
+    while( oScanner.NextFeature( osFeature, nOffset ) )
+    {
+        OGRFeature* poFeature = ReadFeatureFromText( poLayer, osFeature );
+        if( poFeature == NULL )
+            break;
+        const GIntBig nId = poFeature->GetFID();
+        delete poFeature;
+
+        GIntBig nFID = nId;
+        if( nId != -1 && oMapFIDToIdx_.find( nId ) != oMapFIDToIdx_.end() )
+        {
+            if( !bOriginalIdModified )
+            {
+                CPLError( CE_Warning, CPLE_AppDefined,
+                          "Several features with id = " CPL_FRMT_GIB " have "
+                          "been found. Altering it to be unique. This warning "
+                          "will not be emitted for this layer", nId );
+                bOriginalIdModified = true;
+            }
+            nFID = -1;
+        }
+        if( nFID == -1 )
+        {
+            nFID = nIdx;
+            while( oMapFIDToIdx_.find( nFID ) != oMapFIDToIdx_.end() )
+                nFID ++;
+        }
+
+        oMapFIDToIdx_[nFID] = nIdx;
+        if( nFID != (nId == -1 ? nIdx : nId) )
+            oMapIdxToFID_[nIdx] = nFID;
+        nIdx ++;
+    }
+}
+
+/************************************************************************/
+/*                             GetFeature()                             */
+/************************************************************************/
+
+OGRFeature* OGRGeoJSONReader::GetFeature( OGRGeoJSONLayer* poLayer,
+                                          GIntBig nFID )
+{
+    if( fp_ == NULL )
+        return NULL;
+
+    GIntBig nIdx = nFID;
+    if( bHasExplicitFID_ )
+    {
+        if( !bFIDMapBuilt_ )
+            BuildFIDMap( poLayer );
+        std::map<GIntBig, GIntBig>::const_iterator oIter =
+            oMapFIDToIdx_.find( nFID );
+        if( oIter == oMapFIDToIdx_.end() )
+            return NULL;
+        nIdx = oIter->second;
+    }
+    if( nIdx < 0 || nIdx >= GetFeatureCount() )
+        return NULL;
+
+    CPLString osFeature;
+    if( !OGRGeoJSONFeatureScanner::ReadObjectAt(
+                fp_, anFeatureOffsets_[static_cast<size_t>(nIdx)], osFeature ) )
+    {
+        CPLError( CE_Failure, CPLE_FileIO,
+                  "Cannot read feature " CPL_FRMT_GIB, nFID );
+        return NULL;
+    }
+
+    OGRFeature* poFeature = ReadFeatureFromText( poLayer, osFeature );
+    if( poFeature != NULL )
+        AssignFID( poFeature, nIdx );
+    return poFeature;
+}
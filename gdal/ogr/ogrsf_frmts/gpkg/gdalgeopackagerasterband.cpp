@@ -31,10 +31,52 @@
 #include "memdataset.h"
 #include "gdal_alg_priv.h"
 
+#include <algorithm>
+#include <vector>
+
 #if !defined(DEBUG_VERBOSE) && defined(DEBUG_VERBOSE_GPKG)
 #define DEBUG_VERBOSE
 #endif
 
+/* A tile fetched by PrefetchTiles(), to be decoded by a worker thread */
+struct GPKGTileDecodeJob
+{
+    GDALGPKGMBTilesLikePseudoDataset* poTPD;
+    int                 nBlockXOff;
+    int                 nBlockYOff;
+    GByte              *pabyBlob;
+    int                 nBlobSize;
+    GByte              *pabyTileData;
+};
+
+/* A tile prepared by WriteTileInternal(), to be encoded by a worker */
+/* thread and inserted in the database by the main thread */
+struct GPKGTileEncodeJob
+{
+    GDALGPKGMBTilesLikePseudoDataset* poMainDS;
+    GDALDriver         *poDriver;
+    GDALDataset        *poMEMDS;
+    GByte              *pabyTileData; /* owned copy of the tile, or NULL */
+    char              **papszDriverOptions;
+    CPLString           osMemFileName;
+    CPLString           osRasterTable;
+    int                 nZoomLevel;
+    int                 nTileRow; /* in the convention of the table */
+    int                 nTileCol;
+    GByte              *pabyBlob;
+    vsi_l_offset        nBlobSize;
+    bool                bReady;
+};
+
+static void FreeEncodeJob( GPKGTileEncodeJob* psJob )
+{
+    delete psJob->poMEMDS;
+    CPLFree(psJob->pabyTileData);
+    CSLDestroy(psJob->papszDriverOptions);
+    CPLFree(psJob->pabyBlob);
+    delete psJob;
+}
+
 /************************************************************************/
 /*                    GDALGPKGMBTilesLikePseudoDataset()                */
 /************************************************************************/
@@ -55,7 +97,10 @@ GDALGPKGMBTilesLikePseudoDataset::GDALGPKGMBTilesLikePseudoDataset() :
     m_nZLevel(6),
     m_nQuality(75),
     m_bDither(false),
-    m_poParentDS(NULL)
+    m_poParentDS(NULL),
+    m_poThreadPool(NULL),
+    m_nPoolThreads(-1),
+    m_hEncodeMutex(NULL)
 {
     for(int i=0;i<4;i++)
     {
@@ -87,6 +132,17 @@ GDALGPKGMBTilesLikePseudoDataset::GDALGPKGMBTilesLikePseudoDataset() :
 
 GDALGPKGMBTilesLikePseudoDataset::~GDALGPKGMBTilesLikePseudoDataset()
 {
+    // The dataset should have been flushed. If not, the database may
+    // already be closed, so just discard the pending tiles.
+    if( m_poThreadPool != NULL )
+        m_poThreadPool->WaitCompletion();
+    for( size_t i = 0; i < m_apsEncodeJobs.size(); i++ )
+        FreeEncodeJob(m_apsEncodeJobs[i]);
+    m_apsEncodeJobs.clear();
+    delete m_poThreadPool;
+    if( m_hEncodeMutex != NULL )
+        CPLDestroyMutex(m_hEncodeMutex);
+
     if( m_poParentDS == NULL && m_hTempDB != NULL )
     {
         sqlite3_close(m_hTempDB);
@@ -152,6 +208,9 @@ CPLErr GDALGPKGMBTilesLikePseudoDataset::FlushTiles()
         }
     }
 
+    if( FlushEncodedTiles() != CE_None )
+        eErr = CE_Failure;
+
     GDALGPKGMBTilesLikePseudoDataset* poMainDS = m_poParentDS ? m_poParentDS : this;
     if( poMainDS->m_nTileInsertionCount )
     {
@@ -181,6 +240,8 @@ GDALColorTable* GDALGPKGMBTilesLikeRasterBand::GetColorTable()
                 return m_poTPD->m_poCT;
             }
 
+            m_poTPD->FlushEncodedTiles();
+
             for( int i=0;i<2;i++)
             {
                 bool bRetry = false;
@@ -360,13 +421,33 @@ CPLErr GDALGPKGMBTilesLikePseudoDataset::ReadTile(const CPLString& osMemFileName
                                        bool* pbIsLossyFormat)
 {
     const char* apszDrivers[] = { "JPEG", "PNG", "WEBP", NULL };
+    const char* apszTileDriver[] = { NULL, NULL };
+    const char* const* papszDrivers = apszDrivers;
+
+    /* Only probe the driver matching the signature of the tile */
+    vsi_l_offset nTileDataSize = 0;
+    const GByte* pabySig = VSIGetMemFileBuffer(osMemFileName, &nTileDataSize,
+                                               FALSE);
+    if( pabySig != NULL && nTileDataSize >= 12 )
+    {
+        if( pabySig[0] == 0xFF && pabySig[1] == 0xD8 && pabySig[2] == 0xFF )
+            apszTileDriver[0] = "JPEG";
+        else if( memcmp(pabySig, "\x89PNG", 4) == 0 )
+            apszTileDriver[0] = "PNG";
+        else if( memcmp(pabySig, "RIFF", 4) == 0 &&
+                 memcmp(pabySig + 8, "WEBP", 4) == 0 )
+            apszTileDriver[0] = "WEBP";
+        if( apszTileDriver[0] != NULL )
+            papszDrivers = apszTileDriver;
+    }
+
     int nBlockXSize, nBlockYSize;
     IGetRasterBand(1)->GetBlockSize(&nBlockXSize, &nBlockYSize);
     const int nBands = IGetRasterCount();
     GDALDataset* poDSTile = reinterpret_cast<GDALDataset*>(
         GDALOpenEx( osMemFileName.c_str(),
                     GDAL_OF_RASTER | GDAL_OF_INTERNAL,
-                    apszDrivers, NULL, NULL ) );
+                    papszDrivers, NULL, NULL ) );
     if( poDSTile == NULL )
     {
         CPLError(CE_Failure, CPLE_AppDefined,
@@ -668,6 +749,9 @@ GByte* GDALGPKGMBTilesLikePseudoDataset::ReadTile( int nRow, int nCol, GByte *pa
     CPLDebug( "GPKG", "ReadTile(row=%d, col=%d)", nRow, nCol );
 #endif
 
+    /* The tile might still be in the encoding queue */
+    FlushEncodedTiles();
+
     char *pszSQL = sqlite3_mprintf( "SELECT tile_data FROM '%q' "
         "WHERE zoom_level = %d AND tile_row = %d AND tile_column = %d%s",
         m_osRasterTable.c_str(), m_nZoomLevel, GetRowFromIntoTopConvention(nRow), nCol,
@@ -768,6 +852,276 @@ GByte* GDALGPKGMBTilesLikePseudoDataset::ReadTile( int nRow, int nCol, GByte *pa
     return pabyData;
 }
 
+/************************************************************************/
+/*                           GetThreadPool()                            */
+/************************************************************************/
+
+/* Worker threads, shared with the overviews, used to decode and encode */
+/* tiles. NULL unless GDAL_NUM_THREADS is set to more than 1 */
+CPLWorkerThreadPool* GDALGPKGMBTilesLikePseudoDataset::GetThreadPool()
+{
+    if( m_poParentDS != NULL )
+        return m_poParentDS->GetThreadPool();
+
+    if( m_nPoolThreads < 0 )
+    {
+        m_nPoolThreads = 0;
+        const char* pszThreads = CPLGetConfigOption("GDAL_NUM_THREADS", NULL);
+        if( pszThreads != NULL )
+        {
+            m_nPoolThreads = EQUAL(pszThreads, "ALL_CPUS") ?
+                CPLGetNumCPUs() : atoi(pszThreads);
+            m_nPoolThreads = MIN(m_nPoolThreads, 128);
+        }
+        if( m_nPoolThreads > 1 )
+        {
+            m_poThreadPool = new CPLWorkerThreadPool();
+            if( !m_poThreadPool->Setup(m_nPoolThreads, NULL, NULL) )
+            {
+                delete m_poThreadPool;
+                m_poThreadPool = NULL;
+            }
+            else
+            {
+                m_hEncodeMutex = CPLCreateMutex();
+                CPLReleaseMutex(m_hEncodeMutex);
+            }
+        }
+    }
+    return m_poThreadPool;
+}
+
+/************************************************************************/
+/*                           DecodeTileJob()                            */
+/************************************************************************/
+
+void GDALGPKGMBTilesLikePseudoDataset::DecodeTileJob(void* pData)
+{
+    GPKGTileDecodeJob* psJob = static_cast<GPKGTileDecodeJob*>(pData);
+    CPLString osMemFileName;
+    osMemFileName.Printf("/vsimem/gpkg_read_tile_%p", psJob);
+    VSILFILE * fp = VSIFileFromMemBuffer(
+        osMemFileName.c_str(), psJob->pabyBlob, psJob->nBlobSize, FALSE );
+    VSIFCloseL(fp);
+
+    psJob->poTPD->ReadTile(osMemFileName, psJob->pabyTileData);
+    VSIUnlink(osMemFileName);
+}
+
+/************************************************************************/
+/*                           PrefetchTiles()                            */
+/************************************************************************/
+
+/* Load in the block cache the tiles intersecting a window that are not */
+/* already there. The tiles are fetched with a single SQL request and */
+/* decoded by the worker threads if there are some. Only done for */
+/* read-only datasets whose blocks are aligned on the tiles */
+void GDALGPKGMBTilesLikePseudoDataset::PrefetchTiles(int nXOff, int nYOff,
+                                                     int nXSize, int nYSize)
+{
+    if( IGetUpdate() || m_nShiftXPixelsMod != 0 || m_nShiftYPixelsMod != 0 ||
+        nXSize <= 0 || nYSize <= 0 )
+        return;
+
+    int nBlockXSize, nBlockYSize;
+    IGetRasterBand(1)->GetBlockSize(&nBlockXSize, &nBlockYSize);
+    const int nBands = IGetRasterCount();
+    const int nBlockXOff0 = nXOff / nBlockXSize;
+    const int nBlockYOff0 = nYOff / nBlockYSize;
+    const int nXBlocks = (nXOff + nXSize - 1) / nBlockXSize - nBlockXOff0 + 1;
+    const int nYBlocks = (nYOff + nYSize - 1) / nBlockYSize - nBlockYOff0 + 1;
+    const GIntBig nTiles = static_cast<GIntBig>(nXBlocks) * nYBlocks;
+    if( nTiles < 2 ||
+        nTiles * 4 * nBlockXSize * nBlockYSize > GDALGetCacheMax64() / 2 )
+        return;
+
+    /* Find the tiles with at least one band not in the block cache */
+    std::vector<bool> abNeeded(static_cast<size_t>(nTiles), false);
+    int nNeeded = 0;
+    for( int iY = 0; iY < nYBlocks; iY++ )
+    {
+        for( int iX = 0; iX < nXBlocks; iX++ )
+        {
+            for( int iBand = 1; iBand <= nBands; iBand++ )
+            {
+                GDALGPKGMBTilesLikeRasterBand* poBand =
+                    static_cast<GDALGPKGMBTilesLikeRasterBand*>(
+                        IGetRasterBand(iBand));
+                GDALRasterBlock* poBlock = poBand->AccessibleTryGetLockedBlockRef(
+                    nBlockXOff0 + iX, nBlockYOff0 + iY);
+                if( poBlock == NULL )
+                {
+                    abNeeded[iY * nXBlocks + iX] = true;
+                    nNeeded ++;
+                    break;
+                }
+                poBlock->DropLock();
+            }
+        }
+    }
+    if( nNeeded < 2 )
+        return;
+
+    /* Establish the color table before decoding in other threads */
+    if( nBands == 1 )
+        IGetRasterBand(1)->GetColorTable();
+
+    const int nRowMin = nBlockYOff0 + m_nShiftYTiles;
+    const int nRowMax = nRowMin + nYBlocks - 1;
+    const int nColMin = nBlockXOff0 + m_nShiftXTiles;
+    const int nColMax = nColMin + nXBlocks - 1;
+    int nTableRowMin = GetRowFromIntoTopConvention(nRowMin);
+    int nTableRowMax = GetRowFromIntoTopConvention(nRowMax);
+    if( nTableRowMin > nTableRowMax )
+        std::swap(nTableRowMin, nTableRowMax);
+
+    char *pszSQL = sqlite3_mprintf( "SELECT tile_row, tile_column, tile_data "
+        "FROM '%q' WHERE zoom_level = %d AND tile_row BETWEEN %d AND %d AND "
+        "tile_column BETWEEN %d AND %d%s",
+        m_osRasterTable.c_str(), m_nZoomLevel, nTableRowMin, nTableRowMax,
+        nColMin, nColMax,
+        m_osWHERE.size() ? CPLSPrintf(" AND (%s)", m_osWHERE.c_str()): "");
+
+#ifdef DEBUG_VERBOSE
+    CPLDebug("GPKG", "%s", pszSQL);
+#endif
+
+    sqlite3_stmt *hStmt = NULL;
+    int rc = sqlite3_prepare( IGetDB(), pszSQL, -1, &hStmt, NULL );
+    sqlite3_free( pszSQL );
+    if ( rc != SQLITE_OK )
+    {
+        /* IReadBlock() will report the error */
+        sqlite3_finalize( hStmt );
+        return;
+    }
+
+    const size_t nTileSize = 4 * static_cast<size_t>(nBlockXSize) * nBlockYSize;
+    std::vector<GPKGTileDecodeJob> asJobs;
+    std::vector<int> anJobIdx(static_cast<size_t>(nTiles), -1);
+    while( sqlite3_step( hStmt ) == SQLITE_ROW )
+    {
+        const int nRow =
+            GetRowFromIntoTopConvention(sqlite3_column_int( hStmt, 0 ));
+        const int nCol = sqlite3_column_int( hStmt, 1 );
+        if( nRow < nRowMin || nRow > nRowMax || nCol < nColMin ||
+            nCol > nColMax || nRow < 0 || nCol < 0 ||
+            nRow >= m_nTileMatrixHeight || nCol >= m_nTileMatrixWidth ||
+            sqlite3_column_type( hStmt, 2 ) != SQLITE_BLOB )
+            continue;
+        const int iIdx = (nRow - nRowMin) * nXBlocks + (nCol - nColMin);
+        if( !abNeeded[iIdx] || anJobIdx[iIdx] >= 0 )
+            continue;
+
+        GPKGTileDecodeJob sJob;
+        sJob.poTPD = this;
+        sJob.nBlockXOff = nBlockXOff0 + nCol - nColMin;
+        sJob.nBlockYOff = nBlockYOff0 + nRow - nRowMin;
+        sJob.nBlobSize = sqlite3_column_bytes( hStmt, 2 );
+        sJob.pabyBlob = static_cast<GByte*>(
+            VSI_MALLOC_VERBOSE(MAX(1, sJob.nBlobSize)));
+        sJob.pabyTileData = NULL;
+        if( sJob.pabyBlob == NULL )
+            break;
+        memcpy( sJob.pabyBlob, sqlite3_column_blob( hStmt, 2 ),
+                sJob.nBlobSize );
+        anJobIdx[iIdx] = static_cast<int>(asJobs.size());
+        asJobs.push_back(sJob);
+    }
+    sqlite3_finalize( hStmt );
+
+    GByte* pabyTiles = asJobs.empty() ? NULL : static_cast<GByte*>(
+        VSI_MALLOC2_VERBOSE(asJobs.size(), nTileSize));
+    if( !asJobs.empty() && pabyTiles == NULL )
+    {
+        for( size_t i = 0; i < asJobs.size(); i++ )
+            CPLFree(asJobs[i].pabyBlob);
+        return;
+    }
+
+    CPLDebug("GPKG", "Prefetch %d tiles at zoom_level=%d",
+             static_cast<int>(asJobs.size()), m_nZoomLevel);
+
+    /* Decode the tiles */
+    std::vector<void*> apJobs;
+    for( size_t i = 0; i < asJobs.size(); i++ )
+    {
+        asJobs[i].pabyTileData = pabyTiles + i * nTileSize;
+        apJobs.push_back(&asJobs[i]);
+    }
+    CPLWorkerThreadPool* poPool = GetThreadPool();
+    if( poPool != NULL && apJobs.size() > 1 )
+    {
+        poPool->SubmitJobs(DecodeTileJob, apJobs);
+        poPool->WaitCompletion();
+    }
+    else
+    {
+        for( size_t i = 0; i < apJobs.size(); i++ )
+            DecodeTileJob(apJobs[i]);
+    }
+
+    /* Fill the blocks. Tiles missing in the table are blank */
+    for( int iIdx = 0; iIdx < static_cast<int>(nTiles); iIdx++ )
+    {
+        if( !abNeeded[iIdx] )
+            continue;
+        const GByte* pabyTile = (anJobIdx[iIdx] >= 0) ?
+            asJobs[anJobIdx[iIdx]].pabyTileData : NULL;
+        const int nBlockXOff = nBlockXOff0 + iIdx % nXBlocks;
+        const int nBlockYOff = nBlockYOff0 + iIdx / nXBlocks;
+        for( int iBand = 1; iBand <= nBands; iBand++ )
+        {
+            GDALGPKGMBTilesLikeRasterBand* poBand =
+                static_cast<GDALGPKGMBTilesLikeRasterBand*>(
+                    IGetRasterBand(iBand));
+            GDALRasterBlock* poBlock =
+                poBand->AccessibleTryGetLockedBlockRef(nBlockXOff, nBlockYOff);
+            if( poBlock != NULL )
+            {
+                poBlock->DropLock();
+                continue;
+            }
+            poBlock = poBand->GetLockedBlockRef(nBlockXOff, nBlockYOff, TRUE);
+            if( poBlock == NULL )
+                continue;
+            if( pabyTile != NULL )
+                memcpy( poBlock->GetDataRef(),
+                        pabyTile + (iBand - 1) * nBlockXSize * nBlockYSize,
+                        nBlockXSize * nBlockYSize );
+            else
+                memset( poBlock->GetDataRef(), 0, nBlockXSize * nBlockYSize );
+            poBlock->DropLock();
+        }
+    }
+
+    for( size_t i = 0; i < asJobs.size(); i++ )
+        CPLFree(asJobs[i].pabyBlob);
+    CPLFree(pabyTiles);
+}
+
+/************************************************************************/
+/*                             IRasterIO()                              */
+/************************************************************************/
+
+CPLErr GDALGPKGMBTilesLikeRasterBand::IRasterIO( GDALRWFlag eRWFlag,
+                                                 int nXOff, int nYOff,
+                                                 int nXSize, int nYSize,
+                                                 void * pData,
+                                                 int nBufXSize, int nBufYSize,
+                                                 GDALDataType eBufType,
+                                                 GSpacing nPixelSpace,
+                                                 GSpacing nLineSpace,
+                                                 GDALRasterIOExtraArg* psExtraArg )
+{
+    if( eRWFlag == GF_Read && nXSize == nBufXSize && nYSize == nBufYSize )
+        m_poTPD->PrefetchTiles(nXOff, nYOff, nXSize, nYSize);
+
+    return GDALPamRasterBand::IRasterIO( eRWFlag, nXOff, nYOff, nXSize, nYSize,
+                                         pData, nBufXSize, nBufYSize, eBufType,
+                                         nPixelSpace, nLineSpace, psExtraArg );
+}
+
 /************************************************************************/
 /*                         IReadBlock()                                 */
 /************************************************************************/
@@ -1176,6 +1530,7 @@ CPLErr GDALGPKGMBTilesLikePseudoDataset::WriteTileInternal()
             // If tile is fully transparent, don't serialize it and remove it if it exists
             if( byFirstAlphaVal == 0 )
             {
+                FlushEncodedTiles();
                 char* pszSQL = sqlite3_mprintf("DELETE FROM '%q' "
                     "WHERE zoom_level = %d AND tile_row = %d AND tile_column = %d",
                     m_osRasterTable.c_str(), m_nZoomLevel, GetRowFromIntoTopConvention(nRow), nCol);
@@ -1207,8 +1562,6 @@ CPLErr GDALGPKGMBTilesLikePseudoDataset::WriteTileInternal()
                  nRow, nCol, m_nZoomLevel);
     }
 
-    CPLString osMemFileName;
-    osMemFileName.Printf("/vsimem/gpkg_write_tile_%p", this);
     const char* pszDriverName = "PNG";
     bool bTileDriverSupports1Band = false;
     bool bTileDriverSupports2Bands = false;
@@ -1258,6 +1611,22 @@ CPLErr GDALGPKGMBTilesLikePseudoDataset::WriteTileInternal()
     GDALDriver* l_poDriver = (GDALDriver*) GDALGetDriverByName(pszDriverName);
     if( l_poDriver != NULL)
     {
+        /* When tiles are encoded by worker threads, work on a copy of */
+        /* the tile as m_pabyCachedTiles is reused for the next one */
+        GDALGPKGMBTilesLikePseudoDataset* poMainDS = m_poParentDS ? m_poParentDS : this;
+        GByte* pabyTileData = m_pabyCachedTiles;
+        GByte* pabyTileDataCopy = NULL;
+        if( poMainDS->GetThreadPool() != NULL )
+        {
+            pabyTileDataCopy = static_cast<GByte*>(
+                VSI_MALLOC3_VERBOSE(4, nBlockXSize, nBlockYSize));
+            if( pabyTileDataCopy == NULL )
+                return CE_Failure;
+            memcpy(pabyTileDataCopy, m_pabyCachedTiles,
+                   4 * nBlockXSize * nBlockYSize);
+            pabyTileData = pabyTileDataCopy;
+        }
+
         GDALDataset* poMEMDS = MEMDataset::Create("", nBlockXSize, nBlockYSize,
                                                   0, GDT_Byte, NULL);
         int nTileBands = nBands;
@@ -1308,11 +1677,11 @@ CPLErr GDALGPKGMBTilesLikePseudoDataset::WriteTileInternal()
         if( bPartialTile && (nTileBands == 2 || nTileBands == 4) )
         {
             int nTargetAlphaBand = nTileBands;
-            memset(m_pabyCachedTiles + (nTargetAlphaBand-1) * nBlockXSize * nBlockYSize, 0,
+            memset(pabyTileData + (nTargetAlphaBand-1) * nBlockXSize * nBlockYSize, 0,
                   nBlockXSize * nBlockYSize);
             for(int iY = iYOff; iY < iYOff + iYCount; iY ++)
             {
-                memset(m_pabyCachedTiles + ((nTargetAlphaBand-1) * nBlockYSize + iY) * nBlockXSize + iXOff,
+                memset(pabyTileData + ((nTargetAlphaBand-1) * nBlockYSize + iY) * nBlockXSize + iXOff,
                        255, iXCount);
             }
         }
@@ -1329,7 +1698,7 @@ CPLErr GDALGPKGMBTilesLikePseudoDataset::WriteTileInternal()
             else if( nBands == 2 && nTileBands >= 3 )
                 iSrc = (i < 3) ? 0 : 1;
             int nRet = CPLPrintPointer(szDataPointer,
-                                       m_pabyCachedTiles + iSrc * nBlockXSize * nBlockYSize,
+                                       pabyTileData + iSrc * nBlockXSize * nBlockYSize,
                                        sizeof(szDataPointer));
             szDataPointer[nRet] = '\0';
             papszOptions = CSLSetNameValue(papszOptions, "DATAPOINTER", szDataPointer);
@@ -1348,7 +1717,7 @@ CPLErr GDALGPKGMBTilesLikePseudoDataset::WriteTileInternal()
                 char** papszOptions = NULL;
                 char szDataPointer[32];
                 int nRet = CPLPrintPointer(szDataPointer,
-                                        m_pabyCachedTiles + i * nBlockXSize * nBlockYSize,
+                                        pabyTileData + i * nBlockXSize * nBlockYSize,
                                         sizeof(szDataPointer));
                 szDataPointer[nRet] = '\0';
                 papszOptions = CSLSetNameValue(papszOptions, "DATAPOINTER", szDataPointer);
@@ -1369,9 +1738,9 @@ CPLErr GDALGPKGMBTilesLikePseudoDataset::WriteTileInternal()
                                        poMEM_RGB_DS->GetRasterBand(2),
                                        poMEM_RGB_DS->GetRasterBand(3),
                                        /*NULL, NULL, NULL,*/
-                                       m_pabyCachedTiles,
-                                       m_pabyCachedTiles + nBlockXSize * nBlockYSize,
-                                       m_pabyCachedTiles + 2 * nBlockXSize * nBlockYSize,
+                                       pabyTileData,
+                                       pabyTileData + nBlockXSize * nBlockYSize,
+                                       pabyTileData + 2 * nBlockXSize * nBlockYSize,
                                        NULL,
                                        256, /* max colors */
                                        8, /* bit depth */
@@ -1413,10 +1782,10 @@ CPLErr GDALGPKGMBTilesLikePseudoDataset::WriteTileInternal()
             }
             if( iYOff > 0 )
             {
-                memset(m_pabyCachedTiles + 0 * nBlockXSize * nBlockYSize, 0, nBlockXSize * iYOff);
-                memset(m_pabyCachedTiles + 1 * nBlockXSize * nBlockYSize, 0, nBlockXSize * iYOff);
-                memset(m_pabyCachedTiles + 2 * nBlockXSize * nBlockYSize, 0, nBlockXSize * iYOff);
-                memset(m_pabyCachedTiles + 3 * nBlockXSize * nBlockYSize, 0, nBlockXSize * iYOff);
+                memset(pabyTileData + 0 * nBlockXSize * nBlockYSize, 0, nBlockXSize * iYOff);
+                memset(pabyTileData + 1 * nBlockXSize * nBlockYSize, 0, nBlockXSize * iYOff);
+                memset(pabyTileData + 2 * nBlockXSize * nBlockYSize, 0, nBlockXSize * iYOff);
+                memset(pabyTileData + 3 * nBlockXSize * nBlockYSize, 0, nBlockXSize * iYOff);
             }
             int i;  // TODO: Rename the variable to make it clean what it is.
             for(int iY = iYOff; iY < iYOff + iYCount; iY ++)
@@ -1424,36 +1793,36 @@ CPLErr GDALGPKGMBTilesLikePseudoDataset::WriteTileInternal()
                 if( iXOff > 0 )
                 {
                     i = iY * nBlockXSize;
-                    memset(m_pabyCachedTiles + 0 * nBlockXSize * nBlockYSize + i, 0, iXOff);
-                    memset(m_pabyCachedTiles + 1 * nBlockXSize * nBlockYSize + i, 0, iXOff);
-                    memset(m_pabyCachedTiles + 2 * nBlockXSize * nBlockYSize + i, 0, iXOff);
-                    memset(m_pabyCachedTiles + 3 * nBlockXSize * nBlockYSize + i, 0, iXOff);
+                    memset(pabyTileData + 0 * nBlockXSize * nBlockYSize + i, 0, iXOff);
+                    memset(pabyTileData + 1 * nBlockXSize * nBlockYSize + i, 0, iXOff);
+                    memset(pabyTileData + 2 * nBlockXSize * nBlockYSize + i, 0, iXOff);
+                    memset(pabyTileData + 3 * nBlockXSize * nBlockYSize + i, 0, iXOff);
                 }
                 for(int iX = iXOff; iX < iXOff + iXCount; iX ++)
                 {
                     i = iY * nBlockXSize + iX;
-                    GByte byVal = m_pabyCachedTiles[i];
-                    m_pabyCachedTiles[i] = abyCT[4*byVal];
-                    m_pabyCachedTiles[i + 1 * nBlockXSize * nBlockYSize] = abyCT[4*byVal+1];
-                    m_pabyCachedTiles[i + 2 * nBlockXSize * nBlockYSize] = abyCT[4*byVal+2];
-                    m_pabyCachedTiles[i + 3 * nBlockXSize * nBlockYSize] = abyCT[4*byVal+3];
+                    GByte byVal = pabyTileData[i];
+                    pabyTileData[i] = abyCT[4*byVal];
+                    pabyTileData[i + 1 * nBlockXSize * nBlockYSize] = abyCT[4*byVal+1];
+                    pabyTileData[i + 2 * nBlockXSize * nBlockYSize] = abyCT[4*byVal+2];
+                    pabyTileData[i + 3 * nBlockXSize * nBlockYSize] = abyCT[4*byVal+3];
                 }
                 if( iXOff + iXCount < nBlockXSize )
                 {
                     i = iY * nBlockXSize + iXOff + iXCount;
-                    memset(m_pabyCachedTiles + 0 * nBlockXSize * nBlockYSize + i, 0, nBlockXSize - (iXOff + iXCount));
-                    memset(m_pabyCachedTiles + 1 * nBlockXSize * nBlockYSize + i, 0, nBlockXSize - (iXOff + iXCount));
-                    memset(m_pabyCachedTiles + 2 * nBlockXSize * nBlockYSize + i, 0, nBlockXSize - (iXOff + iXCount));
-                    memset(m_pabyCachedTiles + 3 * nBlockXSize * nBlockYSize + i, 0, nBlockXSize - (iXOff + iXCount));
+                    memset(pabyTileData + 0 * nBlockXSize * nBlockYSize + i, 0, nBlockXSize - (iXOff + iXCount));
+                    memset(pabyTileData + 1 * nBlockXSize * nBlockYSize + i, 0, nBlockXSize - (iXOff + iXCount));
+                    memset(pabyTileData + 2 * nBlockXSize * nBlockYSize + i, 0, nBlockXSize - (iXOff + iXCount));
+                    memset(pabyTileData + 3 * nBlockXSize * nBlockYSize + i, 0, nBlockXSize - (iXOff + iXCount));
                 }
             }
             if( iYOff + iYCount < nBlockYSize )
             {
                 i = (iYOff + iYCount) * nBlockXSize;
-                memset(m_pabyCachedTiles + 0 * nBlockXSize * nBlockYSize + i, 0, nBlockXSize * (nBlockYSize - (iYOff + iYCount)));
-                memset(m_pabyCachedTiles + 1 * nBlockXSize * nBlockYSize + i, 0, nBlockXSize * (nBlockYSize - (iYOff + iYCount)));
-                memset(m_pabyCachedTiles + 2 * nBlockXSize * nBlockYSize + i, 0, nBlockXSize * (nBlockYSize - (iYOff + iYCount)));
-                memset(m_pabyCachedTiles + 3 * nBlockXSize * nBlockYSize + i, 0, nBlockXSize * (nBlockYSize - (iYOff + iYCount)));
+                memset(pabyTileData + 0 * nBlockXSize * nBlockYSize + i, 0, nBlockXSize * (nBlockYSize - (iYOff + iYCount)));
+                memset(pabyTileData + 1 * nBlockXSize * nBlockYSize + i, 0, nBlockXSize * (nBlockYSize - (iYOff + iYCount)));
+                memset(pabyTileData + 2 * nBlockXSize * nBlockYSize + i, 0, nBlockXSize * (nBlockYSize - (iYOff + iYCount)));
+                memset(pabyTileData + 3 * nBlockXSize * nBlockYSize + i, 0, nBlockXSize * (nBlockYSize - (iYOff + iYCount)));
             }
         }
 
@@ -1468,76 +1837,187 @@ CPLErr GDALGPKGMBTilesLikePseudoDataset::WriteTileInternal()
             papszDriverOptions = CSLSetNameValue(
                 papszDriverOptions, "ZLEVEL", CPLSPrintf("%d", m_nZLevel));
         }
+
+        GPKGTileEncodeJob* psJob = new GPKGTileEncodeJob();
+        psJob->poMainDS = poMainDS;
+        psJob->poDriver = l_poDriver;
+        psJob->poMEMDS = poMEMDS;
+        psJob->pabyTileData = pabyTileDataCopy;
+        psJob->papszDriverOptions = papszDriverOptions;
+        psJob->osMemFileName.Printf("/vsimem/gpkg_write_tile_%p", psJob);
+        psJob->osRasterTable = m_osRasterTable;
+        psJob->nZoomLevel = m_nZoomLevel;
+        psJob->nTileRow = GetRowFromIntoTopConvention(nRow);
+        psJob->nTileCol = nCol;
+        psJob->pabyBlob = NULL;
+        psJob->nBlobSize = 0;
+        psJob->bReady = false;
+        eErr = poMainDS->QueueTileEncoding(psJob);
+    }
+    else
+    {
+        CPLError(CE_Failure, CPLE_NotSupported,
+                 "Cannot find driver %s", pszDriverName);
+    }
+
+    return eErr;
+}
+
+/************************************************************************/
+/*                           EncodeTileJob()                            */
+/************************************************************************/
+
+void GDALGPKGMBTilesLikePseudoDataset::EncodeTileJob(void* pData)
+{
+    GPKGTileEncodeJob* psJob = static_cast<GPKGTileEncodeJob*>(pData);
+
 #ifdef DEBUG
-        VSIStatBufL sStat;
-        CPLAssert(VSIStatL(osMemFileName, &sStat) != 0);
+    VSIStatBufL sStat;
+    CPLAssert(VSIStatL(psJob->osMemFileName, &sStat) != 0);
 #endif
-        GDALDataset* poOutDS = l_poDriver->CreateCopy(osMemFileName, poMEMDS,
-                                                    FALSE, papszDriverOptions, NULL, NULL);
-        CSLDestroy( papszDriverOptions );
-        if( poOutDS )
-        {
-            GDALClose( poOutDS );
-            vsi_l_offset nBlobSize;
-            GByte* pabyBlob = VSIGetMemFileBuffer(osMemFileName, &nBlobSize, TRUE);
-
-            /* Create or commit and recreate transaction */
-            GDALGPKGMBTilesLikePseudoDataset* poMainDS = m_poParentDS ? m_poParentDS : this;
-            if( poMainDS->m_nTileInsertionCount == 0 )
-            {
-                poMainDS->IStartTransaction();
-            }
-            else if( poMainDS->m_nTileInsertionCount == 1000 )
+    GDALDataset* poOutDS = psJob->poDriver->CreateCopy(
+        psJob->osMemFileName, psJob->poMEMDS, FALSE,
+        psJob->papszDriverOptions, NULL, NULL);
+    GByte* pabyBlob = NULL;
+    vsi_l_offset nBlobSize = 0;
+    if( poOutDS )
+    {
+        GDALClose( poOutDS );
+        pabyBlob = VSIGetMemFileBuffer(psJob->osMemFileName, &nBlobSize, TRUE);
+    }
+    VSIUnlink(psJob->osMemFileName);
+
+    CPLMutex* hMutex = psJob->poMainDS->m_hEncodeMutex;
+    if( hMutex )
+        CPLAcquireMutex(hMutex, 1000.0);
+    psJob->pabyBlob = pabyBlob;
+    psJob->nBlobSize = nBlobSize;
+    psJob->bReady = true;
+    if( hMutex )
+        CPLReleaseMutex(hMutex);
+}
+
+/************************************************************************/
+/*                         QueueTileEncoding()                          */
+/************************************************************************/
+
+/* Tiles are inserted in the order they are queued, so the content of */
+/* the database does not depend on the number of threads. Returns the */
+/* error of inserting the previous tiles */
+CPLErr GDALGPKGMBTilesLikePseudoDataset::QueueTileEncoding(
+                                                    GPKGTileEncodeJob* psJob)
+{
+    CPLAssert( m_poParentDS == NULL );
+    m_apsEncodeJobs.push_back(psJob);
+    if( GetThreadPool() == NULL )
+    {
+        EncodeTileJob(psJob);
+        return WriteEncodedTiles();
+    }
+    m_poThreadPool->SubmitJob(EncodeTileJob, psJob);
+    // Keep the workers busy while bounding the memory used by pending tiles
+    return WriteEncodedTiles(2 * m_nPoolThreads);
+}
+
+/************************************************************************/
+/*                         WriteEncodedTiles()                          */
+/************************************************************************/
+
+CPLErr GDALGPKGMBTilesLikePseudoDataset::WriteEncodedTiles(size_t nMaxQueued)
+{
+    CPLErr eErr = CE_None;
+    while( m_apsEncodeJobs.size() > nMaxQueued )
+    {
+        GPKGTileEncodeJob* psJob = m_apsEncodeJobs.front();
+        while( m_poThreadPool != NULL )
+        {
+            // Count the tiles not encoded yet, and wait for one more
+            int nPending = 0;
+            CPLAcquireMutex(m_hEncodeMutex, 1000.0);
+            const bool bReady = psJob->bReady;
+            for( size_t i = 0; i < m_apsEncodeJobs.size(); i++ )
             {
-                poMainDS->ICommitTransaction();
-                poMainDS->IStartTransaction();
-                poMainDS->m_nTileInsertionCount = 0;
+                if( !m_apsEncodeJobs[i]->bReady )
+                    nPending ++;
             }
-            poMainDS->m_nTileInsertionCount ++;
+            CPLReleaseMutex(m_hEncodeMutex);
+            if( bReady )
+                break;
+            m_poThreadPool->WaitCompletion(nPending - 1);
+        }
+        m_apsEncodeJobs.pop_front();
+
+        if( psJob->pabyBlob == NULL )
+        {
+            eErr = CE_Failure;
+            FreeEncodeJob(psJob);
+            continue;
+        }
+
+        /* Create or commit and recreate transaction */
+        if( m_nTileInsertionCount == 0 )
+        {
+            IStartTransaction();
+        }
+        else if( m_nTileInsertionCount == 1000 )
+        {
+            ICommitTransaction();
+            IStartTransaction();
+            m_nTileInsertionCount = 0;
+        }
+        m_nTileInsertionCount ++;
 
-            char* pszSQL = sqlite3_mprintf("INSERT OR REPLACE INTO '%q' "
-                "(zoom_level, tile_row, tile_column, tile_data) VALUES (%d, %d, %d, ?)",
-                m_osRasterTable.c_str(), m_nZoomLevel, GetRowFromIntoTopConvention(nRow), nCol);
+        char* pszSQL = sqlite3_mprintf("INSERT OR REPLACE INTO '%q' "
+            "(zoom_level, tile_row, tile_column, tile_data) VALUES (%d, %d, %d, ?)",
+            psJob->osRasterTable.c_str(), psJob->nZoomLevel, psJob->nTileRow,
+            psJob->nTileCol);
 #ifdef DEBUG_VERBOSE
-            CPLDebug("GPKG", "%s", pszSQL);
+        CPLDebug("GPKG", "%s", pszSQL);
 #endif
-            sqlite3_stmt* hStmt = NULL;
-            int rc = sqlite3_prepare(IGetDB(), pszSQL, -1, &hStmt, NULL);
-            if ( rc != SQLITE_OK )
-            {
-                CPLError( CE_Failure, CPLE_AppDefined, "failed to prepare SQL %s: %s",
-                          pszSQL, sqlite3_errmsg(IGetDB()) );
-                CPLFree(pabyBlob);
-            }
-            else
+        sqlite3_stmt* hStmt = NULL;
+        int rc = sqlite3_prepare(IGetDB(), pszSQL, -1, &hStmt, NULL);
+        if ( rc != SQLITE_OK )
+        {
+            CPLError( CE_Failure, CPLE_AppDefined, "failed to prepare SQL %s: %s",
+                      pszSQL, sqlite3_errmsg(IGetDB()) );
+            eErr = CE_Failure;
+        }
+        else
+        {
+            sqlite3_bind_blob( hStmt, 1, psJob->pabyBlob,
+                               (int)psJob->nBlobSize, CPLFree);
+            psJob->pabyBlob = NULL;
+            rc = sqlite3_step( hStmt );
+            if( rc != SQLITE_DONE )
             {
-                sqlite3_bind_blob( hStmt, 1, pabyBlob, (int)nBlobSize, CPLFree);
-                rc = sqlite3_step( hStmt );
-                if( rc == SQLITE_DONE )
-                    eErr = CE_None;
-                else
-                {
-                    CPLError(CE_Failure, CPLE_AppDefined,
-                             "Failure when inserting tile (row=%d,col=%d) at zoom_level=%d : %s",
-                             GetRowFromIntoTopConvention(nRow), nCol, m_nZoomLevel, sqlite3_errmsg(IGetDB()));
-                }
+                CPLError(CE_Failure, CPLE_AppDefined,
+                         "Failure when inserting tile (row=%d,col=%d) at zoom_level=%d : %s",
+                         psJob->nTileRow, psJob->nTileCol, psJob->nZoomLevel,
+                         sqlite3_errmsg(IGetDB()));
+                eErr = CE_Failure;
             }
-            sqlite3_finalize(hStmt);
-            sqlite3_free(pszSQL);
         }
-
-        VSIUnlink(osMemFileName);
-        delete poMEMDS;
-    }
-    else
-    {
-        CPLError(CE_Failure, CPLE_NotSupported,
-                 "Cannot find driver %s", pszDriverName);
+        sqlite3_finalize(hStmt);
+        sqlite3_free(pszSQL);
+        FreeEncodeJob(psJob);
     }
-
     return eErr;
 }
 
+/************************************************************************/
+/*                         FlushEncodedTiles()                          */
+/************************************************************************/
+
+/* Insert the tiles still in the encoding queue. To be called before */
+/* anything that relies on the content of the tile table */
+CPLErr GDALGPKGMBTilesLikePseudoDataset::FlushEncodedTiles()
+{
+    GDALGPKGMBTilesLikePseudoDataset* poMainDS = m_poParentDS ? m_poParentDS : this;
+    if( poMainDS->m_apsEncodeJobs.empty() )
+        return CE_None;
+    return poMainDS->WriteEncodedTiles();
+}
+
 /************************************************************************/
 /*                     FlushRemainingShiftedTiles()                     */
 /************************************************************************/
@@ -1692,6 +2172,7 @@ CPLErr GDALGPKGMBTilesLikePseudoDataset::FlushRemainingShiftedTiles(bool bPartia
             // temporary database
             if( nPartialFlags != nFullFlags )
             {
+                FlushEncodedTiles();
                 char* pszNewSQL = sqlite3_mprintf("SELECT tile_data FROM '%q' "
                         "WHERE zoom_level = %d AND tile_row = %d AND tile_column = %d%s",
                         m_osRasterTable.c_str(), m_nZoomLevel, GetRowFromIntoTopConvention(nRow), nCol,
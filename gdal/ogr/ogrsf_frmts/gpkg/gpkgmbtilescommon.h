@@ -31,9 +31,12 @@
 #define GPKGMBTILESCOMMON_H_INCLUDED
 
 #include "cpl_string.h"
+#include "cpl_worker_thread_pool.h"
 #include "gdal_pam.h"
 #include "ogr_sqlite.h" // for sqlite3*
 
+#include <deque>
+
 typedef struct
 {
     int     nRow;
@@ -53,6 +56,9 @@ typedef enum
 
 GPKGTileFormat GDALGPKGMBTilesGetTileFormat(const char* pszTF );
 
+struct GPKGTileDecodeJob;
+struct GPKGTileEncodeJob;
+
 class GDALGPKGMBTilesLikePseudoDataset
 {
     friend class GDALGPKGMBTilesLikeRasterBand;
@@ -97,9 +103,21 @@ class GDALGPKGMBTilesLikePseudoDataset
 
     GDALGPKGMBTilesLikePseudoDataset* m_poParentDS;
 
+    CPLWorkerThreadPool*            m_poThreadPool;
+    int                             m_nPoolThreads;
+    CPLMutex*                       m_hEncodeMutex;
+    std::deque<GPKGTileEncodeJob*>  m_apsEncodeJobs;
+
         bool                    m_bInWriteTile;
         CPLErr                  WriteTileInternal(); /* should only be called by WriteTile() */
 
+        CPLWorkerThreadPool*    GetThreadPool();
+        CPLErr                  QueueTileEncoding(GPKGTileEncodeJob* psJob);
+        CPLErr                  WriteEncodedTiles(size_t nMaxQueued = 0);
+        CPLErr                  FlushEncodedTiles();
+        static void             DecodeTileJob(void* pData);
+        static void             EncodeTileJob(void* pData);
+
   public:
                                 GDALGPKGMBTilesLikePseudoDataset();
         virtual                ~GDALGPKGMBTilesLikePseudoDataset();
@@ -111,6 +129,9 @@ class GDALGPKGMBTilesLikePseudoDataset
         GByte*                  ReadTile(int nRow, int nCol, GByte* pabyData,
                                          bool* pbIsLossyFormat = NULL);
 
+        void                    PrefetchTiles(int nXOff, int nYOff,
+                                              int nXSize, int nYSize);
+
         CPLErr                  WriteTile();
 
         CPLErr                  FlushTiles();
@@ -144,6 +165,10 @@ class GDALGPKGMBTilesLikeRasterBand: public GDALPamRasterBand
                                            void* pData);
         virtual CPLErr          IWriteBlock(int nBlockXOff, int nBlockYOff,
                                            void* pData);
+        virtual CPLErr          IRasterIO( GDALRWFlag, int, int, int, int,
+                                           void *, int, int, GDALDataType,
+                                           GSpacing, GSpacing,
+                                           GDALRasterIOExtraArg* psExtraArg );
         virtual CPLErr          FlushCache();
 
         virtual GDALColorTable* GetColorTable();
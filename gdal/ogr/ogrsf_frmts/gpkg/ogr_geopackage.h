@@ -35,6 +35,8 @@
 #include "ogrgeopackageutility.h"
 #include "gpkgmbtilescommon.h"
 
+#include <vector>
+
 #define UNKNOWN_SRID   -2
 #define DEFAULT_SRID    0
 
@@ -155,6 +157,10 @@ class GDALGeoPackageDataset CPL_FINAL : public OGRSQLiteBaseDataSource, public G
         virtual CPLErr      SetGeoTransform( double* padfGeoTransform );
 
         virtual void        FlushCache();
+        virtual CPLErr      IRasterIO( GDALRWFlag, int, int, int, int,
+                                       void *, int, int, GDALDataType,
+                                       int, int *, GSpacing, GSpacing, GSpacing,
+                                       GDALRasterIOExtraArg* psExtraArg );
         virtual CPLErr      IBuildOverviews( const char *, int, int *,
                                              int, int *, GDALProgressFunc, void * );
 
@@ -290,6 +296,17 @@ class OGRGeoPackageLayer : public OGRLayer, public IOGRSQLiteGetSpatialWhere
 /*                        OGRGeoPackageTableLayer                       */
 /************************************************************************/
 
+/* Cell of a node of the rtree_<t>_<c> virtual table, with the coordinates */
+/* rounded to float as the SQLite rtree module does */
+typedef struct
+{
+    GIntBig     nId;
+    float       fMinX;
+    float       fMaxX;
+    float       fMinY;
+    float       fMaxY;
+} GPKGRTreeEntry;
+
 class OGRGeoPackageTableLayer CPL_FINAL : public OGRGeoPackageLayer
 {
     char*                       m_pszTableName;
@@ -306,6 +323,11 @@ class OGRGeoPackageTableLayer CPL_FINAL : public OGRGeoPackageLayer
     // m_bHasSpatialIndex cannot be bool.  -1 is unset.
     int                         m_bHasSpatialIndex;
     bool                        m_bDropRTreeTable;
+    // Envelopes of the features inserted while the spatial index creation
+    // is deferred. Only valid if m_bRTreeEntriesValid.
+    bool                        m_bRTreeEntriesValid;
+    size_t                      m_nMaxRTreeEntries;
+    std::vector<GPKGRTreeEntry> m_asRTreeEntries;
     bool                        m_abHasGeometryExtension[wkbTIN+1];
     bool                        m_bPreservePrecision;
     bool                        m_bTruncateFields;
@@ -361,8 +383,7 @@ class OGRGeoPackageTableLayer CPL_FINAL : public OGRGeoPackageLayer
                                                const char* pszFIDColumnName,
                                                const char* pszIdentifier,
                                                const char* pszDescription );
-    void                SetDeferredSpatialIndexCreation( bool bFlag )
-                                { m_bDeferredSpatialIndexCreation = bFlag; }
+    void                SetDeferredSpatialIndexCreation( bool bFlag );
 
     void                CreateSpatialIndexIfNecessary();
     bool                CreateSpatialIndex();
@@ -408,6 +429,12 @@ class OGRGeoPackageTableLayer CPL_FINAL : public OGRGeoPackageLayer
 
     void                CheckUnknownExtensions();
     bool                CreateGeometryExtensionIfNecessary(OGRwkbGeometryType eGType);
+
+    void                AddRTreeEntry( GIntBig nFID, OGRGeometry* poGeom,
+                                       const OGREnvelope& sEnvelope );
+    void                InvalidateRTreeEntries();
+    bool                CollectRTreeEntries();
+    OGRErr              BulkLoadRTree();
 };
 
 /************************************************************************/
@@ -1433,6 +1433,29 @@ CPLErr GDALGeoPackageDataset::FinalizeRasterRegistration()
     return CE_None;
 }
 
+/************************************************************************/
+/*                             IRasterIO()                              */
+/************************************************************************/
+
+CPLErr GDALGeoPackageDataset::IRasterIO( GDALRWFlag eRWFlag,
+                                          int nXOff, int nYOff, int nXSize, int nYSize,
+                                          void * pData, int nBufXSize, int nBufYSize,
+                                          GDALDataType eBufType,
+                                          int nBandCount, int *panBandMap,
+                                          GSpacing nPixelSpace, GSpacing nLineSpace,
+                                          GSpacing nBandSpace,
+                                          GDALRasterIOExtraArg* psExtraArg )
+{
+    if( eRWFlag == GF_Read && nXSize == nBufXSize && nYSize == nBufYSize )
+        PrefetchTiles(nXOff, nYOff, nXSize, nYSize);
+
+    return GDALPamDataset::IRasterIO( eRWFlag, nXOff, nYOff, nXSize, nYSize,
+                                      pData, nBufXSize, nBufYSize, eBufType,
+                                      nBandCount, panBandMap,
+                                      nPixelSpace, nLineSpace, nBandSpace,
+                                      psExtraArg );
+}
+
 /************************************************************************/
 /*                             FlushCache()                             */
 /************************************************************************/
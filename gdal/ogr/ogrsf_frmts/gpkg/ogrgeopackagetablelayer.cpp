@@ -33,6 +33,10 @@
 #include "cpl_time.h"
 #include "ogr_p.h"
 
+#include <algorithm>
+#include <limits>
+#include <new>
+
 //----------------------------------------------------------------------
 // SaveExtent()
 //
@@ -861,6 +865,8 @@ OGRGeoPackageTableLayer::OGRGeoPackageTableLayer(
     m_bDeferredSpatialIndexCreation = false;
     m_bHasSpatialIndex = -1;
     m_bDropRTreeTable = false;
+    m_bRTreeEntriesValid = false;
+    m_nMaxRTreeEntries = 0;
     memset(m_abHasGeometryExtension, 0, sizeof(m_abHasGeometryExtension)); /* false */
     m_bPreservePrecision = true;
     m_bTruncateFields = false;
@@ -1212,9 +1218,10 @@ OGRErr OGRGeoPackageTableLayer::ICreateFeature( OGRFeature *poFeature )
     }
 
     /* Update the layer extents with this new object */
-    if ( IsGeomFieldSet(poFeature) )
+    OGREnvelope oEnv;
+    const bool bGeomFieldSet = CPL_TO_BOOL(IsGeomFieldSet(poFeature));
+    if ( bGeomFieldSet )
     {
-        OGREnvelope oEnv;
         poFeature->GetGeomFieldRef(0)->getEnvelope(&oEnv);
         UpdateExtent(&oEnv);
     }
@@ -1230,8 +1237,13 @@ OGRErr OGRGeoPackageTableLayer::ICreateFeature( OGRFeature *poFeature )
     else
     {
         poFeature->SetFID(OGRNullFID);
+        InvalidateRTreeEntries();
     }
 
+    /* Remember the envelope for the deferred spatial index creation */
+    if( m_bRTreeEntriesValid && bGeomFieldSet )
+        AddRTreeEntry( nFID, poFeature->GetGeomFieldRef(0), oEnv );
+
     /* All done! */
     return OGRERR_NONE;
 }
@@ -1271,6 +1283,9 @@ OGRErr OGRGeoPackageTableLayer::ISetFeature( OGRFeature *poFeature )
     if( m_bDeferredCreation && RunDeferredCreationIfNecessary() != OGRERR_NONE )
         return OGRERR_FAILURE;
 
+    /* The envelopes collected at insertion time may no longer match */
+    InvalidateRTreeEntries();
+
     /* Old version of SQLite have issues with some of the spatial index triggers */
 #if SQLITE_VERSION_NUMBER < 3007008
     if( HasSpatialIndex() )
@@ -1545,6 +1560,8 @@ OGRErr OGRGeoPackageTableLayer::DeleteFeature(GIntBig nFID)
     if( m_bDeferredCreation && RunDeferredCreationIfNecessary() != OGRERR_NONE )
         return OGRERR_FAILURE;
 
+    InvalidateRTreeEntries();
+
     /* Clear out any existing query */
     ResetReading();
 
@@ -1712,6 +1729,673 @@ int OGRGeoPackageTableLayer::TestCapability ( const char * pszCap )
     }
 }
 
+/************************************************************************/
+/*                      GPKGGetMaxRTreeEntries()                        */
+/************************************************************************/
+
+/* Bytes of a cell of a node of a rtree(id, minx, maxx, miny, maxy) table */
+#define GPKG_RTREE_CELL_SIZE            (8 + 4 * 4)
+
+/* Bounds of the batches of geometry blobs in CollectRTreeEntries() */
+#define GPKG_RTREE_EXTRACT_BATCH_COUNT  1000
+#define GPKG_RTREE_EXTRACT_BATCH_SIZE   (4 * 1024 * 1024)
+
+/* Maximum number of envelopes kept in memory to bulk load the RTree. */
+/* Beyond that, the RTree is filled with SQL statements. */
+static size_t GPKGGetMaxRTreeEntries()
+{
+    const GIntBig nMaxRAM = CPLAtoGIntBig(
+        CPLGetConfigOption("OGR_GPKG_MAX_RAM_USAGE_RTREE", "536870912"));
+    if( nMaxRAM <= 0 )
+        return 0;
+    return static_cast<size_t>(std::min(
+        nMaxRAM / static_cast<GIntBig>(sizeof(GPKGRTreeEntry)),
+        static_cast<GIntBig>(std::numeric_limits<int>::max())));
+}
+
+/************************************************************************/
+/*                        GPKGMakeRTreeEntry()                          */
+/************************************************************************/
+
+/* Same rounding of the coordinates to float as rtreeValueDown() and */
+/* rtreeValueUp() of the SQLite rtree module, so that the box of the */
+/* entry contains the envelope */
+#define GPKG_RTREE_RNDTOWARDS   (1.0 - 1.0 / 8388608.0)
+#define GPKG_RTREE_RNDAWAY      (1.0 + 1.0 / 8388608.0)
+
+static float GPKGRTreeValueDown( double dfVal )
+{
+    float fVal = static_cast<float>(dfVal);
+    if( fVal > dfVal )
+        fVal = static_cast<float>(dfVal * (dfVal < 0 ? GPKG_RTREE_RNDAWAY :
+                                                       GPKG_RTREE_RNDTOWARDS));
+    return fVal;
+}
+
+static float GPKGRTreeValueUp( double dfVal )
+{
+    float fVal = static_cast<float>(dfVal);
+    if( fVal < dfVal )
+        fVal = static_cast<float>(dfVal * (dfVal < 0 ? GPKG_RTREE_RNDTOWARDS :
+                                                       GPKG_RTREE_RNDAWAY));
+    return fVal;
+}
+
+/* Returns false if the envelope cannot be stored as a float box */
+static bool GPKGMakeRTreeEntry( GIntBig nFID, const OGREnvelope& sEnvelope,
+                                GPKGRTreeEntry* psEntry )
+{
+    const double dfMax = std::numeric_limits<float>::max();
+    if( !(sEnvelope.MinX >= -dfMax && sEnvelope.MinX <= sEnvelope.MaxX &&
+          sEnvelope.MaxX <= dfMax &&
+          sEnvelope.MinY >= -dfMax && sEnvelope.MinY <= sEnvelope.MaxY &&
+          sEnvelope.MaxY <= dfMax) )
+    {
+        return false;
+    }
+    psEntry->nId = nFID;
+    psEntry->fMinX = GPKGRTreeValueDown(sEnvelope.MinX);
+    psEntry->fMaxX = GPKGRTreeValueUp(sEnvelope.MaxX);
+    psEntry->fMinY = GPKGRTreeValueDown(sEnvelope.MinY);
+    psEntry->fMaxY = GPKGRTreeValueUp(sEnvelope.MaxY);
+    return true;
+}
+
+/************************************************************************/
+/*                        GPKGRTreeWriteCell()                          */
+/************************************************************************/
+
+/* Node content is big-endian */
+static void GPKGRTreeWriteInt( GByte* pabyDst, int nBytes, GIntBig nVal )
+{
+    for( int i = 0; i < nBytes; i++ )
+        pabyDst[i] = static_cast<GByte>(
+            static_cast<GUIntBig>(nVal) >> (8 * (nBytes - 1 - i)));
+}
+
+static void GPKGRTreeWriteFloat( GByte* pabyDst, float fVal )
+{
+    GUInt32 nVal;
+    memcpy(&nVal, &fVal, sizeof(nVal));
+    GPKGRTreeWriteInt(pabyDst, 4, nVal);
+}
+
+static void GPKGRTreeWriteCell( GByte* pabyDst, const GPKGRTreeEntry& sEntry )
+{
+    GPKGRTreeWriteInt(pabyDst, 8, sEntry.nId);
+    GPKGRTreeWriteFloat(pabyDst + 8, sEntry.fMinX);
+    GPKGRTreeWriteFloat(pabyDst + 12, sEntry.fMaxX);
+    GPKGRTreeWriteFloat(pabyDst + 16, sEntry.fMinY);
+    GPKGRTreeWriteFloat(pabyDst + 20, sEntry.fMaxY);
+}
+
+/************************************************************************/
+/*                         GPKGSTRSortLevel()                           */
+/************************************************************************/
+
+typedef struct
+{
+    GPKGRTreeEntry* pasBegin;
+    /* NULL to sort [pasBegin, pasEnd[, otherwise to merge its two sorted */
+    /* halves [pasBegin, pasMiddle[ and [pasMiddle, pasEnd[ */
+    GPKGRTreeEntry* pasMiddle;
+    GPKGRTreeEntry* pasEnd;
+    bool            bOnY;
+} GPKGRTreeSortJob;
+
+static bool GPKGRTreeLessX( const GPKGRTreeEntry& sA, const GPKGRTreeEntry& sB )
+{
+    return static_cast<double>(sA.fMinX) + sA.fMaxX <
+           static_cast<double>(sB.fMinX) + sB.fMaxX;
+}
+
+static bool GPKGRTreeLessY( const GPKGRTreeEntry& sA, const GPKGRTreeEntry& sB )
+{
+    return static_cast<double>(sA.fMinY) + sA.fMaxY <
+           static_cast<double>(sB.fMinY) + sB.fMaxY;
+}
+
+static void GPKGRTreeSortJobFunc( void* pData )
+{
+    GPKGRTreeSortJob* psJob = static_cast<GPKGRTreeSortJob*>(pData);
+    bool (*pfnLess)(const GPKGRTreeEntry&, const GPKGRTreeEntry&) =
+        psJob->bOnY ? GPKGRTreeLessY : GPKGRTreeLessX;
+    if( psJob->pasMiddle == NULL )
+        std::sort(psJob->pasBegin, psJob->pasEnd, pfnLess);
+    else
+        std::inplace_merge(psJob->pasBegin, psJob->pasMiddle, psJob->pasEnd,
+                           pfnLess);
+}
+
+static void GPKGRunRTreeSortJobs( std::vector<GPKGRTreeSortJob>& asJobs,
+                                  CPLWorkerThreadPool* poPool )
+{
+    if( poPool != NULL && asJobs.size() > 1 )
+    {
+        std::vector<void*> apJobs;
+        for( size_t i = 0; i < asJobs.size(); i++ )
+            apJobs.push_back(&asJobs[i]);
+        poPool->SubmitJobs(GPKGRTreeSortJobFunc, apJobs);
+        poPool->WaitCompletion();
+    }
+    else
+    {
+        for( size_t i = 0; i < asJobs.size(); i++ )
+            GPKGRTreeSortJobFunc(&asJobs[i]);
+    }
+}
+
+/* Orders the cells of a level of the tree with the Sort-Tile-Recursive */
+/* algorithm: they are sorted on the X of their center, cut in about */
+/* sqrt(number of nodes) vertical slices, and each slice is sorted on the Y */
+/* of their center. Each run of nMaxCells cells then makes a node. */
+/* The sorts are split between the worker threads, if any. */
+static void GPKGSTRSortLevel( std::vector<GPKGRTreeEntry>& asCells,
+                              int nMaxCells, CPLWorkerThreadPool* poPool )
+{
+    const size_t nCells = asCells.size();
+    const size_t nNodes = (nCells + nMaxCells - 1) / nMaxCells;
+    if( nNodes <= 1 )
+        return;
+    const size_t nSlices =
+        static_cast<size_t>(ceil(sqrt(static_cast<double>(nNodes))));
+    const size_t nSliceCells = ((nNodes + nSlices - 1) / nSlices) * nMaxCells;
+    GPKGRTreeEntry* pasCells = &asCells[0];
+
+    /* Sort on X by chunks, then merge them by pairs */
+    std::vector<size_t> anBounds;
+    const size_t nChunks = (poPool != NULL && nCells >= 100000) ?
+        static_cast<size_t>(poPool->GetThreadCount()) : 1;
+    for( size_t i = 0; i <= nChunks; i++ )
+        anBounds.push_back(nCells * i / nChunks);
+    std::vector<GPKGRTreeSortJob> asJobs;
+    for( size_t i = 0; i < nChunks; i++ )
+    {
+        GPKGRTreeSortJob sJob;
+        sJob.pasBegin = pasCells + anBounds[i];
+        sJob.pasMiddle = NULL;
+        sJob.pasEnd = pasCells + anBounds[i + 1];
+        sJob.bOnY = false;
+        asJobs.push_back(sJob);
+    }
+    GPKGRunRTreeSortJobs(asJobs, poPool);
+    while( anBounds.size() > 2 )
+    {
+        asJobs.clear();
+        std::vector<size_t> anMergedBounds;
+        for( size_t i = 0; i + 1 < anBounds.size(); i += 2 )
+        {
+            anMergedBounds.push_back(anBounds[i]);
+            if( i + 2 < anBounds.size() )
+            {
+                GPKGRTreeSortJob sJob;
+                sJob.pasBegin = pasCells + anBounds[i];
+                sJob.pasMiddle = pasCells + anBounds[i + 1];
+                sJob.pasEnd = pasCells + anBounds[i + 2];
+                sJob.bOnY = false;
+                asJobs.push_back(sJob);
+            }
+        }
+        anMergedBounds.push_back(nCells);
+        anBounds.swap(anMergedBounds);
+        GPKGRunRTreeSortJobs(asJobs, poPool);
+    }
+
+    /* Sort each slice on Y */
+    asJobs.clear();
+    for( size_t i = 0; i < nCells; i += nSliceCells )
+    {
+        GPKGRTreeSortJob sJob;
+        sJob.pasBegin = pasCells + i;
+        sJob.pasMiddle = NULL;
+        sJob.pasEnd = pasCells + std::min(i + nSliceCells, nCells);
+        sJob.bOnY = true;
+        asJobs.push_back(sJob);
+    }
+    GPKGRunRTreeSortJobs(asJobs, poPool);
+}
+
+/************************************************************************/
+/*                      GPKGRTreeExtractJobFunc()                       */
+/************************************************************************/
+
+typedef struct
+{
+    /* Input: FIDs and geometry blobs, the blob of the i-th feature being */
+    /* at [anOffsets[i], anOffsets[i+1][ in abyBlobs */
+    std::vector<GIntBig>        anFIDs;
+    std::vector<size_t>         anOffsets;
+    std::vector<GByte>          abyBlobs;
+    /* Output */
+    std::vector<GPKGRTreeEntry> asEntries;
+    bool                        bOK;
+} GPKGRTreeExtractJob;
+
+/* Envelope of a point, which is not written in the header by GDAL */
+static bool GPKGGetPointEnvelope( const GByte* pabyWKB, size_t nWKBSize,
+                                  OGREnvelope* psEnvelope )
+{
+    OGRwkbGeometryType eGeomType;
+    if( nWKBSize < 5 + 2 * sizeof(double) ||
+        OGRReadWKBGeometryType(const_cast<GByte*>(pabyWKB), wkbVariantIso, &eGeomType)
+                                                        != OGRERR_NONE ||
+        wkbFlatten(eGeomType) != wkbPoint )
+    {
+        return false;
+    }
+    double dfX, dfY;
+    memcpy(&dfX, pabyWKB + 5, sizeof(double));
+    memcpy(&dfY, pabyWKB + 5 + sizeof(double), sizeof(double));
+    if( OGR_SWAP(static_cast<OGRwkbByteOrder>(pabyWKB[0])) )
+    {
+        CPL_SWAPDOUBLE(&dfX);
+        CPL_SWAPDOUBLE(&dfY);
+    }
+    psEnvelope->MinX = psEnvelope->MaxX = dfX;
+    psEnvelope->MinY = psEnvelope->MaxY = dfY;
+    return true;
+}
+
+static void GPKGRTreeExtractJobFunc( void* pData )
+{
+    GPKGRTreeExtractJob* psJob = static_cast<GPKGRTreeExtractJob*>(pData);
+    psJob->asEntries.clear();
+    psJob->bOK = true;
+    const GByte* pabyBlobs =
+        psJob->abyBlobs.empty() ? NULL : &psJob->abyBlobs[0];
+    for( size_t i = 0; i < psJob->anFIDs.size(); i++ )
+    {
+        const GByte* pabyBlob = pabyBlobs + psJob->anOffsets[i];
+        const size_t nBlobSize = psJob->anOffsets[i + 1] - psJob->anOffsets[i];
+
+        /* Same envelope as ST_MinX() and friends. Empty and invalid */
+        /* geometries are skipped, as they are not indexed by the triggers */
+        GPkgHeader sHeader;
+        if( nBlobSize < 8 ||
+            GPkgHeaderFromWKB(pabyBlob, nBlobSize, &sHeader) != OGRERR_NONE ||
+            sHeader.bEmpty )
+        {
+            continue;
+        }
+        OGREnvelope sEnvelope;
+        if( sHeader.bExtentHasXY )
+        {
+            sEnvelope.MinX = sHeader.MinX;
+            sEnvelope.MaxX = sHeader.MaxX;
+            sEnvelope.MinY = sHeader.MinY;
+            sEnvelope.MaxY = sHeader.MaxY;
+        }
+        else if( GPKGGetPointEnvelope(pabyBlob + sHeader.szHeader,
+                                      nBlobSize - sHeader.szHeader,
+                                      &sEnvelope) )
+        {
+            /* Empty point */
+            if( CPLIsNan(sEnvelope.MinX) || CPLIsNan(sEnvelope.MinY) )
+                continue;
+        }
+        else
+        {
+            OGRGeometry* poGeom = GPkgGeometryToOGR(pabyBlob, nBlobSize, NULL);
+            if( poGeom == NULL || poGeom->IsEmpty() )
+            {
+                delete poGeom;
+                continue;
+            }
+            poGeom->getEnvelope(&sEnvelope);
+            delete poGeom;
+        }
+
+        GPKGRTreeEntry sEntry;
+        if( !GPKGMakeRTreeEntry(psJob->anFIDs[i], sEnvelope, &sEntry) )
+        {
+            psJob->bOK = false;
+            return;
+        }
+        psJob->asEntries.push_back(sEntry);
+    }
+}
+
+/************************************************************************/
+/*                  SetDeferredSpatialIndexCreation()                   */
+/************************************************************************/
+
+void OGRGeoPackageTableLayer::SetDeferredSpatialIndexCreation( bool bFlag )
+{
+    m_bDeferredSpatialIndexCreation = bFlag;
+
+    /* This is called on newly created tables, so until the index is */
+    /* created, the envelopes of the inserted features describe the whole */
+    /* table and can be used to bulk load the RTree */
+    InvalidateRTreeEntries();
+    if( bFlag )
+    {
+        m_nMaxRTreeEntries = GPKGGetMaxRTreeEntries();
+        m_bRTreeEntriesValid = m_nMaxRTreeEntries > 0;
+    }
+}
+
+/************************************************************************/
+/*                           AddRTreeEntry()                            */
+/************************************************************************/
+
+void OGRGeoPackageTableLayer::AddRTreeEntry( GIntBig nFID,
+                                             OGRGeometry* poGeom,
+                                             const OGREnvelope& sEnvelope )
+{
+    /* Empty geometries are not indexed, as in the insert trigger */
+    if( poGeom->IsEmpty() )
+        return;
+
+    GPKGRTreeEntry sEntry;
+    if( m_asRTreeEntries.size() >= m_nMaxRTreeEntries ||
+        !GPKGMakeRTreeEntry(nFID, sEnvelope, &sEntry) )
+    {
+        InvalidateRTreeEntries();
+        return;
+    }
+    try
+    {
+        m_asRTreeEntries.push_back(sEntry);
+    }
+    catch( const std::bad_alloc& )
+    {
+        InvalidateRTreeEntries();
+    }
+}
+
+/************************************************************************/
+/*                       InvalidateRTreeEntries()                       */
+/************************************************************************/
+
+void OGRGeoPackageTableLayer::InvalidateRTreeEntries()
+{
+    m_bRTreeEntriesValid = false;
+    std::vector<GPKGRTreeEntry>().swap(m_asRTreeEntries);
+}
+
+/************************************************************************/
+/*                        CollectRTreeEntries()                         */
+/************************************************************************/
+
+/* Reads the envelopes of all the geometries of the table, when they could */
+/* not be collected at insertion time. The main thread reads the geometry */
+/* blobs by batches, and the envelopes are extracted by the worker threads */
+/* of the dataset, if any. Returns false if the envelopes do not fit in */
+/* the memory allowed, or cannot be stored in the RTree as they are. */
+
+bool OGRGeoPackageTableLayer::CollectRTreeEntries()
+{
+    InvalidateRTreeEntries();
+
+    const size_t nMaxEntries = GPKGGetMaxRTreeEntries();
+    if( nMaxEntries == 0 )
+        return false;
+
+    const char* pszT = m_pszTableName;
+    const char* pszC = m_poFeatureDefn->GetGeomFieldDefn(0)->GetNameRef();
+    const char* pszI = GetFIDColumn();
+
+    char* pszSQL = sqlite3_mprintf(
+                 "SELECT \"%s\", \"%s\" FROM \"%s\" WHERE \"%s\" IS NOT NULL",
+                 pszI, pszC, pszT, pszC );
+    sqlite3_stmt* hStmt = NULL;
+    int rc = sqlite3_prepare_v2(m_poDS->GetDB(), pszSQL, -1, &hStmt, NULL);
+    sqlite3_free(pszSQL);
+    if( rc != SQLITE_OK )
+        return false;
+
+    CPLWorkerThreadPool* poPool = m_poDS->GetThreadPool();
+    const int nJobs = poPool ? 2 * poPool->GetThreadCount() : 1;
+    std::vector<GPKGRTreeExtractJob> asJobs(nJobs);
+    bool bOK = true;
+    bool bEOF = false;
+    try
+    {
+        while( bOK && !bEOF )
+        {
+            int nSubmitted = 0;
+            for( ; nSubmitted < nJobs && !bEOF; nSubmitted++ )
+            {
+                GPKGRTreeExtractJob& sJob = asJobs[nSubmitted];
+                sJob.anFIDs.clear();
+                sJob.anOffsets.clear();
+                sJob.anOffsets.push_back(0);
+                sJob.abyBlobs.clear();
+                while( sJob.anFIDs.size() < GPKG_RTREE_EXTRACT_BATCH_COUNT &&
+                       sJob.abyBlobs.size() < GPKG_RTREE_EXTRACT_BATCH_SIZE )
+                {
+                    rc = sqlite3_step(hStmt);
+                    if( rc != SQLITE_ROW )
+                    {
+                        if( rc != SQLITE_DONE )
+                            bOK = false;
+                        bEOF = true;
+                        break;
+                    }
+                    if( sqlite3_column_type(hStmt, 1) != SQLITE_BLOB )
+                        continue;
+                    const GByte* pabyBlob = static_cast<const GByte*>(
+                                            sqlite3_column_blob(hStmt, 1));
+                    const int nBlobSize = sqlite3_column_bytes(hStmt, 1);
+                    sJob.anFIDs.push_back(sqlite3_column_int64(hStmt, 0));
+                    sJob.abyBlobs.insert(sJob.abyBlobs.end(),
+                                         pabyBlob, pabyBlob + nBlobSize);
+                    sJob.anOffsets.push_back(sJob.abyBlobs.size());
+                }
+                if( sJob.anFIDs.empty() )
+                    break;
+                if( poPool != NULL )
+                    poPool->SubmitJob(GPKGRTreeExtractJobFunc, &sJob);
+                else
+                    GPKGRTreeExtractJobFunc(&sJob);
+            }
+            if( poPool != NULL )
+                poPool->WaitCompletion();
+
+            for( int i = 0; i < nSubmitted; i++ )
+            {
+                const GPKGRTreeExtractJob& sJob = asJobs[i];
+                if( !sJob.bOK )
+                    bOK = false;
+                m_asRTreeEntries.insert(m_asRTreeEntries.end(),
+                                        sJob.asEntries.begin(),
+                                        sJob.asEntries.end());
+            }
+            if( m_asRTreeEntries.size() > nMaxEntries )
+                bOK = false;
+        }
+    }
+    catch( const std::bad_alloc& )
+    {
+        if( poPool != NULL )
+            poPool->WaitCompletion();
+        bOK = false;
+    }
+    sqlite3_finalize(hStmt);
+
+    if( !bOK )
+    {
+        CPLDebug("GPKG", "Cannot bulk load the RTree of %s", pszT);
+        InvalidateRTreeEntries();
+        return false;
+    }
+    m_bRTreeEntriesValid = true;
+    return true;
+}
+
+/************************************************************************/
+/*                           BulkLoadRTree()                            */
+/************************************************************************/
+
+/* Builds the RTree from m_asRTreeEntries by writing directly the node, */
+/* rowid and parent tables behind the rtree virtual table, as SQLite */
+/* would have written them. The tree is packed with the Sort-Tile-Recursive */
+/* algorithm, which is both much faster than the insertion of the entries */
+/* one at a time and results in fuller nodes with less overlap. */
+/* Returns OGRERR_UNSUPPORTED_OPERATION if the tables could not be */
+/* modified, so that the RTree can still be filled with SQL statements. */
+
+OGRErr OGRGeoPackageTableLayer::BulkLoadRTree()
+{
+    const char* pszT = m_pszTableName;
+    const char* pszC = m_poFeatureDefn->GetGeomFieldDefn(0)->GetNameRef();
+    sqlite3* hDB = m_poDS->GetDB();
+
+    /* SQLite derives the size of the nodes from the page size when */
+    /* creating the table, and writes an empty root node of that size */
+    char* pszSQL = sqlite3_mprintf(
+        "SELECT length(data) FROM \"rtree_%s_%s_node\" WHERE nodeno = 1",
+        pszT, pszC );
+    OGRErr err = OGRERR_NONE;
+    const int nNodeSize = SQLGetInteger(hDB, pszSQL, &err);
+    sqlite3_free(pszSQL);
+    const int nMaxCells = (nNodeSize - 4) / GPKG_RTREE_CELL_SIZE;
+    if( err != OGRERR_NONE || nMaxCells < 2 )
+        return OGRERR_UNSUPPORTED_OPERATION;
+
+    pszSQL = sqlite3_mprintf(
+        "DELETE FROM \"rtree_%s_%s_node\"; "
+        "DELETE FROM \"rtree_%s_%s_rowid\"; "
+        "DELETE FROM \"rtree_%s_%s_parent\"",
+        pszT, pszC, pszT, pszC, pszT, pszC );
+    err = SQLCommand(hDB, pszSQL);
+    sqlite3_free(pszSQL);
+    if( err != OGRERR_NONE )
+        return OGRERR_UNSUPPORTED_OPERATION;
+
+    sqlite3_stmt* hInsertNode = NULL;
+    sqlite3_stmt* hInsertRowid = NULL;
+    sqlite3_stmt* hInsertParent = NULL;
+    pszSQL = sqlite3_mprintf(
+        "INSERT INTO \"rtree_%s_%s_node\" (nodeno, data) VALUES (?, ?)",
+        pszT, pszC );
+    int rc = sqlite3_prepare_v2(hDB, pszSQL, -1, &hInsertNode, NULL);
+    sqlite3_free(pszSQL);
+    if( rc == SQLITE_OK )
+    {
+        pszSQL = sqlite3_mprintf(
+            "INSERT INTO \"rtree_%s_%s_rowid\" (rowid, nodeno) VALUES (?, ?)",
+            pszT, pszC );
+        rc = sqlite3_prepare_v2(hDB, pszSQL, -1, &hInsertRowid, NULL);
+        sqlite3_free(pszSQL);
+    }
+    if( rc == SQLITE_OK )
+    {
+        pszSQL = sqlite3_mprintf(
+            "INSERT INTO \"rtree_%s_%s_parent\" (nodeno, parentnode) "
+            "VALUES (?, ?)",
+            pszT, pszC );
+        rc = sqlite3_prepare_v2(hDB, pszSQL, -1, &hInsertParent, NULL);
+        sqlite3_free(pszSQL);
+    }
+
+/* -------------------------------------------------------------------- */
+/*      Write the tree level by level, from the leaves to the root.     */
+/*      The cells of a level are the entries of its nodes, ordered      */
+/*      so that each run of nMaxCells cells makes a node. The nodes     */
+/*      of a level then make the cells of the level above.              */
+/* -------------------------------------------------------------------- */
+    CPLWorkerThreadPool* poPool = m_poDS->GetThreadPool();
+    std::vector<GPKGRTreeEntry> asCells;
+    asCells.swap(m_asRTreeEntries);
+    std::vector<GByte> abyNode(nNodeSize);
+    GIntBig nNextNodeNo = 2;
+    int nDepth = 0;
+    while( rc == SQLITE_OK )
+    {
+        GPKGSTRSortLevel(asCells, nMaxCells, poPool);
+
+        const size_t nCells = asCells.size();
+        const size_t nNodes =
+            std::max(static_cast<size_t>(1), (nCells + nMaxCells - 1) / nMaxCells);
+        std::vector<GPKGRTreeEntry> asNodes;
+        /* (cell id, node number), for the rowid or parent table */
+        std::vector< std::pair<GIntBig, GIntBig> > anCellToNode;
+        anCellToNode.reserve(nCells);
+        for( size_t iNode = 0; rc == SQLITE_OK && iNode < nNodes; iNode++ )
+        {
+            const size_t iFirst = iNode * nMaxCells;
+            const size_t iLast = std::min(iFirst + nMaxCells, nCells);
+
+            GPKGRTreeEntry sNode;
+            sNode.nId = (nNodes == 1) ? 1 : nNextNodeNo++;
+            sNode.fMinX = sNode.fMaxX = sNode.fMinY = sNode.fMaxY = 0.0f;
+
+            std::fill(abyNode.begin(), abyNode.end(), 0);
+            /* The depth of the tree is stored in the root node */
+            if( nNodes == 1 )
+                GPKGRTreeWriteInt(&abyNode[0], 2, nDepth);
+            GPKGRTreeWriteInt(&abyNode[2], 2, static_cast<GIntBig>(iLast - iFirst));
+            for( size_t i = iFirst; i < iLast; i++ )
+            {
+                const GPKGRTreeEntry& sCell = asCells[i];
+                GPKGRTreeWriteCell(&abyNode[4 + (i - iFirst) * GPKG_RTREE_CELL_SIZE],
+                                   sCell);
+                if( i == iFirst )
+                {
+                    sNode.fMinX = sCell.fMinX;
+                    sNode.fMaxX = sCell.fMaxX;
+                    sNode.fMinY = sCell.fMinY;
+                    sNode.fMaxY = sCell.fMaxY;
+                }
+                else
+                {
+                    sNode.fMinX = std::min(sNode.fMinX, sCell.fMinX);
+                    sNode.fMaxX = std::max(sNode.fMaxX, sCell.fMaxX);
+                    sNode.fMinY = std::min(sNode.fMinY, sCell.fMinY);
+                    sNode.fMaxY = std::max(sNode.fMaxY, sCell.fMaxY);
+                }
+                anCellToNode.push_back(std::make_pair(sCell.nId, sNode.nId));
+            }
+
+            sqlite3_bind_int64(hInsertNode, 1, sNode.nId);
+            sqlite3_bind_blob(hInsertNode, 2, &abyNode[0], nNodeSize,
+                              SQLITE_STATIC);
+            rc = sqlite3_step(hInsertNode);
+            sqlite3_reset(hInsertNode);
+            if( rc == SQLITE_DONE )
+                rc = SQLITE_OK;
+            asNodes.push_back(sNode);
+        }
+        std::vector<GPKGRTreeEntry>().swap(asCells);
+
+        /* The leaf cells are registered in the rowid table, and the other */
+        /* nodes in the parent table. Insert them by increasing key. */
+        std::sort(anCellToNode.begin(), anCellToNode.end());
+        sqlite3_stmt* hInsert = (nDepth == 0) ? hInsertRowid : hInsertParent;
+        for( size_t i = 0; rc == SQLITE_OK && i < anCellToNode.size(); i++ )
+        {
+            sqlite3_bind_int64(hInsert, 1, anCellToNode[i].first);
+            sqlite3_bind_int64(hInsert, 2, anCellToNode[i].second);
+            rc = sqlite3_step(hInsert);
+            sqlite3_reset(hInsert);
+            if( rc == SQLITE_DONE )
+                rc = SQLITE_OK;
+        }
+
+        if( nNodes == 1 )
+            break;
+        asCells.swap(asNodes);
+        nDepth++;
+    }
+
+    if( rc != SQLITE_OK )
+    {
+        CPLError( CE_Failure, CPLE_AppDefined,
+                  "failed to write the RTree of %s: %s",
+                  pszT, sqlite3_errmsg(hDB) );
+    }
+    else
+    {
+        CPLDebug("GPKG", "RTree of %s bulk loaded, depth %d", pszT, nDepth);
+    }
+    sqlite3_finalize(hInsertNode);
+    sqlite3_finalize(hInsertRowid);
+    sqlite3_finalize(hInsertParent);
+
+    return rc == SQLITE_OK ? OGRERR_NONE : OGRERR_FAILURE;
+}
+
 /************************************************************************/
 /*                     CreateSpatialIndexIfNecessary()                  */
 /************************************************************************/
@@ -1791,13 +2475,23 @@ bool OGRGeoPackageTableLayer::CreateSpatialIndex()
     }
     m_bDropRTreeTable = false;
 
-    /* Populate the RTree */
-    pszSQL = sqlite3_mprintf(
+    /* Populate the RTree, preferably by bulk loading it from the envelopes */
+    /* collected at insertion time, or read from the table */
+    err = OGRERR_UNSUPPORTED_OPERATION;
+    if( m_bRTreeEntriesValid || CollectRTreeEntries() )
+        err = BulkLoadRTree();
+    InvalidateRTreeEntries();
+    if( err == OGRERR_UNSUPPORTED_OPERATION )
+    {
+        /* Same condition as in the insert trigger */
+        pszSQL = sqlite3_mprintf(
                  "INSERT OR REPLACE INTO \"rtree_%s_%s\" "
-                 "SELECT \"%s\", st_minx(\"%s\"), st_maxx(\"%s\"), st_miny(\"%s\"), st_maxy(\"%s\") FROM \"%s\"",
-                 pszT, pszC, pszI, pszC, pszC, pszC, pszC, pszT );
-    err = SQLCommand(m_poDS->GetDB(), pszSQL);
-    sqlite3_free(pszSQL);
+                 "SELECT \"%s\", st_minx(\"%s\"), st_maxx(\"%s\"), st_miny(\"%s\"), st_maxy(\"%s\") FROM \"%s\" "
+                 "WHERE \"%s\" NOT NULL AND NOT ST_IsEmpty(\"%s\")",
+                 pszT, pszC, pszI, pszC, pszC, pszC, pszC, pszT, pszC, pszC );
+        err = SQLCommand(m_poDS->GetDB(), pszSQL);
+        sqlite3_free(pszSQL);
+    }
     if( err != OGRERR_NONE )
     {
         m_poDS->SoftRollbackTransaction();
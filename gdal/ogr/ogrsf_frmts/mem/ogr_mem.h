@@ -81,6 +81,7 @@ class OGRMemLayer : public OGRLayer
     virtual OGRErr      SetNextByIndex( GIntBig nIndex );
 
     OGRFeature         *GetFeature( GIntBig nFeatureId );
+    OGRFeature         *GetFeatureRef( GIntBig nFeatureId );
     OGRErr              ISetFeature( OGRFeature *poFeature );
     OGRErr              ICreateFeature( OGRFeature *poFeature );
     virtual OGRErr      DeleteFeature( GIntBig nFID );
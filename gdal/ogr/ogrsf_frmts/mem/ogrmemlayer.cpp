@@ -190,6 +190,22 @@ OGRErr OGRMemLayer::SetNextByIndex( GIntBig nIndex )
 
 OGRFeature *OGRMemLayer::GetFeature( GIntBig nFeatureId )
 
+{
+    OGRFeature* poFeature = GetFeatureRef( nFeatureId );
+    if( poFeature == NULL )
+        return NULL;
+
+    return poFeature->Clone();
+}
+
+/************************************************************************/
+/*                           GetFeatureRef()                            */
+/*                                                                      */
+/*      Returns the feature stored in the layer, without cloning it.    */
+/************************************************************************/
+
+OGRFeature *OGRMemLayer::GetFeatureRef( GIntBig nFeatureId )
+
 {
     if( nFeatureId < 0 )
         return NULL;
@@ -207,10 +223,7 @@ OGRFeature *OGRMemLayer::GetFeature( GIntBig nFeatureId )
         if( oIter != m_oMapFeatures.end() )
             poFeature = oIter->second;
     }
-    if( poFeature == NULL )
-        return NULL;
-
-    return poFeature->Clone();
+    return poFeature;
 }
 
 /************************************************************************/
@@ -943,6 +943,7 @@ OGRLayer* OGROpenFileGDBDataSource::ExecuteSQL( const char *pszSQLCommand,
 /* -------------------------------------------------------------------- */
         if( oSelect.join_count == 0 && oSelect.poOtherSelect == NULL &&
             oSelect.table_count == 1 && oSelect.order_specs == 0 &&
+            oSelect.group_specs == 0 &&
             oSelect.query_mode != SWQM_DISTINCT_LIST )
         {
             OGROpenFileGDBLayer* poLayer =
@@ -1078,7 +1079,9 @@ OGRLayer* OGROpenFileGDBDataSource::ExecuteSQL( const char *pszSQLCommand,
 /* -------------------------------------------------------------------- */
         if( oSelect.join_count == 0 && oSelect.poOtherSelect == NULL &&
             oSelect.table_count == 1 && oSelect.order_specs == 1 &&
-            oSelect.query_mode != SWQM_DISTINCT_LIST )
+            oSelect.query_mode != SWQM_DISTINCT_LIST &&
+            oSelect.group_specs == 0 &&
+            oSelect.limit < 0 && oSelect.offset == 0 )
         {
             OGROpenFileGDBLayer* poLayer =
                 reinterpret_cast<OGROpenFileGDBLayer *>(
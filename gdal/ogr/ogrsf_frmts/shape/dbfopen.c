@@ -213,6 +213,8 @@ static void DBFWriteHeader(DBFHandle psDBF)
     if( !psDBF->bNoHeader )
         return;
 
+    SAReadAheadInvalidate( &psDBF->sReadAhead );
+
     psDBF->bNoHeader = FALSE;
 
 /* -------------------------------------------------------------------- */
@@ -273,6 +275,7 @@ static int DBFFlushRecord( DBFHandle psDBF )
     if( psDBF->bCurrentRecordModified && psDBF->nCurrentRecord > -1 )
     {
 	psDBF->bCurrentRecordModified = FALSE;
+	SAReadAheadInvalidate( &psDBF->sReadAhead );
 
 	nRecordOffset =
             psDBF->nRecordLength * (SAOffset) psDBF->nCurrentRecord
@@ -304,6 +307,7 @@ static int DBFLoadRecord( DBFHandle psDBF, int iRecord )
     if( psDBF->nCurrentRecord != iRecord )
     {
         SAOffset nRecordOffset;
+        int      nRead;
 
 	if( !DBFFlushRecord( psDBF ) )
             return FALSE;
@@ -311,7 +315,13 @@ static int DBFLoadRecord( DBFHandle psDBF, int iRecord )
 	nRecordOffset =
             psDBF->nRecordLength * (SAOffset) iRecord + psDBF->nHeaderLength;
 
-	if( psDBF->sHooks.FSeek( psDBF->fp, nRecordOffset, SEEK_SET ) != 0 )
+        nRead = SAReadAheadRead( &psDBF->sHooks, psDBF->fp,
+                                 &psDBF->sReadAhead,
+                                 nRecordOffset, psDBF->pszCurrentRecord,
+                                 psDBF->nRecordLength,
+                                 psDBF->nRecordLength * (SAOffset) psDBF->nRecords
+                                 + psDBF->nHeaderLength );
+	if( nRead < 0 )
         {
             char szMessage[128];
             snprintf( szMessage, sizeof(szMessage), "fseek(%ld) failed on DBF file.\n",
@@ -320,8 +330,7 @@ static int DBFLoadRecord( DBFHandle psDBF, int iRecord )
             return FALSE;
         }
 
-	if( psDBF->sHooks.FRead( psDBF->pszCurrentRecord,
-                                 psDBF->nRecordLength, 1, psDBF->fp ) != 1 )
+	if( nRead != psDBF->nRecordLength )
         {
             char szMessage[128];
             snprintf( szMessage, sizeof(szMessage), "fread(%d) failed on DBF file.\n",
@@ -352,6 +361,8 @@ DBFUpdateHeader( DBFHandle psDBF )
     if( !DBFFlushRecord( psDBF ) )
         return;
 
+    SAReadAheadInvalidate( &psDBF->sReadAhead );
+
     psDBF->sHooks.FSeek( psDBF->fp, 0, 0 );
     psDBF->sHooks.FRead( abyFileHeader, 32, 1, psDBF->fp );
 
@@ -381,6 +392,16 @@ DBFSetLastModifiedDate( DBFHandle psDBF, int nYYSince1900, int nMM, int nDD )
     psDBF->nUpdateDay = nDD;
 }
 
+/************************************************************************/
+/*                         DBFSetReadAheadSize()                        */
+/************************************************************************/
+
+void SHPAPI_CALL
+DBFSetReadAheadSize( DBFHandle psDBF, int nBufSize )
+{
+    SAReadAheadSetSize( &psDBF->sReadAhead, nBufSize );
+}
+
 /************************************************************************/
 /*                              DBFOpen()                               */
 /*                                                                      */
@@ -644,6 +665,7 @@ DBFClose(DBFHandle psDBF)
     free( psDBF->pszHeader );
     free( psDBF->pszCurrentRecord );
     free( psDBF->pszCodePage );
+    free( psDBF->sReadAhead.pabyData );
 
     free( psDBF );
 }
@@ -861,6 +883,7 @@ DBFAddNativeFieldType(DBFHandle psDBF, const char * pszFieldName,
     /* make sure that everything is written in .dbf */
     if( !DBFFlushRecord( psDBF ) )
         return -1;
+    SAReadAheadInvalidate( &psDBF->sReadAhead );
 
 /* -------------------------------------------------------------------- */
 /*      Do some checking to ensure we can add records to this file.     */
@@ -1828,6 +1851,7 @@ DBFDeleteField(DBFHandle psDBF, int iField)
     /* make sure that everything is written in .dbf */
     if( !DBFFlushRecord( psDBF ) )
         return FALSE;
+    SAReadAheadInvalidate( &psDBF->sReadAhead );
 
     /* get information about field to be deleted */
     nOldRecordLength = psDBF->nRecordLength;
@@ -1948,6 +1972,7 @@ DBFReorderFields( DBFHandle psDBF, int* panMap )
     /* make sure that everything is written in .dbf */
     if( !DBFFlushRecord( psDBF ) )
         return FALSE;
+    SAReadAheadInvalidate( &psDBF->sReadAhead );
 
     /* a simple malloc() would be enough, but calloc() helps clang static analyzer */
     panFieldOffsetNew = (int *) calloc(sizeof(int), psDBF->nFields);
@@ -2059,6 +2084,7 @@ DBFAlterFieldDefn( DBFHandle psDBF, int iField, const char * pszFieldName,
     /* make sure that everything is written in .dbf */
     if( !DBFFlushRecord( psDBF ) )
         return FALSE;
+    SAReadAheadInvalidate( &psDBF->sReadAhead );
 
     chFieldFill = DBFGetNullCharacter(chType);
 
@@ -49,8 +49,10 @@
 /* ==================================================================== */
 OGRFeature *SHPReadOGRFeature( SHPHandle hSHP, DBFHandle hDBF,
                                OGRFeatureDefn * poDefn, int iShape,
-                               SHPObject *psShape, const char *pszSHPEncoding );
-OGRGeometry *SHPReadOGRObject( SHPHandle hSHP, int iShape, SHPObject *psShape );
+                               SHPObject *psShape, const char *pszSHPEncoding,
+                               OGRGeometry *poRecycledGeom = NULL );
+OGRGeometry *SHPReadOGRObject( SHPHandle hSHP, int iShape, SHPObject *psShape,
+                               OGRGeometry *poRecycled = NULL );
 OGRFeatureDefn *SHPReadOGRFeatureDefn( const char * pszName,
                                        SHPHandle hSHP, DBFHandle hDBF,
                                        const char *pszSHPEncoding,
@@ -118,6 +120,10 @@ class OGRShapeLayer CPL_FINAL: public OGRAbstractProxiedLayer
     int                 iMatchingFID;
     void                ClearMatchingFIDs();
 
+    /* Geometry of the last feature rejected by the filters, whose storage */
+    /* is reused for the next feature read */
+    OGRGeometry        *poRecycledGeom;
+
     OGRGeometry        *m_poFilterGeomLastValid;
     int                 nSpatialFIDCount;
     int                *panSpatialFIDs;
@@ -31,12 +31,30 @@
 #include "ogrshape.h"
 #include "cpl_conv.h"
 #include "cpl_string.h"
+#include <algorithm>
 #include <set>
 
 //#define IMMEDIATE_OPENING 1
 
 CPL_CVSID("$Id$");
 
+/************************************************************************/
+/*                        GetReadAheadSize()                            */
+/*                                                                      */
+/*      Size of the windows fetched ahead of the current position of    */
+/*      the .shp, .shx and .dbf files opened in read-only mode, when    */
+/*      records are read in increasing order.                           */
+/************************************************************************/
+
+static int GetReadAheadSize( const char * pszAccess )
+{
+    if( strchr(pszAccess, '+') != NULL )
+        return 0;
+    const int nSize =
+        atoi(CPLGetConfigOption("SHAPE_READ_AHEAD_SIZE", "262144"));
+    return std::max(0, std::min(nSize, 64 * 1024 * 1024));
+}
+
 /************************************************************************/
 /*                          DS_SHPOpen()                                */
 /************************************************************************/
@@ -53,7 +71,10 @@ SHPHandle OGRShapeDataSource::DS_SHPOpen( const char * pszShapeFile, const char
                                   bRestoreSHX );
     
     if( hSHP != NULL )
+    {
         SHPSetFastModeReadObject( hSHP, TRUE );
+        SHPSetReadAheadSize( hSHP, GetReadAheadSize(pszAccess) );
+    }
     return hSHP;
 }
 
@@ -64,6 +85,8 @@ SHPHandle OGRShapeDataSource::DS_SHPOpen( const char * pszShapeFile, const char
 DBFHandle OGRShapeDataSource::DS_DBFOpen( const char * pszDBFFile, const char * pszAccess )
 {
     DBFHandle hDBF = DBFOpenLL( pszDBFFile, pszAccess, (SAHooks*) VSI_SHP_GetHook(b2GBLimit) );
+    if( hDBF != NULL )
+        DBFSetReadAheadSize( hDBF, GetReadAheadSize(pszAccess) );
     return hDBF;
 }
 
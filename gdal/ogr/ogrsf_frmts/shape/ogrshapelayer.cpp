@@ -62,6 +62,7 @@ OGRShapeLayer::OGRShapeLayer( OGRShapeDataSource* poDSIn,
     eRequestedGeomType(eReqType),
     panMatchingFIDs(NULL),
     iMatchingFID(0),
+    poRecycledGeom(NULL),
     m_poFilterGeomLastValid(NULL),
     nSpatialFIDCount(0),
     panSpatialFIDs(NULL),
@@ -237,6 +238,8 @@ OGRShapeLayer::~OGRShapeLayer()
     ClearMatchingFIDs();
     ClearSpatialFIDs();
 
+    delete poRecycledGeom;
+
     CPLFree( pszFullName );
 
     if( poFeatureDefn != NULL )
@@ -715,45 +718,79 @@ OGRFeature *OGRShapeLayer::FetchShape(int iShapeId /*, OGREnvelope* psShapeExten
 
     if (m_poFilterGeom != NULL && hSHP != NULL )
     {
-        SHPObject   *psShape;
+/* -------------------------------------------------------------------- */
+/*      Check the bounding box of the shape from its raw record         */
+/*      before translating it.  The record stays in the buffer of the   */
+/*      handle for SHPReadOGRFeature().                                 */
+/* -------------------------------------------------------------------- */
+        int nEntitySize = 0;
+        const GByte *pabyRec = SHPReadObjectRecord( hSHP, iShapeId,
+                                                    &nEntitySize );
+        int nSHPType = SHPT_NULL;
+        OGREnvelope sShapeEnv;
+        bool bHasEnv = false;
 
-        psShape = SHPReadObject( hSHP, iShapeId );
+        if( pabyRec != NULL )
+        {
+            memcpy( &nSHPType, pabyRec + 8, 4 );
+            CPL_LSBPTR32( &nSHPType );
+        }
 
-        // do not trust degenerate bounds on non-point geometries
-        // or bounds on null shapes.
-        if( psShape == NULL
-            || (psShape->nSHPType != SHPT_POINT
-                && psShape->nSHPType != SHPT_POINTZ
-                && psShape->nSHPType != SHPT_POINTM
-                && (psShape->dfXMin == psShape->dfXMax
-                 || psShape->dfYMin == psShape->dfYMax))
-            || psShape->nSHPType == SHPT_NULL )
+        if( (nSHPType == SHPT_POINT || nSHPType == SHPT_POINTZ ||
+             nSHPType == SHPT_POINTM) && nEntitySize >= 8 + 20 )
         {
-            poFeature = SHPReadOGRFeature( hSHP, hDBF, poFeatureDefn,
-                                           iShapeId, psShape, osEncoding );
+            memcpy( &(sShapeEnv.MinX), pabyRec + 12, 8 );
+            memcpy( &(sShapeEnv.MinY), pabyRec + 20, 8 );
+            CPL_LSBPTR64( &(sShapeEnv.MinX) );
+            CPL_LSBPTR64( &(sShapeEnv.MinY) );
+            sShapeEnv.MaxX = sShapeEnv.MinX;
+            sShapeEnv.MaxY = sShapeEnv.MinY;
+            bHasEnv = true;
         }
-        else if( m_sFilterEnvelope.MaxX < psShape->dfXMin
-                 || m_sFilterEnvelope.MaxY < psShape->dfYMin
-                 || psShape->dfXMax  < m_sFilterEnvelope.MinX
-                 || psShape->dfYMax < m_sFilterEnvelope.MinY )
+        else if( (nSHPType == SHPT_ARC || nSHPType == SHPT_ARCZ ||
+                  nSHPType == SHPT_ARCM || nSHPType == SHPT_POLYGON ||
+                  nSHPType == SHPT_POLYGONZ || nSHPType == SHPT_POLYGONM ||
+                  nSHPType == SHPT_MULTIPOINT ||
+                  nSHPType == SHPT_MULTIPOINTZ ||
+                  nSHPType == SHPT_MULTIPOINTM ||
+                  nSHPType == SHPT_MULTIPATCH) && nEntitySize >= 8 + 36 )
+        {
+            memcpy( &(sShapeEnv.MinX), pabyRec + 12, 8 );
+            memcpy( &(sShapeEnv.MinY), pabyRec + 20, 8 );
+            memcpy( &(sShapeEnv.MaxX), pabyRec + 28, 8 );
+            memcpy( &(sShapeEnv.MaxY), pabyRec + 36, 8 );
+            CPL_LSBPTR64( &(sShapeEnv.MinX) );
+            CPL_LSBPTR64( &(sShapeEnv.MinY) );
+            CPL_LSBPTR64( &(sShapeEnv.MaxX) );
+            CPL_LSBPTR64( &(sShapeEnv.MaxY) );
+
+            // do not trust degenerate bounds on non-point geometries.
+            bHasEnv = sShapeEnv.MinX != sShapeEnv.MaxX &&
+                      sShapeEnv.MinY != sShapeEnv.MaxY;
+        }
+
+        if( bHasEnv &&
+            (m_sFilterEnvelope.MaxX < sShapeEnv.MinX
+             || m_sFilterEnvelope.MaxY < sShapeEnv.MinY
+             || sShapeEnv.MaxX < m_sFilterEnvelope.MinX
+             || sShapeEnv.MaxY < m_sFilterEnvelope.MinY) )
         {
-            SHPDestroyObject(psShape);
             poFeature = NULL;
         }
         else
         {
-            /*psShapeExtent->MinX = psShape->dfXMin;
-            psShapeExtent->MinY = psShape->dfYMin;
-            psShapeExtent->MaxX = psShape->dfXMax;
-            psShapeExtent->MaxY = psShape->dfYMax;*/
             poFeature = SHPReadOGRFeature( hSHP, hDBF, poFeatureDefn,
-                                           iShapeId, psShape, osEncoding );
+                                           iShapeId, NULL, osEncoding,
+                                           poRecycledGeom );
+            poRecycledGeom = NULL;
         }
     }
     else
     {
         poFeature = SHPReadOGRFeature( hSHP, hDBF, poFeatureDefn,
-                                       iShapeId, NULL, osEncoding );
+                                       iShapeId, NULL, osEncoding,
+                                       poRecycledGeom );
+        poRecycledGeom = NULL;
     }
 
     return poFeature;
@@ -841,6 +878,9 @@ OGRFeature *OGRShapeLayer::GetNextFeature()
                 return poFeature;
             }
 
+            // Keep the geometry of the rejected feature for the next one.
+            delete poRecycledGeom;
+            poRecycledGeom = poFeature->StealGeometry();
             delete poFeature;
         }
     }
@@ -1252,13 +1292,13 @@ int OGRShapeLayer::GetFeatureCountWithSpatialFilterOnly()
                 /* We need to read the full geometry */
                 /* to compute the envelope */
                 if (psShape == &sShape)
-                    psShape = SHPReadObject( hSHP, iShape);
-                if (psShape)
-                {
-                    poGeometry = SHPReadOGRObject( hSHP, iShape, psShape );
-                    poGeometry->getEnvelope( &sGeomEnv );
                     psShape = NULL;
-                }
+                poGeometry = SHPReadOGRObject( hSHP, iShape, psShape,
+                                               poRecycledGeom );
+                poRecycledGeom = NULL;
+                psShape = NULL;
+                if( poGeometry != NULL )
+                    poGeometry->getEnvelope( &sGeomEnv );
             }
             else
             {
@@ -1305,13 +1345,11 @@ int OGRShapeLayer::GetFeatureCountWithSpatialFilterOnly()
                     if (poGeometry == NULL)
                     {
                         if (psShape == &sShape)
-                            psShape = SHPReadObject( hSHP, iShape);
-                        if (psShape)
-                        {
-                            poGeometry =
-                                SHPReadOGRObject( hSHP, iShape, psShape );
                             psShape = NULL;
-                        }
+                        poGeometry = SHPReadOGRObject( hSHP, iShape, psShape,
+                                                       poRecycledGeom );
+                        poRecycledGeom = NULL;
+                        psShape = NULL;
                     }
                     if( poGeometry == NULL )
                         nFeatureCount ++;
@@ -1330,7 +1368,8 @@ int OGRShapeLayer::GetFeatureCountWithSpatialFilterOnly()
                     nFeatureCount ++;
             }
 
-            delete poGeometry;
+            delete poRecycledGeom;
+            poRecycledGeom = poGeometry;
         }
         else
             nFeatureCount ++;
@@ -91,21 +91,334 @@ static OGRLinearRing * CreateLinearRing ( SHPObject *psShape, int ring, int bHas
 }
 
 
+#ifdef CPL_LSB
+
+/************************************************************************/
+/*                        SetCurveFromRecord()                          */
+/*                                                                      */
+/*      Assign nPoints vertices of a shape record to a curve. The XY    */
+/*      pairs of the record have the layout of OGRRawPoint, so they     */
+/*      are copied in one go. pabyZ and pabyM may be NULL.              */
+/************************************************************************/
+
+static void SetCurveFromRecord( OGRSimpleCurve *poCurve, int nPoints,
+                                const GByte *pabyXY, const GByte *pabyZ,
+                                const GByte *pabyM )
+{
+    poCurve->setPoints( nPoints, (OGRRawPoint *) pabyXY,
+                        (double *) pabyZ, (double *) pabyM );
+}
+
+/************************************************************************/
+/*                       SHPReadOGRObjectDirect()                       */
+/*                                                                      */
+/*      Translate the raw record of a point, arc or polygon shape to    */
+/*      an OGR geometry, without going through a SHPObject, so the      */
+/*      vertices are only copied once. poRecycled, which may be NULL,   */
+/*      is reused for the result if it is of the same type, or          */
+/*      destroyed. *pbHandled is set to false for the other shape       */
+/*      types and for corrupted records, which are left to              */
+/*      SHPReadObject().                                                */
+/************************************************************************/
+
+static OGRGeometry *SHPReadOGRObjectDirect( int iShape, const GByte *pabyRec,
+                                            int nEntitySize,
+                                            OGRGeometry *poRecycled,
+                                            bool *pbHandled )
+{
+    int nSHPType = 0;
+    memcpy( &nSHPType, pabyRec + 8, 4 );
+
+    *pbHandled = true;
+    if( poRecycled != NULL )
+        poRecycled->assignSpatialReference( NULL );
+
+/* -------------------------------------------------------------------- */
+/*      Point.                                                          */
+/* -------------------------------------------------------------------- */
+    if( nSHPType == SHPT_POINT || nSHPType == SHPT_POINTZ ||
+        nSHPType == SHPT_POINTM )
+    {
+        const int nZSize = (nSHPType == SHPT_POINTZ) ? 8 : 0;
+        if( 20 + 8 + nZSize > nEntitySize )
+        {
+            *pbHandled = false;
+            delete poRecycled;
+            return NULL;
+        }
+
+        double dfX = 0.0;
+        double dfY = 0.0;
+        double dfZ = 0.0;
+        double dfM = 0.0;
+        memcpy( &dfX, pabyRec + 12, 8 );
+        memcpy( &dfY, pabyRec + 20, 8 );
+        if( nZSize )
+            memcpy( &dfZ, pabyRec + 28, 8 );
+        const bool bHasM = nEntitySize >= 28 + nZSize + 8;
+        if( bHasM )
+            memcpy( &dfM, pabyRec + 28 + nZSize, 8 );
+
+        OGRPoint oPoint;
+        if( nSHPType == SHPT_POINT )
+            oPoint = OGRPoint( dfX, dfY );
+        else if( nSHPType == SHPT_POINTZ && bHasM )
+            oPoint = OGRPoint( dfX, dfY, dfZ, dfM );
+        else if( nSHPType == SHPT_POINTZ )
+            oPoint = OGRPoint( dfX, dfY, dfZ );
+        else
+        {
+            oPoint = OGRPoint( dfX, dfY, 0.0, dfM );
+            oPoint.set3D(FALSE);
+        }
+
+        if( poRecycled != NULL &&
+            wkbFlatten(poRecycled->getGeometryType()) == wkbPoint )
+        {
+            *((OGRPoint *) poRecycled) = oPoint;
+            return poRecycled;
+        }
+        delete poRecycled;
+        return new OGRPoint( oPoint );
+    }
+
+    if( nSHPType != SHPT_ARC && nSHPType != SHPT_ARCZ &&
+        nSHPType != SHPT_ARCM && nSHPType != SHPT_POLYGON &&
+        nSHPType != SHPT_POLYGONZ && nSHPType != SHPT_POLYGONM )
+    {
+        *pbHandled = nSHPType == SHPT_NULL;
+        delete poRecycled;
+        return NULL;
+    }
+
+/* -------------------------------------------------------------------- */
+/*      Arc or polygon: check the record as SHPReadObject() does.       */
+/* -------------------------------------------------------------------- */
+    const bool bHasZ = nSHPType == SHPT_ARCZ || nSHPType == SHPT_POLYGONZ;
+    int nPoints = 0;
+    int nParts = 0;
+    if( 40 + 8 + 4 <= nEntitySize )
+    {
+        memcpy( &nPoints, pabyRec + 40 + 8, 4 );
+        memcpy( &nParts, pabyRec + 36 + 8, 4 );
+    }
+    if( 40 + 8 + 4 > nEntitySize ||
+        nPoints < 0 || nParts < 0 ||
+        nPoints > 50 * 1000 * 1000 || nParts > 10 * 1000 * 1000 ||
+        44 + 8 + 4 * nParts + 16 * nPoints +
+            (bHasZ ? 16 + 8 * nPoints : 0) > nEntitySize )
+    {
+        *pbHandled = false;
+        delete poRecycled;
+        return NULL;
+    }
+
+    const GByte *pabyParts = pabyRec + 44 + 8;
+    for( int i = 0; i < nParts; i++ )
+    {
+        int nStart = 0;
+        int nPrevStart = 0;
+        memcpy( &nStart, pabyParts + 4 * i, 4 );
+        if( i > 0 )
+            memcpy( &nPrevStart, pabyParts + 4 * (i - 1), 4 );
+        if( nStart < 0 || (nStart >= nPoints && nPoints > 0) ||
+            (nStart > 0 && nPoints == 0) ||
+            (i > 0 && nStart <= nPrevStart) )
+        {
+            *pbHandled = false;
+            delete poRecycled;
+            return NULL;
+        }
+    }
+
+    if( nParts == 0 )
+    {
+        delete poRecycled;
+        return NULL;
+    }
+
+    int nOffset = 44 + 8 + 4 * nParts;
+    const GByte *pabyXY = pabyRec + nOffset;
+    nOffset += 16 * nPoints;
+    const GByte *pabyZ = NULL;
+    if( bHasZ )
+    {
+        pabyZ = pabyRec + nOffset + 16;
+        nOffset += 16 + 8 * nPoints;
+    }
+    // Measures are only used for the Z and M types, when present.
+    const GByte *pabyM = NULL;
+    if( nSHPType != SHPT_ARC && nSHPType != SHPT_POLYGON &&
+        nEntitySize >= nOffset + 16 + 8 * nPoints )
+    {
+        pabyM = pabyRec + nOffset + 16;
+    }
+
+/* -------------------------------------------------------------------- */
+/*      Arc (LineString, or MultiLineString for several parts).         */
+/* -------------------------------------------------------------------- */
+    if( nSHPType == SHPT_ARC || nSHPType == SHPT_ARCZ ||
+        nSHPType == SHPT_ARCM )
+    {
+        if( nParts == 1 )
+        {
+            OGRLineString *poLine = NULL;
+            if( poRecycled != NULL &&
+                wkbFlatten(poRecycled->getGeometryType()) == wkbLineString )
+            {
+                poLine = (OGRLineString *) poRecycled;
+            }
+            else
+            {
+                delete poRecycled;
+                poLine = new OGRLineString();
+            }
+            SetCurveFromRecord( poLine, nPoints, pabyXY, pabyZ, pabyM );
+            return poLine;
+        }
+
+        delete poRecycled;
+        OGRMultiLineString *poMulti = new OGRMultiLineString();
+        for( int iPart = 0; iPart < nParts; iPart++ )
+        {
+            int nStart = 0;
+            int nEnd = nPoints;
+            memcpy( &nStart, pabyParts + 4 * iPart, 4 );
+            if( iPart < nParts - 1 )
+                memcpy( &nEnd, pabyParts + 4 * (iPart + 1), 4 );
+
+            OGRLineString *poLine = new OGRLineString();
+            SetCurveFromRecord( poLine, nEnd - nStart, pabyXY + 16 * nStart,
+                                pabyZ ? pabyZ + 8 * nStart : NULL,
+                                pabyM ? pabyM + 8 * nStart : NULL );
+            poMulti->addGeometryDirectly( poLine );
+        }
+        return poMulti;
+    }
+
+/* -------------------------------------------------------------------- */
+/*      Polygon. Each part is a ring, and parts are grouped in          */
+/*      polygons by organizePolygons() as in SHPReadOGRObject().        */
+/* -------------------------------------------------------------------- */
+    if( nParts == 1 )
+    {
+        OGRPolygon *poPoly = NULL;
+        OGRLinearRing *poRing = NULL;
+        if( poRecycled != NULL &&
+            wkbFlatten(poRecycled->getGeometryType()) == wkbPolygon &&
+            ((OGRPolygon *) poRecycled)->getExteriorRing() != NULL &&
+            ((OGRPolygon *) poRecycled)->getNumInteriorRings() == 0 )
+        {
+            poPoly = (OGRPolygon *) poRecycled;
+            poRing = poPoly->getExteriorRing();
+        }
+        else
+        {
+            delete poRecycled;
+            poPoly = new OGRPolygon();
+            poRing = new OGRLinearRing();
+            poPoly->addRingDirectly( poRing );
+        }
+        if( nPoints > 0 )
+        {
+            SetCurveFromRecord( poRing, nPoints, pabyXY, pabyZ, pabyM );
+        }
+        else
+        {
+            // As CreateLinearRing() does for an empty part.
+            poRing->empty();
+            poRing->set3D(FALSE);
+            poRing->setMeasured(FALSE);
+        }
+        poPoly->set3D( poRing->Is3D() );
+        poPoly->setMeasured( poRing->IsMeasured() );
+        return poPoly;
+    }
+
+    delete poRecycled;
+    OGRPolygon **papoPolygons = new OGRPolygon*[nParts];
+    for( int iPart = 0; iPart < nParts; iPart++ )
+    {
+        int nStart = 0;
+        int nEnd = nPoints;
+        memcpy( &nStart, pabyParts + 4 * iPart, 4 );
+        if( iPart < nParts - 1 )
+            memcpy( &nEnd, pabyParts + 4 * (iPart + 1), 4 );
+
+        OGRLinearRing *poRing = new OGRLinearRing();
+        SetCurveFromRecord( poRing, nEnd - nStart, pabyXY + 16 * nStart,
+                            pabyZ ? pabyZ + 8 * nStart : NULL,
+                            pabyM ? pabyM + 8 * nStart : NULL );
+        papoPolygons[iPart] = new OGRPolygon();
+        papoPolygons[iPart]->addRingDirectly( poRing );
+    }
+
+    int isValidGeometry;
+    const char* papszOptions[] = { "METHOD=ONLY_CCW", NULL };
+    OGRGeometry *poOGR = OGRGeometryFactory::organizePolygons(
+        (OGRGeometry**)papoPolygons, nParts, &isValidGeometry, papszOptions );
+
+    if (!isValidGeometry)
+    {
+        CPLError(CE_Warning, CPLE_AppDefined,
+                "Geometry of polygon of fid %d cannot be translated to Simple Geometry. "
+                "All polygons will be contained in a multipolygon.\n",
+                iShape);
+    }
+
+    delete[] papoPolygons;
+    return poOGR;
+}
+
+#endif /* def CPL_LSB */
+
 /************************************************************************/
 /*                          SHPReadOGRObject()                          */
 /*                                                                      */
 /*      Read an item in a shapefile, and translate to OGR geometry      */
 /*      representation.                                                 */
+/*                                                                      */
+/*      poRecycled is an optional geometry the caller no longer needs,  */
+/*      whose storage may be reused for the result. It is owned by      */
+/*      this function in all cases.                                     */
 /************************************************************************/
 
-OGRGeometry *SHPReadOGRObject( SHPHandle hSHP, int iShape, SHPObject *psShape )
+OGRGeometry *SHPReadOGRObject( SHPHandle hSHP, int iShape, SHPObject *psShape,
+                               OGRGeometry *poRecycled )
 {
     // CPLDebug( "Shape", "SHPReadOGRObject( iShape=%d )\n", iShape );
 
     OGRGeometry *poOGR = NULL;
 
     if( psShape == NULL )
+    {
+#ifdef CPL_LSB
+/* -------------------------------------------------------------------- */
+/*      Decode points, arcs and polygons straight from the record.      */
+/* -------------------------------------------------------------------- */
+        int nEntitySize = 0;
+        const GByte *pabyRec = SHPReadObjectRecord( hSHP, iShape,
+                                                    &nEntitySize );
+        if( pabyRec == NULL )
+        {
+            delete poRecycled;
+            return NULL;
+        }
+
+        bool bHandled = false;
+        poOGR = SHPReadOGRObjectDirect( iShape, pabyRec, nEntitySize,
+                                        poRecycled, &bHandled );
+        if( bHandled )
+            return poOGR;
+        poRecycled = NULL;
+#endif
+
+        // The record is still in the buffer of the handle, so this does
+        // not read the file again.
         psShape = SHPReadObject( hSHP, iShape );
+    }
+
+    delete poRecycled;
 
     if( psShape == NULL )
     {
@@ -1158,7 +1471,8 @@ OGRFeatureDefn *SHPReadOGRFeatureDefn( const char * pszName,
 
 OGRFeature *SHPReadOGRFeature( SHPHandle hSHP, DBFHandle hDBF,
                                OGRFeatureDefn * poDefn, int iShape,
-                               SHPObject *psShape, const char *pszSHPEncoding )
+                               SHPObject *psShape, const char *pszSHPEncoding,
+                               OGRGeometry *poRecycledGeom )
 
 {
     if( iShape < 0
@@ -1168,6 +1482,7 @@ OGRFeature *SHPReadOGRFeature( SHPHandle hSHP, DBFHandle hDBF,
         CPLError( CE_Failure, CPLE_AppDefined,
                   "Attempt to read shape with feature id (%d) out of available"
                   " range.", iShape );
+        delete poRecycledGeom;
         return NULL;
     }
 
@@ -1178,6 +1493,7 @@ OGRFeature *SHPReadOGRFeature( SHPHandle hSHP, DBFHandle hDBF,
                   iShape );
         if( psShape != NULL )
             SHPDestroyObject(psShape);
+        delete poRecycledGeom;
         return NULL;
     }
 
@@ -1191,7 +1507,9 @@ OGRFeature *SHPReadOGRFeature( SHPHandle hSHP, DBFHandle hDBF,
         if( !poDefn->IsGeometryIgnored() )
         {
             OGRGeometry* poGeometry = NULL;
-            poGeometry = SHPReadOGRObject( hSHP, iShape, psShape );
+            poGeometry = SHPReadOGRObject( hSHP, iShape, psShape,
+                                           poRecycledGeom );
+            poRecycledGeom = NULL;
 
             /*
             * NOTE - mloskot:
@@ -1236,6 +1554,7 @@ OGRFeature *SHPReadOGRFeature( SHPHandle hSHP, DBFHandle hDBF,
             SHPDestroyObject( psShape );
         }
     }
+    delete poRecycledGeom;
 
 /* -------------------------------------------------------------------- */
 /*      Fetch feature attributes to OGRFeature fields.                  */
@@ -168,6 +168,26 @@ void SHPAPI_CALL SASetupDefaultHooks( SAHooks *psHooks );
 void SHPAPI_CALL SASetupUtf8Hooks( SAHooks *psHooks );
 #endif
 
+/* -------------------------------------------------------------------- */
+/*      Read-ahead window, used to serve sequential record reads       */
+/*      from a large contiguous read instead of one seek+read per      */
+/*      record.                                                         */
+/* -------------------------------------------------------------------- */
+typedef struct
+{
+    unsigned char *pabyData;
+    int         nBufSize;     /* 0 if read-ahead is disabled */
+    SAOffset    nOffset;      /* file offset of pabyData[0] */
+    int         nSize;        /* number of valid bytes in pabyData */
+    SAOffset    nNextOffset;  /* end of the previous read, 0 if unknown */
+} SAReadAhead;
+
+void SAReadAheadSetSize( SAReadAhead *psRA, int nBufSize );
+void SAReadAheadInvalidate( SAReadAhead *psRA );
+int  SAReadAheadRead( SAHooks *psHooks, SAFile fp, SAReadAhead *psRA,
+                      SAOffset nOffset, void *pData, int nBytes,
+                      SAOffset nLimit );
+
 /************************************************************************/
 /*                             SHP Support.                             */
 /************************************************************************/
@@ -201,6 +221,12 @@ typedef struct
     unsigned char *pabyObjectBuf;
     int            nObjectBufSize;
     SHPObject*     psCachedObject;
+
+    SAReadAhead    sSHPReadAhead;
+    SAReadAhead    sSHXReadAhead;
+
+    int            nRecInBuf;      /* shape whose record is in pabyRec, -1 if none */
+    int            nRecInBufSize;
 } SHPInfo;
 
 typedef SHPInfo * SHPHandle;
@@ -295,6 +321,11 @@ int SHPAPI_CALL
 /* type. It is illegal to free at hand any of the pointer members of the SHPObject structure */
 void SHPAPI_CALL SHPSetFastModeReadObject( SHPHandle hSHP, int bFastMode );
 
+/* Size in bytes of the windows read ahead of the current position of */
+/* the .shp and .shx files when shapes are read in increasing order. */
+/* 0 (the default) disables read-ahead. */
+void SHPAPI_CALL SHPSetReadAheadSize( SHPHandle hSHP, int nBufSize );
+
 SHPHandle SHPAPI_CALL
       SHPCreate( const char * pszShapeFile, int nShapeType );
 SHPHandle SHPAPI_CALL
@@ -306,6 +337,12 @@ void SHPAPI_CALL
 
 SHPObject SHPAPI_CALL1(*)
       SHPReadObject( SHPHandle hSHP, int iShape );
+
+/* Returns the raw record of a shape, starting with its 8 byte record header, */
+/* and sets *pnRecordSize to its size. The buffer is owned by the SHPHandle, */
+/* and is only valid until the next read or write of a shape. */
+const unsigned char SHPAPI_CALL1(*)
+      SHPReadObjectRecord( SHPHandle hSHP, int iShape, int *pnRecordSize );
 int SHPAPI_CALL
       SHPWriteObject( SHPHandle hSHP, int iShape, SHPObject * psObject );
 
@@ -491,6 +528,8 @@ typedef struct
     int         nUpdateYearSince1900; /* 0-255 */
     int         nUpdateMonth; /* 1-12 */
     int         nUpdateDay; /* 1-31 */
+
+    SAReadAhead sReadAhead;
 } DBFInfo;
 
 typedef DBFInfo * DBFHandle;
@@ -601,6 +640,12 @@ const char SHPAPI_CALL1(*)
 void SHPAPI_CALL
     DBFSetLastModifiedDate( DBFHandle psDBF, int nYYSince1900, int nMM, int nDD );
 
+/* Size in bytes of the window read ahead of the current position of */
+/* the .dbf file when records are read in increasing order. */
+/* 0 (the default) disables read-ahead. */
+void SHPAPI_CALL
+    DBFSetReadAheadSize( DBFHandle psDBF, int nBufSize );
+
 #ifdef __cplusplus
 }
 #endif
@@ -345,6 +345,138 @@ static void * SfRealloc( void * pMem, int nNewSize )
         return( (void *) realloc(pMem,nNewSize) );
 }
 
+/************************************************************************/
+/*                         SAReadAheadSetSize()                         */
+/*                                                                      */
+/*      Set the size of the read-ahead window. 0 disables it. The       */
+/*      buffer itself is only allocated on the first sequential read.   */
+/************************************************************************/
+
+void SAReadAheadSetSize( SAReadAhead *psRA, int nBufSize )
+
+{
+    if( nBufSize < 0 )
+        nBufSize = 0;
+    if( nBufSize != psRA->nBufSize )
+    {
+        free( psRA->pabyData );
+        psRA->pabyData = NULL;
+        psRA->nBufSize = nBufSize;
+    }
+    SAReadAheadInvalidate( psRA );
+}
+
+/************************************************************************/
+/*                        SAReadAheadInvalidate()                       */
+/*                                                                      */
+/*      Discard the content of the window, to be called when the file   */
+/*      is written.                                                     */
+/************************************************************************/
+
+void SAReadAheadInvalidate( SAReadAhead *psRA )
+
+{
+    psRA->nOffset = 0;
+    psRA->nSize = 0;
+    psRA->nNextOffset = 0;
+}
+
+/************************************************************************/
+/*                           SAReadAheadRead()                          */
+/*                                                                      */
+/*      Read nBytes at nOffset into pData, as a FSeek() followed by     */
+/*      FRead( pData, 1, nBytes ) would do. Returns the number of       */
+/*      bytes read, or -1 if the seek failed.                           */
+/*                                                                      */
+/*      When the read starts at, or slightly after, the end of the      */
+/*      previous one, a whole window of the file is fetched and the     */
+/*      following reads are served from memory. Random reads go         */
+/*      directly to the file so they do not pay for the window.         */
+/*      nLimit, if not 0, is the offset of the end of the useful data   */
+/*      of the file: the window is not extended beyond it, so that      */
+/*      the end-of-file status of the handle is not set before the      */
+/*      caller actually reaches that point.                             */
+/************************************************************************/
+
+int SAReadAheadRead( SAHooks *psHooks, SAFile fp, SAReadAhead *psRA,
+                     SAOffset nOffset, void *pData, int nBytes,
+                     SAOffset nLimit )
+
+{
+    int         bFill;
+    int         nRead;
+    SAOffset    nToRead;
+
+/* -------------------------------------------------------------------- */
+/*      Serve from the current window if possible.                      */
+/* -------------------------------------------------------------------- */
+    if( psRA->nSize > 0 && nOffset >= psRA->nOffset &&
+        nOffset - psRA->nOffset + nBytes <= (SAOffset) psRA->nSize )
+    {
+        memcpy( pData, psRA->pabyData + (nOffset - psRA->nOffset), nBytes );
+        psRA->nNextOffset = nOffset + nBytes;
+        return nBytes;
+    }
+
+/* -------------------------------------------------------------------- */
+/*      Only fetch a new window when reading forward, close to the      */
+/*      end of the previous read.                                       */
+/* -------------------------------------------------------------------- */
+    bFill = psRA->nBufSize > 0 && nBytes <= psRA->nBufSize &&
+            psRA->nNextOffset != 0 && nOffset >= psRA->nNextOffset &&
+            nOffset - psRA->nNextOffset < (SAOffset) psRA->nBufSize;
+    psRA->nNextOffset = nOffset + nBytes;
+
+    if( bFill && psRA->pabyData == NULL )
+    {
+        psRA->pabyData = (unsigned char *) malloc( psRA->nBufSize );
+        if( psRA->pabyData == NULL )
+            bFill = FALSE;
+    }
+
+    if( psHooks->FSeek( fp, nOffset, 0 ) != 0 )
+    {
+        psRA->nSize = 0;
+        return -1;
+    }
+
+    if( !bFill )
+        return (int) psHooks->FRead( pData, 1, nBytes, fp );
+
+/* -------------------------------------------------------------------- */
+/*      Fetch the window starting at the requested offset.              */
+/* -------------------------------------------------------------------- */
+    nToRead = psRA->nBufSize;
+    if( nLimit > 0 && nOffset + nToRead > nLimit )
+    {
+        if( nLimit > nOffset + nBytes )
+            nToRead = nLimit - nOffset;
+        else
+            nToRead = nBytes;
+    }
+
+    psRA->nSize = 0;
+    nRead = (int) psHooks->FRead( psRA->pabyData, 1, nToRead, fp );
+    if( nRead < nBytes )
+    {
+        /* Same outcome as a direct read: partial content and EOF. */
+        if( nRead > 0 )
+            memcpy( pData, psRA->pabyData, nRead );
+        return nRead;
+    }
+
+    /* Reset the end-of-file status if the window went past the end */
+    /* of a file shorter than expected. */
+    if( (SAOffset) nRead < nToRead )
+        psHooks->FSeek( fp, nOffset + nRead, 0 );
+
+    psRA->nOffset = nOffset;
+    psRA->nSize = nRead;
+    memcpy( pData, psRA->pabyData, nBytes );
+
+    return nBytes;
+}
+
 /************************************************************************/
 /*                          SHPWriteHeader()                            */
 /*                                                                      */
@@ -367,6 +499,9 @@ void SHPAPI_CALL SHPWriteHeader( SHPHandle psSHP )
         return;
     }
 
+    SAReadAheadInvalidate( &psSHP->sSHPReadAhead );
+    SAReadAheadInvalidate( &psSHP->sSHXReadAhead );
+
 /* -------------------------------------------------------------------- */
 /*      Prepare header block for .shp file.                             */
 /* -------------------------------------------------------------------- */
@@ -543,6 +678,7 @@ SHPOpenLL( const char * pszLayer, const char * pszAccess, SAHooks *psHooks )
     psSHP = (SHPHandle) calloc(sizeof(SHPInfo),1);
 
     psSHP->bUpdated = FALSE;
+    psSHP->nRecInBuf = -1;
     memcpy( &(psSHP->sHooks), psHooks, sizeof(SAHooks) );
 
 /* -------------------------------------------------------------------- */
@@ -1102,6 +1238,9 @@ SHPClose(SHPHandle psSHP )
         free( psSHP->psCachedObject );
     }
 
+    free( psSHP->sSHPReadAhead.pabyData );
+    free( psSHP->sSHXReadAhead.pabyData );
+
     free( psSHP );
 }
 
@@ -1127,6 +1266,16 @@ void SHPAPI_CALL SHPSetFastModeReadObject( SHPHandle hSHP, int bFastMode )
     hSHP->bFastModeReadObject = bFastMode;
 }
 
+/************************************************************************/
+/*                        SHPSetReadAheadSize()                         */
+/************************************************************************/
+
+void SHPAPI_CALL SHPSetReadAheadSize( SHPHandle hSHP, int nBufSize )
+{
+    SAReadAheadSetSize( &hSHP->sSHPReadAhead, nBufSize );
+    SAReadAheadSetSize( &hSHP->sSHXReadAhead, nBufSize );
+}
+
 /************************************************************************/
 /*                             SHPGetInfo()                             */
 /*                                                                      */
@@ -1522,6 +1671,8 @@ SHPWriteObject(SHPHandle psSHP, int nShapeId, SHPObject * psObject )
     int     bExtendFile = FALSE;
 
     psSHP->bUpdated = TRUE;
+    psSHP->nRecInBuf = -1;
+    SAReadAheadInvalidate( &psSHP->sSHPReadAhead );
 
 /* -------------------------------------------------------------------- */
 /*      Ensure that shape object matches the type of the file it is     */
@@ -1966,20 +2117,20 @@ static unsigned char* SHPReallocObjectBufIfNecessary ( SHPHandle psSHP,
 }
 
 /************************************************************************/
-/*                          SHPReadObject()                             */
+/*                        SHPReadObjectRecord()                         */
 /*                                                                      */
-/*      Read the vertices, parts, and other non-attribute information	*/
-/*	for one shape.							*/
+/*      Read the raw record of one shape in the record buffer of the    */
+/*      handle, and return it. The record of the last shape read is     */
+/*      kept, so that reading it again, for example after a bounding    */
+/*      box check, does not hit the file.                               */
 /************************************************************************/
 
-SHPObject SHPAPI_CALL1(*)
-SHPReadObject( SHPHandle psSHP, int hEntity )
+const unsigned char SHPAPI_CALL1(*)
+SHPReadObjectRecord( SHPHandle psSHP, int hEntity, int *pnRecordSize )
 
 {
-    int                  nEntitySize, nRequiredSize;
-    SHPObject           *psShape;
+    int                  nEntitySize;
     char                 szErrorMsg[128];
-    int                  nSHPType;
     int                  nBytesRead;
 
 /* -------------------------------------------------------------------- */
@@ -1988,16 +2139,25 @@ SHPReadObject( SHPHandle psSHP, int hEntity )
     if( hEntity < 0 || hEntity >= psSHP->nRecords )
         return( NULL );
 
+    if( hEntity == psSHP->nRecInBuf && psSHP->pabyRec != NULL )
+    {
+        *pnRecordSize = psSHP->nRecInBufSize;
+        return psSHP->pabyRec;
+    }
+    psSHP->nRecInBuf = -1;
+
 /* -------------------------------------------------------------------- */
 /*      Read offset/length from SHX loading if necessary.               */
 /* -------------------------------------------------------------------- */
     if( psSHP->panRecOffset[hEntity] == 0 && psSHP->fpSHX != NULL )
     {
         unsigned int       nOffset, nLength;
+        uchar              abyEntry[8];
 
-        if( psSHP->sHooks.FSeek( psSHP->fpSHX, 100 + 8 * hEntity, 0 ) != 0 ||
-            psSHP->sHooks.FRead( &nOffset, 1, 4, psSHP->fpSHX ) != 4 ||
-            psSHP->sHooks.FRead( &nLength, 1, 4, psSHP->fpSHX ) != 4 )
+        if( SAReadAheadRead( &psSHP->sHooks, psSHP->fpSHX,
+                             &psSHP->sSHXReadAhead,
+                             100 + 8 * (SAOffset) hEntity, abyEntry, 8,
+                             100 + 8 * (SAOffset) psSHP->nRecords ) != 8 )
         {
             char str[128];
             snprintf( str, sizeof(str),
@@ -2007,6 +2167,8 @@ SHPReadObject( SHPHandle psSHP, int hEntity )
             psSHP->sHooks.Error( str );
             return NULL;
         }
+        memcpy( &nOffset, abyEntry, 4 );
+        memcpy( &nLength, abyEntry + 4, 4 );
         if( !bBigEndian ) SwapWord( 4, &nOffset );
         if( !bBigEndian ) SwapWord( 4, &nLength );
 
@@ -2099,7 +2261,12 @@ SHPReadObject( SHPHandle psSHP, int hEntity )
 /* -------------------------------------------------------------------- */
 /*      Read the record.                                                */
 /* -------------------------------------------------------------------- */
-    if( psSHP->sHooks.FSeek( psSHP->fpSHP, psSHP->panRecOffset[hEntity], 0 ) != 0 )
+    nBytesRead = SAReadAheadRead( &psSHP->sHooks, psSHP->fpSHP,
+                                  &psSHP->sSHPReadAhead,
+                                  psSHP->panRecOffset[hEntity],
+                                  psSHP->pabyRec, nEntitySize,
+                                  psSHP->nFileSize );
+    if( nBytesRead < 0 )
     {
         /*
          * TODO - mloskot: Consider detailed diagnostics of shape file,
@@ -2114,8 +2281,6 @@ SHPReadObject( SHPHandle psSHP, int hEntity )
         return NULL;
     }
 
-    nBytesRead = (int)psSHP->sHooks.FRead( psSHP->pabyRec, 1, nEntitySize, psSHP->fpSHP );
-
     /* Special case for a shapefile whose .shx content length field is not equal */
     /* to the content length field of the .shp, which is a violation of "The */
     /* content length stored in the index record is the same as the value stored in the main */
@@ -2164,6 +2329,32 @@ SHPReadObject( SHPHandle psSHP, int hEntity )
         psSHP->sHooks.Error( szErrorMsg );
         return NULL;
     }
+
+    psSHP->nRecInBuf = hEntity;
+    psSHP->nRecInBufSize = nEntitySize;
+    *pnRecordSize = nEntitySize;
+    return psSHP->pabyRec;
+}
+
+/************************************************************************/
+/*                          SHPReadObject()                             */
+/*                                                                      */
+/*      Read the vertices, parts, and other non-attribute information	*/
+/*	for one shape.							*/
+/************************************************************************/
+
+SHPObject SHPAPI_CALL1(*)
+SHPReadObject( SHPHandle psSHP, int hEntity )
+
+{
+    int                  nEntitySize, nRequiredSize;
+    SHPObject           *psShape;
+    char                 szErrorMsg[128];
+    int                  nSHPType;
+
+    if( SHPReadObjectRecord( psSHP, hEntity, &nEntitySize ) == NULL )
+        return NULL;
+
     memcpy( &nSHPType, psSHP->pabyRec + 8, 4 );
 
     if( bBigEndian ) SwapWord( 4, &(nSHPType) );
@@ -32,9 +32,12 @@
 #include "cpl_csv.h"
 #include "cpl_http.h"
 #include "cpl_multiproc.h"
+#include "ogr_lrucache.h"
 #include "ogr_p.h"
 #include "ogr_spatialref.h"
 
+#include <vector>
+
 CPL_CVSID("$Id$");
 
 // The current opinion is that WKT longitudes like central meridian
@@ -43,6 +46,9 @@ CPL_CVSID("$Id$");
 // of then geogcs.
 #undef WKT_LONGITUDE_RELATIVE_TO_PM
 
+// WKT strings longer than this are not looked up in the import cache.
+static const size_t MAX_WKT_CACHE_KEY_SIZE = 16384;
+
 /************************************************************************/
 /*                           OGRsnPrintDouble()                         */
 /************************************************************************/
@@ -718,6 +724,25 @@ OGRErr OGRSpatialReference::importFromWkt( char ** ppszInput )
 
     Clear();
 
+/* -------------------------------------------------------------------- */
+/*      Reuse the result of a previous import of the same string.       */
+/* -------------------------------------------------------------------- */
+    const char *pszInputStart = *ppszInput;
+    CPLString osCacheKey;
+    if( strlen(pszInputStart) < MAX_WKT_CACHE_KEY_SIZE )
+    {
+        osCacheKey = "WKT:";
+        osCacheKey += pszInputStart;
+
+        size_t nConsumed = 0;
+        poRoot = OSRGetCachedImport( osCacheKey, &nConsumed );
+        if( poRoot != NULL )
+        {
+            *ppszInput += nConsumed;
+            return OGRERR_NONE;
+        }
+    }
+
     poRoot = new OGR_SRSNode();
 
     OGRErr eErr = poRoot->importFromWkt( ppszInput );
@@ -737,9 +762,12 @@ OGRErr OGRSpatialReference::importFromWkt( char ** ppszInput )
             (*ppszInput)++;
         OGR_SRSNode *poNewChild = new OGR_SRSNode();
         poRoot->AddChild( poNewChild );
-        return poNewChild->importFromWkt( ppszInput );
+        eErr = poNewChild->importFromWkt( ppszInput );
     }
 
+    if( eErr == OGRERR_NONE && !osCacheKey.empty() )
+        OSRCacheImport( osCacheKey, poRoot, *ppszInput - pszInputStart );
+
     return eErr;
 }
 
@@ -7121,6 +7149,117 @@ OGRErr OGRSpatialReference::SetExtension( const char *pszTargetKey,
     return OGRERR_NONE;
 }
 
+/* ==================================================================== */
+/*      Process-wide cache of SRS imports.                              */
+/*                                                                      */
+/*      importFromWkt() and importFromEPSGA() store a copy of the root  */
+/*      node of successful imports, keyed by their input, so that       */
+/*      repeated imports of the same definition only cost a Clone().    */
+/* ==================================================================== */
+
+typedef struct
+{
+    OGR_SRSNode *poRoot;
+    size_t       nConsumed;
+} OGRSRSImportCacheEntry;
+
+static CPLMutex *hSRSImportCacheMutex = NULL;
+static OGRLRUCache<OGRSRSImportCacheEntry> *poSRSImportCache = NULL;
+static GUIntBig nSRSImportCacheHits = 0;
+static GUIntBig nSRSImportCacheMisses = 0;
+
+/************************************************************************/
+/*                       OSRGetImportCacheSize()                        */
+/************************************************************************/
+
+static int OSRGetImportCacheSize()
+{
+    return atoi(CPLGetConfigOption("OSR_IMPORT_CACHE_SIZE", "64"));
+}
+
+/************************************************************************/
+/*                         OSRGetCachedImport()                         */
+/*                                                                      */
+/*      Returns a copy of the root node cached for pszKey, or NULL.     */
+/************************************************************************/
+
+OGR_SRSNode *OSRGetCachedImport( const char *pszKey, size_t *pnConsumed )
+{
+    if( OSRGetImportCacheSize() <= 0 )
+        return NULL;
+
+    CPLMutexHolderD( &hSRSImportCacheMutex );
+    OGRSRSImportCacheEntry *psEntry =
+        poSRSImportCache != NULL ? poSRSImportCache->Get(pszKey) : NULL;
+    if( psEntry == NULL )
+    {
+        nSRSImportCacheMisses++;
+        return NULL;
+    }
+    nSRSImportCacheHits++;
+    if( pnConsumed != NULL )
+        *pnConsumed = psEntry->nConsumed;
+    return psEntry->poRoot->Clone();
+}
+
+/************************************************************************/
+/*                           OSRCacheImport()                           */
+/************************************************************************/
+
+void OSRCacheImport( const char *pszKey, const OGR_SRSNode *poRoot,
+                     size_t nConsumed )
+{
+    const int nCacheSize = OSRGetImportCacheSize();
+    if( nCacheSize <= 0 || poRoot == NULL )
+        return;
+
+    OGRSRSImportCacheEntry sEntry;
+    sEntry.poRoot = poRoot->Clone();
+    sEntry.nConsumed = nConsumed;
+
+    std::vector<OGRSRSImportCacheEntry> asEvicted;
+    {
+        CPLMutexHolderD( &hSRSImportCacheMutex );
+        if( poSRSImportCache == NULL )
+            poSRSImportCache =
+                new OGRLRUCache<OGRSRSImportCacheEntry>(nCacheSize);
+        poSRSImportCache->Insert(pszKey, sEntry, asEvicted);
+    }
+    for( size_t i = 0; i < asEvicted.size(); i++ )
+        delete asEvicted[i].poRoot;
+}
+
+/************************************************************************/
+/*                       OSRCleanupImportCache()                        */
+/************************************************************************/
+
+static void OSRCleanupImportCache()
+{
+    if( hSRSImportCacheMutex == NULL )
+        return;
+
+    std::vector<OGRSRSImportCacheEntry> asEvicted;
+    {
+        CPLMutexHolderD( &hSRSImportCacheMutex );
+        if( poSRSImportCache != NULL )
+        {
+            poSRSImportCache->Clear(asEvicted);
+            delete poSRSImportCache;
+            poSRSImportCache = NULL;
+        }
+        CPLDebug( "OSR", "Import cache: " CPL_FRMT_GUIB " hits, "
+                  CPL_FRMT_GUIB " misses",
+                  nSRSImportCacheHits, nSRSImportCacheMisses );
+        nSRSImportCacheHits = 0;
+        nSRSImportCacheMisses = 0;
+    }
+    for( size_t i = 0; i < asEvicted.size(); i++ )
+        delete asEvicted[i].poRoot;
+
+    CPLDestroyMutex(hSRSImportCacheMutex);
+    hSRSImportCacheMutex = NULL;
+}
+
 /************************************************************************/
 /*                             OSRCleanup()                             */
 /************************************************************************/
@@ -7141,6 +7280,8 @@ void OSRCleanup( void )
 {
     CleanupESRIDatumMappingTable();
     CSVDeaccess( NULL );
+    OSRCleanupImportCache();
+    OCTCleanupTransformCache();
     OCTCleanupProjMutex();
     CleanupSRSWGS84Thread();
 }
@@ -52,6 +52,35 @@ void swqerror( swq_parse_context *context, const char *msg )
 }
 
 
+/************************************************************************/
+/*                        swq_skip_white_space()                        */
+/************************************************************************/
+
+static const char *swq_skip_white_space( const char *pszInput )
+{
+    while( *pszInput == ' ' || *pszInput == '\t'
+           || *pszInput == 10 || *pszInput == 13 )
+        pszInput++;
+    return pszInput;
+}
+
+/************************************************************************/
+/*                          swq_next_word_is()                          */
+/*                                                                      */
+/*      Check if the next word of the input is pszWord.                 */
+/************************************************************************/
+
+static bool swq_next_word_is( const char *pszInput, const char *pszWord )
+{
+    pszInput = swq_skip_white_space( pszInput );
+    const size_t nLen = strlen(pszWord);
+    if( !EQUALN(pszInput, pszWord, nLen) )
+        return false;
+    const char chNext = pszInput[nLen];
+    return !(isalnum(chNext) || chNext == '_' ||
+             ((unsigned char) chNext) > 127);
+}
+
 /************************************************************************/
 /*                               swqlex()                               */
 /*                                                                      */
@@ -77,9 +106,7 @@ int swqlex( YYSTYPE *ppNode, swq_parse_context *context )
 /* -------------------------------------------------------------------- */
 /*      Skip white space.                                               */
 /* -------------------------------------------------------------------- */
-    while( *pszInput == ' ' || *pszInput == '\t'
-           || *pszInput == 10 || *pszInput == 13 )
-        pszInput++;
+    pszInput = swq_skip_white_space( pszInput );
 
     context->pszLastValid = pszInput;
 
@@ -243,6 +270,10 @@ int swqlex( YYSTYPE *ppNode, swq_parse_context *context )
             nReturn = SWQT_ON;
         else if( EQUAL(osToken,"ORDER") )
             nReturn = SWQT_ORDER;
+        // GROUP is only a keyword when followed by BY, so that it can
+        // still be used as a field name.
+        else if( EQUAL(osToken,"GROUP") && swq_next_word_is(pszNext, "BY") )
+            nReturn = SWQT_GROUP;
         else if( EQUAL(osToken,"BY") )
             nReturn = SWQT_BY;
         else if( EQUAL(osToken,"FROM") )
@@ -261,10 +292,16 @@ int swqlex( YYSTYPE *ppNode, swq_parse_context *context )
             nReturn = SWQT_UNION;
         else if( EQUAL(osToken,"ALL") )
             nReturn = SWQT_ALL;
+        else if( EQUAL(osToken,"LIMIT") )
+            nReturn = SWQT_LIMIT;
+        // OFFSET is only a keyword when followed by its value, so that it
+        // can still be used as a field name.
+        else if( EQUAL(osToken,"OFFSET") &&
+                 isdigit(*swq_skip_white_space(pszNext)) )
+            nReturn = SWQT_OFFSET;
 
         /* Unhandled by OGR SQL */
-        else if( EQUAL(osToken,"LIMIT") ||
-                 EQUAL(osToken,"OUTER") ||
+        else if( EQUAL(osToken,"OUTER") ||
                  EQUAL(osToken,"INNER") )
             nReturn = SWQT_RESERVED_KEYWORD;
 
@@ -323,12 +360,7 @@ swq_select_summarize( swq_select *select_info,
                 sizeof(swq_summary) * select_info->result_columns );
 
         for( int i = 0; i < select_info->result_columns; i++ )
-        {
-            select_info->column_summary[i].min = 1e20;
-            select_info->column_summary[i].max = -1e20;
-            strcpy(select_info->column_summary[i].szMin, "9999/99/99 99:99:99");
-            strcpy(select_info->column_summary[i].szMax, "0000/00/00 00:00:00");
-        }
+            swq_summary_init( select_info->column_summary + i );
     }
 
 /* -------------------------------------------------------------------- */
@@ -372,10 +404,35 @@ swq_select_summarize( swq_select *select_info,
         }
     }
 
-/* -------------------------------------------------------------------- */
-/*      Process various options.                                        */
-/* -------------------------------------------------------------------- */
+    return swq_summary_add_value( def, summary, value );
+}
 
+/************************************************************************/
+/*                          swq_summary_init()                          */
+/************************************************************************/
+
+void swq_summary_init( swq_summary *summary )
+
+{
+    memset( summary, 0, sizeof(swq_summary) );
+    summary->min = 1e20;
+    summary->max = -1e20;
+    strcpy(summary->szMin, "9999/99/99 99:99:99");
+    strcpy(summary->szMax, "0000/00/00 00:00:00");
+}
+
+/************************************************************************/
+/*                       swq_summary_add_value()                        */
+/*                                                                      */
+/*      Accumulate a value in the summary of a column with a column     */
+/*      function.  value is NULL for a null field.                      */
+/************************************************************************/
+
+const char *swq_summary_add_value( const swq_col_def *def,
+                                   swq_summary *summary,
+                                   const char *value )
+
+{
     switch( def->col_func )
     {
       case SWQCF_MIN:
@@ -474,6 +531,36 @@ swq_select_summarize( swq_select *select_info,
 
     return NULL;
 }
+
+/************************************************************************/
+/*                         swq_summary_merge()                          */
+/*                                                                      */
+/*      Combine in summary the partial summary other, computed on       */
+/*      another subset of the records.                                  */
+/************************************************************************/
+
+void swq_summary_merge( const swq_col_def *def,
+                        swq_summary *summary,
+                        const swq_summary *other )
+
+{
+    summary->count += other->count;
+    summary->sum += other->sum;
+    if( other->min < summary->min )
+        summary->min = other->min;
+    if( other->max > summary->max )
+        summary->max = other->max;
+    if( def->field_type == SWQ_DATE ||
+        def->field_type == SWQ_TIME ||
+        def->field_type == SWQ_TIMESTAMP )
+    {
+        if( strcmp( other->szMin, summary->szMin ) < 0 )
+            strcpy( summary->szMin, other->szMin );
+        if( strcmp( other->szMax, summary->szMax ) > 0 )
+            strcpy( summary->szMax, other->szMax );
+    }
+}
+
 /************************************************************************/
 /*                      sort comparison functions.                      */
 /************************************************************************/
@@ -824,13 +911,16 @@ static const char* const apszSQLReservedKeywords[] = {
     "WHERE",
     "ON",
     "ORDER",
+    "GROUP",
     "BY",
     "FROM",
     "AS",
     "ASC",
     "DESC",
     "UNION",
-    "ALL"
+    "ALL",
+    "LIMIT",
+    "OFFSET"
 };
 
 int swq_is_reserved_keyword(const char* pszStr)
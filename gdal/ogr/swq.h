@@ -239,7 +239,7 @@ CPLErr swq_expr_compile2( const char *where_clause,
 /*
 ** Evaluation related.
 */
-int swq_test_like( const char *input, const char *pattern );
+int swq_test_like( const char *input, const char *pattern, char chEscape );
 
 swq_expr_node *SWQGeneralEvaluator( swq_expr_node *, swq_expr_node **);
 swq_field_type SWQGeneralChecker( swq_expr_node *node, int bAllowMismatchTypeOnFieldComparison );
@@ -254,6 +254,7 @@ const char*    SWQFieldTypeToString( swq_field_type field_type );
 #define SWQM_SUMMARY_RECORD  1
 #define SWQM_RECORDSET       2
 #define SWQM_DISTINCT_LIST   3
+#define SWQM_GROUP_BY        4
 
 typedef enum {
     SWQCF_NONE = 0,
@@ -302,6 +303,13 @@ typedef struct {
     int   ascending_flag;
 } swq_order_def;
 
+typedef struct {
+    char *table_name;
+    char *field_name;
+    int   table_index;
+    int   field_index;
+} swq_group_def;
+
 typedef struct {
     int        secondary_table;
     swq_expr_node  *poExpr;
@@ -328,6 +336,7 @@ public:
 class swq_select
 {
     void        postpreparse();
+    CPLErr      ParseGroupBy( swq_field_list *field_list );
 
 public:
     swq_select();
@@ -355,10 +364,18 @@ public:
 
     swq_expr_node *where_expr;
 
+    void        PushGroupBy( const char* pszTableName, const char *pszFieldName );
+    int         group_specs;
+    swq_group_def *group_defs;
+    int         GetGroupByKey( int table_index, int field_index );
+
     void        PushOrderBy( const char* pszTableName, const char *pszFieldName, int bAscending );
     int         order_specs;
     swq_order_def *order_defs;
 
+    GIntBig     limit;  // -1 if no LIMIT clause
+    GIntBig     offset;
+
     swq_select *poOtherSelect;
     void        PushUnionAll( swq_select* poOtherSelectIn );
 
@@ -382,6 +399,14 @@ const char *swq_select_summarize( swq_select *select_info,
                                   int dest_column,
                                   const char *value );
 
+void        swq_summary_init( swq_summary *summary );
+const char *swq_summary_add_value( const swq_col_def *def,
+                                   swq_summary *summary,
+                                   const char *value );
+void        swq_summary_merge( const swq_col_def *def,
+                               swq_summary *summary,
+                               const swq_summary *other );
+
 int swq_is_reserved_keyword(const char* pszStr);
 
 char* OGRHStoreGetValue(const char* pszHStore, const char* pszSearchedKey);
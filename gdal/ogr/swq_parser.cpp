@@ -1,8 +1,9 @@
-/* A Bison parser, made by GNU Bison 3.0.  */
+/* A Bison parser, made by GNU Bison 3.8.2.  */
 
 /* Bison implementation for Yacc-like parsers in C
 
-   Copyright (C) 1984, 1989-1990, 2000-2013 Free Software Foundation, Inc.
+   Copyright (C) 1984, 1989-1990, 2000-2015, 2018-2021 Free Software Foundation,
+   Inc.
 
    This program is free software: you can redistribute it and/or modify
    it under the terms of the GNU General Public License as published by
@@ -15,7 +16,7 @@
    GNU General Public License for more details.
 
    You should have received a copy of the GNU General Public License
-   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+   along with this program.  If not, see <https://www.gnu.org/licenses/>.  */
 
 /* As a special exception, you may create a larger work that contains
    part or all of the Bison parser skeleton and distribute that work
@@ -33,6 +34,10 @@
 /* C LALR(1) parser skeleton written by Richard Stallman, by
    simplifying the original so-called "semantic" parser.  */
 
+/* DO NOT RELY ON FEATURES THAT ARE NOT DOCUMENTED in the manual,
+   especially those whose name start with YY_ or yy_.  They are
+   private implementation details that can be changed or removed.  */
+
 /* All symbols defined below should begin with yy or YY, to avoid
    infringing on user name space.  This should be done even for local
    variables, as they might otherwise be expanded by user macros.
@@ -40,11 +45,11 @@
    define necessary library symbols; they are noted "INFRINGES ON
    USER NAME SPACE" below.  */
 
-/* Identify Bison output.  */
-#define YYBISON 1
+/* Identify Bison output, and Bison version.  */
+#define YYBISON 30802
 
-/* Bison version.  */
-#define YYBISON_VERSION "3.0"
+/* Bison version string.  */
+#define YYBISON_VERSION "3.8.2"
 
 /* Skeleton name.  */
 #define YYSKELETON_NAME "yacc.c"
@@ -66,9 +71,8 @@
 #define yydebug         swqdebug
 #define yynerrs         swqnerrs
 
-
-/* Copy the first part of user declarations.  */
-#line 1 "swq_parser.y" /* yacc.c:339  */
+/* First part of user prologue.  */
+#line 1 "swq_parser.y"
 
 /******************************************************************************
  *
@@ -101,7 +105,6 @@
 
 
 #include "cpl_conv.h"
-#include "cpl_port.h"
 #include "cpl_string.h"
 #include "ogr_geometry.h"
 #include "swq.h"
@@ -116,120 +119,201 @@
 #define YYSTYPE_IS_TRIVIAL 1
 
 
-#line 119 "swq_parser.cpp" /* yacc.c:339  */
+#line 123 "swq_parser.cpp"
 
-# ifndef YY_NULL
-#  if defined __cplusplus && 201103L <= __cplusplus
-#   define YY_NULL nullptr
+# ifndef YY_CAST
+#  ifdef __cplusplus
+#   define YY_CAST(Type, Val) static_cast<Type> (Val)
+#   define YY_REINTERPRET_CAST(Type, Val) reinterpret_cast<Type> (Val)
 #  else
-#   define YY_NULL 0
+#   define YY_CAST(Type, Val) ((Type) (Val))
+#   define YY_REINTERPRET_CAST(Type, Val) ((Type) (Val))
+#  endif
+# endif
+# ifndef YY_NULLPTR
+#  if defined __cplusplus
+#   if 201103L <= __cplusplus
+#    define YY_NULLPTR nullptr
+#   else
+#    define YY_NULLPTR 0
+#   endif
+#  else
+#   define YY_NULLPTR ((void*)0)
 #  endif
 # endif
 
-/* Enabling verbose error messages.  */
-#ifdef YYERROR_VERBOSE
-# undef YYERROR_VERBOSE
-# define YYERROR_VERBOSE 1
-#else
-# define YYERROR_VERBOSE 1
-#endif
-
-/* In a future release of Bison, this section will be replaced
-   by #include "swq_parser.hpp".  */
-#ifndef YY_SWQ_SWQ_PARSER_HPP_INCLUDED
-# define YY_SWQ_SWQ_PARSER_HPP_INCLUDED
-/* Debug traces.  */
-#ifndef YYDEBUG
-# define YYDEBUG 0
-#endif
-#if YYDEBUG
-extern int swqdebug;
-#endif
-
-/* Token type.  */
-#ifndef YYTOKENTYPE
-# define YYTOKENTYPE
-  enum yytokentype
-  {
-    END = 0,
-    SWQT_INTEGER_NUMBER = 258,
-    SWQT_FLOAT_NUMBER = 259,
-    SWQT_STRING = 260,
-    SWQT_IDENTIFIER = 261,
-    SWQT_IN = 262,
-    SWQT_LIKE = 263,
-    SWQT_ESCAPE = 264,
-    SWQT_BETWEEN = 265,
-    SWQT_NULL = 266,
-    SWQT_IS = 267,
-    SWQT_SELECT = 268,
-    SWQT_LEFT = 269,
-    SWQT_JOIN = 270,
-    SWQT_WHERE = 271,
-    SWQT_ON = 272,
-    SWQT_ORDER = 273,
-    SWQT_BY = 274,
-    SWQT_FROM = 275,
-    SWQT_AS = 276,
-    SWQT_ASC = 277,
-    SWQT_DESC = 278,
-    SWQT_DISTINCT = 279,
-    SWQT_CAST = 280,
-    SWQT_UNION = 281,
-    SWQT_ALL = 282,
-    SWQT_VALUE_START = 283,
-    SWQT_SELECT_START = 284,
-    SWQT_NOT = 285,
-    SWQT_OR = 286,
-    SWQT_AND = 287,
-    SWQT_UMINUS = 288,
-    SWQT_RESERVED_KEYWORD = 289
-  };
-#endif
+#include "swq_parser.hpp"
+/* Symbol kind.  */
+enum yysymbol_kind_t
+{
+  YYSYMBOL_YYEMPTY = -2,
+  YYSYMBOL_YYEOF = 0,                      /* "end of string"  */
+  YYSYMBOL_YYerror = 1,                    /* error  */
+  YYSYMBOL_YYUNDEF = 2,                    /* "invalid token"  */
+  YYSYMBOL_SWQT_INTEGER_NUMBER = 3,        /* "integer number"  */
+  YYSYMBOL_SWQT_FLOAT_NUMBER = 4,          /* "floating point number"  */
+  YYSYMBOL_SWQT_STRING = 5,                /* "string"  */
+  YYSYMBOL_SWQT_IDENTIFIER = 6,            /* "identifier"  */
+  YYSYMBOL_SWQT_IN = 7,                    /* "IN"  */
+  YYSYMBOL_SWQT_LIKE = 8,                  /* "LIKE"  */
+  YYSYMBOL_SWQT_ESCAPE = 9,                /* "ESCAPE"  */
+  YYSYMBOL_SWQT_BETWEEN = 10,              /* "BETWEEN"  */
+  YYSYMBOL_SWQT_NULL = 11,                 /* "NULL"  */
+  YYSYMBOL_SWQT_IS = 12,                   /* "IS"  */
+  YYSYMBOL_SWQT_SELECT = 13,               /* "SELECT"  */
+  YYSYMBOL_SWQT_LEFT = 14,                 /* "LEFT"  */
+  YYSYMBOL_SWQT_JOIN = 15,                 /* "JOIN"  */
+  YYSYMBOL_SWQT_WHERE = 16,                /* "WHERE"  */
+  YYSYMBOL_SWQT_ON = 17,                   /* "ON"  */
+  YYSYMBOL_SWQT_ORDER = 18,                /* "ORDER"  */
+  YYSYMBOL_SWQT_BY = 19,                   /* "BY"  */
+  YYSYMBOL_SWQT_FROM = 20,                 /* "FROM"  */
+  YYSYMBOL_SWQT_AS = 21,                   /* "AS"  */
+  YYSYMBOL_SWQT_ASC = 22,                  /* "ASC"  */
+  YYSYMBOL_SWQT_DESC = 23,                 /* "DESC"  */
+  YYSYMBOL_SWQT_DISTINCT = 24,             /* "DISTINCT"  */
+  YYSYMBOL_SWQT_CAST = 25,                 /* "CAST"  */
+  YYSYMBOL_SWQT_UNION = 26,                /* "UNION"  */
+  YYSYMBOL_SWQT_ALL = 27,                  /* "ALL"  */
+  YYSYMBOL_SWQT_LIMIT = 28,                /* "LIMIT"  */
+  YYSYMBOL_SWQT_GROUP = 29,                /* "GROUP"  */
+  YYSYMBOL_SWQT_OFFSET = 30,               /* "OFFSET"  */
+  YYSYMBOL_SWQT_VALUE_START = 31,          /* SWQT_VALUE_START  */
+  YYSYMBOL_SWQT_SELECT_START = 32,         /* SWQT_SELECT_START  */
+  YYSYMBOL_SWQT_NOT = 33,                  /* "NOT"  */
+  YYSYMBOL_SWQT_OR = 34,                   /* "OR"  */
+  YYSYMBOL_SWQT_AND = 35,                  /* "AND"  */
+  YYSYMBOL_36_ = 36,                       /* '='  */
+  YYSYMBOL_37_ = 37,                       /* '<'  */
+  YYSYMBOL_38_ = 38,                       /* '>'  */
+  YYSYMBOL_39_ = 39,                       /* '!'  */
+  YYSYMBOL_40_ = 40,                       /* '+'  */
+  YYSYMBOL_41_ = 41,                       /* '-'  */
+  YYSYMBOL_42_ = 42,                       /* '*'  */
+  YYSYMBOL_43_ = 43,                       /* '/'  */
+  YYSYMBOL_44_ = 44,                       /* '%'  */
+  YYSYMBOL_SWQT_UMINUS = 45,               /* SWQT_UMINUS  */
+  YYSYMBOL_SWQT_RESERVED_KEYWORD = 46,     /* "reserved keyword"  */
+  YYSYMBOL_47_ = 47,                       /* '('  */
+  YYSYMBOL_48_ = 48,                       /* ')'  */
+  YYSYMBOL_49_ = 49,                       /* ','  */
+  YYSYMBOL_50_ = 50,                       /* '.'  */
+  YYSYMBOL_YYACCEPT = 51,                  /* $accept  */
+  YYSYMBOL_input = 52,                     /* input  */
+  YYSYMBOL_value_expr = 53,                /* value_expr  */
+  YYSYMBOL_value_expr_list = 54,           /* value_expr_list  */
+  YYSYMBOL_field_value = 55,               /* field_value  */
+  YYSYMBOL_value_expr_non_logical = 56,    /* value_expr_non_logical  */
+  YYSYMBOL_type_def = 57,                  /* type_def  */
+  YYSYMBOL_select_statement = 58,          /* select_statement  */
+  YYSYMBOL_select_core = 59,               /* select_core  */
+  YYSYMBOL_opt_union_all = 60,             /* opt_union_all  */
+  YYSYMBOL_union_all = 61,                 /* union_all  */
+  YYSYMBOL_select_field_list = 62,         /* select_field_list  */
+  YYSYMBOL_column_spec = 63,               /* column_spec  */
+  YYSYMBOL_as_clause = 64,                 /* as_clause  */
+  YYSYMBOL_opt_where = 65,                 /* opt_where  */
+  YYSYMBOL_opt_joins = 66,                 /* opt_joins  */
+  YYSYMBOL_opt_group_by = 67,              /* opt_group_by  */
+  YYSYMBOL_group_spec_list = 68,           /* group_spec_list  */
+  YYSYMBOL_group_spec = 69,                /* group_spec  */
+  YYSYMBOL_opt_order_by = 70,              /* opt_order_by  */
+  YYSYMBOL_opt_limit = 71,                 /* opt_limit  */
+  YYSYMBOL_opt_offset = 72,                /* opt_offset  */
+  YYSYMBOL_sort_spec_list = 73,            /* sort_spec_list  */
+  YYSYMBOL_sort_spec = 74,                 /* sort_spec  */
+  YYSYMBOL_table_def = 75                  /* table_def  */
+};
+typedef enum yysymbol_kind_t yysymbol_kind_t;
 
-/* Value type.  */
-#if ! defined YYSTYPE && ! defined YYSTYPE_IS_DECLARED
-typedef int YYSTYPE;
-# define YYSTYPE_IS_TRIVIAL 1
-# define YYSTYPE_IS_DECLARED 1
-#endif
 
 
 
-int swqparse (swq_parse_context *context);
+#ifdef short
+# undef short
+#endif
 
-#endif /* !YY_SWQ_SWQ_PARSER_HPP_INCLUDED  */
+/* On compilers that do not define __PTRDIFF_MAX__ etc., make sure
+   <limits.h> and (if available) <stdint.h> are included
+   so that the code can choose integer types of a good width.  */
 
-/* Copy the second part of user declarations.  */
+#ifndef __PTRDIFF_MAX__
+# include <limits.h> /* INFRINGES ON USER NAME SPACE */
+# if defined __STDC_VERSION__ && 199901 <= __STDC_VERSION__
+#  include <stdint.h> /* INFRINGES ON USER NAME SPACE */
+#  define YY_STDINT_H
+# endif
+#endif
 
-#line 205 "swq_parser.cpp" /* yacc.c:358  */
+/* Narrow types that promote to a signed type and that can represent a
+   signed or unsigned integer of at least N bits.  In tables they can
+   save space and decrease cache pressure.  Promoting to a signed type
+   helps avoid bugs in integer arithmetic.  */
 
-#ifdef short
-# undef short
+#ifdef __INT_LEAST8_MAX__
+typedef __INT_LEAST8_TYPE__ yytype_int8;
+#elif defined YY_STDINT_H
+typedef int_least8_t yytype_int8;
+#else
+typedef signed char yytype_int8;
 #endif
 
-#ifdef YYTYPE_UINT8
-typedef YYTYPE_UINT8 yytype_uint8;
+#ifdef __INT_LEAST16_MAX__
+typedef __INT_LEAST16_TYPE__ yytype_int16;
+#elif defined YY_STDINT_H
+typedef int_least16_t yytype_int16;
 #else
-typedef unsigned char yytype_uint8;
+typedef short yytype_int16;
 #endif
 
-#ifdef YYTYPE_INT8
-typedef YYTYPE_INT8 yytype_int8;
-#else
-typedef signed char yytype_int8;
+/* Work around bug in HP-UX 11.23, which defines these macros
+   incorrectly for preprocessor constants.  This workaround can likely
+   be removed in 2023, as HPE has promised support for HP-UX 11.23
+   (aka HP-UX 11i v2) only through the end of 2022; see Table 2 of
+   <https://h20195.www2.hpe.com/V2/getpdf.aspx/4AA4-7673ENW.pdf>.  */
+#ifdef __hpux
+# undef UINT_LEAST8_MAX
+# undef UINT_LEAST16_MAX
+# define UINT_LEAST8_MAX 255
+# define UINT_LEAST16_MAX 65535
 #endif
 
-#ifdef YYTYPE_UINT16
-typedef YYTYPE_UINT16 yytype_uint16;
+#if defined __UINT_LEAST8_MAX__ && __UINT_LEAST8_MAX__ <= __INT_MAX__
+typedef __UINT_LEAST8_TYPE__ yytype_uint8;
+#elif (!defined __UINT_LEAST8_MAX__ && defined YY_STDINT_H \
+       && UINT_LEAST8_MAX <= INT_MAX)
+typedef uint_least8_t yytype_uint8;
+#elif !defined __UINT_LEAST8_MAX__ && UCHAR_MAX <= INT_MAX
+typedef unsigned char yytype_uint8;
 #else
-typedef unsigned short int yytype_uint16;
+typedef short yytype_uint8;
 #endif
 
-#ifdef YYTYPE_INT16
-typedef YYTYPE_INT16 yytype_int16;
+#if defined __UINT_LEAST16_MAX__ && __UINT_LEAST16_MAX__ <= __INT_MAX__
+typedef __UINT_LEAST16_TYPE__ yytype_uint16;
+#elif (!defined __UINT_LEAST16_MAX__ && defined YY_STDINT_H \
+       && UINT_LEAST16_MAX <= INT_MAX)
+typedef uint_least16_t yytype_uint16;
+#elif !defined __UINT_LEAST16_MAX__ && USHRT_MAX <= INT_MAX
+typedef unsigned short yytype_uint16;
 #else
-typedef short int yytype_int16;
+typedef int yytype_uint16;
+#endif
+
+#ifndef YYPTRDIFF_T
+# if defined __PTRDIFF_TYPE__ && defined __PTRDIFF_MAX__
+#  define YYPTRDIFF_T __PTRDIFF_TYPE__
+#  define YYPTRDIFF_MAXIMUM __PTRDIFF_MAX__
+# elif defined PTRDIFF_MAX
+#  ifndef ptrdiff_t
+#   include <stddef.h> /* INFRINGES ON USER NAME SPACE */
+#  endif
+#  define YYPTRDIFF_T ptrdiff_t
+#  define YYPTRDIFF_MAXIMUM PTRDIFF_MAX
+# else
+#  define YYPTRDIFF_T long
+#  define YYPTRDIFF_MAXIMUM LONG_MAX
+# endif
 #endif
 
 #ifndef YYSIZE_T
@@ -237,15 +321,28 @@ typedef short int yytype_int16;
 #  define YYSIZE_T __SIZE_TYPE__
 # elif defined size_t
 #  define YYSIZE_T size_t
-# elif ! defined YYSIZE_T
+# elif defined __STDC_VERSION__ && 199901 <= __STDC_VERSION__
 #  include <stddef.h> /* INFRINGES ON USER NAME SPACE */
 #  define YYSIZE_T size_t
 # else
-#  define YYSIZE_T unsigned int
+#  define YYSIZE_T unsigned
 # endif
 #endif
 
-#define YYSIZE_MAXIMUM ((YYSIZE_T) -1)
+#define YYSIZE_MAXIMUM                                  \
+  YY_CAST (YYPTRDIFF_T,                                 \
+           (YYPTRDIFF_MAXIMUM < YY_CAST (YYSIZE_T, -1)  \
+            ? YYPTRDIFF_MAXIMUM                         \
+            : YY_CAST (YYSIZE_T, -1)))
+
+#define YYSIZEOF(X) YY_CAST (YYPTRDIFF_T, sizeof (X))
+
+
+/* Stored state numbers (used for stacks). */
+typedef yytype_uint8 yy_state_t;
+
+/* State numbers in computations.  */
+typedef int yy_state_fast_t;
 
 #ifndef YY_
 # if defined YYENABLE_NLS && YYENABLE_NLS
@@ -259,28 +356,43 @@ typedef short int yytype_int16;
 # endif
 #endif
 
-#ifndef __attribute__
-/* This feature is available in gcc versions 2.5 and later.  */
-# if (! defined __GNUC__ || __GNUC__ < 2 \
-      || (__GNUC__ == 2 && __GNUC_MINOR__ < 5))
-#  define __attribute__(Spec) /* empty */
+
+#ifndef YY_ATTRIBUTE_PURE
+# if defined __GNUC__ && 2 < __GNUC__ + (96 <= __GNUC_MINOR__)
+#  define YY_ATTRIBUTE_PURE __attribute__ ((__pure__))
+# else
+#  define YY_ATTRIBUTE_PURE
+# endif
+#endif
+
+#ifndef YY_ATTRIBUTE_UNUSED
+# if defined __GNUC__ && 2 < __GNUC__ + (7 <= __GNUC_MINOR__)
+#  define YY_ATTRIBUTE_UNUSED __attribute__ ((__unused__))
+# else
+#  define YY_ATTRIBUTE_UNUSED
 # endif
 #endif
 
 /* Suppress unused-variable warnings by "using" E.  */
 #if ! defined lint || defined __GNUC__
-# define YYUSE(E) ((void) (E))
+# define YY_USE(E) ((void) (E))
 #else
-# define YYUSE(E) /* empty */
+# define YY_USE(E) /* empty */
 #endif
 
-#if defined __GNUC__ && 407 <= __GNUC__ * 100 + __GNUC_MINOR__
 /* Suppress an incorrect diagnostic about yylval being uninitialized.  */
-# define YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN \
-    _Pragma ("GCC diagnostic push") \
-    _Pragma ("GCC diagnostic ignored \"-Wuninitialized\"")\
+#if defined __GNUC__ && ! defined __ICC && 406 <= __GNUC__ * 100 + __GNUC_MINOR__
+# if __GNUC__ * 100 + __GNUC_MINOR__ < 407
+#  define YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN                           \
+    _Pragma ("GCC diagnostic push")                                     \
+    _Pragma ("GCC diagnostic ignored \"-Wuninitialized\"")
+# else
+#  define YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN                           \
+    _Pragma ("GCC diagnostic push")                                     \
+    _Pragma ("GCC diagnostic ignored \"-Wuninitialized\"")              \
     _Pragma ("GCC diagnostic ignored \"-Wmaybe-uninitialized\"")
-# define YY_IGNORE_MAYBE_UNINITIALIZED_END \
+# endif
+# define YY_IGNORE_MAYBE_UNINITIALIZED_END      \
     _Pragma ("GCC diagnostic pop")
 #else
 # define YY_INITIAL_VALUE(Value) Value
@@ -293,8 +405,22 @@ typedef short int yytype_int16;
 # define YY_INITIAL_VALUE(Value) /* Nothing. */
 #endif
 
+#if defined __cplusplus && defined __GNUC__ && ! defined __ICC && 6 <= __GNUC__
+# define YY_IGNORE_USELESS_CAST_BEGIN                          \
+    _Pragma ("GCC diagnostic push")                            \
+    _Pragma ("GCC diagnostic ignored \"-Wuseless-cast\"")
+# define YY_IGNORE_USELESS_CAST_END            \
+    _Pragma ("GCC diagnostic pop")
+#endif
+#ifndef YY_IGNORE_USELESS_CAST_BEGIN
+# define YY_IGNORE_USELESS_CAST_BEGIN
+# define YY_IGNORE_USELESS_CAST_END
+#endif
+
+
+#define YY_ASSERT(E) ((void) (0 && (E)))
 
-#if ! defined yyoverflow || YYERROR_VERBOSE
+#if 1
 
 /* The parser invokes alloca or malloc; define the necessary symbols.  */
 
@@ -359,8 +485,7 @@ void free (void *); /* INFRINGES ON USER NAME SPACE */
 #   endif
 #  endif
 # endif
-#endif /* ! defined yyoverflow || YYERROR_VERBOSE */
-
+#endif /* 1 */
 
 #if (! defined yyoverflow \
      && (! defined __cplusplus \
@@ -369,17 +494,17 @@ void free (void *); /* INFRINGES ON USER NAME SPACE */
 /* A type that is properly aligned for any stack member.  */
 union yyalloc
 {
-  yytype_int16 yyss_alloc;
+  yy_state_t yyss_alloc;
   YYSTYPE yyvs_alloc;
 };
 
 /* The size of the maximum gap between one aligned stack and the next.  */
-# define YYSTACK_GAP_MAXIMUM (sizeof (union yyalloc) - 1)
+# define YYSTACK_GAP_MAXIMUM (YYSIZEOF (union yyalloc) - 1)
 
 /* The size of an array large to enough to hold all stacks, each with
    N elements.  */
 # define YYSTACK_BYTES(N) \
-     ((N) * (sizeof (yytype_int16) + sizeof (YYSTYPE)) \
+     ((N) * (YYSIZEOF (yy_state_t) + YYSIZEOF (YYSTYPE)) \
       + YYSTACK_GAP_MAXIMUM)
 
 # define YYCOPY_NEEDED 1
@@ -392,11 +517,11 @@ union yyalloc
 # define YYSTACK_RELOCATE(Stack_alloc, Stack)                           \
     do                                                                  \
       {                                                                 \
-        YYSIZE_T yynewbytes;                                            \
+        YYPTRDIFF_T yynewbytes;                                         \
         YYCOPY (&yyptr->Stack_alloc, Stack, yysize);                    \
         Stack = &yyptr->Stack_alloc;                                    \
-        yynewbytes = yystacksize * sizeof (*Stack) + YYSTACK_GAP_MAXIMUM; \
-        yyptr += yynewbytes / sizeof (*yyptr);                          \
+        yynewbytes = yystacksize * YYSIZEOF (*Stack) + YYSTACK_GAP_MAXIMUM; \
+        yyptr += yynewbytes / YYSIZEOF (*yyptr);                        \
       }                                                                 \
     while (0)
 
@@ -408,12 +533,12 @@ union yyalloc
 # ifndef YYCOPY
 #  if defined __GNUC__ && 1 < __GNUC__
 #   define YYCOPY(Dst, Src, Count) \
-      __builtin_memcpy (Dst, Src, (Count) * sizeof (*(Src)))
+      __builtin_memcpy (Dst, Src, YY_CAST (YYSIZE_T, (Count)) * sizeof (*(Src)))
 #  else
 #   define YYCOPY(Dst, Src, Count)              \
       do                                        \
         {                                       \
-          YYSIZE_T yyi;                         \
+          YYPTRDIFF_T yyi;                      \
           for (yyi = 0; yyi < (Count); yyi++)   \
             (Dst)[yyi] = (Src)[yyi];            \
         }                                       \
@@ -425,36 +550,39 @@ union yyalloc
 /* YYFINAL -- State number of the termination state.  */
 #define YYFINAL  20
 /* YYLAST -- Last index in YYTABLE.  */
-#define YYLAST   416
+#define YYLAST   390
 
 /* YYNTOKENS -- Number of terminals.  */
-#define YYNTOKENS  48
+#define YYNTOKENS  51
 /* YYNNTS -- Number of nonterminals.  */
-#define YYNNTS  20
+#define YYNNTS  25
 /* YYNRULES -- Number of rules.  */
-#define YYNRULES  87
+#define YYNRULES  96
 /* YYNSTATES -- Number of states.  */
-#define YYNSTATES  185
+#define YYNSTATES  201
+
+/* YYMAXUTOK -- Last valid token kind.  */
+#define YYMAXUTOK   292
 
-/* YYTRANSLATE[YYX] -- Symbol number corresponding to YYX as returned
-   by yylex, with out-of-bounds checking.  */
-#define YYUNDEFTOK  2
-#define YYMAXUTOK   289
 
-#define YYTRANSLATE(YYX)                                                \
-  ((unsigned int) (YYX) <= YYMAXUTOK ? yytranslate[YYX] : YYUNDEFTOK)
+/* YYTRANSLATE(TOKEN-NUM) -- Symbol number corresponding to TOKEN-NUM
+   as returned by yylex, with out-of-bounds checking.  */
+#define YYTRANSLATE(YYX)                                \
+  (0 <= (YYX) && (YYX) <= YYMAXUTOK                     \
+   ? YY_CAST (yysymbol_kind_t, yytranslate[YYX])        \
+   : YYSYMBOL_YYUNDEF)
 
 /* YYTRANSLATE[TOKEN-NUM] -- Symbol number corresponding to TOKEN-NUM
-   as returned by yylex, without out-of-bounds checking.  */
-static const yytype_uint8 yytranslate[] =
+   as returned by yylex.  */
+static const yytype_int8 yytranslate[] =
 {
        0,     2,     2,     2,     2,     2,     2,     2,     2,     2,
        2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
        2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
-       2,     2,     2,    36,     2,     2,     2,    41,     2,     2,
-      44,    45,    39,    37,    46,    38,    47,    40,     2,     2,
+       2,     2,     2,    39,     2,     2,     2,    44,     2,     2,
+      47,    48,    42,    40,    49,    41,    50,    43,     2,     2,
        2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
-      34,    33,    35,     2,     2,     2,     2,     2,     2,     2,
+      37,    36,    38,     2,     2,     2,     2,     2,     2,     2,
        2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
        2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
        2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
@@ -476,99 +604,104 @@ static const yytype_uint8 yytranslate[] =
        2,     2,     2,     2,     2,     2,     1,     2,     3,     4,
        5,     6,     7,     8,     9,    10,    11,    12,    13,    14,
       15,    16,    17,    18,    19,    20,    21,    22,    23,    24,
-      25,    26,    27,    28,    29,    30,    31,    32,    42,    43
+      25,    26,    27,    28,    29,    30,    31,    32,    33,    34,
+      35,    45,    46
 };
 
 #if YYDEBUG
-  /* YYRLINE[YYN] -- Source line where rule number YYN was defined.  */
-static const yytype_uint16 yyrline[] =
+/* YYRLINE[YYN] -- Source line where rule number YYN was defined.  */
+static const yytype_int16 yyrline[] =
 {
-       0,   112,   112,   113,   118,   124,   129,   137,   145,   152,
-     160,   168,   176,   184,   192,   200,   208,   216,   224,   232,
-     245,   254,   268,   277,   292,   301,   315,   322,   336,   342,
-     349,   356,   368,   373,   378,   382,   387,   392,   397,   413,
-     420,   427,   434,   441,   448,   484,   492,   498,   505,   514,
-     532,   552,   553,   556,   561,   567,   568,   570,   578,   579,
-     582,   591,   602,   616,   638,   668,   702,   726,   755,   761,
-     764,   765,   770,   771,   777,   784,   785,   788,   789,   792,
-     798,   804,   812,   822,   833,   844,   857,   868
+       0,   115,   115,   116,   121,   127,   132,   140,   148,   155,
+     163,   171,   179,   187,   195,   203,   211,   219,   227,   235,
+     248,   257,   271,   280,   295,   304,   318,   325,   339,   345,
+     352,   359,   371,   376,   381,   385,   390,   395,   400,   416,
+     423,   430,   437,   444,   451,   487,   495,   501,   508,   517,
+     535,   555,   556,   559,   564,   570,   571,   573,   581,   582,
+     585,   594,   605,   619,   641,   671,   705,   729,   758,   764,
+     767,   768,   773,   774,   780,   787,   788,   791,   792,   795,
+     802,   803,   805,   806,   813,   814,   822,   823,   826,   832,
+     838,   846,   856,   867,   878,   891,   902
 };
 #endif
 
-#if YYDEBUG || YYERROR_VERBOSE || 1
+/** Accessing symbol of state STATE.  */
+#define YY_ACCESSING_SYMBOL(State) YY_CAST (yysymbol_kind_t, yystos[State])
+
+#if 1
+/* The user-facing name of the symbol whose (internal) number is
+   YYSYMBOL.  No bounds checking.  */
+static const char *yysymbol_name (yysymbol_kind_t yysymbol) YY_ATTRIBUTE_UNUSED;
+
 /* YYTNAME[SYMBOL-NUM] -- String name of the symbol SYMBOL-NUM.
    First, the terminals, then, starting at YYNTOKENS, nonterminals.  */
 static const char *const yytname[] =
 {
-  "\"end of string\"", "error", "$undefined", "\"integer number\"",
+  "\"end of string\"", "error", "\"invalid token\"", "\"integer number\"",
   "\"floating point number\"", "\"string\"", "\"identifier\"", "\"IN\"",
   "\"LIKE\"", "\"ESCAPE\"", "\"BETWEEN\"", "\"NULL\"", "\"IS\"",
   "\"SELECT\"", "\"LEFT\"", "\"JOIN\"", "\"WHERE\"", "\"ON\"", "\"ORDER\"",
   "\"BY\"", "\"FROM\"", "\"AS\"", "\"ASC\"", "\"DESC\"", "\"DISTINCT\"",
-  "\"CAST\"", "\"UNION\"", "\"ALL\"", "SWQT_VALUE_START",
-  "SWQT_SELECT_START", "\"NOT\"", "\"OR\"", "\"AND\"", "'='", "'<'", "'>'",
-  "'!'", "'+'", "'-'", "'*'", "'/'", "'%'", "SWQT_UMINUS",
-  "\"reserved keyword\"", "'('", "')'", "','", "'.'", "$accept", "input",
-  "value_expr", "value_expr_list", "field_value", "value_expr_non_logical",
-  "type_def", "select_statement", "select_core", "opt_union_all",
-  "union_all", "select_field_list", "column_spec", "as_clause",
-  "opt_where", "opt_joins", "opt_order_by", "sort_spec_list", "sort_spec",
-  "table_def", YY_NULL
+  "\"CAST\"", "\"UNION\"", "\"ALL\"", "\"LIMIT\"", "\"GROUP\"",
+  "\"OFFSET\"", "SWQT_VALUE_START", "SWQT_SELECT_START", "\"NOT\"",
+  "\"OR\"", "\"AND\"", "'='", "'<'", "'>'", "'!'", "'+'", "'-'", "'*'",
+  "'/'", "'%'", "SWQT_UMINUS", "\"reserved keyword\"", "'('", "')'", "','",
+  "'.'", "$accept", "input", "value_expr", "value_expr_list",
+  "field_value", "value_expr_non_logical", "type_def", "select_statement",
+  "select_core", "opt_union_all", "union_all", "select_field_list",
+  "column_spec", "as_clause", "opt_where", "opt_joins", "opt_group_by",
+  "group_spec_list", "group_spec", "opt_order_by", "opt_limit",
+  "opt_offset", "sort_spec_list", "sort_spec", "table_def", YY_NULLPTR
 };
-#endif
 
-# ifdef YYPRINT
-/* YYTOKNUM[NUM] -- (External) token number corresponding to the
-   (internal) symbol number NUM (which must be that of a token).  */
-static const yytype_uint16 yytoknum[] =
+static const char *
+yysymbol_name (yysymbol_kind_t yysymbol)
 {
-       0,   256,   257,   258,   259,   260,   261,   262,   263,   264,
-     265,   266,   267,   268,   269,   270,   271,   272,   273,   274,
-     275,   276,   277,   278,   279,   280,   281,   282,   283,   284,
-     285,   286,   287,    61,    60,    62,    33,    43,    45,    42,
-      47,    37,   288,   289,    40,    41,    44,    46
-};
-# endif
+  return yytname[yysymbol];
+}
+#endif
 
-#define YYPACT_NINF -119
+#define YYPACT_NINF (-126)
 
-#define yypact_value_is_default(Yystate) \
-  (!!((Yystate) == (-119)))
+#define yypact_value_is_default(Yyn) \
+  ((Yyn) == YYPACT_NINF)
 
-#define YYTABLE_NINF -1
+#define YYTABLE_NINF (-1)
 
-#define yytable_value_is_error(Yytable_value) \
+#define yytable_value_is_error(Yyn) \
   0
 
-  /* YYPACT[STATE-NUM] -- Index in YYTABLE of the portion describing
-     STATE-NUM.  */
+/* YYPACT[STATE-NUM] -- Index in YYTABLE of the portion describing
+   STATE-NUM.  */
 static const yytype_int16 yypact[] =
 {
-      -9,   204,    -6,    10,  -119,  -119,  -119,   -30,  -119,   -32,
-     204,   240,   204,   342,  -119,   356,    54,    12,  -119,     4,
-    -119,   204,    35,   204,   380,  -119,   263,    18,   204,   240,
-      50,    87,   204,   204,    97,   112,   158,    33,   240,   240,
-     240,   240,   240,   -23,   194,  -119,   297,    36,    28,    31,
-      56,  -119,    -6,   256,    42,  -119,   335,  -119,   204,    82,
-      72,  -119,    70,    55,   204,   240,   247,   350,   204,   204,
-    -119,   204,   204,  -119,   204,  -119,   204,    80,    80,  -119,
-    -119,  -119,   148,     0,    94,  -119,   118,  -119,    47,   194,
-       4,  -119,  -119,   204,  -119,   120,    85,   204,   240,  -119,
-     204,   124,   284,  -119,  -119,  -119,  -119,  -119,  -119,   130,
-      95,  -119,    47,  -119,    96,    -5,    75,  -119,  -119,  -119,
-     100,   101,  -119,  -119,   356,   103,   204,   240,   108,   115,
-       2,    75,   151,   159,  -119,   153,    47,   150,    23,  -119,
-    -119,  -119,   356,     2,  -119,   150,     2,     2,    47,   154,
-     204,   152,    61,    83,  -119,   152,  -119,  -119,   157,   204,
-     342,   156,  -119,  -119,   173,  -119,   174,  -119,   204,   305,
-     130,   134,   135,   305,  -119,   116,  -119,   136,  -119,  -119,
-    -119,  -119,  -119,   130,  -119
+      22,   199,    -6,     3,  -126,  -126,  -126,   -37,  -126,   -35,
+     199,   211,   199,   318,  -126,   291,    53,    13,  -126,     4,
+    -126,   199,    34,   199,   351,  -126,   249,   -19,   199,   211,
+       6,    82,   199,   199,    76,   115,   165,    30,   211,   211,
+     211,   211,   211,   -31,   188,  -126,   269,    49,    -7,    26,
+      66,  -126,    -6,   231,    56,  -126,   303,  -126,   199,    97,
+      87,  -126,   113,    64,   199,   211,   100,   336,   199,   199,
+    -126,   199,   199,  -126,   199,  -126,   199,    55,    55,  -126,
+    -126,  -126,   139,    -4,   112,  -126,   135,  -126,    79,   188,
+       4,  -126,  -126,   199,  -126,   141,   104,   199,   211,  -126,
+     199,   148,   207,  -126,  -126,  -126,  -126,  -126,  -126,   153,
+     117,  -126,    79,  -126,   110,     2,    46,  -126,  -126,  -126,
+     119,   125,  -126,  -126,   291,   127,   199,   211,   129,   134,
+       8,    46,   177,   178,  -126,   170,    79,   171,    18,  -126,
+    -126,  -126,   291,     8,  -126,   171,     8,     8,    79,   172,
+     199,   159,    54,    67,  -126,   159,  -126,  -126,   179,   199,
+     318,   176,   182,  -126,   194,  -126,   204,   182,   199,   284,
+     153,   189,   181,   163,   175,   181,   284,  -126,  -126,  -126,
+     169,   153,   216,  -126,  -126,  -126,  -126,  -126,   153,   132,
+    -126,   184,   190,  -126,  -126,  -126,   153,   222,  -126,  -126,
+    -126
 };
 
-  /* YYDEFACT[STATE-NUM] -- Default reduction number in state STATE-NUM.
-     Performed when YYTABLE does not specify something else to do.  Zero
-     means the default is an error.  */
-static const yytype_uint8 yydefact[] =
+/* YYDEFACT[STATE-NUM] -- Default reduction number in state STATE-NUM.
+   Performed when YYTABLE does not specify something else to do.  Zero
+   means the default is an error.  */
+static const yytype_int8 yydefact[] =
 {
        2,     0,     0,     0,    32,    33,    34,    30,    37,     0,
        0,     0,     0,     3,    35,     5,     0,     0,     4,    55,
@@ -581,212 +714,216 @@ static const yytype_uint8 yydefact[] =
       42,    43,     0,     0,     0,    69,     0,    61,     0,     0,
       55,    57,    56,     0,    44,     0,     0,     0,     0,    27,
        0,    19,     0,    15,    16,    14,    10,    17,    11,     0,
-       0,    63,     0,    68,     0,    82,    72,    59,    52,    28,
+       0,    63,     0,    68,     0,    91,    72,    59,    52,    28,
       46,     0,    22,    20,    24,     0,     0,     0,    30,     0,
-      64,    72,     0,     0,    83,     0,     0,    70,     0,    45,
-      23,    21,    25,    66,    65,    70,    84,    86,     0,     0,
-       0,    75,     0,     0,    67,    75,    85,    87,     0,     0,
-      71,     0,    53,    47,     0,    49,     0,    54,     0,    72,
-       0,     0,     0,    72,    73,    79,    76,    78,    48,    50,
-      74,    80,    81,     0,    77
+      64,    72,     0,     0,    92,     0,     0,    70,     0,    45,
+      23,    21,    25,    66,    65,    70,    93,    95,     0,     0,
+       0,    75,     0,     0,    67,    75,    94,    96,     0,     0,
+      71,     0,    80,    47,     0,    49,     0,    80,     0,    72,
+       0,     0,    82,     0,     0,    82,    72,    73,    79,    76,
+      78,     0,     0,    53,    48,    50,    54,    74,     0,    88,
+      81,    87,    84,    77,    89,    90,     0,     0,    83,    86,
+      85
 };
 
-  /* YYPGOTO[NTERM-NUM].  */
+/* YYPGOTO[NTERM-NUM].  */
 static const yytype_int16 yypgoto[] =
 {
-    -119,  -119,    -1,   -56,  -106,     7,  -119,   129,   167,    99,
-    -119,   -39,  -119,   -61,    40,  -118,    38,    11,  -119,  -108
+    -126,  -126,    -1,   -38,  -105,     7,  -126,   174,   210,   138,
+    -126,   -39,  -126,    31,    86,  -125,    89,    57,  -126,    70,
+      59,  -126,    58,  -126,  -111
 };
 
-  /* YYDEFGOTO[NTERM-NUM].  */
-static const yytype_int16 yydefgoto[] =
+/* YYDEFGOTO[NTERM-NUM].  */
+static const yytype_uint8 yydefgoto[] =
 {
-      -1,     3,    53,    54,    14,    15,   121,    18,    19,    51,
-      52,    47,    48,    87,   151,   137,   162,   176,   177,   116
+       0,     3,    53,    54,    14,    15,   121,    18,    19,    51,
+      52,    47,    48,    87,   151,   137,   162,   179,   180,   172,
+     183,   198,   190,   191,   116
 };
 
-  /* YYTABLE[YYPACT[STATE-NUM]] -- What to do in state STATE-NUM.  If
-     positive, shift that token.  If negative, reduce the rule whose
-     number is the opposite.  If YYTABLE_NINF, syntax error.  */
+/* YYTABLE[YYPACT[STATE-NUM]] -- What to do in state STATE-NUM.  If
+   positive, shift that token.  If negative, reduce the rule whose
+   number is the opposite.  If YYTABLE_NINF, syntax error.  */
 static const yytype_uint8 yytable[] =
 {
-      13,    85,    96,   129,   131,    84,    55,    16,    85,    24,
-      20,    26,    23,   145,    21,    46,    86,    22,    25,     1,
-       2,    82,    56,    86,    83,    16,   152,    59,   149,   153,
-      50,    66,    67,    70,    73,    75,    60,   119,    17,   111,
-     158,    55,   133,    46,   125,    77,    78,    79,    80,    81,
-     117,   174,   114,   115,   134,   180,    88,     4,     5,     6,
-      43,    61,    58,   101,   175,     8,    76,   103,   104,   144,
-     105,   106,   102,   107,    89,   108,    90,   175,    44,     9,
-      62,    99,   154,    91,    10,   156,   157,    94,    46,   135,
-     136,    97,    11,    45,    63,    64,   123,    65,    12,   100,
-       4,     5,     6,     7,    98,   124,   163,   164,     8,    38,
-      39,    40,    41,    42,   112,     4,     5,     6,     7,    40,
-      41,    42,     9,     8,   113,   141,   120,    10,   165,   166,
-     122,    68,    69,   126,   142,    11,   128,     9,   181,   182,
-     130,    12,    10,   132,   138,    71,   139,    72,   140,   160,
-      11,     4,     5,     6,     7,    22,    12,   146,   169,     8,
-     143,     4,     5,     6,     7,   147,   150,   173,   148,     8,
-     161,   159,   109,     9,   168,   170,   171,   172,    10,   178,
-     179,    92,   183,     9,    49,   155,    11,   110,    10,   118,
-       0,    74,    12,   167,   184,     0,    11,     4,     5,     6,
-      43,     0,    12,     0,     0,     8,     0,     4,     5,     6,
-       7,     0,     0,     0,     0,     8,     0,     0,     0,     9,
-       0,     0,     0,     0,    10,     0,     0,     0,     0,     9,
-       0,     0,    11,    45,    10,     0,     0,     0,    12,     0,
-       0,     0,    11,     4,     5,     6,     7,     0,    12,     0,
-       0,     8,     0,     0,    27,    28,     0,    29,     0,    30,
-       0,     0,     0,    27,    28,     9,    29,     0,    30,     0,
-      27,    28,     0,    29,     0,    30,     0,    31,    11,    33,
-      34,    35,    36,    37,    12,     0,    31,    32,    33,    34,
-      35,    36,    37,    31,    32,    33,    34,    35,    36,    37,
-       0,     0,    93,    85,    27,    28,     0,    29,    57,    30,
-       0,     0,    27,    28,     0,    29,   127,    30,    86,   135,
-     136,    38,    39,    40,    41,    42,     0,    31,    32,    33,
-      34,    35,    36,    37,     0,    31,    32,    33,    34,    35,
-      36,    37,    27,    28,     0,    29,     0,    30,     0,    27,
-      28,     0,    29,     0,    30,     0,    95,    27,    28,     0,
-      29,     0,    30,     0,     0,    31,    32,    33,    34,    35,
-      36,    37,    31,    32,    33,    34,    35,    36,    37,     0,
-      31,     0,     0,    34,    35,    36,    37,    27,    28,     0,
-      29,     0,    30,    38,    39,    40,    41,    42,     0,     0,
-       0,     0,     0,     0,     0,     0,     0,     0,     0,     0,
-       0,     0,     0,    34,    35,    36,    37
+      13,   131,    55,    20,   129,    84,   145,    16,    85,    24,
+      21,    26,    23,    22,    85,    46,    82,    61,    25,    83,
+      96,   152,    56,    86,   153,   149,    16,    59,    58,    86,
+      50,    66,    67,    70,    73,    75,    60,   158,   111,    62,
+      55,    17,    89,    46,   177,    77,    78,    79,    80,    81,
+     117,   187,   133,     1,     2,   119,     4,     5,     6,    43,
+     135,   136,   125,   101,     8,   178,    76,   103,   104,    88,
+     105,   106,   102,   107,    90,   108,   189,    44,     9,     4,
+       5,     6,     7,   178,   114,   115,    10,     8,    46,    63,
+      64,   189,    65,    91,    11,    45,   123,    40,    41,    42,
+      12,     9,   163,   164,    94,   124,    97,    27,    28,    10,
+      29,   100,    30,    68,    69,   165,   166,    11,     4,     5,
+       6,     7,    98,    12,    99,   141,     8,    38,    39,    40,
+      41,    42,   112,    31,   142,    33,    34,    35,    36,    37,
+       9,   113,     4,     5,     6,     7,   134,   120,    10,   160,
+       8,    71,   122,    72,   194,   195,    11,   126,   169,   128,
+     132,   144,    12,   109,     9,   130,   138,   176,     4,     5,
+       6,     7,    10,   139,   154,   140,     8,   156,   157,    22,
+      11,   110,   143,   146,   147,   148,    12,   150,   161,   159,
+       9,     4,     5,     6,    43,   170,   168,   173,    10,     8,
+     171,    74,     4,     5,     6,     7,    11,   174,   181,   182,
+       8,   184,    12,     9,     4,     5,     6,     7,   188,   192,
+     197,    10,     8,   185,     9,   200,    92,    49,   118,    11,
+      45,   155,    10,   196,   186,    12,     9,   175,    27,    28,
+      11,    29,   127,    30,   167,   193,    12,    38,    39,    40,
+      41,    42,    11,     0,   199,     0,    27,    28,    12,    29,
+       0,    30,     0,     0,    31,    32,    33,    34,    35,    36,
+      37,     0,     0,     0,     0,    85,    27,    28,     0,    29,
+      93,    30,    31,    32,    33,    34,    35,    36,    37,     0,
+      86,    27,    28,     0,    29,     0,    30,    57,   135,   136,
+       0,     0,    31,    32,    33,    34,    35,    36,    37,     0,
+      27,    28,     0,    29,     0,    30,     0,    31,    32,    33,
+      34,    35,    36,    37,    95,    27,    28,     0,    29,     0,
+      30,    38,    39,    40,    41,    42,    31,    32,    33,    34,
+      35,    36,    37,    27,    28,     0,    29,     0,    30,     0,
+       0,    31,    32,    33,    34,    35,    36,    37,    27,    28,
+       0,    29,     0,    30,     0,     0,     0,     0,     0,    31,
+       0,     0,    34,    35,    36,    37,     0,     0,     0,     0,
+       0,     0,     0,     0,     0,     0,     0,    34,    35,    36,
+      37
 };
 
 static const yytype_int16 yycheck[] =
 {
-       1,     6,    58,   109,   112,    44,     6,    13,     6,    10,
-       0,    12,    44,   131,    44,    16,    21,    47,    11,    28,
-      29,    44,    23,    21,    47,    13,     3,    28,   136,     6,
-      26,    32,    33,    34,    35,    36,    29,    93,    44,    39,
-     148,     6,    47,    44,   100,    38,    39,    40,    41,    42,
-      89,   169,     5,     6,   115,   173,    20,     3,     4,     5,
-       6,    11,    44,    64,   170,    11,    33,    68,    69,   130,
-      71,    72,    65,    74,    46,    76,    45,   183,    24,    25,
-      30,    11,   143,    27,    30,   146,   147,    45,    89,    14,
-      15,     9,    38,    39,     7,     8,    97,    10,    44,    44,
-       3,     4,     5,     6,    32,    98,    45,    46,    11,    37,
-      38,    39,    40,    41,    20,     3,     4,     5,     6,    39,
-      40,    41,    25,    11,     6,   126,     6,    30,    45,    46,
-      45,    34,    35,     9,   127,    38,     6,    25,    22,    23,
-      45,    44,    30,    47,    44,    33,    45,    35,    45,   150,
-      38,     3,     4,     5,     6,    47,    44,     6,   159,    11,
-      45,     3,     4,     5,     6,     6,    16,   168,    15,    11,
-      18,    17,    24,    25,    17,    19,     3,     3,    30,    45,
-      45,    52,    46,    25,    17,   145,    38,    39,    30,    90,
-      -1,    33,    44,   155,   183,    -1,    38,     3,     4,     5,
-       6,    -1,    44,    -1,    -1,    11,    -1,     3,     4,     5,
-       6,    -1,    -1,    -1,    -1,    11,    -1,    -1,    -1,    25,
-      -1,    -1,    -1,    -1,    30,    -1,    -1,    -1,    -1,    25,
-      -1,    -1,    38,    39,    30,    -1,    -1,    -1,    44,    -1,
-      -1,    -1,    38,     3,     4,     5,     6,    -1,    44,    -1,
-      -1,    11,    -1,    -1,     7,     8,    -1,    10,    -1,    12,
-      -1,    -1,    -1,     7,     8,    25,    10,    -1,    12,    -1,
-       7,     8,    -1,    10,    -1,    12,    -1,    30,    38,    32,
-      33,    34,    35,    36,    44,    -1,    30,    31,    32,    33,
-      34,    35,    36,    30,    31,    32,    33,    34,    35,    36,
-      -1,    -1,    46,     6,     7,     8,    -1,    10,    45,    12,
-      -1,    -1,     7,     8,    -1,    10,    32,    12,    21,    14,
-      15,    37,    38,    39,    40,    41,    -1,    30,    31,    32,
-      33,    34,    35,    36,    -1,    30,    31,    32,    33,    34,
-      35,    36,     7,     8,    -1,    10,    -1,    12,    -1,     7,
-       8,    -1,    10,    -1,    12,    -1,    21,     7,     8,    -1,
-      10,    -1,    12,    -1,    -1,    30,    31,    32,    33,    34,
-      35,    36,    30,    31,    32,    33,    34,    35,    36,    -1,
-      30,    -1,    -1,    33,    34,    35,    36,     7,     8,    -1,
-      10,    -1,    12,    37,    38,    39,    40,    41,    -1,    -1,
-      -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,
-      -1,    -1,    -1,    33,    34,    35,    36
+       1,   112,     6,     0,   109,    44,   131,    13,     6,    10,
+      47,    12,    47,    50,     6,    16,    47,    11,    11,    50,
+      58,     3,    23,    21,     6,   136,    13,    28,    47,    21,
+      26,    32,    33,    34,    35,    36,    29,   148,    42,    33,
+       6,    47,    49,    44,   169,    38,    39,    40,    41,    42,
+      89,   176,    50,    31,    32,    93,     3,     4,     5,     6,
+      14,    15,   100,    64,    11,   170,    36,    68,    69,    20,
+      71,    72,    65,    74,    48,    76,   181,    24,    25,     3,
+       4,     5,     6,   188,     5,     6,    33,    11,    89,     7,
+       8,   196,    10,    27,    41,    42,    97,    42,    43,    44,
+      47,    25,    48,    49,    48,    98,     9,     7,     8,    33,
+      10,    47,    12,    37,    38,    48,    49,    41,     3,     4,
+       5,     6,    35,    47,    11,   126,    11,    40,    41,    42,
+      43,    44,    20,    33,   127,    35,    36,    37,    38,    39,
+      25,     6,     3,     4,     5,     6,   115,     6,    33,   150,
+      11,    36,    48,    38,    22,    23,    41,     9,   159,     6,
+      50,   130,    47,    24,    25,    48,    47,   168,     3,     4,
+       5,     6,    33,    48,   143,    48,    11,   146,   147,    50,
+      41,    42,    48,     6,     6,    15,    47,    16,    29,    17,
+      25,     3,     4,     5,     6,    19,    17,     3,    33,    11,
+      18,    36,     3,     4,     5,     6,    41,     3,    19,    28,
+      11,    48,    47,    25,     3,     4,     5,     6,    49,     3,
+      30,    33,    11,    48,    25,     3,    52,    17,    90,    41,
+      42,   145,    33,    49,   175,    47,    25,   167,     7,     8,
+      41,    10,    35,    12,   155,   188,    47,    40,    41,    42,
+      43,    44,    41,    -1,   196,    -1,     7,     8,    47,    10,
+      -1,    12,    -1,    -1,    33,    34,    35,    36,    37,    38,
+      39,    -1,    -1,    -1,    -1,     6,     7,     8,    -1,    10,
+      49,    12,    33,    34,    35,    36,    37,    38,    39,    -1,
+      21,     7,     8,    -1,    10,    -1,    12,    48,    14,    15,
+      -1,    -1,    33,    34,    35,    36,    37,    38,    39,    -1,
+       7,     8,    -1,    10,    -1,    12,    -1,    33,    34,    35,
+      36,    37,    38,    39,    21,     7,     8,    -1,    10,    -1,
+      12,    40,    41,    42,    43,    44,    33,    34,    35,    36,
+      37,    38,    39,     7,     8,    -1,    10,    -1,    12,    -1,
+      -1,    33,    34,    35,    36,    37,    38,    39,     7,     8,
+      -1,    10,    -1,    12,    -1,    -1,    -1,    -1,    -1,    33,
+      -1,    -1,    36,    37,    38,    39,    -1,    -1,    -1,    -1,
+      -1,    -1,    -1,    -1,    -1,    -1,    -1,    36,    37,    38,
+      39
 };
 
-  /* YYSTOS[STATE-NUM] -- The (internal number of the) accessing
-     symbol of state STATE-NUM.  */
-static const yytype_uint8 yystos[] =
+/* YYSTOS[STATE-NUM] -- The symbol kind of the accessing symbol of
+   state STATE-NUM.  */
+static const yytype_int8 yystos[] =
 {
-       0,    28,    29,    49,     3,     4,     5,     6,    11,    25,
-      30,    38,    44,    50,    52,    53,    13,    44,    55,    56,
-       0,    44,    47,    44,    50,    53,    50,     7,     8,    10,
-      12,    30,    31,    32,    33,    34,    35,    36,    37,    38,
-      39,    40,    41,     6,    24,    39,    50,    59,    60,    56,
-      26,    57,    58,    50,    51,     6,    50,    45,    44,    50,
-      53,    11,    30,     7,     8,    10,    50,    50,    34,    35,
-      50,    33,    35,    50,    33,    50,    33,    53,    53,    53,
-      53,    53,    44,    47,    59,     6,    21,    61,    20,    46,
-      45,    27,    55,    46,    45,    21,    51,     9,    32,    11,
-      44,    50,    53,    50,    50,    50,    50,    50,    50,    24,
-      39,    39,    20,     6,     5,     6,    67,    59,    57,    51,
-       6,    54,    45,    50,    53,    51,     9,    32,     6,    52,
-      45,    67,    47,    47,    61,    14,    15,    63,    44,    45,
-      45,    50,    53,    45,    61,    63,     6,     6,    15,    67,
-      16,    62,     3,     6,    61,    62,    61,    61,    67,    17,
-      50,    18,    64,    45,    46,    45,    46,    64,    17,    50,
-      19,     3,     3,    50,    63,    52,    65,    66,    45,    45,
-      63,    22,    23,    46,    65
+       0,    31,    32,    52,     3,     4,     5,     6,    11,    25,
+      33,    41,    47,    53,    55,    56,    13,    47,    58,    59,
+       0,    47,    50,    47,    53,    56,    53,     7,     8,    10,
+      12,    33,    34,    35,    36,    37,    38,    39,    40,    41,
+      42,    43,    44,     6,    24,    42,    53,    62,    63,    59,
+      26,    60,    61,    53,    54,     6,    53,    48,    47,    53,
+      56,    11,    33,     7,     8,    10,    53,    53,    37,    38,
+      53,    36,    38,    53,    36,    53,    36,    56,    56,    56,
+      56,    56,    47,    50,    62,     6,    21,    64,    20,    49,
+      48,    27,    58,    49,    48,    21,    54,     9,    35,    11,
+      47,    53,    56,    53,    53,    53,    53,    53,    53,    24,
+      42,    42,    20,     6,     5,     6,    75,    62,    60,    54,
+       6,    57,    48,    53,    56,    54,     9,    35,     6,    55,
+      48,    75,    50,    50,    64,    14,    15,    66,    47,    48,
+      48,    53,    56,    48,    64,    66,     6,     6,    15,    75,
+      16,    65,     3,     6,    64,    65,    64,    64,    75,    17,
+      53,    29,    67,    48,    49,    48,    49,    67,    17,    53,
+      19,    18,    70,     3,     3,    70,    53,    66,    55,    68,
+      69,    19,    28,    71,    48,    48,    71,    66,    49,    55,
+      73,    74,     3,    68,    22,    23,    49,    30,    72,    73,
+       3
 };
 
-  /* YYR1[YYN] -- Symbol number of symbol that rule YYN derives.  */
-static const yytype_uint8 yyr1[] =
+/* YYR1[RULE-NUM] -- Symbol kind of the left-hand side of rule RULE-NUM.  */
+static const yytype_int8 yyr1[] =
 {
-       0,    48,    49,    49,    49,    50,    50,    50,    50,    50,
-      50,    50,    50,    50,    50,    50,    50,    50,    50,    50,
-      50,    50,    50,    50,    50,    50,    50,    50,    51,    51,
-      52,    52,    53,    53,    53,    53,    53,    53,    53,    53,
-      53,    53,    53,    53,    53,    53,    54,    54,    54,    54,
-      54,    55,    55,    56,    56,    57,    57,    58,    59,    59,
-      60,    60,    60,    60,    60,    60,    60,    60,    61,    61,
-      62,    62,    63,    63,    63,    64,    64,    65,    65,    66,
-      66,    66,    67,    67,    67,    67,    67,    67
+       0,    51,    52,    52,    52,    53,    53,    53,    53,    53,
+      53,    53,    53,    53,    53,    53,    53,    53,    53,    53,
+      53,    53,    53,    53,    53,    53,    53,    53,    54,    54,
+      55,    55,    56,    56,    56,    56,    56,    56,    56,    56,
+      56,    56,    56,    56,    56,    56,    57,    57,    57,    57,
+      57,    58,    58,    59,    59,    60,    60,    61,    62,    62,
+      63,    63,    63,    63,    63,    63,    63,    63,    64,    64,
+      65,    65,    66,    66,    66,    67,    67,    68,    68,    69,
+      70,    70,    71,    71,    72,    72,    73,    73,    74,    74,
+      74,    75,    75,    75,    75,    75,    75
 };
 
-  /* YYR2[YYN] -- Number of symbols on the right hand side of rule YYN.  */
-static const yytype_uint8 yyr2[] =
+/* YYR2[RULE-NUM] -- Number of symbols on the right-hand side of rule RULE-NUM.  */
+static const yytype_int8 yyr2[] =
 {
        0,     2,     0,     2,     2,     1,     3,     3,     2,     3,
        4,     4,     3,     3,     4,     4,     4,     4,     3,     4,
        5,     6,     5,     6,     5,     6,     3,     4,     3,     1,
        1,     3,     1,     1,     1,     1,     3,     1,     2,     3,
        3,     3,     3,     3,     4,     6,     1,     4,     6,     4,
-       6,     2,     4,     7,     8,     0,     2,     2,     1,     3,
+       6,     2,     4,     9,    10,     0,     2,     2,     1,     3,
        1,     2,     1,     3,     4,     5,     5,     6,     2,     1,
        0,     2,     0,     5,     6,     0,     3,     3,     1,     1,
-       2,     2,     1,     2,     3,     4,     3,     4
+       0,     3,     0,     3,     0,     2,     3,     1,     1,     2,
+       2,     1,     2,     3,     4,     3,     4
 };
 
 
+enum { YYENOMEM = -2 };
+
 #define yyerrok         (yyerrstatus = 0)
 #define yyclearin       (yychar = YYEMPTY)
-#define YYEMPTY         (-2)
-#define YYEOF           0
 
 #define YYACCEPT        goto yyacceptlab
 #define YYABORT         goto yyabortlab
 #define YYERROR         goto yyerrorlab
+#define YYNOMEM         goto yyexhaustedlab
 
 
 #define YYRECOVERING()  (!!yyerrstatus)
 
-#define YYBACKUP(Token, Value)                                  \
-do                                                              \
-  if (yychar == YYEMPTY)                                        \
-    {                                                           \
-      yychar = (Token);                                         \
-      yylval = (Value);                                         \
-      YYPOPSTACK (yylen);                                       \
-      yystate = *yyssp;                                         \
-      goto yybackup;                                            \
-    }                                                           \
-  else                                                          \
-    {                                                           \
-      yyerror (context, YY_("syntax error: cannot back up")); \
-      YYERROR;                                                  \
-    }                                                           \
-while (0)
-
-/* Error token number */
-#define YYTERROR        1
-#define YYERRCODE       256
-
+#define YYBACKUP(Token, Value)                                    \
+  do                                                              \
+    if (yychar == YYEMPTY)                                        \
+      {                                                           \
+        yychar = (Token);                                         \
+        yylval = (Value);                                         \
+        YYPOPSTACK (yylen);                                       \
+        yystate = *yyssp;                                         \
+        goto yybackup;                                            \
+      }                                                           \
+    else                                                          \
+      {                                                           \
+        yyerror (context, YY_("syntax error: cannot back up")); \
+        YYERROR;                                                  \
+      }                                                           \
+  while (0)
+
+/* Backward compatibility with an undocumented macro.
+   Use YYerror or YYUNDEF. */
+#define YYERRCODE YYUNDEF
 
 
 /* Enable debugging if requested.  */
@@ -803,56 +940,53 @@ do {                                            \
     YYFPRINTF Args;                             \
 } while (0)
 
-/* This macro is provided for backward compatibility. */
-#ifndef YY_LOCATION_PRINT
-# define YY_LOCATION_PRINT(File, Loc) ((void) 0)
-#endif
 
 
-# define YY_SYMBOL_PRINT(Title, Type, Value, Location)                    \
+
+# define YY_SYMBOL_PRINT(Title, Kind, Value, Location)                    \
 do {                                                                      \
   if (yydebug)                                                            \
     {                                                                     \
       YYFPRINTF (stderr, "%s ", Title);                                   \
       yy_symbol_print (stderr,                                            \
-                  Type, Value, context); \
+                  Kind, Value, context); \
       YYFPRINTF (stderr, "\n");                                           \
     }                                                                     \
 } while (0)
 
 
-/*----------------------------------------.
-| Print this symbol's value on YYOUTPUT.  |
-`----------------------------------------*/
+/*-----------------------------------.
+| Print this symbol's value on YYO.  |
+`-----------------------------------*/
 
 static void
-yy_symbol_value_print (FILE *yyoutput, int yytype, YYSTYPE const * const yyvaluep, swq_parse_context *context)
+yy_symbol_value_print (FILE *yyo,
+                       yysymbol_kind_t yykind, YYSTYPE const * const yyvaluep, swq_parse_context *context)
 {
-  FILE *yyo = yyoutput;
-  YYUSE (yyo);
-  YYUSE (context);
+  FILE *yyoutput = yyo;
+  YY_USE (yyoutput);
+  YY_USE (context);
   if (!yyvaluep)
     return;
-# ifdef YYPRINT
-  if (yytype < YYNTOKENS)
-    YYPRINT (yyoutput, yytoknum[yytype], *yyvaluep);
-# endif
-  YYUSE (yytype);
+  YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+  YY_USE (yykind);
+  YY_IGNORE_MAYBE_UNINITIALIZED_END
 }
 
 
-/*--------------------------------.
-| Print this symbol on YYOUTPUT.  |
-`--------------------------------*/
+/*---------------------------.
+| Print this symbol on YYO.  |
+`---------------------------*/
 
 static void
-yy_symbol_print (FILE *yyoutput, int yytype, YYSTYPE const * const yyvaluep, swq_parse_context *context)
+yy_symbol_print (FILE *yyo,
+                 yysymbol_kind_t yykind, YYSTYPE const * const yyvaluep, swq_parse_context *context)
 {
-  YYFPRINTF (yyoutput, "%s %s (",
-             yytype < YYNTOKENS ? "token" : "nterm", yytname[yytype]);
+  YYFPRINTF (yyo, "%s %s (",
+             yykind < YYNTOKENS ? "token" : "nterm", yysymbol_name (yykind));
 
-  yy_symbol_value_print (yyoutput, yytype, yyvaluep, context);
-  YYFPRINTF (yyoutput, ")");
+  yy_symbol_value_print (yyo, yykind, yyvaluep, context);
+  YYFPRINTF (yyo, ")");
 }
 
 /*------------------------------------------------------------------.
@@ -861,7 +995,7 @@ yy_symbol_print (FILE *yyoutput, int yytype, YYSTYPE const * const yyvaluep, swq
 `------------------------------------------------------------------*/
 
 static void
-yy_stack_print (yytype_int16 *yybottom, yytype_int16 *yytop)
+yy_stack_print (yy_state_t *yybottom, yy_state_t *yytop)
 {
   YYFPRINTF (stderr, "Stack now");
   for (; yybottom <= yytop; yybottom++)
@@ -884,21 +1018,21 @@ do {                                                            \
 `------------------------------------------------*/
 
 static void
-yy_reduce_print (yytype_int16 *yyssp, YYSTYPE *yyvsp, int yyrule, swq_parse_context *context)
+yy_reduce_print (yy_state_t *yyssp, YYSTYPE *yyvsp,
+                 int yyrule, swq_parse_context *context)
 {
-  unsigned long int yylno = yyrline[yyrule];
+  int yylno = yyrline[yyrule];
   int yynrhs = yyr2[yyrule];
   int yyi;
-  YYFPRINTF (stderr, "Reducing stack by rule %d (line %lu):\n",
+  YYFPRINTF (stderr, "Reducing stack by rule %d (line %d):\n",
              yyrule - 1, yylno);
   /* The symbols being reduced.  */
   for (yyi = 0; yyi < yynrhs; yyi++)
     {
       YYFPRINTF (stderr, "   $%d = ", yyi + 1);
       yy_symbol_print (stderr,
-                       yystos[yyssp[yyi + 1 - yynrhs]],
-                       &(yyvsp[(yyi + 1) - (yynrhs)])
-                                              , context);
+                       YY_ACCESSING_SYMBOL (+yyssp[yyi + 1 - yynrhs]),
+                       &yyvsp[(yyi + 1) - (yynrhs)], context);
       YYFPRINTF (stderr, "\n");
     }
 }
@@ -913,8 +1047,8 @@ do {                                    \
    multiple parsers can coexist.  */
 int yydebug;
 #else /* !YYDEBUG */
-# define YYDPRINTF(Args)
-# define YY_SYMBOL_PRINT(Title, Type, Value, Location)
+# define YYDPRINTF(Args) ((void) 0)
+# define YY_SYMBOL_PRINT(Title, Kind, Value, Location)
 # define YY_STACK_PRINT(Bottom, Top)
 # define YY_REDUCE_PRINT(Rule)
 #endif /* !YYDEBUG */
@@ -937,28 +1071,76 @@ int yydebug;
 #endif
 
 
-#if YYERROR_VERBOSE
+/* Context of a parse error.  */
+typedef struct
+{
+  yy_state_t *yyssp;
+  yysymbol_kind_t yytoken;
+} yypcontext_t;
+
+/* Put in YYARG at most YYARGN of the expected tokens given the
+   current YYCTX, and return the number of tokens stored in YYARG.  If
+   YYARG is null, return the number of expected tokens (guaranteed to
+   be less than YYNTOKENS).  Return YYENOMEM on memory exhaustion.
+   Return 0 if there are more than YYARGN expected tokens, yet fill
+   YYARG up to YYARGN. */
+static int
+yypcontext_expected_tokens (const yypcontext_t *yyctx,
+                            yysymbol_kind_t yyarg[], int yyargn)
+{
+  /* Actual size of YYARG. */
+  int yycount = 0;
+  int yyn = yypact[+*yyctx->yyssp];
+  if (!yypact_value_is_default (yyn))
+    {
+      /* Start YYX at -YYN if negative to avoid negative indexes in
+         YYCHECK.  In other words, skip the first -YYN actions for
+         this state because they are default actions.  */
+      int yyxbegin = yyn < 0 ? -yyn : 0;
+      /* Stay within bounds of both yycheck and yytname.  */
+      int yychecklim = YYLAST - yyn + 1;
+      int yyxend = yychecklim < YYNTOKENS ? yychecklim : YYNTOKENS;
+      int yyx;
+      for (yyx = yyxbegin; yyx < yyxend; ++yyx)
+        if (yycheck[yyx + yyn] == yyx && yyx != YYSYMBOL_YYerror
+            && !yytable_value_is_error (yytable[yyx + yyn]))
+          {
+            if (!yyarg)
+              ++yycount;
+            else if (yycount == yyargn)
+              return 0;
+            else
+              yyarg[yycount++] = YY_CAST (yysymbol_kind_t, yyx);
+          }
+    }
+  if (yyarg && yycount == 0 && 0 < yyargn)
+    yyarg[0] = YYSYMBOL_YYEMPTY;
+  return yycount;
+}
+
+
 
-# ifndef yystrlen
-#  if defined __GLIBC__ && defined _STRING_H
-#   define yystrlen strlen
-#  else
+
+#ifndef yystrlen
+# if defined __GLIBC__ && defined _STRING_H
+#  define yystrlen(S) (YY_CAST (YYPTRDIFF_T, strlen (S)))
+# else
 /* Return the length of YYSTR.  */
-static YYSIZE_T
+static YYPTRDIFF_T
 yystrlen (const char *yystr)
 {
-  YYSIZE_T yylen;
+  YYPTRDIFF_T yylen;
   for (yylen = 0; yystr[yylen]; yylen++)
     continue;
   return yylen;
 }
-#  endif
 # endif
+#endif
 
-# ifndef yystpcpy
-#  if defined __GLIBC__ && defined _STRING_H && defined _GNU_SOURCE
-#   define yystpcpy stpcpy
-#  else
+#ifndef yystpcpy
+# if defined __GLIBC__ && defined _STRING_H && defined _GNU_SOURCE
+#  define yystpcpy stpcpy
+# else
 /* Copy YYSRC to YYDEST, returning the address of the terminating '\0' in
    YYDEST.  */
 static char *
@@ -972,10 +1154,10 @@ yystpcpy (char *yydest, const char *yysrc)
 
   return yyd - 1;
 }
-#  endif
 # endif
+#endif
 
-# ifndef yytnamerr
+#ifndef yytnamerr
 /* Copy to YYRES the contents of YYSTR after stripping away unnecessary
    quotes and backslashes, so that it's suitable for yyerror.  The
    heuristic is that double-quoting is unnecessary unless the string
@@ -983,14 +1165,13 @@ yystpcpy (char *yydest, const char *yysrc)
    backslash-backslash).  YYSTR is taken from yytname.  If YYRES is
    null, do not copy; instead, return the length of what the result
    would have been.  */
-static YYSIZE_T
+static YYPTRDIFF_T
 yytnamerr (char *yyres, const char *yystr)
 {
   if (*yystr == '"')
     {
-      YYSIZE_T yyn = 0;
+      YYPTRDIFF_T yyn = 0;
       char const *yyp = yystr;
-
       for (;;)
         switch (*++yyp)
           {
@@ -1001,8 +1182,10 @@ yytnamerr (char *yyres, const char *yystr)
           case '\\':
             if (*++yyp != '\\')
               goto do_not_strip_quotes;
-            /* Fall through.  */
-            // CPL_FALLTHROUGH
+            else
+              goto append;
+
+          append:
           default:
             if (yyres)
               yyres[yyn] = *yyp;
@@ -1017,36 +1200,20 @@ yytnamerr (char *yyres, const char *yystr)
     do_not_strip_quotes: ;
     }
 
-  if (! yyres)
+  if (yyres)
+    return yystpcpy (yyres, yystr) - yyres;
+  else
     return yystrlen (yystr);
-
-  return yystpcpy (yyres, yystr) - yyres;
 }
-# endif
+#endif
 
-/* Copy into *YYMSG, which is of size *YYMSG_ALLOC, an error message
-   about the unexpected token YYTOKEN for the state stack whose top is
-   YYSSP.
 
-   Return 0 if *YYMSG was successfully written.  Return 1 if *YYMSG is
-   not large enough to hold the message.  In that case, also set
-   *YYMSG_ALLOC to the required number of bytes.  Return 2 if the
-   required number of bytes is too large to store.  */
 static int
-yysyntax_error (YYSIZE_T *yymsg_alloc, char **yymsg,
-                yytype_int16 *yyssp, int yytoken)
+yy_syntax_error_arguments (const yypcontext_t *yyctx,
+                           yysymbol_kind_t yyarg[], int yyargn)
 {
-  YYSIZE_T yysize0 = yytnamerr (YY_NULL, yytname[yytoken]);
-  YYSIZE_T yysize = yysize0;
-  enum { YYERROR_VERBOSE_ARGS_MAXIMUM = 5 };
-  /* Internationalized format string. */
-  const char *yyformat = YY_NULL;
-  /* Arguments of yyformat. */
-  char const *yyarg[YYERROR_VERBOSE_ARGS_MAXIMUM];
-  /* Number of reported tokens (one for the "unexpected", one per
-     "expected"). */
+  /* Actual size of YYARG. */
   int yycount = 0;
-
   /* There are many possibilities here to consider:
      - If this state is a consistent state with a default action, then
        the only way this function was invoked is if the default action
@@ -1070,63 +1237,78 @@ yysyntax_error (YYSIZE_T *yymsg_alloc, char **yymsg,
        one exception: it will still contain any token that will not be
        accepted due to an error action in a later state.
   */
-  if (yytoken != YYEMPTY)
-    {
-      int yyn = yypact[*yyssp];
-      yyarg[yycount++] = yytname[yytoken];
-      if (!yypact_value_is_default (yyn))
-        {
-          /* Start YYX at -YYN if negative to avoid negative indexes in
-             YYCHECK.  In other words, skip the first -YYN actions for
-             this state because they are default actions.  */
-          int yyxbegin = yyn < 0 ? -yyn : 0;
-          /* Stay within bounds of both yycheck and yytname.  */
-          int yychecklim = YYLAST - yyn + 1;
-          int yyxend = yychecklim < YYNTOKENS ? yychecklim : YYNTOKENS;
-          int yyx;
-
-          for (yyx = yyxbegin; yyx < yyxend; ++yyx)
-            if (yycheck[yyx + yyn] == yyx && yyx != YYTERROR
-                && !yytable_value_is_error (yytable[yyx + yyn]))
-              {
-                if (yycount == YYERROR_VERBOSE_ARGS_MAXIMUM)
-                  {
-                    yycount = 1;
-                    yysize = yysize0;
-                    break;
-                  }
-                yyarg[yycount++] = yytname[yyx];
-                {
-                  YYSIZE_T yysize1 = yysize + yytnamerr (YY_NULL, yytname[yyx]);
-                  if (! (yysize <= yysize1
-                         && yysize1 <= YYSTACK_ALLOC_MAXIMUM))
-                    return 2;
-                  yysize = yysize1;
-                }
-              }
-        }
+  if (yyctx->yytoken != YYSYMBOL_YYEMPTY)
+    {
+      int yyn;
+      if (yyarg)
+        yyarg[yycount] = yyctx->yytoken;
+      ++yycount;
+      yyn = yypcontext_expected_tokens (yyctx,
+                                        yyarg ? yyarg + 1 : yyarg, yyargn - 1);
+      if (yyn == YYENOMEM)
+        return YYENOMEM;
+      else
+        yycount += yyn;
     }
+  return yycount;
+}
+
+/* Copy into *YYMSG, which is of size *YYMSG_ALLOC, an error message
+   about the unexpected token YYTOKEN for the state stack whose top is
+   YYSSP.
+
+   Return 0 if *YYMSG was successfully written.  Return -1 if *YYMSG is
+   not large enough to hold the message.  In that case, also set
+   *YYMSG_ALLOC to the required number of bytes.  Return YYENOMEM if the
+   required number of bytes is too large to store.  */
+static int
+yysyntax_error (YYPTRDIFF_T *yymsg_alloc, char **yymsg,
+                const yypcontext_t *yyctx)
+{
+  enum { YYARGS_MAX = 5 };
+  /* Internationalized format string. */
+  const char *yyformat = YY_NULLPTR;
+  /* Arguments of yyformat: reported tokens (one for the "unexpected",
+     one per "expected"). */
+  yysymbol_kind_t yyarg[YYARGS_MAX];
+  /* Cumulated lengths of YYARG.  */
+  YYPTRDIFF_T yysize = 0;
+
+  /* Actual size of YYARG. */
+  int yycount = yy_syntax_error_arguments (yyctx, yyarg, YYARGS_MAX);
+  if (yycount == YYENOMEM)
+    return YYENOMEM;
 
   switch (yycount)
     {
-# define YYCASE_(N, S)                      \
+#define YYCASE_(N, S)                       \
       case N:                               \
         yyformat = S;                       \
-      break
+        break
+    default: /* Avoid compiler warnings. */
       YYCASE_(0, YY_("syntax error"));
       YYCASE_(1, YY_("syntax error, unexpected %s"));
       YYCASE_(2, YY_("syntax error, unexpected %s, expecting %s"));
       YYCASE_(3, YY_("syntax error, unexpected %s, expecting %s or %s"));
       YYCASE_(4, YY_("syntax error, unexpected %s, expecting %s or %s or %s"));
       YYCASE_(5, YY_("syntax error, unexpected %s, expecting %s or %s or %s or %s"));
-# undef YYCASE_
+#undef YYCASE_
     }
 
+  /* Compute error message size.  Don't count the "%s"s, but reserve
+     room for the terminator.  */
+  yysize = yystrlen (yyformat) - 2 * yycount + 1;
   {
-    YYSIZE_T yysize1 = yysize + yystrlen (yyformat);
-    if (! (yysize <= yysize1 && yysize1 <= YYSTACK_ALLOC_MAXIMUM))
-      return 2;
-    yysize = yysize1;
+    int yyi;
+    for (yyi = 0; yyi < yycount; ++yyi)
+      {
+        YYPTRDIFF_T yysize1
+          = yysize + yytnamerr (YY_NULLPTR, yytname[yyarg[yyi]]);
+        if (yysize <= yysize1 && yysize1 <= YYSTACK_ALLOC_MAXIMUM)
+          yysize = yysize1;
+        else
+          return YYENOMEM;
+      }
   }
 
   if (*yymsg_alloc < yysize)
@@ -1135,7 +1317,7 @@ yysyntax_error (YYSIZE_T *yymsg_alloc, char **yymsg,
       if (! (yysize <= *yymsg_alloc
              && *yymsg_alloc <= YYSTACK_ALLOC_MAXIMUM))
         *yymsg_alloc = YYSTACK_ALLOC_MAXIMUM;
-      return 1;
+      return -1;
     }
 
   /* Avoid sprintf, as that infringes on the user's name space.
@@ -1147,96 +1329,96 @@ yysyntax_error (YYSIZE_T *yymsg_alloc, char **yymsg,
     while ((*yyp = *yyformat) != '\0')
       if (*yyp == '%' && yyformat[1] == 's' && yyi < yycount)
         {
-          yyp += yytnamerr (yyp, yyarg[yyi++]);
+          yyp += yytnamerr (yyp, yytname[yyarg[yyi++]]);
           yyformat += 2;
         }
       else
         {
-          yyp++;
-          yyformat++;
+          ++yyp;
+          ++yyformat;
         }
   }
   return 0;
 }
-#endif /* YYERROR_VERBOSE */
+
 
 /*-----------------------------------------------.
 | Release the memory associated to this symbol.  |
 `-----------------------------------------------*/
 
 static void
-yydestruct (const char *yymsg, int yytype, YYSTYPE *yyvaluep, swq_parse_context *context)
+yydestruct (const char *yymsg,
+            yysymbol_kind_t yykind, YYSTYPE *yyvaluep, swq_parse_context *context)
 {
-  YYUSE (yyvaluep);
-  YYUSE (context);
+  YY_USE (yyvaluep);
+  YY_USE (context);
   if (!yymsg)
     yymsg = "Deleting";
-  YY_SYMBOL_PRINT (yymsg, yytype, yyvaluep, yylocationp);
+  YY_SYMBOL_PRINT (yymsg, yykind, yyvaluep, yylocationp);
 
   YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
-  switch (yytype)
+  switch (yykind)
     {
-          case 3: /* "integer number"  */
-#line 107 "swq_parser.y" /* yacc.c:1257  */
-      { delete ((*yyvaluep)); }
-#line 1181 "swq_parser.cpp" /* yacc.c:1257  */
+    case YYSYMBOL_SWQT_INTEGER_NUMBER: /* "integer number"  */
+#line 110 "swq_parser.y"
+            { delete (*yyvaluep); }
+#line 1366 "swq_parser.cpp"
         break;
 
-    case 4: /* "floating point number"  */
-#line 107 "swq_parser.y" /* yacc.c:1257  */
-      { delete ((*yyvaluep)); }
-#line 1187 "swq_parser.cpp" /* yacc.c:1257  */
+    case YYSYMBOL_SWQT_FLOAT_NUMBER: /* "floating point number"  */
+#line 110 "swq_parser.y"
+            { delete (*yyvaluep); }
+#line 1372 "swq_parser.cpp"
         break;
 
-    case 5: /* "string"  */
-#line 107 "swq_parser.y" /* yacc.c:1257  */
-      { delete ((*yyvaluep)); }
-#line 1193 "swq_parser.cpp" /* yacc.c:1257  */
+    case YYSYMBOL_SWQT_STRING: /* "string"  */
+#line 110 "swq_parser.y"
+            { delete (*yyvaluep); }
+#line 1378 "swq_parser.cpp"
         break;
 
-    case 6: /* "identifier"  */
-#line 107 "swq_parser.y" /* yacc.c:1257  */
-      { delete ((*yyvaluep)); }
-#line 1199 "swq_parser.cpp" /* yacc.c:1257  */
+    case YYSYMBOL_SWQT_IDENTIFIER: /* "identifier"  */
+#line 110 "swq_parser.y"
+            { delete (*yyvaluep); }
+#line 1384 "swq_parser.cpp"
         break;
 
-    case 50: /* value_expr  */
-#line 108 "swq_parser.y" /* yacc.c:1257  */
-      { delete ((*yyvaluep)); }
-#line 1205 "swq_parser.cpp" /* yacc.c:1257  */
+    case YYSYMBOL_value_expr: /* value_expr  */
+#line 111 "swq_parser.y"
+            { delete (*yyvaluep); }
+#line 1390 "swq_parser.cpp"
         break;
 
-    case 51: /* value_expr_list  */
-#line 108 "swq_parser.y" /* yacc.c:1257  */
-      { delete ((*yyvaluep)); }
-#line 1211 "swq_parser.cpp" /* yacc.c:1257  */
+    case YYSYMBOL_value_expr_list: /* value_expr_list  */
+#line 111 "swq_parser.y"
+            { delete (*yyvaluep); }
+#line 1396 "swq_parser.cpp"
         break;
 
-    case 52: /* field_value  */
-#line 108 "swq_parser.y" /* yacc.c:1257  */
-      { delete ((*yyvaluep)); }
-#line 1217 "swq_parser.cpp" /* yacc.c:1257  */
+    case YYSYMBOL_field_value: /* field_value  */
+#line 111 "swq_parser.y"
+            { delete (*yyvaluep); }
+#line 1402 "swq_parser.cpp"
         break;
 
-    case 53: /* value_expr_non_logical  */
-#line 108 "swq_parser.y" /* yacc.c:1257  */
-      { delete ((*yyvaluep)); }
-#line 1223 "swq_parser.cpp" /* yacc.c:1257  */
+    case YYSYMBOL_value_expr_non_logical: /* value_expr_non_logical  */
+#line 111 "swq_parser.y"
+            { delete (*yyvaluep); }
+#line 1408 "swq_parser.cpp"
         break;
 
-    case 54: /* type_def  */
-#line 108 "swq_parser.y" /* yacc.c:1257  */
-      { delete ((*yyvaluep)); }
-#line 1229 "swq_parser.cpp" /* yacc.c:1257  */
+    case YYSYMBOL_type_def: /* type_def  */
+#line 111 "swq_parser.y"
+            { delete (*yyvaluep); }
+#line 1414 "swq_parser.cpp"
         break;
 
-    case 67: /* table_def  */
-#line 108 "swq_parser.y" /* yacc.c:1257  */
-      { delete ((*yyvaluep)); }
-#line 1235 "swq_parser.cpp" /* yacc.c:1257  */
+    case YYSYMBOL_table_def: /* table_def  */
+#line 111 "swq_parser.y"
+            { delete (*yyvaluep); }
+#line 1420 "swq_parser.cpp"
         break;
 
-
       default:
         break;
     }
@@ -1246,6 +1428,8 @@ yydestruct (const char *yymsg, int yytype, YYSTYPE *yyvaluep, swq_parse_context
 
 
 
+
+
 /*----------.
 | yyparse.  |
 `----------*/
@@ -1253,7 +1437,7 @@ yydestruct (const char *yymsg, int yytype, YYSTYPE *yyvaluep, swq_parse_context
 int
 yyparse (swq_parse_context *context)
 {
-/* The lookahead symbol.  */
+/* Lookahead token kind.  */
 int yychar;
 
 
@@ -1264,45 +1448,41 @@ YY_INITIAL_VALUE (static YYSTYPE yyval_default;)
 YYSTYPE yylval YY_INITIAL_VALUE (= yyval_default);
 
     /* Number of syntax errors so far.  */
-    int yynerrs;
+    int yynerrs = 0;
 
-    int yystate;
+    yy_state_fast_t yystate = 0;
     /* Number of tokens to shift before error messages enabled.  */
-    int yyerrstatus;
-
-    /* The stacks and their tools:
-       'yyss': related to states.
-       'yyvs': related to semantic values.
+    int yyerrstatus = 0;
 
-       Refer to the stacks through separate pointers, to allow yyoverflow
+    /* Refer to the stacks through separate pointers, to allow yyoverflow
        to reallocate them elsewhere.  */
 
-    /* The state stack.  */
-    yytype_int16 yyssa[YYINITDEPTH]; /* workaround bug with gcc 4.1 -O2 */ memset(yyssa, 0, sizeof(yyssa));
-    yytype_int16 *yyss;
-    yytype_int16 *yyssp;
+    /* Their size.  */
+    YYPTRDIFF_T yystacksize = YYINITDEPTH;
 
-    /* The semantic value stack.  */
-    YYSTYPE yyvsa[YYINITDEPTH];
-    YYSTYPE *yyvs;
-    YYSTYPE *yyvsp;
+    /* The state stack: array, bottom, top.  */
+    yy_state_t yyssa[YYINITDEPTH];
+    yy_state_t *yyss = yyssa;
+    yy_state_t *yyssp = yyss;
 
-    YYSIZE_T yystacksize;
+    /* The semantic value stack: array, bottom, top.  */
+    YYSTYPE yyvsa[YYINITDEPTH];
+    YYSTYPE *yyvs = yyvsa;
+    YYSTYPE *yyvsp = yyvs;
 
   int yyn;
+  /* The return value of yyparse.  */
   int yyresult;
-  /* Lookahead token as an internal (translated) token number.  */
-  int yytoken = 0;
+  /* Lookahead symbol kind.  */
+  yysymbol_kind_t yytoken = YYSYMBOL_YYEMPTY;
   /* The variables used to return semantic value and location from the
      action routines.  */
   YYSTYPE yyval;
 
-#if YYERROR_VERBOSE
   /* Buffer for error messages, and its allocated size.  */
   char yymsgbuf[128];
   char *yymsg = yymsgbuf;
-  YYSIZE_T yymsg_alloc = sizeof yymsgbuf;
-#endif
+  YYPTRDIFF_T yymsg_alloc = sizeof yymsgbuf;
 
 #define YYPOPSTACK(N)   (yyvsp -= (N), yyssp -= (N))
 
@@ -1310,71 +1490,75 @@ YYSTYPE yylval YY_INITIAL_VALUE (= yyval_default);
      Keep to zero when no symbol should be popped.  */
   int yylen = 0;
 
-  yyssp = yyss = yyssa;
-  yyvsp = yyvs = yyvsa;
-  yystacksize = YYINITDEPTH;
-
   YYDPRINTF ((stderr, "Starting parse\n"));
 
-  yystate = 0;
-  yyerrstatus = 0;
-  yynerrs = 0;
   yychar = YYEMPTY; /* Cause a token to be read.  */
+
   goto yysetstate;
 
+
 /*------------------------------------------------------------.
-| yynewstate -- Push a new state, which is found in yystate.  |
+| yynewstate -- push a new state, which is found in yystate.  |
 `------------------------------------------------------------*/
- yynewstate:
+yynewstate:
   /* In all cases, when you get here, the value and location stacks
      have just been pushed.  So pushing a state here evens the stacks.  */
   yyssp++;
 
- yysetstate:
-  *yyssp = (yytype_int16)yystate;
+
+/*--------------------------------------------------------------------.
+| yysetstate -- set current state (the top of the stack) to yystate.  |
+`--------------------------------------------------------------------*/
+yysetstate:
+  YYDPRINTF ((stderr, "Entering state %d\n", yystate));
+  YY_ASSERT (0 <= yystate && yystate < YYNSTATES);
+  YY_IGNORE_USELESS_CAST_BEGIN
+  *yyssp = YY_CAST (yy_state_t, yystate);
+  YY_IGNORE_USELESS_CAST_END
+  YY_STACK_PRINT (yyss, yyssp);
 
   if (yyss + yystacksize - 1 <= yyssp)
+#if !defined yyoverflow && !defined YYSTACK_RELOCATE
+    YYNOMEM;
+#else
     {
       /* Get the current used size of the three stacks, in elements.  */
-      YYSIZE_T yysize = yyssp - yyss + 1;
+      YYPTRDIFF_T yysize = yyssp - yyss + 1;
 
-#ifdef yyoverflow
+# if defined yyoverflow
       {
         /* Give user a chance to reallocate the stack.  Use copies of
            these so that the &'s don't force the real ones into
            memory.  */
+        yy_state_t *yyss1 = yyss;
         YYSTYPE *yyvs1 = yyvs;
-        yytype_int16 *yyss1 = yyss;
 
         /* Each stack pointer address is followed by the size of the
            data in use in that stack, in bytes.  This used to be a
            conditional around just the two extra args, but that might
            be undefined if yyoverflow is a macro.  */
         yyoverflow (YY_("memory exhausted"),
-                    &yyss1, yysize * sizeof (*yyssp),
-                    &yyvs1, yysize * sizeof (*yyvsp),
+                    &yyss1, yysize * YYSIZEOF (*yyssp),
+                    &yyvs1, yysize * YYSIZEOF (*yyvsp),
                     &yystacksize);
-
         yyss = yyss1;
         yyvs = yyvs1;
       }
-#else /* no yyoverflow */
-# ifndef YYSTACK_RELOCATE
-      goto yyexhaustedlab;
-# else
+# else /* defined YYSTACK_RELOCATE */
       /* Extend the stack our own way.  */
       if (YYMAXDEPTH <= yystacksize)
-        goto yyexhaustedlab;
+        YYNOMEM;
       yystacksize *= 2;
       if (YYMAXDEPTH < yystacksize)
         yystacksize = YYMAXDEPTH;
 
       {
-        yytype_int16 *yyss1 = yyss;
+        yy_state_t *yyss1 = yyss;
         union yyalloc *yyptr =
-          (union yyalloc *) YYSTACK_ALLOC (YYSTACK_BYTES (yystacksize));
+          YY_CAST (union yyalloc *,
+                   YYSTACK_ALLOC (YY_CAST (YYSIZE_T, YYSTACK_BYTES (yystacksize))));
         if (! yyptr)
-          goto yyexhaustedlab;
+          YYNOMEM;
         YYSTACK_RELOCATE (yyss_alloc, yyss);
         YYSTACK_RELOCATE (yyvs_alloc, yyvs);
 #  undef YYSTACK_RELOCATE
@@ -1382,30 +1566,31 @@ YYSTYPE yylval YY_INITIAL_VALUE (= yyval_default);
           YYSTACK_FREE (yyss1);
       }
 # endif
-#endif /* no yyoverflow */
 
       yyssp = yyss + yysize - 1;
       yyvsp = yyvs + yysize - 1;
 
-      YYDPRINTF ((stderr, "Stack size increased to %lu\n",
-                  (unsigned long int) yystacksize));
+      YY_IGNORE_USELESS_CAST_BEGIN
+      YYDPRINTF ((stderr, "Stack size increased to %ld\n",
+                  YY_CAST (long, yystacksize)));
+      YY_IGNORE_USELESS_CAST_END
 
       if (yyss + yystacksize - 1 <= yyssp)
         YYABORT;
     }
+#endif /* !defined yyoverflow && !defined YYSTACK_RELOCATE */
 
-  YYDPRINTF ((stderr, "Entering state %d\n", yystate));
 
   if (yystate == YYFINAL)
     YYACCEPT;
 
   goto yybackup;
 
+
 /*-----------.
 | yybackup.  |
 `-----------*/
 yybackup:
-
   /* Do appropriate processing given the current state.  Read a
      lookahead token if we need one and don't already have one.  */
 
@@ -1416,18 +1601,29 @@ yybackup:
 
   /* Not known => get a lookahead token if don't already have one.  */
 
-  /* YYCHAR is either YYEMPTY or YYEOF or a valid lookahead symbol.  */
+  /* YYCHAR is either empty, or end-of-input, or a valid lookahead.  */
   if (yychar == YYEMPTY)
     {
-      YYDPRINTF ((stderr, "Reading a token: "));
+      YYDPRINTF ((stderr, "Reading a token\n"));
       yychar = yylex (&yylval, context);
     }
 
-  if (yychar <= YYEOF)
+  if (yychar <= END)
     {
-      yychar = yytoken = YYEOF;
+      yychar = END;
+      yytoken = YYSYMBOL_YYEOF;
       YYDPRINTF ((stderr, "Now at end of input.\n"));
     }
+  else if (yychar == YYerror)
+    {
+      /* The scanner already issued an error message, process directly
+         to error recovery.  But do not keep the error token as
+         lookahead, it is too special and may lead us to an endless
+         loop in error recovery. */
+      yychar = YYUNDEF;
+      yytoken = YYSYMBOL_YYerror;
+      goto yyerrlab1;
+    }
   else
     {
       yytoken = YYTRANSLATE (yychar);
@@ -1455,15 +1651,13 @@ yybackup:
 
   /* Shift the lookahead token.  */
   YY_SYMBOL_PRINT ("Shifting", yytoken, &yylval, &yylloc);
-
-  /* Discard the shifted token.  */
-  yychar = YYEMPTY;
-
   yystate = yyn;
   YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
   *++yyvsp = yylval;
   YY_IGNORE_MAYBE_UNINITIALIZED_END
 
+  /* Discard the shifted token.  */
+  yychar = YYEMPTY;
   goto yynewstate;
 
 
@@ -1478,7 +1672,7 @@ yydefault:
 
 
 /*-----------------------------.
-| yyreduce -- Do a reduction.  |
+| yyreduce -- do a reduction.  |
 `-----------------------------*/
 yyreduce:
   /* yyn is the number of a rule to reduce with.  */
@@ -1498,638 +1692,638 @@ yyreduce:
   YY_REDUCE_PRINT (yyn);
   switch (yyn)
     {
-        case 3:
-#line 114 "swq_parser.y" /* yacc.c:1646  */
-    {
-            context->poRoot = (yyvsp[0]);
+  case 3: /* input: SWQT_VALUE_START value_expr  */
+#line 117 "swq_parser.y"
+        {
+            context->poRoot = yyvsp[0];
         }
-#line 1505 "swq_parser.cpp" /* yacc.c:1646  */
+#line 1701 "swq_parser.cpp"
     break;
 
-  case 4:
-#line 119 "swq_parser.y" /* yacc.c:1646  */
-    {
-            context->poRoot = (yyvsp[0]);
+  case 4: /* input: SWQT_SELECT_START select_statement  */
+#line 122 "swq_parser.y"
+        {
+            context->poRoot = yyvsp[0];
         }
-#line 1513 "swq_parser.cpp" /* yacc.c:1646  */
+#line 1709 "swq_parser.cpp"
     break;
 
-  case 5:
-#line 125 "swq_parser.y" /* yacc.c:1646  */
-    {
-            (yyval) = (yyvsp[0]);
+  case 5: /* value_expr: value_expr_non_logical  */
+#line 128 "swq_parser.y"
+        {
+            yyval = yyvsp[0];
         }
-#line 1521 "swq_parser.cpp" /* yacc.c:1646  */
+#line 1717 "swq_parser.cpp"
     break;
 
-  case 6:
-#line 130 "swq_parser.y" /* yacc.c:1646  */
-    {
-            (yyval) = new swq_expr_node( SWQ_AND );
-            (yyval)->field_type = SWQ_BOOLEAN;
-            (yyval)->PushSubExpression( (yyvsp[-2]) );
-            (yyval)->PushSubExpression( (yyvsp[0]) );
+  case 6: /* value_expr: value_expr "AND" value_expr  */
+#line 133 "swq_parser.y"
+        {
+            yyval = new swq_expr_node( SWQ_AND );
+            yyval->field_type = SWQ_BOOLEAN;
+            yyval->PushSubExpression( yyvsp[-2] );
+            yyval->PushSubExpression( yyvsp[0] );
         }
-#line 1532 "swq_parser.cpp" /* yacc.c:1646  */
+#line 1728 "swq_parser.cpp"
     break;
 
-  case 7:
-#line 138 "swq_parser.y" /* yacc.c:1646  */
-    {
-            (yyval) = new swq_expr_node( SWQ_OR );
-            (yyval)->field_type = SWQ_BOOLEAN;
-            (yyval)->PushSubExpression( (yyvsp[-2]) );
-            (yyval)->PushSubExpression( (yyvsp[0]) );
+  case 7: /* value_expr: value_expr "OR" value_expr  */
+#line 141 "swq_parser.y"
+        {
+            yyval = new swq_expr_node( SWQ_OR );
+            yyval->field_type = SWQ_BOOLEAN;
+            yyval->PushSubExpression( yyvsp[-2] );
+            yyval->PushSubExpression( yyvsp[0] );
         }
-#line 1543 "swq_parser.cpp" /* yacc.c:1646  */
+#line 1739 "swq_parser.cpp"
     break;
 
-  case 8:
-#line 146 "swq_parser.y" /* yacc.c:1646  */
-    {
-            (yyval) = new swq_expr_node( SWQ_NOT );
-            (yyval)->field_type = SWQ_BOOLEAN;
-            (yyval)->PushSubExpression( (yyvsp[0]) );
+  case 8: /* value_expr: "NOT" value_expr  */
+#line 149 "swq_parser.y"
+        {
+            yyval = new swq_expr_node( SWQ_NOT );
+            yyval->field_type = SWQ_BOOLEAN;
+            yyval->PushSubExpression( yyvsp[0] );
         }
-#line 1553 "swq_parser.cpp" /* yacc.c:1646  */
+#line 1749 "swq_parser.cpp"
     break;
 
-  case 9:
-#line 153 "swq_parser.y" /* yacc.c:1646  */
-    {
-            (yyval) = new swq_expr_node( SWQ_EQ );
-            (yyval)->field_type = SWQ_BOOLEAN;
-            (yyval)->PushSubExpression( (yyvsp[-2]) );
-            (yyval)->PushSubExpression( (yyvsp[0]) );
+  case 9: /* value_expr: value_expr '=' value_expr  */
+#line 156 "swq_parser.y"
+        {
+            yyval = new swq_expr_node( SWQ_EQ );
+            yyval->field_type = SWQ_BOOLEAN;
+            yyval->PushSubExpression( yyvsp[-2] );
+            yyval->PushSubExpression( yyvsp[0] );
         }
-#line 1564 "swq_parser.cpp" /* yacc.c:1646  */
+#line 1760 "swq_parser.cpp"
     break;
 
-  case 10:
-#line 161 "swq_parser.y" /* yacc.c:1646  */
-    {
-            (yyval) = new swq_expr_node( SWQ_NE );
-            (yyval)->field_type = SWQ_BOOLEAN;
-            (yyval)->PushSubExpression( (yyvsp[-3]) );
-            (yyval)->PushSubExpression( (yyvsp[0]) );
+  case 10: /* value_expr: value_expr '<' '>' value_expr  */
+#line 164 "swq_parser.y"
+        {
+            yyval = new swq_expr_node( SWQ_NE );
+            yyval->field_type = SWQ_BOOLEAN;
+            yyval->PushSubExpression( yyvsp[-3] );
+            yyval->PushSubExpression( yyvsp[0] );
         }
-#line 1575 "swq_parser.cpp" /* yacc.c:1646  */
+#line 1771 "swq_parser.cpp"
     break;
 
-  case 11:
-#line 169 "swq_parser.y" /* yacc.c:1646  */
-    {
-            (yyval) = new swq_expr_node( SWQ_NE );
-            (yyval)->field_type = SWQ_BOOLEAN;
-            (yyval)->PushSubExpression( (yyvsp[-3]) );
-            (yyval)->PushSubExpression( (yyvsp[0]) );
+  case 11: /* value_expr: value_expr '!' '=' value_expr  */
+#line 172 "swq_parser.y"
+        {
+            yyval = new swq_expr_node( SWQ_NE );
+            yyval->field_type = SWQ_BOOLEAN;
+            yyval->PushSubExpression( yyvsp[-3] );
+            yyval->PushSubExpression( yyvsp[0] );
         }
-#line 1586 "swq_parser.cpp" /* yacc.c:1646  */
+#line 1782 "swq_parser.cpp"
     break;
 
-  case 12:
-#line 177 "swq_parser.y" /* yacc.c:1646  */
-    {
-            (yyval) = new swq_expr_node( SWQ_LT );
-            (yyval)->field_type = SWQ_BOOLEAN;
-            (yyval)->PushSubExpression( (yyvsp[-2]) );
-            (yyval)->PushSubExpression( (yyvsp[0]) );
+  case 12: /* value_expr: value_expr '<' value_expr  */
+#line 180 "swq_parser.y"
+        {
+            yyval = new swq_expr_node( SWQ_LT );
+            yyval->field_type = SWQ_BOOLEAN;
+            yyval->PushSubExpression( yyvsp[-2] );
+            yyval->PushSubExpression( yyvsp[0] );
         }
-#line 1597 "swq_parser.cpp" /* yacc.c:1646  */
+#line 1793 "swq_parser.cpp"
     break;
 
-  case 13:
-#line 185 "swq_parser.y" /* yacc.c:1646  */
-    {
-            (yyval) = new swq_expr_node( SWQ_GT );
-            (yyval)->field_type = SWQ_BOOLEAN;
-            (yyval)->PushSubExpression( (yyvsp[-2]) );
-            (yyval)->PushSubExpression( (yyvsp[0]) );
+  case 13: /* value_expr: value_expr '>' value_expr  */
+#line 188 "swq_parser.y"
+        {
+            yyval = new swq_expr_node( SWQ_GT );
+            yyval->field_type = SWQ_BOOLEAN;
+            yyval->PushSubExpression( yyvsp[-2] );
+            yyval->PushSubExpression( yyvsp[0] );
         }
-#line 1608 "swq_parser.cpp" /* yacc.c:1646  */
+#line 1804 "swq_parser.cpp"
     break;
 
-  case 14:
-#line 193 "swq_parser.y" /* yacc.c:1646  */
-    {
-            (yyval) = new swq_expr_node( SWQ_LE );
-            (yyval)->field_type = SWQ_BOOLEAN;
-            (yyval)->PushSubExpression( (yyvsp[-3]) );
-            (yyval)->PushSubExpression( (yyvsp[0]) );
+  case 14: /* value_expr: value_expr '<' '=' value_expr  */
+#line 196 "swq_parser.y"
+        {
+            yyval = new swq_expr_node( SWQ_LE );
+            yyval->field_type = SWQ_BOOLEAN;
+            yyval->PushSubExpression( yyvsp[-3] );
+            yyval->PushSubExpression( yyvsp[0] );
         }
-#line 1619 "swq_parser.cpp" /* yacc.c:1646  */
+#line 1815 "swq_parser.cpp"
     break;
 
-  case 15:
-#line 201 "swq_parser.y" /* yacc.c:1646  */
-    {
-            (yyval) = new swq_expr_node( SWQ_LE );
-            (yyval)->field_type = SWQ_BOOLEAN;
-            (yyval)->PushSubExpression( (yyvsp[-3]) );
-            (yyval)->PushSubExpression( (yyvsp[0]) );
+  case 15: /* value_expr: value_expr '=' '<' value_expr  */
+#line 204 "swq_parser.y"
+        {
+            yyval = new swq_expr_node( SWQ_LE );
+            yyval->field_type = SWQ_BOOLEAN;
+            yyval->PushSubExpression( yyvsp[-3] );
+            yyval->PushSubExpression( yyvsp[0] );
         }
-#line 1630 "swq_parser.cpp" /* yacc.c:1646  */
+#line 1826 "swq_parser.cpp"
     break;
 
-  case 16:
-#line 209 "swq_parser.y" /* yacc.c:1646  */
-    {
-            (yyval) = new swq_expr_node( SWQ_LE );
-            (yyval)->field_type = SWQ_BOOLEAN;
-            (yyval)->PushSubExpression( (yyvsp[-3]) );
-            (yyval)->PushSubExpression( (yyvsp[0]) );
+  case 16: /* value_expr: value_expr '=' '>' value_expr  */
+#line 212 "swq_parser.y"
+        {
+            yyval = new swq_expr_node( SWQ_LE );
+            yyval->field_type = SWQ_BOOLEAN;
+            yyval->PushSubExpression( yyvsp[-3] );
+            yyval->PushSubExpression( yyvsp[0] );
         }
-#line 1641 "swq_parser.cpp" /* yacc.c:1646  */
+#line 1837 "swq_parser.cpp"
     break;
 
-  case 17:
-#line 217 "swq_parser.y" /* yacc.c:1646  */
-    {
-            (yyval) = new swq_expr_node( SWQ_GE );
-            (yyval)->field_type = SWQ_BOOLEAN;
-            (yyval)->PushSubExpression( (yyvsp[-3]) );
-            (yyval)->PushSubExpression( (yyvsp[0]) );
+  case 17: /* value_expr: value_expr '>' '=' value_expr  */
+#line 220 "swq_parser.y"
+        {
+            yyval = new swq_expr_node( SWQ_GE );
+            yyval->field_type = SWQ_BOOLEAN;
+            yyval->PushSubExpression( yyvsp[-3] );
+            yyval->PushSubExpression( yyvsp[0] );
         }
-#line 1652 "swq_parser.cpp" /* yacc.c:1646  */
+#line 1848 "swq_parser.cpp"
     break;
 
-  case 18:
-#line 225 "swq_parser.y" /* yacc.c:1646  */
-    {
-            (yyval) = new swq_expr_node( SWQ_LIKE );
-            (yyval)->field_type = SWQ_BOOLEAN;
-            (yyval)->PushSubExpression( (yyvsp[-2]) );
-            (yyval)->PushSubExpression( (yyvsp[0]) );
+  case 18: /* value_expr: value_expr "LIKE" value_expr  */
+#line 228 "swq_parser.y"
+        {
+            yyval = new swq_expr_node( SWQ_LIKE );
+            yyval->field_type = SWQ_BOOLEAN;
+            yyval->PushSubExpression( yyvsp[-2] );
+            yyval->PushSubExpression( yyvsp[0] );
         }
-#line 1663 "swq_parser.cpp" /* yacc.c:1646  */
+#line 1859 "swq_parser.cpp"
     break;
 
-  case 19:
-#line 233 "swq_parser.y" /* yacc.c:1646  */
-    {
+  case 19: /* value_expr: value_expr "NOT" "LIKE" value_expr  */
+#line 236 "swq_parser.y"
+        {
             swq_expr_node *like;
             like = new swq_expr_node( SWQ_LIKE );
             like->field_type = SWQ_BOOLEAN;
-            like->PushSubExpression( (yyvsp[-3]) );
-            like->PushSubExpression( (yyvsp[0]) );
+            like->PushSubExpression( yyvsp[-3] );
+            like->PushSubExpression( yyvsp[0] );
 
-            (yyval) = new swq_expr_node( SWQ_NOT );
-            (yyval)->field_type = SWQ_BOOLEAN;
-            (yyval)->PushSubExpression( like );
+            yyval = new swq_expr_node( SWQ_NOT );
+            yyval->field_type = SWQ_BOOLEAN;
+            yyval->PushSubExpression( like );
         }
-#line 1679 "swq_parser.cpp" /* yacc.c:1646  */
+#line 1875 "swq_parser.cpp"
     break;
 
-  case 20:
-#line 246 "swq_parser.y" /* yacc.c:1646  */
-    {
-            (yyval) = new swq_expr_node( SWQ_LIKE );
-            (yyval)->field_type = SWQ_BOOLEAN;
-            (yyval)->PushSubExpression( (yyvsp[-4]) );
-            (yyval)->PushSubExpression( (yyvsp[-2]) );
-            (yyval)->PushSubExpression( (yyvsp[0]) );
+  case 20: /* value_expr: value_expr "LIKE" value_expr "ESCAPE" value_expr  */
+#line 249 "swq_parser.y"
+        {
+            yyval = new swq_expr_node( SWQ_LIKE );
+            yyval->field_type = SWQ_BOOLEAN;
+            yyval->PushSubExpression( yyvsp[-4] );
+            yyval->PushSubExpression( yyvsp[-2] );
+            yyval->PushSubExpression( yyvsp[0] );
         }
-#line 1691 "swq_parser.cpp" /* yacc.c:1646  */
+#line 1887 "swq_parser.cpp"
     break;
 
-  case 21:
-#line 255 "swq_parser.y" /* yacc.c:1646  */
-    {
+  case 21: /* value_expr: value_expr "NOT" "LIKE" value_expr "ESCAPE" value_expr  */
+#line 258 "swq_parser.y"
+        {
             swq_expr_node *like;
             like = new swq_expr_node( SWQ_LIKE );
             like->field_type = SWQ_BOOLEAN;
-            like->PushSubExpression( (yyvsp[-5]) );
-            like->PushSubExpression( (yyvsp[-2]) );
-            like->PushSubExpression( (yyvsp[0]) );
+            like->PushSubExpression( yyvsp[-5] );
+            like->PushSubExpression( yyvsp[-2] );
+            like->PushSubExpression( yyvsp[0] );
 
-            (yyval) = new swq_expr_node( SWQ_NOT );
-            (yyval)->field_type = SWQ_BOOLEAN;
-            (yyval)->PushSubExpression( like );
+            yyval = new swq_expr_node( SWQ_NOT );
+            yyval->field_type = SWQ_BOOLEAN;
+            yyval->PushSubExpression( like );
         }
-#line 1708 "swq_parser.cpp" /* yacc.c:1646  */
+#line 1904 "swq_parser.cpp"
     break;
 
-  case 22:
-#line 269 "swq_parser.y" /* yacc.c:1646  */
-    {
-            (yyval) = (yyvsp[-1]);
-            (yyval)->field_type = SWQ_BOOLEAN;
-            (yyval)->nOperation = SWQ_IN;
-            (yyval)->PushSubExpression( (yyvsp[-4]) );
-            (yyval)->ReverseSubExpressions();
+  case 22: /* value_expr: value_expr "IN" '(' value_expr_list ')'  */
+#line 272 "swq_parser.y"
+        {
+            yyval = yyvsp[-1];
+            yyval->field_type = SWQ_BOOLEAN;
+            yyval->nOperation = SWQ_IN;
+            yyval->PushSubExpression( yyvsp[-4] );
+            yyval->ReverseSubExpressions();
         }
-#line 1720 "swq_parser.cpp" /* yacc.c:1646  */
+#line 1916 "swq_parser.cpp"
     break;
 
-  case 23:
-#line 278 "swq_parser.y" /* yacc.c:1646  */
-    {
+  case 23: /* value_expr: value_expr "NOT" "IN" '(' value_expr_list ')'  */
+#line 281 "swq_parser.y"
+        {
             swq_expr_node *in;
 
-            in = (yyvsp[-1]);
+            in = yyvsp[-1];
             in->field_type = SWQ_BOOLEAN;
             in->nOperation = SWQ_IN;
-            in->PushSubExpression( (yyvsp[-5]) );
+            in->PushSubExpression( yyvsp[-5] );
             in->ReverseSubExpressions();
 
-            (yyval) = new swq_expr_node( SWQ_NOT );
-            (yyval)->field_type = SWQ_BOOLEAN;
-            (yyval)->PushSubExpression( in );
+            yyval = new swq_expr_node( SWQ_NOT );
+            yyval->field_type = SWQ_BOOLEAN;
+            yyval->PushSubExpression( in );
         }
-#line 1738 "swq_parser.cpp" /* yacc.c:1646  */
+#line 1934 "swq_parser.cpp"
     break;
 
-  case 24:
-#line 293 "swq_parser.y" /* yacc.c:1646  */
-    {
-            (yyval) = new swq_expr_node( SWQ_BETWEEN );
-            (yyval)->field_type = SWQ_BOOLEAN;
-            (yyval)->PushSubExpression( (yyvsp[-4]) );
-            (yyval)->PushSubExpression( (yyvsp[-2]) );
-            (yyval)->PushSubExpression( (yyvsp[0]) );
+  case 24: /* value_expr: value_expr "BETWEEN" value_expr_non_logical "AND" value_expr_non_logical  */
+#line 296 "swq_parser.y"
+        {
+            yyval = new swq_expr_node( SWQ_BETWEEN );
+            yyval->field_type = SWQ_BOOLEAN;
+            yyval->PushSubExpression( yyvsp[-4] );
+            yyval->PushSubExpression( yyvsp[-2] );
+            yyval->PushSubExpression( yyvsp[0] );
         }
-#line 1750 "swq_parser.cpp" /* yacc.c:1646  */
+#line 1946 "swq_parser.cpp"
     break;
 
-  case 25:
-#line 302 "swq_parser.y" /* yacc.c:1646  */
-    {
+  case 25: /* value_expr: value_expr "NOT" "BETWEEN" value_expr_non_logical "AND" value_expr_non_logical  */
+#line 305 "swq_parser.y"
+        {
             swq_expr_node *between;
             between = new swq_expr_node( SWQ_BETWEEN );
             between->field_type = SWQ_BOOLEAN;
-            between->PushSubExpression( (yyvsp[-5]) );
-            between->PushSubExpression( (yyvsp[-2]) );
-            between->PushSubExpression( (yyvsp[0]) );
+            between->PushSubExpression( yyvsp[-5] );
+            between->PushSubExpression( yyvsp[-2] );
+            between->PushSubExpression( yyvsp[0] );
 
-            (yyval) = new swq_expr_node( SWQ_NOT );
-            (yyval)->field_type = SWQ_BOOLEAN;
-            (yyval)->PushSubExpression( between );
+            yyval = new swq_expr_node( SWQ_NOT );
+            yyval->field_type = SWQ_BOOLEAN;
+            yyval->PushSubExpression( between );
         }
-#line 1767 "swq_parser.cpp" /* yacc.c:1646  */
+#line 1963 "swq_parser.cpp"
     break;
 
-  case 26:
-#line 316 "swq_parser.y" /* yacc.c:1646  */
-    {
-            (yyval) = new swq_expr_node( SWQ_ISNULL );
-            (yyval)->field_type = SWQ_BOOLEAN;
-            (yyval)->PushSubExpression( (yyvsp[-2]) );
+  case 26: /* value_expr: value_expr "IS" "NULL"  */
+#line 319 "swq_parser.y"
+        {
+            yyval = new swq_expr_node( SWQ_ISNULL );
+            yyval->field_type = SWQ_BOOLEAN;
+            yyval->PushSubExpression( yyvsp[-2] );
         }
-#line 1777 "swq_parser.cpp" /* yacc.c:1646  */
+#line 1973 "swq_parser.cpp"
     break;
 
-  case 27:
-#line 323 "swq_parser.y" /* yacc.c:1646  */
-    {
+  case 27: /* value_expr: value_expr "IS" "NOT" "NULL"  */
+#line 326 "swq_parser.y"
+        {
         swq_expr_node *isnull;
 
             isnull = new swq_expr_node( SWQ_ISNULL );
             isnull->field_type = SWQ_BOOLEAN;
-            isnull->PushSubExpression( (yyvsp[-3]) );
+            isnull->PushSubExpression( yyvsp[-3] );
 
-            (yyval) = new swq_expr_node( SWQ_NOT );
-            (yyval)->field_type = SWQ_BOOLEAN;
-            (yyval)->PushSubExpression( isnull );
+            yyval = new swq_expr_node( SWQ_NOT );
+            yyval->field_type = SWQ_BOOLEAN;
+            yyval->PushSubExpression( isnull );
         }
-#line 1793 "swq_parser.cpp" /* yacc.c:1646  */
+#line 1989 "swq_parser.cpp"
     break;
 
-  case 28:
-#line 337 "swq_parser.y" /* yacc.c:1646  */
-    {
-            (yyval) = (yyvsp[0]);
-            (yyvsp[0])->PushSubExpression( (yyvsp[-2]) );
+  case 28: /* value_expr_list: value_expr ',' value_expr_list  */
+#line 340 "swq_parser.y"
+        {
+            yyval = yyvsp[0];
+            yyvsp[0]->PushSubExpression( yyvsp[-2] );
         }
-#line 1802 "swq_parser.cpp" /* yacc.c:1646  */
+#line 1998 "swq_parser.cpp"
     break;
 
-  case 29:
-#line 343 "swq_parser.y" /* yacc.c:1646  */
-    {
-            (yyval) = new swq_expr_node( SWQ_ARGUMENT_LIST ); /* temporary value */
-            (yyval)->PushSubExpression( (yyvsp[0]) );
+  case 29: /* value_expr_list: value_expr  */
+#line 346 "swq_parser.y"
+            {
+            yyval = new swq_expr_node( SWQ_ARGUMENT_LIST ); /* temporary value */
+            yyval->PushSubExpression( yyvsp[0] );
         }
-#line 1811 "swq_parser.cpp" /* yacc.c:1646  */
+#line 2007 "swq_parser.cpp"
     break;
 
-  case 30:
-#line 350 "swq_parser.y" /* yacc.c:1646  */
-    {
-            (yyval) = (yyvsp[0]);  // validation deferred.
-            (yyval)->eNodeType = SNT_COLUMN;
-            (yyval)->field_index = (yyval)->table_index = -1;
+  case 30: /* field_value: "identifier"  */
+#line 353 "swq_parser.y"
+        {
+            yyval = yyvsp[0];  // validation deferred.
+            yyval->eNodeType = SNT_COLUMN;
+            yyval->field_index = yyval->table_index = -1;
         }
-#line 1821 "swq_parser.cpp" /* yacc.c:1646  */
+#line 2017 "swq_parser.cpp"
     break;
 
-  case 31:
-#line 357 "swq_parser.y" /* yacc.c:1646  */
-    {
-            (yyval) = (yyvsp[-2]);  // validation deferred.
-            (yyval)->eNodeType = SNT_COLUMN;
-            (yyval)->field_index = (yyval)->table_index = -1;
-            (yyval)->table_name = (yyval)->string_value;
-            (yyval)->string_value = CPLStrdup((yyvsp[0])->string_value);
-            delete (yyvsp[0]);
-            (yyvsp[0]) = NULL;
+  case 31: /* field_value: "identifier" '.' "identifier"  */
+#line 360 "swq_parser.y"
+        {
+            yyval = yyvsp[-2];  // validation deferred.
+            yyval->eNodeType = SNT_COLUMN;
+            yyval->field_index = yyval->table_index = -1;
+            yyval->table_name = yyval->string_value;
+            yyval->string_value = CPLStrdup(yyvsp[0]->string_value);
+            delete yyvsp[0];
+            yyvsp[0] = NULL;
         }
-#line 1835 "swq_parser.cpp" /* yacc.c:1646  */
+#line 2031 "swq_parser.cpp"
     break;
 
-  case 32:
-#line 369 "swq_parser.y" /* yacc.c:1646  */
-    {
-            (yyval) = (yyvsp[0]);
+  case 32: /* value_expr_non_logical: "integer number"  */
+#line 372 "swq_parser.y"
+        {
+            yyval = yyvsp[0];
         }
-#line 1843 "swq_parser.cpp" /* yacc.c:1646  */
+#line 2039 "swq_parser.cpp"
     break;
 
-  case 33:
-#line 374 "swq_parser.y" /* yacc.c:1646  */
-    {
-            (yyval) = (yyvsp[0]);
+  case 33: /* value_expr_non_logical: "floating point number"  */
+#line 377 "swq_parser.y"
+        {
+            yyval = yyvsp[0];
         }
-#line 1851 "swq_parser.cpp" /* yacc.c:1646  */
+#line 2047 "swq_parser.cpp"
     break;
 
-  case 34:
-#line 379 "swq_parser.y" /* yacc.c:1646  */
-    {
-            (yyval) = (yyvsp[0]);
+  case 34: /* value_expr_non_logical: "string"  */
+#line 382 "swq_parser.y"
+        {
+            yyval = yyvsp[0];
         }
-#line 1859 "swq_parser.cpp" /* yacc.c:1646  */
+#line 2055 "swq_parser.cpp"
     break;
 
-  case 35:
-#line 383 "swq_parser.y" /* yacc.c:1646  */
-    {
-            (yyval) = (yyvsp[0]);
+  case 35: /* value_expr_non_logical: field_value  */
+#line 386 "swq_parser.y"
+        {
+            yyval = yyvsp[0];
         }
-#line 1867 "swq_parser.cpp" /* yacc.c:1646  */
+#line 2063 "swq_parser.cpp"
     break;
 
-  case 36:
-#line 388 "swq_parser.y" /* yacc.c:1646  */
-    {
-            (yyval) = (yyvsp[-1]);
+  case 36: /* value_expr_non_logical: '(' value_expr ')'  */
+#line 391 "swq_parser.y"
+        {
+            yyval = yyvsp[-1];
         }
-#line 1875 "swq_parser.cpp" /* yacc.c:1646  */
+#line 2071 "swq_parser.cpp"
     break;
 
-  case 37:
-#line 393 "swq_parser.y" /* yacc.c:1646  */
-    {
-            (yyval) = new swq_expr_node((const char*)NULL);
+  case 37: /* value_expr_non_logical: "NULL"  */
+#line 396 "swq_parser.y"
+        {
+            yyval = new swq_expr_node((const char*)NULL);
         }
-#line 1883 "swq_parser.cpp" /* yacc.c:1646  */
+#line 2079 "swq_parser.cpp"
     break;
 
-  case 38:
-#line 398 "swq_parser.y" /* yacc.c:1646  */
-    {
-            if ((yyvsp[0])->eNodeType == SNT_CONSTANT)
+  case 38: /* value_expr_non_logical: '-' value_expr_non_logical  */
+#line 401 "swq_parser.y"
+        {
+            if (yyvsp[0]->eNodeType == SNT_CONSTANT)
             {
-                (yyval) = (yyvsp[0]);
-                (yyval)->int_value *= -1;
-                (yyval)->float_value *= -1;
+                yyval = yyvsp[0];
+                yyval->int_value *= -1;
+                yyval->float_value *= -1;
             }
             else
             {
-                (yyval) = new swq_expr_node( SWQ_MULTIPLY );
-                (yyval)->PushSubExpression( new swq_expr_node(-1) );
-                (yyval)->PushSubExpression( (yyvsp[0]) );
+                yyval = new swq_expr_node( SWQ_MULTIPLY );
+                yyval->PushSubExpression( new swq_expr_node(-1) );
+                yyval->PushSubExpression( yyvsp[0] );
             }
         }
-#line 1902 "swq_parser.cpp" /* yacc.c:1646  */
+#line 2098 "swq_parser.cpp"
     break;
 
-  case 39:
-#line 414 "swq_parser.y" /* yacc.c:1646  */
-    {
-            (yyval) = new swq_expr_node( SWQ_ADD );
-            (yyval)->PushSubExpression( (yyvsp[-2]) );
-            (yyval)->PushSubExpression( (yyvsp[0]) );
+  case 39: /* value_expr_non_logical: value_expr_non_logical '+' value_expr_non_logical  */
+#line 417 "swq_parser.y"
+        {
+            yyval = new swq_expr_node( SWQ_ADD );
+            yyval->PushSubExpression( yyvsp[-2] );
+            yyval->PushSubExpression( yyvsp[0] );
         }
-#line 1912 "swq_parser.cpp" /* yacc.c:1646  */
+#line 2108 "swq_parser.cpp"
     break;
 
-  case 40:
-#line 421 "swq_parser.y" /* yacc.c:1646  */
-    {
-            (yyval) = new swq_expr_node( SWQ_SUBTRACT );
-            (yyval)->PushSubExpression( (yyvsp[-2]) );
-            (yyval)->PushSubExpression( (yyvsp[0]) );
+  case 40: /* value_expr_non_logical: value_expr_non_logical '-' value_expr_non_logical  */
+#line 424 "swq_parser.y"
+        {
+            yyval = new swq_expr_node( SWQ_SUBTRACT );
+            yyval->PushSubExpression( yyvsp[-2] );
+            yyval->PushSubExpression( yyvsp[0] );
         }
-#line 1922 "swq_parser.cpp" /* yacc.c:1646  */
+#line 2118 "swq_parser.cpp"
     break;
 
-  case 41:
-#line 428 "swq_parser.y" /* yacc.c:1646  */
-    {
-            (yyval) = new swq_expr_node( SWQ_MULTIPLY );
-            (yyval)->PushSubExpression( (yyvsp[-2]) );
-            (yyval)->PushSubExpression( (yyvsp[0]) );
+  case 41: /* value_expr_non_logical: value_expr_non_logical '*' value_expr_non_logical  */
+#line 431 "swq_parser.y"
+        {
+            yyval = new swq_expr_node( SWQ_MULTIPLY );
+            yyval->PushSubExpression( yyvsp[-2] );
+            yyval->PushSubExpression( yyvsp[0] );
         }
-#line 1932 "swq_parser.cpp" /* yacc.c:1646  */
+#line 2128 "swq_parser.cpp"
     break;
 
-  case 42:
-#line 435 "swq_parser.y" /* yacc.c:1646  */
-    {
-            (yyval) = new swq_expr_node( SWQ_DIVIDE );
-            (yyval)->PushSubExpression( (yyvsp[-2]) );
-            (yyval)->PushSubExpression( (yyvsp[0]) );
+  case 42: /* value_expr_non_logical: value_expr_non_logical '/' value_expr_non_logical  */
+#line 438 "swq_parser.y"
+        {
+            yyval = new swq_expr_node( SWQ_DIVIDE );
+            yyval->PushSubExpression( yyvsp[-2] );
+            yyval->PushSubExpression( yyvsp[0] );
         }
-#line 1942 "swq_parser.cpp" /* yacc.c:1646  */
+#line 2138 "swq_parser.cpp"
     break;
 
-  case 43:
-#line 442 "swq_parser.y" /* yacc.c:1646  */
-    {
-            (yyval) = new swq_expr_node( SWQ_MODULUS );
-            (yyval)->PushSubExpression( (yyvsp[-2]) );
-            (yyval)->PushSubExpression( (yyvsp[0]) );
+  case 43: /* value_expr_non_logical: value_expr_non_logical '%' value_expr_non_logical  */
+#line 445 "swq_parser.y"
+        {
+            yyval = new swq_expr_node( SWQ_MODULUS );
+            yyval->PushSubExpression( yyvsp[-2] );
+            yyval->PushSubExpression( yyvsp[0] );
         }
-#line 1952 "swq_parser.cpp" /* yacc.c:1646  */
+#line 2148 "swq_parser.cpp"
     break;
 
-  case 44:
-#line 449 "swq_parser.y" /* yacc.c:1646  */
-    {
+  case 44: /* value_expr_non_logical: "identifier" '(' value_expr_list ')'  */
+#line 452 "swq_parser.y"
+        {
             const swq_operation *poOp =
-                    swq_op_registrar::GetOperator( (yyvsp[-3])->string_value );
+                    swq_op_registrar::GetOperator( yyvsp[-3]->string_value );
 
             if( poOp == NULL )
             {
                 if( context->bAcceptCustomFuncs )
                 {
-                    (yyval) = (yyvsp[-1]);
-                    (yyval)->eNodeType = SNT_OPERATION;
-                    (yyval)->nOperation = SWQ_CUSTOM_FUNC;
-                    (yyval)->string_value = CPLStrdup((yyvsp[-3])->string_value);
-                    (yyval)->ReverseSubExpressions();
-                    delete (yyvsp[-3]);
+                    yyval = yyvsp[-1];
+                    yyval->eNodeType = SNT_OPERATION;
+                    yyval->nOperation = SWQ_CUSTOM_FUNC;
+                    yyval->string_value = CPLStrdup(yyvsp[-3]->string_value);
+                    yyval->ReverseSubExpressions();
+                    delete yyvsp[-3];
                 }
                 else
                 {
                     CPLError( CE_Failure, CPLE_AppDefined,
                                     "Undefined function '%s' used.",
-                                    (yyvsp[-3])->string_value );
-                    delete (yyvsp[-3]);
-                    delete (yyvsp[-1]);
+                                    yyvsp[-3]->string_value );
+                    delete yyvsp[-3];
+                    delete yyvsp[-1];
                     YYERROR;
                 }
             }
             else
             {
-                (yyval) = (yyvsp[-1]);
-                (yyval)->eNodeType = SNT_OPERATION;
-                (yyval)->nOperation = poOp->eOperation;
-                (yyval)->ReverseSubExpressions();
-                delete (yyvsp[-3]);
+                yyval = yyvsp[-1];
+                yyval->eNodeType = SNT_OPERATION;
+                yyval->nOperation = poOp->eOperation;
+                yyval->ReverseSubExpressions();
+                delete yyvsp[-3];
             }
         }
-#line 1991 "swq_parser.cpp" /* yacc.c:1646  */
+#line 2187 "swq_parser.cpp"
     break;
 
-  case 45:
-#line 485 "swq_parser.y" /* yacc.c:1646  */
-    {
-            (yyval) = (yyvsp[-1]);
-            (yyval)->PushSubExpression( (yyvsp[-3]) );
-            (yyval)->ReverseSubExpressions();
+  case 45: /* value_expr_non_logical: "CAST" '(' value_expr "AS" type_def ')'  */
+#line 488 "swq_parser.y"
+        {
+            yyval = yyvsp[-1];
+            yyval->PushSubExpression( yyvsp[-3] );
+            yyval->ReverseSubExpressions();
         }
-#line 2001 "swq_parser.cpp" /* yacc.c:1646  */
+#line 2197 "swq_parser.cpp"
     break;
 
-  case 46:
-#line 493 "swq_parser.y" /* yacc.c:1646  */
+  case 46: /* type_def: "identifier"  */
+#line 496 "swq_parser.y"
     {
-        (yyval) = new swq_expr_node( SWQ_CAST );
-        (yyval)->PushSubExpression( (yyvsp[0]) );
+        yyval = new swq_expr_node( SWQ_CAST );
+        yyval->PushSubExpression( yyvsp[0] );
     }
-#line 2010 "swq_parser.cpp" /* yacc.c:1646  */
+#line 2206 "swq_parser.cpp"
     break;
 
-  case 47:
-#line 499 "swq_parser.y" /* yacc.c:1646  */
+  case 47: /* type_def: "identifier" '(' "integer number" ')'  */
+#line 502 "swq_parser.y"
     {
-        (yyval) = new swq_expr_node( SWQ_CAST );
-        (yyval)->PushSubExpression( (yyvsp[-1]) );
-        (yyval)->PushSubExpression( (yyvsp[-3]) );
+        yyval = new swq_expr_node( SWQ_CAST );
+        yyval->PushSubExpression( yyvsp[-1] );
+        yyval->PushSubExpression( yyvsp[-3] );
     }
-#line 2020 "swq_parser.cpp" /* yacc.c:1646  */
+#line 2216 "swq_parser.cpp"
     break;
 
-  case 48:
-#line 506 "swq_parser.y" /* yacc.c:1646  */
+  case 48: /* type_def: "identifier" '(' "integer number" ',' "integer number" ')'  */
+#line 509 "swq_parser.y"
     {
-        (yyval) = new swq_expr_node( SWQ_CAST );
-        (yyval)->PushSubExpression( (yyvsp[-1]) );
-        (yyval)->PushSubExpression( (yyvsp[-3]) );
-        (yyval)->PushSubExpression( (yyvsp[-5]) );
+        yyval = new swq_expr_node( SWQ_CAST );
+        yyval->PushSubExpression( yyvsp[-1] );
+        yyval->PushSubExpression( yyvsp[-3] );
+        yyval->PushSubExpression( yyvsp[-5] );
     }
-#line 2031 "swq_parser.cpp" /* yacc.c:1646  */
+#line 2227 "swq_parser.cpp"
     break;
 
-  case 49:
-#line 515 "swq_parser.y" /* yacc.c:1646  */
+  case 49: /* type_def: "identifier" '(' "identifier" ')'  */
+#line 518 "swq_parser.y"
     {
-        OGRwkbGeometryType eType = OGRFromOGCGeomType((yyvsp[-1])->string_value);
-        if( !EQUAL((yyvsp[-3])->string_value,"GEOMETRY") ||
+        OGRwkbGeometryType eType = OGRFromOGCGeomType(yyvsp[-1]->string_value);
+        if( !EQUAL(yyvsp[-3]->string_value,"GEOMETRY") ||
             (wkbFlatten(eType) == wkbUnknown &&
-            !STARTS_WITH_CI((yyvsp[-1])->string_value, "GEOMETRY")) )
+            !STARTS_WITH_CI(yyvsp[-1]->string_value, "GEOMETRY")) )
         {
             yyerror (context, "syntax error");
-            delete (yyvsp[-3]);
-            delete (yyvsp[-1]);
+            delete yyvsp[-3];
+            delete yyvsp[-1];
             YYERROR;
         }
-        (yyval) = new swq_expr_node( SWQ_CAST );
-        (yyval)->PushSubExpression( (yyvsp[-1]) );
-        (yyval)->PushSubExpression( (yyvsp[-3]) );
+        yyval = new swq_expr_node( SWQ_CAST );
+        yyval->PushSubExpression( yyvsp[-1] );
+        yyval->PushSubExpression( yyvsp[-3] );
     }
-#line 2051 "swq_parser.cpp" /* yacc.c:1646  */
+#line 2247 "swq_parser.cpp"
     break;
 
-  case 50:
-#line 533 "swq_parser.y" /* yacc.c:1646  */
+  case 50: /* type_def: "identifier" '(' "identifier" ',' "integer number" ')'  */
+#line 536 "swq_parser.y"
     {
-        OGRwkbGeometryType eType = OGRFromOGCGeomType((yyvsp[-3])->string_value);
-        if( !EQUAL((yyvsp[-5])->string_value,"GEOMETRY") ||
+        OGRwkbGeometryType eType = OGRFromOGCGeomType(yyvsp[-3]->string_value);
+        if( !EQUAL(yyvsp[-5]->string_value,"GEOMETRY") ||
             (wkbFlatten(eType) == wkbUnknown &&
-            !STARTS_WITH_CI((yyvsp[-3])->string_value, "GEOMETRY")) )
+            !STARTS_WITH_CI(yyvsp[-3]->string_value, "GEOMETRY")) )
         {
             yyerror (context, "syntax error");
-            delete (yyvsp[-5]);
-            delete (yyvsp[-3]);
-            delete (yyvsp[-1]);
+            delete yyvsp[-5];
+            delete yyvsp[-3];
+            delete yyvsp[-1];
             YYERROR;
         }
-        (yyval) = new swq_expr_node( SWQ_CAST );
-        (yyval)->PushSubExpression( (yyvsp[-1]) );
-        (yyval)->PushSubExpression( (yyvsp[-3]) );
-        (yyval)->PushSubExpression( (yyvsp[-5]) );
+        yyval = new swq_expr_node( SWQ_CAST );
+        yyval->PushSubExpression( yyvsp[-1] );
+        yyval->PushSubExpression( yyvsp[-3] );
+        yyval->PushSubExpression( yyvsp[-5] );
     }
-#line 2073 "swq_parser.cpp" /* yacc.c:1646  */
+#line 2269 "swq_parser.cpp"
     break;
 
-  case 53:
-#line 557 "swq_parser.y" /* yacc.c:1646  */
+  case 53: /* select_core: "SELECT" select_field_list "FROM" table_def opt_joins opt_where opt_group_by opt_order_by opt_limit  */
+#line 560 "swq_parser.y"
     {
-        delete (yyvsp[-3]);
+        delete yyvsp[-5];
     }
-#line 2081 "swq_parser.cpp" /* yacc.c:1646  */
+#line 2277 "swq_parser.cpp"
     break;
 
-  case 54:
-#line 562 "swq_parser.y" /* yacc.c:1646  */
+  case 54: /* select_core: "SELECT" "DISTINCT" select_field_list "FROM" table_def opt_joins opt_where opt_group_by opt_order_by opt_limit  */
+#line 565 "swq_parser.y"
     {
         context->poCurSelect->query_mode = SWQM_DISTINCT_LIST;
-        delete (yyvsp[-3]);
+        delete yyvsp[-5];
     }
-#line 2090 "swq_parser.cpp" /* yacc.c:1646  */
+#line 2286 "swq_parser.cpp"
     break;
 
-  case 57:
-#line 571 "swq_parser.y" /* yacc.c:1646  */
+  case 57: /* union_all: "UNION" "ALL"  */
+#line 574 "swq_parser.y"
     {
         swq_select* poNewSelect = new swq_select();
         context->poCurSelect->PushUnionAll(poNewSelect);
         context->poCurSelect = poNewSelect;
     }
-#line 2100 "swq_parser.cpp" /* yacc.c:1646  */
+#line 2296 "swq_parser.cpp"
     break;
 
-  case 60:
-#line 583 "swq_parser.y" /* yacc.c:1646  */
-    {
-            if( !context->poCurSelect->PushField( (yyvsp[0]) ) )
+  case 60: /* column_spec: value_expr  */
+#line 586 "swq_parser.y"
+        {
+            if( !context->poCurSelect->PushField( yyvsp[0] ) )
             {
-                delete (yyvsp[0]);
+                delete yyvsp[0];
                 YYERROR;
             }
         }
-#line 2112 "swq_parser.cpp" /* yacc.c:1646  */
+#line 2308 "swq_parser.cpp"
     break;
 
-  case 61:
-#line 592 "swq_parser.y" /* yacc.c:1646  */
-    {
-            if( !context->poCurSelect->PushField( (yyvsp[-1]), (yyvsp[0])->string_value ) )
+  case 61: /* column_spec: value_expr as_clause  */
+#line 595 "swq_parser.y"
+        {
+            if( !context->poCurSelect->PushField( yyvsp[-1], yyvsp[0]->string_value ) )
             {
-                delete (yyvsp[-1]);
-                delete (yyvsp[0]);
+                delete yyvsp[-1];
+                delete yyvsp[0];
                 YYERROR;
             }
-            delete (yyvsp[0]);
+            delete yyvsp[0];
         }
-#line 2126 "swq_parser.cpp" /* yacc.c:1646  */
+#line 2322 "swq_parser.cpp"
     break;
 
-  case 62:
-#line 603 "swq_parser.y" /* yacc.c:1646  */
-    {
+  case 62: /* column_spec: '*'  */
+#line 606 "swq_parser.y"
+        {
             swq_expr_node *poNode = new swq_expr_node();
             poNode->eNodeType = SNT_COLUMN;
             poNode->string_value = CPLStrdup( "*" );
@@ -2141,18 +2335,18 @@ yyreduce:
                 YYERROR;
             }
         }
-#line 2143 "swq_parser.cpp" /* yacc.c:1646  */
+#line 2339 "swq_parser.cpp"
     break;
 
-  case 63:
-#line 617 "swq_parser.y" /* yacc.c:1646  */
-    {
+  case 63: /* column_spec: "identifier" '.' '*'  */
+#line 620 "swq_parser.y"
+        {
             CPLString osTableName;
 
-            osTableName = (yyvsp[-2])->string_value;
+            osTableName = yyvsp[-2]->string_value;
 
-            delete (yyvsp[-2]);
-            (yyvsp[-2]) = NULL;
+            delete yyvsp[-2];
+            yyvsp[-2] = NULL;
 
             swq_expr_node *poNode = new swq_expr_node();
             poNode->eNodeType = SNT_COLUMN;
@@ -2166,24 +2360,24 @@ yyreduce:
                 YYERROR;
             }
         }
-#line 2168 "swq_parser.cpp" /* yacc.c:1646  */
+#line 2364 "swq_parser.cpp"
     break;
 
-  case 64:
-#line 639 "swq_parser.y" /* yacc.c:1646  */
-    {
+  case 64: /* column_spec: "identifier" '(' '*' ')'  */
+#line 642 "swq_parser.y"
+        {
                 // special case for COUNT(*), confirm it.
-            if( !EQUAL((yyvsp[-3])->string_value,"COUNT") )
+            if( !EQUAL(yyvsp[-3]->string_value,"COUNT") )
             {
                 CPLError( CE_Failure, CPLE_AppDefined,
                         "Syntax Error with %s(*).",
-                        (yyvsp[-3])->string_value );
-                delete (yyvsp[-3]);
+                        yyvsp[-3]->string_value );
+                delete yyvsp[-3];
                 YYERROR;
             }
 
-            delete (yyvsp[-3]);
-            (yyvsp[-3]) = NULL;
+            delete yyvsp[-3];
+            yyvsp[-3] = NULL;
 
             swq_expr_node *poNode = new swq_expr_node();
             poNode->eNodeType = SNT_COLUMN;
@@ -2199,25 +2393,25 @@ yyreduce:
                 YYERROR;
             }
         }
-#line 2201 "swq_parser.cpp" /* yacc.c:1646  */
+#line 2397 "swq_parser.cpp"
     break;
 
-  case 65:
-#line 669 "swq_parser.y" /* yacc.c:1646  */
-    {
+  case 65: /* column_spec: "identifier" '(' '*' ')' as_clause  */
+#line 672 "swq_parser.y"
+        {
                 // special case for COUNT(*), confirm it.
-            if( !EQUAL((yyvsp[-4])->string_value,"COUNT") )
+            if( !EQUAL(yyvsp[-4]->string_value,"COUNT") )
             {
                 CPLError( CE_Failure, CPLE_AppDefined,
                         "Syntax Error with %s(*).",
-                        (yyvsp[-4])->string_value );
-                delete (yyvsp[-4]);
-                delete (yyvsp[0]);
+                        yyvsp[-4]->string_value );
+                delete yyvsp[-4];
+                delete yyvsp[0];
                 YYERROR;
             }
 
-            delete (yyvsp[-4]);
-            (yyvsp[-4]) = NULL;
+            delete yyvsp[-4];
+            yyvsp[-4] = NULL;
 
             swq_expr_node *poNode = new swq_expr_node();
             poNode->eNodeType = SNT_COLUMN;
@@ -2227,35 +2421,35 @@ yyreduce:
             swq_expr_node *count = new swq_expr_node( (swq_op)SWQ_COUNT );
             count->PushSubExpression( poNode );
 
-            if( !context->poCurSelect->PushField( count, (yyvsp[0])->string_value ) )
+            if( !context->poCurSelect->PushField( count, yyvsp[0]->string_value ) )
             {
                 delete count;
-                delete (yyvsp[0]);
+                delete yyvsp[0];
                 YYERROR;
             }
 
-            delete (yyvsp[0]);
+            delete yyvsp[0];
         }
-#line 2238 "swq_parser.cpp" /* yacc.c:1646  */
+#line 2434 "swq_parser.cpp"
     break;
 
-  case 66:
-#line 703 "swq_parser.y" /* yacc.c:1646  */
-    {
+  case 66: /* column_spec: "identifier" '(' "DISTINCT" field_value ')'  */
+#line 706 "swq_parser.y"
+        {
                 // special case for COUNT(DISTINCT x), confirm it.
-            if( !EQUAL((yyvsp[-4])->string_value,"COUNT") )
+            if( !EQUAL(yyvsp[-4]->string_value,"COUNT") )
             {
                 CPLError( CE_Failure, CPLE_AppDefined,
                         "DISTINCT keyword can only be used in COUNT() operator." );
-                delete (yyvsp[-4]);
-                delete (yyvsp[-1]);
+                delete yyvsp[-4];
+                delete yyvsp[-1];
                     YYERROR;
             }
 
-            delete (yyvsp[-4]);
+            delete yyvsp[-4];
 
             swq_expr_node *count = new swq_expr_node( SWQ_COUNT );
-            count->PushSubExpression( (yyvsp[-1]) );
+            count->PushSubExpression( yyvsp[-1] );
 
             if( !context->poCurSelect->PushField( count, NULL, TRUE ) )
             {
@@ -2263,196 +2457,227 @@ yyreduce:
                 YYERROR;
             }
         }
-#line 2265 "swq_parser.cpp" /* yacc.c:1646  */
+#line 2461 "swq_parser.cpp"
     break;
 
-  case 67:
-#line 727 "swq_parser.y" /* yacc.c:1646  */
-    {
+  case 67: /* column_spec: "identifier" '(' "DISTINCT" field_value ')' as_clause  */
+#line 730 "swq_parser.y"
+        {
             // special case for COUNT(DISTINCT x), confirm it.
-            if( !EQUAL((yyvsp[-5])->string_value,"COUNT") )
+            if( !EQUAL(yyvsp[-5]->string_value,"COUNT") )
             {
                 CPLError( CE_Failure, CPLE_AppDefined,
                         "DISTINCT keyword can only be used in COUNT() operator." );
-                delete (yyvsp[-5]);
-                delete (yyvsp[-2]);
-                delete (yyvsp[0]);
+                delete yyvsp[-5];
+                delete yyvsp[-2];
+                delete yyvsp[0];
                 YYERROR;
             }
 
             swq_expr_node *count = new swq_expr_node( SWQ_COUNT );
-            count->PushSubExpression( (yyvsp[-2]) );
+            count->PushSubExpression( yyvsp[-2] );
 
-            if( !context->poCurSelect->PushField( count, (yyvsp[0])->string_value, TRUE ) )
+            if( !context->poCurSelect->PushField( count, yyvsp[0]->string_value, TRUE ) )
             {
-                delete (yyvsp[-5]);
+                delete yyvsp[-5];
                 delete count;
-                delete (yyvsp[0]);
+                delete yyvsp[0];
                 YYERROR;
             }
 
-            delete (yyvsp[-5]);
-            delete (yyvsp[0]);
+            delete yyvsp[-5];
+            delete yyvsp[0];
         }
-#line 2296 "swq_parser.cpp" /* yacc.c:1646  */
+#line 2492 "swq_parser.cpp"
     break;
 
-  case 68:
-#line 756 "swq_parser.y" /* yacc.c:1646  */
-    {
-            delete (yyvsp[-1]);
-            (yyval) = (yyvsp[0]);
+  case 68: /* as_clause: "AS" "identifier"  */
+#line 759 "swq_parser.y"
+        {
+            delete yyvsp[-1];
+            yyval = yyvsp[0];
         }
-#line 2305 "swq_parser.cpp" /* yacc.c:1646  */
+#line 2501 "swq_parser.cpp"
     break;
 
-  case 71:
-#line 766 "swq_parser.y" /* yacc.c:1646  */
-    {
-            context->poCurSelect->where_expr = (yyvsp[0]);
+  case 71: /* opt_where: "WHERE" value_expr  */
+#line 769 "swq_parser.y"
+        {
+            context->poCurSelect->where_expr = yyvsp[0];
         }
-#line 2313 "swq_parser.cpp" /* yacc.c:1646  */
+#line 2509 "swq_parser.cpp"
     break;
 
-  case 73:
-#line 772 "swq_parser.y" /* yacc.c:1646  */
-    {
-            context->poCurSelect->PushJoin( static_cast<int>((yyvsp[-3])->int_value),
-                                            (yyvsp[-1]) );
-            delete (yyvsp[-3]);
+  case 73: /* opt_joins: "JOIN" table_def "ON" value_expr opt_joins  */
+#line 775 "swq_parser.y"
+        {
+            context->poCurSelect->PushJoin( static_cast<int>(yyvsp[-3]->int_value),
+                                            yyvsp[-1] );
+            delete yyvsp[-3];
         }
-#line 2323 "swq_parser.cpp" /* yacc.c:1646  */
+#line 2519 "swq_parser.cpp"
     break;
 
-  case 74:
-#line 778 "swq_parser.y" /* yacc.c:1646  */
-    {
-            context->poCurSelect->PushJoin( static_cast<int>((yyvsp[-3])->int_value),
-                                            (yyvsp[-1]) );
-            delete (yyvsp[-3]);
+  case 74: /* opt_joins: "LEFT" "JOIN" table_def "ON" value_expr opt_joins  */
+#line 781 "swq_parser.y"
+        {
+            context->poCurSelect->PushJoin( static_cast<int>(yyvsp[-3]->int_value),
+                                            yyvsp[-1] );
+            delete yyvsp[-3];
 	    }
-#line 2333 "swq_parser.cpp" /* yacc.c:1646  */
+#line 2529 "swq_parser.cpp"
     break;
 
-  case 79:
-#line 793 "swq_parser.y" /* yacc.c:1646  */
-    {
-            context->poCurSelect->PushOrderBy( (yyvsp[0])->table_name, (yyvsp[0])->string_value, TRUE );
-            delete (yyvsp[0]);
-            (yyvsp[0]) = NULL;
+  case 79: /* group_spec: field_value  */
+#line 796 "swq_parser.y"
+        {
+            context->poCurSelect->PushGroupBy( yyvsp[0]->table_name, yyvsp[0]->string_value );
+            delete yyvsp[0];
+            yyvsp[0] = NULL;
         }
-#line 2343 "swq_parser.cpp" /* yacc.c:1646  */
+#line 2539 "swq_parser.cpp"
     break;
 
-  case 80:
-#line 799 "swq_parser.y" /* yacc.c:1646  */
-    {
-            context->poCurSelect->PushOrderBy( (yyvsp[-1])->table_name, (yyvsp[-1])->string_value, TRUE );
-            delete (yyvsp[-1]);
-            (yyvsp[-1]) = NULL;
+  case 83: /* opt_limit: "LIMIT" "integer number" opt_offset  */
+#line 807 "swq_parser.y"
+        {
+            context->poCurSelect->limit = yyvsp[-1]->int_value;
+            delete yyvsp[-1];
+            yyvsp[-1] = NULL;
         }
-#line 2353 "swq_parser.cpp" /* yacc.c:1646  */
+#line 2549 "swq_parser.cpp"
     break;
 
-  case 81:
-#line 805 "swq_parser.y" /* yacc.c:1646  */
-    {
-            context->poCurSelect->PushOrderBy( (yyvsp[-1])->table_name, (yyvsp[-1])->string_value, FALSE );
-            delete (yyvsp[-1]);
-            (yyvsp[-1]) = NULL;
+  case 85: /* opt_offset: "OFFSET" "integer number"  */
+#line 815 "swq_parser.y"
+        {
+            context->poCurSelect->offset = yyvsp[0]->int_value;
+            delete yyvsp[0];
+            yyvsp[0] = NULL;
         }
-#line 2363 "swq_parser.cpp" /* yacc.c:1646  */
+#line 2559 "swq_parser.cpp"
     break;
 
-  case 82:
-#line 813 "swq_parser.y" /* yacc.c:1646  */
+  case 88: /* sort_spec: field_value  */
+#line 827 "swq_parser.y"
+        {
+            context->poCurSelect->PushOrderBy( yyvsp[0]->table_name, yyvsp[0]->string_value, TRUE );
+            delete yyvsp[0];
+            yyvsp[0] = NULL;
+        }
+#line 2569 "swq_parser.cpp"
+    break;
+
+  case 89: /* sort_spec: field_value "ASC"  */
+#line 833 "swq_parser.y"
+        {
+            context->poCurSelect->PushOrderBy( yyvsp[-1]->table_name, yyvsp[-1]->string_value, TRUE );
+            delete yyvsp[-1];
+            yyvsp[-1] = NULL;
+        }
+#line 2579 "swq_parser.cpp"
+    break;
+
+  case 90: /* sort_spec: field_value "DESC"  */
+#line 839 "swq_parser.y"
+        {
+            context->poCurSelect->PushOrderBy( yyvsp[-1]->table_name, yyvsp[-1]->string_value, FALSE );
+            delete yyvsp[-1];
+            yyvsp[-1] = NULL;
+        }
+#line 2589 "swq_parser.cpp"
+    break;
+
+  case 91: /* table_def: "identifier"  */
+#line 847 "swq_parser.y"
     {
         int iTable;
-        iTable =context->poCurSelect->PushTableDef( NULL, (yyvsp[0])->string_value,
+        iTable =context->poCurSelect->PushTableDef( NULL, yyvsp[0]->string_value,
                                                     NULL );
-        delete (yyvsp[0]);
+        delete yyvsp[0];
 
-        (yyval) = new swq_expr_node( iTable );
+        yyval = new swq_expr_node( iTable );
     }
-#line 2376 "swq_parser.cpp" /* yacc.c:1646  */
+#line 2602 "swq_parser.cpp"
     break;
 
-  case 83:
-#line 823 "swq_parser.y" /* yacc.c:1646  */
+  case 92: /* table_def: "identifier" as_clause  */
+#line 857 "swq_parser.y"
     {
         int iTable;
-        iTable = context->poCurSelect->PushTableDef( NULL, (yyvsp[-1])->string_value,
-                                                     (yyvsp[0])->string_value );
-        delete (yyvsp[-1]);
-        delete (yyvsp[0]);
+        iTable = context->poCurSelect->PushTableDef( NULL, yyvsp[-1]->string_value,
+                                                     yyvsp[0]->string_value );
+        delete yyvsp[-1];
+        delete yyvsp[0];
 
-        (yyval) = new swq_expr_node( iTable );
+        yyval = new swq_expr_node( iTable );
     }
-#line 2390 "swq_parser.cpp" /* yacc.c:1646  */
+#line 2616 "swq_parser.cpp"
     break;
 
-  case 84:
-#line 834 "swq_parser.y" /* yacc.c:1646  */
+  case 93: /* table_def: "string" '.' "identifier"  */
+#line 868 "swq_parser.y"
     {
         int iTable;
-        iTable = context->poCurSelect->PushTableDef( (yyvsp[-2])->string_value,
-                                                     (yyvsp[0])->string_value, NULL );
-        delete (yyvsp[-2]);
-        delete (yyvsp[0]);
+        iTable = context->poCurSelect->PushTableDef( yyvsp[-2]->string_value,
+                                                     yyvsp[0]->string_value, NULL );
+        delete yyvsp[-2];
+        delete yyvsp[0];
 
-        (yyval) = new swq_expr_node( iTable );
+        yyval = new swq_expr_node( iTable );
     }
-#line 2404 "swq_parser.cpp" /* yacc.c:1646  */
+#line 2630 "swq_parser.cpp"
     break;
 
-  case 85:
-#line 845 "swq_parser.y" /* yacc.c:1646  */
+  case 94: /* table_def: "string" '.' "identifier" as_clause  */
+#line 879 "swq_parser.y"
     {
         int iTable;
-        iTable = context->poCurSelect->PushTableDef( (yyvsp[-3])->string_value,
-                                                     (yyvsp[-1])->string_value,
-                                                     (yyvsp[0])->string_value );
-        delete (yyvsp[-3]);
-        delete (yyvsp[-1]);
-        delete (yyvsp[0]);
-
-        (yyval) = new swq_expr_node( iTable );
+        iTable = context->poCurSelect->PushTableDef( yyvsp[-3]->string_value,
+                                                     yyvsp[-1]->string_value,
+                                                     yyvsp[0]->string_value );
+        delete yyvsp[-3];
+        delete yyvsp[-1];
+        delete yyvsp[0];
+
+        yyval = new swq_expr_node( iTable );
     }
-#line 2420 "swq_parser.cpp" /* yacc.c:1646  */
+#line 2646 "swq_parser.cpp"
     break;
 
-  case 86:
-#line 858 "swq_parser.y" /* yacc.c:1646  */
+  case 95: /* table_def: "identifier" '.' "identifier"  */
+#line 892 "swq_parser.y"
     {
         int iTable;
-        iTable = context->poCurSelect->PushTableDef( (yyvsp[-2])->string_value,
-                                                     (yyvsp[0])->string_value, NULL );
-        delete (yyvsp[-2]);
-        delete (yyvsp[0]);
+        iTable = context->poCurSelect->PushTableDef( yyvsp[-2]->string_value,
+                                                     yyvsp[0]->string_value, NULL );
+        delete yyvsp[-2];
+        delete yyvsp[0];
 
-        (yyval) = new swq_expr_node( iTable );
+        yyval = new swq_expr_node( iTable );
     }
-#line 2434 "swq_parser.cpp" /* yacc.c:1646  */
+#line 2660 "swq_parser.cpp"
     break;
 
-  case 87:
-#line 869 "swq_parser.y" /* yacc.c:1646  */
+  case 96: /* table_def: "identifier" '.' "identifier" as_clause  */
+#line 903 "swq_parser.y"
     {
         int iTable;
-        iTable = context->poCurSelect->PushTableDef( (yyvsp[-3])->string_value,
-                                                     (yyvsp[-1])->string_value,
-                                                     (yyvsp[0])->string_value );
-        delete (yyvsp[-3]);
-        delete (yyvsp[-1]);
-        delete (yyvsp[0]);
-
-        (yyval) = new swq_expr_node( iTable );
+        iTable = context->poCurSelect->PushTableDef( yyvsp[-3]->string_value,
+                                                     yyvsp[-1]->string_value,
+                                                     yyvsp[0]->string_value );
+        delete yyvsp[-3];
+        delete yyvsp[-1];
+        delete yyvsp[0];
+
+        yyval = new swq_expr_node( iTable );
     }
-#line 2450 "swq_parser.cpp" /* yacc.c:1646  */
+#line 2676 "swq_parser.cpp"
     break;
 
 
-#line 2454 "swq_parser.cpp" /* yacc.c:1646  */
+#line 2680 "swq_parser.cpp"
+
       default: break;
     }
   /* User semantic actions sometimes alter yychar, and that requires
@@ -2466,25 +2691,23 @@ yyreduce:
      case of YYERROR or YYBACKUP, subsequent parser actions might lead
      to an incorrect destructor call or verbose syntax error message
      before the lookahead is translated.  */
-  YY_SYMBOL_PRINT ("-> $$ =", yyr1[yyn], &yyval, &yyloc);
+  YY_SYMBOL_PRINT ("-> $$ =", YY_CAST (yysymbol_kind_t, yyr1[yyn]), &yyval, &yyloc);
 
   YYPOPSTACK (yylen);
   yylen = 0;
-  YY_STACK_PRINT (yyss, yyssp);
 
   *++yyvsp = yyval;
 
   /* Now 'shift' the result of the reduction.  Determine what state
      that goes to, based on the state we popped back to and the rule
      number reduced by.  */
-
-  yyn = yyr1[yyn];
-
-  yystate = yypgoto[yyn - YYNTOKENS] + *yyssp;
-  if (0 <= yystate && yystate <= YYLAST && yycheck[yystate] == *yyssp)
-    yystate = yytable[yystate];
-  else
-    yystate = yydefgoto[yyn - YYNTOKENS];
+  {
+    const int yylhs = yyr1[yyn] - YYNTOKENS;
+    const int yyi = yypgoto[yylhs] + *yyssp;
+    yystate = (0 <= yyi && yyi <= YYLAST && yycheck[yyi] == *yyssp
+               ? yytable[yyi]
+               : yydefgoto[yylhs]);
+  }
 
   goto yynewstate;
 
@@ -2495,59 +2718,53 @@ yyreduce:
 yyerrlab:
   /* Make sure we have latest lookahead translation.  See comments at
      user semantic actions for why this is necessary.  */
-  yytoken = yychar == YYEMPTY ? YYEMPTY : YYTRANSLATE (yychar);
-
+  yytoken = yychar == YYEMPTY ? YYSYMBOL_YYEMPTY : YYTRANSLATE (yychar);
   /* If not already recovering from an error, report this error.  */
   if (!yyerrstatus)
     {
       ++yynerrs;
-#if ! YYERROR_VERBOSE
-      yyerror (context, YY_("syntax error"));
-#else
-# define YYSYNTAX_ERROR yysyntax_error (&yymsg_alloc, &yymsg, \
-                                        yyssp, yytoken)
       {
+        yypcontext_t yyctx
+          = {yyssp, yytoken};
         char const *yymsgp = YY_("syntax error");
         int yysyntax_error_status;
-        yysyntax_error_status = YYSYNTAX_ERROR;
+        yysyntax_error_status = yysyntax_error (&yymsg_alloc, &yymsg, &yyctx);
         if (yysyntax_error_status == 0)
           yymsgp = yymsg;
-        else if (yysyntax_error_status == 1)
+        else if (yysyntax_error_status == -1)
           {
             if (yymsg != yymsgbuf)
               YYSTACK_FREE (yymsg);
-            yymsg = (char *) YYSTACK_ALLOC (yymsg_alloc);
-            if (!yymsg)
+            yymsg = YY_CAST (char *,
+                             YYSTACK_ALLOC (YY_CAST (YYSIZE_T, yymsg_alloc)));
+            if (yymsg)
               {
-                yymsg = yymsgbuf;
-                yymsg_alloc = sizeof yymsgbuf;
-                yysyntax_error_status = 2;
+                yysyntax_error_status
+                  = yysyntax_error (&yymsg_alloc, &yymsg, &yyctx);
+                yymsgp = yymsg;
               }
             else
               {
-                yysyntax_error_status = YYSYNTAX_ERROR;
-                yymsgp = yymsg;
+                yymsg = yymsgbuf;
+                yymsg_alloc = sizeof yymsgbuf;
+                yysyntax_error_status = YYENOMEM;
               }
           }
         yyerror (context, yymsgp);
-        if (yysyntax_error_status == 2)
-          goto yyexhaustedlab;
+        if (yysyntax_error_status == YYENOMEM)
+          YYNOMEM;
       }
-# undef YYSYNTAX_ERROR
-#endif
     }
 
-
-
   if (yyerrstatus == 3)
     {
       /* If just tried and failed to reuse lookahead token after an
          error, discard it.  */
 
-      if (yychar <= YYEOF)
+      if (yychar <= END)
         {
           /* Return failure if at end of input.  */
-          if (yychar == YYEOF)
+          if (yychar == END)
             YYABORT;
         }
       else
@@ -2567,12 +2784,11 @@ yyerrlab:
 | yyerrorlab -- error raised explicitly by YYERROR.  |
 `---------------------------------------------------*/
 yyerrorlab:
-
-  /* Pacify compilers like GCC when the user code never invokes
-     YYERROR and the label yyerrorlab therefore never appears in user
-     code.  */
-  if (/*CONSTCOND*/ 0)
-     goto yyerrorlab;
+  /* Pacify compilers when the user code never invokes YYERROR and the
+     label yyerrorlab therefore never appears in user code.  */
+  if (0)
+    YYERROR;
+  ++yynerrs;
 
   /* Do not reclaim the symbols of the rule whose action triggered
      this YYERROR.  */
@@ -2589,13 +2805,14 @@ yyerrorlab:
 yyerrlab1:
   yyerrstatus = 3;      /* Each real token shifted decrements this.  */
 
+  /* Pop stack until we find a state that shifts the error token.  */
   for (;;)
     {
       yyn = yypact[yystate];
       if (!yypact_value_is_default (yyn))
         {
-          yyn += YYTERROR;
-          if (0 <= yyn && yyn <= YYLAST && yycheck[yyn] == YYTERROR)
+          yyn += YYSYMBOL_YYerror;
+          if (0 <= yyn && yyn <= YYLAST && yycheck[yyn] == YYSYMBOL_YYerror)
             {
               yyn = yytable[yyn];
               if (0 < yyn)
@@ -2609,7 +2826,7 @@ yyerrlab1:
 
 
       yydestruct ("Error: popping",
-                  yystos[yystate], yyvsp, context);
+                  YY_ACCESSING_SYMBOL (yystate), yyvsp, context);
       YYPOPSTACK (1);
       yystate = *yyssp;
       YY_STACK_PRINT (yyss, yyssp);
@@ -2621,7 +2838,7 @@ yyerrlab1:
 
 
   /* Shift the error token.  */
-  YY_SYMBOL_PRINT ("Shifting", yystos[yyn], yyvsp, yylsp);
+  YY_SYMBOL_PRINT ("Shifting", YY_ACCESSING_SYMBOL (yyn), yyvsp, yylsp);
 
   yystate = yyn;
   goto yynewstate;
@@ -2632,26 +2849,30 @@ yyerrlab1:
 `-------------------------------------*/
 yyacceptlab:
   yyresult = 0;
-  goto yyreturn;
+  goto yyreturnlab;
+
 
 /*-----------------------------------.
 | yyabortlab -- YYABORT comes here.  |
 `-----------------------------------*/
 yyabortlab:
   yyresult = 1;
-  goto yyreturn;
+  goto yyreturnlab;
+
 
-#if !defined yyoverflow || YYERROR_VERBOSE
-/*-------------------------------------------------.
-| yyexhaustedlab -- memory exhaustion comes here.  |
-`-------------------------------------------------*/
+/*-----------------------------------------------------------.
+| yyexhaustedlab -- YYNOMEM (memory exhaustion) comes here.  |
+`-----------------------------------------------------------*/
 yyexhaustedlab:
   yyerror (context, YY_("memory exhausted"));
   yyresult = 2;
-  /* Fall through.  */
-#endif
+  goto yyreturnlab;
+
 
-yyreturn:
+/*----------------------------------------------------------.
+| yyreturnlab -- parsing is finished, clean up and return.  |
+`----------------------------------------------------------*/
+yyreturnlab:
   if (yychar != YYEMPTY)
     {
       /* Make sure we have latest lookahead translation.  See comments at
@@ -2667,16 +2888,15 @@ yyreturn:
   while (yyssp != yyss)
     {
       yydestruct ("Cleanup: popping",
-                  yystos[*yyssp], yyvsp, context);
+                  YY_ACCESSING_SYMBOL (+*yyssp), yyvsp, context);
       YYPOPSTACK (1);
     }
 #ifndef yyoverflow
   if (yyss != yyssa)
     YYSTACK_FREE (yyss);
 #endif
-#if YYERROR_VERBOSE
   if (yymsg != yymsgbuf)
     YYSTACK_FREE (yymsg);
-#endif
   return yyresult;
 }
+
@@ -79,6 +79,9 @@
 %token SWQT_CAST                "CAST"
 %token SWQT_UNION               "UNION"
 %token SWQT_ALL                 "ALL"
+%token SWQT_LIMIT               "LIMIT"
+%token SWQT_GROUP               "GROUP"
+%token SWQT_OFFSET              "OFFSET"
 
 %token SWQT_VALUE_START
 %token SWQT_SELECT_START
@@ -553,12 +556,12 @@ select_statement:
     | '(' select_core ')' opt_union_all
 
 select_core:
-    SWQT_SELECT select_field_list SWQT_FROM table_def opt_joins opt_where opt_order_by
+    SWQT_SELECT select_field_list SWQT_FROM table_def opt_joins opt_where opt_group_by opt_order_by opt_limit
     {
         delete $4;
     }
 
-    | SWQT_SELECT SWQT_DISTINCT select_field_list SWQT_FROM table_def opt_joins opt_where opt_order_by
+    | SWQT_SELECT SWQT_DISTINCT select_field_list SWQT_FROM table_def opt_joins opt_where opt_group_by opt_order_by opt_limit
     {
         context->poCurSelect->query_mode = SWQM_DISTINCT_LIST;
         delete $5;
@@ -781,9 +784,40 @@ opt_joins:
             delete $3;
 	    }
 
+opt_group_by:
+    | SWQT_GROUP SWQT_BY group_spec_list
+
+group_spec_list:
+    group_spec ',' group_spec_list
+    | group_spec
+
+group_spec:
+    field_value
+        {
+            context->poCurSelect->PushGroupBy( $1->table_name, $1->string_value );
+            delete $1;
+            $1 = NULL;
+        }
+
 opt_order_by:
     | SWQT_ORDER SWQT_BY sort_spec_list
 
+opt_limit:
+    | SWQT_LIMIT SWQT_INTEGER_NUMBER opt_offset
+        {
+            context->poCurSelect->limit = $2->int_value;
+            delete $2;
+            $2 = NULL;
+        }
+
+opt_offset:
+    | SWQT_OFFSET SWQT_INTEGER_NUMBER
+        {
+            context->poCurSelect->offset = $2->int_value;
+            delete $2;
+            $2 = NULL;
+        }
+
 sort_spec_list:
     sort_spec ',' sort_spec_list
     | sort_spec
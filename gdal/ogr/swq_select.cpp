@@ -46,8 +46,12 @@ swq_select::swq_select() :
     join_count(0),
     join_defs(NULL),
     where_expr(NULL),
+    group_specs(0),
+    group_defs(NULL),
     order_specs(0),
     order_defs(NULL),
+    limit(-1),
+    offset(0),
     poOtherSelect(NULL)
 { }
 
@@ -94,6 +98,14 @@ swq_select::~swq_select()
 
     CPLFree( column_summary );
 
+    for( int i = 0; i < group_specs; i++ )
+    {
+        CPLFree( group_defs[i].table_name );
+        CPLFree( group_defs[i].field_name );
+    }
+
+    CPLFree( group_defs );
+
     for( int i = 0; i < order_specs; i++ )
     {
         CPLFree( order_defs[i].table_name );
@@ -193,6 +205,8 @@ void swq_select::Dump( FILE *fp )
         fprintf( fp, "  QUERY MODE: RECORDSET\n" );
     else if( query_mode == SWQM_DISTINCT_LIST )
         fprintf( fp, "  QUERY MODE: DISTINCT LIST\n" );
+    else if( query_mode == SWQM_GROUP_BY )
+        fprintf( fp, "  QUERY MODE: GROUP BY\n" );
     else
         fprintf( fp, "  QUERY MODE: %d/unknown\n", query_mode );
 
@@ -281,6 +295,18 @@ void swq_select::Dump( FILE *fp )
         where_expr->Dump( fp, 2 );
     }
 
+/* -------------------------------------------------------------------- */
+/*      Group by                                                        */
+/* -------------------------------------------------------------------- */
+
+    for( int i = 0; i < group_specs; i++ )
+    {
+        fprintf( fp, "  GROUP BY: %s (%d/%d)\n",
+                 group_defs[i].field_name,
+                 group_defs[i].table_index,
+                 group_defs[i].field_index );
+    }
+
 /* -------------------------------------------------------------------- */
 /*      Order by                                                        */
 /* -------------------------------------------------------------------- */
@@ -296,6 +322,11 @@ void swq_select::Dump( FILE *fp )
         else
             fprintf( fp, " DESC\n" );
     }
+
+    if( limit >= 0 )
+        fprintf( fp, "  LIMIT: " CPL_FRMT_GIB "\n", limit );
+    if( offset > 0 )
+        fprintf( fp, "  OFFSET: " CPL_FRMT_GIB "\n", offset );
 }
 
 /************************************************************************/
@@ -403,6 +434,12 @@ char* swq_select::Unparse()
         CPLFree(pszTmp);
     }
 
+    for( int i = 0; i < group_specs; i++ )
+    {
+        osSelect += (i == 0) ? " GROUP BY " : ", ";
+        osSelect += swq_expr_node::QuoteIfNecessary(group_defs[i].field_name, '"');
+    }
+
     for( int i = 0; i < order_specs; i++ )
     {
         osSelect += " ORDER BY ";
@@ -411,6 +448,19 @@ char* swq_select::Unparse()
             osSelect += " DESC";
     }
 
+    // OFFSET is only valid after LIMIT in the grammar.
+    if( limit >= 0 )
+    {
+        osSelect += " LIMIT ";
+        osSelect += CPLSPrintf(CPL_FRMT_GIB, limit);
+
+        if( offset > 0 )
+        {
+            osSelect += " OFFSET ";
+            osSelect += CPLSPrintf(CPL_FRMT_GIB, offset);
+        }
+    }
+
     return CPLStrdup(osSelect);
 }
 
@@ -739,6 +789,23 @@ void swq_select::PushOrderBy( const char* pszTableName, const char *pszFieldName
     order_defs[order_specs-1].ascending_flag = bAscending;
 }
 
+/************************************************************************/
+/*                             PushGroupBy()                            */
+/************************************************************************/
+
+void swq_select::PushGroupBy( const char* pszTableName, const char *pszFieldName )
+
+{
+    group_specs++;
+    group_defs = (swq_group_def *)
+        CPLRealloc( group_defs, sizeof(swq_group_def) * group_specs );
+
+    group_defs[group_specs-1].table_name = CPLStrdup(pszTableName ? pszTableName : "");
+    group_defs[group_specs-1].field_name = CPLStrdup(pszFieldName);
+    group_defs[group_specs-1].table_index = -1;
+    group_defs[group_specs-1].field_index = -1;
+}
+
 /************************************************************************/
 /*                              PushJoin()                              */
 /************************************************************************/
@@ -1088,7 +1155,7 @@ CPLErr swq_select::parse( swq_field_list *field_list,
             return CE_Failure;
     }
 
-    for( int i = 0; i < result_columns; i++ )
+    for( int i = 0; group_specs == 0 && i < result_columns; i++ )
     {
         swq_col_def *def = column_defs + i;
         int this_indicator = -1;
@@ -1150,6 +1217,13 @@ CPLErr swq_select::parse( swq_field_list *field_list,
         query_mode = SWQM_RECORDSET;
     }
 
+    if( group_specs > 0 )
+    {
+        eError = ParseGroupBy( field_list );
+        if( eError != CE_None )
+            return eError;
+    }
+
 /* -------------------------------------------------------------------- */
 /*      Process column names in JOIN specs.                             */
 /* -------------------------------------------------------------------- */
@@ -1199,6 +1273,16 @@ CPLErr swq_select::parse( swq_field_list *field_list,
                       def->field_name );
             return CE_Failure;
         }
+
+        if( group_specs > 0 && GetGroupByKey( def->table_index,
+                                              def->field_index ) < 0 )
+        {
+            CPLError( CE_Failure, CPLE_NotSupported,
+                      "Field '%s' in ORDER BY clause must appear in the "
+                      "GROUP BY clause",
+                      def->field_name );
+            return CE_Failure;
+        }
     }
 
 /* -------------------------------------------------------------------- */
@@ -1216,3 +1300,107 @@ CPLErr swq_select::parse( swq_field_list *field_list,
 
     return CE_None;
 }
+
+/************************************************************************/
+/*                           GetGroupByKey()                            */
+/*                                                                      */
+/*      Return the index of the GROUP BY key matching a field, or -1.   */
+/************************************************************************/
+
+int swq_select::GetGroupByKey( int table_index, int field_index )
+
+{
+    for( int i = 0; i < group_specs; i++ )
+    {
+        if( group_defs[i].table_index == table_index &&
+            group_defs[i].field_index == field_index )
+            return i;
+    }
+    return -1;
+}
+
+/************************************************************************/
+/*                            ParseGroupBy()                            */
+/*                                                                      */
+/*      Identify the GROUP BY keys, and check that all result           */
+/*      columns are either a key or an aggregate.                       */
+/************************************************************************/
+
+CPLErr swq_select::ParseGroupBy( swq_field_list *field_list )
+
+{
+    if( query_mode == SWQM_DISTINCT_LIST )
+    {
+        CPLError( CE_Failure, CPLE_NotSupported,
+                  "SELECT DISTINCT not supported with GROUP BY." );
+        return CE_Failure;
+    }
+
+    for( int i = 0; i < group_specs; i++ )
+    {
+        swq_group_def *def = group_defs + i;
+
+        swq_field_type field_type;
+        def->field_index = swq_identify_field( def->table_name,
+                                               def->field_name, field_list,
+                                               &field_type, &(def->table_index) );
+        if( def->field_index == -1 )
+        {
+            CPLError( CE_Failure, CPLE_AppDefined,
+                      "Unrecognized field name %s in GROUP BY.",
+                      def->table_name[0] ?
+                      CPLSPrintf("%s.%s", def->table_name, def->field_name)
+                      : def->field_name );
+            return CE_Failure;
+        }
+
+        if( def->table_index != 0 )
+        {
+            CPLError( CE_Failure, CPLE_AppDefined,
+                      "Cannot use field '%s' of a secondary table in a GROUP BY clause",
+                      def->field_name );
+            return CE_Failure;
+        }
+
+        if( field_type == SWQ_GEOMETRY )
+        {
+            CPLError( CE_Failure, CPLE_AppDefined,
+                      "Cannot use geometry field '%s' in a GROUP BY clause",
+                      def->field_name );
+            return CE_Failure;
+        }
+    }
+
+    for( int i = 0; i < result_columns; i++ )
+    {
+        swq_col_def *def = column_defs + i;
+
+        if( def->col_func == SWQCF_MIN
+            || def->col_func == SWQCF_MAX
+            || def->col_func == SWQCF_AVG
+            || def->col_func == SWQCF_SUM
+            || def->col_func == SWQCF_COUNT )
+        {
+            if( def->distinct_flag )
+            {
+                CPLError( CE_Failure, CPLE_NotSupported,
+                          "COUNT(DISTINCT) not supported with GROUP BY." );
+                return CE_Failure;
+            }
+        }
+        else if( def->col_func != SWQCF_NONE ||
+                 (def->expr != NULL && def->expr->eNodeType != SNT_COLUMN) ||
+                 GetGroupByKey( def->table_index, def->field_index ) < 0 )
+        {
+            CPLError( CE_Failure, CPLE_AppDefined,
+                      "Field %s must appear in the GROUP BY clause or be "
+                      "used in an aggregate function.",
+                      def->field_name );
+            return CE_Failure;
+        }
+    }
+
+    query_mode = SWQM_GROUP_BY;
+
+    return CE_None;
+}
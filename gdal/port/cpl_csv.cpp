@@ -31,8 +31,13 @@
 #include "cpl_csv.h"
 #include "cpl_conv.h"
 #include "cpl_multiproc.h"
+#include "cpl_virtualmem.h"
 #include "gdal_csv.h"
 
+#include <vector>
+
+#include "zlib.h"
+
 CPL_CVSID("$Id$");
 
 /* ==================================================================== */
@@ -55,8 +60,42 @@ typedef struct ctb {
     char      **papszLines;
     int        *panLineIndex;
     char       *pszRawData;
+
+    /* Compiled version of the table (see CSVCompile()) */
+    GByte      *pabyCompiled;
+    CPLVirtualMem *psCompiledMem;
+    const GUInt32 *panCompiledOffsets;
+    const char *pszCompiledStrings;
 } CSVTable;
 
+/* ==================================================================== */
+/*      Layout of a compiled table, all values being little-endian:     */
+/*                                                                      */
+/*      char    szSignature[8]       "GDALCSVB"                         */
+/*      GUInt32 nVersion             3                                  */
+/*      GUInt32 nRecordCount         number of records, without header  */
+/*      GUInt32 nFlags               CSV_COMPILED_SORTED if the keys    */
+/*                                   are in ascending order             */
+/*      GUInt32 nSourceCRC           CRC32 of samples of the .csv file, */
+/*                                   see CSVComputeSampleCRC()          */
+/*      GUInt64 nSourceSize          size of the .csv file              */
+/*      GInt64  nSourceMTime         modification time of the .csv file */
+/*      GInt32  anKeys[nRecordCount] atoi() of each record line         */
+/*      GUInt32 anOffsets[nRecordCount+2] offset of the header record,  */
+/*                                   of each record, and end of the     */
+/*                                   string area                        */
+/*      char    achStrings[]         fields of each record, already     */
+/*                                   unquoted, as nul terminated        */
+/*                                   strings.                           */
+/*                                                                      */
+/*      Records are in the order of the .csv file.                      */
+/* ==================================================================== */
+
+static const char CSV_COMPILED_SIGNATURE[] = "GDALCSVB";
+static const GUInt32 CSV_COMPILED_VERSION = 3;
+static const GUInt32 CSV_COMPILED_SORTED = 1;
+static const int CSV_COMPILED_HEADER_SIZE = 40;
+
 static void CSVDeaccessInternal( CSVTable **ppsCSVTableList, int bCanUseTLS,
                                  const char * pszFilename );
 
@@ -69,6 +108,288 @@ static void CSVFreeTLS( void* pData )
     CPLFree(pData);
 }
 
+/************************************************************************/
+/*                            CSVFreeTable()                            */
+/************************************************************************/
+
+static void CSVFreeTable( CSVTable *psTable )
+
+{
+    if( psTable->fp != NULL )
+        VSIFCloseL( psTable->fp );
+
+    CSLDestroy( psTable->papszFieldNames );
+    CSLDestroy( psTable->papszRecFields );
+    CPLFree( psTable->pszFilename );
+    if( psTable->pabyCompiled == NULL )
+        CPLFree( psTable->panLineIndex );
+    CPLFree( psTable->pszRawData );
+    CPLFree( psTable->papszLines );
+    if( psTable->psCompiledMem != NULL )
+        CPLVirtualMemFree( psTable->psCompiledMem );
+    else
+        CPLFree( psTable->pabyCompiled );
+
+    CPLFree( psTable );
+}
+
+/************************************************************************/
+/*                        CSVGetCompiledRecord()                        */
+/*                                                                      */
+/*      Split a record of a compiled table into fields.  Record -1      */
+/*      is the header record.                                           */
+/************************************************************************/
+
+static char **CSVGetCompiledRecord( CSVTable *psTable, int iRecord )
+
+{
+    const char *pszField =
+        psTable->pszCompiledStrings + psTable->panCompiledOffsets[iRecord+1];
+    const char * const pszEnd =
+        psTable->pszCompiledStrings + psTable->panCompiledOffsets[iRecord+2];
+
+    CPLStringList aosFields;
+    while( pszField < pszEnd )
+    {
+        aosFields.AddString( pszField );
+        pszField += strlen(pszField) + 1;
+    }
+
+    return aosFields.StealList();
+}
+
+/************************************************************************/
+/*                        CSVGetCompiledField()                         */
+/*                                                                      */
+/*      Return a field of a record of a compiled table, or NULL if      */
+/*      the record has not so many fields.                              */
+/************************************************************************/
+
+static const char *CSVGetCompiledField( CSVTable *psTable, int iRecord,
+                                        int iField )
+
+{
+    const char *pszField =
+        psTable->pszCompiledStrings + psTable->panCompiledOffsets[iRecord+1];
+    const char * const pszEnd =
+        psTable->pszCompiledStrings + psTable->panCompiledOffsets[iRecord+2];
+
+    for( ; pszField < pszEnd && iField > 0; iField-- )
+        pszField += strlen(pszField) + 1;
+
+    return pszField < pszEnd ? pszField : NULL;
+}
+
+/************************************************************************/
+/*                        CSVComputeSampleCRC()                         */
+/*                                                                      */
+/*      CRC32 of the first and last blocks of a file of nSize bytes,    */
+/*      and of evenly spaced blocks in between, so that checking a      */
+/*      compiled table costs a few small reads whatever the size of     */
+/*      the CSV file.  Files of up to 64 KB are read entirely.          */
+/************************************************************************/
+
+static bool CSVComputeSampleCRC( const char *pszFilename, GUIntBig nSize,
+                                 GUInt32 *pnCRC )
+
+{
+    VSILFILE *fp = VSIFOpenL( pszFilename, "rb" );
+    if( fp == NULL )
+        return false;
+
+    const int nBlockSize = 4096;
+    const int nBlockCount = 16;
+    std::vector<GByte> abyBuffer( nBlockSize );
+    uLong nCRC = crc32( 0L, NULL, 0 );
+    for( int i = 0; i < nBlockCount; i++ )
+    {
+        GUIntBig nOffset = static_cast<GUIntBig>(i) * nBlockSize;
+        if( nSize > static_cast<GUIntBig>(nBlockSize) * nBlockCount )
+            nOffset = (nSize - nBlockSize) * i / (nBlockCount - 1);
+        if( nOffset >= nSize )
+            break;
+
+        if( VSIFSeekL( fp, static_cast<vsi_l_offset>(nOffset),
+                       SEEK_SET ) != 0 )
+        {
+            VSIFCloseL( fp );
+            return false;
+        }
+        const size_t nRead = VSIFReadL( &abyBuffer[0], 1, nBlockSize, fp );
+        nCRC = crc32( nCRC, &abyBuffer[0], static_cast<uInt>(nRead) );
+    }
+    VSIFCloseL( fp );
+
+    *pnCRC = static_cast<GUInt32>(nCRC);
+    return true;
+}
+
+/************************************************************************/
+/*                          CSVOpenCompiled()                           */
+/*                                                                      */
+/*      Open the compiled version of a CSV file, that is to say         */
+/*      the file with the .csvb extension written by CSVCompile(),      */
+/*      provided that it exists, is valid and matches the CSV file.     */
+/*      It is memory mapped when possible, and otherwise read at        */
+/*      once.                                                           */
+/*                                                                      */
+/*      The CSV file is considered unchanged when its size and its      */
+/*      modification time are the ones recorded.  When only the         */
+/*      modification time differs, for example after the files have    */
+/*      been copied, the CRC of samples of the file is checked.         */
+/************************************************************************/
+
+static CSVTable *CSVOpenCompiled( const char *pszFilename )
+
+{
+#ifdef CPL_MSB
+    // Compiled tables are little-endian.
+    (void)pszFilename;
+    return NULL;
+#else
+    if( !CPLTestBool( CPLGetConfigOption( "CPL_CSV_COMPILED", "YES" ) ) )
+        return NULL;
+
+    VSIStatBufL sStat;
+    if( VSIStatL( pszFilename, &sStat ) != 0 )
+        return NULL;
+
+    const CPLString osCompiledFilename(
+        CPLResetExtension( pszFilename, "csvb" ) );
+    VSILFILE *fp = VSIFOpenL( osCompiledFilename, "rb" );
+    if( fp == NULL )
+        return NULL;
+
+    if( VSIFSeekL( fp, 0, SEEK_END ) != 0 )
+    {
+        VSIFCloseL( fp );
+        return NULL;
+    }
+    const vsi_l_offset nFileSize = VSIFTellL( fp );
+    if( nFileSize < static_cast<vsi_l_offset>(CSV_COMPILED_HEADER_SIZE) ||
+        nFileSize > static_cast<vsi_l_offset>(INT_MAX) )
+    {
+        VSIFCloseL( fp );
+        return NULL;
+    }
+    const size_t nSize = static_cast<size_t>(nFileSize);
+
+/* -------------------------------------------------------------------- */
+/*      Map or load the file.                                           */
+/* -------------------------------------------------------------------- */
+    CPLVirtualMem *psMem = NULL;
+    GByte *pabyData = NULL;
+    if( CPLIsVirtualMemFileMapAvailable() &&
+        VSIFGetNativeFileDescriptorL( fp ) != NULL )
+    {
+        psMem = CPLVirtualMemFileMapNew( fp, 0, nFileSize,
+                                         VIRTUALMEM_READONLY, NULL, NULL );
+        if( psMem != NULL )
+            pabyData = static_cast<GByte *>( CPLVirtualMemGetAddr( psMem ) );
+    }
+    if( pabyData == NULL )
+    {
+        pabyData = static_cast<GByte *>( VSI_MALLOC_VERBOSE( nSize ) );
+        if( pabyData == NULL ||
+            VSIFSeekL( fp, 0, SEEK_SET ) != 0 ||
+            VSIFReadL( pabyData, 1, nSize, fp ) != nSize )
+        {
+            CPLFree( pabyData );
+            VSIFCloseL( fp );
+            return NULL;
+        }
+    }
+    VSIFCloseL( fp );
+
+/* -------------------------------------------------------------------- */
+/*      Validate the header and offsets, so that later accesses do      */
+/*      not need any check.                                             */
+/* -------------------------------------------------------------------- */
+    GUInt32 nVersion = 0;
+    GUInt32 nRecordCount = 0;
+    GUInt32 nFlags = 0;
+    GUInt32 nSourceCRC = 0;
+    GUIntBig nSourceSize = 0;
+    GIntBig nSourceMTime = 0;
+    memcpy( &nVersion, pabyData + 8, 4 );
+    memcpy( &nRecordCount, pabyData + 12, 4 );
+    memcpy( &nFlags, pabyData + 16, 4 );
+    memcpy( &nSourceCRC, pabyData + 20, 4 );
+    memcpy( &nSourceSize, pabyData + 24, 8 );
+    memcpy( &nSourceMTime, pabyData + 32, 8 );
+
+    const GUInt32 *panOffsets = NULL;
+    const char *pszStrings = NULL;
+    bool bValid =
+        memcmp( pabyData, CSV_COMPILED_SIGNATURE, 8 ) == 0 &&
+        nVersion == CSV_COMPILED_VERSION &&
+        nSourceSize == static_cast<GUIntBig>(sStat.st_size) &&
+        nRecordCount < static_cast<GUInt32>(INT_MAX / 8) &&
+        CSV_COMPILED_HEADER_SIZE + 8 * static_cast<size_t>(nRecordCount) + 8
+            <= nSize;
+    if( bValid )
+    {
+        panOffsets = reinterpret_cast<const GUInt32 *>(
+            pabyData + CSV_COMPILED_HEADER_SIZE + 4 * nRecordCount );
+        pszStrings = reinterpret_cast<const char *>(
+            panOffsets + nRecordCount + 2 );
+        const size_t nStringsSize =
+            nSize - (CSV_COMPILED_HEADER_SIZE + 8 * nRecordCount + 8);
+        bValid = panOffsets[0] == 0 &&
+                 panOffsets[nRecordCount + 1] == nStringsSize;
+        for( GUInt32 i = 0; bValid && i <= nRecordCount; i++ )
+        {
+            bValid = panOffsets[i] <= panOffsets[i+1] &&
+                     (panOffsets[i] == panOffsets[i+1] ||
+                      pszStrings[panOffsets[i+1] - 1] == '\0');
+        }
+    }
+    if( bValid && nSourceMTime != static_cast<GIntBig>(sStat.st_mtime) )
+    {
+        GUInt32 nCRC = 0;
+        bValid = CSVComputeSampleCRC( pszFilename, nSourceSize, &nCRC ) &&
+                 nCRC == nSourceCRC;
+    }
+    if( !bValid )
+    {
+        CPLDebug( "CPL_CSV", "Ignoring invalid or outdated %s",
+                  osCompiledFilename.c_str() );
+        if( psMem != NULL )
+            CPLVirtualMemFree( psMem );
+        else
+            CPLFree( pabyData );
+        return NULL;
+    }
+
+/* -------------------------------------------------------------------- */
+/*      Create the table, in the state of an ingested one.              */
+/* -------------------------------------------------------------------- */
+    CSVTable * const psTable = reinterpret_cast<CSVTable *>(
+        VSI_CALLOC_VERBOSE( sizeof(CSVTable), 1 ) );
+    if( psTable == NULL )
+    {
+        if( psMem != NULL )
+            CPLVirtualMemFree( psMem );
+        else
+            CPLFree( pabyData );
+        return NULL;
+    }
+
+    psTable->pabyCompiled = pabyData;
+    psTable->psCompiledMem = psMem;
+    psTable->panCompiledOffsets = panOffsets;
+    psTable->pszCompiledStrings = pszStrings;
+    psTable->nLineCount = static_cast<int>(nRecordCount);
+    if( nFlags & CSV_COMPILED_SORTED )
+        psTable->panLineIndex = reinterpret_cast<int *>(
+            pabyData + CSV_COMPILED_HEADER_SIZE );
+    psTable->iLastLine = -1;
+    psTable->papszFieldNames = CSVGetCompiledRecord( psTable, -1 );
+
+    return psTable;
+#endif
+}
+
 /* It would likely be better to share this list between threads, but
    that will require some rework. */
 
@@ -83,7 +404,8 @@ static void CSVFreeTLS( void* pData )
 /*      isn't done.                                                     */
 /************************************************************************/
 
-static CSVTable *CSVAccess( const char * pszFilename )
+static CSVTable *CSVAccess( const char * pszFilename,
+                            bool bAllowCompiled = true )
 
 {
 /* -------------------------------------------------------------------- */
@@ -122,30 +444,38 @@ static CSVTable *CSVAccess( const char * pszFilename )
     }
 
 /* -------------------------------------------------------------------- */
-/*      If not, try to open it.                                         */
+/*      If not, use its compiled version if there is one up to date.    */
 /* -------------------------------------------------------------------- */
-    VSILFILE *fp = VSIFOpenL( pszFilename, "rb" );
-    if( fp == NULL )
-        return NULL;
+    CSVTable *psTable = bAllowCompiled ? CSVOpenCompiled( pszFilename ) : NULL;
+    VSILFILE *fp = NULL;
 
 /* -------------------------------------------------------------------- */
-/*      Create an information structure about this table, and add to    */
-/*      the front of the list.                                          */
+/*      Otherwise try to open it.                                       */
 /* -------------------------------------------------------------------- */
-    CSVTable * const psTable = reinterpret_cast<CSVTable *>(
-        VSI_CALLOC_VERBOSE( sizeof(CSVTable), 1 ) );
     if( psTable == NULL )
     {
-        VSIFCloseL(fp);
-        return NULL;
+        fp = VSIFOpenL( pszFilename, "rb" );
+        if( fp == NULL )
+            return NULL;
+
+        psTable = reinterpret_cast<CSVTable *>(
+            VSI_CALLOC_VERBOSE( sizeof(CSVTable), 1 ) );
+        if( psTable == NULL )
+        {
+            VSIFCloseL(fp);
+            return NULL;
+        }
+        psTable->fp = fp;
     }
 
-    psTable->fp = fp;
+/* -------------------------------------------------------------------- */
+/*      Add the information structure about this table to the front    */
+/*      of the list.                                                    */
+/* -------------------------------------------------------------------- */
     psTable->pszFilename = VSI_STRDUP_VERBOSE( pszFilename );
     if( psTable->pszFilename == NULL )
     {
-        VSIFree(psTable);
-        VSIFCloseL(fp);
+        CSVFreeTable(psTable);
         return NULL;
     }
     psTable->bNonUniqueKey = FALSE; /* as far as we know now */
@@ -156,7 +486,8 @@ static CSVTable *CSVAccess( const char * pszFilename )
 /* -------------------------------------------------------------------- */
 /*      Read the table header record containing the field names.        */
 /* -------------------------------------------------------------------- */
-    psTable->papszFieldNames = CSVReadParseLineL( fp );
+    if( fp != NULL )
+        psTable->papszFieldNames = CSVReadParseLineL( fp );
 
     return psTable;
 }
@@ -214,17 +545,7 @@ static void CSVDeaccessInternal( CSVTable **ppsCSVTableList, int bCanUseTLS,
 /* -------------------------------------------------------------------- */
 /*      Free the table.                                                 */
 /* -------------------------------------------------------------------- */
-    if( psTable->fp != NULL )
-        VSIFCloseL( psTable->fp );
-
-    CSLDestroy( psTable->papszFieldNames );
-    CSLDestroy( psTable->papszRecFields );
-    CPLFree( psTable->pszFilename );
-    CPLFree( psTable->panLineIndex );
-    CPLFree( psTable->pszRawData );
-    CPLFree( psTable->papszLines );
-
-    CPLFree( psTable );
+    CSVFreeTable( psTable );
 
     if (bCanUseTLS)
         CPLReadLine( NULL );
@@ -393,7 +714,7 @@ static void CSVIngest( const char *pszFilename )
         return;
     }
 
-    if( psTable->pszRawData != NULL )
+    if( psTable->pszRawData != NULL || psTable->pabyCompiled != NULL )
         return;
 
 /* -------------------------------------------------------------------- */
@@ -901,6 +1222,9 @@ CSVScanLinesIndexed( CSVTable *psTable, int nKeyValue )
 /* -------------------------------------------------------------------- */
     psTable->iLastLine = iResult;
 
+    if( psTable->pabyCompiled != NULL )
+        return CSVGetCompiledRecord( psTable, iResult );
+
     return CSVSplitLine( psTable->papszLines[iResult], ',' );
 }
 
@@ -929,6 +1253,28 @@ CSVScanLinesIngested( CSVTable *psTable, int iKeyField, const char * pszValue,
         && psTable->panLineIndex != NULL )
         return CSVScanLinesIndexed( psTable, nTestValue );
 
+/* -------------------------------------------------------------------- */
+/*      Scan a compiled table, only splitting the selected record.      */
+/* -------------------------------------------------------------------- */
+    if( psTable->pabyCompiled != NULL )
+    {
+        while( psTable->iLastLine+1 < psTable->nLineCount )
+        {
+            psTable->iLastLine++;
+            const char *pszFieldValue =
+                CSVGetCompiledField( psTable, psTable->iLastLine, iKeyField );
+            if( pszFieldValue == NULL )
+                continue;
+            if( eCriteria == CC_Integer
+                ? atoi(pszFieldValue) == nTestValue
+                : CSVCompare( pszFieldValue, pszValue, eCriteria ) )
+            {
+                return CSVGetCompiledRecord( psTable, psTable->iLastLine );
+            }
+        }
+        return NULL;
+    }
+
 /* -------------------------------------------------------------------- */
 /*      Scan from in-core lines.                                        */
 /* -------------------------------------------------------------------- */
@@ -1001,8 +1347,12 @@ char **CSVGetNextLine( const char *pszFilename )
 
     psTable->iLastLine++;
     CSLDestroy( psTable->papszRecFields );
-    psTable->papszRecFields =
-        CSVSplitLine( psTable->papszLines[psTable->iLastLine], ',' );
+    if( psTable->pabyCompiled != NULL )
+        psTable->papszRecFields =
+            CSVGetCompiledRecord( psTable, psTable->iLastLine );
+    else
+        psTable->papszRecFields =
+            CSVSplitLine( psTable->papszLines[psTable->iLastLine], ',' );
 
     return psTable->papszRecFields;
 }
@@ -1051,7 +1401,7 @@ char **CSVScanFile( const char * pszFilename, int iKeyField,
     psTable->iLastLine = -1;
     CSLDestroy( psTable->papszRecFields );
 
-    if( psTable->pszRawData != NULL )
+    if( psTable->pszRawData != NULL || psTable->pabyCompiled != NULL )
         psTable->papszRecFields =
             CSVScanLinesIngested( psTable, iKeyField, pszValue, eCriteria );
     else
@@ -1237,6 +1587,168 @@ const char *CSVGetField( const char * pszFilename,
     return "";
 }
 
+/************************************************************************/
+/*                             CSVCompile()                             */
+/************************************************************************/
+
+/**
+ * Write the compiled version of a CSV table.
+ *
+ * The compiled version contains the records of the table already split into
+ * fields, and the index of the integer key of the first column, in a form
+ * that can be memory mapped.  When a file with the same name as a CSV file,
+ * but with a .csvb extension, exists and matches the size, and the
+ * modification time or the CRC of samples, of the CSV file, the CSVScanFile(),
+ * CSVGetField(), etc. functions use it instead of parsing the CSV file.
+ * This is mostly useful for the tables of the
+ * GDAL_DATA directory, that are looked up when importing EPSG codes.
+ * Setting the CPL_CSV_COMPILED configuration option to NO disables the use
+ * of compiled tables.
+ *
+ * Compiled tables are only used on little-endian hosts.
+ *
+ * @param pszFilename the CSV file.
+ * @param pszOutFilename the file to write, or NULL to use pszFilename with
+ * a .csvb extension.
+ *
+ * @return TRUE on success.
+ *
+ * @since GDAL 2.2
+ */
+
+int CSVCompile( const char *pszFilename, const char *pszOutFilename )
+
+{
+    const CPLString osOutFilename(
+        pszOutFilename != NULL ? CPLString(pszOutFilename) :
+                                 CPLString(CPLResetExtension( pszFilename,
+                                                              "csvb" )) );
+
+    VSIStatBufL sStat;
+    GUInt32 nSourceCRC = 0;
+    if( VSIStatL( pszFilename, &sStat ) != 0 ||
+        !CSVComputeSampleCRC( pszFilename,
+                              static_cast<GUIntBig>(sStat.st_size),
+                              &nSourceCRC ) )
+    {
+        CPLError( CE_Failure, CPLE_FileIO, "Failed to open file: %s",
+                  pszFilename );
+        return FALSE;
+    }
+
+/* -------------------------------------------------------------------- */
+/*      Ingest the CSV file itself, the same way CSVScanFile() does.   */
+/* -------------------------------------------------------------------- */
+    CSVDeaccess( pszFilename );
+    CSVTable * const psTable = CSVAccess( pszFilename, false );
+    if( psTable == NULL )
+    {
+        CPLError( CE_Failure, CPLE_FileIO, "Failed to open file: %s",
+                  pszFilename );
+        return FALSE;
+    }
+    CSVIngest( pszFilename );
+    if( psTable->pszRawData == NULL || psTable->papszLines == NULL )
+    {
+        CSVDeaccess( pszFilename );
+        return FALSE;
+    }
+
+/* -------------------------------------------------------------------- */
+/*      Build the key index, offsets and strings.                       */
+/* -------------------------------------------------------------------- */
+    const int nRecordCount = psTable->nLineCount;
+    std::vector<GInt32> anKeys( nRecordCount );
+    std::vector<GUInt32> anOffsets;
+    std::vector<char> achStrings;
+    GUInt32 nFlags = CSV_COMPILED_SORTED;
+
+    for( int iRecord = -1; iRecord < nRecordCount; iRecord++ )
+    {
+        char **papszFields = NULL;
+        if( iRecord < 0 )
+        {
+            papszFields = CSLDuplicate( psTable->papszFieldNames );
+        }
+        else
+        {
+            anKeys[iRecord] = atoi( psTable->papszLines[iRecord] );
+            if( iRecord > 0 && anKeys[iRecord] < anKeys[iRecord-1] )
+                nFlags &= ~CSV_COMPILED_SORTED;
+            papszFields = CSVSplitLine( psTable->papszLines[iRecord], ',' );
+        }
+
+        anOffsets.push_back( static_cast<GUInt32>(achStrings.size()) );
+        for( int i = 0; papszFields != NULL && papszFields[i] != NULL; i++ )
+        {
+            achStrings.insert( achStrings.end(), papszFields[i],
+                               papszFields[i] + strlen(papszFields[i]) + 1 );
+        }
+        CSLDestroy( papszFields );
+    }
+    anOffsets.push_back( static_cast<GUInt32>(achStrings.size()) );
+
+    CSVDeaccess( pszFilename );
+
+/* -------------------------------------------------------------------- */
+/*      Write the file.                                                 */
+/* -------------------------------------------------------------------- */
+    VSILFILE *fp = VSIFOpenL( osOutFilename, "wb" );
+    if( fp == NULL )
+    {
+        CPLError( CE_Failure, CPLE_FileIO, "Failed to create file: %s",
+                  osOutFilename.c_str() );
+        return FALSE;
+    }
+
+    GByte abyHeader[CSV_COMPILED_HEADER_SIZE];
+    memset( abyHeader, 0, sizeof(abyHeader) );
+    memcpy( abyHeader, CSV_COMPILED_SIGNATURE, 8 );
+    GUInt32 nTmp = CSV_COMPILED_VERSION;
+    CPL_LSBPTR32( &nTmp );
+    memcpy( abyHeader + 8, &nTmp, 4 );
+    nTmp = static_cast<GUInt32>(nRecordCount);
+    CPL_LSBPTR32( &nTmp );
+    memcpy( abyHeader + 12, &nTmp, 4 );
+    CPL_LSBPTR32( &nFlags );
+    memcpy( abyHeader + 16, &nFlags, 4 );
+    CPL_LSBPTR32( &nSourceCRC );
+    memcpy( abyHeader + 20, &nSourceCRC, 4 );
+    GUIntBig nSourceSize = static_cast<GUIntBig>(sStat.st_size);
+    CPL_LSBPTR64( &nSourceSize );
+    memcpy( abyHeader + 24, &nSourceSize, 8 );
+    GIntBig nSourceMTime = static_cast<GIntBig>(sStat.st_mtime);
+    CPL_LSBPTR64( &nSourceMTime );
+    memcpy( abyHeader + 32, &nSourceMTime, 8 );
+
+    for( size_t i = 0; i < anKeys.size(); i++ )
+        CPL_LSBPTR32( &anKeys[i] );
+    for( size_t i = 0; i < anOffsets.size(); i++ )
+        CPL_LSBPTR32( &anOffsets[i] );
+
+    bool bOK = VSIFWriteL( abyHeader, sizeof(abyHeader), 1, fp ) == 1;
+    if( bOK && nRecordCount > 0 )
+        bOK = VSIFWriteL( &anKeys[0], sizeof(GInt32), anKeys.size(), fp )
+                == anKeys.size();
+    if( bOK )
+        bOK = VSIFWriteL( &anOffsets[0], sizeof(GUInt32), anOffsets.size(),
+                          fp ) == anOffsets.size();
+    if( bOK && !achStrings.empty() )
+        bOK = VSIFWriteL( &achStrings[0], 1, achStrings.size(), fp )
+                == achStrings.size();
+    if( VSIFCloseL( fp ) != 0 )
+        bOK = false;
+    if( !bOK )
+    {
+        CPLError( CE_Failure, CPLE_FileIO, "Failed to write file: %s",
+                  osOutFilename.c_str() );
+        VSIUnlink( osOutFilename );
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
 /************************************************************************/
 /*                       GDALDefaultCSVFilename()                       */
 /************************************************************************/
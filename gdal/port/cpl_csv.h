@@ -66,6 +66,8 @@ int CPL_DLL CSVGetFileFieldId( const char *, const char * );
 
 void CPL_DLL CSVDeaccess( const char * );
 
+int CPL_DLL CSVCompile( const char *pszFilename, const char *pszOutFilename );
+
 const char CPL_DLL *CSVGetField( const char *, const char *, const char *,
                                  CSVCompareCriteria, const char * );
 
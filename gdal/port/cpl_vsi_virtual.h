@@ -53,6 +53,7 @@ class CPL_DLL VSIVirtualHandle {
     virtual vsi_l_offset Tell() = 0;
     virtual size_t    Read( void *pBuffer, size_t nSize, size_t nMemb ) = 0;
     virtual int       ReadMultiRange( int nRanges, void ** ppData, const vsi_l_offset* panOffsets, const size_t* panSizes );
+    virtual void      AdviseRead( CPL_UNUSED int nRanges, CPL_UNUSED const vsi_l_offset* panOffsets, CPL_UNUSED const size_t* panSizes ) {}
     virtual size_t    Write( const void *pBuffer, size_t nSize,size_t nMemb)=0;
     virtual int       Eof() = 0;
     virtual int       Flush() {return 0;}
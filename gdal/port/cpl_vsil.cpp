@@ -814,6 +814,36 @@ int VSIFReadMultiRangeL( int nRanges, void ** ppData,
     return poFileHandle->ReadMultiRange( nRanges, ppData, panOffsets, panSizes );
 }
 
+/************************************************************************/
+/*                          VSIFAdviseReadL()                           */
+/************************************************************************/
+
+/**
+ * \brief Advise the file system of ranges of bytes that will be read soon.
+ *
+ * This is only a hint: file systems for which fetching data has a high
+ * latency, such as /vsicurl/, may start downloading the indicated ranges in
+ * the background, so that subsequent VSIFReadL() or VSIFReadMultiRangeL()
+ * calls on them can be served from memory.  Other file systems ignore it.
+ *
+ * Ranges should be sorted in ascending start offset.
+ *
+ * @param nRanges number of ranges.
+ * @param panOffsets array of nRanges offsets of the ranges.
+ * @param panSizes array of nRanges sizes of the ranges (in bytes).
+ * @param fp file handle opened with VSIFOpenL().
+ *
+ * @since GDAL 2.2
+ */
+
+void VSIFAdviseReadL( int nRanges, const vsi_l_offset* panOffsets,
+                      const size_t* panSizes, VSILFILE * fp )
+{
+    VSIVirtualHandle *poFileHandle = reinterpret_cast<VSIVirtualHandle *>( fp );
+
+    poFileHandle->AdviseRead( nRanges, panOffsets, panSizes );
+}
+
 /************************************************************************/
 /*                             VSIFWriteL()                             */
 /************************************************************************/
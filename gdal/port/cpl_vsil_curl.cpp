@@ -80,6 +80,7 @@ void CPLHTTPSetOptions(CURL *http_handle, char** papszOptions);
 void VSICurlSetOptions(CURL* hCurlHandle, const char* pszURL);
 
 #include <map>
+#include <vector>
 
 #define ENABLE_DEBUG 1
 
@@ -153,6 +154,18 @@ typedef struct
     bool                bInterrupted;
 } WriteFuncStruct;
 
+typedef struct
+{
+    vsi_l_offset        nStartOffset;
+    vsi_l_offset        nEndOffset;
+    CURL               *hCurlHandle;
+    struct curl_slist  *psHeaders;
+    WriteFuncStruct     sWriteFuncData;
+    WriteFuncStruct     sWriteFuncHeaderData;
+    char                szCurlErrBuf[CURL_ERROR_SIZE+1];
+    bool                bDownloaded;
+} PrefetchRange;
+
 } /* end of anoymous namespace */
 
 static const char* VSICurlGetCacheFileName()
@@ -348,6 +361,14 @@ class VSICurlHandle : public VSIVirtualHandle
     time_t              m_nExpireTimestampLocal;
     CPLString           m_osRedirectURL;
 
+    CPLJoinableThread           *m_hPrefetchThread;
+    std::vector<PrefetchRange*>  m_apsPrefetchRanges;
+    int                          m_nPrefetchMaxConnections;
+
+    static void         PrefetchThreadMain( void* pData );
+    void                DownloadPrefetchRanges();
+    void                WaitForPrefetch();
+
   protected:
     virtual struct curl_slist* GetCurlHeaders(const CPLString& ) { return NULL; }
     bool CanRestartOnError(const char* pszErrorMsg) { return CanRestartOnError(pszErrorMsg, false); }
@@ -366,6 +387,8 @@ class VSICurlHandle : public VSIVirtualHandle
     virtual size_t       Read( void *pBuffer, size_t nSize, size_t nMemb );
     virtual int          ReadMultiRange( int nRanges, void ** ppData,
                                          const vsi_l_offset* panOffsets, const size_t* panSizes );
+    virtual void         AdviseRead( int nRanges, const vsi_l_offset* panOffsets,
+                                     const size_t* panSizes );
     virtual size_t       Write( const void *pBuffer, size_t nSize, size_t nMemb );
     virtual int          Eof();
     virtual int          Flush();
@@ -399,7 +422,9 @@ VSICurlHandle::VSICurlHandle(VSICurlFilesystemHandler* poFSIn, const char* pszUR
     bStopOnInterrruptUntilUninstall(false),
     bInterrupted(false),
     m_bS3Redirect(false),
-    m_nExpireTimestampLocal(0)
+    m_nExpireTimestampLocal(0),
+    m_hPrefetchThread(NULL),
+    m_nPrefetchMaxConnections(0)
 {
     pszURL = CPLStrdup(pszURLIn);
     CachedFileProp* cachedFileProp = poFS->GetCachedFileProp(pszURL);
@@ -416,6 +441,7 @@ VSICurlHandle::VSICurlHandle(VSICurlFilesystemHandler* poFSIn, const char* pszUR
 
 VSICurlHandle::~VSICurlHandle()
 {
+    WaitForPrefetch();
     CPLFree(pszURL);
 }
 
@@ -1302,6 +1328,8 @@ size_t VSICurlHandle::Read( void * const pBufferIn, size_t const  nSize, size_t
     if (nBufferRequestSize == 0)
         return 0;
 
+    WaitForPrefetch();
+
     //CPLDebug("VSICURL", "offset=%d, size=%d", (int)curOffset, (int)nBufferRequestSize);
 
     vsi_l_offset iterOffset = curOffset;
@@ -1396,6 +1424,8 @@ int VSICurlHandle::ReadMultiRange( int const nRanges, void ** const ppData,
     WriteFuncStruct sWriteFuncData;
     WriteFuncStruct sWriteFuncHeaderData;
 
+    WaitForPrefetch();
+
     if (bInterrupted && bStopOnInterrruptUntilUninstall)
         return FALSE;
 
@@ -1741,6 +1771,296 @@ end:
     return nRet;
 }
 
+/************************************************************************/
+/*                             AdviseRead()                             */
+/************************************************************************/
+
+void VSICurlHandle::AdviseRead( int const nRanges,
+                                const vsi_l_offset* const panOffsets,
+                                const size_t* const panSizes )
+{
+#if LIBCURL_VERSION_NUM >= 0x071C00
+    if( !CPLTestBool(CPLGetConfigOption("CPL_VSIL_CURL_ADVISE_READ", "YES")) )
+        return;
+
+    WaitForPrefetch();
+
+    if (bInterrupted && bStopOnInterrruptUntilUninstall)
+        return;
+
+    /* Multiple concurrent range requests are only worth for HTTP */
+    if( !STARTS_WITH(pszURL, "http") )
+        return;
+
+    CachedFileProp* cachedFileProp = poFS->GetCachedFileProp(pszURL);
+    if (cachedFileProp->eExists == EXIST_NO)
+        return;
+
+/* -------------------------------------------------------------------- */
+/*      Collect the chunks that are not cached yet, and merge the       */
+/*      consecutive ones.  Do not prefetch more than half of the        */
+/*      cache, so that prefetched chunks are not evicted before use.    */
+/* -------------------------------------------------------------------- */
+    std::vector< std::pair<vsi_l_offset, vsi_l_offset> > aoRanges;
+    int nChunks = 0;
+    for( int i = 0; i < nRanges && nChunks < N_MAX_REGIONS / 2; i++ )
+    {
+        if( panSizes[i] == 0 )
+            continue;
+
+        const vsi_l_offset nStart =
+            (panOffsets[i] / DOWNLOAD_CHUNK_SIZE) * DOWNLOAD_CHUNK_SIZE;
+        vsi_l_offset nEnd = panOffsets[i] + panSizes[i] - 1;
+        if( cachedFileProp->bHasComputedFileSize )
+        {
+            if( nStart >= cachedFileProp->fileSize )
+                continue;
+            if( nEnd >= cachedFileProp->fileSize )
+                nEnd = cachedFileProp->fileSize - 1;
+        }
+        nEnd = (nEnd / DOWNLOAD_CHUNK_SIZE) * DOWNLOAD_CHUNK_SIZE;
+
+        for( vsi_l_offset nOffset = nStart;
+             nOffset <= nEnd && nChunks < N_MAX_REGIONS / 2;
+             nOffset += DOWNLOAD_CHUNK_SIZE )
+        {
+            if( !aoRanges.empty() && nOffset >= aoRanges.back().first &&
+                nOffset <= aoRanges.back().second )
+                continue;
+            if( poFS->GetRegion(pszURL, nOffset) != NULL )
+                continue;
+
+            if( !aoRanges.empty() &&
+                aoRanges.back().second + DOWNLOAD_CHUNK_SIZE == nOffset )
+                aoRanges.back().second = nOffset;
+            else
+                aoRanges.push_back(
+                    std::pair<vsi_l_offset, vsi_l_offset>(nOffset, nOffset));
+            nChunks++;
+        }
+    }
+
+    if( aoRanges.empty() )
+        return;
+
+    CPLString osURL(pszURL);
+    if( m_bS3Redirect && time(NULL) + 1 < m_nExpireTimestampLocal )
+        osURL = m_osRedirectURL;
+
+    if (ENABLE_DEBUG)
+        CPLDebug("VSICURL", "Prefetching %d chunks in %d ranges (%s)...",
+                 nChunks, static_cast<int>(aoRanges.size()), osURL.c_str());
+
+/* -------------------------------------------------------------------- */
+/*      Setup one curl handle per range.  This is done in this thread   */
+/*      so that thread-local configuration options are honoured.        */
+/* -------------------------------------------------------------------- */
+    for( size_t i = 0; i < aoRanges.size(); i++ )
+    {
+        PrefetchRange* psRange = new PrefetchRange;
+        psRange->bDownloaded = false;
+        psRange->nStartOffset = aoRanges[i].first;
+        psRange->nEndOffset = aoRanges[i].second + DOWNLOAD_CHUNK_SIZE - 1;
+        if( cachedFileProp->bHasComputedFileSize &&
+            psRange->nEndOffset >= cachedFileProp->fileSize )
+        {
+            psRange->nEndOffset = cachedFileProp->fileSize - 1;
+        }
+
+        psRange->hCurlHandle = curl_easy_init();
+        VSICurlSetOptions(psRange->hCurlHandle, osURL);
+
+        VSICURLInitWriteFuncStruct(&psRange->sWriteFuncData, NULL, NULL, NULL);
+        curl_easy_setopt(psRange->hCurlHandle, CURLOPT_WRITEDATA,
+                         &psRange->sWriteFuncData);
+        curl_easy_setopt(psRange->hCurlHandle, CURLOPT_WRITEFUNCTION,
+                         VSICurlHandleWriteFunc);
+
+        VSICURLInitWriteFuncStruct(&psRange->sWriteFuncHeaderData, NULL, NULL, NULL);
+        psRange->sWriteFuncHeaderData.bIsHTTP = true;
+        psRange->sWriteFuncHeaderData.nStartOffset = psRange->nStartOffset;
+        psRange->sWriteFuncHeaderData.nEndOffset = psRange->nEndOffset;
+        curl_easy_setopt(psRange->hCurlHandle, CURLOPT_HEADERDATA,
+                         &psRange->sWriteFuncHeaderData);
+        curl_easy_setopt(psRange->hCurlHandle, CURLOPT_HEADERFUNCTION,
+                         VSICurlHandleWriteFunc);
+
+        char rangeStr[512];
+        snprintf(rangeStr, sizeof(rangeStr),
+                 CPL_FRMT_GUIB "-" CPL_FRMT_GUIB,
+                 psRange->nStartOffset, psRange->nEndOffset);
+        curl_easy_setopt(psRange->hCurlHandle, CURLOPT_RANGE, rangeStr);
+
+        psRange->szCurlErrBuf[0] = '\0';
+        curl_easy_setopt(psRange->hCurlHandle, CURLOPT_ERRORBUFFER,
+                         psRange->szCurlErrBuf);
+        curl_easy_setopt(psRange->hCurlHandle, CURLOPT_PRIVATE, psRange);
+
+        psRange->psHeaders = GetCurlHeaders("GET");
+        if( psRange->psHeaders != NULL )
+            curl_easy_setopt(psRange->hCurlHandle, CURLOPT_HTTPHEADER,
+                             psRange->psHeaders);
+
+        m_apsPrefetchRanges.push_back(psRange);
+    }
+
+    m_nPrefetchMaxConnections = atoi(
+        CPLGetConfigOption("CPL_VSIL_CURL_ADVISE_READ_MAX_CONNECTIONS", "8"));
+    if( m_nPrefetchMaxConnections < 1 )
+        m_nPrefetchMaxConnections = 1;
+
+/* -------------------------------------------------------------------- */
+/*      Run the requests in the background.  The next read on this      */
+/*      handle will wait for their completion.                          */
+/* -------------------------------------------------------------------- */
+    m_hPrefetchThread = CPLCreateJoinableThread(PrefetchThreadMain, this);
+    if( m_hPrefetchThread == NULL )
+    {
+        DownloadPrefetchRanges();
+        WaitForPrefetch();
+    }
+#else
+    (void)nRanges;
+    (void)panOffsets;
+    (void)panSizes;
+#endif
+}
+
+/************************************************************************/
+/*                         PrefetchThreadMain()                         */
+/************************************************************************/
+
+void VSICurlHandle::PrefetchThreadMain( void* pData )
+{
+    static_cast<VSICurlHandle*>(pData)->DownloadPrefetchRanges();
+}
+
+/************************************************************************/
+/*                       DownloadPrefetchRanges()                       */
+/*                                                                      */
+/*      Only downloads the ranges in buffers owned by the handle: the   */
+/*      region cache is shared with the other handles, so it is only    */
+/*      updated from the thread of the handle, in WaitForPrefetch().    */
+/************************************************************************/
+
+void VSICurlHandle::DownloadPrefetchRanges()
+{
+#if LIBCURL_VERSION_NUM >= 0x071C00
+    /* Errors are not fatal: the data will be requested again on read */
+    CPLPushErrorHandler(CPLQuietErrorHandler);
+
+    CURLM* hMultiHandle = curl_multi_init();
+
+    size_t iNextRange = 0;
+    int nActive = 0;
+    while( true )
+    {
+        while( nActive < m_nPrefetchMaxConnections &&
+               iNextRange < m_apsPrefetchRanges.size() )
+        {
+            curl_multi_add_handle(hMultiHandle,
+                                  m_apsPrefetchRanges[iNextRange]->hCurlHandle);
+            iNextRange++;
+            nActive++;
+        }
+        if( nActive == 0 )
+            break;
+
+        int nStillRunning = 0;
+        curl_multi_perform(hMultiHandle, &nStillRunning);
+
+        int nMsgsInQueue = 0;
+        CURLMsg* psMsg;
+        while( (psMsg = curl_multi_info_read(hMultiHandle, &nMsgsInQueue)) != NULL )
+        {
+            if( psMsg->msg != CURLMSG_DONE )
+                continue;
+
+            CURL* hCurlHandle = psMsg->easy_handle;
+            const CURLcode eResult = psMsg->data.result;
+            curl_multi_remove_handle(hMultiHandle, hCurlHandle);
+            nActive--;
+
+            char* pPrivate = NULL;
+            curl_easy_getinfo(hCurlHandle, CURLINFO_PRIVATE, &pPrivate);
+            PrefetchRange* psRange = reinterpret_cast<PrefetchRange*>(pPrivate);
+
+            long response_code = 0;
+            curl_easy_getinfo(hCurlHandle, CURLINFO_HTTP_CODE, &response_code);
+
+            if( eResult != CURLE_OK ||
+                psRange->sWriteFuncHeaderData.bError ||
+                !(response_code == 206 ||
+                  (response_code == 200 && psRange->nStartOffset == 0)) )
+            {
+                CPLDebug("VSICURL", "Prefetching of " CPL_FRMT_GUIB "-"
+                         CPL_FRMT_GUIB " failed: %ld %s",
+                         psRange->nStartOffset, psRange->nEndOffset,
+                         response_code, psRange->szCurlErrBuf);
+                continue;
+            }
+
+            psRange->bDownloaded = true;
+        }
+
+        if( nActive > 0 && nStillRunning > 0 )
+            curl_multi_wait(hMultiHandle, NULL, 0, 1000, NULL);
+    }
+
+    curl_multi_cleanup(hMultiHandle);
+
+    CPLPopErrorHandler();
+#endif
+}
+
+/************************************************************************/
+/*                          WaitForPrefetch()                           */
+/************************************************************************/
+
+void VSICurlHandle::WaitForPrefetch()
+{
+    if( m_hPrefetchThread != NULL )
+    {
+        CPLJoinThread(m_hPrefetchThread);
+        m_hPrefetchThread = NULL;
+    }
+
+/* -------------------------------------------------------------------- */
+/*      Insert the downloaded ranges in the region cache, by chunks.    */
+/* -------------------------------------------------------------------- */
+    for( size_t i = 0; i < m_apsPrefetchRanges.size(); i++ )
+    {
+        PrefetchRange* psRange = m_apsPrefetchRanges[i];
+        if( psRange->bDownloaded )
+        {
+            const char* pBuffer = psRange->sWriteFuncData.pBuffer;
+            size_t nSize = psRange->sWriteFuncData.nSize;
+            const size_t nExpectedSize = static_cast<size_t>(
+                psRange->nEndOffset - psRange->nStartOffset + 1);
+            if( nSize > nExpectedSize )
+                nSize = nExpectedSize;
+
+            vsi_l_offset nOffset = psRange->nStartOffset;
+            while( nSize > 0 )
+            {
+                const size_t nChunkSize = MIN((size_t)DOWNLOAD_CHUNK_SIZE, nSize);
+                poFS->AddRegion(pszURL, nOffset, nChunkSize, pBuffer);
+                nOffset += nChunkSize;
+                pBuffer += nChunkSize;
+                nSize -= nChunkSize;
+            }
+        }
+
+        curl_easy_cleanup(psRange->hCurlHandle);
+        if( psRange->psHeaders != NULL )
+            curl_slist_free_all(psRange->psHeaders);
+        CPLFree(psRange->sWriteFuncData.pBuffer);
+        CPLFree(psRange->sWriteFuncHeaderData.pBuffer);
+        delete psRange;
+    }
+    m_apsPrefetchRanges.clear();
+}
+
 /************************************************************************/
 /*                               Write()                                */
 /************************************************************************/